@@ -0,0 +1,109 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: s1see_captured.cc
+ * Description: Capture daemon application that reads live S1AP traffic from a
+ *              network interface (e.g. a tap or SPAN port) and stores it in
+ *              spool partitions for later processing.
+ */
+
+#include "s1see/ingest/capture_adapter.h"
+#include "s1see/spool/spool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <signal.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::atomic<bool> g_running{true};
+
+void signal_handler(int) {
+    g_running = false;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> positional;
+    std::shared_ptr<const s1see::spool::Partitioner> partitioner;  // Null: one partition per thread
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--partition-by" && i + 1 < argc) {
+            auto parsed = s1see::spool::parse_partitioning(argv[++i]);
+            if (!parsed) {
+                std::cerr << "Unknown --partition-by: " << argv[i] << " (source, ue or sctp)" << std::endl;
+                return 1;
+            }
+            partitioner = s1see::spool::make_partitioner(*parsed);
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <interface> [spool_dir] [threads] [--partition-by source|ue|sctp]"
+                  << std::endl;
+        return 1;
+    }
+    
+    s1see::ingest::CaptureIngestAdapter::Config capture_config;
+    capture_config.interface = positional[0];
+    std::string spool_dir = "spool_data";
+    if (positional.size() > 1) {
+        spool_dir = positional[1];
+    }
+    if (positional.size() > 2) {
+        capture_config.num_threads = std::strtoul(positional[2].c_str(), nullptr, 10);
+    }
+    size_t num_threads = capture_config.num_threads > 0
+        ? capture_config.num_threads
+        : std::max<size_t>(1, std::thread::hardware_concurrency());
+    
+    std::cout << "S1-SEE Capture Daemon" << std::endl;
+    std::cout << "Interface: " << capture_config.interface << std::endl;
+    std::cout << "Spool directory: " << spool_dir << std::endl;
+    
+    // One spool partition per capture thread; syncs are batched by the adapter
+    s1see::spool::WALLog::Config spool_config;
+    spool_config.base_dir = spool_dir;
+    spool_config.num_partitions = static_cast<int32_t>(num_threads);
+    spool_config.fsync_on_append = false;
+    spool_config.visible_on_append = true;  // Processors in other processes see records immediately
+    spool_config.recover_segments = true;  // Repair a tail torn by a crash before appending
+    spool_config.partitioner = partitioner;
+    auto spool = std::make_shared<s1see::spool::Spool>(spool_config);
+    
+    s1see::ingest::CaptureIngestAdapter adapter(capture_config);
+    adapter.set_spool(spool);
+    
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+    
+    if (!adapter.start()) {
+        std::cerr << "Failed to start capture" << std::endl;
+        return 1;
+    }
+    
+    std::cout << "Capture daemon running. Press Ctrl+C to stop." << std::endl;
+    
+    auto last = adapter.stats();
+    while (g_running) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        auto stats = adapter.stats();
+        std::cout << "packets/s=" << (stats.packets - last.packets)
+                  << " pdus/s=" << (stats.s1ap_pdus - last.s1ap_pdus)
+                  << " kernel_drops=" << stats.kernel_drops
+                  << " reassembly_drops=" << stats.reassembly_drops << std::endl;
+        last = stats;
+    }
+    
+    adapter.stop();
+    spool->flush();
+    auto stats = adapter.stats();
+    std::cout << "Captured " << stats.s1ap_pdus << " S1AP PDUs from " << stats.packets << " packets" << std::endl;
+    return 0;
+}
@@ -4,106 +4,477 @@
  * Support: support@melrosenetworks.com
  * Disclaimer: Provided "as is" without warranty; use at your own risk.
  * Title: s1see_demo_generator.cc
- * Description: Demo/test application for generating sample SignalMessage records
- *              and sending them to the spooler daemon via gRPC. Used for testing
- *              and demonstration purposes to simulate message ingestion.
+ * Description: Load generator for the spooler daemon. Simulates a population
+ *              of UEs and eNBs running attach, service request, S1 and X2
+ *              handover, TAU and release procedures with encoded S1AP/NAS,
+ *              sends them over one or more gRPC ingest streams at a target
+ *              rate, and reports acked throughput and ack latency.
  */
 
 #include "ingest.grpc.pb.h"
 #include "signal_message.pb.h"
+#include "s1see/utils/latency_histogram.h"
+#include "s1see/utils/ue_traffic_model.h"
 #include <grpcpp/grpcpp.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <thread>
-#include <chrono>
 #include <vector>
 
-using grpc::Channel;
 using grpc::ClientContext;
 using grpc::ClientReaderWriter;
 using grpc::Status;
 using s1see::SignalMessage;
+using s1see::SignalMessageBatch;
 using s1see::IngestService;
 using s1see::IngestAck;
+using s1see::IngestBatchAck;
+using s1see::utils::LatencyHistogram;
+using s1see::utils::UeTrafficModel;
+using Clock = std::chrono::steady_clock;
 
-int main(int argc, char** argv) {
-    std::string server_address = "localhost:50051";
-    int num_messages = 10;
-    
-    if (argc > 1) {
-        server_address = argv[1];
-    }
-    if (argc > 2) {
-        num_messages = std::stoi(argv[2]);
+static void usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [server] [messages] [options]" << std::endl;
+    std::cerr << "  server           Spooler address (default localhost:50051)" << std::endl;
+    std::cerr << "  messages         Messages to send, 0 for no limit (default 10)" << std::endl;
+    std::cerr << "  --ues N          Simulated UEs (default 100)" << std::endl;
+    std::cerr << "  --enbs N         Simulated eNBs, at least 2 (default 8)" << std::endl;
+    std::cerr << "  --rate N         Messages per second over all streams, 0 for no limit (default 10)" << std::endl;
+    std::cerr << "  --streams N      Concurrent ingest streams, each owning a slice of the UEs (default 1)" << std::endl;
+    std::cerr << "  --batch N        Messages per IngestBatch frame; 0 or 1 uses per-message Ingest (default 0)" << std::endl;
+    std::cerr << "  --window N       Unacked messages allowed per stream (default 128)" << std::endl;
+    std::cerr << "  --duration S     Stop after S seconds, 0 for no limit (default 0)" << std::endl;
+    std::cerr << "  --verbose        Print every ack" << std::endl;
+}
+
+namespace {
+
+struct Options {
+    std::string server = "localhost:50051";
+    uint64_t messages = 10;
+    size_t ues = 100;
+    size_t enbs = 8;
+    double rate = 10.0;
+    size_t streams = 1;
+    size_t batch = 0;
+    size_t window = 128;
+    double duration = 0.0;
+    bool verbose = false;
+};
+
+// Messages sent by the MME; everything else comes from the eNB
+SignalMessage::Direction direction_of(const char* procedure) {
+    static const char* const downlink[] = {
+        "downlink_nas_transport", "initial_context_setup_request", "ue_context_release_command",
+        "handover_request", "handover_command", "path_switch_request_ack",
+    };
+    for (const char* name : downlink) {
+        if (std::strcmp(procedure, name) == 0) {
+            return SignalMessage::DOWNLINK;
+        }
     }
-    
-    std::cout << "S1-SEE Demo Generator" << std::endl;
-    std::cout << "Connecting to: " << server_address << std::endl;
-    std::cout << "Sending " << num_messages << " messages" << std::endl;
-    
-    // Create channel
-    auto channel = grpc::CreateChannel(server_address, grpc::InsecureChannelCredentials());
-    auto stub = IngestService::NewStub(channel);
-    
-    // Create stream
-    ClientContext context;
-    std::shared_ptr<ClientReaderWriter<SignalMessage, IngestAck>> stream(
-        stub->Ingest(&context));
-    
-    // Send messages
-    auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    return SignalMessage::UPLINK;
+}
+
+int64_t wall_clock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
         std::chrono::system_clock::now().time_since_epoch()).count();
-    
-    // Generate sample PDUs
-    std::vector<std::vector<uint8_t>> sample_pdus = {
-        {0x00, 0x01, 0x02, 0x03, 0x04}, // HandoverRequest (stub)
-        {0x01, 0x05, 0x06, 0x07, 0x08}, // HandoverNotify (stub)
-        {0x02, 0x09, 0x0A, 0x0B, 0x0C}, // InitialUEMessage (stub)
+}
+
+// One ingest stream and the UE slice it simulates. The writer thread paces
+// and sends; the reader thread matches acks to send times. Acks arrive in
+// send order, so pending sends are a FIFO.
+class StreamLoad {
+public:
+    StreamLoad(const Options& options, size_t index, UeTrafficModel::Config model_config,
+               uint64_t message_limit, Clock::time_point deadline)
+        : options_(options), index_(index), model_(model_config),
+          message_limit_(message_limit), deadline_(deadline) {}
+
+    void run(IngestService::Stub& stub) {
+        if (options_.batch > 1) {
+            run_batched(stub);
+        } else {
+            run_single(stub);
+        }
+    }
+
+    const LatencyHistogram& latency_us() const { return latency_us_; }
+    uint64_t sent() const { return sent_.load(); }
+    uint64_t acked() const { return acked_.load(); }
+    uint64_t failed() const { return failed_.load(); }
+    const std::string& error() const { return error_; }
+
+private:
+    struct PendingSend {
+        int64_t last_sequence;  // Stream-wide message count after this send
+        uint64_t count;
+        Clock::time_point sent_at;
     };
-    
-    for (int i = 0; i < num_messages; ++i) {
+
+    const Options& options_;
+    size_t index_;
+    UeTrafficModel model_;
+    uint64_t message_limit_;  // 0 for no limit
+    Clock::time_point deadline_;
+    int64_t sequence_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable window_cv_;
+    std::deque<PendingSend> pending_;
+    uint64_t in_flight_ = 0;
+    bool reader_done_ = false;
+
+    LatencyHistogram latency_us_;  // Reader thread only, until joined
+    std::atomic<uint64_t> sent_{0};
+    std::atomic<uint64_t> acked_{0};
+    std::atomic<uint64_t> failed_{0};
+    std::string error_;
+
+    bool more_to_send() const {
+        if (message_limit_ != 0 && sequence_ >= static_cast<int64_t>(message_limit_)) {
+            return false;
+        }
+        return deadline_ == Clock::time_point::max() || Clock::now() < deadline_;
+    }
+
+    // Wall time between sends of `count` messages at this stream's share of the rate
+    Clock::duration interval(uint64_t count) const {
+        if (options_.rate <= 0.0) {
+            return Clock::duration::zero();
+        }
+        double seconds = static_cast<double>(count) * static_cast<double>(options_.streams) / options_.rate;
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    }
+
+    SignalMessage next_message() {
+        UeTrafficModel::Pdu pdu = model_.next();
         SignalMessage message;
-        message.set_ts_capture(now + i * 1000000); // 1ms apart
-        message.set_ts_ingest(now + i * 1000000);
-        message.set_source_id("demo_source");
-        message.set_direction(SignalMessage::UPLINK);
-        message.set_source_sequence(i);
-        message.set_transport_meta("{\"demo\": true}");
+        int64_t now = wall_clock_ns();
+        message.set_ts_capture(now);
+        message.set_ts_ingest(now);
+        message.set_source_id("enb-" + std::to_string(pdu.enb));
+        message.set_direction(direction_of(pdu.procedure));
+        message.set_source_sequence(++sequence_);
         message.set_payload_type(SignalMessage::RAW_BYTES);
-        
-        // Use sample PDU (round-robin)
-        const auto& pdu = sample_pdus[i % sample_pdus.size()];
-        message.set_raw_bytes(pdu.data(), pdu.size());
-        
-        // Send message
-        if (!stream->Write(message)) {
-            std::cerr << "Failed to write message " << i << std::endl;
-            break;
+        message.set_raw_bytes(pdu.bytes.data(), pdu.bytes.size());
+        return message;
+    }
+
+    // Blocks until `count` more messages fit in the window; false once the
+    // reader has stopped
+    bool reserve(uint64_t count, int64_t last_sequence) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        uint64_t limit = std::max<uint64_t>(options_.window, count);
+        window_cv_.wait(lock, [&] { return reader_done_ || in_flight_ + count <= limit; });
+        if (reader_done_) {
+            return false;
+        }
+        in_flight_ += count;
+        pending_.push_back({last_sequence, count, Clock::now()});
+        return true;
+    }
+
+    // Completes every pending send up to last_sequence
+    void complete(int64_t last_sequence, bool success) {
+        Clock::time_point now = Clock::now();
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (!pending_.empty() && pending_.front().last_sequence <= last_sequence) {
+            const PendingSend& send = pending_.front();
+            auto latency = std::chrono::duration_cast<std::chrono::microseconds>(now - send.sent_at);
+            latency_us_.record(static_cast<uint64_t>(latency.count()), send.count);
+            (success ? acked_ : failed_) += send.count;
+            in_flight_ -= send.count;
+            pending_.pop_front();
+        }
+        window_cv_.notify_all();
+    }
+
+    void reader_finished() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reader_done_ = true;
+        window_cv_.notify_all();
+    }
+
+    void finish(const Status& status) {
+        if (!status.ok()) {
+            error_ = "stream " + std::to_string(index_) + ": " + status.error_message();
+        }
+    }
+
+    void run_single(IngestService::Stub& stub) {
+        ClientContext context;
+        std::unique_ptr<ClientReaderWriter<SignalMessage, IngestAck>> stream(stub.Ingest(&context));
+
+        std::thread reader([&] {
+            IngestAck ack;
+            while (stream->Read(&ack)) {
+                if (!ack.success()) {
+                    std::cerr << "Message " << ack.message_id() << " failed: " << ack.error_message() << std::endl;
+                } else if (options_.verbose) {
+                    std::cout << "Message " << ack.message_id() << " acked: p=" << ack.spool_offset().partition()
+                              << " offset=" << ack.spool_offset().offset() << std::endl;
+                }
+                complete(ack.sequence(), ack.success());
+            }
+            reader_finished();
+        });
+
+        Clock::time_point next_send = Clock::now();
+        while (more_to_send()) {
+            std::this_thread::sleep_until(next_send);
+            next_send += interval(1);
+            SignalMessage message = next_message();
+            if (!reserve(1, sequence_)) {
+                break;
+            }
+            if (!stream->Write(message)) {
+                std::cerr << "Stream " << index_ << ": write failed" << std::endl;
+                break;
+            }
+            sent_ += 1;
         }
-        
-        // Read ack
-        IngestAck ack;
-        if (stream->Read(&ack)) {
-            if (ack.success()) {
-                std::cout << "Message " << i << " acked: p=" << ack.spool_offset().partition()
-                         << " offset=" << ack.spool_offset().offset() << std::endl;
-            } else {
-                std::cerr << "Message " << i << " failed: " << ack.error_message() << std::endl;
+
+        stream->WritesDone();
+        reader.join();
+        finish(stream->Finish());
+    }
+
+    void run_batched(IngestService::Stub& stub) {
+        ClientContext context;
+        std::unique_ptr<ClientReaderWriter<SignalMessageBatch, IngestBatchAck>> stream(stub.IngestBatch(&context));
+
+        std::thread reader([&] {
+            IngestBatchAck ack;
+            while (stream->Read(&ack)) {
+                if (!ack.success()) {
+                    std::cerr << "Messages " << ack.first_sequence() << "-" << ack.last_sequence()
+                              << " failed: " << ack.error_message() << std::endl;
+                } else if (options_.verbose) {
+                    std::cout << "Messages " << ack.first_sequence() << "-" << ack.last_sequence()
+                              << " acked: p=" << ack.last_offset().partition()
+                              << " offset=" << ack.last_offset().offset() << std::endl;
+                }
+                complete(ack.last_sequence(), ack.success());
+            }
+            reader_finished();
+        });
+
+        SignalMessageBatch batch;
+        int64_t batch_id = 0;
+        Clock::time_point next_send = Clock::now();
+        while (more_to_send()) {
+            std::this_thread::sleep_until(next_send);
+            batch.Clear();
+            while (static_cast<size_t>(batch.messages_size()) < options_.batch && more_to_send()) {
+                *batch.add_messages() = next_message();
+            }
+            uint64_t count = static_cast<uint64_t>(batch.messages_size());
+            if (count == 0) {
+                break;
+            }
+            batch.set_batch_id(++batch_id);
+            next_send += interval(count);
+            if (!reserve(count, sequence_)) {
+                break;
             }
+            if (!stream->Write(batch)) {
+                std::cerr << "Stream " << index_ << ": write failed" << std::endl;
+                break;
+            }
+            sent_ += count;
+        }
+
+        stream->WritesDone();
+        reader.join();
+        finish(stream->Finish());
+    }
+};
+
+void print_latency(const LatencyHistogram& histogram) {
+    std::cout << "Ack latency (us): mean=" << std::fixed << std::setprecision(1) << histogram.mean()
+              << " min=" << histogram.min()
+              << " p50=" << histogram.percentile(50)
+              << " p90=" << histogram.percentile(90)
+              << " p99=" << histogram.percentile(99)
+              << " p99.9=" << histogram.percentile(99.9)
+              << " max=" << histogram.max() << std::endl;
+    if (histogram.count() == 0) {
+        return;
+    }
+
+    // Fold the fine buckets into powers of two for display
+    std::vector<uint64_t> octaves(65, 0);
+    histogram.for_each_bucket([&](uint64_t lower, uint64_t, uint64_t count) {
+        octaves[std::bit_width(lower)] += count;
+    });
+    uint64_t cumulative = 0;
+    std::cout << "  " << std::setw(22) << "latency (us)" << std::setw(12) << "acks" << std::setw(10) << "cum %" << std::endl;
+    for (size_t octave = 0; octave < octaves.size(); ++octave) {
+        if (octaves[octave] == 0) {
+            continue;
         }
-        
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-    
-    // Close stream
-    stream->WritesDone();
-    Status status = stream->Finish();
-    
-    if (!status.ok()) {
-        std::cerr << "Stream failed: " << status.error_message() << std::endl;
-        return 1;
-    }
-    
-    std::cout << "Demo complete. Sent " << num_messages << " messages." << std::endl;
-    return 0;
+        uint64_t lower = octave == 0 ? 0 : uint64_t(1) << (octave - 1);
+        uint64_t upper = octave == 0 ? 0 : (octave == 64 ? ~uint64_t(0) : (uint64_t(1) << octave) - 1);
+        cumulative += octaves[octave];
+        std::cout << "  " << std::setw(10) << lower << " - " << std::setw(9) << upper
+                  << std::setw(12) << octaves[octave]
+                  << std::setw(9) << std::setprecision(2)
+                  << 100.0 * static_cast<double>(cumulative) / static_cast<double>(histogram.count()) << "%" << std::endl;
+    }
 }
 
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    int positional = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--ues" && has_value) {
+            options.ues = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--enbs" && has_value) {
+            options.enbs = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--rate" && has_value) {
+            options.rate = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--streams" && has_value) {
+            options.streams = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--batch" && has_value) {
+            options.batch = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--window" && has_value) {
+            options.window = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--duration" && has_value) {
+            options.duration = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--verbose") {
+            options.verbose = true;
+        } else if (arg[0] != '-' && positional == 0) {
+            options.server = arg;
+            positional++;
+        } else if (arg[0] != '-' && positional == 1) {
+            options.messages = std::strtoull(arg.c_str(), nullptr, 10);
+            positional++;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    options.ues = std::clamp<size_t>(options.ues, 1, UeTrafficModel::MAX_UES);
+    options.streams = std::clamp<size_t>(options.streams, 1, options.ues);
+    options.window = std::max<size_t>(options.window, 1);
+    if (options.messages == 0 && options.duration <= 0.0) {
+        std::cerr << "Unbounded run: stop with Ctrl+C" << std::endl;
+    }
+
+    std::cout << "S1-SEE Demo Generator" << std::endl;
+    std::cout << "Connecting to: " << options.server << std::endl;
+    std::cout << "Simulating " << options.ues << " UEs on " << std::max<size_t>(options.enbs, 2) << " eNBs over "
+              << options.streams << " stream(s), "
+              << (options.batch > 1 ? "batch " + std::to_string(options.batch) : std::string("per-message ingest"))
+              << ", window " << options.window << std::endl;
+    std::cout << "Sending " << (options.messages ? std::to_string(options.messages) : std::string("unlimited"))
+              << " messages at "
+              << (options.rate > 0.0 ? std::to_string(static_cast<uint64_t>(options.rate)) + " msg/s" : std::string("full speed"))
+              << std::endl;
+
+    auto channel = grpc::CreateChannel(options.server, grpc::InsecureChannelCredentials());
+    auto stub = IngestService::NewStub(channel);
+
+    Clock::time_point start = Clock::now();
+    Clock::time_point deadline = options.duration > 0.0
+        ? start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.duration))
+        : Clock::time_point::max();
+
+    // Split UEs and the message budget evenly; each UE stays on one stream,
+    // so its procedures are acked in order
+    std::vector<std::unique_ptr<StreamLoad>> loads;
+    size_t first_ue = 0;
+    for (size_t k = 0; k < options.streams; ++k) {
+        UeTrafficModel::Config model_config;
+        model_config.first_ue = first_ue;
+        model_config.num_ues = options.ues / options.streams + (k < options.ues % options.streams ? 1 : 0);
+        model_config.num_enbs = options.enbs;
+        first_ue += model_config.num_ues;
+
+        uint64_t limit = 0;
+        if (options.messages != 0) {
+            limit = options.messages / options.streams + (k < options.messages % options.streams ? 1 : 0);
+            if (limit == 0) {
+                continue;
+            }
+        }
+        loads.push_back(std::make_unique<StreamLoad>(options, k, model_config, limit, deadline));
+    }
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> writers;
+    for (auto& load : loads) {
+        writers.emplace_back([&stub, &load] { load->run(*stub); });
+    }
+
+    // Per-second progress
+    std::thread progress([&] {
+        uint64_t last_acked = 0;
+        Clock::time_point next = start + std::chrono::seconds(1);
+        while (!done.load()) {
+            std::this_thread::sleep_until(std::min(next, Clock::now() + std::chrono::milliseconds(100)));
+            if (Clock::now() < next) {
+                continue;
+            }
+            next += std::chrono::seconds(1);
+            uint64_t sent = 0, acked = 0, failed = 0;
+            for (const auto& load : loads) {
+                sent += load->sent();
+                acked += load->acked();
+                failed += load->failed();
+            }
+            std::cout << "[" << std::chrono::duration_cast<std::chrono::seconds>(Clock::now() - start).count() << "s]"
+                      << " acked/s=" << (acked - last_acked)
+                      << " sent=" << sent << " acked=" << acked << " failed=" << failed
+                      << " in_flight=" << (sent - acked - failed) << std::endl;
+            last_acked = acked;
+        }
+    });
+
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    done = true;
+    progress.join();
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    LatencyHistogram latency;
+    uint64_t sent = 0, acked = 0, failed = 0;
+    bool stream_failed = false;
+    for (const auto& load : loads) {
+        latency.merge(load->latency_us());
+        sent += load->sent();
+        acked += load->acked();
+        failed += load->failed();
+        if (!load->error().empty()) {
+            std::cerr << "Stream failed: " << load->error() << std::endl;
+            stream_failed = true;
+        }
+    }
+
+    std::cout << "Demo complete. Sent " << sent << " messages, " << acked << " acked, " << failed << " failed in "
+              << std::fixed << std::setprecision(2) << elapsed << "s" << std::endl;
+    std::cout << "Acked throughput: " << std::setprecision(1)
+              << (elapsed > 0.0 ? static_cast<double>(acked) / elapsed : 0.0) << " msg/s" << std::endl;
+    print_latency(latency);
+
+    return stream_failed || failed != 0 ? 1 : 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: s1see_pcap_loader.cc
+ * Description: Bulk loader application that writes the S1AP PDUs of a pcap or
+ *              pcapng capture straight into spool partitions, for later
+ *              processing by s1see_processor.
+ */
+
+#include "s1see/ingest/pcap_loader.h"
+#include "s1see/spool/spool.h"
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+
+static void usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " <capture.pcap|pcapng> [spool_dir] [options]" << std::endl;
+    std::cerr << "  --partitions N   Spool partitions (default 1)" << std::endl;
+    std::cerr << "  --partition-by P source, ue or sctp (default source)" << std::endl;
+    std::cerr << "  --workers N      Extraction threads (default: all cores)" << std::endl;
+    std::cerr << "  --batch N        Messages per spool append (default 8192)" << std::endl;
+    std::cerr << "  --source-id ID   Source ID (default pcap:<file name>)" << std::endl;
+    std::cerr << "  --file-id N      Capture file ID stored with each record (default 0)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    
+    std::string pcap_path = argv[1];
+    std::string spool_dir = "spool_data";
+    int32_t num_partitions = 1;
+    auto partitioning = s1see::spool::Partitioning::SOURCE_SEQUENCE;
+    s1see::ingest::PcapLoader::Config loader_config;
+    
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--partitions" && has_value) {
+            num_partitions = std::atoi(argv[++i]);
+        } else if (arg == "--partition-by" && has_value) {
+            auto parsed = s1see::spool::parse_partitioning(argv[++i]);
+            if (!parsed) {
+                usage(argv[0]);
+                return 1;
+            }
+            partitioning = *parsed;
+        } else if (arg == "--workers" && has_value) {
+            loader_config.num_workers = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--batch" && has_value) {
+            loader_config.batch_size = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--source-id" && has_value) {
+            loader_config.source_id = argv[++i];
+        } else if (arg == "--file-id" && has_value) {
+            loader_config.file_id = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg[0] != '-') {
+            spool_dir = arg;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    
+    std::cout << "S1-SEE PCAP Loader" << std::endl;
+    std::cout << "Capture: " << pcap_path << std::endl;
+    std::cout << "Spool directory: " << spool_dir << std::endl;
+    
+    // Bulk load: one sync at the end instead of per append
+    s1see::spool::WALLog::Config spool_config;
+    spool_config.base_dir = spool_dir;
+    spool_config.num_partitions = num_partitions > 0 ? num_partitions : 1;
+    spool_config.fsync_on_append = false;
+    spool_config.partitioner = s1see::spool::make_partitioner(partitioning);
+    spool_config.recover_segments = true;  // Repair a tail torn by a crash before appending
+    auto spool = std::make_shared<s1see::spool::Spool>(spool_config);
+    
+    try {
+        s1see::ingest::PcapLoader loader(spool, loader_config);
+        auto stats = loader.load(pcap_path);
+        double mb = stats.bytes / (1024.0 * 1024.0);
+        std::cout << "Loaded " << stats.s1ap_pdus << " S1AP PDUs from " << stats.frames
+                  << " frames (" << mb << " MB) in " << stats.seconds << " s";
+        if (stats.seconds > 0) {
+            std::cout << " [" << (stats.s1ap_pdus / stats.seconds) << " PDUs/s, "
+                      << (mb / stats.seconds) << " MB/s]";
+        }
+        std::cout << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
@@ -7,20 +7,35 @@
  * Description: Main application for processing S1AP messages from spool storage.
  *              Reads messages from spool partitions, processes them through the
  *              pipeline (decode, correlate, rule evaluation), and emits events to
- *              configured sinks (stdout, JSONL file). Supports continuous and
- *              batch processing modes.
+ *              configured sinks (stdout, JSONL file, optionally Arrow IPC
+ *              files, a Kafka topic and a gRPC event stream).
+ *              Optionally serves UE lookups and per-cell listings over gRPC.
+ *              Supports continuous and batch processing modes, running
+ *              as one of several members of a consumer group, and replaying
+ *              a capture-time range of the spool into a group of its own.
  */
 
+#include "s1see/metrics/metrics_server.h"
 #include "s1see/processor/pipeline.h"
+#include "s1see/processor/grpc_query_service.h"
+#include "s1see/rules/ruleset_watcher.h"
 #include "s1see/rules/yaml_loader.h"
 #include "s1see/sinks/stdout_sink.h"
 #include "s1see/sinks/jsonl_sink.h"
+#include "s1see/sinks/async_sink.h"
+#include "s1see/sinks/arrow_sink.h"
+#include "s1see/sinks/kafka_sink.h"
+#include "s1see/sinks/grpc_sink.h"
 #include "event.pb.h"
+#include <algorithm>
 #include <iostream>
 #include <signal.h>
 #include <memory>
 #include <thread>
 #include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
 
 using s1see::Event;
 
@@ -35,31 +50,145 @@ int main(int argc, char** argv) {
     std::string spool_dir = "spool_data";
     std::string ruleset_file = "config/rulesets/mobility.yaml";
     std::string output_file = "events.jsonl";
+    std::string arrow_dir;
+    std::string kafka_brokers;
+    std::string kafka_topic = "s1see-events";
+    std::string grpc_events_address;
+    std::string grpc_query_address;
+    auto event_detail = s1see::decode::DecodeLevel::IDENTIFIERS;
     bool continuous = true;
+    int32_t spool_partitions = 1;
+    std::string consumer_group = "processor";
+    bool group_given = false;
+    int64_t replay_from_ns = 0;
+    int64_t replay_to_ns = 0;
+    std::string member_id;
+    bool group_membership = false;
+    auto lease_duration = std::chrono::milliseconds(10000);
+    bool watch_rules = false;
+    bool event_time = false;
+    s1see::metrics::MetricsServer::Config metrics_config;
+    metrics_config.port = 9465;
     
-    if (argc > 1) {
-        spool_dir = argv[1];
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--metrics-port" && i + 1 < argc) {
+            metrics_config.port = static_cast<uint16_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--partitions" && i + 1 < argc) {
+            spool_partitions = std::max(std::atoi(argv[++i]), 1);
+        } else if (arg == "--group" && i + 1 < argc) {
+            consumer_group = argv[++i];
+            group_given = true;
+        } else if ((arg == "--replay-from" || arg == "--replay-to") && i + 1 < argc) {
+            // Unix seconds, fractions allowed
+            auto ns = static_cast<int64_t>(std::strtod(argv[++i], nullptr) * 1e9);
+            (arg == "--replay-from" ? replay_from_ns : replay_to_ns) = ns;
+        } else if (arg == "--member" && i + 1 < argc) {
+            // "auto" names the member <hostname>-<pid>
+            member_id = argv[++i];
+            if (member_id == "auto") {
+                member_id.clear();
+            }
+            group_membership = true;
+        } else if (arg == "--lease-ms" && i + 1 < argc) {
+            lease_duration = std::chrono::milliseconds(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--watch-rules") {
+            watch_rules = true;
+        } else if (arg == "--event-time") {
+            event_time = true;
+        } else if (arg == "--arrow-dir" && i + 1 < argc) {
+            arrow_dir = argv[++i];
+        } else if (arg == "--kafka-brokers" && i + 1 < argc) {
+            kafka_brokers = argv[++i];
+        } else if (arg == "--kafka-topic" && i + 1 < argc) {
+            kafka_topic = argv[++i];
+        } else if (arg == "--grpc-events" && i + 1 < argc) {
+            grpc_events_address = argv[++i];
+        } else if (arg == "--grpc-query" && i + 1 < argc) {
+            grpc_query_address = argv[++i];
+        } else if (arg == "--event-detail" && i + 1 < argc) {
+            std::string detail = argv[++i];
+            if (detail == "ies") {
+                event_detail = s1see::decode::DecodeLevel::IE_TABLE;
+            } else if (detail == "tree") {
+                event_detail = s1see::decode::DecodeLevel::FULL_TREE;
+            } else if (detail != "none") {
+                std::cerr << "Unknown --event-detail " << detail << " (none, ies or tree)" << std::endl;
+                return 1;
+            }
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    
+    if (positional.size() > 0) {
+        spool_dir = positional[0];
+    }
+    if (positional.size() > 1) {
+        ruleset_file = positional[1];
     }
-    if (argc > 2) {
-        ruleset_file = argv[2];
+    if (positional.size() > 2) {
+        output_file = positional[2];
     }
-    if (argc > 3) {
-        output_file = argv[3];
+    if (positional.size() > 3) {
+        continuous = (positional[3] == "true" || positional[3] == "1");
     }
-    if (argc > 4) {
-        continuous = (std::string(argv[4]) == "true" || std::string(argv[4]) == "1");
+    size_t worker_threads = 0;
+    if (positional.size() > 4) {
+        worker_threads = std::stoul(positional[4]);
+    }
+    
+    bool replay = replay_from_ns > 0 || replay_to_ns > 0;
+    if (replay && !group_given) {
+        // Never move the live processor's offsets
+        consumer_group = "replay";
     }
     
     std::cout << "S1-SEE Processor" << std::endl;
     std::cout << "Spool directory: " << spool_dir << std::endl;
     std::cout << "Ruleset: " << ruleset_file << std::endl;
     std::cout << "Output: " << output_file << std::endl;
+    std::cout << "Consumer group: " << consumer_group << " over " << spool_partitions << " partitions"
+              << (group_membership ? " (shared with other members)" : "") << std::endl;
+    if (replay) {
+        std::cout << "Replaying capture times [" << std::to_string(replay_from_ns / 1e9) << ", "
+                  << (replay_to_ns > 0 ? std::to_string(replay_to_ns / 1e9) : std::string("end")) << ")"
+                  << std::endl;
+    }
+    if (!arrow_dir.empty()) {
+        std::cout << "Arrow output: " << arrow_dir << std::endl;
+    }
+    if (!kafka_brokers.empty()) {
+        std::cout << "Kafka output: " << kafka_topic << " on " << kafka_brokers << std::endl;
+    }
+    if (!grpc_events_address.empty()) {
+        std::cout << "gRPC event stream: " << grpc_events_address << std::endl;
+    }
+    if (!grpc_query_address.empty()) {
+        std::cout << "gRPC UE queries: " << grpc_query_address << std::endl;
+    }
     
     // Setup pipeline
     s1see::processor::Pipeline::Config config;
     config.spool_base_dir = spool_dir;
-    config.spool_partitions = 1;
-    config.consumer_group = "processor";
+    config.spool_partitions = spool_partitions;
+    config.consumer_group = consumer_group;
+    config.group_membership = group_membership;
+    config.member_id = member_id;
+    config.lease_duration = lease_duration;
+    config.replay_from_ns = replay_from_ns;
+    config.replay_to_ns = replay_to_ns;
+    // A replay runs far faster than it was captured; only capture time
+    // gives its windows and expiry the live result
+    config.event_time = event_time || replay;
+    config.batch_arena = true;
+    if (worker_threads > 0) {
+        config.parallel = true;
+        config.worker_threads = worker_threads;
+        config.num_shards = worker_threads;
+        std::cout << "Parallel mode: " << worker_threads << " workers/shards" << std::endl;
+    }
     g_pipeline = std::make_unique<s1see::processor::Pipeline>(config);
     
     // Load ruleset
@@ -72,11 +201,107 @@ int main(int argc, char** argv) {
         return 1;
     }
     
-    // Setup sinks
-    auto stdout_sink = std::make_shared<s1see::sinks::StdoutSink>();
-    auto jsonl_sink = std::make_shared<s1see::sinks::JSONLSink>(output_file);
-    g_pipeline->add_sink(stdout_sink);
-    g_pipeline->add_sink(jsonl_sink);
+    // Hot reload: each good version of the file replaces the rules between
+    // batches, keeping UE contexts and the sequences of unchanged rules
+    std::unique_ptr<s1see::rules::RulesetWatcher> ruleset_watcher;
+    if (watch_rules) {
+        s1see::rules::RulesetWatcher::Config watch_config;
+        watch_config.path = ruleset_file;
+        ruleset_watcher = std::make_unique<s1see::rules::RulesetWatcher>(
+            watch_config, [](const s1see::rules::Ruleset& ruleset) {
+                g_pipeline->reload_rulesets({ruleset});
+                std::cout << "Reloaded ruleset: " << ruleset.id << " v" << ruleset.version << std::endl;
+            });
+        ruleset_watcher->start();
+        std::cout << "Watching " << ruleset_file << " for changes" << std::endl;
+    }
+    
+    // Setup sinks. Each is written from its own thread so a slow terminal
+    // or disk does not stall processing; the files, Kafka and gRPC must not
+    // lose events, while stdout drops the oldest when it falls behind.
+    // Spool offsets are committed once every lossless sink has delivered.
+    using NamedSink = std::pair<std::string, std::shared_ptr<s1see::sinks::AsyncSink>>;
+    std::vector<NamedSink> sinks;
+    s1see::sinks::AsyncSink::Config stdout_config;
+    stdout_config.overflow = s1see::sinks::AsyncSink::OverflowPolicy::DROP_OLDEST;
+    sinks.emplace_back("stdout", std::make_shared<s1see::sinks::AsyncSink>(
+        std::make_shared<s1see::sinks::StdoutSink>(), stdout_config));
+    sinks.emplace_back("jsonl", std::make_shared<s1see::sinks::AsyncSink>(
+        std::make_shared<s1see::sinks::JSONLSink>(output_file, 1 << 20, event_detail)));
+    if (!arrow_dir.empty()) {
+        s1see::sinks::ArrowSink::Config arrow_config;
+        arrow_config.directory = arrow_dir;
+        try {
+            sinks.emplace_back("arrow", std::make_shared<s1see::sinks::AsyncSink>(
+                std::make_shared<s1see::sinks::ArrowSink>(arrow_config)));
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to create Arrow sink: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    if (!kafka_brokers.empty()) {
+        s1see::sinks::KafkaSink::Config kafka_config;
+        kafka_config.brokers = kafka_brokers;
+        kafka_config.topic = kafka_topic;
+        auto kafka = std::make_shared<s1see::sinks::KafkaSink>(kafka_config);
+        if (!kafka->start()) {
+            std::cerr << "Failed to start Kafka sink" << std::endl;
+            return 1;
+        }
+        sinks.emplace_back("kafka", std::make_shared<s1see::sinks::AsyncSink>(kafka));
+    }
+    if (!grpc_events_address.empty()) {
+        s1see::sinks::GrpcEventSink::Config grpc_config;
+        grpc_config.listen_address = grpc_events_address;
+        auto grpc_events = std::make_shared<s1see::sinks::GrpcEventSink>(grpc_config);
+        if (!grpc_events->start()) {
+            std::cerr << "Failed to start gRPC event stream" << std::endl;
+            return 1;
+        }
+        sinks.emplace_back("grpc", std::make_shared<s1see::sinks::AsyncSink>(grpc_events));
+    }
+    for (const auto& [name, sink] : sinks) {
+        g_pipeline->add_sink(sink);
+    }
+    
+    // Metrics: pipeline stages and state gauges, plus sink queues read at
+    // scrape time
+    auto registry = std::make_shared<s1see::metrics::MetricsRegistry>();
+    g_pipeline->set_metrics(registry);
+    std::unique_ptr<s1see::metrics::MetricsServer> metrics_server;
+    if (metrics_config.port != 0) {
+        metrics_server = std::make_unique<s1see::metrics::MetricsServer>(registry, metrics_config);
+        metrics_server->set_collect_hook([registry, sinks] {
+            for (const auto& [name, sink] : sinks) {
+                auto stats = sink->stats();
+                s1see::metrics::Labels labels = {{"sink", name}};
+                registry->gauge("s1see_sink_queue_depth", "Events queued in memory by an async sink", labels)
+                    .set(static_cast<double>(stats.queue_depth));
+                registry->gauge("s1see_sink_spill_depth", "Events waiting in an async sink's spill file", labels)
+                    .set(static_cast<double>(stats.spill_depth));
+                registry->gauge("s1see_sink_emitted_events", "Events written by an async sink", labels)
+                    .set(static_cast<double>(stats.emitted));
+                registry->gauge("s1see_sink_dropped_events", "Events dropped by an async sink", labels)
+                    .set(static_cast<double>(stats.dropped));
+            }
+        });
+        if (metrics_server->start()) {
+            std::cout << "Metrics: http://" << metrics_config.bind_address << ":" << metrics_server->port()
+                      << metrics_config.path << std::endl;
+        }
+    }
+    
+    // UE queries read the shards' published contexts from gRPC's threads
+    std::unique_ptr<s1see::processor::GrpcUeQueryService> query_service;
+    if (!grpc_query_address.empty()) {
+        s1see::processor::GrpcUeQueryService::Config query_config;
+        query_config.listen_address = grpc_query_address;
+        query_service = std::make_unique<s1see::processor::GrpcUeQueryService>(*g_pipeline, query_config);
+        if (!query_service->start()) {
+            std::cerr << "Failed to start gRPC UE query service" << std::endl;
+            return 1;
+        }
+    }
     
     // Setup signal handlers
     signal(SIGINT, signal_handler);
@@ -84,14 +309,28 @@ int main(int argc, char** argv) {
     
     std::cout << "Processor running. Processing messages..." << std::endl;
     
-    if (continuous) {
+    if (replay) {
+        // Full speed to the end of the range, then stop
+        while (g_running && !g_pipeline->replay_done()) {
+            int events = g_pipeline->process_batch();
+            if (events > 0) {
+                std::cout << "Emitted " << events << " events" << std::endl;
+            }
+            if (events == 0 && !g_pipeline->replay_done()) {
+                // Commits waiting on sinks have paused reading
+                g_pipeline->wait_for_data(std::chrono::milliseconds(50));
+            }
+        }
+    } else if (continuous) {
         // Run continuously
         while (g_running) {
             int events = g_pipeline->process_batch();
             if (events > 0) {
                 std::cout << "Emitted " << events << " events" << std::endl;
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            // Wake as soon as the spooler appends; the timeout only bounds
+            // how long a shutdown signal can go unnoticed
+            g_pipeline->wait_for_data(std::chrono::milliseconds(200));
         }
     } else {
         // Process one batch
@@ -99,14 +338,31 @@ int main(int argc, char** argv) {
         std::cout << "Emitted " << events << " events" << std::endl;
     }
     
-    // Flush sinks
-    stdout_sink->flush();
-    jsonl_sink->flush();
-    jsonl_sink->close();
+    if (ruleset_watcher) {
+        ruleset_watcher->stop();
+    }
+    if (query_service) {
+        query_service->stop();
+    }
+    
+    // Drain and close sinks; the Arrow sink writes out its open file and
+    // Kafka waits for outstanding acks. Then commit what was delivered.
+    for (const auto& [name, sink] : sinks) {
+        sink->close();
+    }
+    if (size_t pending = g_pipeline->commit_delivered()) {
+        std::cout << pending << " batches not delivered; they are replayed on restart" << std::endl;
+    }
+    for (const auto& [name, sink] : sinks) {
+        auto stats = sink->stats();
+        std::cout << "Sink " << name << ": " << stats.emitted << " emitted, "
+                  << stats.dropped << " dropped, " << stats.failed << " failed" << std::endl;
+    }
     
     // Dump UE records on exit
     std::cout << "\nDumping UE records..." << std::endl;
     g_pipeline->dump_ue_records(std::cout);
+    g_pipeline->dump_memory_usage(std::cout);
     
     return 0;
 }
@@ -11,12 +11,17 @@
  */
 
 #include "s1see/ingest/grpc_adapter.h"
+#include "s1see/metrics/metrics_server.h"
 #include "s1see/spool/spool.h"
+#include <cstdlib>
 #include <iostream>
 #include <signal.h>
 #include <memory>
+#include <algorithm>
 #include <thread>
 #include <chrono>
+#include <string>
+#include <vector>
 
 std::unique_ptr<s1see::ingest::GrpcIngestAdapter> g_adapter;
 
@@ -30,25 +35,86 @@ void signal_handler(int sig) {
 int main(int argc, char** argv) {
     std::string listen_address = "0.0.0.0:50051";
     std::string spool_dir = "spool_data";
+    s1see::metrics::MetricsServer::Config metrics_config;
+    metrics_config.port = 9464;
+    auto compression = s1see::spool::SegmentCompression::NONE;
+    int32_t num_partitions = 1;
+    std::shared_ptr<const s1see::spool::Partitioner> partitioner;  // Null: round-robin per stream
     
-    if (argc > 1) {
-        listen_address = argv[1];
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--metrics-port" && i + 1 < argc) {
+            metrics_config.port = static_cast<uint16_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--partitions" && i + 1 < argc) {
+            num_partitions = std::max(std::atoi(argv[++i]), 1);
+        } else if (arg == "--partition-by" && i + 1 < argc) {
+            auto parsed = s1see::spool::parse_partitioning(argv[++i]);
+            if (!parsed) {
+                std::cerr << "Unknown --partition-by: " << argv[i] << " (source, ue or sctp)" << std::endl;
+                return 1;
+            }
+            partitioner = s1see::spool::make_partitioner(*parsed);
+        } else if (arg == "--compress" && i + 1 < argc) {
+            std::string codec = argv[++i];
+            if (codec == "zlib") {
+                compression = s1see::spool::SegmentCompression::ZLIB;
+            } else if (codec == "zstd") {
+                compression = s1see::spool::SegmentCompression::ZSTD;
+            } else if (codec != "none") {
+                std::cerr << "Unknown --compress codec: " << codec << " (none, zlib or zstd)" << std::endl;
+                return 1;
+            }
+        } else {
+            positional.push_back(arg);
+        }
     }
-    if (argc > 2) {
-        spool_dir = argv[2];
+    if (positional.size() > 0) {
+        listen_address = positional[0];
+    }
+    if (positional.size() > 1) {
+        spool_dir = positional[1];
     }
     
     std::cout << "S1-SEE Spooler Daemon" << std::endl;
     std::cout << "Listening on: " << listen_address << std::endl;
-    std::cout << "Spool directory: " << spool_dir << std::endl;
+    std::cout << "Spool directory: " << spool_dir << " (" << num_partitions << " partitions)" << std::endl;
     
     // Setup spool
     s1see::spool::WALLog::Config spool_config;
     spool_config.base_dir = spool_dir;
-    spool_config.num_partitions = 1;
+    spool_config.num_partitions = num_partitions;  // Ingest streams are spread over them
+    spool_config.partitioner = partitioner;
     spool_config.fsync_on_append = true;
+    spool_config.group_commit = true;  // Acks wait for fdatasync; concurrent streams share syncs
+    spool_config.recover_segments = true;  // Repair a tail torn by a crash before appending
+    spool_config.visible_on_append = true;  // Processors in other processes see records immediately
+    spool_config.compression = compression;  // Sealed segments only; the tail stays raw
+    spool_config.retention_thread = true;  // Enforce retention limits, keeping what processors have not committed
     auto spool = std::make_shared<s1see::spool::Spool>(spool_config);
     
+    // Metrics: append counters and latency from the spool, plus per-partition
+    // high-water marks and segment counts read at scrape time
+    auto registry = std::make_shared<s1see::metrics::MetricsRegistry>();
+    spool->set_metrics(registry);
+    std::unique_ptr<s1see::metrics::MetricsServer> metrics_server;
+    if (metrics_config.port != 0) {
+        metrics_server = std::make_unique<s1see::metrics::MetricsServer>(registry, metrics_config);
+        metrics_server->set_collect_hook([spool, registry] {
+            for (int32_t p = 0; p < spool->num_partitions(); ++p) {
+                s1see::metrics::Labels labels = {{"partition", std::to_string(p)}};
+                registry->gauge("s1see_spool_high_water_mark", "Last offset written, per partition", labels)
+                    .set(static_cast<double>(spool->get_high_water_mark(p)));
+                registry->gauge("s1see_wal_segments", "WAL segments on disk, per partition", labels)
+                    .set(static_cast<double>(spool->segment_count(p)));
+            }
+        });
+        if (metrics_server->start()) {
+            std::cout << "Metrics: http://" << metrics_config.bind_address << ":" << metrics_server->port()
+                      << metrics_config.path << std::endl;
+        }
+    }
+    
     // Setup gRPC adapter
     g_adapter = std::make_unique<s1see::ingest::GrpcIngestAdapter>(listen_address);
     g_adapter->set_spool(spool);
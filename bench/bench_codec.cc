@@ -0,0 +1,114 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: bench_codec.cc
+ * Description: Hex and TBCD codec benchmarks at identifier (8 bytes) and
+ *              IE (64 and 1024 bytes) sizes, each beside the ostringstream
+ *              or per-digit loop the call sites used before.
+ */
+
+#include "s1see/utils/codec.h"
+#include <benchmark/benchmark.h>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace s1see;
+
+std::vector<uint8_t> make_bytes(size_t size) {
+    std::vector<uint8_t> bytes(size);
+    for (size_t i = 0; i < size; ++i) {
+        bytes[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+    return bytes;
+}
+
+void BM_HexEncodeStream(benchmark::State& state) {
+    auto bytes = make_bytes(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        std::ostringstream hex;
+        hex << std::hex << std::setfill('0');
+        for (uint8_t byte : bytes) {
+            hex << std::setw(2) << static_cast<int>(byte);
+        }
+        benchmark::DoNotOptimize(hex.str());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HexEncodeStream)->ArgName("bytes")->Arg(8)->Arg(64)->Arg(1024);
+
+void BM_HexEncode(benchmark::State& state) {
+    auto bytes = make_bytes(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(utils::to_hex(bytes));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    state.SetLabel(utils::codec_instruction_set());
+}
+BENCHMARK(BM_HexEncode)->ArgName("bytes")->Arg(8)->Arg(64)->Arg(1024);
+
+void BM_HexDecodeStoul(benchmark::State& state) {
+    std::string hex = utils::to_hex(make_bytes(static_cast<size_t>(state.range(0))));
+    for (auto _ : state) {
+        std::vector<uint8_t> bytes;
+        for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+            bytes.push_back(static_cast<uint8_t>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+        }
+        benchmark::DoNotOptimize(bytes);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HexDecodeStoul)->ArgName("bytes")->Arg(8)->Arg(64)->Arg(1024);
+
+void BM_HexDecode(benchmark::State& state) {
+    std::string hex = utils::to_hex(make_bytes(static_cast<size_t>(state.range(0))));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(utils::from_hex(hex));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    state.SetLabel(utils::codec_instruction_set());
+}
+BENCHMARK(BM_HexDecode)->ArgName("bytes")->Arg(8)->Arg(64)->Arg(1024);
+
+// IMSI-sized TBCD (15 digits and the filler), then a long digit run
+std::vector<uint8_t> make_tbcd(size_t size) {
+    std::vector<uint8_t> bytes(size);
+    for (size_t i = 0; i < size; ++i) {
+        bytes[i] = static_cast<uint8_t>((i * 3 % 10) | ((i * 7 + 1) % 10) << 4);
+    }
+    bytes.back() |= 0xf0;
+    return bytes;
+}
+
+void BM_TbcdDecodeLoop(benchmark::State& state) {
+    auto bytes = make_tbcd(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        std::string digits;
+        for (uint8_t byte : bytes) {
+            if ((byte & 0x0f) > 9) break;
+            digits.push_back(static_cast<char>('0' + (byte & 0x0f)));
+            if ((byte >> 4) > 9) break;
+            digits.push_back(static_cast<char>('0' + (byte >> 4)));
+        }
+        benchmark::DoNotOptimize(digits);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TbcdDecodeLoop)->ArgName("bytes")->Arg(8)->Arg(64)->Arg(1024);
+
+void BM_TbcdDecode(benchmark::State& state) {
+    auto bytes = make_tbcd(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(utils::tbcd_to_string(bytes));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    state.SetLabel(utils::codec_instruction_set());
+}
+BENCHMARK(BM_TbcdDecode)->ArgName("bytes")->Arg(8)->Arg(64)->Arg(1024);
+
+} // namespace
@@ -0,0 +1,71 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: bench_common.cc
+ * Description: Implementation of the shared benchmark fixtures.
+ */
+
+#include "bench_common.h"
+#include "s1see/utils/ue_traffic_model.h"
+#include <filesystem>
+#include <set>
+
+namespace fs = std::filesystem;
+
+namespace s1see {
+namespace bench {
+
+std::vector<TrafficPdu> generate_traffic(size_t num_ues, size_t num_enbs) {
+    utils::UeTrafficModel::Config config;
+    config.num_ues = num_ues;
+    config.num_enbs = num_enbs;
+    utils::UeTrafficModel model(config);
+    
+    std::vector<TrafficPdu> traffic;
+    size_t count = utils::UeTrafficModel::script_length() * num_ues;
+    traffic.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        utils::UeTrafficModel::Pdu pdu = model.next();
+        traffic.push_back({pdu.procedure, "enb-" + std::to_string(pdu.enb), std::move(pdu.bytes)});
+    }
+    return traffic;
+}
+
+const std::vector<TrafficPdu>& sample_pdus() {
+    static const std::vector<TrafficPdu> samples = [] {
+        std::vector<TrafficPdu> unique;
+        std::set<std::string> seen;
+        for (auto& pdu : generate_traffic(1, 2)) {
+            if (seen.insert(pdu.procedure).second) {
+                unique.push_back(std::move(pdu));
+            }
+        }
+        return unique;
+    }();
+    return samples;
+}
+
+SignalMessage to_signal_message(const TrafficPdu& pdu, int64_t sequence) {
+    static const int64_t base_ns = 1767484800LL * 1000000000LL;  // 2026-01-04T00:00:00Z
+    SignalMessage message;
+    message.set_ts_capture(base_ns + sequence * 1000000);
+    message.set_ts_ingest(message.ts_capture());
+    message.set_source_id(pdu.source_id);
+    message.set_source_sequence(sequence);
+    message.set_direction(SignalMessage::UPLINK);
+    message.set_payload_type(SignalMessage::RAW_BYTES);
+    message.set_raw_bytes(pdu.bytes.data(), pdu.bytes.size());
+    return message;
+}
+
+std::string scratch_dir(const std::string& name) {
+    fs::path dir = fs::temp_directory_path() / ("s1see_bench_" + name);
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    return dir.string();
+}
+
+} // namespace bench
+} // namespace s1see
@@ -0,0 +1,42 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: bench_common.h
+ * Description: Shared fixtures for the S1-SEE benchmarks: S1AP traffic for
+ *              a simulated UE population and scratch directories.
+ */
+
+#pragma once
+
+#include "s1see/utils/s1ap_builder.h"
+#include "signal_message.pb.h"
+#include <string>
+#include <vector>
+
+namespace s1see {
+namespace bench {
+
+struct TrafficPdu {
+    std::string procedure;  // Builder message, e.g. "initial_context_setup_request"
+    std::string source_id;  // eNB the PDU was exchanged with
+    utils::S1apBuilder::Bytes bytes;
+};
+
+// One pass of the UeTrafficModel script for num_ues UEs spread over
+// num_enbs eNBs: attach, service request, S1 and X2 handover, TAU and
+// releases, interleaved step by step as on a live S1-MME link.
+std::vector<TrafficPdu> generate_traffic(size_t num_ues, size_t num_enbs);
+
+// One PDU per builder message, in first-seen order
+const std::vector<TrafficPdu>& sample_pdus();
+
+// SignalMessage carrying a traffic PDU, captured 1 ms after the previous one
+SignalMessage to_signal_message(const TrafficPdu& pdu, int64_t sequence);
+
+// Fresh, empty directory under the system temp directory
+std::string scratch_dir(const std::string& name);
+
+} // namespace bench
+} // namespace s1see
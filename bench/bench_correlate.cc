@@ -0,0 +1,41 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: bench_correlate.cc
+ * Description: S1apUeCorrelator::processS1apFrame benchmark over the
+ *              interleaved signalling of a simulated UE population.
+ */
+
+#include "bench_common.h"
+#include "s1ap_parser.h"
+#include "s1ap_ue_correlator.h"
+#include <benchmark/benchmark.h>
+
+namespace {
+
+using namespace s1see;
+
+void BM_S1apUeCorrelator(benchmark::State& state) {
+    auto traffic = bench::generate_traffic(static_cast<size_t>(state.range(0)), 64);
+    std::vector<s1ap_parser::S1apParseResult> frames;
+    frames.reserve(traffic.size());
+    for (const auto& pdu : traffic) {
+        frames.push_back(s1ap_parser::parseS1apPdu(pdu.bytes.data(), pdu.bytes.size()));
+    }
+    
+    // Traffic is replayed in a loop; later rounds find every UE known
+    s1ap_correlator::S1apUeCorrelator correlator;
+    size_t i = 0;
+    uint32_t frame_no = 0;
+    for (auto _ : state) {
+        ++frame_no;
+        benchmark::DoNotOptimize(correlator.processS1apFrame(frame_no, frames[i], frame_no * 0.001));
+        i = (i + 1) % frames.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_S1apUeCorrelator)->ArgName("ues")->Arg(1000)->Arg(10000);
+
+} // namespace
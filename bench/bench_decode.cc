@@ -0,0 +1,73 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: bench_decode.cc
+ * Description: parseS1apPdu and RealS1APDecoder::decode benchmarks, one per
+ *              S1AP message of the simulated attach, handover, TAU and
+ *              release procedures.
+ */
+
+#include "bench_common.h"
+#include "s1see/decode/s1ap_decoder_wrapper.h"
+#include "s1ap_parser.h"
+#include "canonical_message.pb.h"
+#include <benchmark/benchmark.h>
+
+namespace {
+
+using namespace s1see;
+
+void BM_ParseS1apPdu(benchmark::State& state, const utils::S1apBuilder::Bytes& pdu) {
+    std::span<const uint8_t> bytes(pdu);
+    for (auto _ : state) {
+        auto result = s1ap_parser::parseS1apPdu(bytes);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(pdu.size()));
+}
+
+// Decoder options as the pipeline runs them: no raw byte copy, no JSON tree
+void BM_RealS1APDecoder(benchmark::State& state, const utils::S1apBuilder::Bytes& pdu) {
+    decode::RealS1APDecoder decoder;
+    decode::S1APDecoderWrapper::Options options;
+    options.embed_raw_bytes = false;
+    options.level = decode::DecodeLevel::IDENTIFIERS;
+    std::span<const uint8_t> bytes(pdu);
+    for (auto _ : state) {
+        CanonicalMessage canonical;
+        decode::DecodedTree tree;
+        benchmark::DoNotOptimize(decoder.decode(bytes, canonical, tree, options));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(pdu.size()));
+}
+
+// Same with the JSON decoded tree rendered, as for rules reading it
+void BM_RealS1APDecoderTree(benchmark::State& state, const utils::S1apBuilder::Bytes& pdu) {
+    decode::RealS1APDecoder decoder;
+    std::span<const uint8_t> bytes(pdu);
+    for (auto _ : state) {
+        CanonicalMessage canonical;
+        decode::DecodedTree tree;
+        benchmark::DoNotOptimize(decoder.decode(bytes, canonical, tree, decode::S1APDecoderWrapper::Options()));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+const bool registered = [] {
+    for (const auto& sample : bench::sample_pdus()) {
+        const auto& pdu = sample.bytes;
+        benchmark::RegisterBenchmark(("BM_ParseS1apPdu/" + sample.procedure).c_str(),
+                                     [&pdu](benchmark::State& state) { BM_ParseS1apPdu(state, pdu); });
+        benchmark::RegisterBenchmark(("BM_RealS1APDecoder/" + sample.procedure).c_str(),
+                                     [&pdu](benchmark::State& state) { BM_RealS1APDecoder(state, pdu); });
+        benchmark::RegisterBenchmark(("BM_RealS1APDecoderTree/" + sample.procedure).c_str(),
+                                     [&pdu](benchmark::State& state) { BM_RealS1APDecoderTree(state, pdu); });
+    }
+    return true;
+}();
+
+} // namespace
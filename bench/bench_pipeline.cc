@@ -0,0 +1,176 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: bench_pipeline.cc
+ * Description: End-to-end Pipeline::process_batch benchmark. Each iteration
+ *              replays a recorded spool through decode, correlation, rules
+ *              and a sink, reporting msgs/s and p50/p99 per-message latency.
+ *              Set S1SEE_BENCH_SPOOL (and S1SEE_BENCH_PARTITIONS) to replay
+ *              an existing spool, e.g. one written by s1see_pcap_loader;
+ *              consumer offsets for groups "bench-<pid>-<n>" are written into it.
+ */
+
+#include "bench_common.h"
+#include "s1see/decode/s1ap_decoder_wrapper.h"
+#include "s1see/processor/pipeline.h"
+#include "s1see/spool/spool.h"
+#include "canonical_message.pb.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <set>
+#include <unistd.h>
+
+namespace {
+
+using namespace s1see;
+
+struct RecordedSpool {
+    std::string dir;
+    int32_t partitions = 1;
+    int64_t records = 0;
+    std::vector<std::string> msg_types;
+};
+
+// The spool is recorded once: 500 simulated UEs over 64 eNBs unless
+// S1SEE_BENCH_SPOOL names one
+const RecordedSpool& recorded_spool() {
+    static const RecordedSpool recorded = [] {
+        RecordedSpool spool_info;
+        spool::WALLog::Config config;
+        if (const char* dir = std::getenv("S1SEE_BENCH_SPOOL")) {
+            spool_info.dir = dir;
+            const char* partitions = std::getenv("S1SEE_BENCH_PARTITIONS");
+            spool_info.partitions = partitions ? std::max(std::atoi(partitions), 1) : 1;
+        } else {
+            spool_info.dir = bench::scratch_dir("pipeline_spool");
+            spool_info.partitions = 4;
+        }
+        config.base_dir = spool_info.dir;
+        config.num_partitions = spool_info.partitions;
+        config.fsync_on_append = false;
+        spool::Spool spool(config);
+        
+        if (!std::getenv("S1SEE_BENCH_SPOOL")) {
+            auto traffic = bench::generate_traffic(500, 64);
+            std::vector<SignalMessage> messages;
+            for (size_t i = 0; i < traffic.size(); ++i) {
+                messages.push_back(bench::to_signal_message(traffic[i], static_cast<int64_t>(i)));
+            }
+            spool.append_batch(messages);
+            spool.flush();
+        }
+        
+        // Message types present, so the bench ruleset emits one event per message
+        decode::RealS1APDecoder decoder;
+        decode::S1APDecoderWrapper::Options options;
+        options.embed_raw_bytes = false;
+        options.level = decode::DecodeLevel::IDENTIFIERS;
+        std::set<std::string> msg_types;
+        for (int32_t p = 0; p < spool_info.partitions; ++p) {
+            int64_t high_water = spool.get_high_water_mark(p);
+            spool_info.records += high_water + 1;
+            for (int64_t offset = 0; offset <= high_water;) {
+                auto records = spool.read(p, offset, 1000);
+                if (records.empty()) break;
+                for (const auto& record : records) {
+                    const std::string& raw = record.message().raw_bytes();
+                    CanonicalMessage canonical;
+                    decode::DecodedTree tree;
+                    decoder.decode(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(raw.data()), raw.size()),
+                                   canonical, tree, options);
+                    msg_types.insert(canonical.msg_type());
+                }
+                offset = records.back().offset() + 1;
+            }
+        }
+        spool_info.msg_types.assign(msg_types.begin(), msg_types.end());
+        return spool_info;
+    }();
+    return recorded;
+}
+
+// Records the emit time of every event
+class LatencySink : public sinks::Sink {
+public:
+    bool emit(const Event&) override {
+        int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        std::lock_guard<std::mutex> lock(mutex_);
+        emit_ns.push_back(now);
+        return true;
+    }
+    std::vector<int64_t> emit_ns;
+private:
+    std::mutex mutex_;
+};
+
+double percentile(std::vector<int64_t>& samples, double fraction) {
+    if (samples.empty()) return 0.0;
+    size_t rank = std::min(samples.size() - 1, static_cast<size_t>(fraction * static_cast<double>(samples.size())));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(rank), samples.end());
+    return static_cast<double>(samples[rank]);
+}
+
+// Latency of a message is the time from the start of the process_batch
+// call that reads it to its event reaching the sink, so it includes
+// waiting behind earlier records of the same batch
+void BM_PipelineReplay(benchmark::State& state) {
+    const RecordedSpool& recorded = recorded_spool();
+    rules::Ruleset ruleset;
+    ruleset.id = "bench";
+    ruleset.version = "1.0";
+    for (const auto& msg_type : recorded.msg_types) {
+        rules::SingleMessageRule rule;
+        rule.event_name = "Bench." + msg_type;
+        rule.msg_type_pattern = msg_type;
+        rule.event_data = {{"imsi", "context.imsi"}, {"cell_id", "message.ecgi"}};
+        ruleset.single_message_rules.push_back(rule);
+    }
+    
+    static int run = 0;
+    std::vector<int64_t> latencies_ns;
+    int64_t messages = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        processor::Pipeline::Config config;
+        config.spool_base_dir = recorded.dir;
+        config.spool_partitions = recorded.partitions;
+        config.consumer_group = "bench-" + std::to_string(getpid()) + "-" + std::to_string(++run);
+        config.embed_raw_bytes = false;
+        config.parallel = state.range(1) != 0;
+        processor::Pipeline pipeline(config);
+        pipeline.set_decoder(std::make_unique<decode::RealS1APDecoder>());
+        pipeline.load_ruleset(ruleset);
+        auto sink = std::make_shared<LatencySink>();
+        pipeline.add_sink(sink);
+        state.ResumeTiming();
+        
+        while (pipeline.wait_for_data(std::chrono::milliseconds(0))) {
+            size_t first_event = sink->emit_ns.size();
+            int64_t start = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            pipeline.process_batch(state.range(0));
+            for (size_t i = first_event; i < sink->emit_ns.size(); ++i) {
+                latencies_ns.push_back(sink->emit_ns[i] - start);
+            }
+        }
+        messages += recorded.records;
+    }
+    
+    state.SetItemsProcessed(messages);
+    state.counters["msgs_per_s"] = benchmark::Counter(static_cast<double>(messages), benchmark::Counter::kIsRate);
+    state.counters["p50_us"] = percentile(latencies_ns, 0.50) / 1000.0;
+    state.counters["p99_us"] = percentile(latencies_ns, 0.99) / 1000.0;
+}
+BENCHMARK(BM_PipelineReplay)
+    ->ArgNames({"batch", "parallel"})
+    ->ArgsProduct({{100, 1000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+} // namespace
@@ -0,0 +1,91 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: bench_rules.cc
+ * Description: RuleEngine::process benchmark with 10, 100 and 1000 loaded
+ *              rules over decoded simulated traffic.
+ */
+
+#include "bench_common.h"
+#include "s1see/correlate/correlator.h"
+#include "s1see/decode/s1ap_decoder_wrapper.h"
+#include "s1see/rules/rule_engine.h"
+#include "canonical_message.pb.h"
+#include <benchmark/benchmark.h>
+#include <set>
+
+namespace {
+
+using namespace s1see;
+
+struct DecodedMessage {
+    CanonicalMessage canonical;
+    decode::DecodedTree tree;
+};
+
+// Rule i targets the i-th message type round-robin, so every rule can
+// fire; one in ten is a sequence rule opened by that type and closed by
+// HandoverNotify
+rules::Ruleset make_ruleset(size_t num_rules, const std::vector<std::string>& msg_types) {
+    rules::Ruleset ruleset;
+    ruleset.id = "bench";
+    ruleset.version = "1.0";
+    for (size_t i = 0; i < num_rules; ++i) {
+        const std::string& msg_type = msg_types[i % msg_types.size()];
+        if (i % 10 == 9) {
+            rules::SequenceRule rule;
+            rule.event_name = "Bench.Sequence." + std::to_string(i);
+            rule.first_msg_type = msg_type;
+            rule.second_msg_type = "HandoverNotify";
+            rule.time_window = std::chrono::milliseconds(5000);
+            rule.event_data = {{"target_cell_id", "message.ecgi"}};
+            ruleset.sequence_rules.push_back(rule);
+        } else {
+            rules::SingleMessageRule rule;
+            rule.event_name = "Bench.Single." + std::to_string(i);
+            rule.msg_type_pattern = msg_type;
+            rule.attributes = {{"category", "bench"}};
+            rule.event_data = {{"imsi", "context.imsi"}, {"mme_ue_s1ap_id", "message.mme_ue_s1ap_id"}};
+            ruleset.single_message_rules.push_back(rule);
+        }
+    }
+    return ruleset;
+}
+
+void BM_RuleEngineProcess(benchmark::State& state) {
+    auto traffic = bench::generate_traffic(500, 16);
+    decode::RealS1APDecoder decoder;
+    decode::S1APDecoderWrapper::Options options;
+    options.level = decode::DecodeLevel::IDENTIFIERS;
+    std::vector<DecodedMessage> messages(traffic.size());
+    std::set<std::string> msg_types;
+    for (size_t i = 0; i < traffic.size(); ++i) {
+        SignalMessage signal = bench::to_signal_message(traffic[i], static_cast<int64_t>(i));
+        decoder.decode(std::span<const uint8_t>(traffic[i].bytes), messages[i].canonical, messages[i].tree, options);
+        messages[i].canonical.set_ts_capture(signal.ts_capture());
+        msg_types.insert(messages[i].canonical.msg_type());
+    }
+    
+    auto correlator = std::make_shared<correlate::Correlator>();
+    rules::RuleEngine engine(correlator);
+    engine.load_ruleset(make_ruleset(static_cast<size_t>(state.range(0)),
+                                     std::vector<std::string>(msg_types.begin(), msg_types.end())));
+    
+    size_t i = 0;
+    int64_t events = 0;
+    for (auto _ : state) {
+        const auto& message = messages[i];
+        auto emitted = engine.process(message.canonical,
+                                      message.tree.parse_result ? &*message.tree.parse_result : nullptr);
+        events += static_cast<int64_t>(emitted.size());
+        benchmark::DoNotOptimize(emitted);
+        i = (i + 1) % messages.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["events_per_msg"] = static_cast<double>(events) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_RuleEngineProcess)->ArgName("rules")->Arg(10)->Arg(100)->Arg(1000);
+
+} // namespace
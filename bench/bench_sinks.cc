@@ -0,0 +1,61 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: bench_sinks.cc
+ * Description: JSONLSink::emit benchmark across write buffer sizes.
+ */
+
+#include "bench_common.h"
+#include "s1see/sinks/jsonl_sink.h"
+#include "event.pb.h"
+#include <benchmark/benchmark.h>
+#include <filesystem>
+
+namespace {
+
+using namespace s1see;
+
+// Event shaped like the mobility ruleset's handover events
+Event make_event(int64_t i) {
+    Event event;
+    event.set_name("Mobility.Handover.Notified");
+    event.set_ts(1767484800LL * 1000000000LL + i * 1000000);
+    event.set_subscriber_key("imsi:00101" + std::to_string(1000000000 + i % 10000));
+    auto& attributes = *event.mutable_attributes();
+    attributes["category"] = "mobility";
+    attributes["action"] = "notified";
+    attributes["severity"] = "info";
+    attributes["source_cell_id"] = "00f1100001a2b3";
+    attributes["target_cell_id"] = "00f1100002b3c4";
+    event.set_confidence(1.0);
+    auto* offset = event.mutable_evidence()->add_offsets();
+    offset->set_partition(static_cast<int32_t>(i % 4));
+    offset->set_offset(i);
+    event.set_ruleset_id("mobility");
+    event.set_ruleset_version("1.0");
+    return event;
+}
+
+void BM_JSONLSinkEmit(benchmark::State& state) {
+    std::string dir = bench::scratch_dir("jsonl_sink");
+    std::vector<Event> events;
+    for (int64_t i = 0; i < 1024; ++i) {
+        events.push_back(make_event(i));
+    }
+    {
+        sinks::JSONLSink sink(dir + "/events.jsonl", static_cast<size_t>(state.range(0)));
+        size_t i = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(sink.emit(events[i++ % events.size()]));
+        }
+        sink.flush();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(std::filesystem::file_size(dir + "/events.jsonl")));
+    std::filesystem::remove_all(dir);
+}
+BENCHMARK(BM_JSONLSinkEmit)->ArgName("buffer_bytes")->Arg(0)->Arg(64 << 10)->Arg(1 << 20);
+
+} // namespace
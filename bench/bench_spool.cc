@@ -0,0 +1,91 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: bench_spool.cc
+ * Description: WALLog append and read benchmarks across partition counts,
+ *              with and without write buffering. fsync is off so the
+ *              numbers measure the log rather than the disk.
+ */
+
+#include "bench_common.h"
+#include "s1see/spool/wal_log.h"
+#include <benchmark/benchmark.h>
+#include <filesystem>
+
+namespace {
+
+using namespace s1see;
+
+spool::WALLog::Config wal_config(const std::string& dir, const benchmark::State& state) {
+    spool::WALLog::Config config;
+    config.base_dir = dir;
+    config.num_partitions = static_cast<int32_t>(state.range(0));
+    config.use_buffering = state.range(1) != 0;
+    config.fsync_on_append = false;
+    return config;
+}
+
+// Append path of the ingest adapters: one record at a time, spread over
+// partitions by source_id
+void BM_WALAppend(benchmark::State& state) {
+    std::string dir = bench::scratch_dir("wal_append");
+    auto traffic = bench::generate_traffic(64, 16);
+    std::vector<SignalMessage> messages;
+    for (size_t i = 0; i < traffic.size(); ++i) {
+        messages.push_back(bench::to_signal_message(traffic[i], static_cast<int64_t>(i)));
+    }
+    
+    int64_t bytes = 0;
+    {
+        spool::WALLog wal(wal_config(dir, state));
+        size_t i = 0;
+        for (auto _ : state) {
+            const SignalMessage& message = messages[i++ % messages.size()];
+            benchmark::DoNotOptimize(wal.append(message));
+            bytes += static_cast<int64_t>(message.raw_bytes().size());
+        }
+        wal.flush_all_segments();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(bytes);
+    std::filesystem::remove_all(dir);
+}
+BENCHMARK(BM_WALAppend)
+    ->ArgNames({"partitions", "buffered"})
+    ->ArgsProduct({{1, 4, 16}, {0, 1}});
+
+// Consumer read path: batches of 1000 records, cycling over the partitions
+void BM_WALRead(benchmark::State& state) {
+    std::string dir = bench::scratch_dir("wal_read");
+    spool::WALLog wal(wal_config(dir, state));
+    auto traffic = bench::generate_traffic(2000, 64);
+    for (size_t i = 0; i < traffic.size(); ++i) {
+        wal.append(bench::to_signal_message(traffic[i], static_cast<int64_t>(i)));
+    }
+    wal.flush_all_segments();
+    
+    int32_t partitions = wal.num_partitions();
+    std::vector<int64_t> next(partitions, 0);
+    int32_t p = 0;
+    int64_t records = 0;
+    for (auto _ : state) {
+        auto batch = wal.read(p, next[p], 1000);
+        if (batch.empty()) {
+            next[p] = 0;  // Wrap to the start of the partition
+        } else {
+            next[p] = batch.back().offset() + 1;
+            records += static_cast<int64_t>(batch.size());
+        }
+        benchmark::DoNotOptimize(batch);
+        p = (p + 1) % partitions;
+    }
+    state.SetItemsProcessed(records);
+    std::filesystem::remove_all(dir);
+}
+BENCHMARK(BM_WALRead)
+    ->ArgNames({"partitions", "buffered"})
+    ->ArgsProduct({{1, 4, 16}, {0, 1}});
+
+} // namespace
@@ -7,6 +7,7 @@ Each journey represents a sequence of cell site visits for a subscriber.
 """
 
 import json
+from pathlib import Path
 from typing import Dict, List, Optional, Tuple
 from datetime import datetime, timedelta
 from dataclasses import dataclass, asdict
@@ -200,6 +201,54 @@ def load_events_from_jsonl(file_path: str) -> List[Dict]:
     return events
 
 
+# Columns of S1-SEE Arrow files that are not attributes
+ARROW_EVENT_COLUMNS = ("name", "ts", "subscriber_key", "confidence",
+                       "ruleset_id", "ruleset_version", "attributes", "evidence")
+
+
+def load_events_from_arrow(path: str) -> List[Dict]:
+    """
+    Load events from S1-SEE Arrow files (s1see_processor --arrow-dir).
+
+    path may be one .arrow file or a directory of them. Rows are returned
+    in the same shape as the JSONL events. Requires pyarrow.
+    """
+    import pyarrow as pa  # Optional dependency
+    import pyarrow.feather as feather
+
+    p = Path(path)
+    files = sorted(p.glob("*.arrow")) if p.is_dir() else [p]
+    events = []
+    for file in files:
+        table = feather.read_table(str(file))
+        # Nanoseconds as in the JSONL output, rather than datetimes
+        ts_index = table.column_names.index("ts")
+        table = table.set_column(ts_index, "ts", table["ts"].cast(pa.int64()))
+        attribute_columns = [c for c in table.column_names if c not in ARROW_EVENT_COLUMNS]
+        for row in table.to_pylist():
+            attributes = {c: row[c] for c in attribute_columns if row[c] is not None}
+            attributes.update(dict(row["attributes"]))
+            events.append({
+                "name": row["name"],
+                "ts": row["ts"],
+                "subscriber_key": row["subscriber_key"],
+                "attributes": attributes,
+                "confidence": row["confidence"],
+                "evidence": {"offsets": row["evidence"]},
+                "ruleset_id": row["ruleset_id"],
+                "ruleset_version": row["ruleset_version"],
+            })
+    return events
+
+
+def load_events(path: str) -> List[Dict]:
+    """Load events from a JSONL file, an .arrow file or a directory of .arrow files."""
+    p = Path(path)
+    if p.is_dir() or p.suffix == ".arrow":
+        return load_events_from_arrow(path)
+    return load_events_from_jsonl(path)
+
+
 if __name__ == "__main__":
     # Example usage
     tracker = JourneyTracker()
@@ -17,7 +17,7 @@ from pathlib import Path
 sys.path.insert(0, str(Path(__file__).parent))
 
 from cell_site_db import CellSiteDB, init_sample_cell_sites
-from journey_tracker import JourneyTracker, load_events_from_jsonl
+from journey_tracker import JourneyTracker, load_events
 from aggregator import JourneyAggregator
 from map_visualizer import MapVisualizer
 
@@ -31,7 +31,7 @@ def process_events(events_file: str, cell_db: CellSiteDB,
         Tuple of (journey_tracker, completed_journeys)
     """
     print(f"Loading events from {events_file}...")
-    events = load_events_from_jsonl(events_file)
+    events = load_events(events_file)
     print(f"Loaded {len(events)} events")
     
     # Initialize journey tracker
@@ -114,7 +114,7 @@ def main():
     parser.add_argument(
         "--events",
         required=True,
-        help="Path to JSONL file containing S1-SEE events"
+        help="Path to JSONL file, .arrow file or directory of .arrow files containing S1-SEE events"
     )
     parser.add_argument(
         "--output",
@@ -13,13 +13,19 @@
 #pragma once
 
 #include "s1see/correlate/ue_context.h"
+#include "s1see/snapshot/snapshot.h"
+#include "s1see/utils/block_pool.h"
+#include "s1see/utils/expiry_queue.h"
 #include "canonical_message.pb.h"
+#include <array>
 #include <memory>
+#include <set>
 #include <unordered_map>
 #include <string>
 #include <chrono>
 #include <shared_mutex>
 #include <cstdint>
+#include <vector>
 
 // Include S1apUeCorrelator (full definition needed for unique_ptr)
 #include "s1ap_ue_correlator.h"
@@ -27,45 +33,149 @@
 namespace s1see {
 namespace correlate {
 
+// Identifier a UE query resolves through the S1apUeCorrelator indexes
+struct UeLookup {
+    enum class Kind { IMSI, TMSI, TEID, MME_UE_S1AP_ID };
+    Kind kind = Kind::IMSI;
+    std::string identifier; // IMSI or TMSI digits
+    uint32_t value = 0;     // TEID or MME-UE-S1AP-ID
+};
+
 // UE Context Correlator
 class Correlator {
 public:
     struct Config {
         Config() : context_expiry(std::chrono::seconds(300)) {}
         std::chrono::seconds context_expiry; // 5 minutes default
+        
+        // Event time: last_seen and expiry follow message ts_capture.
+        // Processing time (the default): the wall clock, as for a live feed.
+        bool event_time = false;
     };
     
     explicit Correlator(const Config& config = Config());
     
     // Get or create UE context for a message
-    // Returns subscriber_key for the context
-    std::string get_or_create_context(const CanonicalMessage& message);
+    // Returns the context's ID, or 0 if the message cannot be correlated.
+    // parse_result is the decoder's native result for the message; when null
+    // it is rebuilt from the message's decoded_tree JSON and ID fields.
+    SubscriberId get_or_create_subscriber(const CanonicalMessage& message,
+                                          const s1ap_parser::S1apParseResult* parse_result = nullptr);
+    
+    // As get_or_create_subscriber, returning the rendered subscriber key
+    std::string get_or_create_context(const CanonicalMessage& message,
+                                      const s1ap_parser::S1apParseResult* parse_result = nullptr);
+    
+    // String key for a context ("imsi:...", "tmsi:...", ...); empty if unknown
+    std::string subscriber_key(SubscriberId id) const;
     
     // Update context from a message
     void update_context(const CanonicalMessage& message);
     
-    // Get context by subscriber key
-    std::shared_ptr<UEContext> get_context(const std::string& subscriber_key);
+    // Get context by ID. Readers never take the ingestion lock: they get the
+    // last published immutable snapshot from a lock stripe keyed by ID, so
+    // rule evaluation and queries do not block get_or_create_subscriber.
+    std::shared_ptr<const UEContext> get_context(SubscriberId id) const;
+    
+    // Get context by rendered subscriber key (linear scan; tools and tests)
+    std::shared_ptr<const UEContext> get_context(const std::string& subscriber_key) const;
+    
+    // Published context of the live UE holding an identifier, or null. The
+    // ingestion lock is shared only for the two index probes.
+    std::shared_ptr<const UEContext> find_context(const UeLookup& lookup) const;
     
-    // Cleanup expired contexts
+    // One page of the UEs on a cell, in context ID order
+    struct CellPage {
+        std::vector<std::shared_ptr<const UEContext>> contexts;
+        SubscriberId next_after = 0; // `after` for the next page; 0 on the last
+    };
+    
+    // UEs whose current cell is `ecgi`, with IDs above `after`, at most
+    // `limit` of them. Served from the published contexts and a cell index
+    // kept with them; never takes the ingestion lock.
+    CellPage list_cell(const std::string& ecgi, SubscriberId after, size_t limit) const;
+    
+    // Number of UEs whose current cell is `ecgi`
+    size_t cell_ue_count(const std::string& ecgi) const;
+    
+    // Cleanup expired contexts. Only contexts that are due are visited.
+    // In event time the clock is the watermark if one has been set, else the
+    // latest message ts_capture seen, else the wall clock.
     void cleanup_expired();
     
+    // Advance the event-time watermark (nanoseconds; never moves back)
+    void advance_watermark(int64_t watermark_ns);
+    
+    // Number of live UE contexts
+    size_t context_count() const;
+    
     // Dump all UE records to output stream (for debugging/shutdown)
     void dump_ue_records(std::ostream& os) const;
+    
+    // Report approximate memory used by the UE records and identifier indexes
+    void dump_memory_usage(std::ostream& os) const;
+    
+    // Write subscriber records, contexts and clocks as snapshot shard `shard`
+    void save_snapshot(snapshot::SnapshotWriter& writer, uint32_t shard) const;
+    
+    // Restore state saved by save_snapshot into this (empty) correlator
+    void load_snapshot(const snapshot::SnapshotReader& reader, uint32_t shard);
 
 private:
     Config config_;
-    mutable std::shared_mutex mutex_; // Read-write lock for fine-grained locking
+    mutable std::shared_mutex mutex_; // Ingestion-side lock (resolution and expiry)
+    
+    // Published contexts, read-copy-update style. Writers never modify a
+    // published context: they copy it, update the copy and swap it in, so
+    // a reader's snapshot stays consistent for as long as it is held.
+    struct ReadStripe {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<SubscriberId, std::shared_ptr<const UEContext>> contexts;
+    };
+    static constexpr size_t kReadStripes = 16;
+    mutable std::array<ReadStripe, kReadStripes> read_stripes_;
+    ReadStripe& read_stripe(SubscriberId id) const { return read_stripes_[id % kReadStripes]; }
+    void publish(const std::shared_ptr<UEContext>& context);
+    void unpublish(SubscriberId id);
+    
+    // ECGI -> IDs of the published contexts on that cell. Updated by
+    // publish and unpublish (under the ingestion lock) when a context
+    // changes cell; ordered so cell listings page by ID.
+    mutable std::shared_mutex cell_mutex_;
+    std::unordered_map<std::string, std::set<SubscriberId>> cell_index_;
+    void move_cell(SubscriberId id, const std::string* from, const std::string* to);
     
     // S1apUeCorrelator instance
     std::unique_ptr<s1ap_correlator::S1apUeCorrelator> s1ap_correlator_;
     
-    // Context storage: subscriber_key -> UEContext
-    std::unordered_map<std::string, std::shared_ptr<UEContext>> contexts_;
+    // Subscriber record -> the context it resolved to, so identifier
+    // queries go from the S1apUeCorrelator indexes to a context. Records
+    // are never freed; entries for expired contexts find nothing.
+    std::unordered_map<const s1ap_correlator::SubscriberRecord*, SubscriberId> record_contexts_;
+    
+    // Context storage: dense subscriber ID -> UEContext. Contexts are
+    // allocated (with their shared_ptr control block) from context_pool_.
+    std::shared_ptr<utils::BlockPool> context_pool_;
+    std::unordered_map<SubscriberId, std::shared_ptr<UEContext>> contexts_;
+    SubscriberId next_context_id_ = 1;
     
     // Counter for unknown subscriber IDs
     uint64_t next_unknown_id_ = 1;
     
+    // Context expiry deadlines, driven by message capture time
+    utils::ExpiryQueue<SubscriberId> expiry_;
+    int64_t clock_ns_ = 0; // Latest ts_capture seen; 0 until one arrives
+    int64_t watermark_ns_ = 0; // Set by the pipeline; 0 until advanced
+    
+    int64_t current_time_ns() const;
+    SubscriberId resolve_context(const CanonicalMessage& message,
+                                 const s1ap_parser::S1apParseResult* parse_result);
+    std::string render_subscriber_key(const s1ap_correlator::SubscriberRecord& subscriber,
+                                      SubscriberKeyKind kind);
+    
+    // Rebuild an S1apParseResult from a message without a native result
+    static s1ap_parser::S1apParseResult rebuild_parse_result(const CanonicalMessage& message);
+    
     // Helper function to update UEContext from SubscriberRecord
     void update_context_from_subscriber(
         std::shared_ptr<UEContext> context,
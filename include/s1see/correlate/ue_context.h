@@ -16,10 +16,24 @@
 #include <chrono>
 #include <unordered_map>
 #include <optional>
+#include <cstdint>
 
 namespace s1see {
 namespace correlate {
 
+// Dense per-context ID used for every internal map; 0 means "no context".
+// The string subscriber key is only rendered for events and dumps.
+using SubscriberId = uint64_t;
+
+// Identifier a subscriber key was rendered from, best first
+enum class SubscriberKeyKind : uint8_t {
+    IMSI,
+    TMSI,
+    S1AP_ID,
+    UNKNOWN,
+    NONE
+};
+
 // UE Context for correlation
 struct UEContext {
     // Identifiers (best available)
@@ -44,13 +58,13 @@ struct UEContext {
     std::string last_procedure;
     std::chrono::system_clock::time_point last_seen;
     
-    // Subscriber key (best identifier available)
-    std::string subscriber_key;
+    // Correlator-assigned ID, stable for the context's lifetime
+    SubscriberId id = 0;
     
-    // Cached composite keys for fast lookups (avoid repeated string concatenation)
-    std::string mme_composite_key;  // "mme_id:mme_ue_s1ap_id"
-    std::string enb_composite_key;   // "enb_id:enb_ue_s1ap_id"
-    std::string tmsi_composite_key;  // "tmsi@ecgi"
+    // Subscriber key (best identifier available), re-rendered only when a
+    // better identifier kind is learned
+    std::string subscriber_key;
+    SubscriberKeyKind key_kind = SubscriberKeyKind::NONE;
     
     // Additional state for handover sequences
     bool handover_in_progress = false;
@@ -68,9 +82,7 @@ struct UEContext {
     
     // Check if this context matches another by stable identifiers (IMSI, GUTI, IMEI)
     bool matches_stable_identity(const UEContext& other) const;
-    
-    // Update cached composite keys (call after updating identifiers)
-    void update_composite_keys();
+
 };
 
 } // namespace correlate
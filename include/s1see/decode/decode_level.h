@@ -0,0 +1,27 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: decode_level.h
+ * Description: How much of each S1AP PDU the decoder renders beyond the
+ *              identifiers correlation needs. Rules and sinks declare the
+ *              level they use and the pipeline decodes at the highest.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace s1see {
+namespace decode {
+
+// Each level includes the ones before it, so the highest requested wins
+enum class DecodeLevel : uint8_t {
+    IDENTIFIERS = 0,  // Canonical fields (message type, UE IDs, cells) only
+    IE_TABLE = 1,     // Plus CanonicalMessage::information_elements, the raw IE values
+    FULL_TREE = 2     // Plus the decoded_tree JSON
+};
+
+} // namespace decode
+} // namespace s1see
@@ -12,38 +12,77 @@
 #pragma once
 
 #include "canonical_message.pb.h"
+#include "s1see/decode/decode_level.h"
+#include "s1ap_parser.h"
 #include <string>
 #include <vector>
 #include <memory>
+#include <optional>
+#include <span>
 
 namespace s1see {
 namespace decode {
 
 // Decoded tree structure (lossless representation)
 struct DecodedTree {
-    std::string json_representation; // JSON or similar format
-    // Additional structured fields can be added
+    std::string json_representation; // JSON or similar format; empty unless requested
+    
+    // Native parser output, for handing straight to the Correlator instead
+    // of re-parsing json_representation. It views the decoded bytes, so it
+    // is only valid while the decoder's input buffer is.
+    std::optional<s1ap_parser::S1apParseResult> parse_result;
 };
 
+// Build the decoded tree JSON for a parse result
+std::string build_decoded_tree_json(const s1ap_parser::S1apParseResult& parse_result);
+
 // Interface for S1AP decoder
 // This wraps an existing C++ S1AP parsing library
 class S1APDecoderWrapper {
 public:
+    struct Options {
+        // Copy the input bytes into canonical_message.raw_bytes. Callers that
+        // keep the spool record can turn this off and reference it instead.
+        bool embed_raw_bytes = true;
+        
+        // IE_TABLE copies the IE values into
+        // canonical_message.information_elements; FULL_TREE also renders the
+        // decoded_tree JSON (into DecodedTree and canonical_message). The
+        // pipeline decodes at the level its rules and sinks ask for.
+        DecodeLevel level = DecodeLevel::FULL_TREE;
+    };
+    
     virtual ~S1APDecoderWrapper() = default;
     
     // Decode raw bytes into canonical message and decoded tree
     // Returns true on success, false on decode failure
-    // On failure, decode_failed is set in canonical_message and raw_bytes are preserved
-    virtual bool decode(const std::vector<uint8_t>& raw_bytes,
-                       CanonicalMessage& canonical_message,
-                       DecodedTree& decoded_tree) = 0;
+    // On failure, decode_failed is set in canonical_message and raw_bytes are
+    // preserved (if options.embed_raw_bytes). raw_bytes is only read during
+    // the call, so it may point straight into a spool record.
+    virtual bool decode(std::span<const uint8_t> raw_bytes,
+                        CanonicalMessage& canonical_message,
+                        DecodedTree& decoded_tree,
+                        const Options& options) = 0;
+    
+    // Convenience methods
+    bool decode(std::span<const uint8_t> raw_bytes,
+                CanonicalMessage& canonical_message,
+                DecodedTree& decoded_tree) {
+        return decode(raw_bytes, canonical_message, decoded_tree, Options{});
+    }
+    
+    bool decode(const std::vector<uint8_t>& raw_bytes,
+                CanonicalMessage& canonical_message,
+                DecodedTree& decoded_tree) {
+        return decode(std::span<const uint8_t>(raw_bytes), canonical_message, decoded_tree, Options{});
+    }
     
-    // Convenience method
     bool decode(const std::string& raw_bytes,
                 CanonicalMessage& canonical_message,
                 DecodedTree& decoded_tree) {
-        std::vector<uint8_t> bytes(raw_bytes.begin(), raw_bytes.end());
-        return decode(bytes, canonical_message, decoded_tree);
+        return decode(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(raw_bytes.data()),
+                                               raw_bytes.size()),
+                      canonical_message, decoded_tree, Options{});
     }
 };
 
@@ -51,17 +90,21 @@ public:
 // Replace with actual S1AP parser integration
 class StubS1APDecoder : public S1APDecoderWrapper {
 public:
-    bool decode(const std::vector<uint8_t>& raw_bytes,
+    using S1APDecoderWrapper::decode;
+    bool decode(std::span<const uint8_t> raw_bytes,
                 CanonicalMessage& canonical_message,
-                DecodedTree& decoded_tree) override;
+                DecodedTree& decoded_tree,
+                const Options& options) override;
 };
 
 // Real S1AP parser implementation using s1ap_parser library
 class RealS1APDecoder : public S1APDecoderWrapper {
 public:
-    bool decode(const std::vector<uint8_t>& raw_bytes,
+    using S1APDecoderWrapper::decode;
+    bool decode(std::span<const uint8_t> raw_bytes,
                 CanonicalMessage& canonical_message,
-                DecodedTree& decoded_tree) override;
+                DecodedTree& decoded_tree,
+                const Options& options) override;
 };
 
 } // namespace decode
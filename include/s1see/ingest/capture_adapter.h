@@ -0,0 +1,77 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: capture_adapter.h
+ * Description: Header for CaptureIngestAdapter class that ingests live S1AP
+ *              traffic from a network interface (e.g. a tap port) through
+ *              memory-mapped AF_PACKET TPACKET_V3 receive rings.
+ */
+
+#pragma once
+
+#include "s1see/ingest/ingest_adapter.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace s1see {
+namespace ingest {
+
+// Live capture adapter (Linux only). Each capture thread owns an AF_PACKET
+// socket with a TPACKET_V3 RX ring; the sockets join one PACKET_FANOUT_HASH
+// group so the kernel keeps every SCTP association on the same thread.
+// Frames are read in place from the ring, S1AP messages are reassembled
+// from SCTP DATA chunks, and thread i appends its batches to spool
+// partition (i mod spool partitions), so per-association order holds;
+// a spool partitioner, if configured, picks the partition instead.
+// Requires CAP_NET_RAW; start() fails otherwise or on other platforms.
+class CaptureIngestAdapter : public IngestAdapter {
+public:
+    struct Config {
+        Config() : num_threads(0), fanout_group(0), block_size(1 << 22), block_count(64),
+                   frame_size(2048), block_timeout(std::chrono::milliseconds(10)),
+                   batch_size(4096), pin_threads(false) {}
+        std::string interface;
+        size_t num_threads;             // Capture threads / fanout members (0 = hardware concurrency)
+        uint16_t fanout_group;          // Fanout group ID (0 = derived from the process ID)
+        uint32_t block_size;            // Ring block size, a multiple of the page size
+        uint32_t block_count;           // Blocks per ring
+        uint32_t frame_size;            // Nominal frame slot size (TPACKET_V3 packs frames)
+        std::chrono::milliseconds block_timeout;  // Kernel retires a partly filled block after this
+        size_t batch_size;              // Messages per spool append
+        bool pin_threads;               // Pin capture thread i to CPU i
+    };
+
+    struct Stats {
+        uint64_t packets = 0;           // Frames read from the rings
+        uint64_t s1ap_pdus = 0;         // Messages appended to the spool
+        uint64_t kernel_drops = 0;      // Frames the kernel dropped (ring full)
+        uint64_t reassembly_drops = 0;  // Fragmented messages abandoned
+    };
+
+    explicit CaptureIngestAdapter(const Config& config);
+    ~CaptureIngestAdapter();
+
+    bool start() override;
+    void stop() override;
+
+    Stats stats() const;
+
+private:
+    struct Ring;
+
+    void capture_loop(size_t index);
+
+    Config config_;
+    std::atomic<bool> running_{false};
+    std::vector<std::unique_ptr<Ring>> rings_;
+    std::vector<std::thread> threads_;
+};
+
+} // namespace ingest
+} // namespace s1see
@@ -21,7 +21,15 @@
 namespace s1see {
 namespace ingest {
 
-class GrpcIngestAdapter : public IngestAdapter, public IngestService::Service {
+// Ingest is served on the synchronous API with one ack per message.
+// IngestBatch is served on the callback API: each stream reads ahead while
+// its previous batch is being written, appends every batch in one durable
+// write and coalesces acks that queue up behind a slow client into one
+// cumulative ack. Without a spool partitioner each batch stream is pinned
+// to a spool partition (round-robin), so concurrent streams write to
+// different partitions; with one, each message goes where it says.
+class GrpcIngestAdapter : public IngestAdapter,
+                          public IngestService::WithCallbackMethod_IngestBatch<IngestService::Service> {
 public:
     GrpcIngestAdapter(const std::string& listen_address);
     ~GrpcIngestAdapter();
@@ -32,9 +40,16 @@ public:
     // gRPC service implementation
     grpc::Status Ingest(grpc::ServerContext* context,
                        grpc::ServerReaderWriter<IngestAck, SignalMessage>* stream) override;
+    
+    grpc::ServerBidiReactor<SignalMessageBatch, IngestBatchAck>* IngestBatch(
+        grpc::CallbackServerContext* context) override;
 
 private:
+    class BatchReactor;
+    
     std::string listen_address_;
+    std::atomic<uint32_t> next_stream_partition_{0};
+    std::atomic<uint64_t> next_stream_id_{1};  // SignalMessage::grpc().stream_id()
     std::unique_ptr<grpc::Server> server_;
     std::thread server_thread_;
     std::atomic<bool> running_{false};
@@ -17,13 +17,30 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <future>
+#include <span>
+#include <stdexcept>
+#include <vector>
 
 namespace s1see {
 namespace ingest {
 
+// One transport record awaiting a durable spool write. The ack fields are
+// whatever the transport needs to acknowledge it afterwards.
+struct IngestRecord {
+    SignalMessage message;
+    int32_t spool_partition = -1;   // Preferred partition; -1: from source_id
+    int32_t source_partition = 0;   // Transport partition (e.g. Kafka), else 0
+    int64_t ack_token = 0;          // Offset, delivery tag or batch index
+};
+
 // Base interface for all ingest adapters
 class IngestAdapter {
 public:
+    // Called after each spool write with the records written (arrival order)
+    // and whether they are durable
+    using BatchAck = std::function<void(std::span<const IngestRecord> records, bool durable)>;
+    
     using AckCallback = std::function<void(const std::string& message_id, bool success, const std::string& error)>;
     
     virtual ~IngestAdapter() = default;
@@ -49,6 +66,55 @@ protected:
         }
         return spool_->append(message);
     }
+    
+    // Helper: append a burst of messages in one spool call
+    std::vector<std::pair<int32_t, int64_t>> append_batch_to_spool(std::span<const SignalMessage> messages) {
+        if (!spool_) {
+            throw std::runtime_error("Spool not set");
+        }
+        return spool_->append_batch(messages);
+    }
+    
+    // Helper: append a burst to one spool partition and return once it is
+    // durable, so the caller can acknowledge upstream. Returns first offset.
+    int64_t append_batch_to_spool_durable(int32_t partition, std::span<const SignalMessage> messages) {
+        if (!spool_) {
+            throw std::runtime_error("Spool not set");
+        }
+        return spool_->append_batch_durable(partition, messages);
+    }
+    
+    // Helper: durable append of a burst, each message to the partition
+    // Spool::partition_for gives it (one write per partition, arrival order
+    // kept within each). preferred is the adapter's own choice, used when
+    // the spool has no partitioner. Returns where the last message went.
+    std::pair<int32_t, int64_t> append_batch_to_spool_partitioned(std::span<const SignalMessage> messages,
+                                                                  int32_t preferred);
+    
+    // Helper: write a polled batch with one durable append per spool
+    // partition, then acknowledge each group through ack. Shared by the
+    // pull-based transports so they all ack in bulk after the write.
+    // Partitions come from Spool::partition_for, preferring each record's
+    // spool_partition.
+    // Returns the number of records made durable. Reorders records and
+    // moves their messages out (the ack fields stay valid).
+    size_t spool_batch_and_ack(std::vector<IngestRecord>& records, const BatchAck& ack);
+    
+    // Helper: build a SignalMessage from a transport payload. Serialized
+    // SignalMessages are used as-is; anything else is wrapped as a raw PDU
+    // from source_id with the given sequence and capture time. Callers set
+    // the transport oneof when the payload did not carry one.
+    static SignalMessage payload_to_message(const void* payload, size_t length,
+                                            const std::string& source_id, int64_t sequence,
+                                            int64_t ts_capture_ns);
+    
+    // Helper: append to spool; the future resolves once the record is durable
+    std::future<std::pair<int32_t, int64_t>> append_to_spool_durable(const SignalMessage& message) {
+        if (!spool_) {
+            throw std::runtime_error("Spool not set");
+        }
+        return spool_->append_durable(message);
+    }
 };
 
 } // namespace ingest
@@ -6,35 +6,66 @@
  * Title: kafka_adapter.h
  * Description: Header for KafkaIngestAdapter class that implements message ingestion
  *              via Apache Kafka messaging protocol. Receives SignalMessage records
- *              through Kafka and stores them in spool partitions (skeleton implementation).
+ *              through Kafka and stores them in spool partitions (librdkafka).
  */
 
 #pragma once
 
 #include "s1see/ingest/ingest_adapter.h"
+#include <atomic>
+#include <chrono>
+#include <map>
 #include <string>
 #include <memory>
+#include <thread>
+#include <vector>
 
 namespace s1see {
 namespace ingest {
 
-// Kafka adapter skeleton
-// For production, integrate with librdkafka or similar
+// Kafka consumer-group adapter. Messages are polled in batches and Kafka
+// partition k is appended to spool partition (k mod spool partitions), one
+// durable write per spool partition; Kafka offsets are committed only after
+// that write returns, so delivery is at-least-once.
+// Requires building with librdkafka (HAVE_RDKAFKA); otherwise start() fails.
 class KafkaIngestAdapter : public IngestAdapter {
 public:
+    struct Config {
+        Config() : group_id("s1see"), batch_size(1000), poll_timeout(std::chrono::milliseconds(100)) {}
+        std::string brokers;
+        std::string topic;
+        std::string group_id;
+        size_t batch_size;                      // Max messages per rd_kafka_consume_batch_queue call
+        std::chrono::milliseconds poll_timeout;
+        std::map<std::string, std::string> properties;  // Extra librdkafka settings
+    };
+    
     KafkaIngestAdapter(const std::string& brokers, const std::string& topic);
+    explicit KafkaIngestAdapter(const Config& config);
     ~KafkaIngestAdapter();
     
     bool start() override;
     void stop() override;
+    
+    // Messages appended to the spool so far
+    uint64_t messages_ingested() const { return messages_ingested_.load(); }
+    
+    // Build the SignalMessage for a Kafka record. Payloads are serialized
+    // SignalMessages; anything that does not parse is treated as a raw PDU.
+    // Public for tests.
+    static SignalMessage to_signal_message(const std::string& topic, int32_t partition, int64_t offset,
+                                           int64_t timestamp_ms, const void* payload, size_t length);
 
 private:
-    std::string brokers_;
-    std::string topic_;
-    // TODO: Add Kafka consumer handle
+    void consume_loop();
+    
+    Config config_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> messages_ingested_{0};
+    std::thread consumer_thread_;
+    void* consumer_ = nullptr;  // rd_kafka_t*, opaque so the header has no librdkafka dependency
+    void* queue_ = nullptr;     // rd_kafka_queue_t*
 };
 
 } // namespace ingest
 } // namespace s1see
-
-
@@ -6,33 +6,59 @@
  * Title: nats_adapter.h
  * Description: Header for NATSIngestAdapter class that implements message ingestion
  *              via NATS messaging protocol. Receives SignalMessage records through
- *              NATS and stores them in spool partitions (skeleton implementation).
+ *              a JetStream pull consumer and stores them in spool partitions (nats.c).
  */
 
 #pragma once
 
 #include "s1see/ingest/ingest_adapter.h"
+#include <atomic>
+#include <chrono>
 #include <string>
+#include <thread>
 
 namespace s1see {
 namespace ingest {
 
-// NATS adapter skeleton
+// JetStream pull-consumer adapter. Messages are fetched in batches of up to
+// batch_size, written to the spool through spool_batch_and_ack and then
+// acknowledged with a single ack (the consumer uses the AckAll policy). If
+// any part of a batch fails to reach disk, the whole batch is nak'ed and
+// redelivered. Requires building with nats.c (HAVE_NATS).
 class NATSIngestAdapter : public IngestAdapter {
 public:
+    struct Config {
+        Config() : durable("s1see"), batch_size(500), fetch_timeout(std::chrono::milliseconds(100)) {}
+        std::string servers;        // Comma-separated nats:// URLs
+        std::string subject;
+        std::string stream;         // Empty: look the stream up from the subject
+        std::string durable;        // Durable consumer name
+        int batch_size;             // Messages per fetch
+        std::chrono::milliseconds fetch_timeout;
+    };
+    
     NATSIngestAdapter(const std::string& servers, const std::string& subject);
+    explicit NATSIngestAdapter(const Config& config);
     ~NATSIngestAdapter();
     
     bool start() override;
     void stop() override;
+    
+    // Messages appended to the spool so far
+    uint64_t messages_ingested() const { return messages_ingested_.load(); }
 
 private:
-    std::string servers_;
-    std::string subject_;
-    // TODO: Add NATS connection handle
+    void fetch_loop();
+    
+    Config config_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> messages_ingested_{0};
+    std::thread fetch_thread_;
+    // nats.c handles, opaque so the header has no nats.c dependency
+    void* connection_ = nullptr;    // natsConnection*
+    void* jetstream_ = nullptr;     // jsCtx*
+    void* subscription_ = nullptr;  // natsSubscription*
 };
 
 } // namespace ingest
 } // namespace s1see
-
-
@@ -0,0 +1,57 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: pcap_loader.h
+ * Description: Header for PcapLoader, a bulk path from pcap/pcapng captures
+ *              into the spool. The capture is memory-mapped, S1AP PDUs are
+ *              extracted from SCTP by worker threads over chunks of frames,
+ *              and the results are appended in frame order in large batches.
+ */
+
+#pragma once
+
+#include "s1see/spool/spool.h"
+#include "signal_message.pb.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace s1see {
+namespace ingest {
+
+class PcapLoader {
+public:
+    struct Config {
+        Config() : num_workers(0), chunk_frames(4096), batch_size(8192), partition(-1), file_id(0) {}
+        size_t num_workers;         // Extraction threads (0 = hardware concurrency)
+        size_t chunk_frames;        // Frames per extraction task
+        size_t batch_size;          // Messages per spool append
+        int32_t partition;          // Spool partition for every record (-1 = spool partitioner)
+        uint32_t file_id;           // Stored in SignalMessage::pcap().file_id()
+        std::string source_id;      // Defaults to "pcap:<file name>"
+    };
+
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t s1ap_pdus = 0;
+        uint64_t bytes = 0;         // Capture file size
+        double seconds = 0;
+    };
+
+    explicit PcapLoader(std::shared_ptr<spool::Spool> spool, const Config& config = Config());
+
+    // Loads the whole capture and flushes the spool. Records carry the
+    // frame number in SignalMessage::frame_number and are numbered from
+    // first_sequence in frame order. Throws std::runtime_error if the file
+    // cannot be read.
+    Stats load(const std::string& pcap_path, int64_t first_sequence = 0);
+
+private:
+    std::shared_ptr<spool::Spool> spool_;
+    Config config_;
+};
+
+} // namespace ingest
+} // namespace s1see
@@ -0,0 +1,79 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: sctp_reassembler.h
+ * Description: Header for SctpReassembler, which recovers S1AP messages from
+ *              the SCTP DATA chunks of captured Ethernet frames, including
+ *              messages fragmented across several chunks and packets.
+ */
+
+#pragma once
+
+#include "s1see/utils/flat_hash_map.h"
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace s1see {
+namespace ingest {
+
+// Walks SCTP DATA chunks with PayloadProtocolID 18 (S1AP), as
+// extractAllS1apFromSctp does, but honours the B/E fragment flags.
+// Unfragmented chunks are passed on as views into the frame, without a
+// copy; fragments are buffered per (verification tag, source port, stream)
+// until the E chunk arrives, and require consecutive TSNs. Each direction
+// of an association reassembles on its own, so one instance per capture
+// thread is enough. Not thread-safe.
+class SctpReassembler {
+public:
+    struct Config {
+        Config() : max_message_size(65536), max_pending(4096) {}
+        size_t max_message_size;    // Larger fragmented messages are dropped
+        size_t max_pending;         // Partial messages kept before all are dropped
+    };
+
+    struct Stats {
+        uint64_t data_chunks = 0;   // S1AP DATA chunks seen
+        uint64_t fragments = 0;     // Chunks that were part of a fragmented message
+        uint64_t reassembled = 0;   // Fragmented messages completed
+        uint64_t dropped = 0;       // Fragmented messages abandoned (loss, size, pending limit)
+    };
+
+    using PduCallback = std::function<void(std::span<const uint8_t>)>;
+
+    explicit SctpReassembler(const Config& config = Config());
+
+    // Parse one Ethernet frame (optionally VLAN-tagged, IPv4 or IPv6) and
+    // call on_pdu for every complete S1AP message, in chunk order. The span
+    // is only valid during the call. Returns the number of messages.
+    size_t process_frame(std::span<const uint8_t> frame, const PduCallback& on_pdu);
+
+    // SCTP association of the frame last passed to process_frame (see
+    // sctp_association), for on_pdu to tag its messages with
+    uint64_t association() const { return association_; }
+
+    const Stats& stats() const { return stats_; }
+    size_t pending() const { return partials_.size(); }
+
+private:
+    struct Partial {
+        std::vector<uint8_t> data;
+        uint32_t next_tsn = 0;
+    };
+
+    Config config_;
+    Stats stats_;
+    uint64_t association_ = 0;
+    utils::FlatHashMap<uint64_t, Partial> partials_;
+};
+
+// Key of the SCTP association an Ethernet frame belongs to, hashed from
+// both endpoints' addresses and ports so the two directions agree; 0 if
+// the frame carries no SCTP. Stored as SignalMessage::sctp_association.
+uint64_t sctp_association(std::span<const uint8_t> frame);
+
+} // namespace ingest
+} // namespace s1see
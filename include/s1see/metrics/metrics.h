@@ -0,0 +1,148 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: metrics.h
+ * Description: Header for the metrics registry: striped counters, gauges and
+ *              HDR-style latency histograms, rendered in the Prometheus text
+ *              exposition format.
+ */
+
+#pragma once
+
+#include "s1see/utils/latency_histogram.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace s1see {
+namespace metrics {
+
+// Label name/value pairs, in the order they are rendered
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+// Small per-thread index used to pick a stripe; threads are numbered on
+// first use, so up to STRIPES threads never share one
+size_t thread_stripe();
+
+// Monotonic counter. Each thread adds to its own cache line; value() sums
+// the stripes, so hot-path increments never contend.
+class Counter {
+public:
+    static constexpr size_t STRIPES = 16;
+
+    void add(uint64_t n = 1) {
+        stripes_[thread_stripe() % STRIPES].value.fetch_add(n, std::memory_order_relaxed);
+    }
+    uint64_t value() const;
+
+private:
+    struct alignas(64) Stripe {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Stripe, STRIPES> stripes_;
+};
+
+// Last-written value, set by the owner of the measured state
+class Gauge {
+public:
+    void set(double value) { value_.store(value, std::memory_order_relaxed); }
+    double value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value_{0.0};
+};
+
+// Latency histogram in nanoseconds, rendered in seconds. Threads record
+// into their own stripe under an uncontended lock; snapshot() merges them.
+class Histogram {
+public:
+    static constexpr size_t STRIPES = 8;
+
+    void record(uint64_t nanoseconds, uint64_t count = 1) {
+        Stripe& stripe = stripes_[thread_stripe() % STRIPES];
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        stripe.histogram.record(nanoseconds, count);
+    }
+
+    // Merge a histogram recorded locally (e.g. over a batch) in one step
+    void merge(const utils::LatencyHistogram& local);
+
+    utils::LatencyHistogram snapshot() const;
+
+private:
+    struct alignas(64) Stripe {
+        mutable std::mutex mutex;
+        utils::LatencyHistogram histogram;
+    };
+    std::array<Stripe, STRIPES> stripes_;
+};
+
+// Times a scope into a histogram; a null histogram disables it
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram* histogram)
+        : histogram_(histogram),
+          start_(histogram ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()) {}
+    ~ScopedTimer() {
+        if (histogram_) {
+            histogram_->record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start_).count()));
+        }
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram* histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Named metric families. Lookups take a lock, so callers resolve their
+// metrics once and keep the references, which stay valid for the life of
+// the registry. Asking again for the same name and labels returns the same
+// metric; reusing a name with another type throws std::runtime_error.
+class MetricsRegistry {
+public:
+    Counter& counter(const std::string& name, const std::string& help, const Labels& labels = {});
+    Gauge& gauge(const std::string& name, const std::string& help, const Labels& labels = {});
+    Histogram& histogram(const std::string& name, const std::string& help, const Labels& labels = {});
+
+    // Prometheus text exposition format (version 0.0.4). Histogram bucket
+    // counts are exact to the recording resolution, about 3%.
+    std::string render() const;
+
+    // Upper bounds of the rendered histogram buckets, in seconds
+    static const std::vector<double>& histogram_bounds();
+
+private:
+    enum class Type { COUNTER, GAUGE, HISTOGRAM };
+    struct Series {
+        Labels labels;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+    struct Family {
+        std::string help;
+        Type type;
+        std::vector<std::unique_ptr<Series>> series;  // Stable while the registry lives
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Family> families_;
+
+    Series& series(const std::string& name, const std::string& help, Type type, const Labels& labels);
+};
+
+} // namespace metrics
+} // namespace s1see
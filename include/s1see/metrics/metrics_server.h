@@ -0,0 +1,67 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: metrics_server.h
+ * Description: Header for MetricsServer, a minimal HTTP endpoint that serves
+ *              a MetricsRegistry in the Prometheus text format.
+ */
+
+#pragma once
+
+#include "s1see/metrics/metrics.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace s1see {
+namespace metrics {
+
+// Serves GET <path> on one thread, one connection at a time; scrapes are
+// infrequent and small, so there is no keep-alive or request pipelining
+class MetricsServer {
+public:
+    struct Config {
+        Config() : bind_address("0.0.0.0"), port(9464), path("/metrics") {}
+        
+        std::string bind_address;  // IPv4 address to listen on
+        uint16_t port;             // 0 picks a free port; see port()
+        std::string path;
+    };
+    
+    MetricsServer(std::shared_ptr<MetricsRegistry> registry, const Config& config = Config());
+    ~MetricsServer();
+    
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+    
+    // Called on the server thread before each scrape is rendered, e.g. to
+    // refresh gauges from thread-safe sources. Set before start().
+    void set_collect_hook(std::function<void()> hook) { collect_hook_ = std::move(hook); }
+    
+    // Returns false (and logs) if the address cannot be bound
+    bool start();
+    void stop();
+    
+    // Port actually bound; valid after start()
+    uint16_t port() const { return bound_port_; }
+
+private:
+    std::shared_ptr<MetricsRegistry> registry_;
+    Config config_;
+    std::function<void()> collect_hook_;
+    int listen_fd_ = -1;
+    uint16_t bound_port_ = 0;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    
+    void serve_loop();
+    void handle_connection(int fd);
+};
+
+} // namespace metrics
+} // namespace s1see
@@ -0,0 +1,67 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: grpc_query_service.h
+ * Description: Header for GrpcUeQueryService, which answers UeQueryService
+ *              lookups (by IMSI, TMSI, TEID or MME-UE-S1AP-ID) and per-cell
+ *              UE listings from a running pipeline's published UE contexts.
+ */
+
+#pragma once
+
+#include "s1see/processor/pipeline.h"
+#include "event_service.grpc.pb.h"
+#include <grpcpp/grpcpp.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace s1see {
+namespace processor {
+
+// Queries run on gRPC's threads against the pipeline's sharded read path,
+// so polling does not wait for, or hold up, batch processing. The pipeline
+// must outlive the service.
+class GrpcUeQueryService : public UeQueryService::Service {
+public:
+    struct Config {
+        Config()
+            : listen_address("0.0.0.0:50053"),
+              default_page_size(100),
+              max_page_size(1000) {}
+        std::string listen_address;
+        uint32_t default_page_size; // For a CellQuery without page_size
+        uint32_t max_page_size;     // Larger requests are cut to this
+    };
+
+    GrpcUeQueryService(const Pipeline& pipeline, const Config& config = Config());
+    ~GrpcUeQueryService();
+
+    bool start();
+    void stop();
+
+    // Port bound by start(), for listen addresses ending in :0
+    int port() const { return port_; }
+
+    // gRPC service implementation
+    grpc::Status Lookup(grpc::ServerContext* context, const UeLookupRequest* request,
+                        UeRecord* response) override;
+    grpc::Status ListCell(grpc::ServerContext* context, const CellQuery* request,
+                          UePage* response) override;
+
+    // Fill a UeRecord from a published context
+    static void to_record(const correlate::UEContext& context, UeRecord& record);
+
+private:
+    const Pipeline& pipeline_;
+    Config config_;
+    std::unique_ptr<grpc::Server> server_;
+    int port_ = 0;
+    std::atomic<bool> running_{false};
+};
+
+} // namespace processor
+} // namespace s1see
@@ -13,13 +13,23 @@
 #pragma once
 
 #include "s1see/spool/spool.h"
+#include "s1see/spool/consumer_group.h"
 #include "s1see/decode/s1ap_decoder_wrapper.h"
 #include "s1see/correlate/correlator.h"
 #include "s1see/rules/rule_engine.h"
 #include "s1see/sinks/sink.h"
+#include "s1see/metrics/metrics.h"
+#include "s1see/utils/thread_pool.h"
 #include "canonical_message.pb.h"
 #include "event.pb.h"
+#include <google/protobuf/arena.h>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <span>
 #include <memory>
+#include <optional>
+#include <unordered_map>
 #include <vector>
 #include <string>
 
@@ -34,6 +44,82 @@ public:
         int32_t spool_partitions = 1;
         std::string consumer_group = "default";
         std::chrono::seconds context_expiry = std::chrono::seconds(300);
+        
+        // Copy each record's raw bytes into its CanonicalMessage. The bytes
+        // stay in the spool (see spool_partition/spool_offset) either way;
+        // turning this off skips a copy per message, but rules and sinks
+        // then see decoded fields only.
+        bool embed_raw_bytes = true;
+        
+        // Lowest decode level. Correlation uses the decoder's native parse
+        // result, so by default only identifiers are rendered; the pipeline
+        // raises the level to what loaded rules (RuleEngine::decode_level)
+        // and added sinks (Sink::decode_level) need.
+        decode::DecodeLevel decode_level = decode::DecodeLevel::IDENTIFIERS;
+        
+        // Event time: sequence windows and expiry run on SignalMessage
+        // ts_capture. Expiry follows a watermark, the slowest partition's
+        // latest capture time less allowed_lateness (partitions with nothing
+        // new in a batch are skipped), so a replay at any speed matches the
+        // live result. The watermark only moves with new records, so a live
+        // feed that goes quiet would hold state back. Off (the default): the
+        // wall clock throughout.
+        bool event_time = false;
+        std::chrono::milliseconds allowed_lateness = std::chrono::milliseconds(0);
+        
+        // Parallel mode: decode on a worker pool, then run correlation and
+        // rules on shards keyed by UE identity. The decoder must be stateless.
+        bool parallel = false;
+        size_t worker_threads = 4;
+        size_t num_shards = 4;
+        
+        // Warm restart: with snapshot_path set, correlator and sequence
+        // state is restored from the snapshot at startup and the consumer
+        // group rewinds to the offsets it was taken at, so only the spool
+        // tail is replayed. A new snapshot is written every snapshot_interval.
+        std::string snapshot_path;
+        std::chrono::seconds snapshot_interval = std::chrono::seconds(60);
+        
+        // Commits wait for sinks that track delivery (Sink::delivered_sequence)
+        // to deliver the events emitted for the committed records. Reading
+        // pauses while this many partition batches are waiting.
+        size_t max_pending_commits = 64;
+        
+        // Records parsed per spool read. Reads stream through a cursor per
+        // partition, so memory stays bounded whatever max_messages is: serial
+        // batches go through several chunks, parallel batches take at most
+        // one chunk per partition.
+        size_t spool_read_chunk = 256;
+        
+        // Allocate each batch's CanonicalMessages, raw bytes and decoded
+        // trees included, from one protobuf arena released in one go once
+        // the batch's events are with the sinks. The first arena_block_bytes
+        // are kept from batch to batch, so a batch that fits allocates
+        // nothing on the heap for its messages.
+        bool batch_arena = false;
+        size_t arena_block_bytes = 1024 * 1024;
+        
+        // Scale-out: run as one member of consumer_group among several
+        // processors sharing the spool. The pipeline reads only the
+        // partitions its spool::ConsumerGroup leases give it, heartbeating
+        // every lease_duration / 3 from process_batch, and a partition it
+        // gains resumes from the group's committed offset. A subscriber's
+        // correlator and sequence state is only complete if the spool keeps
+        // each UE on one partition. Snapshots are not taken in this mode.
+        bool group_membership = false;
+        std::string member_id;  // Empty: <hostname>-<pid>
+        std::chrono::milliseconds lease_duration = std::chrono::seconds(10);
+        
+        // Replay: with either bound set, read only the records whose
+        // ts_capture falls in [replay_from_ns, replay_to_ns) (Unix
+        // nanoseconds; 0 leaves that end open, the upper one at the spool's
+        // end when the pipeline starts), found with Spool::seek_by_time.
+        // Records are read as fast as they are processed. Give the replay a
+        // consumer_group of its own: its commits start from the range's
+        // first record, and a rerun resumes past what it committed.
+        // Snapshots are not taken in this mode.
+        int64_t replay_from_ns = 0;
+        int64_t replay_to_ns = 0;
     };
     
     explicit Pipeline(const Config& config);
@@ -44,29 +130,193 @@ public:
     // Load ruleset
     void load_ruleset(const rules::Ruleset& ruleset);
     
+    // Hot reload: replace every loaded ruleset with `rulesets`. Safe to
+    // call from any thread while processing runs. The rules are compiled
+    // on the calling thread and installed in every shard at the start of
+    // the next batch, so processing never waits for a compile; sequence
+    // states of unchanged rules carry over (see RuleEngine::install_rules)
+    // and correlator state is untouched. A reload published before the
+    // last one was installed replaces it.
+    void reload_rulesets(std::vector<rules::Ruleset> rulesets);
+    
+    // Reloads installed so far
+    uint64_t ruleset_reloads() const { return ruleset_reloads_.load(std::memory_order_relaxed); }
+    
     // Add sink
     void add_sink(std::shared_ptr<sinks::Sink> sink);
     
+    // Export stage latency and throughput, consumer lag, live UE contexts,
+    // sequence states and WAL segment counts to `registry`. Latency is per
+    // message for decode, correlate and rules, per chunk read from the spool
+    // for spool_read, and per call for sink_emit. Gauges refresh after every
+    // batch. Call before processing.
+    void set_metrics(std::shared_ptr<metrics::MetricsRegistry> registry);
+    
     // Process one batch from spool
     // Returns number of events emitted
     int process_batch(int64_t max_messages = 100);
     
-    // Run continuous processing (blocking)
+    // Block until unprocessed records are available in any partition, or
+    // timeout. Returns true if there is something to process.
+    bool wait_for_data(std::chrono::milliseconds timeout);
+    
+    // Run continuous processing (blocking); wakes on spool appends
     void run_continuous();
     
-    // Dump UE records (for debugging/shutdown)
+    // Dump UE records (for debugging/shutdown). Holds each shard's
+    // ingestion lock for the whole dump; queries use find_ue and list_cell.
     void dump_ue_records(std::ostream& os) const;
+    
+    // UE queries, safe to call from other threads while batches are
+    // processed: they read the shards' published contexts.
+    // The live UE holding an identifier, or null. Where several shards hold
+    // a context with it, the most recently seen.
+    std::shared_ptr<const correlate::UEContext> find_ue(const correlate::UeLookup& lookup) const;
+    
+    struct UePage {
+        std::vector<std::shared_ptr<const correlate::UEContext>> ues;
+        uint64_t next_page_token = 0; // 0 on the last page
+    };
+    
+    // Up to page_size UEs whose current cell is `ecgi`, shard by shard in
+    // context ID order. page_token is the previous page's next_page_token,
+    // 0 for the first page.
+    UePage list_cell(const std::string& ecgi, uint64_t page_token, size_t page_size) const;
+    
+    // Report correlator memory usage per shard
+    void dump_memory_usage(std::ostream& os) const;
+    
+    // Commit the offsets of batches whose events every sink has delivered.
+    // process_batch does this itself; call it after flushing the sinks at
+    // shutdown. Returns the number of partition batches still waiting.
+    size_t commit_delivered();
+    
+    // Write a snapshot of all shards to config.snapshot_path, tagged with
+    // the committed offsets. Call between batches with no commits pending
+    // (periodic snapshots wait for that). Throws on I/O failure.
+    void write_snapshot();
+    
+    // Restore from config.snapshot_path. Returns false (and leaves state
+    // empty) if there is no usable snapshot.
+    bool load_snapshot();
+    
+    // Current event-time watermark (Unix nanoseconds; 0 until data is read)
+    int64_t watermark() const { return watermark_ns_; }
+    
+    // Replay mode: every partition read has reached the end of the range
+    bool replay_done() const;
+    
+    // Group membership with config.group_membership, else null
+    const spool::ConsumerGroup* consumer_group() const { return group_.get(); }
 
 private:
     Config config_;
     std::unique_ptr<spool::Spool> spool_;
     std::unique_ptr<decode::S1APDecoderWrapper> decoder_;
-    std::shared_ptr<correlate::Correlator> correlator_;
-    std::unique_ptr<rules::RuleEngine> rule_engine_;
     std::vector<std::shared_ptr<sinks::Sink>> sinks_;
     
-    CanonicalMessage decode_and_normalize(const SpoolRecord& record);
-    std::vector<Event> process_message(const CanonicalMessage& canonical);
+    // Correlation and rule state. Each S1 connection is routed to one shard
+    // (see shard_for), so its context and sequence state never cross
+    // threads. Serial mode uses a single shard.
+    struct Shard {
+        std::shared_ptr<correlate::Correlator> correlator;
+        std::unique_ptr<rules::RuleEngine> rule_engine;
+    };
+    std::vector<Shard> shards_;
+    std::unique_ptr<utils::ThreadPool> worker_pool_;
+    // Shards of the S1 connections seen: by MME-UE-S1AP-ID, and by eNB and
+    // eNB-UE-S1AP-ID; dropped at UEContextReleaseComplete
+    std::unordered_map<uint32_t, uint32_t> mme_affinity_;
+    std::unordered_map<uint64_t, uint32_t> enb_affinity_;
+    
+    // Highest of config, rules and sinks; sinks alone decide which
+    // attributes are added to events
+    decode::DecodeLevel decode_level_;
+    decode::DecodeLevel sink_decode_level_ = decode::DecodeLevel::IDENTIFIERS;
+    
+    // Event-time watermark state
+    std::vector<int64_t> partition_time_ns_; // Latest ts_capture per partition
+    int64_t watermark_ns_ = 0;
+    
+    std::chrono::steady_clock::time_point last_snapshot_;
+    
+    // Rules published by reload_rulesets, until process_batch installs them
+    std::mutex reload_mutex_;
+    std::shared_ptr<const rules::RuleEngine::CompiledRules> pending_rules_;
+    std::atomic<bool> rules_pending_{false};
+    std::atomic<uint64_t> ruleset_reloads_{0};
+    
+    // Consumer group membership (config.group_membership)
+    std::unique_ptr<spool::ConsumerGroup> group_;
+    std::chrono::steady_clock::time_point last_heartbeat_;
+    
+    // Next offset to read per partition. It runs ahead of the committed
+    // offset while commits wait for sinks to deliver.
+    std::vector<int64_t> read_offsets_;
+    std::vector<spool::SpoolCursor> cursors_;  // Per partition
+    std::vector<int64_t> replay_end_;  // Per partition in replay mode, else empty
+    struct PendingCommit {
+        int32_t partition;
+        int64_t next_offset;
+        std::vector<uint64_t> accepted;  // Per sink, after the batch's events
+    };
+    std::deque<PendingCommit> pending_commits_;
+    
+    // Per-batch message arena (config.batch_arena), reset after each batch
+    std::vector<char> arena_block_;
+    std::unique_ptr<google::protobuf::Arena> arena_;
+    
+    // Metrics; all null until set_metrics()
+    struct StageMetrics {
+        metrics::Histogram* latency = nullptr;
+        metrics::Counter* items = nullptr;  // Records, or events for sink_emit
+    };
+    std::shared_ptr<metrics::MetricsRegistry> metrics_;
+    StageMetrics spool_read_metrics_;
+    StageMetrics decode_metrics_;
+    StageMetrics correlate_metrics_;
+    StageMetrics rules_metrics_;
+    StageMetrics sink_metrics_;
+    metrics::Counter* decode_failures_ = nullptr;
+    metrics::Counter* processing_errors_ = nullptr;
+    metrics::Gauge* ue_contexts_gauge_ = nullptr;
+    metrics::Gauge* sequence_states_gauge_ = nullptr;
+    metrics::Gauge* watermark_gauge_ = nullptr;
+    metrics::Gauge* pending_commits_gauge_ = nullptr;
+    std::vector<metrics::Gauge*> consumer_lag_gauges_;   // Per partition
+    std::vector<metrics::Gauge*> wal_segment_gauges_;    // Per partition
+    
+    bool has_pending_records();
+    // Last offset to read in a partition: its high water mark, or the
+    // replay range's last record
+    int64_t read_limit(int32_t partition);
+    // Partitions this pipeline reads: all of them, or its group leases
+    bool reads_partition(int32_t partition) const { return !group_ || group_->owns(partition); }
+    void maybe_heartbeat(bool force = false);
+    void install_pending_rules();
+    void update_gauges();
+    // Cursor for a partition, positioned at its read offset
+    spool::SpoolCursor& cursor_for(int32_t partition);
+    std::span<const SpoolRecord> read_chunk(spool::SpoolCursor& cursor, size_t max_messages);
+    void maybe_write_snapshot();
+    void update_watermark(const std::vector<int64_t>& batch_time_ns);
+    // A message from the batch arena, or `local` without one
+    CanonicalMessage* new_message(CanonicalMessage& local);
+    void decode_and_normalize(const SpoolRecord& record, CanonicalMessage& canonical,
+                              decode::DecodedTree& decoded_tree);
+    std::vector<Event> process_message(Shard& shard, const CanonicalMessage& canonical,
+                                       const s1ap_parser::S1apParseResult* parse_result);
+    void update_decode_level();
+    void add_message_detail(const CanonicalMessage& canonical, std::vector<Event>& events) const;
+    // Shard for a record, by MME-UE-S1AP-ID, then its eNB's eNB-UE-S1AP-ID,
+    // then TMSI or IMSI; called from the routing stage only
+    size_t shard_for(const SpoolRecord& record, const CanonicalMessage& canonical);
+    int process_batch_serial(int64_t max_messages);
+    int process_batch_parallel(int64_t max_messages);
+    void emit_events(const std::vector<Event>& events);
+    // Close aggregate windows the rules' clock has passed and emit their summaries
+    int emit_aggregate_windows();
+    void commit_when_delivered(int32_t partition, int64_t next_offset);
 };
 
 } // namespace processor
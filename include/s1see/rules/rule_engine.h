@@ -6,7 +6,8 @@
  * Title: rule_engine.h
  * Description: Header for RuleEngine class that processes canonical messages
  *              against rule sets. Evaluates single-message rules and sequence
- *              rules, extracts event data, and generates events when rules match.
+ *              rules, extracts event data, and generates events when rules match;
+ *              aggregate rules summarize messages per cell, eNB or MME per window.
  */
 
 #pragma once
@@ -14,11 +15,20 @@
 #include "canonical_message.pb.h"
 #include "event.pb.h"
 #include "s1see/correlate/correlator.h"
+#include "s1see/decode/decode_level.h"
+#include "s1see/utils/expiry_queue.h"
+#include "s1see/utils/small_vector.h"
+#include "s1see/utils/hyperloglog.h"
 #include <memory>
 #include <vector>
 #include <string>
 #include <chrono>
 #include <unordered_map>
+#include <map>
+#include <deque>
+#include <optional>
+#include <cstdint>
+#include <utility>
 
 namespace s1see {
 namespace rules {
@@ -26,7 +36,9 @@ namespace rules {
 // Event data extraction specification
 // Supports expressions like:
 //   "message.ecgi" - from current message
+//   "message.decoded_tree" - decoded tree JSON (built only when a rule asks for it)
 //   "first_message.ecgi" - from first message (sequence rules only)
+//   "step2.ecgi" - from the second step's message (sequence rules only)
 //   "context.source_ecgi" - from UE context
 //   "context.ecgi" - from UE context
 struct EventDataExtraction {
@@ -34,6 +46,39 @@ struct EventDataExtraction {
     std::string source_expression; // Source expression (e.g., "message.ecgi")
 };
 
+// Pre-parsed source expression, resolved once when a ruleset is loaded
+enum class ExtractionSource : uint8_t {
+    MESSAGE,
+    FIRST_MESSAGE,
+    CONTEXT,
+    STEP,
+    INVALID
+};
+
+// Stored by value in snapshots; add new fields just before UNKNOWN
+enum class ExtractionField : uint8_t {
+    ECGI,
+    TARGET_ECGI,
+    SOURCE_ECGI,
+    MME_UE_S1AP_ID,
+    ENB_UE_S1AP_ID,
+    IMSI,
+    TMSI,
+    MSG_TYPE,
+    DECODED_TREE,
+    UNKNOWN
+};
+
+struct CompiledExtraction {
+    std::string target_attribute;
+    ExtractionSource source = ExtractionSource::INVALID;
+    ExtractionField field = ExtractionField::UNKNOWN;
+    uint8_t step = 0;  // FIRST_MESSAGE and STEP: the step read, from 0
+};
+
+// Parse "source.field"; unknown sources or fields never yield a value
+CompiledExtraction compile_extraction(const EventDataExtraction& extraction);
+
 // Rule types
 struct SingleMessageRule {
     std::string event_name;
@@ -42,77 +87,357 @@ struct SingleMessageRule {
     std::vector<EventDataExtraction> event_data; // Data extraction specifications
 };
 
+// Most steps a sequence rule can have
+constexpr size_t kMaxSequenceSteps = 32;
+
+// Fires when the steps' message types are seen in order for one
+// subscriber, other messages in between, within time_window of the first.
+// A two-step rule may set first/second_msg_type; steps, if set, lists
+// every step and takes precedence.
 struct SequenceRule {
     std::string event_name;
     std::string first_msg_type;
     std::string second_msg_type;
+    std::vector<std::string> steps;
     std::chrono::milliseconds time_window;
     std::map<std::string, std::string> attributes;
     std::vector<EventDataExtraction> event_data; // Data extraction specifications
 };
 
+// Most slides a sliding window can span
+constexpr size_t kMaxWindowPanes = 1024;
+
+// Summary of the messages of each key (cell, eNB or MME) over a window of
+// capture time, emitted as one event when the window closes
+struct AggregateRule {
+    enum class Function : uint8_t {
+        COUNT,         // Messages of msg_types
+        DISTINCT_UES,  // Subscribers with one (HyperLogLog estimate)
+        RATIO          // Messages of msg_types per message of total_msg_types
+    };
+    enum class Key : uint8_t {
+        ECGI,  // The message's cell, else the UE's current cell
+        ENB,   // enb_id, the message's or else the UE context's
+        MME    // mme_id, likewise
+    };
+    
+    std::string event_name;
+    Function function = Function::COUNT;
+    Key key = Key::ECGI;
+    std::vector<std::string> msg_types;
+    std::vector<std::string> total_msg_types;  // RATIO only
+    std::chrono::milliseconds window = std::chrono::milliseconds(60000);
+    // Sliding: a window ends every slide, which must divide window. Zero:
+    // tumbling, one window after another.
+    std::chrono::milliseconds slide = std::chrono::milliseconds(0);
+    // Only windows whose value reaches threshold are emitted, and for RATIO
+    // only those with at least min_total messages of total_msg_types
+    std::optional<double> threshold;
+    uint64_t min_total = 0;
+    std::map<std::string, std::string> attributes;
+};
+
 struct Ruleset {
     std::string id;
     std::string version;
     std::vector<SingleMessageRule> single_message_rules;
     std::vector<SequenceRule> sequence_rules;
+    std::vector<AggregateRule> aggregate_rules;
+};
+
+// Partial aggregate of one key over one pane of a rule: a slide of a
+// sliding window, or a whole tumbling window. Panes of the same rule, key
+// and start kept by several engines merge into one.
+struct AggregatePane {
+    uint64_t rule_fingerprint = 0;
+    std::string key;        // ECGI bytes, or the eNB or MME id
+    int64_t start_ns = 0;
+    uint64_t count = 0;     // Messages of msg_types
+    uint64_t total = 0;     // Messages of total_msg_types
+    utils::HyperLogLog ues; // DISTINCT_UES only
+    
+    void merge(const AggregatePane& other) {
+        count += other.count;
+        total += other.total;
+        ues.merge(other.ues);
+    }
+};
+
+// Steps of a rule in order: steps, or first and second msg_type
+std::vector<std::string> sequence_steps(const SequenceRule& rule);
+
+// Spool position of a matched step's message
+struct StepEvidence {
+    int32_t partition;
+    int64_t offset;
+    int64_t frame_number;  // 0 if not from a PCAP
 };
 
-// Sequence state tracking
+// One sequence rule's automaton for one subscriber. Only the steps matched
+// so far, each matched message's spool position and the values the rule
+// extracts from it are kept, not the messages with their raw bytes and
+// decoded trees.
 struct SequenceState {
-    std::string subscriber_key;
-    std::string first_msg_type;
-    CanonicalMessage first_message;
-    std::chrono::system_clock::time_point first_seen;
-    std::string ruleset_id;
-    std::string ruleset_version;
+    static constexpr uint32_t UNBOUND = UINT32_MAX;
+    
+    uint64_t rule_fingerprint = 0;   // Identifies the rule across reloads and snapshots
+    uint32_t ruleset = UNBOUND;      // The rule in the installed rules; UNBOUND
+    uint32_t rule = 0;               // (e.g. restored before its rules) never advances
+    uint32_t steps_matched = 0;      // 1 .. steps - 1
+    int64_t first_seen_ns = 0;       // First step's capture time
+    utils::SmallVector<StepEvidence, 4> evidence; // Per matched step
+    // Per value: step (uint8_t), field (uint8_t), length (uint32_t), bytes,
+    // as extraction renders them; empty values are not kept
+    std::string captured;
 };
 
 // Event Engine
 class RuleEngine {
 public:
-    explicit RuleEngine(std::shared_ptr<correlate::Correlator> correlator);
+    struct Config {
+        Config() : event_time(false), emit_aggregates(true), shard(0) {}
+        
+        // Event time: sequence windows compare the two messages' ts_capture
+        // and state expiry follows the watermark (or latest ts_capture).
+        // Processing time (the default): both use the wall clock.
+        bool event_time;
+        
+        // close_windows() returns the summary events of aggregate windows.
+        // Off: closed panes wait for take_closed_panes(), for an owner that
+        // merges those of several engines (see merge_panes).
+        bool emit_aggregates;
+        
+        // Told apart in distinct-UE counts merged from several engines,
+        // whose subscriber IDs overlap
+        uint32_t shard;
+    };
+    
+    // Compiled dispatch: msg_type -> candidate rules in evaluation order
+    // (rulesets in load order; per ruleset, single rules then sequence rules).
+    // A sequence rule has one entry per distinct step type, whose steps
+    // mask is its transition table: bit k is set if the type is step k.
+    // An aggregate rule's mask has bit 0 set if the type is counted and
+    // bit 1 if it is totalled.
+    struct RuleRef {
+        enum class Kind : uint8_t { SINGLE, SEQUENCE, AGGREGATE };
+        Kind kind;
+        uint32_t ruleset;
+        uint32_t rule;
+        uint32_t steps = 0;
+    };
+    
+    // A sequence rule compiled to an automaton
+    struct SequenceAutomaton {
+        uint32_t num_steps = 0;  // Rules outside 2..kMaxSequenceSteps never match
+        int64_t window_ns = 0;
+        uint64_t fingerprint = 0;  // Ruleset id and rule fields
+        // Fields the rule extracts from each step's message but the last
+        std::vector<std::vector<ExtractionField>> captured_fields;
+    };
+    
+    // An aggregate rule's windows
+    struct CompiledAggregate {
+        int64_t window_ns = 0;
+        int64_t pane_ns = 0;       // Slide, or window if tumbling; 0 never matches
+        uint64_t fingerprint = 0;  // Ruleset id and rule fields
+    };
+    
+    // Compiled event_data, automata and windows, parallel to rulesets[i].*_rules
+    struct CompiledRuleset {
+        std::vector<std::vector<CompiledExtraction>> single_event_data;
+        std::vector<std::vector<CompiledExtraction>> sequence_event_data;
+        std::vector<SequenceAutomaton> sequences;
+        std::vector<CompiledAggregate> aggregates;
+    };
     
-    // Load ruleset from YAML
+    // A set of rulesets compiled for evaluation. Immutable once built, so
+    // one copy is shared by every engine it is installed in, and a reload
+    // builds a new one on any thread while the old one is still in use.
+    struct CompiledRules {
+        std::vector<Ruleset> rulesets;
+        std::unordered_map<std::string, std::vector<RuleRef>> dispatch;
+        std::vector<CompiledRuleset> compiled;
+        
+        // Aggregate rules by fingerprint, which panes carry
+        std::unordered_map<uint64_t, RuleRef> aggregate_index;
+        
+        decode::DecodeLevel decode_level = decode::DecodeLevel::IDENTIFIERS;
+    };
+    
+    explicit RuleEngine(std::shared_ptr<correlate::Correlator> correlator,
+                        const Config& config = Config());
+    
+    // Compile rulesets, in evaluation order. Pure, so it runs off the hot
+    // path on whatever thread loads the rules.
+    static std::shared_ptr<const CompiledRules> compile(std::vector<Ruleset> rulesets);
+    
+    // Replace the rules. Call between messages on the thread that calls
+    // process(); it swaps a pointer and drops the sequence states of rules
+    // the new set does not have. A sequence rule is unchanged if its
+    // ruleset id and every field are the same in both sets; its states
+    // are kept, so a reload does not forget in-flight sequences. States
+    // restored from a snapshot wait, unbound, until their rule is installed.
+    void install_rules(std::shared_ptr<const CompiledRules> rules);
+    
+    // Rules in use (never null)
+    const std::shared_ptr<const CompiledRules>& rules() const { return rules_; }
+    
+    // Add a ruleset after those loaded (compiles and installs a new set)
     void load_ruleset(const Ruleset& ruleset);
     
     // Process a canonical message and emit events
-    std::vector<Event> process(const CanonicalMessage& message);
+    // parse_result is the decoder's native result, handed to the correlator
+    // so it need not rebuild one from the decoded_tree JSON
+    std::vector<Event> process(const CanonicalMessage& message,
+                               const s1ap_parser::S1apParseResult* parse_result = nullptr);
+    
+    // Rule evaluation alone, for a subscriber the caller has already
+    // resolved through this engine's correlator (process() does both)
+    std::vector<Event> evaluate(const CanonicalMessage& message, correlate::SubscriberId subscriber_id);
+    
+    // Decode level the loaded rules need: FULL_TREE if any extracts from
+    // the decoded_tree JSON, else IDENTIFIERS
+    decode::DecodeLevel decode_level() const;
     
-    // Cleanup expired sequence states
+    // Cleanup expired sequence states. Only subscribers with a state that
+    // is due are visited. In event time the clock is the watermark if one
+    // has been set, else the latest message ts_capture seen, else the wall clock.
     void cleanup_expired_sequences();
+    
+    // Advance the event-time watermark (nanoseconds; never moves back)
+    void advance_watermark(int64_t watermark_ns);
+    
+    // The rules' clock: in event time the watermark if one has been set,
+    // else the latest message ts_capture seen, else the wall clock
+    int64_t now_ns() const { return current_time_ns(); }
+    
+    // Close the aggregate panes that end by now_ns. With
+    // config.emit_aggregates the summary events of the windows they
+    // complete are returned; otherwise the panes wait for
+    // take_closed_panes() and nothing is.
+    std::vector<Event> close_windows(int64_t now_ns);
+    std::vector<Event> close_windows() { return close_windows(now_ns()); }
+    
+    // Move out the panes closed so far
+    void take_closed_panes(std::vector<AggregatePane>& panes);
+    
+    // Merge closed panes, from this engine or several closed at the same
+    // now_ns, and return the events of the windows ending by now_ns. Sliding
+    // windows keep their recent panes here, so every pane of a rule must
+    // be merged by the same engine.
+    std::vector<Event> merge_panes(std::vector<AggregatePane> panes, int64_t now_ns);
+    
+    // Open aggregate panes, over all rules and keys
+    size_t aggregate_pane_count() const { return open_panes_.size(); }
+    
+    // Messages not counted because their pane had already closed
+    uint64_t late_aggregate_messages() const { return late_aggregate_messages_; }
+    
+    // Number of subscribers with pending sequence state
+    size_t pending_sequence_count() const { return sequence_states_.size(); }
+    
+    // Number of pending sequence states, over all subscribers
+    size_t sequence_state_count() const { return sequence_state_count_; }
+    
+    // Write pending sequences and clocks as snapshot shard `shard`
+    void save_snapshot(snapshot::SnapshotWriter& writer, uint32_t shard) const;
+    
+    // Restore state saved by save_snapshot. Subscriber IDs refer to the
+    // correlator contexts restored from the same snapshot shard.
+    void load_snapshot(const snapshot::SnapshotReader& reader, uint32_t shard);
 
 private:
+    Config config_;
     std::shared_ptr<correlate::Correlator> correlator_;
-    std::vector<Ruleset> rulesets_;
+    std::shared_ptr<const CompiledRules> rules_;
+    
+    // Sequence state: subscriber ID -> vector of active sequences
+    std::unordered_map<correlate::SubscriberId, std::vector<SequenceState>> sequence_states_;
+    size_t sequence_state_count_ = 0;
+    
+    // Per-subscriber deadline of its oldest sequence state
+    utils::ExpiryQueue<correlate::SubscriberId> sequence_expiry_;
+    // Aggregate panes being filled, by rule fingerprint, key and start
+    struct PaneKey {
+        uint64_t rule_fingerprint;
+        std::string key;
+        int64_t start_ns;
+        bool operator==(const PaneKey& other) const = default;
+    };
+    struct PaneKeyHash {
+        size_t operator()(const PaneKey& k) const {
+            return std::hash<std::string>{}(k.key) ^ (k.rule_fingerprint * 0x9E3779B97F4A7C15ULL) ^
+                   static_cast<size_t>(k.start_ns);
+        }
+    };
+    std::unordered_map<PaneKey, AggregatePane, PaneKeyHash> open_panes_;
+    int64_t next_pane_end_ns_ = INT64_MAX;  // Earliest end of an open pane
+    int64_t windows_closed_ns_ = 0;         // now_ns of the last close_windows()
+    std::vector<AggregatePane> closed_panes_;
+    uint64_t late_aggregate_messages_ = 0;
     
-    // Sequence state: subscriber_key -> vector of active sequences
-    std::unordered_map<std::string, std::vector<SequenceState>> sequence_states_;
+    // Sliding windows: the panes a later window still covers, per rule and
+    // key (start_ns 0), and the end of the last window closed
+    struct WindowHistory {
+        std::deque<AggregatePane> panes;
+        int64_t last_end_ns = 0;
+    };
+    std::unordered_map<PaneKey, WindowHistory, PaneKeyHash> window_history_;
+    int64_t next_window_end_ns_ = INT64_MAX;
     
-    std::vector<Event> check_single_message_rules(const CanonicalMessage& message,
-                                                   const Ruleset& ruleset,
-                                                   const std::string& subscriber_key);
-    std::vector<Event> check_sequence_rules(const CanonicalMessage& message,
-                                           const Ruleset& ruleset,
-                                           const std::string& subscriber_key);
+    int64_t clock_ns_ = 0; // Latest ts_capture seen; 0 until one arrives
+    int64_t watermark_ns_ = 0; // Set by the pipeline; 0 until advanced
+    
+    int64_t current_time_ns() const;
+    int64_t message_time_ns(const CanonicalMessage& message) const;
+    
+    Event apply_single_rule(const RuleRef& ref,
+                            const CanonicalMessage& message,
+                            correlate::SubscriberId subscriber_id);
+    // Step a subscriber's automaton for the rule: a message of its next
+    // step type within the window advances it (the last step emits the
+    // event), else one of its first step type restarts it
+    void advance_sequence(const RuleRef& ref,
+                          const CanonicalMessage& message,
+                          correlate::SubscriberId subscriber_id,
+                          std::vector<Event>& events);
+    void capture_step(SequenceState& state,
+                      const SequenceAutomaton& automaton,
+                      const CanonicalMessage& message);
+    Event complete_sequence(const RuleRef& ref,
+                            const SequenceState& state,
+                            const CanonicalMessage& message,
+                            correlate::SubscriberId subscriber_id);
+    
+    // Point states at their rule in rules_ by fingerprint; drop bound
+    // states whose rule is gone
+    void bind_sequences();
+    
+    // Count a message into its pane of an aggregate rule
+    void accumulate(const RuleRef& ref,
+                    const CanonicalMessage& message,
+                    correlate::SubscriberId subscriber_id);
+    // Summary event of a window, unless below the rule's thresholds
+    void emit_window(const RuleRef& ref, const AggregatePane& window, int64_t end_ns,
+                     std::vector<Event>& events) const;
     Event create_event(const std::string& name,
                       const CanonicalMessage& message,
                       const std::map<std::string, std::string>& attributes,
                       const std::string& ruleset_id,
                       const std::string& ruleset_version,
-                      const std::string& subscriber_key);
+                      correlate::SubscriberId subscriber_id);
+    
+    // Extract data value from a compiled expression
+    std::string extract_event_data_value(const CompiledExtraction& extraction,
+                                        const CanonicalMessage& message,
+                                        const SequenceState* sequence,
+                                        correlate::SubscriberId subscriber_id);
     
     // Extract data value from expression
     std::string extract_event_data_value(const std::string& expression,
                                         const CanonicalMessage& message,
-                                        const CanonicalMessage* first_message,
-                                        const std::string& subscriber_key);
-    
-    // Extract data from expression and add to event attributes
-    void extract_event_data(Event& event,
-                           const std::string& expression,
-                           const CanonicalMessage& message,
-                           const CanonicalMessage* first_message = nullptr);
+                                        const SequenceState* sequence,
+                                        correlate::SubscriberId subscriber_id);
 };
 
 } // namespace rules
@@ -0,0 +1,82 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: ruleset_watcher.h
+ * Description: Header for RulesetWatcher, which polls a YAML ruleset file and
+ *              hands each new version to a callback, so a running processor
+ *              picks up rule changes without a restart.
+ */
+
+#pragma once
+
+#include "s1see/rules/rule_engine.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace s1see {
+namespace rules {
+
+// Polls the file's inode, size and modification time, which catches both
+// editors that rewrite in place and ones that rename a new file over it.
+// A changed file is loaded with load_ruleset_from_yaml on the watcher
+// thread; one that fails to load is reported on stderr and skipped, so
+// the rules in use stay until a good version appears.
+class RulesetWatcher {
+public:
+    struct Config {
+        Config() : poll_interval(std::chrono::seconds(1)) {}
+        std::string path;
+        std::chrono::milliseconds poll_interval;
+    };
+    
+    using ReloadCallback = std::function<void(const Ruleset& ruleset)>;
+    
+    // The file as it is now counts as loaded; only later changes reload
+    RulesetWatcher(const Config& config, ReloadCallback on_reload);
+    ~RulesetWatcher();  // stop()
+    
+    RulesetWatcher(const RulesetWatcher&) = delete;
+    RulesetWatcher& operator=(const RulesetWatcher&) = delete;
+    
+    // Poll on a thread every poll_interval
+    void start();
+    void stop();
+    
+    // Poll once on the calling thread; true if a new version was loaded
+    // and handed to the callback
+    bool check();
+    
+    uint64_t reloads() const { return reloads_.load(std::memory_order_relaxed); }
+    uint64_t failures() const { return failures_.load(std::memory_order_relaxed); }
+
+private:
+    struct FileVersion {
+        uint64_t inode = 0;
+        int64_t size = -1;
+        int64_t mtime_ns = 0;
+        bool operator==(const FileVersion& other) const = default;
+    };
+    
+    Config config_;
+    ReloadCallback on_reload_;
+    FileVersion seen_;
+    std::atomic<uint64_t> reloads_{0};
+    std::atomic<uint64_t> failures_{0};
+    
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable stop_cv_;
+    bool stopping_ = false;
+    
+    FileVersion version() const;
+};
+
+} // namespace rules
+} // namespace s1see
@@ -0,0 +1,106 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: arrow_sink.h
+ * Description: Header for ArrowSink, which batches events into columns and
+ *              writes them as Arrow IPC files (Feather v2), with the
+ *              repetitive string columns dictionary-encoded. Files roll by
+ *              age and size and are readable by pyarrow, pandas, DuckDB and
+ *              Spark without conversion.
+ */
+
+#pragma once
+
+#include "s1see/sinks/sink.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace s1see {
+namespace sinks {
+
+// Columns, in schema order:
+//   name                          dictionary<int32, utf8>
+//   ts                            timestamp[ns, UTC]
+//   subscriber_key                dictionary<int32, utf8>
+//   confidence                    double
+//   ruleset_id, ruleset_version   dictionary<int32, utf8>
+//   one per dictionary attribute  dictionary<int32, utf8>, null when the event lacks it
+//   attributes                    map<utf8, utf8>, the remaining attribute keys
+//   evidence                      list<struct<partition: int32, offset: int64, frame_number: int64>>
+//
+// Each file carries its own dictionaries, so files can be read, moved or
+// deleted independently. Rows are held in memory until the file rolls; a
+// file is written to a .tmp name and renamed once complete, so readers
+// never see a partial file.
+class ArrowSink : public Sink {
+public:
+    struct Config {
+        Config()
+            : directory("events"),
+              file_prefix("events"),
+              batch_rows(65536),
+              roll_bytes(64 << 20),
+              roll_interval(std::chrono::seconds(300)),
+              dictionary_attributes({"category", "action", "severity", "phase", "msg_type", "ecgi",
+                                     "source_cell_id", "target_cell_id"}) {}
+
+        std::string directory;
+        std::string file_prefix;            // Files are <prefix>-<UTC time>-<seq>.arrow
+        size_t batch_rows;                  // Rows per record batch
+        size_t roll_bytes;                  // Roll once the file would reach this size
+        std::chrono::seconds roll_interval; // Roll once the first buffered event is this old;
+                                            // checked on emit and flush
+        std::vector<std::string> dictionary_attributes;  // Attribute keys stored as their own column
+    };
+
+    struct Stats {
+        uint64_t files_written = 0;
+        uint64_t events_written = 0;
+        uint64_t bytes_written = 0;
+    };
+
+    // Throws std::runtime_error if the directory cannot be created or a
+    // dictionary attribute clashes with another column
+    explicit ArrowSink(const Config& config = Config());
+    ~ArrowSink();
+
+    bool emit(const Event& event) override;
+    bool emit_batch(const std::vector<Event>& events) override;
+
+    // Writes out the open file if it has reached its roll interval
+    void flush() override;
+
+    // Writes out the open file; later emits fail
+    void close() override;
+
+    // Writes out the open file now, whatever its age or size. Returns false
+    // if the file could not be written (its events are dropped).
+    bool roll();
+
+    Stats stats() const { return stats_; }
+
+    // Column names in schema order
+    std::vector<std::string> column_names() const;
+
+private:
+    class Columns;
+
+    Config config_;
+    std::unique_ptr<Columns> columns_;
+    std::chrono::steady_clock::time_point file_started_;
+    uint64_t file_sequence_ = 0;
+    bool closed_ = false;
+    Stats stats_;
+
+    bool append(const Event& event);
+    bool write_file();
+};
+
+} // namespace sinks
+} // namespace s1see
@@ -0,0 +1,125 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: async_sink.h
+ * Description: Header for AsyncSink, a wrapper that decouples event emission
+ *              from a slow sink. Events are queued in a bounded ring buffer
+ *              and written by a dedicated thread through the wrapped sink's
+ *              emit_batch, with a configurable policy when the ring is full.
+ */
+
+#pragma once
+
+#include "s1see/sinks/sink.h"
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace s1see {
+namespace sinks {
+
+class AsyncSink : public Sink {
+public:
+    enum class OverflowPolicy {
+        BLOCK,          // Producers wait for the writer (no loss)
+        DROP_OLDEST,    // Overwrite the oldest queued event
+        SPILL_TO_DISK   // Append to a spill file, replayed in order once drained
+    };
+
+    struct Config {
+        Config() : capacity(8192), max_batch(256), overflow(OverflowPolicy::BLOCK) {}
+        size_t capacity;            // Ring buffer slots
+        size_t max_batch;           // Events per emit_batch call
+        OverflowPolicy overflow;
+        std::string spill_path;     // Required for SPILL_TO_DISK
+    };
+
+    struct Stats {
+        size_t queue_depth = 0;     // Events queued in memory
+        uint64_t spill_depth = 0;   // Events waiting in the spill file
+        uint64_t enqueued = 0;
+        uint64_t emitted = 0;
+        uint64_t dropped = 0;
+        uint64_t spilled = 0;
+        uint64_t failed = 0;        // Events in batches the sink rejected
+    };
+
+    // Starts the writer thread. Throws std::runtime_error if the spill file
+    // cannot be opened.
+    explicit AsyncSink(std::shared_ptr<Sink> sink, const Config& config = Config());
+    ~AsyncSink();
+
+    // Queue events; returns false only if an event was dropped or the sink
+    // is closed. Safe to call from multiple threads.
+    bool emit(const Event& event) override;
+    bool emit_batch(const std::vector<Event>& events) override;
+
+    // Wait until every queued and spilled event is written, then flush the
+    // wrapped sink
+    void flush() override;
+
+    // Drain, stop the writer thread and close the wrapped sink
+    void close() override;
+
+    Stats stats() const;
+
+    // Events are accepted when queued and delivered once the wrapped sink
+    // has written them, or once it reports them delivered if it tracks
+    // delivery itself. After any event is dropped or rejected, delivery
+    // stops advancing, so commits stop short of the loss and a restart
+    // replays it. DROP_OLDEST makes no delivery promise and reports
+    // nothing.
+    uint64_t accepted_sequence() const override;
+    uint64_t delivered_sequence() const override;
+
+    // The wrapped sink's
+    decode::DecodeLevel decode_level() const override { return sink_->decode_level(); }
+
+    const std::shared_ptr<Sink>& sink() const { return sink_; }
+
+private:
+    void writer_loop();
+    bool enqueue_locked(const Event& event, std::unique_lock<std::mutex>& lock);
+    void spill_locked(const Event& event);
+    bool read_spill_locked(std::vector<Event>& batch);
+    bool idle_locked() const { return count_ == 0 && spill_pending_ == 0 && !writing_; }
+    void mark_lost_locked();
+
+    std::shared_ptr<Sink> sink_;
+    Config config_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::condition_variable drained_;
+
+    // Ring buffer of capacity slots; head_ is the oldest event
+    std::vector<Event> ring_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+
+    // Spill file of length-prefixed serialized events. Once anything is
+    // spilled, new events follow it to the file until the writer catches
+    // up, so emission order is preserved.
+    std::fstream spill_;
+    uint64_t spill_write_pos_ = 0;
+    uint64_t spill_read_pos_ = 0;
+    uint64_t spill_pending_ = 0;
+
+    bool writing_ = false;      // Writer holds a batch outside the lock
+    bool stopping_ = false;
+    bool lost_ = false;         // An accepted event was dropped or rejected
+    uint64_t emitted_at_loss_ = 0;
+    Stats stats_;
+    std::thread writer_;
+};
+
+} // namespace sinks
+} // namespace s1see
@@ -0,0 +1,29 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: event_json.h
+ * Description: Direct Event to JSON serializer for the sinks. Produces the
+ *              same text as protobuf's MessageToJsonString with
+ *              preserve_proto_field_names (field order, int64 as strings,
+ *              default values omitted, protobuf's escaping and number
+ *              formatting) without going through reflection.
+ */
+
+#pragma once
+
+#include "event.pb.h"
+#include <string>
+
+namespace s1see {
+namespace sinks {
+
+// Append the JSON object for event to out (no trailing newline)
+void append_event_json(const Event& event, std::string& out);
+
+// Convenience wrapper returning a new string
+std::string event_to_json(const Event& event);
+
+} // namespace sinks
+} // namespace s1see
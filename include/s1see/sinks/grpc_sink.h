@@ -0,0 +1,105 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: grpc_sink.h
+ * Description: Header for GrpcEventSink, which serves emitted events to
+ *              subscribers over the EventStreamService gRPC stream, in
+ *              batches, and counts an event as delivered once a subscriber
+ *              acks it.
+ */
+
+#pragma once
+
+#include "s1see/sinks/sink.h"
+#include "event_service.grpc.pb.h"
+#include <grpcpp/grpcpp.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace s1see {
+namespace sinks {
+
+// Events are numbered from 1 as they are emitted and held in a buffer until
+// acked. Each subscriber gets every event after its resume point, in order,
+// in batches of up to max_batch that wait up to linger to fill. An ack from
+// any subscriber delivers (and releases) every event up to it, so one
+// consumer, or several resuming from a shared checkpoint, is the intended
+// use. With the buffer full, emit blocks until a subscriber acks, which
+// pushes back on the pipeline rather than dropping events.
+class GrpcEventSink : public Sink, public EventStreamService::Service {
+public:
+    struct Config {
+        Config()
+            : listen_address("0.0.0.0:50052"),
+              buffer_events(65536),
+              max_batch(512),
+              linger(std::chrono::milliseconds(5)),
+              compress(true) {}
+        std::string listen_address;
+        size_t buffer_events;             // Unacked events held for subscribers
+        size_t max_batch;                 // Events per streamed batch
+        std::chrono::milliseconds linger; // How long a partial batch waits for more events
+        bool compress;                    // gzip the stream (gRPC has no lz4 or zstd codec)
+    };
+
+    struct Stats {
+        size_t subscribers = 0;
+        size_t buffered = 0;      // Emitted, not yet acked
+        uint64_t sent = 0;        // Events written to subscriber streams
+        uint64_t delivered = 0;
+    };
+
+    explicit GrpcEventSink(const Config& config = Config());
+    ~GrpcEventSink();
+
+    bool start();
+    void stop();
+
+    // Port bound by start(), for listen addresses ending in :0
+    int port() const { return port_; }
+
+    bool emit(const Event& event) override;
+    bool emit_batch(const std::vector<Event>& events) override;
+
+    // Stops the server; events not yet acked stay undelivered
+    void close() override;
+
+    uint64_t accepted_sequence() const override;
+    uint64_t delivered_sequence() const override;
+
+    Stats stats() const;
+
+    // gRPC service implementation
+    grpc::Status Subscribe(grpc::ServerContext* context,
+                           grpc::ServerReaderWriter<EventBatch, EventStreamRequest>* stream) override;
+
+private:
+    void acknowledge_locked(int64_t sequence);
+
+    Config config_;
+    std::unique_ptr<grpc::Server> server_;
+    int port_ = 0;
+    std::atomic<bool> running_{false};
+
+    mutable std::mutex mutex_;
+    std::condition_variable events_ready_;  // New events, or stopping
+    std::condition_variable space_ready_;   // Buffer space freed by an ack, or stopping
+    std::deque<Event> buffer_;              // Events first_buffered_ .. accepted_
+    int64_t first_buffered_ = 1;
+    int64_t accepted_ = 0;
+    int64_t delivered_ = 0;
+    bool stopping_ = false;
+    Stats stats_;
+};
+
+} // namespace sinks
+} // namespace s1see
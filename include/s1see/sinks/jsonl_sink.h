@@ -13,27 +13,34 @@
 
 #include "s1see/sinks/sink.h"
 #include <string>
-#include <fstream>
 
 namespace s1see {
 namespace sinks {
 
 class JSONLSink : public Sink {
 public:
-    explicit JSONLSink(const std::string& file_path);
+    // Events are serialized into an in-memory buffer and written to the
+    // file in write() calls of about buffer_bytes each. decode_level asks
+    // for IE or decoded tree attributes on the events (see Sink).
+    explicit JSONLSink(const std::string& file_path, size_t buffer_bytes = 1 << 20,
+                       decode::DecodeLevel decode_level = decode::DecodeLevel::IDENTIFIERS);
     ~JSONLSink();
     
     bool emit(const Event& event) override;
+    bool emit_batch(const std::vector<Event>& events) override;
     void flush() override;
     void close() override;
+    decode::DecodeLevel decode_level() const override { return decode_level_; }
 
 private:
+    bool write_buffer();
+    
     std::string file_path_;
-    std::ofstream file_;
-    bool opened_;
+    int fd_;
+    size_t buffer_bytes_;
+    std::string buffer_;
+    decode::DecodeLevel decode_level_;
 };
 
 } // namespace sinks
 } // namespace s1see
-
-
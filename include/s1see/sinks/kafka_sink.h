@@ -0,0 +1,133 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: kafka_sink.h
+ * Description: Header for KafkaSink, which produces events to a Kafka topic
+ *              (librdkafka) keyed by subscriber, with producer-side batching
+ *              and compression, and reports delivery so spool commits can
+ *              wait for the broker's acks.
+ */
+
+#pragma once
+
+#include "s1see/sinks/sink.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace s1see {
+namespace sinks {
+
+// Tracks which of events 1, 2, ... have been delivered when acks arrive out
+// of order (Kafka partitions complete independently), and reports the
+// contiguous delivered prefix
+class DeliveryWindow {
+public:
+    void complete(uint64_t sequence) {
+        if (sequence != delivered_ + 1) {
+            early_.insert(sequence);
+            return;
+        }
+        ++delivered_;
+        while (!early_.empty() && *early_.begin() == delivered_ + 1) {
+            early_.erase(early_.begin());
+            ++delivered_;
+        }
+    }
+    uint64_t delivered() const { return delivered_; }
+    size_t out_of_order() const { return early_.size(); }
+
+private:
+    uint64_t delivered_ = 0;
+    std::set<uint64_t> early_;  // Delivered ahead of the prefix
+};
+
+// Events are keyed by subscriber_key, so the partitioner sends each UE's
+// events to one partition and the idempotent producer keeps them in order
+// across retries. A delivery that fails after librdkafka's retries holds
+// delivered_sequence() back for the life of the sink: the pipeline stops
+// committing and a restart replays from the last delivered record.
+// Requires building with librdkafka (HAVE_RDKAFKA); otherwise start() fails.
+class KafkaSink : public Sink {
+public:
+    enum class Format {
+        JSON,       // Same text as JSONLSink, one event per record
+        PROTOBUF    // Serialized Event
+    };
+
+    struct Config {
+        Config()
+            : linger(std::chrono::milliseconds(5)),
+              batch_size(10000),
+              compression("lz4"),
+              acks("all"),
+              format(Format::JSON),
+              flush_timeout(std::chrono::seconds(10)) {}
+        std::string brokers;
+        std::string topic;
+        std::chrono::milliseconds linger;         // linger.ms: wait to fill a batch
+        size_t batch_size;                        // batch.num.messages per partition batch
+        std::string compression;                  // compression.codec: none, gzip, snappy, lz4, zstd
+        std::string acks;                         // "all" waits for the in-sync replicas
+        Format format;
+        std::chrono::milliseconds flush_timeout;  // How long flush() and close() wait for acks
+        std::map<std::string, std::string> properties;  // Extra librdkafka settings
+    };
+
+    struct Stats {
+        uint64_t produced = 0;   // Accepted by the producer
+        uint64_t delivered = 0;  // Acked by the broker
+        uint64_t failed = 0;     // Rejected by the producer or failed after retries
+    };
+
+    explicit KafkaSink(const Config& config);
+    ~KafkaSink();
+
+    // Create the producer and start polling for delivery reports
+    bool start();
+
+    bool emit(const Event& event) override;
+
+    // Waits while the producer queue is full, so a stalled broker pushes
+    // back on the caller
+    bool emit_batch(const std::vector<Event>& events) override;
+
+    // Wait up to flush_timeout for outstanding deliveries
+    void flush() override;
+    void close() override;
+
+    uint64_t accepted_sequence() const override { return accepted_.load(); }
+    uint64_t delivered_sequence() const override;
+
+    Stats stats() const;
+
+    // Record value for an event. Public for tests.
+    static std::string encode(const Event& event, Format format);
+
+    // Called from librdkafka's delivery report callback
+    void on_delivery(uint64_t sequence, bool success, const char* error);
+
+private:
+    void poll_loop();
+
+    Config config_;
+    void* producer_ = nullptr;  // rd_kafka_t*, opaque so the header has no librdkafka dependency
+    void* topic_ = nullptr;     // rd_kafka_topic_t*
+    std::atomic<bool> running_{false};
+    std::thread poll_thread_;
+
+    std::atomic<uint64_t> accepted_{0};
+    mutable std::mutex delivery_mutex_;
+    DeliveryWindow window_;
+    Stats stats_;
+};
+
+} // namespace sinks
+} // namespace s1see
@@ -12,6 +12,8 @@
 #pragma once
 
 #include "event.pb.h"
+#include "s1see/decode/decode_level.h"
+#include <cstdint>
 #include <string>
 #include <memory>
 #include <vector>
@@ -43,6 +45,22 @@ public:
     
     // Close the sink
     virtual void close() {}
+    
+    // Delivery tracking. A sink that delivers after emit returns (a broker
+    // or a remote subscriber) numbers the events it accepts 1, 2, ... and
+    // reports the highest n such that events 1..n are durably delivered.
+    // The pipeline commits spool offsets only once every sink has
+    // delivered the events emitted for them. Sinks that are done with an
+    // event when emit returns keep the defaults, which never hold back a
+    // commit.
+    virtual uint64_t accepted_sequence() const { return 0; }
+    virtual uint64_t delivered_sequence() const { return 0; }
+    
+    // Message detail wanted on events. The pipeline decodes at the highest
+    // level any sink or rule asks for and adds, to each event of a message,
+    // an "ie.<IE name>" hex attribute per IE at IE_TABLE and the
+    // "decoded_tree" JSON at FULL_TREE. Those attributes reach every sink.
+    virtual decode::DecodeLevel decode_level() const { return decode::DecodeLevel::IDENTIFIERS; }
 };
 
 } // namespace sinks
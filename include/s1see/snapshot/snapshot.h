@@ -0,0 +1,225 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: snapshot.h
+ * Description: Binary snapshot of correlator and rule-engine state, tagged
+ *              with the consumer offsets it corresponds to. The file is a
+ *              header, a section table, fixed-size POD record arrays and a
+ *              byte blob for strings, so a reader maps it and walks records
+ *              in place. Used for warm restart without replaying the spool.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace s1see {
+namespace snapshot {
+
+// Snapshot file layout (native byte order, 8-byte aligned sections):
+//   FileHeader | SectionHeader[section_count] | section data... | blob
+constexpr char kMagic[8] = {'S', '1', 'S', 'E', 'E', 'S', 'N', 'P'};
+constexpr uint32_t kVersion = 3;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t section_count;
+    uint32_t shard_count;
+    uint32_t reserved;
+    int64_t created_ns;
+    int64_t watermark_ns;
+    uint64_t blob_offset;
+    uint64_t blob_bytes;
+    uint64_t checksum;      // FNV-1a over everything after the header
+};
+
+enum class SectionKind : uint32_t {
+    OFFSETS = 1,       // OffsetEntry
+    SUBSCRIBERS = 2,   // SubscriberEntry (S1apUeCorrelator records)
+    CONTEXTS = 3,      // ContextEntry (Correlator UE contexts)
+    SEQUENCES = 4,     // SequenceEntry (RuleEngine pending sequences)
+    CORRELATOR_STATE = 5,   // CorrelatorStateEntry (clocks and ID counters)
+    RULE_ENGINE_STATE = 6   // RuleEngineStateEntry (clocks)
+};
+
+struct SectionHeader {
+    SectionKind kind;
+    uint32_t shard;
+    uint32_t record_size;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t count;
+};
+
+// Bytes in the blob (presence of optional fields is in the entry flags)
+struct BlobRef {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct OffsetEntry {
+    int32_t partition;
+    int32_t reserved;
+    int64_t next_offset;    // Next record the consumer group will read
+    int64_t partition_time_ns;  // Latest ts_capture read from the partition
+};
+
+struct CorrelatorStateEntry {
+    int64_t clock_ns;
+    int64_t watermark_ns;
+    uint64_t next_context_id;
+    uint64_t next_unknown_id;
+};
+
+struct RuleEngineStateEntry {
+    int64_t clock_ns;
+    int64_t watermark_ns;
+};
+
+// Presence bits for optional fields
+enum : uint32_t {
+    HAS_IMSI = 1u << 0,
+    HAS_TMSI = 1u << 1,
+    HAS_IMEI = 1u << 2,
+    HAS_ENB_UE_S1AP_ID = 1u << 3,
+    HAS_MME_UE_S1AP_ID = 1u << 4,
+    HAS_GUTI = 1u << 5,
+    HAS_ENB_ID = 1u << 6,
+    HAS_MME_ID = 1u << 7,
+    HAS_MME_GROUP_ID = 1u << 8,
+    HAS_MME_CODE = 1u << 9,
+    HANDOVER_IN_PROGRESS = 1u << 10
+};
+
+struct SubscriberEntry {
+    uint32_t flags;
+    uint32_t enb_ue_s1ap_id;
+    uint32_t mme_ue_s1ap_id;
+    uint32_t reserved;
+    BlobRef imsi;
+    BlobRef tmsi;
+    BlobRef imeisv;
+    BlobRef teids;          // uint32_t array
+    double first_seen_timestamp;
+    double last_seen_timestamp;
+};
+
+struct ContextEntry {
+    uint64_t id;
+    uint32_t flags;
+    uint32_t key_kind;
+    uint32_t enb_ue_s1ap_id;
+    uint32_t mme_ue_s1ap_id;
+    int64_t last_seen_ns;
+    int64_t handover_start_ns;
+    BlobRef imsi;
+    BlobRef tmsi;
+    BlobRef imei;
+    BlobRef guti;
+    BlobRef enb_id;
+    BlobRef mme_id;
+    BlobRef mme_group_id;
+    BlobRef mme_code;
+    BlobRef ecgi;
+    BlobRef target_ecgi;
+    BlobRef source_ecgi;
+    BlobRef last_procedure;
+    BlobRef subscriber_key;
+};
+
+struct SequenceEntry {
+    uint64_t subscriber_id;
+    int64_t first_seen_ns;
+    uint64_t rule_fingerprint;
+    uint32_t steps_matched;
+    uint32_t reserved;
+    BlobRef evidence;       // Per matched step: partition (int32_t), offset (int64_t), frame number (int64_t)
+    BlobRef captured;       // Per value: step (uint8_t), field (uint8_t), length (uint32_t), bytes
+};
+
+// Accumulates sections in memory and writes them out atomically
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(uint32_t shard_count = 1) : shard_count_(shard_count) {}
+
+    void set_watermark(int64_t watermark_ns) { watermark_ns_ = watermark_ns; }
+
+    // Copy bytes into the blob
+    BlobRef add_blob(std::string_view bytes);
+    BlobRef add_blob(const void* data, size_t size);
+
+    template <typename T>
+    void add_record(SectionKind kind, uint32_t shard, const T& record) {
+        static_assert(std::is_trivially_copyable_v<T>, "snapshot records are POD");
+        Section& section = sections_[{kind, shard}];
+        section.record_size = sizeof(T);
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&record);
+        section.data.insert(section.data.end(), bytes, bytes + sizeof(T));
+        ++section.count;
+    }
+
+    // Write to path via a temporary file, fsync and rename. Throws
+    // std::runtime_error on I/O failure.
+    void write(const std::string& path) const;
+
+private:
+    struct Section {
+        uint32_t record_size = 0;
+        uint64_t count = 0;
+        std::vector<uint8_t> data;
+    };
+    uint32_t shard_count_;
+    int64_t watermark_ns_ = 0;
+    std::map<std::pair<SectionKind, uint32_t>, Section> sections_;
+    std::vector<uint8_t> blob_;
+};
+
+// Read-only view of a mapped snapshot file
+class SnapshotReader {
+public:
+    // Map and validate path. Throws std::runtime_error if the file is
+    // missing, truncated, of another version or fails its checksum.
+    explicit SnapshotReader(const std::string& path);
+    ~SnapshotReader();
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    const FileHeader& header() const { return *header_; }
+    uint32_t shard_count() const { return header_->shard_count; }
+    int64_t watermark() const { return header_->watermark_ns; }
+
+    // Records of a section, viewed in place (empty if absent)
+    template <typename T>
+    std::span<const T> records(SectionKind kind, uint32_t shard) const {
+        const SectionHeader* section = find(kind, shard);
+        if (!section || section->record_size != sizeof(T)) {
+            return {};
+        }
+        return {reinterpret_cast<const T*>(data_ + section->offset), section->count};
+    }
+
+    std::string_view blob(BlobRef ref) const;
+
+private:
+    const SectionHeader* find(SectionKind kind, uint32_t shard) const;
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    const FileHeader* header_ = nullptr;
+    const SectionHeader* sections_ = nullptr;
+};
+
+} // namespace snapshot
+} // namespace s1see
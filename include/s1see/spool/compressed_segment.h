@@ -0,0 +1,106 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: compressed_segment.h
+ * Description: Header for CompressedSegment, the block-compressed form of a
+ *              sealed WAL segment (.logz). Records are grouped into blocks
+ *              compressed independently against a per-segment dictionary,
+ *              with a block index so a read decompresses only the blocks
+ *              it touches.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace s1see {
+namespace spool {
+
+enum class SegmentCompression : uint16_t {
+    NONE = 0,
+    ZLIB = 1,   // Deflate with a preset dictionary sampled from the segment
+    ZSTD = 2    // zstd with a dictionary trained on the segment (HAVE_ZSTD)
+};
+
+// File layout, little-endian:
+//   header      magic "S1SZ", version (u16), codec (u16), dictionary size (u32),
+//               block count (u32), raw size (i64), block index position (i64)
+//   dictionary  dictionary size bytes
+//   blocks      each compressed on its own
+//   index       per block: raw position (i64), file position (i64),
+//               raw size (u32), compressed size (u32)
+//
+// Blocks hold whole records, so the raw positions in the segment's .idx
+// file stay valid: a record at raw position p lies in the last block whose
+// raw position is <= p.
+class CompressedSegment {
+public:
+    struct Options {
+        Options()
+            : codec(SegmentCompression::ZLIB),
+              block_size(64 * 1024),
+              level(0),
+              dictionary_size(16 * 1024) {}
+        SegmentCompression codec;
+        size_t block_size;       // Raw bytes per block; a larger record gets a block of its own
+        int level;               // 0 picks the codec's default
+        size_t dictionary_size;  // 0 disables the dictionary
+    };
+
+    struct Block {
+        int64_t raw_position;
+        int64_t file_position;
+        uint32_t raw_size;
+        uint32_t compressed_size;
+    };
+
+    CompressedSegment() = default;
+    CompressedSegment(const CompressedSegment&) = delete;
+    CompressedSegment& operator=(const CompressedSegment&) = delete;
+    ~CompressedSegment();
+
+    // Compress the raw segment at log_path into out_path. Returns the
+    // compressed file size. Throws std::runtime_error on I/O failure or a
+    // codec this build lacks.
+    static int64_t write(const std::string& log_path, const std::string& out_path,
+                         const Options& options = Options());
+
+    // Map a compressed segment and load its block index; returns false if
+    // the file is missing, truncated or uses an unknown codec
+    bool open(const std::string& path);
+
+    SegmentCompression codec() const { return codec_; }
+    int64_t raw_size() const { return raw_size_; }
+    const std::vector<Block>& blocks() const { return blocks_; }
+
+    // Index of the block holding raw position, or -1 past the end
+    int64_t find_block(int64_t raw_position) const;
+
+    // Decompress one block into out; returns false on corrupt data
+    bool decompress(size_t block, std::string& out) const;
+
+    // Start the kernel reading the blocks that hold raw bytes
+    // [raw_position, raw_position + raw_bytes)
+    void read_ahead(int64_t raw_position, int64_t raw_bytes) const;
+
+    // Whether this build can write (and read) codec
+    static bool available(SegmentCompression codec);
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    SegmentCompression codec_ = SegmentCompression::NONE;
+    int64_t raw_size_ = 0;
+    const char* dictionary_ = nullptr;
+    size_t dictionary_size_ = 0;
+    std::vector<Block> blocks_;
+    void* zstd_dictionary_ = nullptr;  // ZSTD_DDict*, opaque so the header has no zstd dependency
+};
+
+} // namespace spool
+} // namespace s1see
@@ -0,0 +1,100 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: consumer_group.h
+ * Description: Header for ConsumerGroup, membership of one consumer in a
+ *              group sharing a spool. Members hold leases in the spool
+ *              directory and split the partitions between them, so several
+ *              processors, on one host or on nodes sharing the spool, each
+ *              read a disjoint set and take over when one of them dies.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace s1see {
+namespace spool {
+
+// State lives under <base_dir>/groups/<group>/: a member file per live
+// member and a lease file per owned partition, each holding a wall-clock
+// expiry. Every heartbeat renews both and recomputes the assignment, which
+// is partition p to the (p mod n)th of the n live members in id order, so
+// all members agree on it without talking to each other. Hand-over is
+// cooperative: a member gives up a partition only once can_release says
+// its work is committed, and a member takes one only once its lease is
+// free or expired. Heartbeats serialize on a lock file (flock).
+//
+// Leases are wall-clock times, so nodes sharing the spool need synchronized
+// clocks, and lease_duration must outlast the longest gap between two
+// heartbeats of a live member. Not thread-safe.
+class ConsumerGroup {
+public:
+    struct Config {
+        Config()
+            : num_partitions(1),
+              lease_duration(std::chrono::seconds(10)) {}
+        std::string base_dir;   // Spool directory
+        std::string group;
+        std::string member_id;  // Empty: <hostname>-<pid>
+        int32_t num_partitions;
+        std::chrono::milliseconds lease_duration;
+    };
+
+    // Partitions that changed hands in one heartbeat
+    struct Assignment {
+        std::vector<int32_t> gained;
+        std::vector<int32_t> lost;
+        bool changed() const { return !gained.empty() || !lost.empty(); }
+    };
+
+    explicit ConsumerGroup(const Config& config);
+    ~ConsumerGroup();  // leave()
+
+    ConsumerGroup(const ConsumerGroup&) = delete;
+    ConsumerGroup& operator=(const ConsumerGroup&) = delete;
+
+    // Renew this member's leases and rebalance. can_release(p) is asked
+    // before an owned partition moves to another member; return false
+    // while p has records read but not committed. A partition whose lease
+    // another member took over (this one missed its renewal) is lost
+    // whatever can_release says. Throws std::runtime_error if the group
+    // directory cannot be used.
+    Assignment heartbeat(const std::function<bool(int32_t)>& can_release);
+
+    // Release every lease and leave the group, so the other members take
+    // over at their next heartbeat instead of after lease_duration
+    void leave();
+
+    bool owns(int32_t partition) const;
+    const std::vector<int32_t>& owned_partitions() const { return owned_; }
+
+    // Live members seen by the last heartbeat, in id order
+    const std::vector<std::string>& members() const { return members_; }
+
+    const std::string& member_id() const { return config_.member_id; }
+
+private:
+    Config config_;
+    std::string group_dir_;
+    int lock_fd_ = -1;
+    bool joined_ = false;
+    std::vector<int32_t> owned_;       // Sorted
+    std::vector<std::string> members_;
+
+    std::string member_path(const std::string& member) const;
+    std::string lease_path(int32_t partition) const;
+    int64_t expiry_ns() const;
+    std::vector<std::string> live_members(int64_t now_ns);
+    // Owner of a partition's unexpired lease; empty if it is free
+    std::string lease_owner(int32_t partition, int64_t now_ns) const;
+};
+
+} // namespace spool
+} // namespace s1see
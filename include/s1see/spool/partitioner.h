@@ -0,0 +1,78 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: partitioner.h
+ * Description: Header for the spool partitioners that choose the partition
+ *              of each appended record: by source and sequence (the
+ *              default), by UE (eNB plus eNB-UE-S1AP-ID, read from the
+ *              first IEs of the raw PDU) or by SCTP association.
+ */
+
+#pragma once
+
+#include "signal_message.pb.h"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace s1see {
+namespace spool {
+
+// Chooses the partition of a record appended without one. Called on the
+// append path for every record, from any thread, so implementations must
+// be stateless and cheap.
+class Partitioner {
+public:
+    virtual ~Partitioner() = default;
+
+    // Partition in [0, num_partitions); num_partitions is at least 1
+    virtual int32_t partition(const SignalMessage& message, int32_t num_partitions) const = 0;
+};
+
+// source_id and source_sequence: spreads records evenly, whatever UE they
+// belong to. The default.
+class SourceSequencePartitioner : public Partitioner {
+public:
+    int32_t partition(const SignalMessage& message, int32_t num_partitions) const override;
+};
+
+// Keeps a UE's S1 connection on one partition, so parallel consumers hold
+// all of its correlator and sequence state. The key is the eNB (the SCTP
+// association, or source_id without one) and the eNB-UE-S1AP-ID, read from
+// the first IEs of the raw PDU without decoding the rest. Non-UE-associated
+// signalling goes by eNB alone. A UE handed over to another eNB gets a new
+// eNB-UE-S1AP-ID there, so its target-side messages may move partition.
+class UeAffinityPartitioner : public Partitioner {
+public:
+    int32_t partition(const SignalMessage& message, int32_t num_partitions) const override;
+};
+
+// Keeps an SCTP association (one eNB's S1 link) on one partition, in order.
+// Records without an association go by source_id.
+class SctpAssociationPartitioner : public Partitioner {
+public:
+    int32_t partition(const SignalMessage& message, int32_t num_partitions) const override;
+};
+
+enum class Partitioning {
+    SOURCE_SEQUENCE,
+    UE,
+    SCTP_ASSOCIATION
+};
+
+std::shared_ptr<const Partitioner> make_partitioner(Partitioning partitioning);
+
+// Parse "source", "ue" or "sctp"; nullopt for anything else
+std::optional<Partitioning> parse_partitioning(const std::string& name);
+
+// eNB-UE-S1AP-ID of an S1AP PDU, from its eNB-UE-S1AP-ID IE or the pair
+// in UE-S1AP-IDs, looked up among the first IEs and decoded as a
+// constrained INTEGER; nullopt if the PDU has none there or is cut short
+std::optional<uint32_t> peek_enb_ue_s1ap_id(std::span<const uint8_t> pdu);
+
+} // namespace spool
+} // namespace s1see
@@ -0,0 +1,75 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: record_frame.h
+ * Description: Framing of SpoolRecords in segment files: a length prefix
+ *              and a CRC32C of the record, checked on read and by crash
+ *              recovery to find where a segment's valid records end.
+ */
+
+#pragma once
+
+#include "s1see/utils/crc32c.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace s1see {
+namespace spool {
+
+// Each record, little-endian:
+//   length (u32) with RECORD_CHECKSUMMED set, CRC32C of the payload (u32), payload
+//   length (u32), payload   (segments written before records carried a CRC)
+// The payload is a serialized SpoolRecord of (length & RECORD_LENGTH_MASK) bytes.
+constexpr uint32_t RECORD_CHECKSUMMED = 0x80000000u;
+constexpr uint32_t RECORD_LENGTH_MASK = 0x7fffffffu;
+constexpr size_t RECORD_FRAME_HEADER_SIZE = 2 * sizeof(uint32_t);
+
+struct RecordFrame {
+    const char* payload = nullptr;
+    size_t payload_size = 0;
+    size_t size = 0;           // Whole frame, header included
+    bool checksummed = false;
+};
+
+enum class FrameStatus {
+    OK,
+    END,      // Zero length or not enough bytes: the end of the written records, or a torn write
+    CORRUPT   // Complete frame whose CRC does not match
+};
+
+// Parse the frame at data[0, available). With verify, a checksummed
+// payload is checked against its CRC.
+inline FrameStatus parse_record_frame(const char* data, size_t available, RecordFrame& frame,
+                                      bool verify = true) {
+    uint32_t length;
+    if (available < sizeof(length)) return FrameStatus::END;
+    std::memcpy(&length, data, sizeof(length));
+    frame.checksummed = (length & RECORD_CHECKSUMMED) != 0;
+    frame.payload_size = length & RECORD_LENGTH_MASK;
+    size_t header = frame.checksummed ? RECORD_FRAME_HEADER_SIZE : sizeof(length);
+    if (frame.payload_size == 0 || available < header || available - header < frame.payload_size) {
+        return FrameStatus::END;
+    }
+    frame.payload = data + header;
+    frame.size = header + frame.payload_size;
+    if (verify && frame.checksummed) {
+        uint32_t crc;
+        std::memcpy(&crc, data + sizeof(length), sizeof(crc));
+        if (utils::crc32c(frame.payload, frame.payload_size) != crc) return FrameStatus::CORRUPT;
+    }
+    return FrameStatus::OK;
+}
+
+// Fill in the header of a frame whose payload is already in place after it
+inline void seal_record_frame(char* frame, size_t payload_size) {
+    uint32_t length = static_cast<uint32_t>(payload_size) | RECORD_CHECKSUMMED;
+    uint32_t crc = utils::crc32c(frame + RECORD_FRAME_HEADER_SIZE, payload_size);
+    std::memcpy(frame, &length, sizeof(length));
+    std::memcpy(frame + sizeof(length), &crc, sizeof(crc));
+}
+
+} // namespace spool
+} // namespace s1see
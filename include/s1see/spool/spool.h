@@ -12,9 +12,13 @@
 #pragma once
 
 #include "s1see/spool/wal_log.h"
+#include "s1see/spool/spool_cursor.h"
+#include "s1see/metrics/metrics.h"
 #include "signal_message.pb.h"
 #include "spool_record.pb.h"
 #include <memory>
+#include <future>
+#include <span>
 
 namespace s1see {
 namespace spool {
@@ -24,23 +28,61 @@ class Spool {
 public:
     explicit Spool(const WALLog::Config& config);
     
+    // Count appended records and time synchronous appends in `registry`.
+    // Call before the spool is shared between threads.
+    void set_metrics(std::shared_ptr<metrics::MetricsRegistry> registry);
+    
     // Append a message, returns (partition, offset)
     std::pair<int32_t, int64_t> append(const SignalMessage& message);
     
+    // Append a batch of messages, returns (partition, offset) per message
+    std::vector<std::pair<int32_t, int64_t>> append_batch(std::span<const SignalMessage> messages);
+    
+    // Append a batch to one partition and sync it; returns the first offset
+    int64_t append_batch_durable(int32_t partition, std::span<const SignalMessage> messages);
+    
+    int32_t num_partitions() const;
+    int32_t partition_for(const SignalMessage& message, int32_t preferred = -1) const;  // See WALLog::partition_for_message
+    
+    // Append a message; the future resolves once it is durable on disk
+    std::future<std::pair<int32_t, int64_t>> append_durable(const SignalMessage& message);
+    
     // Read records
     std::vector<SpoolRecord> read(int32_t partition, int64_t offset, int64_t max_records = 1000);
     
+    // Stream records from offset on in bounded chunks, reading ahead; the
+    // cursor must not outlive the spool
+    SpoolCursor cursor(int32_t partition, int64_t offset,
+                       const SpoolCursor::Config& config = SpoolCursor::Config());
+    
+    // First offset at or after a time; see WALLog::seek_by_time
+    int64_t seek_by_time(int32_t partition, int64_t ts_ns, TimeField field = TimeField::CAPTURE);
+    
     // Consumer group management
     void commit_offset(const std::string& group, int32_t partition, int64_t offset);
     int64_t load_offset(const std::string& group, int32_t partition);
+    int64_t reload_offset(const std::string& group, int32_t partition);  // See WALLog::reload_offset
     
     // Maintenance
-    void prune_old_segments();
+    size_t prune_old_segments();  // See WALLog::prune_old_segments
     int64_t get_high_water_mark(int32_t partition);
+    size_t segment_count(int32_t partition);
     void flush();  // Flush all buffers to disk
+    
+    // Block until something is appended after append_sequence() returned
+    // seen_sequence; see WALLog::wait_for_appends
+    uint32_t append_sequence() const;
+    bool wait_for_appends(uint32_t seen_sequence, std::chrono::milliseconds timeout);
 
 private:
     std::unique_ptr<WALLog> wal_;
+    
+    // Null until set_metrics()
+    std::shared_ptr<metrics::MetricsRegistry> metrics_;
+    metrics::Counter* appended_records_ = nullptr;
+    metrics::Histogram* append_latency_ = nullptr;
+    metrics::Histogram* append_batch_latency_ = nullptr;
+    metrics::Histogram* append_batch_durable_latency_ = nullptr;
 };
 
 } // namespace spool
@@ -0,0 +1,77 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: spool_cursor.h
+ * Description: Header for SpoolCursor, a streaming reader over one spool
+ *              partition. Records are parsed a chunk at a time into slots
+ *              reused from chunk to chunk, and the bytes after each chunk
+ *              are read ahead while the caller works through it.
+ */
+
+#pragma once
+
+#include "s1see/spool/wal_log.h"
+#include "spool_record.pb.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace s1see {
+namespace spool {
+
+// Memory is bounded by chunk_records however many records the caller goes
+// through. After each chunk is parsed, the next read_ahead_bytes of the
+// partition are handed to the kernel (madvise/posix_fadvise WILLNEED), so
+// the disk reads for the next chunk overlap with processing this one.
+// Not thread-safe; use one cursor per reading thread.
+class SpoolCursor {
+public:
+    struct Config {
+        Config()
+            : chunk_records(256),
+              read_ahead_bytes(1024 * 1024) {}
+        size_t chunk_records;     // Records parsed per read
+        size_t read_ahead_bytes;  // Read ahead past each chunk; 0 disables
+    };
+
+    SpoolCursor(WALLog& wal, int32_t partition, int64_t offset, const Config& config = Config());
+
+    // Next record, or nullptr once caught up with the partition (a later
+    // call picks up anything appended since). The record stays valid until
+    // the cursor reads its next chunk.
+    const SpoolRecord* next();
+
+    // The rest of the current chunk, reading one if it is used up, up to
+    // max_records. Valid until the next call on the cursor. Empty once
+    // caught up.
+    std::span<const SpoolRecord> next_chunk(size_t max_records);
+
+    // Offset of the next record next() returns
+    int64_t position() const { return position_; }
+
+    // Records of the current chunk not yet returned; the next read from
+    // the spool happens once this is 0
+    size_t buffered() const { return count_ - next_; }
+
+    // Continue from offset, dropping what the current chunk has left
+    void seek(int64_t offset);
+
+    int32_t partition() const { return partition_; }
+
+private:
+    bool fill();
+
+    WALLog* wal_;
+    int32_t partition_;
+    Config config_;
+    int64_t position_;
+    std::vector<SpoolRecord> slots_;  // Reused across chunks, so their buffers are too
+    size_t count_ = 0;                // Records of the current chunk in slots_
+    size_t next_ = 0;                 // Next of them to return
+};
+
+} // namespace spool
+} // namespace s1see
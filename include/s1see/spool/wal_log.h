@@ -19,11 +19,36 @@
 #include <unordered_map>
 #include <fstream>
 #include <chrono>
+#include <map>
+#include <span>
+#include <deque>
+#include <future>
+#include <thread>
+#include <condition_variable>
+#include <filesystem>
+#include <atomic>
+#include "s1see/spool/compressed_segment.h"
+#include "s1see/spool/partitioner.h"
 #include "spool_record.pb.h"
 
 namespace s1see {
 namespace spool {
 
+// Sparse time index entry, kept per segment in segment_<base>.tix: the
+// latest capture and append times over `count` records from `offset` on.
+// A seek skips every block whose maxima fall short and scans only the one
+// holding the answer, so capture times need not arrive in order. The index
+// is advisory: records it does not cover are scanned.
+struct TimeIndexEntry {
+    int64_t offset;
+    int64_t count;
+    int64_t max_ts_capture;
+    int64_t max_ts_append;
+};
+
+// Record time a seek goes by: SignalMessage ts_capture or SpoolRecord ts_append
+enum class TimeField { CAPTURE, APPEND };
+
 struct SegmentInfo {
     int32_t partition;
     int64_t base_offset;
@@ -32,9 +57,14 @@ struct SegmentInfo {
     int64_t current_offset;
     int64_t file_size;
     
-    // Cached file handles for performance
-    std::unique_ptr<std::ofstream> log_file;
-    std::unique_ptr<std::ofstream> idx_file;
+    // Cached file descriptors (O_APPEND) for performance and fdatasync
+    int log_fd = -1;
+    int idx_fd = -1;
+    
+    // Time index file and the block it has yet to get an entry for
+    std::string tix_path;
+    int tix_fd = -1;
+    TimeIndexEntry time_block{};
     
     // Write buffering
     std::vector<char> log_buffer;
@@ -44,6 +74,36 @@ struct SegmentInfo {
     static constexpr auto FSYNC_INTERVAL = std::chrono::milliseconds(100); // fsync every 100ms
 };
 
+// Read-only memory mapping of a sealed (rotated) segment and its index.
+// Sealed segments are immutable, so mappings stay valid until the segment
+// is pruned and can be shared across read() calls.
+struct MappedSegment {
+    int64_t base_offset = 0;
+    const char* log_data = nullptr;
+    size_t log_size = 0;
+    const char* idx_data = nullptr;
+    size_t idx_size = 0;
+
+    MappedSegment() = default;
+    MappedSegment(const MappedSegment&) = delete;
+    MappedSegment& operator=(const MappedSegment&) = delete;
+    ~MappedSegment();
+
+    // Map log_path and idx_path; returns false if either cannot be mapped
+    bool map(const std::string& log_path, const std::string& idx_path);
+};
+
+// Append notification block, mapped MAP_SHARED from <base_dir>/notify so
+// every process that opens the spool sees the same counter. Writers bump
+// sequence after each append; readers block on it (futex on Linux).
+// segment_generation is bumped whenever a segment is created, sealed,
+// compressed or pruned, so cached segment listings stay valid until it moves.
+struct SpoolNotifyBlock {
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<uint32_t> waiters{0};
+    std::atomic<uint32_t> segment_generation{0};
+};
+
 // Write-Ahead Log segmented storage
 class WALLog {
 public:
@@ -51,11 +111,49 @@ public:
         std::string base_dir = "spool_data";
         int32_t num_partitions = 1;
         int64_t max_segment_size = 100 * 1024 * 1024; // 100MB
-        int64_t max_retention_bytes = 1024 * 1024 * 1024; // 1GB
-        int64_t max_retention_seconds = 7 * 24 * 3600; // 7 days
+        int64_t max_retention_bytes = 1024 * 1024 * 1024; // 1GB of sealed segments, over all partitions; 0 = no limit
+        int64_t max_retention_seconds = 7 * 24 * 3600; // 7 days since a segment was sealed; 0 = no limit
         bool fsync_on_append = true;
         bool use_buffering = true; // Enable write buffering
         std::chrono::milliseconds fsync_interval = std::chrono::milliseconds(100);
+        bool use_mmap_reads = true; // Read sealed segments via mmap (active segment stays on buffered path)
+        bool group_commit = false; // Run a writer thread that batches append_durable() calls
+        size_t group_commit_max_batch = 4096; // Max records per writev/fdatasync batch
+        bool visible_on_append = false; // Write buffers through to the page cache on every append so other processes see records at once
+        
+        // Check the newest segment of each partition on open (partitions in
+        // parallel, recovery_threads at a time; 0 = one per core): cut off a
+        // torn or corrupt tail and bring its index back in line with the
+        // log. Set only in the process that appends; a reader would cut off
+        // records still being written.
+        bool recover_segments = false;
+        size_t recovery_threads = 0;
+        
+        // Compress segments on a background thread once they are sealed;
+        // the active segment stays raw. Set only in the process that
+        // appends; readers handle compressed segments whatever this says.
+        SegmentCompression compression = SegmentCompression::NONE;
+        size_t compression_block_size = 64 * 1024; // Raw bytes per independently compressed block
+        int compression_level = 0; // 0 = codec default
+        size_t compression_dictionary_size = 16 * 1024; // Sampled (zlib) or trained (zstd) per segment
+        
+        // Run prune_old_segments() on a maintenance thread every
+        // retention_interval. Like compression, enable it only in the
+        // process that appends.
+        bool retention_thread = false;
+        std::chrono::milliseconds retention_interval = std::chrono::seconds(10);
+        bool retain_unconsumed = true; // Keep segments some consumer group has not committed past
+        
+        // Records per time index entry (see TimeIndexEntry); 0 writes no
+        // time index and seek_by_time then scans
+        int64_t time_index_interval = 1024;
+        
+        // Partition of every record (append, append_batch, append_durable,
+        // and ingest adapters through partition_for_message). Null keeps
+        // each adapter's own choice and SourceSequencePartitioner for the
+        // rest. Use UeAffinityPartitioner for consumers that keep per-UE
+        // state.
+        std::shared_ptr<const Partitioner> partitioner;
     };
 
     explicit WALLog(const Config& config);
@@ -64,42 +162,196 @@ public:
     // Append a record, returns (partition, offset)
     std::pair<int32_t, int64_t> append(const SignalMessage& message);
 
+    // Append several records, returns (partition, offset) per input message.
+    // Each partition lock is taken once for the whole batch.
+    std::vector<std::pair<int32_t, int64_t>> append_batch(std::span<const SignalMessage> messages);
+
+    // Append records to one partition, in order, and sync the segment before
+    // returning. Returns the offset of the first record. For sources that
+    // carry their own partitioning (e.g. Kafka partitions) and acknowledge
+    // upstream only once the batch is on disk.
+    int64_t append_batch_durable(int32_t partition, std::span<const SignalMessage> messages);
+
+    int32_t num_partitions() const { return static_cast<int32_t>(partitions_.size()); }
+    
+    // Partition the configured partitioner gives a record. Without one,
+    // preferred (taken mod num_partitions) if it is not negative, else
+    // SourceSequencePartitioner's choice.
+    int32_t partition_for_message(const SignalMessage& message, int32_t preferred = -1) const;
+
+    // Append a record and resolve the future once it is on disk. With
+    // group_commit enabled, concurrent callers share one writev + fdatasync
+    // per partition; otherwise each call syncs its own segment.
+    std::future<std::pair<int32_t, int64_t>> append_durable(const SignalMessage& message);
+
     // Read records from a partition starting at offset
     std::vector<SpoolRecord> read(int32_t partition, int64_t offset, int64_t max_records = 1000);
+    
+    // Same, parsing into records[0, n) and returning n. The vector only
+    // grows, so a caller reading into the same one every time reuses its
+    // records and their buffers.
+    size_t read_into(int32_t partition, int64_t offset, int64_t max_records, std::vector<SpoolRecord>& records);
+    
+    // Offset of the first record in the partition whose time (`field`) is
+    // at least ts_ns, or the next offset to be written if there is none.
+    // Whole time index blocks are skipped; at most one block is scanned
+    // per answer, plus any records the index does not cover.
+    int64_t seek_by_time(int32_t partition, int64_t ts_ns, TimeField field = TimeField::CAPTURE);
+    
+    // Ask the kernel to start reading the bytes of up to `bytes` of records
+    // from offset on (within one segment), for a read that follows shortly
+    void read_ahead(int32_t partition, int64_t offset, int64_t bytes);
 
     // Consumer group offset management
     void commit_offset(const std::string& group, int32_t partition, int64_t offset);
     int64_t load_offset(const std::string& group, int32_t partition);
+    
+    // Re-read a group's committed offset from its file, for a consumer
+    // taking over a partition that another process has been committing on
+    int64_t reload_offset(const std::string& group, int32_t partition);
 
-    // Retention and maintenance
-    void prune_old_segments();
+    // Delete the oldest sealed segments past max_retention_bytes or
+    // max_retention_seconds. Works from the in-memory segment catalog and
+    // never takes a partition's append lock. With retain_unconsumed, a
+    // segment goes only once every consumer group has committed past it
+    // (none if no group has committed on that partition). The newest
+    // sealed segment of each partition is always kept, so offsets carry
+    // on after a restart. Returns the number of segments deleted.
+    size_t prune_old_segments();
 
     // Get current high water mark for a partition
     int64_t get_high_water_mark(int32_t partition);
     
+    // Block until every segment sealed so far has been compressed
+    void wait_for_compression();
+    
+    // Segments on disk for a partition, active one included
+    size_t segment_count(int32_t partition);
+    
     // Flush all active segments (public for Spool::flush)
     void flush_all_segments();
+    
+    // Append notification. Take append_sequence() before reading, then
+    // wait_for_appends() with that value: it returns true as soon as any
+    // partition has been appended to since (in this or another process),
+    // or false on timeout.
+    uint32_t append_sequence() const;
+    bool wait_for_appends(uint32_t seen_sequence, std::chrono::milliseconds timeout);
 
 private:
     Config config_;
-    std::mutex mutex_;
     
-    // Active segments per partition
-    std::unordered_map<int32_t, std::unique_ptr<SegmentInfo>> active_segments_;
+    // Resident read index for one partition: sorted segment bases plus the
+    // dense position array of every sealed segment, so an offset resolves
+    // to a file position without touching the .idx file. Immutable once
+    // built; readers hold a shared_ptr snapshot.
+    struct SegmentIndex {
+        std::vector<int64_t> base_offsets;
+        std::vector<std::string> log_paths;  // .log, or .logz once compressed
+        std::vector<bool> compressed;
+        // positions[i][offset - base_offsets[i]]; null for the last (growing)
+        // segment or an index whose offsets are not dense
+        std::vector<std::shared_ptr<const std::vector<int64_t>>> positions;
+        uint32_t generation = 0;  // notify_->segment_generation it was listed at
+        std::filesystem::file_time_type dir_mtime;  // Without a shared notify block
+    };
+
+    // Per-partition state. Each partition is locked independently, so
+    // appends and reads on different partitions never contend.
+    struct PartitionState {
+        std::mutex mutex; // Guards active segment: appends, rotation, buffer flushes
+        std::unique_ptr<SegmentInfo> active;
+        
+        // Mapped sealed segments (base_offset -> mapping); readers hold a
+        // shared_ptr so a mapping outlives a concurrent drop
+        std::mutex mapped_mutex;
+        std::map<int64_t, std::shared_ptr<const MappedSegment>> mapped;
+        
+        // Opened compressed segments, and the block last decompressed so a
+        // consumer reading on from where it stopped does not repeat the work
+        // (both guarded by mapped_mutex)
+        struct DecompressedBlock {
+            int64_t base_offset;
+            size_t block;
+            std::string data;
+        };
+        std::map<int64_t, std::shared_ptr<const CompressedSegment>> compressed;
+        std::shared_ptr<const DecompressedBlock> last_block;
+        
+        // Rebuilt only after rotation, pruning or a directory change
+        std::mutex index_mutex;
+        std::shared_ptr<const SegmentIndex> index;
+        
+        // Sealed segments, oldest first, so retention never lists the
+        // directory or reads an index
+        struct CatalogEntry {
+            int64_t base_offset;
+            int64_t end_offset;  // One past the last record
+            int64_t bytes;       // Log (raw or compressed) plus index
+            std::chrono::system_clock::time_point sealed_at;
+        };
+        std::mutex catalog_mutex;
+        std::deque<CatalogEntry> catalog;
+    };
+    std::vector<std::unique_ptr<PartitionState>> partitions_;
     
     // Consumer group offsets: group -> (partition -> offset)
+    std::mutex offsets_mutex_;
     std::unordered_map<std::string, std::unordered_map<int32_t, int64_t>> consumer_offsets_;
     
-    // Cached directory listings for reads (partition -> segments)
-    std::unordered_map<int32_t, std::vector<std::pair<int64_t, std::string>>> segment_cache_;
-    std::chrono::system_clock::time_point cache_timestamp_;
-    static constexpr auto CACHE_TTL = std::chrono::seconds(5);
+    // Group commit queue, drained by writer_thread_
+    struct PendingAppend {
+        int32_t partition = 0;
+        std::string payload; // Serialized SignalMessage
+        int64_t ts_capture = 0;
+        std::pair<int32_t, int64_t> result;
+        bool acked = false;
+        std::promise<std::pair<int32_t, int64_t>> done;
+    };
+    std::mutex commit_mutex_;
+    std::condition_variable commit_cv_;
+    std::deque<PendingAppend> pending_appends_;
+    bool stopping_ = false;
+    std::thread writer_thread_;
+    
+    // Sealed segments waiting for compression, drained by compress_thread_
+    std::mutex compress_mutex_;
+    std::condition_variable compress_cv_;
+    std::deque<std::pair<int32_t, int64_t>> compress_queue_; // (partition, base offset)
+    bool compressing_ = false;
+    bool compress_stopping_ = false;
+    std::thread compress_thread_;
     
+    // Held while compression or retention creates or deletes segment files
+    std::mutex segment_files_mutex_;
+    
+    // Retention thread
+    std::mutex retention_mutex_;
+    std::condition_variable retention_cv_;
+    bool retention_stopping_ = false;
+    std::thread retention_thread_;
+    
+    // Shared notify mapping, or local_notify_ if the file cannot be mapped
+    SpoolNotifyBlock* notify_ = nullptr;
+    bool notify_mapped_ = false;
+    SpoolNotifyBlock local_notify_;
+    
+    PartitionState& partition_state(int32_t partition);
     std::string offset_file_path(const std::string& group, int32_t partition);
     std::string segment_path(int32_t partition, int64_t base_offset, const std::string& suffix);
+    // Caller must hold the partition's mutex
     SegmentInfo* get_or_create_segment(int32_t partition);
     void rotate_segment(int32_t partition);
-    int32_t partition_for_message(const SignalMessage& message);
+    // Frame and buffer one record in the active segment; caller holds the partition mutex
+    int64_t append_record_locked(int32_t partition, const SignalMessage& message, int64_t ts_append);
+    void sync_if_due(SegmentInfo* seg);
+    // Time index: add a record to the open block; write the block's entry
+    void index_time(SegmentInfo* seg, int64_t offset, int64_t ts_capture, int64_t ts_append);
+    void write_time_block(SegmentInfo* seg);
+    std::vector<TimeIndexEntry> load_time_index(int32_t partition, int64_t base_offset);
+    void open_notify_block();
+    void publish_appends();
+    int64_t next_offset_for_partition(int32_t partition);
     void ensure_directory(const std::string& path);
     void load_consumer_offsets();
     void save_consumer_offset(const std::string& group, int32_t partition, int64_t offset);
@@ -108,7 +360,56 @@ private:
     void open_segment_files(SegmentInfo* seg);
     void flush_segment_buffers(SegmentInfo* seg, bool force_fsync = false);
     void close_segment_files(SegmentInfo* seg);
-    std::vector<std::pair<int64_t, std::string>> get_segments_for_partition(int32_t partition);
+    
+    // Group commit writer
+    void writer_loop();
+    void commit_batch(std::vector<PendingAppend>& batch);
+    void commit_partition(int32_t partition, std::vector<PendingAppend*>& entries);
+    
+    // Segment compression
+    void queue_compression(int32_t partition, int64_t base_offset);
+    void queue_sealed_segments();
+    void compress_loop();
+    void compress_segment(int32_t partition, int64_t base_offset);
+    
+    // Crash recovery
+    void recover_partitions();
+    void recover_partition(int32_t partition);
+    
+    // Segment catalog and retention
+    void load_catalog();
+    void retention_loop();
+    std::unordered_map<int32_t, int64_t> min_committed_offsets();
+    
+    // Helper functions for reads
+    std::shared_ptr<const SegmentIndex> get_segment_index(int32_t partition);
+    void invalidate_segment_index(int32_t partition);
+    std::shared_ptr<const std::vector<int64_t>> load_segment_positions(const std::string& idx_path,
+                                                                       int64_t base_offset);
+    std::shared_ptr<const MappedSegment> get_mapped_segment(int32_t partition, int64_t base_offset,
+                                                            const std::string& log_path);
+    void drop_stale_mappings(int32_t partition, const SegmentIndex& index);
+    int64_t find_position_mapped(const MappedSegment& mapped, int64_t offset);
+    int64_t find_position_stream(const std::string& idx_path, int64_t offset);
+    std::shared_ptr<const CompressedSegment> get_compressed_segment(int32_t partition, int64_t base_offset,
+                                                                    const std::string& log_path);
+    // Records of one read, parsed into slots[0, count) of a reused vector
+    struct RecordSlots {
+        std::vector<SpoolRecord>& slots;
+        size_t count = 0;
+        // Parse a payload into the next slot; kept only if its offset is at
+        // least min_offset
+        void parse(const char* data, size_t size, int64_t min_offset);
+        const SpoolRecord& back() const { return slots[count - 1]; }
+    };
+    // Each returns false if the segment could not be read
+    bool read_mapped_records(const MappedSegment& mapped, int64_t file_position, int64_t offset,
+                             int64_t max_records, RecordSlots& records);
+    bool read_stream_records(const std::string& log_path, int64_t file_position, int64_t offset,
+                             int64_t max_records, RecordSlots& records);
+    bool read_compressed_records(int32_t partition, int64_t base_offset, const CompressedSegment& segment,
+                                 int64_t file_position, int64_t offset, int64_t max_records,
+                                 RecordSlots& records);
 };
 
 } // namespace spool
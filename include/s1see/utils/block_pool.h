@@ -0,0 +1,140 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: block_pool.h
+ * Description: Fixed-size block pool and matching allocator. Blocks are carved
+ *              from large chunks and recycled through a free list, so objects
+ *              created and expired at high rate (UE contexts) do not churn the
+ *              general-purpose allocator. Pair with std::allocate_shared.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace s1see {
+namespace utils {
+
+// Pool of equally sized blocks. The block size is fixed by the first
+// allocation; requests of any other size go to operator new. Thread-safe,
+// since the last shared_ptr to a pooled object may drop on another thread.
+class BlockPool {
+public:
+    explicit BlockPool(size_t blocks_per_chunk = 256) : blocks_per_chunk_(blocks_per_chunk) {}
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    void* allocate(size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (block_size_ == 0) {
+            block_size_ = round_up(bytes);
+        }
+        if (round_up(bytes) != block_size_) {
+            return ::operator new(bytes);
+        }
+        if (!free_) {
+            add_chunk();
+        }
+        FreeBlock* block = free_;
+        free_ = block->next;
+        ++in_use_;
+        return block;
+    }
+
+    void deallocate(void* p, size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (round_up(bytes) != block_size_) {
+            ::operator delete(p);
+            return;
+        }
+        FreeBlock* block = static_cast<FreeBlock*>(p);
+        block->next = free_;
+        free_ = block;
+        --in_use_;
+    }
+
+    // Blocks currently handed out
+    size_t in_use() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return in_use_;
+    }
+
+    // Bytes reserved in chunks, used or free
+    size_t memory_bytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return chunks_.size() * blocks_per_chunk_ * block_size_;
+    }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static size_t round_up(size_t bytes) {
+        constexpr size_t align = alignof(std::max_align_t);
+        bytes = bytes < sizeof(FreeBlock) ? sizeof(FreeBlock) : bytes;
+        return (bytes + align - 1) / align * align;
+    }
+
+    void add_chunk() {
+        size_t words = (block_size_ * blocks_per_chunk_ + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+        chunks_.emplace_back(new std::max_align_t[words]);
+        char* base = reinterpret_cast<char*>(chunks_.back().get());
+        for (size_t i = blocks_per_chunk_; i-- > 0;) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(base + i * block_size_);
+            block->next = free_;
+            free_ = block;
+        }
+    }
+
+    mutable std::mutex mutex_;
+    size_t blocks_per_chunk_;
+    size_t block_size_ = 0;
+    size_t in_use_ = 0;
+    FreeBlock* free_ = nullptr;
+    std::vector<std::unique_ptr<std::max_align_t[]>> chunks_;
+};
+
+// Allocator drawing single objects from a shared BlockPool. The pool is
+// kept alive by every allocator copy, including those inside control blocks.
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    explicit PoolAllocator(std::shared_ptr<BlockPool> pool) : pool_(std::move(pool)) {}
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) : pool_(other.pool()) {}
+
+    T* allocate(size_t n) {
+        if (n != 1) return static_cast<T*>(::operator new(n * sizeof(T)));
+        return static_cast<T*>(pool_->allocate(sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        if (n != 1) {
+            ::operator delete(p);
+            return;
+        }
+        pool_->deallocate(p, sizeof(T));
+    }
+
+    const std::shared_ptr<BlockPool>& pool() const { return pool_; }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>& other) const { return pool_ == other.pool(); }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>& other) const { return pool_ != other.pool(); }
+
+private:
+    std::shared_ptr<BlockPool> pool_;
+};
+
+} // namespace utils
+} // namespace s1see
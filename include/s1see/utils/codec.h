@@ -0,0 +1,51 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: codec.h
+ * Description: Byte codecs shared by the parsers, correlator and rules:
+ *              bytes to lowercase hex, hex to bytes, and TBCD (nibble-swapped
+ *              BCD, as in IMSIs and PLMN identities) to digits. AVX2, SSSE3
+ *              or NEON kernels run where the CPU has them, with a scalar
+ *              path that gives the same results.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace s1see {
+namespace utils {
+
+// Lowercase hex of data[0, size) into out[0, 2 * size)
+void hex_encode(const uint8_t* data, size_t size, char* out);
+
+std::string to_hex(std::span<const uint8_t> bytes);
+std::string to_hex(std::string_view bytes);
+
+// Decode hex.size() / 2 bytes into out; either case is accepted. False
+// (out partly written) on an odd length or a character that is not hex.
+bool hex_decode(std::string_view hex, uint8_t* out);
+
+// Hex to a byte vector; empty on invalid input
+std::vector<uint8_t> from_hex(std::string_view hex);
+
+// TBCD digits of data[0, size): low nibble then high nibble of each byte,
+// stopping at the first nibble above 9 (the 0xF filler, or anything that
+// is not a digit). Writes at most 2 * size digits to out and returns how
+// many.
+size_t tbcd_decode(const uint8_t* data, size_t size, char* out);
+
+std::string tbcd_to_string(std::span<const uint8_t> bytes);
+
+// Instruction set the kernels run on: "avx2", "ssse3", "neon" or "scalar"
+const char* codec_instruction_set();
+
+} // namespace utils
+} // namespace s1see
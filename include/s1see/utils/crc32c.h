@@ -0,0 +1,28 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: crc32c.h
+ * Description: CRC-32C (Castagnoli), the checksum framing spool records.
+ *              Uses the SSE4.2 or ARMv8 CRC instructions where the CPU has
+ *              them and a slicing-by-8 table otherwise.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace s1see {
+namespace utils {
+
+// CRC-32C of data[0, size). Pass a previous result as crc to extend it
+// over data that follows, so crc32c(b, crc32c(a)) == crc32c(a + b).
+uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0);
+
+// Whether crc32c() runs on CPU instructions rather than the table
+bool crc32c_hardware();
+
+} // namespace utils
+} // namespace s1see
@@ -0,0 +1,111 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: expiry_queue.h
+ * Description: Deadline-ordered expiry queue used by the correlator and rule
+ *              engine. Expires only the keys that are actually due instead of
+ *              scanning every live entry. Times are nanoseconds on whatever
+ *              clock the caller drives it with (normally message capture time).
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace s1see {
+namespace utils {
+
+// Wall-clock time in nanoseconds since the Unix epoch
+inline int64_t wall_clock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Min-heap of (deadline, key) with one live deadline per key.
+//
+// Rescheduling a key to a later deadline only updates its recorded deadline;
+// the heap entry is pushed back when it surfaces. A key therefore costs one
+// heap slot however often it is touched, and each entry is re-pushed at most
+// once per expiry period. Not thread-safe; owners lock around it.
+template <typename Key, typename Hash = std::hash<Key>>
+class ExpiryQueue {
+public:
+    // Schedule key to expire at deadline, replacing any earlier schedule
+    void schedule(const Key& key, int64_t deadline) {
+        auto [it, inserted] = deadlines_.try_emplace(key, deadline);
+        if (inserted || deadline < it->second) {
+            heap_.push({deadline, key});
+        }
+        it->second = deadline;
+    }
+
+    // Forget key; any heap entry for it is dropped when it surfaces
+    void cancel(const Key& key) {
+        deadlines_.erase(key);
+    }
+
+    // Remove every key whose deadline is <= now, calling fn(key) for each.
+    // fn may schedule keys again (including the one being expired).
+    // Returns the number of keys expired.
+    template <typename Fn>
+    size_t expire(int64_t now, Fn&& fn) {
+        size_t expired = 0;
+        while (!heap_.empty() && heap_.top().deadline <= now) {
+            Entry entry = heap_.top();
+            heap_.pop();
+
+            auto it = deadlines_.find(entry.key);
+            if (it == deadlines_.end()) {
+                continue; // Cancelled or already expired
+            }
+            if (it->second > entry.deadline) {
+                // Rescheduled later since this entry was pushed
+                if (it->second > now) {
+                    heap_.push({it->second, entry.key});
+                    continue;
+                }
+            }
+            deadlines_.erase(it);
+            fn(entry.key);
+            ++expired;
+        }
+        return expired;
+    }
+
+    // Number of keys with a live deadline
+    size_t size() const { return deadlines_.size(); }
+    bool empty() const { return deadlines_.empty(); }
+
+    // Heap entries, including ones superseded by a later reschedule
+    size_t heap_size() const { return heap_.size(); }
+
+    void clear() {
+        deadlines_.clear();
+        heap_ = {};
+    }
+
+private:
+    struct Entry {
+        int64_t deadline;
+        Key key;
+    };
+    struct Later {
+        bool operator()(const Entry& a, const Entry& b) const {
+            return a.deadline > b.deadline;
+        }
+    };
+
+    std::priority_queue<Entry, std::vector<Entry>, Later> heap_;
+    std::unordered_map<Key, int64_t, Hash> deadlines_;
+};
+
+} // namespace utils
+} // namespace s1see
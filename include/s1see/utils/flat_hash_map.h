@@ -0,0 +1,197 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: flat_hash_map.h
+ * Description: Open-addressing hash map for integer keys. Keys, values and
+ *              slot states live in separate contiguous arrays (linear probing,
+ *              backward-shift deletion, no tombstones), so lookups touch a few
+ *              cache lines instead of chasing node pointers. Used for the
+ *              S1AP-ID and TEID indexes of the UE correlator.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace s1see {
+namespace utils {
+
+template <typename K, typename V>
+class FlatHashMap {
+    static_assert(std::is_integral_v<K>, "FlatHashMap keys must be integers");
+
+public:
+    // Iterators expose it->first / it->second like std::unordered_map
+    struct Reference {
+        const K& first;
+        V& second;
+    };
+
+    class iterator {
+    public:
+        iterator() = default;
+        iterator(FlatHashMap* map, size_t index) : map_(map), index_(index) { skip_empty(); }
+
+        Reference operator*() const { return {map_->keys_[index_], map_->values_[index_]}; }
+
+        struct Arrow {
+            Reference ref;
+            Reference* operator->() { return &ref; }
+        };
+        Arrow operator->() const { return Arrow{**this}; }
+
+        iterator& operator++() {
+            ++index_;
+            skip_empty();
+            return *this;
+        }
+        bool operator==(const iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const iterator& other) const { return index_ != other.index_; }
+
+    private:
+        friend class FlatHashMap;
+        void skip_empty() {
+            while (index_ < map_->used_.size() && !map_->used_[index_]) ++index_;
+        }
+        FlatHashMap* map_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    FlatHashMap() = default;
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, used_.size()); }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return used_.size(); }
+
+    iterator find(K key) {
+        if (size_ == 0) return end();
+        size_t mask = used_.size() - 1;
+        for (size_t i = slot_for(key);; i = (i + 1) & mask) {
+            if (!used_[i]) return end();
+            if (keys_[i] == key) return iterator(this, i);
+        }
+    }
+
+    size_t count(K key) { return find(key) != end() ? 1 : 0; }
+
+    V& operator[](K key) {
+        if ((size_ + 1) * 4 > used_.size() * 3) {
+            rehash(used_.empty() ? kMinCapacity : used_.size() * 2);
+        }
+        size_t mask = used_.size() - 1;
+        size_t i = slot_for(key);
+        for (; used_[i]; i = (i + 1) & mask) {
+            if (keys_[i] == key) return values_[i];
+        }
+        used_[i] = 1;
+        keys_[i] = key;
+        values_[i] = V();
+        ++size_;
+        return values_[i];
+    }
+
+    size_t erase(K key) {
+        iterator it = find(key);
+        if (it == end()) return 0;
+        erase(it);
+        return 1;
+    }
+
+    // Erase the element at it. Backward-shift deletion may move a later
+    // element into this slot, so do not erase while iterating.
+    void erase(iterator it) {
+        size_t mask = used_.size() - 1;
+        size_t hole = it.index_;
+        size_t i = hole;
+        while (true) {
+            i = (i + 1) & mask;
+            if (!used_[i]) break;
+            // Shift back an element whose home slot lies outside (hole, i]
+            size_t home = slot_for(keys_[i]);
+            if (((i - home) & mask) >= ((i - hole) & mask)) {
+                keys_[hole] = keys_[i];
+                values_[hole] = std::move(values_[i]);
+                hole = i;
+            }
+        }
+        used_[hole] = 0;
+        values_[hole] = V();
+        --size_;
+    }
+
+    void reserve(size_t n) {
+        size_t capacity = kMinCapacity;
+        while (capacity * 3 < n * 4) capacity *= 2;
+        if (capacity > used_.size()) rehash(capacity);
+    }
+
+    void clear() {
+        keys_.clear();
+        values_.clear();
+        used_.clear();
+        size_ = 0;
+        shift_ = 64;
+    }
+
+    // Call fn(key, value) for every element (read-only traversal)
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (size_t i = 0; i < used_.size(); ++i) {
+            if (used_[i]) fn(keys_[i], values_[i]);
+        }
+    }
+
+    // Bytes held by the slot arrays (excluding heap owned by values)
+    size_t memory_bytes() const {
+        return keys_.capacity() * sizeof(K) + values_.capacity() * sizeof(V) + used_.capacity();
+    }
+
+private:
+    static constexpr size_t kMinCapacity = 16;
+
+    size_t slot_for(K key) const {
+        // Fibonacci hashing: the top bits of key * 2^64/phi spread sequential keys
+        return static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL) >> shift_);
+    }
+
+    void rehash(size_t new_capacity) {
+        std::vector<K> old_keys = std::move(keys_);
+        std::vector<V> old_values = std::move(values_);
+        std::vector<uint8_t> old_used = std::move(used_);
+
+        keys_.assign(new_capacity, K());
+        values_.clear();
+        values_.resize(new_capacity);
+        used_.assign(new_capacity, 0);
+        shift_ = 64;
+        for (size_t c = new_capacity; c > 1; c >>= 1) --shift_;
+
+        size_t mask = new_capacity - 1;
+        for (size_t j = 0; j < old_used.size(); ++j) {
+            if (!old_used[j]) continue;
+            size_t i = slot_for(old_keys[j]);
+            while (used_[i]) i = (i + 1) & mask;
+            used_[i] = 1;
+            keys_[i] = old_keys[j];
+            values_[i] = std::move(old_values[j]);
+        }
+    }
+
+    std::vector<K> keys_;
+    std::vector<V> values_;
+    std::vector<uint8_t> used_;
+    size_t size_ = 0;
+    unsigned shift_ = 64;
+};
+
+} // namespace utils
+} // namespace s1see
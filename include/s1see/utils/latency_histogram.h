@@ -0,0 +1,120 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: latency_histogram.h
+ * Description: Log-linear latency histogram in the style of HdrHistogram.
+ *              Values are counted in fixed buckets with about 3% relative
+ *              error, so recording is O(1) and histograms merge by addition.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace s1see {
+namespace utils {
+
+// Not thread-safe: keep one histogram per thread and merge() them to report
+class LatencyHistogram {
+public:
+    // Each power of two is split into 2^SUB_BUCKET_BITS linear buckets
+    static constexpr unsigned SUB_BUCKET_BITS = 5;
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+    static constexpr size_t NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+    
+    void record(uint64_t value, uint64_t count = 1) {
+        counts_[bucket_index(value)] += count;
+        total_ += count;
+        sum_ += static_cast<double>(value) * static_cast<double>(count);
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+    
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        total_ += other.total_;
+        sum_ += other.sum_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+    
+    void reset() { *this = LatencyHistogram(); }
+    
+    uint64_t count() const { return total_; }
+    uint64_t min() const { return total_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return total_ ? sum_ / static_cast<double>(total_) : 0.0; }
+    
+    // Smallest bucket upper bound covering q percent of the values (q in
+    // 0..100), capped at the largest value recorded; 0 when empty
+    uint64_t percentile(double q) const {
+        if (total_ == 0) {
+            return 0;
+        }
+        double clamped = std::clamp(q, 0.0, 100.0);
+        uint64_t rank = static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(total_)));
+        rank = std::max<uint64_t>(rank, 1);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return std::clamp(bucket_upper(i), min_, max_);
+            }
+        }
+        return max_;
+    }
+    
+    // Calls fn(lower, upper, count) for each non-empty bucket, in order
+    template <typename Fn>
+    void for_each_bucket(Fn&& fn) const {
+        for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+            if (counts_[i] != 0) {
+                fn(bucket_lower(i), bucket_upper(i), counts_[i]);
+            }
+        }
+    }
+    
+    static size_t bucket_index(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return static_cast<size_t>(value);
+        }
+        unsigned shift = static_cast<unsigned>(std::bit_width(value)) - 1 - SUB_BUCKET_BITS;
+        return (shift + 1) * SUB_BUCKETS + static_cast<size_t>((value >> shift) - SUB_BUCKETS);
+    }
+    
+    static uint64_t bucket_lower(size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        unsigned shift = static_cast<unsigned>(index / SUB_BUCKETS) - 1;
+        return static_cast<uint64_t>(index % SUB_BUCKETS + SUB_BUCKETS) << shift;
+    }
+    
+    static uint64_t bucket_upper(size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        unsigned shift = static_cast<unsigned>(index / SUB_BUCKETS) - 1;
+        return bucket_lower(index) + ((uint64_t(1) << shift) - 1);
+    }
+    
+private:
+    std::array<uint64_t, NUM_BUCKETS> counts_{};
+    uint64_t total_ = 0;
+    double sum_ = 0.0;
+    uint64_t min_ = std::numeric_limits<uint64_t>::max();
+    uint64_t max_ = 0;
+};
+
+} // namespace utils
+} // namespace s1see
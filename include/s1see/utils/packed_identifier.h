@@ -0,0 +1,140 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: packed_identifier.h
+ * Description: Optional identifier string stored as packed nibbles. Normalized
+ *              IMSIs, IMEISVs and TMSIs are at most 16 lowercase hex digits, so
+ *              they fit in one 64-bit word instead of a 32-byte std::string.
+ *              Anything else spills to a heap string.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace s1see {
+namespace utils {
+
+class PackedIdentifier {
+public:
+    static constexpr size_t kMaxPackedDigits = 16;
+
+    PackedIdentifier() : nibbles_(0) {}
+    PackedIdentifier(const std::string& value) : nibbles_(0) { assign(value); }
+    PackedIdentifier(const PackedIdentifier& other) : nibbles_(0) { *this = other; }
+    PackedIdentifier(PackedIdentifier&& other) noexcept
+        : nibbles_(other.nibbles_), length_(other.length_), state_(other.state_) {
+        other.state_ = State::EMPTY;
+    }
+    ~PackedIdentifier() { reset(); }
+
+    PackedIdentifier& operator=(const PackedIdentifier& other) {
+        if (this == &other) return *this;
+        if (other.state_ == State::SPILLED) {
+            assign(*other.spilled_);
+        } else {
+            reset();
+            nibbles_ = other.nibbles_;
+            length_ = other.length_;
+            state_ = other.state_;
+        }
+        return *this;
+    }
+    PackedIdentifier& operator=(PackedIdentifier&& other) noexcept {
+        if (this != &other) {
+            reset();
+            nibbles_ = other.nibbles_;
+            length_ = other.length_;
+            state_ = other.state_;
+            other.state_ = State::EMPTY;
+        }
+        return *this;
+    }
+    PackedIdentifier& operator=(const std::string& value) {
+        assign(value);
+        return *this;
+    }
+
+    PackedIdentifier& operator=(std::nullopt_t) {
+        reset();
+        return *this;
+    }
+
+    bool has_value() const { return state_ != State::EMPTY; }
+    explicit operator bool() const { return has_value(); }
+
+    // Unpacked string; empty if no value
+    std::string value() const {
+        if (state_ == State::SPILLED) return *spilled_;
+        std::string out(length_, '0');
+        for (size_t i = 0; i < length_; ++i) {
+            out[i] = "0123456789abcdef"[(nibbles_ >> (4 * i)) & 0xF];
+        }
+        return out;
+    }
+
+    std::optional<std::string> get() const {
+        return has_value() ? std::optional<std::string>(value()) : std::nullopt;
+    }
+
+    void reset() {
+        if (state_ == State::SPILLED) delete spilled_;
+        nibbles_ = 0;
+        length_ = 0;
+        state_ = State::EMPTY;
+    }
+
+    // Heap bytes held for a spilled value
+    size_t heap_bytes() const {
+        return state_ == State::SPILLED ? sizeof(std::string) + spilled_->capacity() : 0;
+    }
+
+private:
+    enum class State : uint8_t { EMPTY, PACKED, SPILLED };
+
+    static int nibble(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;
+    }
+
+    void assign(const std::string& value) {
+        uint64_t packed = 0;
+        bool packable = value.size() <= kMaxPackedDigits;
+        for (size_t i = 0; packable && i < value.size(); ++i) {
+            int n = nibble(value[i]);
+            if (n < 0) {
+                packable = false;
+            } else {
+                packed |= static_cast<uint64_t>(n) << (4 * i);
+            }
+        }
+        if (packable) {
+            reset();
+            nibbles_ = packed;
+            length_ = static_cast<uint8_t>(value.size());
+            state_ = State::PACKED;
+        } else if (state_ == State::SPILLED) {
+            *spilled_ = value;
+        } else {
+            spilled_ = new std::string(value);
+            length_ = 0;
+            state_ = State::SPILLED;
+        }
+    }
+
+    union {
+        uint64_t nibbles_;
+        std::string* spilled_;
+    };
+    uint8_t length_ = 0;
+    State state_ = State::EMPTY;
+};
+
+} // namespace utils
+} // namespace s1see
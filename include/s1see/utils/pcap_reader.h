@@ -7,6 +7,8 @@
  * Description: Header for PCAP file reader utility. Provides interface for reading
  *              network packet captures from PCAP files, extracting packet data with
  *              timestamps, and supporting both libpcap and basic file reading.
+ *              MappedPcapFile reads pcap and pcapng captures in place through
+ *              mmap without libpcap.
  */
 
 #pragma once
@@ -15,6 +17,7 @@
 #include <vector>
 #include <functional>
 #include <cstdint>
+#include <cstddef>
 
 namespace s1see {
 namespace utils {
@@ -34,6 +37,67 @@ struct PcapPacket {
 int read_pcap_file(const std::string& pcap_path,
                    std::function<void(const PcapPacket&)> packet_callback);
 
+// Packet in a memory-mapped capture. data points into the mapping and is
+// valid until the MappedPcapFile is destroyed.
+struct PcapFrame {
+    int64_t timestamp_ns;
+    uint32_t captured_len;
+    uint32_t original_len;
+    uint32_t frame_number;  // 1-indexed, counting packet blocks only
+    uint32_t link_type;
+    const uint8_t* data;
+};
+
+// Zero-copy reader for classic pcap (micro- and nanosecond, either byte
+// order) and pcapng (SHB/IDB/EPB/SPB, multiple sections). Frames are
+// returned in file order. A record cut short at the end of the file ends
+// the capture, as libpcap does for truncated captures.
+class MappedPcapFile {
+public:
+    // Throws std::runtime_error if the file cannot be mapped or is not a
+    // pcap/pcapng capture
+    explicit MappedPcapFile(const std::string& path);
+    ~MappedPcapFile();
+
+    MappedPcapFile(const MappedPcapFile&) = delete;
+    MappedPcapFile& operator=(const MappedPcapFile&) = delete;
+
+    // Read the next packet; false at end of capture. Throws
+    // std::runtime_error on a malformed block.
+    bool next(PcapFrame& frame);
+
+    bool is_pcapng() const { return pcapng_; }
+    size_t size() const { return size_; }
+    size_t position() const { return pos_; }
+
+private:
+    struct Interface {
+        uint32_t link_type;
+        uint64_t ticks_per_second;
+    };
+
+    bool next_pcap(PcapFrame& frame);
+    bool next_pcapng(PcapFrame& frame);
+    void read_section_header(size_t block_len);
+    void read_interface(size_t body, size_t body_len);
+    uint16_t read16(size_t pos) const;
+    uint32_t read32(size_t pos) const;
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    size_t pos_ = 0;
+    bool pcapng_ = false;
+    bool swapped_ = false;      // File byte order differs from host order
+    uint32_t frame_number_ = 0;
+
+    // Classic pcap
+    bool nanosecond_ = false;
+    uint32_t link_type_ = 0;
+
+    // pcapng: interfaces of the current section
+    std::vector<Interface> interfaces_;
+};
+
 } // namespace utils
 } // namespace s1see
 
@@ -0,0 +1,91 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: s1ap_builder.h
+ * Description: Header for an S1AP/NAS message builder. Encodes well-formed
+ *              APER S1AP PDUs and EPS NAS messages for the attach, service
+ *              request, TAU, handover and release procedures, for use by
+ *              benchmarks, tests and the load generator.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace s1see {
+namespace utils {
+
+// Serving cell of a UE: PLMN as MCC+MNC digits ("00101"), 28-bit E-UTRAN
+// cell identity (eNB ID in the top 20 bits) and tracking area code
+struct S1apCell {
+    std::string plmn = "00101";
+    uint32_t eci = 0;
+    uint16_t tac = 1;
+
+    uint32_t enb_id() const { return eci >> 8; }
+};
+
+// EPS GUTI assigned by the MME
+struct Guti {
+    std::string plmn = "00101";
+    uint16_t mme_group_id = 1;
+    uint8_t mme_code = 1;
+    uint32_t m_tmsi = 0;
+};
+
+// Default bearer set up for a UE: E-RAB ID, GTP-U TEID and IPv4 endpoint
+struct ERab {
+    uint8_t id = 5;
+    uint32_t teid = 0;
+    uint32_t transport_address = 0x0A000001;  // 10.0.0.1
+    uint8_t qci = 9;
+};
+
+class S1apBuilder {
+public:
+    using Bytes = std::vector<uint8_t>;
+
+    // EPS mobility management (TS 24.301). Messages sent after security
+    // activation carry an integrity-protected header with a zero MAC and
+    // the given NAS count; the payload is unciphered (EEA0).
+    static Bytes attach_request(const std::string& imsi);
+    static Bytes attach_accept(const Guti& guti, const S1apCell& cell, uint32_t ue_address, uint8_t nas_count);
+    static Bytes attach_complete(uint8_t nas_count);
+    static Bytes tau_request(const Guti& guti, uint8_t nas_count);
+    static Bytes tau_accept(const Guti& guti, const S1apCell& cell, uint8_t nas_count);
+    static Bytes service_request(uint8_t ksi, uint8_t nas_count);
+
+    // UE-associated S1AP procedures (TS 36.413)
+    static Bytes initial_ue_message(uint32_t enb_ue_id, const Bytes& nas, const S1apCell& cell,
+                                    const std::optional<Guti>& s_tmsi = std::nullopt);
+    static Bytes downlink_nas_transport(uint32_t mme_ue_id, uint32_t enb_ue_id, const Bytes& nas);
+    static Bytes uplink_nas_transport(uint32_t mme_ue_id, uint32_t enb_ue_id, const Bytes& nas,
+                                      const S1apCell& cell);
+    static Bytes initial_context_setup_request(uint32_t mme_ue_id, uint32_t enb_ue_id, const ERab& erab,
+                                               const Bytes& nas = {});
+    static Bytes initial_context_setup_response(uint32_t mme_ue_id, uint32_t enb_ue_id, const ERab& erab);
+    static Bytes ue_context_release_request(uint32_t mme_ue_id, uint32_t enb_ue_id);
+    static Bytes ue_context_release_command(uint32_t mme_ue_id, uint32_t enb_ue_id);
+    static Bytes ue_context_release_complete(uint32_t mme_ue_id, uint32_t enb_ue_id);
+
+    // S1 handover: Required/Command on the source eNB, Request/Ack/Notify
+    // on the target eNB
+    static Bytes handover_required(uint32_t mme_ue_id, uint32_t enb_ue_id, const S1apCell& target);
+    static Bytes handover_request(uint32_t mme_ue_id, const ERab& erab);
+    static Bytes handover_request_ack(uint32_t mme_ue_id, uint32_t enb_ue_id, const ERab& erab);
+    static Bytes handover_command(uint32_t mme_ue_id, uint32_t enb_ue_id);
+    static Bytes handover_notify(uint32_t mme_ue_id, uint32_t enb_ue_id, const S1apCell& cell);
+
+    // X2 handover as seen on S1: the target eNB switches the downlink path
+    static Bytes path_switch_request(uint32_t source_mme_ue_id, uint32_t enb_ue_id, const ERab& erab,
+                                     const S1apCell& cell);
+    static Bytes path_switch_request_ack(uint32_t mme_ue_id, uint32_t enb_ue_id);
+};
+
+} // namespace utils
+} // namespace s1see
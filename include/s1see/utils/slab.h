@@ -0,0 +1,148 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: slab.h
+ * Description: Slab storage with stable handles. Objects live in fixed-size
+ *              chunks that never move, so handles and pointers stay valid
+ *              until the object is released; released slots are reused
+ *              before a new chunk is allocated. Used for per-UE records.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace s1see {
+namespace utils {
+
+// Handles start at 1 so that 0 can mean "none". Not thread-safe.
+template <typename T, size_t ChunkSize = 1024>
+class Slab {
+public:
+    using Handle = uint32_t;
+
+    // Range-for over live objects yields {handle, object}
+    template <bool Const>
+    class basic_iterator {
+        using SlabRef = std::conditional_t<Const, const Slab*, Slab*>;
+        using ValueRef = std::conditional_t<Const, const T&, T&>;
+
+    public:
+        basic_iterator(SlabRef slab, Handle handle) : slab_(slab), handle_(handle) { skip_free(); }
+
+        std::pair<Handle, ValueRef> operator*() const { return {handle_, *slab_->get(handle_)}; }
+        basic_iterator& operator++() {
+            ++handle_;
+            skip_free();
+            return *this;
+        }
+        bool operator!=(const basic_iterator& other) const { return handle_ != other.handle_; }
+        bool operator==(const basic_iterator& other) const { return handle_ == other.handle_; }
+
+    private:
+        void skip_free() {
+            while (handle_ <= slab_->live_.size() && !slab_->live_[handle_ - 1]) ++handle_;
+        }
+        SlabRef slab_;
+        Handle handle_;
+    };
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    Slab() = default;
+    Slab(const Slab&) = delete;
+    Slab& operator=(const Slab&) = delete;
+    ~Slab() { clear(); }
+
+    // Construct a new object and return its handle
+    template <typename... Args>
+    Handle emplace(Args&&... args) {
+        Handle handle;
+        if (!free_.empty()) {
+            handle = free_.back();
+            free_.pop_back();
+        } else {
+            if (live_.size() == chunks_.size() * ChunkSize) {
+                chunks_.emplace_back(new Slot[ChunkSize]);
+            }
+            live_.push_back(0);
+            handle = static_cast<Handle>(live_.size());
+        }
+        new (slot(handle)) T(std::forward<Args>(args)...);
+        live_[handle - 1] = 1;
+        ++size_;
+        return handle;
+    }
+
+    // Destroy the object; its slot is reused by a later emplace
+    void release(Handle handle) {
+        if (!contains(handle)) return;
+        get(handle)->~T();
+        live_[handle - 1] = 0;
+        free_.push_back(handle);
+        --size_;
+    }
+
+    bool contains(Handle handle) const {
+        return handle >= 1 && handle <= live_.size() && live_[handle - 1];
+    }
+
+    // Object for handle, or nullptr if the handle is not live
+    T* get(Handle handle) {
+        return contains(handle) ? std::launder(reinterpret_cast<T*>(slot(handle))) : nullptr;
+    }
+    const T* get(Handle handle) const {
+        return contains(handle) ? std::launder(reinterpret_cast<const T*>(slot(handle))) : nullptr;
+    }
+
+    iterator begin() { return iterator(this, 1); }
+    iterator end() { return iterator(this, static_cast<Handle>(live_.size() + 1)); }
+    const_iterator begin() const { return const_iterator(this, 1); }
+    const_iterator end() const { return const_iterator(this, static_cast<Handle>(live_.size() + 1)); }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    void clear() {
+        for (Handle handle = 1; handle <= live_.size(); ++handle) {
+            if (live_[handle - 1]) get(handle)->~T();
+        }
+        chunks_.clear();
+        live_.clear();
+        free_.clear();
+        size_ = 0;
+    }
+
+    // Bytes held by chunks and bookkeeping (excluding heap owned by objects)
+    size_t memory_bytes() const {
+        return chunks_.size() * ChunkSize * sizeof(Slot) +
+               chunks_.capacity() * sizeof(std::unique_ptr<Slot[]>) +
+               live_.capacity() + free_.capacity() * sizeof(Handle);
+    }
+
+private:
+    struct Slot {
+        alignas(T) unsigned char bytes[sizeof(T)];
+    };
+
+    Slot* slot(Handle handle) const {
+        size_t index = handle - 1;
+        return &chunks_[index / ChunkSize][index % ChunkSize];
+    }
+
+    std::vector<std::unique_ptr<Slot[]>> chunks_;
+    std::vector<uint8_t> live_;
+    std::vector<Handle> free_;
+    size_t size_ = 0;
+};
+
+} // namespace utils
+} // namespace s1see
@@ -0,0 +1,139 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: small_vector.h
+ * Description: Vector of trivially copyable values that keeps up to N elements
+ *              inline and only allocates beyond that. Used where nearly every
+ *              instance holds a handful of values (e.g. a subscriber's TEIDs).
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace s1see {
+namespace utils {
+
+template <typename T, size_t N>
+class SmallVector {
+    static_assert(std::is_trivially_copyable_v<T>, "SmallVector holds trivially copyable values");
+    static_assert(N > 0, "SmallVector needs inline capacity");
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() = default;
+    SmallVector(const SmallVector& other) { assign(other); }
+    SmallVector(SmallVector&& other) noexcept { take(other); }
+    ~SmallVector() { release(); }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            size_ = 0;
+            assign(other);
+        }
+        return *this;
+    }
+    SmallVector& operator=(SmallVector&& other) noexcept {
+        if (this != &other) {
+            release();
+            take(other);
+        }
+        return *this;
+    }
+
+    T* data() { return on_heap() ? heap_ : inline_; }
+    const T* data() const { return on_heap() ? heap_ : inline_; }
+    iterator begin() { return data(); }
+    iterator end() { return data() + size_; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + size_; }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return capacity_; }
+    T& operator[](size_t i) { return data()[i]; }
+    const T& operator[](size_t i) const { return data()[i]; }
+
+    void push_back(const T& value) {
+        if (size_ == capacity_) grow(capacity_ * 2);
+        data()[size_++] = value;
+    }
+
+    iterator erase(iterator pos) {
+        std::memmove(pos, pos + 1, (end() - pos - 1) * sizeof(T));
+        --size_;
+        return pos;
+    }
+
+    void clear() { size_ = 0; }
+
+    bool contains(const T& value) const {
+        return std::find(begin(), end(), value) != end();
+    }
+
+    // Remove the first element equal to value; returns whether one was found
+    bool erase_value(const T& value) {
+        iterator it = std::find(begin(), end(), value);
+        if (it == end()) return false;
+        erase(it);
+        return true;
+    }
+
+    // Heap bytes held beyond the inline buffer
+    size_t heap_bytes() const { return on_heap() ? capacity_ * sizeof(T) : 0; }
+
+private:
+    // The heap pointer shares storage with the inline buffer
+    bool on_heap() const { return capacity_ > N; }
+
+    void grow(size_t new_capacity) {
+        T* storage = new T[new_capacity];
+        std::memcpy(storage, data(), size_ * sizeof(T));
+        if (on_heap()) delete[] heap_;
+        heap_ = storage;
+        capacity_ = static_cast<uint32_t>(new_capacity);
+    }
+
+    void assign(const SmallVector& other) {
+        if (other.size_ > capacity_) grow(other.size_);
+        std::memcpy(data(), other.data(), other.size_ * sizeof(T));
+        size_ = other.size_;
+    }
+
+    void take(SmallVector& other) {
+        if (other.on_heap()) {
+            heap_ = other.heap_;
+            capacity_ = other.capacity_;
+            other.capacity_ = N;
+        } else {
+            std::memcpy(inline_, other.inline_, other.size_ * sizeof(T));
+        }
+        size_ = other.size_;
+        other.size_ = 0;
+    }
+
+    void release() {
+        if (on_heap()) delete[] heap_;
+        capacity_ = N;
+        size_ = 0;
+    }
+
+    uint32_t size_ = 0;
+    uint32_t capacity_ = N;
+    union {
+        T inline_[N];
+        T* heap_;
+    };
+};
+
+} // namespace utils
+} // namespace s1see
@@ -0,0 +1,57 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: thread_pool.h
+ * Description: Header for a fixed-size worker thread pool. Provides a blocking
+ *              parallel_for used by the processing pipeline to fan work out
+ *              across persistent threads and join before continuing.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+namespace s1see {
+namespace utils {
+
+// Fixed-size pool of persistent worker threads
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Run fn(i) for every i in [0, count) across the pool and block until
+    // all calls have returned. Exceptions thrown by fn are not propagated;
+    // callers are expected to handle errors per item. One caller at a time.
+    void parallel_for(size_t count, const std::function<void(size_t)>& fn);
+
+    size_t size() const { return workers_.size(); }
+
+private:
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+
+    // Current parallel_for job
+    const std::function<void(size_t)>* job_ = nullptr;
+    size_t job_count_ = 0;
+    size_t next_index_ = 0;
+    size_t completed_ = 0;
+    bool stopping_ = false;
+
+    void worker_loop();
+};
+
+} // namespace utils
+} // namespace s1see
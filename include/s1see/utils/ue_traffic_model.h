@@ -0,0 +1,72 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: ue_traffic_model.h
+ * Description: Header for UeTrafficModel, which produces the S1AP signalling
+ *              of a simulated UE population: attach, service request, S1 and
+ *              X2 handover, TAU and release, encoded with S1apBuilder.
+ */
+
+#pragma once
+
+#include "s1see/utils/s1ap_builder.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace s1see {
+namespace utils {
+
+class UeTrafficModel {
+public:
+    struct Config {
+        Config() : num_ues(1000), num_enbs(16), first_ue(0), plmn("00101") {}
+
+        size_t num_ues;    // UEs simulated by this model
+        size_t num_enbs;   // eNBs in the network (at least 2, for handovers)
+        size_t first_ue;   // Global index of the first UE, to split a population across models
+                           // (first_ue + num_ues at most MAX_UES)
+        std::string plmn;
+    };
+
+    struct Pdu {
+        const char* procedure;  // Builder message, e.g. "handover_notify"
+        uint32_t enb;           // eNB the PDU was exchanged with
+        S1apBuilder::Bytes bytes;
+    };
+
+    static constexpr size_t MAX_UES = size_t(1) << 20;
+
+    // Throws std::runtime_error on an invalid config
+    explicit UeTrafficModel(const Config& config = Config());
+
+    // Next PDU. Every UE runs the same script: attach, release, service
+    // request, S1 handover, X2 handover back, release, TAU, release. UEs
+    // advance one step each in turn, so their procedures interleave as on
+    // an S1-MME link. The script repeats with fresh S1AP IDs and TEIDs.
+    Pdu next();
+
+    // PDUs in one pass of the script, per UE
+    static size_t script_length();
+
+    // Completed passes over the whole population
+    uint64_t cycles() const { return cycle_; }
+
+    // Identities of a UE, by global index
+    static std::string imsi(const std::string& plmn, size_t ue);
+    static uint32_t m_tmsi(size_t ue);
+
+private:
+    Config config_;
+    size_t step_ = 0;
+    size_t ue_ = 0;
+    uint64_t cycle_ = 0;
+
+    S1apCell cell(size_t enb) const;
+    Pdu build(size_t step, size_t ue) const;
+};
+
+} // namespace utils
+} // namespace s1see
@@ -11,6 +11,7 @@
  */
 
 #include "s1see/correlate/correlator.h"
+#include "s1see/utils/codec.h"
 #include "s1ap_ue_correlator.h"
 #include "s1ap_parser.h"
 #include <algorithm>
@@ -20,78 +21,17 @@
 #include <ctime>
 #include <memory>
 #include <iostream>
+#include <cstring>
 
 namespace s1see {
 namespace correlate {
 
-// Helper function to convert bytes (std::string) to hex string
-static std::string bytes_to_hex_string(const std::string& bytes) {
-    if (bytes.empty()) {
-        return "";
-    }
-    std::ostringstream hex;
-    hex << std::hex << std::setfill('0');
-    for (unsigned char byte : bytes) {
-        hex << std::setw(2) << static_cast<int>(byte);
-    }
-    return hex.str();
-}
-
-// Helper function to convert hex string to bytes
-static std::vector<uint8_t> hex_string_to_bytes(const std::string& hex) {
-    std::vector<uint8_t> bytes;
-    for (size_t i = 0; i < hex.length(); i += 2) {
-        if (i + 1 < hex.length()) {
-            std::string byte_str = hex.substr(i, 2);
-            bytes.push_back(static_cast<uint8_t>(std::stoul(byte_str, nullptr, 16)));
-        }
-    }
-    return bytes;
-}
-
-// Helper function to extract S1AP IDs from UE-S1AP-IDs IE
-// UE-S1AP-IDs contains MME-UE-S1AP-ID in first 4 bytes and eNB-UE-S1AP-ID in second 4 bytes
-static std::pair<std::optional<uint32_t>, std::optional<uint32_t>> 
-extract_ids_from_ue_s1ap_ids(const std::string& hex_value) {
-    std::optional<uint32_t> mme_id = std::nullopt;
-    std::optional<uint32_t> enb_id = std::nullopt;
-    
-    if (hex_value.empty()) {
-        return {mme_id, enb_id};
-    }
-    
-    try {
-        // Convert hex string to bytes
-        std::vector<uint8_t> bytes = hex_string_to_bytes(hex_value);
-        
-        // UE-S1AP-IDs should be 8 bytes (4 bytes for MME-UE-S1AP-ID + 4 bytes for eNB-UE-S1AP-ID)
-        if (bytes.size() >= 8) {
-            // Extract MME-UE-S1AP-ID from first 4 bytes (big-endian)
-            mme_id = (static_cast<uint32_t>(bytes[0]) << 24) |
-                     (static_cast<uint32_t>(bytes[1]) << 16) |
-                     (static_cast<uint32_t>(bytes[2]) << 8) |
-                     static_cast<uint32_t>(bytes[3]);
-            
-            // Extract eNB-UE-S1AP-ID from next 4 bytes (big-endian)
-            enb_id = (static_cast<uint32_t>(bytes[4]) << 24) |
-                     (static_cast<uint32_t>(bytes[5]) << 16) |
-                     (static_cast<uint32_t>(bytes[6]) << 8) |
-                     static_cast<uint32_t>(bytes[7]);
-        }
-    } catch (const std::exception& e) {
-        // Failed to parse UE-S1AP-IDs - silently continue
-    }
-    
-    return {mme_id, enb_id};
-}
-
-Correlator::Correlator(const Config& config) : config_(config) {
+Correlator::Correlator(const Config& config)
+    : config_(config), context_pool_(std::make_shared<utils::BlockPool>()) {
     s1ap_correlator_ = std::make_unique<s1ap_correlator::S1apUeCorrelator>();
 }
 
-std::string Correlator::get_or_create_context(const CanonicalMessage& message) {
-    std::unique_lock<std::shared_mutex> lock(mutex_);
-    
+s1ap_parser::S1apParseResult Correlator::rebuild_parse_result(const CanonicalMessage& message) {
     // Convert CanonicalMessage to S1apParseResult format
     s1ap_parser::S1apParseResult s1ap_result;
     s1ap_result.procedure_code = static_cast<uint8_t>(message.procedure_code());
@@ -105,8 +45,12 @@ std::string Correlator::get_or_create_context(const CanonicalMessage& message) {
         s1ap_result.raw_bytes.assign(message.raw_bytes().begin(), message.raw_bytes().end());
     }
     
-    // Try to parse the decoded_tree JSON to get information_elements
-    if (!message.decoded_tree().empty()) {
+    // IE values by ID from the message's IE table, else parsed (by name)
+    // from the decoded_tree JSON
+    for (const auto& ie : message.information_elements()) {
+        s1ap_result.information_elements[static_cast<uint16_t>(ie.id())] = utils::to_hex(ie.value());
+    }
+    if (message.information_elements().empty() && !message.decoded_tree().empty()) {
         // Simple JSON parsing for information_elements
         // This is a simplified parser - in production you'd use a proper JSON library
         std::string json = message.decoded_tree();
@@ -123,7 +67,8 @@ std::string Correlator::get_or_create_context(const CanonicalMessage& message) {
                     if (key_start == std::string::npos) break;
                     size_t key_end = ie_section.find("\"", key_start + 1);
                     if (key_end == std::string::npos) break;
-                    std::string key = ie_section.substr(key_start + 1, key_end - key_start - 1);
+                    auto ie_id = s1ap_parser::getIeIdFromName(
+                        std::string_view(ie_section).substr(key_start + 1, key_end - key_start - 1));
                     
                     size_t val_start = ie_section.find(":\"", key_end);
                     if (val_start == std::string::npos) break;
@@ -131,28 +76,144 @@ std::string Correlator::get_or_create_context(const CanonicalMessage& message) {
                     if (val_end == std::string::npos) break;
                     std::string value = ie_section.substr(val_start + 2, val_end - val_start - 2);
                     
-                    s1ap_result.information_elements[key] = value;
+                    if (ie_id) s1ap_result.information_elements[*ie_id] = value;
                     pos = val_end + 1;
                 }
             }
         }
     }
     
-    // Add S1AP IDs to information_elements if not already present
+    // Add S1AP IDs to information_elements if not already present: the MME
+    // ID as 8 hex digits, the (24-bit) eNB ID as 6
+    auto id_hex = [](uint32_t id) {
+        const uint8_t be[4] = {static_cast<uint8_t>(id >> 24), static_cast<uint8_t>(id >> 16),
+                               static_cast<uint8_t>(id >> 8), static_cast<uint8_t>(id)};
+        return utils::to_hex(std::span<const uint8_t>(be, 4));
+    };
     if (message.mme_ue_s1ap_id() != 0) {
-        std::ostringstream hex;
-        hex << std::hex << std::setfill('0') << std::setw(8) << message.mme_ue_s1ap_id();
-        if (s1ap_result.information_elements.find("MME-UE-S1AP-ID") == s1ap_result.information_elements.end()) {
-            s1ap_result.information_elements["MME-UE-S1AP-ID"] = hex.str();
-        }
+        s1ap_result.information_elements.try_emplace(
+            static_cast<uint16_t>(s1ap_parser::S1apIeId::MME_UE_S1AP_ID), id_hex(message.mme_ue_s1ap_id()));
     }
     if (message.enb_ue_s1ap_id() != 0) {
-        std::ostringstream hex;
-        hex << std::hex << std::setfill('0') << std::setw(6) << message.enb_ue_s1ap_id();
-        if (s1ap_result.information_elements.find("eNB-UE-S1AP-ID") == s1ap_result.information_elements.end()) {
-            s1ap_result.information_elements["eNB-UE-S1AP-ID"] = hex.str();
+        auto key = static_cast<uint16_t>(s1ap_parser::S1apIeId::ENB_UE_S1AP_ID);
+        if (s1ap_result.information_elements.find(key) == s1ap_result.information_elements.end()) {
+            std::string hex = id_hex(message.enb_ue_s1ap_id());
+            // Six digits unless the ID has grown past 24 bits
+            s1ap_result.information_elements[key] = hex.compare(0, 2, "00") == 0 ? hex.substr(2) : hex;
+        }
+    }
+    
+    return s1ap_result;
+}
+
+int64_t Correlator::current_time_ns() const {
+    if (!config_.event_time) {
+        return utils::wall_clock_ns();
+    }
+    if (watermark_ns_ != 0) {
+        return watermark_ns_;
+    }
+    return clock_ns_ != 0 ? clock_ns_ : utils::wall_clock_ns();
+}
+
+void Correlator::advance_watermark(int64_t watermark_ns) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    watermark_ns_ = std::max(watermark_ns_, watermark_ns);
+}
+
+SubscriberId Correlator::get_or_create_subscriber(const CanonicalMessage& message,
+                                                 const s1ap_parser::S1apParseResult* parse_result) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    
+    // Message time drives last_seen and expiry, so replays age contexts
+    // exactly as the live capture did
+    int64_t ts = config_.event_time ? message.ts_capture() : 0;
+    if (ts > 0) {
+        clock_ns_ = std::max(clock_ns_, ts);
+    } else {
+        ts = config_.event_time ? current_time_ns() : utils::wall_clock_ns();
+    }
+    
+    SubscriberId id = resolve_context(message, parse_result);
+    if (id != 0) {
+        auto it = contexts_.find(id);
+        if (it != contexts_.end()) {
+            it->second->last_seen = std::chrono::system_clock::time_point(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                    std::chrono::nanoseconds(ts)));
+            expiry_.schedule(id, ts + std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                          config_.context_expiry).count());
+            publish(it->second);
         }
     }
+    return id;
+}
+
+void Correlator::publish(const std::shared_ptr<UEContext>& context) {
+    ReadStripe& stripe = read_stripe(context->id);
+    std::shared_ptr<const UEContext> previous;
+    {
+        std::unique_lock<std::shared_mutex> lock(stripe.mutex);
+        auto& published = stripe.contexts[context->id];
+        previous = std::move(published);
+        published = context;
+    }
+    if (!previous || previous->ecgi != context->ecgi) {
+        move_cell(context->id, previous ? &previous->ecgi : nullptr, &context->ecgi);
+    }
+}
+
+void Correlator::unpublish(SubscriberId id) {
+    ReadStripe& stripe = read_stripe(id);
+    std::shared_ptr<const UEContext> previous;
+    {
+        std::unique_lock<std::shared_mutex> lock(stripe.mutex);
+        auto it = stripe.contexts.find(id);
+        if (it == stripe.contexts.end()) {
+            return;
+        }
+        previous = std::move(it->second);
+        stripe.contexts.erase(it);
+    }
+    move_cell(id, &previous->ecgi, nullptr);
+}
+
+void Correlator::move_cell(SubscriberId id, const std::string* from, const std::string* to) {
+    std::unique_lock<std::shared_mutex> lock(cell_mutex_);
+    if (from && !from->empty()) {
+        auto cell = cell_index_.find(*from);
+        if (cell != cell_index_.end()) {
+            cell->second.erase(id);
+            if (cell->second.empty()) {
+                cell_index_.erase(cell);
+            }
+        }
+    }
+    if (to && !to->empty()) {
+        cell_index_[*to].insert(id);
+    }
+}
+
+std::string Correlator::get_or_create_context(const CanonicalMessage& message,
+                                              const s1ap_parser::S1apParseResult* parse_result) {
+    return subscriber_key(get_or_create_subscriber(message, parse_result));
+}
+
+std::string Correlator::subscriber_key(SubscriberId id) const {
+    auto context = get_context(id);
+    return context ? context->subscriber_key : std::string();
+}
+
+SubscriberId Correlator::resolve_context(const CanonicalMessage& message,
+                                         const s1ap_parser::S1apParseResult* parse_result) {
+    // Prefer the decoder's native parse result; rebuild one from the
+    // message (decoded_tree JSON + ID fields) only when none was supplied
+    std::optional<s1ap_parser::S1apParseResult> rebuilt;
+    if (!parse_result) {
+        rebuilt = rebuild_parse_result(message);
+        parse_result = &rebuilt.value();
+    }
+    const s1ap_parser::S1apParseResult& s1ap_result = *parse_result;
     
     // Process frame through S1apUeCorrelator
     // This will create/update a subscriber record if identifiers are found
@@ -164,70 +225,23 @@ std::string Correlator::get_or_create_context(const CanonicalMessage& message) {
     // Extract identifiers from current message
     std::optional<std::string> imsi = message.imsi().empty() ? std::nullopt : std::make_optional(message.imsi());
     std::optional<std::string> tmsi = message.tmsi().empty() ? std::nullopt : std::make_optional(message.tmsi());
-    std::optional<uint32_t> enb_ue_s1ap_id = std::nullopt;
-    std::optional<uint32_t> mme_ue_s1ap_id = std::nullopt;
     std::optional<std::string> imeisv = message.imei().empty() ? std::nullopt : std::make_optional(message.imei());
     
-    // First, try to extract S1AP IDs from UE-S1AP-IDs IE (contains both IDs in one field)
-    auto ue_s1ap_ids_it = s1ap_result.information_elements.find("UE-S1AP-IDs");
-    if (ue_s1ap_ids_it != s1ap_result.information_elements.end()) {
-        const std::string& ue_s1ap_ids_hex = ue_s1ap_ids_it->second;
-        
-        auto [mme_id, enb_id] = extract_ids_from_ue_s1ap_ids(ue_s1ap_ids_hex);
-        if (mme_id.has_value()) {
-            mme_ue_s1ap_id = mme_id;
-        }
-        if (enb_id.has_value()) {
-            enb_ue_s1ap_id = enb_id;
-        }
+    // S1AP IDs from the IEs (UE-S1AP-IDs or the individual IEs), then message fields
+    auto [mme_ue_s1ap_id, enb_ue_s1ap_id] = s1ap_parser::extractS1apIds(s1ap_result);
+    if (!mme_ue_s1ap_id.has_value() && message.mme_ue_s1ap_id() != 0) {
+        mme_ue_s1ap_id = static_cast<uint32_t>(message.mme_ue_s1ap_id());
     }
-    
-    // If UE-S1AP-IDs was not found or failed, try individual IEs or message fields
-    if (!mme_ue_s1ap_id.has_value()) {
-        // Try individual MME-UE-S1AP-ID IE first
-        auto mme_id_it = s1ap_result.information_elements.find("MME-UE-S1AP-ID");
-        if (mme_id_it != s1ap_result.information_elements.end()) {
-            const std::string& mme_id_hex = mme_id_it->second;
-            try {
-                std::string hex_str = mme_id_hex;
-                if (hex_str.length() > 2 && hex_str.substr(0, 2) == "0x") {
-                    hex_str = hex_str.substr(2);
-                }
-                mme_ue_s1ap_id = static_cast<uint32_t>(std::stoul(hex_str, nullptr, 16));
-            } catch (...) {}
-        }
-        // Fallback to message field
-        if (!mme_ue_s1ap_id.has_value() && message.mme_ue_s1ap_id() != 0) {
-            mme_ue_s1ap_id = static_cast<uint32_t>(message.mme_ue_s1ap_id());
-        }
-    }
-    
-    if (!enb_ue_s1ap_id.has_value()) {
-        // Try individual eNB-UE-S1AP-ID IE first
-        auto enb_id_it = s1ap_result.information_elements.find("eNB-UE-S1AP-ID");
-        if (enb_id_it != s1ap_result.information_elements.end()) {
-            const std::string& enb_id_hex = enb_id_it->second;
-            try {
-                std::string hex_str = enb_id_hex;
-                if (hex_str.length() > 2 && hex_str.substr(0, 2) == "0x") {
-                    hex_str = hex_str.substr(2);
-                }
-                enb_ue_s1ap_id = static_cast<uint32_t>(std::stoul(hex_str, nullptr, 16));
-            } catch (...) {}
-        }
-        // Fallback to message field
-        if (!enb_ue_s1ap_id.has_value() && message.enb_ue_s1ap_id() != 0) {
-            enb_ue_s1ap_id = static_cast<uint32_t>(message.enb_ue_s1ap_id());
-        }
+    if (!enb_ue_s1ap_id.has_value() && message.enb_ue_s1ap_id() != 0) {
+        enb_ue_s1ap_id = static_cast<uint32_t>(message.enb_ue_s1ap_id());
     }
     
     // Check if we already have a context that matches by any identifier
     // If so, merge identifiers from existing context with message identifiers
     std::shared_ptr<UEContext> existing_context = nullptr;
-    std::string existing_key;
     
     // Try to find existing context by any identifier from the message
-    for (const auto& [key, context] : contexts_) {
+    for (const auto& [id, context] : contexts_) {
         bool matches = false;
         
         // Check IMSI match
@@ -258,7 +272,6 @@ std::string Correlator::get_or_create_context(const CanonicalMessage& message) {
         
         if (matches) {
             existing_context = context;
-            existing_key = key;
             break;
         }
     }
@@ -294,7 +307,7 @@ std::string Correlator::get_or_create_context(const CanonicalMessage& message) {
     
     if (!has_any_identifier) {
         // No identifiers available - cannot correlate, do not process further
-        return "";
+        return 0;
     }
     
     // For UEContextReleaseComplete, don't create new subscribers - only update existing ones
@@ -323,7 +336,7 @@ std::string Correlator::get_or_create_context(const CanonicalMessage& message) {
             
             // If no existing subscriber found, and no existing context, return early
             if (!subscriber && !existing_context) {
-                return "";
+                return 0;
             }
         } else {
             // For other messages, call getOrCreateSubscriber with ALL available identifiers (existing + new)
@@ -337,81 +350,76 @@ std::string Correlator::get_or_create_context(const CanonicalMessage& message) {
     if (!subscriber) {
         // For UEContextReleaseComplete, if no subscriber found, return early
         if (is_release_complete) {
-            return "";
+            return 0;
         }
         // Fallback: create a context with minimal information
-        std::string key = "unknown_" + std::to_string(next_unknown_id_++);
-        auto context = std::make_shared<UEContext>();
+        auto context = std::allocate_shared<UEContext>(utils::PoolAllocator<UEContext>(context_pool_));
         context->update(message);
-        context->subscriber_key = key;
-        contexts_[key] = context;
-        return key;
+        context->id = next_context_id_++;
+        context->key_kind = SubscriberKeyKind::UNKNOWN;
+        context->subscriber_key = "unknown_" + std::to_string(next_unknown_id_++);
+        contexts_[context->id] = context;
+        return context->id;
     }
     
-    // Generate subscriber key from ALL identifiers in the merged subscriber record
-    std::string subscriber_key;
+    // Rank the best identifier in the merged subscriber record; the string
+    // key is only rendered when a context is created or its rank improves
+    // (IMSI > TMSI > MME/eNB-UE-S1AP-ID > unknown)
+    SubscriberKeyKind kind = SubscriberKeyKind::UNKNOWN;
     if (subscriber->imsi.has_value()) {
-        subscriber_key = "imsi:" + subscriber->imsi.value();
+        kind = SubscriberKeyKind::IMSI;
     } else if (subscriber->tmsi.has_value()) {
-        subscriber_key = "tmsi:" + subscriber->tmsi.value();
-    } else if (subscriber->mme_ue_s1ap_id.has_value()) {
-        subscriber_key = "mme_ue_s1ap_id:" + std::to_string(subscriber->mme_ue_s1ap_id.value());
-    } else if (subscriber->enb_ue_s1ap_id.has_value()) {
-        subscriber_key = "enb_ue_s1ap_id:" + std::to_string(subscriber->enb_ue_s1ap_id.value());
-    } else {
-        subscriber_key = "unknown_" + std::to_string(next_unknown_id_++);
+        kind = SubscriberKeyKind::TMSI;
+    } else if (subscriber->mme_ue_s1ap_id.has_value() || subscriber->enb_ue_s1ap_id.has_value()) {
+        kind = SubscriberKeyKind::S1AP_ID;
     }
     
-    // If we found an existing context, check if we need to update the key
     if (existing_context) {
-        // If the new key is better (e.g., we now have IMSI), move context to new key
-        if (subscriber_key != existing_key) {
-            // Check if new key is "better" (IMSI > TMSI > MME > eNB)
-            bool new_key_better = false;
-            if (subscriber_key.find("imsi:") == 0 && existing_key.find("imsi:") != 0) {
-                new_key_better = true;
-            } else if (subscriber_key.find("tmsi:") == 0 && 
-                      existing_key.find("imsi:") != 0 && existing_key.find("tmsi:") != 0) {
-                new_key_better = true;
-            } else if (subscriber_key.find("mme_ue_s1ap_id:") == 0 && 
-                      existing_key.find("unknown_") == 0) {
-                new_key_better = true;
-            } else if (subscriber_key.find("enb_ue_s1ap_id:") == 0 && 
-                      existing_key.find("unknown_") == 0) {
-                new_key_better = true;
-            }
-            
-            if (new_key_better) {
-                // Move context to new key
-                existing_context->subscriber_key = subscriber_key;
-                contexts_[subscriber_key] = existing_context;
-                contexts_.erase(existing_key);
-                update_context_from_subscriber(existing_context, subscriber, message);
-                return subscriber_key;
-            } else {
-                // Keep existing key, but update the context
-                update_context_from_subscriber(existing_context, subscriber, message);
-                return existing_key;
-            }
-        } else {
-            // Same key, just update
-            update_context_from_subscriber(existing_context, subscriber, message);
-            return subscriber_key;
+        // Copy before updating; readers may hold the published context
+        existing_context = std::allocate_shared<UEContext>(
+            utils::PoolAllocator<UEContext>(context_pool_), *existing_context);
+        contexts_[existing_context->id] = existing_context;
+        if (kind < existing_context->key_kind) {
+            existing_context->key_kind = kind;
+            existing_context->subscriber_key = render_subscriber_key(*subscriber, kind);
         }
+        update_context_from_subscriber(existing_context, subscriber, message);
+        record_contexts_[subscriber] = existing_context->id;
+        return existing_context->id;
     }
     
     // No existing context found - create new one (unless it's a release complete)
     if (is_release_complete) {
         // For UEContextReleaseComplete, don't create new context if none exists
-        return "";
+        return 0;
     }
     
-    auto context = std::make_shared<UEContext>();
+    auto context = std::allocate_shared<UEContext>(utils::PoolAllocator<UEContext>(context_pool_));
+    context->id = next_context_id_++;
+    context->key_kind = kind;
+    context->subscriber_key = render_subscriber_key(*subscriber, kind);
     update_context_from_subscriber(context, subscriber, message);
-    context->subscriber_key = subscriber_key;
-    contexts_[subscriber_key] = context;
+    contexts_[context->id] = context;
+    record_contexts_[subscriber] = context->id;
     
-    return subscriber_key;
+    return context->id;
+}
+
+std::string Correlator::render_subscriber_key(const s1ap_correlator::SubscriberRecord& subscriber,
+                                              SubscriberKeyKind kind) {
+    switch (kind) {
+        case SubscriberKeyKind::IMSI:
+            return "imsi:" + subscriber.imsi.value();
+        case SubscriberKeyKind::TMSI:
+            return "tmsi:" + subscriber.tmsi.value();
+        case SubscriberKeyKind::S1AP_ID:
+            if (subscriber.mme_ue_s1ap_id.has_value()) {
+                return "mme_ue_s1ap_id:" + std::to_string(subscriber.mme_ue_s1ap_id.value());
+            }
+            return "enb_ue_s1ap_id:" + std::to_string(subscriber.enb_ue_s1ap_id.value());
+        default:
+            return "unknown_" + std::to_string(next_unknown_id_++);
+    }
 }
 
 void Correlator::update_context_from_subscriber(
@@ -456,9 +464,6 @@ void Correlator::update_context_from_subscriber(
         context->last_procedure = message.msg_type();
     }
     
-    context->last_seen = std::chrono::system_clock::now();
-    context->update_composite_keys();
-    
     // Handle UEContextReleaseComplete: remove S1AP IDs as the LAST step after all processing
     // This ensures all correlation and updates are complete before removing the IDs
     if (message.msg_type() == "UEContextReleaseComplete") {
@@ -481,26 +486,108 @@ void Correlator::update_context(const CanonicalMessage& message) {
     get_or_create_context(message);
 }
 
-std::shared_ptr<UEContext> Correlator::get_context(const std::string& subscriber_key) {
-    std::shared_lock<std::shared_mutex> lock(mutex_);
-    auto it = contexts_.find(subscriber_key);
-    if (it != contexts_.end()) {
+std::shared_ptr<const UEContext> Correlator::get_context(SubscriberId id) const {
+    ReadStripe& stripe = read_stripe(id);
+    std::shared_lock<std::shared_mutex> lock(stripe.mutex);
+    auto it = stripe.contexts.find(id);
+    if (it != stripe.contexts.end()) {
         return it->second;
     }
     return nullptr;
 }
 
-void Correlator::cleanup_expired() {
-    std::unique_lock<std::shared_mutex> lock(mutex_);
+std::shared_ptr<const UEContext> Correlator::get_context(const std::string& subscriber_key) const {
+    for (const ReadStripe& stripe : read_stripes_) {
+        std::shared_lock<std::shared_mutex> lock(stripe.mutex);
+        for (const auto& [id, context] : stripe.contexts) {
+            if (context->subscriber_key == subscriber_key) {
+                return context;
+            }
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const UEContext> Correlator::find_context(const UeLookup& lookup) const {
+    SubscriberId id = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        const s1ap_correlator::SubscriberRecord* subscriber = nullptr;
+        switch (lookup.kind) {
+            case UeLookup::Kind::IMSI:
+                subscriber = s1ap_correlator_->getSubscriberByImsi(lookup.identifier);
+                break;
+            case UeLookup::Kind::TMSI:
+                subscriber = s1ap_correlator_->getSubscriberByTmsi(lookup.identifier);
+                break;
+            case UeLookup::Kind::TEID:
+                subscriber = s1ap_correlator_->getSubscriberByTeid(lookup.value);
+                break;
+            case UeLookup::Kind::MME_UE_S1AP_ID:
+                subscriber = s1ap_correlator_->getSubscriberByMmeUeS1apId(lookup.value);
+                break;
+        }
+        auto it = subscriber ? record_contexts_.find(subscriber) : record_contexts_.end();
+        if (it == record_contexts_.end()) {
+            return nullptr;
+        }
+        id = it->second;
+    }
+    return get_context(id);
+}
+
+Correlator::CellPage Correlator::list_cell(const std::string& ecgi, SubscriberId after, size_t limit) const {
+    CellPage page;
+    if (limit == 0) {
+        return page;
+    }
     
-    auto it = contexts_.begin();
-    while (it != contexts_.end()) {
-        if (it->second->is_expired(config_.context_expiry)) {
-            it = contexts_.erase(it);
-        } else {
-            ++it;
+    // One ID past the page tells whether another page follows
+    std::vector<SubscriberId> ids;
+    {
+        std::shared_lock<std::shared_mutex> lock(cell_mutex_);
+        auto cell = cell_index_.find(ecgi);
+        if (cell == cell_index_.end()) {
+            return page;
+        }
+        for (auto it = cell->second.upper_bound(after); it != cell->second.end() && ids.size() <= limit; ++it) {
+            ids.push_back(*it);
+        }
+    }
+    if (ids.size() > limit) {
+        ids.resize(limit);
+        page.next_after = ids.back();
+    }
+    
+    // A context may have moved on since the index was read
+    page.contexts.reserve(ids.size());
+    for (SubscriberId id : ids) {
+        auto context = get_context(id);
+        if (context && context->ecgi == ecgi) {
+            page.contexts.push_back(std::move(context));
         }
     }
+    return page;
+}
+
+size_t Correlator::cell_ue_count(const std::string& ecgi) const {
+    std::shared_lock<std::shared_mutex> lock(cell_mutex_);
+    auto cell = cell_index_.find(ecgi);
+    return cell != cell_index_.end() ? cell->second.size() : 0;
+}
+
+void Correlator::cleanup_expired() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    
+    expiry_.expire(current_time_ns(), [this](SubscriberId id) {
+        contexts_.erase(id);
+        unpublish(id);
+    });
+}
+
+size_t Correlator::context_count() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return contexts_.size();
 }
 
 void Correlator::dump_ue_records(std::ostream& os) const {
@@ -510,8 +597,8 @@ void Correlator::dump_ue_records(std::ostream& os) const {
     os << "Total UE contexts: " << contexts_.size() << std::endl;
     os << std::endl;
     
-    for (const auto& [subscriber_key, context] : contexts_) {
-        os << "Subscriber Key: " << subscriber_key << std::endl;
+    for (const auto& [id, context] : contexts_) {
+        os << "Subscriber Key: " << context->subscriber_key << std::endl;
         
         if (context->imsi.has_value()) {
             os << "  IMSI: " << context->imsi.value() << std::endl;
@@ -547,20 +634,22 @@ void Correlator::dump_ue_records(std::ostream& os) const {
         }
         
         if (!context->ecgi.empty()) {
-            os << "  ECGI: " << bytes_to_hex_string(context->ecgi) << std::endl;
+            os << "  ECGI: " << utils::to_hex(context->ecgi) << std::endl;
         }
         if (!context->source_ecgi.empty()) {
-            os << "  Source ECGI: " << bytes_to_hex_string(context->source_ecgi) << std::endl;
+            os << "  Source ECGI: " << utils::to_hex(context->source_ecgi) << std::endl;
         }
         if (!context->target_ecgi.empty()) {
-            os << "  Target ECGI: " << bytes_to_hex_string(context->target_ecgi) << std::endl;
+            os << "  Target ECGI: " << utils::to_hex(context->target_ecgi) << std::endl;
         }
         
         if (!context->last_procedure.empty()) {
             os << "  Last Procedure: " << context->last_procedure << std::endl;
         }
         
-        auto now = std::chrono::system_clock::now();
+        auto now = std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::nanoseconds(current_time_ns())));
         auto age = std::chrono::duration_cast<std::chrono::seconds>(now - context->last_seen);
         os << "  Last Seen: " << age.count() << " seconds ago" << std::endl;
         
@@ -610,30 +699,31 @@ void Correlator::dump_ue_records(std::ostream& os) const {
             os << std::endl;
         }
         
-        if (subscriber.first_seen_timestamp.has_value()) {
+        if (subscriber.first_seen_timestamp > 0.0) {
             auto first_seen_time = std::chrono::system_clock::from_time_t(
-                static_cast<time_t>(subscriber.first_seen_timestamp.value()));
+                static_cast<time_t>(subscriber.first_seen_timestamp));
             auto first_seen_tp = std::chrono::time_point_cast<std::chrono::seconds>(first_seen_time);
             std::time_t first_seen_tt = std::chrono::system_clock::to_time_t(first_seen_tp);
             os << "  First Seen: " << std::put_time(std::localtime(&first_seen_tt), "%Y-%m-%d %H:%M:%S") << std::endl;
         }
-        if (subscriber.last_seen_timestamp.has_value()) {
+        if (subscriber.last_seen_timestamp > 0.0) {
             auto last_seen_time = std::chrono::system_clock::from_time_t(
-                static_cast<time_t>(subscriber.last_seen_timestamp.value()));
+                static_cast<time_t>(subscriber.last_seen_timestamp));
             auto last_seen_tp = std::chrono::time_point_cast<std::chrono::seconds>(last_seen_time);
             std::time_t last_seen_tt = std::chrono::system_clock::to_time_t(last_seen_tp);
             os << "  Last Seen: " << std::put_time(std::localtime(&last_seen_tt), "%Y-%m-%d %H:%M:%S") << std::endl;
         }
         
-        if (subscriber.gps_data_available) {
+        const auto* location = s1ap_correlator_->getLocation(subscriber_id);
+        if (location && location->gps_data_available) {
             os << "  GPS Data Available: true" << std::endl;
-            if (subscriber.gps_latitude.has_value() && subscriber.gps_longitude.has_value()) {
+            if (location->gps_latitude.has_value() && location->gps_longitude.has_value()) {
                 os << "  GPS Location: " << std::fixed << std::setprecision(6) 
-                   << subscriber.gps_latitude.value() << ", " 
-                   << subscriber.gps_longitude.value() << std::endl;
+                   << location->gps_latitude.value() << ", " 
+                   << location->gps_longitude.value() << std::endl;
             }
-            if (subscriber.gps_altitude.has_value()) {
-                os << "  GPS Altitude: " << subscriber.gps_altitude.value() << " m" << std::endl;
+            if (location->gps_altitude.has_value()) {
+                os << "  GPS Altitude: " << location->gps_altitude.value() << " m" << std::endl;
             }
         }
         
@@ -644,5 +734,194 @@ void Correlator::dump_ue_records(std::ostream& os) const {
     os << "\n=== End UE Records Dump ===" << std::endl;
 }
 
+void Correlator::dump_memory_usage(std::ostream& os) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    
+    auto usage = s1ap_correlator_->memoryUsage();
+    os << "\n=== Correlator Memory Usage ===" << std::endl;
+    os << "UE contexts: " << contexts_.size() << " (pool " << context_pool_->memory_bytes()
+       << " bytes, " << context_pool_->in_use() << " blocks in use)" << std::endl;
+    os << "Subscriber records: " << usage.subscribers << std::endl;
+    os << "  Records:          " << usage.record_bytes << " bytes" << std::endl;
+    os << "  Integer indexes:  " << usage.integer_index_bytes << " bytes" << std::endl;
+    os << "  String indexes:   " << usage.string_index_bytes << " bytes" << std::endl;
+    os << "  TEID sets:        " << usage.teid_set_bytes << " bytes" << std::endl;
+    os << "  Total:            " << usage.total() << " bytes";
+    if (usage.subscribers > 0) {
+        os << " (" << usage.total() / usage.subscribers << " bytes/subscriber)";
+    }
+    os << std::endl;
+    os << "=== End Correlator Memory Usage ===" << std::endl;
+}
+
+namespace {
+
+using snapshot::BlobRef;
+
+BlobRef save_optional(snapshot::SnapshotWriter& writer, uint32_t& flags, uint32_t bit,
+                      const std::optional<std::string>& value) {
+    if (!value.has_value()) {
+        return BlobRef{0, 0};
+    }
+    flags |= bit;
+    return writer.add_blob(value.value());
+}
+
+std::optional<std::string> load_optional(const snapshot::SnapshotReader& reader, uint32_t flags,
+                                         uint32_t bit, BlobRef ref) {
+    if (!(flags & bit)) {
+        return std::nullopt;
+    }
+    return std::string(reader.blob(ref));
+}
+
+int64_t to_ns(std::chrono::system_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point to_time_point(int64_t ns) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns)));
+}
+
+} // anonymous namespace
+
+void Correlator::save_snapshot(snapshot::SnapshotWriter& writer, uint32_t shard) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    
+    snapshot::CorrelatorStateEntry state{};
+    state.clock_ns = clock_ns_;
+    state.watermark_ns = watermark_ns_;
+    state.next_context_id = next_context_id_;
+    state.next_unknown_id = next_unknown_id_;
+    writer.add_record(snapshot::SectionKind::CORRELATOR_STATE, shard, state);
+    
+    for (const auto& [id, subscriber] : s1ap_correlator_->getAllSubscribers()) {
+        snapshot::SubscriberEntry entry{};
+        entry.imsi = save_optional(writer, entry.flags, snapshot::HAS_IMSI, subscriber.imsi.get());
+        entry.tmsi = save_optional(writer, entry.flags, snapshot::HAS_TMSI, subscriber.tmsi.get());
+        entry.imeisv = save_optional(writer, entry.flags, snapshot::HAS_IMEI, subscriber.imeisv.get());
+        if (subscriber.enb_ue_s1ap_id.has_value()) {
+            entry.flags |= snapshot::HAS_ENB_UE_S1AP_ID;
+            entry.enb_ue_s1ap_id = subscriber.enb_ue_s1ap_id.value();
+        }
+        if (subscriber.mme_ue_s1ap_id.has_value()) {
+            entry.flags |= snapshot::HAS_MME_UE_S1AP_ID;
+            entry.mme_ue_s1ap_id = subscriber.mme_ue_s1ap_id.value();
+        }
+        entry.teids = writer.add_blob(subscriber.teids.data(), subscriber.teids.size() * sizeof(uint32_t));
+        entry.first_seen_timestamp = subscriber.first_seen_timestamp;
+        entry.last_seen_timestamp = subscriber.last_seen_timestamp;
+        writer.add_record(snapshot::SectionKind::SUBSCRIBERS, shard, entry);
+    }
+    
+    for (const auto& [id, context] : contexts_) {
+        snapshot::ContextEntry entry{};
+        entry.id = id;
+        entry.key_kind = static_cast<uint32_t>(context->key_kind);
+        if (context->enb_ue_s1ap_id.has_value()) {
+            entry.flags |= snapshot::HAS_ENB_UE_S1AP_ID;
+            entry.enb_ue_s1ap_id = context->enb_ue_s1ap_id.value();
+        }
+        if (context->mme_ue_s1ap_id.has_value()) {
+            entry.flags |= snapshot::HAS_MME_UE_S1AP_ID;
+            entry.mme_ue_s1ap_id = context->mme_ue_s1ap_id.value();
+        }
+        if (context->handover_in_progress) {
+            entry.flags |= snapshot::HANDOVER_IN_PROGRESS;
+        }
+        entry.last_seen_ns = to_ns(context->last_seen);
+        entry.handover_start_ns = to_ns(context->handover_start_time);
+        entry.imsi = save_optional(writer, entry.flags, snapshot::HAS_IMSI, context->imsi);
+        entry.tmsi = save_optional(writer, entry.flags, snapshot::HAS_TMSI, context->tmsi);
+        entry.imei = save_optional(writer, entry.flags, snapshot::HAS_IMEI, context->imei);
+        entry.guti = save_optional(writer, entry.flags, snapshot::HAS_GUTI, context->guti);
+        entry.enb_id = save_optional(writer, entry.flags, snapshot::HAS_ENB_ID, context->enb_id);
+        entry.mme_id = save_optional(writer, entry.flags, snapshot::HAS_MME_ID, context->mme_id);
+        entry.mme_group_id = save_optional(writer, entry.flags, snapshot::HAS_MME_GROUP_ID, context->mme_group_id);
+        entry.mme_code = save_optional(writer, entry.flags, snapshot::HAS_MME_CODE, context->mme_code);
+        entry.ecgi = writer.add_blob(context->ecgi);
+        entry.target_ecgi = writer.add_blob(context->target_ecgi);
+        entry.source_ecgi = writer.add_blob(context->source_ecgi);
+        entry.last_procedure = writer.add_blob(context->last_procedure);
+        entry.subscriber_key = writer.add_blob(context->subscriber_key);
+        writer.add_record(snapshot::SectionKind::CONTEXTS, shard, entry);
+    }
+}
+
+void Correlator::load_snapshot(const snapshot::SnapshotReader& reader, uint32_t shard) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    
+    for (const auto& state : reader.records<snapshot::CorrelatorStateEntry>(
+             snapshot::SectionKind::CORRELATOR_STATE, shard)) {
+        clock_ns_ = std::max(clock_ns_, state.clock_ns);
+        watermark_ns_ = std::max(watermark_ns_, state.watermark_ns);
+        next_context_id_ = std::max<SubscriberId>(next_context_id_, state.next_context_id);
+        next_unknown_id_ = std::max<uint64_t>(next_unknown_id_, state.next_unknown_id);
+    }
+    
+    for (const auto& entry : reader.records<snapshot::SubscriberEntry>(snapshot::SectionKind::SUBSCRIBERS, shard)) {
+        s1ap_correlator::SubscriberRecord saved;
+        if (auto imsi = load_optional(reader, entry.flags, snapshot::HAS_IMSI, entry.imsi)) saved.imsi = *imsi;
+        if (auto tmsi = load_optional(reader, entry.flags, snapshot::HAS_TMSI, entry.tmsi)) saved.tmsi = *tmsi;
+        if (auto imeisv = load_optional(reader, entry.flags, snapshot::HAS_IMEI, entry.imeisv)) saved.imeisv = *imeisv;
+        if (entry.flags & snapshot::HAS_ENB_UE_S1AP_ID) saved.enb_ue_s1ap_id = entry.enb_ue_s1ap_id;
+        if (entry.flags & snapshot::HAS_MME_UE_S1AP_ID) saved.mme_ue_s1ap_id = entry.mme_ue_s1ap_id;
+        std::string_view teids = reader.blob(entry.teids);
+        for (size_t i = 0; i + sizeof(uint32_t) <= teids.size(); i += sizeof(uint32_t)) {
+            uint32_t teid;
+            std::memcpy(&teid, teids.data() + i, sizeof(teid));
+            saved.teids.push_back(teid);
+        }
+        saved.first_seen_timestamp = entry.first_seen_timestamp;
+        saved.last_seen_timestamp = entry.last_seen_timestamp;
+        s1ap_correlator_->restoreSubscriber(saved);
+    }
+    
+    int64_t expiry_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(config_.context_expiry).count();
+    for (const auto& entry : reader.records<snapshot::ContextEntry>(snapshot::SectionKind::CONTEXTS, shard)) {
+        auto context = std::allocate_shared<UEContext>(utils::PoolAllocator<UEContext>(context_pool_));
+        context->id = entry.id;
+        context->key_kind = static_cast<SubscriberKeyKind>(entry.key_kind);
+        if (entry.flags & snapshot::HAS_ENB_UE_S1AP_ID) context->enb_ue_s1ap_id = entry.enb_ue_s1ap_id;
+        if (entry.flags & snapshot::HAS_MME_UE_S1AP_ID) context->mme_ue_s1ap_id = entry.mme_ue_s1ap_id;
+        context->handover_in_progress = (entry.flags & snapshot::HANDOVER_IN_PROGRESS) != 0;
+        context->last_seen = to_time_point(entry.last_seen_ns);
+        context->handover_start_time = to_time_point(entry.handover_start_ns);
+        context->imsi = load_optional(reader, entry.flags, snapshot::HAS_IMSI, entry.imsi);
+        context->tmsi = load_optional(reader, entry.flags, snapshot::HAS_TMSI, entry.tmsi);
+        context->imei = load_optional(reader, entry.flags, snapshot::HAS_IMEI, entry.imei);
+        context->guti = load_optional(reader, entry.flags, snapshot::HAS_GUTI, entry.guti);
+        context->enb_id = load_optional(reader, entry.flags, snapshot::HAS_ENB_ID, entry.enb_id);
+        context->mme_id = load_optional(reader, entry.flags, snapshot::HAS_MME_ID, entry.mme_id);
+        context->mme_group_id = load_optional(reader, entry.flags, snapshot::HAS_MME_GROUP_ID, entry.mme_group_id);
+        context->mme_code = load_optional(reader, entry.flags, snapshot::HAS_MME_CODE, entry.mme_code);
+        context->ecgi = std::string(reader.blob(entry.ecgi));
+        context->target_ecgi = std::string(reader.blob(entry.target_ecgi));
+        context->source_ecgi = std::string(reader.blob(entry.source_ecgi));
+        context->last_procedure = std::string(reader.blob(entry.last_procedure));
+        context->subscriber_key = std::string(reader.blob(entry.subscriber_key));
+        
+        contexts_[context->id] = context;
+        next_context_id_ = std::max(next_context_id_, context->id + 1);
+        expiry_.schedule(context->id, entry.last_seen_ns + expiry_ns);
+        publish(context);
+        
+        // Re-link the context to its restored record by its identifiers
+        const s1ap_correlator::SubscriberRecord* subscriber = nullptr;
+        if (context->imsi) subscriber = s1ap_correlator_->getSubscriberByImsi(*context->imsi);
+        if (!subscriber && context->tmsi) subscriber = s1ap_correlator_->getSubscriberByTmsi(*context->tmsi);
+        if (!subscriber && context->mme_ue_s1ap_id) {
+            subscriber = s1ap_correlator_->getSubscriberByMmeUeS1apId(*context->mme_ue_s1ap_id);
+        }
+        if (!subscriber && context->enb_ue_s1ap_id) {
+            subscriber = s1ap_correlator_->getSubscriberByEnbUeS1apId(*context->enb_ue_s1ap_id);
+        }
+        if (subscriber) {
+            record_contexts_[subscriber] = context->id;
+        }
+    }
+}
+
 } // namespace correlate
 } // namespace s1see
@@ -11,26 +11,12 @@
  */
 
 #include "s1see/correlate/ue_context.h"
+#include "s1see/utils/codec.h"
 #include "canonical_message.pb.h"
-#include <sstream>
-#include <iomanip>
 
 namespace s1see {
 namespace correlate {
 
-// Helper function to convert bytes (std::string) to hex string
-static std::string bytes_to_hex_string(const std::string& bytes) {
-    if (bytes.empty()) {
-        return "";
-    }
-    std::ostringstream hex;
-    hex << std::hex << std::setfill('0');
-    for (unsigned char byte : bytes) {
-        hex << std::setw(2) << static_cast<int>(byte);
-    }
-    return hex.str();
-}
-
 void UEContext::update(const CanonicalMessage& msg) {
     // Update UE S1AP IDs
     // Note: Protobuf uses int32_t, but S1AP IDs are unsigned. Convert properly.
@@ -85,9 +71,6 @@ void UEContext::update(const CanonicalMessage& msg) {
     
     last_seen = std::chrono::system_clock::now();
     
-    // Update cached composite keys
-    update_composite_keys();
-    
     // Update handover state
     // HandoverRequired: Source eNodeB initiates handover
     if (msg.msg_type() == "HandoverRequired") {
@@ -118,8 +101,6 @@ void UEContext::update(const CanonicalMessage& msg) {
             }
         }
     }
-    
-    subscriber_key = generate_subscriber_key();
 }
 
 std::string UEContext::generate_subscriber_key() const {
@@ -134,7 +115,7 @@ std::string UEContext::generate_subscriber_key() const {
         return "guti:" + guti.value();
     }
     if (tmsi.has_value() && !ecgi.empty()) {
-        return "tmsi:" + tmsi.value() + "@" + bytes_to_hex_string(ecgi);
+        return "tmsi:" + tmsi.value() + "@" + utils::to_hex(ecgi);
     }
     // Use MME composite when available (even without IMSI)
     if (mme_id.has_value() && mme_ue_s1ap_id.has_value()) {
@@ -184,29 +165,6 @@ bool UEContext::is_expired(std::chrono::seconds max_inactivity) const {
     return elapsed > max_inactivity;
 }
 
-void UEContext::update_composite_keys() {
-    // Update MME composite key
-    if (mme_id.has_value() && mme_ue_s1ap_id.has_value()) {
-        mme_composite_key = mme_id.value() + ":" + std::to_string(mme_ue_s1ap_id.value());
-    } else {
-        mme_composite_key.clear();
-    }
-    
-    // Update eNB composite key
-    if (enb_id.has_value() && enb_ue_s1ap_id.has_value()) {
-        enb_composite_key = enb_id.value() + ":" + std::to_string(enb_ue_s1ap_id.value());
-    } else {
-        enb_composite_key.clear();
-    }
-    
-    // Update TMSI composite key
-    if (tmsi.has_value() && !ecgi.empty()) {
-        tmsi_composite_key = tmsi.value() + "@" + bytes_to_hex_string(ecgi);
-    } else {
-        tmsi_composite_key.clear();
-    }
-}
-
 } // namespace correlate
 } // namespace s1see
 
@@ -11,61 +11,36 @@
  */
 
 #include "s1see/decode/s1ap_decoder_wrapper.h"
+#include "s1see/utils/codec.h"
 #include "s1ap_parser.h"
 #include <sstream>
-#include <iomanip>
 #include <google/protobuf/util/json_util.h>
 #include <cctype>
 
 namespace s1see {
 namespace decode {
 
-// Helper function to convert hex string to bytes
-static std::vector<uint8_t> hex_string_to_bytes(const std::string& hex_str) {
-    std::vector<uint8_t> bytes;
-    std::string clean_hex = hex_str;
-    
-    // Remove whitespace and common separators
-    clean_hex.erase(std::remove_if(clean_hex.begin(), clean_hex.end(),
-        [](char c) { return std::isspace(c) || c == ':' || c == '-'; }), clean_hex.end());
-    
-    // Convert pairs of hex digits to bytes
-    for (size_t i = 0; i < clean_hex.length(); i += 2) {
-        if (i + 1 < clean_hex.length()) {
-            std::string byte_str = clean_hex.substr(i, 2);
-            try {
-                uint8_t byte = static_cast<uint8_t>(std::stoul(byte_str, nullptr, 16));
-                bytes.push_back(byte);
-            } catch (...) {
-                // Skip invalid hex pairs
-            }
-        }
-    }
-    
-    return bytes;
-}
-
-// Helper function to parse EUTRAN-CGI components from bytes
+// Helper function to split EUTRAN-CGI into its components (views, no copy)
 // EUTRAN-CGI ::= SEQUENCE { pLMNidentity PLMNidentity, cell-ID CellIdentity }
 // pLMNidentity is 3 bytes (TBCD-STRING)
 // cell-ID is 28 bits (BIT STRING) typically encoded as 4 bytes
-static void parse_eutran_cgi(const std::vector<uint8_t>& ecgi_bytes,
-                             std::vector<uint8_t>& plmn_identity,
-                             std::vector<uint8_t>& cell_id) {
-    plmn_identity.clear();
-    cell_id.clear();
+static void parse_eutran_cgi(std::span<const uint8_t> ecgi_bytes,
+                             std::span<const uint8_t>& plmn_identity,
+                             std::span<const uint8_t>& cell_id) {
+    plmn_identity = {};
+    cell_id = {};
     
     if (ecgi_bytes.size() >= 3) {
         // Extract PLMNidentity (first 3 bytes)
-        plmn_identity.assign(ecgi_bytes.begin(), ecgi_bytes.begin() + 3);
+        plmn_identity = ecgi_bytes.first(3);
     }
     
     if (ecgi_bytes.size() >= 7) {
         // Extract cell-ID (next 4 bytes, 28 bits)
-        cell_id.assign(ecgi_bytes.begin() + 3, ecgi_bytes.begin() + 7);
+        cell_id = ecgi_bytes.subspan(3, 4);
     } else if (ecgi_bytes.size() > 3) {
         // Cell-ID might be shorter, take remaining bytes
-        cell_id.assign(ecgi_bytes.begin() + 3, ecgi_bytes.end());
+        cell_id = ecgi_bytes.subspan(3);
     }
 }
 
@@ -472,15 +447,53 @@ static std::string map_procedure_to_msg_type(uint8_t procedure_code,
     return procedure_name.empty() ? "Unknown" : procedure_name;
 }
 
-bool StubS1APDecoder::decode(const std::vector<uint8_t>& raw_bytes,
+std::string build_decoded_tree_json(const s1ap_parser::S1apParseResult& parse_result) {
+    // Appended in place; sized for the IE values' hex up front
+    size_t size = 96 + parse_result.procedure_name.size();
+    for (const auto& ie : parse_result.ies) {
+        size += 40 + 2 * ie.length;
+    }
+    std::string json;
+    json.reserve(size);
+    json += "{\"procedure_code\":";
+    json += std::to_string(parse_result.procedure_code);
+    json += ",\"procedure_name\":\"";
+    json += parse_result.procedure_name;
+    json += "\",\"pdu_type\":";
+    json += std::to_string(static_cast<int>(parse_result.pdu_type));
+    json += ",\"information_elements\":{";
+    bool first = true;
+    for (const auto& ie : parse_result.ies) {
+        if (!first) json += ',';
+        json += '"';
+        std::string_view name = s1ap_parser::getIeNameFromId(ie.id);
+        if (name.empty()) {
+            json += "IE_";
+            json += std::to_string(ie.id);
+        } else {
+            json += name;
+        }
+        json += "\":\"";
+        json += s1ap_parser::ieValueHex(parse_result.ieValue(ie));
+        json += '"';
+        first = false;
+    }
+    json += "}}";
+    return json;
+}
+
+bool StubS1APDecoder::decode(std::span<const uint8_t> raw_bytes,
                             CanonicalMessage& canonical_message,
-                            DecodedTree& decoded_tree) {
+                            DecodedTree& decoded_tree,
+                            const Options& options) {
     // Stub implementation for prototype
     // In production, this would call the actual S1AP parser
     
     if (raw_bytes.empty()) {
         canonical_message.set_decode_failed(true);
-        canonical_message.set_raw_bytes(raw_bytes.data(), raw_bytes.size());
+        if (options.embed_raw_bytes) {
+            canonical_message.set_raw_bytes(raw_bytes.data(), raw_bytes.size());
+        }
         return false;
     }
     
@@ -488,20 +501,18 @@ bool StubS1APDecoder::decode(const std::vector<uint8_t>& raw_bytes,
     // Check if it looks like a HandoverRequest (procedure code 0)
     // This is a simplified stub - replace with real parser
     
-    // Generate a JSON-like decoded tree
-    std::ostringstream json;
-    json << "{";
-    json << "\"procedure_code\":" << static_cast<int>(raw_bytes[0] % 256) << ",";
-    json << "\"length\":" << raw_bytes.size() << ",";
-    json << "\"raw_hex\":\"";
-    for (size_t i = 0; i < std::min(raw_bytes.size(), size_t(16)); ++i) {
-        json << std::hex << std::setw(2) << std::setfill('0') 
-             << static_cast<int>(raw_bytes[i]);
+    // Generate a JSON-like decoded tree (the stub has no IE table)
+    if (options.level >= DecodeLevel::FULL_TREE) {
+        std::ostringstream json;
+        json << "{";
+        json << "\"procedure_code\":" << static_cast<int>(raw_bytes[0] % 256) << ",";
+        json << "\"length\":" << raw_bytes.size() << ",";
+        json << "\"raw_hex\":\""
+             << utils::to_hex(raw_bytes.first(std::min(raw_bytes.size(), size_t(16)))) << "\"";
+        json << "}";
+        
+        decoded_tree.json_representation = json.str();
     }
-    json << "\"";
-    json << "}";
-    
-    decoded_tree.json_representation = json.str();
     
     // Try to extract some fields (stub logic)
     if (raw_bytes.size() > 0) {
@@ -528,51 +539,54 @@ bool StubS1APDecoder::decode(const std::vector<uint8_t>& raw_bytes,
         }
         
         // Preserve raw bytes
-        canonical_message.set_raw_bytes(raw_bytes.data(), raw_bytes.size());
-        canonical_message.set_decoded_tree(decoded_tree.json_representation);
+        if (options.embed_raw_bytes) {
+            canonical_message.set_raw_bytes(raw_bytes.data(), raw_bytes.size());
+        }
+        if (options.level >= DecodeLevel::FULL_TREE) {
+            canonical_message.set_decoded_tree(decoded_tree.json_representation);
+        }
         canonical_message.set_decode_failed(false);
         
         return true;
     }
     
     canonical_message.set_decode_failed(true);
-    canonical_message.set_raw_bytes(raw_bytes.data(), raw_bytes.size());
+    if (options.embed_raw_bytes) {
+        canonical_message.set_raw_bytes(raw_bytes.data(), raw_bytes.size());
+    }
     return false;
 }
 
-bool RealS1APDecoder::decode(const std::vector<uint8_t>& raw_bytes,
+bool RealS1APDecoder::decode(std::span<const uint8_t> raw_bytes,
                              CanonicalMessage& canonical_message,
-                             DecodedTree& decoded_tree) {
+                             DecodedTree& decoded_tree,
+                             const Options& options) {
     if (raw_bytes.empty()) {
         canonical_message.set_decode_failed(true);
-        canonical_message.set_raw_bytes(raw_bytes.data(), raw_bytes.size());
+        if (options.embed_raw_bytes) {
+            canonical_message.set_raw_bytes(raw_bytes.data(), raw_bytes.size());
+        }
         return false;
     }
     
-    // Try to extract S1AP from SCTP packet first
-    std::vector<uint8_t> s1ap_bytes;
-    auto s1ap_opt = s1ap_parser::extractS1apFromSctp(raw_bytes.data(), raw_bytes.size());
-    if (s1ap_opt.has_value()) {
-        s1ap_bytes = s1ap_opt.value();
-    } else {
+    // Try to extract S1AP from SCTP packet first (a view, not a copy)
+    std::span<const uint8_t> s1ap_bytes = s1ap_parser::findS1apInSctp(raw_bytes);
+    if (s1ap_bytes.empty()) {
         // Assume raw bytes are already S1AP PDU
         s1ap_bytes = raw_bytes;
     }
     
-    // Parse S1AP PDU
-    auto parse_result = s1ap_parser::parseS1apPdu(s1ap_bytes.data(), s1ap_bytes.size());
+    // Parse S1AP PDU in place
+    auto parse_result = s1ap_parser::parseS1apPdu(s1ap_bytes);
     
     if (!parse_result.decoded) {
         canonical_message.set_decode_failed(true);
-        canonical_message.set_raw_bytes(raw_bytes.data(), raw_bytes.size());
+        if (options.embed_raw_bytes) {
+            canonical_message.set_raw_bytes(raw_bytes.data(), raw_bytes.size());
+        }
         return false;
     }
 
-    // Debug
-    // for (const auto& [key, value] : parse_result.information_elements) {
-    //     std::cout << key << " " << value << std::endl;
-    // }
-    
     // Set procedure code and message type
     canonical_message.set_procedure_code(parse_result.procedure_code);
     // Map procedure code + PDU type to canonical message type name
@@ -583,32 +597,15 @@ bool RealS1APDecoder::decode(const std::vector<uint8_t>& raw_bytes,
     );
     canonical_message.set_msg_type(msg_type);
     
-    // Extract S1AP IDs from information_elements map
-    // Values are hex strings that need to be converted to decimal integers
+    // Extract S1AP IDs straight from the typed IE table
     // According to ASN.1: MME-UE-S1AP-ID ::= INTEGER (0..4294967295)
     //                    ENB-UE-S1AP-ID ::= INTEGER (0..16777215)
-    if (parse_result.information_elements.find("MME-UE-S1AP-ID") != parse_result.information_elements.end()) {
-        const std::string& hex_value = parse_result.information_elements.at("MME-UE-S1AP-ID");
-        try {
-            // Convert hex string to decimal integer (0..4294967295)
-            uint32_t id = static_cast<uint32_t>(std::stoul(hex_value, nullptr, 16));
-            // Store as int32_t (protobuf field type), values fit within range
-            canonical_message.set_mme_ue_s1ap_id(static_cast<int32_t>(id));
-        } catch (...) {
-            // Ignore conversion errors
-        }
+    // Stored as int32_t (protobuf field type), values fit within range
+    if (auto id = parse_result.mmeUeS1apId()) {
+        canonical_message.set_mme_ue_s1ap_id(static_cast<int32_t>(*id));
     }
-    
-    if (parse_result.information_elements.find("eNB-UE-S1AP-ID") != parse_result.information_elements.end()) {
-        const std::string& hex_value = parse_result.information_elements.at("eNB-UE-S1AP-ID");
-        try {
-            // Convert hex string to decimal integer (0..16777215)
-            uint32_t id = static_cast<uint32_t>(std::stoul(hex_value, nullptr, 16));
-            // Store as int32_t (protobuf field type), values fit within range
-            canonical_message.set_enb_ue_s1ap_id(static_cast<int32_t>(id));
-        } catch (...) {
-            // Ignore conversion errors
-        }
+    if (auto id = parse_result.enbUeS1apId()) {
+        canonical_message.set_enb_ue_s1ap_id(static_cast<int32_t>(*id));
     }
     
     // Extract IMSI
@@ -635,40 +632,36 @@ bool RealS1APDecoder::decode(const std::vector<uint8_t>& raw_bytes,
     //                          pLMNidentity    PLMNidentity,  -- 3 bytes (TBCD-STRING)
     //                          cell-ID         CellIdentity   -- 28 bits (BIT STRING SIZE(28))
     //                      }
-    // Value is hex string that needs to be converted to bytes
-    if (parse_result.information_elements.find("EUTRAN-CGI") != parse_result.information_elements.end()) {
-        const std::string& hex_value = parse_result.information_elements.at("EUTRAN-CGI");
-        std::vector<uint8_t> ecgi_bytes = hex_string_to_bytes(hex_value);
+    std::span<const uint8_t> ecgi_bytes = parse_result.eutranCgi();
+    if (!ecgi_bytes.empty()) {
+        // Store raw bytes
+        canonical_message.set_ecgi(ecgi_bytes.data(), ecgi_bytes.size());
         
-        if (!ecgi_bytes.empty()) {
-            // Store raw bytes
-            canonical_message.set_ecgi(ecgi_bytes.data(), ecgi_bytes.size());
-            
-            // Parse and store components
-            std::vector<uint8_t> plmn_identity, cell_id;
-            parse_eutran_cgi(ecgi_bytes, plmn_identity, cell_id);
-            
-            if (!plmn_identity.empty()) {
-                canonical_message.set_ecgi_plmn_identity(plmn_identity.data(), plmn_identity.size());
-            }
-            if (!cell_id.empty()) {
-                canonical_message.set_ecgi_cell_id(cell_id.data(), cell_id.size());
-            }
+        // Parse and store components
+        std::span<const uint8_t> plmn_identity, cell_id;
+        parse_eutran_cgi(ecgi_bytes, plmn_identity, cell_id);
+        
+        if (!plmn_identity.empty()) {
+            canonical_message.set_ecgi_plmn_identity(plmn_identity.data(), plmn_identity.size());
+        }
+        if (!cell_id.empty()) {
+            canonical_message.set_ecgi_cell_id(cell_id.data(), cell_id.size());
         }
     }
     
     // Extract target ECGI if present (for handover messages)
     // This might be in a different IE or in the transparent container
-    for (const auto& [key, value] : parse_result.information_elements) {
+    for (const auto& ie : parse_result.ies) {
+        std::string_view key = s1ap_parser::getIeNameFromId(ie.id);
         if (key.find("target") != std::string::npos || key.find("Target") != std::string::npos) {
             if (key.find("CGI") != std::string::npos || key.find("cgi") != std::string::npos) {
-                std::vector<uint8_t> target_ecgi_bytes = hex_string_to_bytes(value);
+                std::span<const uint8_t> target_ecgi_bytes = parse_result.ieValue(ie);
                 if (!target_ecgi_bytes.empty()) {
                     // Store raw bytes
                     canonical_message.set_target_ecgi(target_ecgi_bytes.data(), target_ecgi_bytes.size());
                     
                     // Parse and store components
-                    std::vector<uint8_t> plmn_identity, cell_id;
+                    std::span<const uint8_t> plmn_identity, cell_id;
                     parse_eutran_cgi(target_ecgi_bytes, plmn_identity, cell_id);
                     
                     if (!plmn_identity.empty()) {
@@ -683,29 +676,27 @@ bool RealS1APDecoder::decode(const std::vector<uint8_t>& raw_bytes,
         }
     }
     
-    // Extract information elements and build decoded tree JSON
-    std::ostringstream json;
-    json << "{";
-    json << "\"procedure_code\":" << static_cast<int>(parse_result.procedure_code) << ",";
-    json << "\"procedure_name\":\"" << parse_result.procedure_name << "\",";
-    json << "\"pdu_type\":" << static_cast<int>(parse_result.pdu_type) << ",";
-    json << "\"information_elements\":{";
-    bool first = true;
-    for (const auto& [key, value] : parse_result.information_elements) {
-        if (!first) json << ",";
-        json << "\"" << key << "\":\"" << value << "\"";
-        first = false;
+    // IE values and tree JSON only on request; the native result travels instead
+    if (options.level >= DecodeLevel::IE_TABLE) {
+        auto* ies = canonical_message.mutable_information_elements();
+        ies->Reserve(static_cast<int>(parse_result.ies.size()));
+        for (const auto& ie : parse_result.ies) {
+            auto value = parse_result.ieValue(ie);
+            auto* element = ies->Add();
+            element->set_id(ie.id);
+            element->set_value(value.data(), value.size());
+        }
     }
-    json << "}";
-    json << "}";
-
-    // std::cout << json.str() << std::endl;
-    
-    decoded_tree.json_representation = json.str();
-    canonical_message.set_decoded_tree(decoded_tree.json_representation);
+    if (options.level >= DecodeLevel::FULL_TREE) {
+        decoded_tree.json_representation = build_decoded_tree_json(parse_result);
+        canonical_message.set_decoded_tree(decoded_tree.json_representation);
+    }
+    decoded_tree.parse_result = std::move(parse_result);
     
     // Preserve raw bytes
-    canonical_message.set_raw_bytes(raw_bytes.data(), raw_bytes.size());
+    if (options.embed_raw_bytes) {
+        canonical_message.set_raw_bytes(raw_bytes.data(), raw_bytes.size());
+    }
     canonical_message.set_decode_failed(false);
     
     return true;
@@ -1,30 +1,226 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: amqp_adapter.cc
+ * Description: Implementation of AMQPIngestAdapter on rabbitmq-c. A consumer
+ *              thread collects up to prefetch deliveries, spools them and
+ *              acknowledges the batch with one multiple-ack.
+ */
+
 #include "s1see/ingest/amqp_adapter.h"
+#include <algorithm>
 #include <iostream>
+#include <vector>
+#ifdef HAVE_RABBITMQ
+#if __has_include(<rabbitmq-c/amqp.h>)
+#include <rabbitmq-c/amqp.h>
+#include <rabbitmq-c/tcp_socket.h>
+#else
+#include <amqp.h>
+#include <amqp_tcp_socket.h>
+#endif
+#endif
 
 namespace s1see {
 namespace ingest {
 
-AMQPIngestAdapter::AMQPIngestAdapter(const std::string& connection_string, const std::string& queue)
-    : connection_string_(connection_string), queue_(queue) {
+AMQPIngestAdapter::AMQPIngestAdapter(const std::string& connection_string, const std::string& queue) {
+    config_.connection_string = connection_string;
+    config_.queue = queue;
+}
+
+AMQPIngestAdapter::AMQPIngestAdapter(const Config& config)
+    : config_(config) {
 }
 
 AMQPIngestAdapter::~AMQPIngestAdapter() {
     stop();
 }
 
+#ifdef HAVE_RABBITMQ
+
+namespace {
+    constexpr amqp_channel_t CHANNEL = 1;
+
+    bool rpc_ok(amqp_rpc_reply_t reply, const char* what) {
+        if (reply.reply_type == AMQP_RESPONSE_NORMAL) {
+            return true;
+        }
+        std::cerr << "AMQPIngestAdapter: " << what << " failed";
+        if (reply.reply_type == AMQP_RESPONSE_LIBRARY_EXCEPTION) {
+            std::cerr << ": " << amqp_error_string2(reply.library_error);
+        }
+        std::cerr << std::endl;
+        return false;
+    }
+
+    timeval to_timeval(std::chrono::milliseconds timeout) {
+        timeval tv;
+        tv.tv_sec = static_cast<long>(timeout.count() / 1000);
+        tv.tv_usec = static_cast<long>((timeout.count() % 1000) * 1000);
+        return tv;
+    }
+} // anonymous namespace
+
 bool AMQPIngestAdapter::start() {
-    // TODO: Initialize AMQP connection
-    std::cerr << "AMQPIngestAdapter: Stub implementation - integrate RabbitMQ-C or similar for production" << std::endl;
-    return false;
+    if (!spool_) {
+        std::cerr << "AMQPIngestAdapter: spool not set" << std::endl;
+        return false;
+    }
+    if (running_.exchange(true)) {
+        return false; // Already running
+    }
+    
+    // amqp_parse_url points into (and so needs) a mutable copy of the URL
+    std::vector<char> url(config_.connection_string.begin(), config_.connection_string.end());
+    url.push_back('\0');
+    amqp_connection_info info;
+    amqp_default_connection_info(&info);
+    if (!config_.connection_string.empty() && amqp_parse_url(url.data(), &info) != AMQP_STATUS_OK) {
+        std::cerr << "AMQPIngestAdapter: invalid connection string: " << config_.connection_string << std::endl;
+        running_ = false;
+        return false;
+    }
+    
+    amqp_connection_state_t conn = amqp_new_connection();
+    amqp_socket_t* socket = amqp_tcp_socket_new(conn);
+    bool ok = socket && amqp_socket_open(socket, info.host, info.port) == AMQP_STATUS_OK;
+    if (!ok) {
+        std::cerr << "AMQPIngestAdapter: failed to connect to " << info.host << ":" << info.port << std::endl;
+    }
+    ok = ok && rpc_ok(amqp_login(conn, info.vhost, 0, 131072, 0, AMQP_SASL_METHOD_PLAIN,
+                                 info.user, info.password), "login");
+    if (ok) {
+        amqp_channel_open(conn, CHANNEL);
+        ok = rpc_ok(amqp_get_rpc_reply(conn), "channel.open");
+    }
+    if (ok) {
+        // Bound unacknowledged deliveries to one batch
+        amqp_basic_qos(conn, CHANNEL, 0, config_.prefetch, 0);
+        ok = rpc_ok(amqp_get_rpc_reply(conn), "basic.qos");
+    }
+    if (ok) {
+        amqp_basic_consume(conn, CHANNEL, amqp_cstring_bytes(config_.queue.c_str()), amqp_empty_bytes,
+                           0 /* no_local */, 0 /* no_ack */, 0 /* exclusive */, amqp_empty_table);
+        ok = rpc_ok(amqp_get_rpc_reply(conn), "basic.consume");
+    }
+    if (!ok) {
+        amqp_destroy_connection(conn);
+        running_ = false;
+        return false;
+    }
+    
+    connection_ = conn;
+    consumer_thread_ = std::thread(&AMQPIngestAdapter::consume_loop, this);
+    return true;
+}
+
+void AMQPIngestAdapter::consume_loop() {
+    auto conn = static_cast<amqp_connection_state_t>(connection_);
+    size_t batch_size = std::max<size_t>(config_.prefetch, 1);
+    std::vector<IngestRecord> records;
+    records.reserve(batch_size);
+    
+    while (running_) {
+        // Collect a batch: wait up to poll_timeout for the first delivery,
+        // then batch_linger for each further one
+        records.clear();
+        uint64_t last_tag = 0;
+        while (running_ && records.size() < batch_size) {
+            amqp_maybe_release_buffers(conn);
+            amqp_envelope_t envelope;
+            timeval tv = to_timeval(records.empty() ? config_.poll_timeout : config_.batch_linger);
+            amqp_rpc_reply_t reply = amqp_consume_message(conn, &envelope, &tv, 0);
+            if (reply.reply_type != AMQP_RESPONSE_NORMAL) {
+                if (!(reply.reply_type == AMQP_RESPONSE_LIBRARY_EXCEPTION &&
+                      reply.library_error == AMQP_STATUS_TIMEOUT)) {
+                    rpc_ok(reply, "consume");
+                    std::this_thread::sleep_for(config_.poll_timeout);
+                }
+                break;
+            }
+            
+            int64_t ts_capture = 0;
+            if (envelope.message.properties._flags & AMQP_BASIC_TIMESTAMP_FLAG) {
+                ts_capture = static_cast<int64_t>(envelope.message.properties.timestamp) * 1000000000LL;
+            }
+            std::string routing_key(static_cast<const char*>(envelope.routing_key.bytes), envelope.routing_key.len);
+            IngestRecord record;
+            record.message = payload_to_message(
+                envelope.message.body.bytes, envelope.message.body.len,
+                "amqp:" + config_.queue, static_cast<int64_t>(envelope.delivery_tag), ts_capture);
+            if (record.message.transport_case() == SignalMessage::TRANSPORT_NOT_SET) {
+                auto* amqp = record.message.mutable_amqp();
+                amqp->set_queue(config_.queue);
+                amqp->set_routing_key(std::move(routing_key));
+                amqp->set_delivery_tag(envelope.delivery_tag);
+            }
+            record.ack_token = static_cast<int64_t>(envelope.delivery_tag);
+            last_tag = envelope.delivery_tag;
+            records.push_back(std::move(record));
+            amqp_destroy_envelope(&envelope);
+        }
+        if (records.empty()) {
+            continue;
+        }
+        
+        // Delivery tags increase on a channel, so one multiple-ack of the
+        // last tag covers the batch when every group is durable
+        std::vector<std::pair<uint64_t, bool>> outcomes;
+        bool all_durable = true;
+        messages_ingested_ += spool_batch_and_ack(records, [&](std::span<const IngestRecord> group, bool durable) {
+            all_durable = all_durable && durable;
+            for (const auto& record : group) {
+                outcomes.emplace_back(static_cast<uint64_t>(record.ack_token), durable);
+            }
+        });
+        if (all_durable) {
+            amqp_basic_ack(conn, CHANNEL, last_tag, 1);
+        } else {
+            for (const auto& [tag, durable] : outcomes) {
+                if (durable) {
+                    amqp_basic_ack(conn, CHANNEL, tag, 0);
+                } else {
+                    amqp_basic_nack(conn, CHANNEL, tag, 0, 1 /* requeue */);
+                }
+            }
+        }
+    }
 }
 
 void AMQPIngestAdapter::stop() {
-    // TODO: Cleanup AMQP connection
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (consumer_thread_.joinable()) {
+        consumer_thread_.join();
+    }
+    auto conn = static_cast<amqp_connection_state_t>(connection_);
+    if (conn) {
+        amqp_channel_close(conn, CHANNEL, AMQP_REPLY_SUCCESS);
+        amqp_connection_close(conn, AMQP_REPLY_SUCCESS);
+        amqp_destroy_connection(conn);
+        connection_ = nullptr;
+    }
 }
 
-} // namespace ingest
-} // namespace s1see
+#else // !HAVE_RABBITMQ
+
+bool AMQPIngestAdapter::start() {
+    std::cerr << "AMQPIngestAdapter: built without rabbitmq-c (install librabbitmq-dev and reconfigure)" << std::endl;
+    return false;
+}
 
+void AMQPIngestAdapter::consume_loop() {
+}
 
+void AMQPIngestAdapter::stop() {
+    running_ = false;
+}
 
+#endif // HAVE_RABBITMQ
 
+} // namespace ingest
+} // namespace s1see
@@ -0,0 +1,288 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: capture_adapter.cc
+ * Description: Implementation of CaptureIngestAdapter. Sets up one TPACKET_V3
+ *              ring per capture thread in a shared fanout group, walks retired
+ *              ring blocks in place and appends reassembled S1AP messages to
+ *              the spool in batches.
+ */
+
+#include "s1see/ingest/capture_adapter.h"
+#include "s1see/ingest/sctp_reassembler.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace s1see {
+namespace ingest {
+
+struct CaptureIngestAdapter::Ring {
+    int fd = -1;
+    uint8_t* map = nullptr;
+    size_t map_size = 0;
+    std::atomic<uint64_t> packets{0};
+    std::atomic<uint64_t> s1ap_pdus{0};
+    std::atomic<uint64_t> kernel_drops{0};
+    std::atomic<uint64_t> reassembly_drops{0};
+
+    ~Ring() {
+#if defined(__linux__)
+        if (map) munmap(map, map_size);
+        if (fd >= 0) ::close(fd);
+#endif
+    }
+};
+
+CaptureIngestAdapter::CaptureIngestAdapter(const Config& config)
+    : config_(config) {
+}
+
+CaptureIngestAdapter::~CaptureIngestAdapter() {
+    stop();
+}
+
+CaptureIngestAdapter::Stats CaptureIngestAdapter::stats() const {
+    Stats stats;
+    for (const auto& ring : rings_) {
+        stats.packets += ring->packets.load(std::memory_order_relaxed);
+        stats.s1ap_pdus += ring->s1ap_pdus.load(std::memory_order_relaxed);
+        stats.kernel_drops += ring->kernel_drops.load(std::memory_order_relaxed);
+        stats.reassembly_drops += ring->reassembly_drops.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+#if defined(__linux__)
+
+bool CaptureIngestAdapter::start() {
+    if (!spool_) {
+        std::cerr << "CaptureIngestAdapter: spool not set" << std::endl;
+        return false;
+    }
+    unsigned ifindex = if_nametoindex(config_.interface.c_str());
+    if (ifindex == 0) {
+        std::cerr << "CaptureIngestAdapter: unknown interface " << config_.interface << std::endl;
+        return false;
+    }
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (config_.block_size == 0 || config_.block_size % page_size != 0 ||
+        config_.frame_size < TPACKET_ALIGNMENT || config_.block_size % config_.frame_size != 0 ||
+        config_.block_count == 0) {
+        std::cerr << "CaptureIngestAdapter: block_size must be a multiple of the page size and of frame_size"
+                  << std::endl;
+        return false;
+    }
+    if (running_.exchange(true)) {
+        return false; // Already running
+    }
+
+    size_t num_threads = config_.num_threads > 0
+        ? config_.num_threads
+        : std::max<size_t>(1, std::thread::hardware_concurrency());
+    uint16_t fanout_group = config_.fanout_group != 0 ? config_.fanout_group
+                                                      : static_cast<uint16_t>(getpid() & 0xFFFF);
+
+    rings_.clear();
+    for (size_t i = 0; i < num_threads; ++i) {
+        auto ring = std::make_unique<Ring>();
+        auto fail = [&](const char* what) {
+            std::cerr << "CaptureIngestAdapter: " << what << " on " << config_.interface << ": "
+                      << std::strerror(errno) << std::endl;
+            rings_.clear();
+            running_ = false;
+            return false;
+        };
+
+        ring->fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+        if (ring->fd < 0) return fail("socket(AF_PACKET)");
+
+        int version = TPACKET_V3;
+        if (setsockopt(ring->fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) != 0) {
+            return fail("PACKET_VERSION");
+        }
+
+        tpacket_req3 req;
+        std::memset(&req, 0, sizeof(req));
+        req.tp_block_size = config_.block_size;
+        req.tp_block_nr = config_.block_count;
+        req.tp_frame_size = config_.frame_size;
+        req.tp_frame_nr = (config_.block_size / config_.frame_size) * config_.block_count;
+        req.tp_retire_blk_tov = static_cast<unsigned>(config_.block_timeout.count());
+        if (setsockopt(ring->fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) != 0) {
+            return fail("PACKET_RX_RING");
+        }
+
+        ring->map_size = static_cast<size_t>(config_.block_size) * config_.block_count;
+        void* map = mmap(nullptr, ring->map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED | MAP_POPULATE,
+                         ring->fd, 0);
+        if (map == MAP_FAILED) {
+            // MAP_LOCKED needs RLIMIT_MEMLOCK headroom; fall back to pageable
+            map = mmap(nullptr, ring->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, 0);
+        }
+        if (map == MAP_FAILED) return fail("mmap of RX ring");
+        ring->map = static_cast<uint8_t*>(map);
+
+        sockaddr_ll addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sll_family = AF_PACKET;
+        addr.sll_protocol = htons(ETH_P_ALL);
+        addr.sll_ifindex = static_cast<int>(ifindex);
+        if (bind(ring->fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            return fail("bind");
+        }
+
+        // Hash fanout keeps a flow on one socket; DEFRAG reassembles IP
+        // fragments first so they hash with their flow
+        int fanout = fanout_group | ((PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG) << 16);
+        if (setsockopt(ring->fd, SOL_PACKET, PACKET_FANOUT, &fanout, sizeof(fanout)) != 0) {
+            return fail("PACKET_FANOUT");
+        }
+        rings_.push_back(std::move(ring));
+    }
+
+    for (size_t i = 0; i < rings_.size(); ++i) {
+        threads_.emplace_back(&CaptureIngestAdapter::capture_loop, this, i);
+        if (config_.pin_threads) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(i % CPU_SETSIZE, &cpus);
+            pthread_setaffinity_np(threads_.back().native_handle(), sizeof(cpus), &cpus);
+        }
+    }
+    std::cerr << "CaptureIngestAdapter: capturing on " << config_.interface << " with "
+              << rings_.size() << " fanout sockets" << std::endl;
+    return true;
+}
+
+void CaptureIngestAdapter::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    for (auto& thread : threads_) {
+        if (thread.joinable()) thread.join();
+    }
+    threads_.clear();
+}
+
+void CaptureIngestAdapter::capture_loop(size_t index) {
+    Ring& ring = *rings_[index];
+    SctpReassembler reassembler;
+    const int32_t partition = static_cast<int32_t>(index % std::max(spool_->num_partitions(), 1));
+    const std::string source_id = "capture:" + config_.interface + "/" + std::to_string(index);
+    const uint32_t ifindex = if_nametoindex(config_.interface.c_str());
+    size_t batch_size = std::max<size_t>(1, config_.batch_size);
+
+    std::vector<SignalMessage> batch;
+    batch.reserve(batch_size);
+    int64_t sequence = 0;
+    uint64_t reassembly_drops_seen = 0;
+
+    auto write_batch = [&]() {
+        if (batch.empty()) return;
+        try {
+            append_batch_to_spool_partitioned(batch, partition);
+            ring.s1ap_pdus.fetch_add(batch.size(), std::memory_order_relaxed);
+        } catch (const std::exception& e) {
+            std::cerr << "CaptureIngestAdapter: spool write failed, " << batch.size()
+                      << " messages lost: " << e.what() << std::endl;
+        }
+        batch.clear();
+    };
+
+    auto sample_kernel_stats = [&]() {
+        // Reading PACKET_STATISTICS resets the kernel counters
+        tpacket_stats_v3 kstats;
+        socklen_t len = sizeof(kstats);
+        if (getsockopt(ring.fd, SOL_PACKET, PACKET_STATISTICS, &kstats, &len) == 0) {
+            ring.kernel_drops.fetch_add(kstats.tp_drops, std::memory_order_relaxed);
+        }
+    };
+
+    uint32_t block = 0;
+    while (running_) {
+        auto* desc = reinterpret_cast<tpacket_block_desc*>(ring.map + static_cast<size_t>(block) * config_.block_size);
+        if ((__atomic_load_n(&desc->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0) {
+            // Nothing retired yet: write out what we have rather than wait
+            write_batch();
+            sample_kernel_stats();
+            pollfd pfd{ring.fd, POLLIN | POLLERR, 0};
+            poll(&pfd, 1, 100);
+            continue;
+        }
+
+        int64_t ts_ingest = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        uint32_t num_packets = desc->hdr.bh1.num_pkts;
+        auto* packet = reinterpret_cast<tpacket3_hdr*>(reinterpret_cast<uint8_t*>(desc) +
+                                                       desc->hdr.bh1.offset_to_first_pkt);
+        for (uint32_t i = 0; i < num_packets; ++i) {
+            std::span<const uint8_t> frame(reinterpret_cast<const uint8_t*>(packet) + packet->tp_mac,
+                                           packet->tp_snaplen);
+            int64_t ts_capture = static_cast<int64_t>(packet->tp_sec) * 1000000000LL + packet->tp_nsec;
+            reassembler.process_frame(frame, [&](std::span<const uint8_t> pdu) {
+                SignalMessage& message = batch.emplace_back();
+                message.set_ts_capture(ts_capture);
+                message.set_ts_ingest(ts_ingest);
+                message.set_source_id(source_id);
+                message.set_direction(SignalMessage::UNKNOWN);
+                message.set_source_sequence(sequence++);
+                message.set_payload_type(SignalMessage::RAW_BYTES);
+                message.set_raw_bytes(pdu.data(), pdu.size());
+                message.set_sctp_association(reassembler.association());
+                message.mutable_capture()->set_ifindex(ifindex);
+                message.mutable_capture()->set_queue(static_cast<uint32_t>(index));
+            });
+            packet = reinterpret_cast<tpacket3_hdr*>(reinterpret_cast<uint8_t*>(packet) + packet->tp_next_offset);
+        }
+        ring.packets.fetch_add(num_packets, std::memory_order_relaxed);
+
+        // Frames are copied into messages; hand the block back to the kernel
+        __atomic_store_n(&desc->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+        block = (block + 1) % config_.block_count;
+
+        uint64_t drops = reassembler.stats().dropped;
+        ring.reassembly_drops.fetch_add(drops - reassembly_drops_seen, std::memory_order_relaxed);
+        reassembly_drops_seen = drops;
+
+        if (batch.size() >= batch_size) {
+            write_batch();
+        }
+    }
+    write_batch();
+    sample_kernel_stats();
+}
+
+#else
+
+bool CaptureIngestAdapter::start() {
+    std::cerr << "CaptureIngestAdapter: AF_PACKET capture is only available on Linux" << std::endl;
+    return false;
+}
+
+void CaptureIngestAdapter::stop() {
+    running_ = false;
+}
+
+void CaptureIngestAdapter::capture_loop(size_t) {
+}
+
+#endif
+
+} // namespace ingest
+} // namespace s1see
@@ -1,6 +1,23 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: grpc_adapter.cc
+ * Description: Implementation of GrpcIngestAdapter. Serves the per-message
+ *              Ingest stream and the batched IngestBatch stream, acknowledging
+ *              records once they are durable in the spool.
+ */
+
 #include "s1see/ingest/grpc_adapter.h"
 #include <grpcpp/server_builder.h>
+#include <algorithm>
 #include <iostream>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <vector>
 
 namespace s1see {
 namespace ingest {
@@ -53,12 +70,65 @@ grpc::Status GrpcIngestAdapter::Ingest(
     grpc::ServerContext* context,
     grpc::ServerReaderWriter<IngestAck, SignalMessage>* stream) {
     
+    // Acks are written by a separate thread, in order, once each append is
+    // durable. Reading keeps going meanwhile so one stream's messages can
+    // share a group commit instead of paying one sync each.
+    struct PendingAck {
+        IngestAck ack;
+        std::future<std::pair<int32_t, int64_t>> durable;
+    };
+    std::deque<PendingAck> pending;
+    std::mutex pending_mutex;
+    std::condition_variable pending_cv;
+    bool reading_done = false;
+    std::atomic<bool> failed{false};
+    std::string error_message;
+    
+    std::thread ack_writer([&]() {
+        while (true) {
+            PendingAck item;
+            {
+                std::unique_lock<std::mutex> lock(pending_mutex);
+                pending_cv.wait(lock, [&] { return reading_done || !pending.empty(); });
+                if (pending.empty()) return;
+                item = std::move(pending.front());
+                pending.pop_front();
+            }
+            
+            try {
+                auto [partition, offset] = item.durable.get();
+                item.ack.mutable_spool_offset()->set_partition(partition);
+                item.ack.mutable_spool_offset()->set_offset(offset);
+                item.ack.set_success(true);
+            } catch (const std::exception& e) {
+                item.ack.set_success(false);
+                item.ack.set_error_message(e.what());
+            }
+            
+            bool written = stream->Write(item.ack);
+            if (!item.ack.success() || !written) {
+                {
+                    std::lock_guard<std::mutex> lock(pending_mutex);
+                    error_message = written ? item.ack.error_message() : "Failed to send ack";
+                }
+                failed = true;
+                context->TryCancel(); // Unblock the pending Read()
+                return;
+            }
+        }
+    });
+    
     SignalMessage message;
     int64_t sequence = 0;
+    const uint64_t stream_id = next_stream_id_.fetch_add(1);
     
-    while (stream->Read(&message)) {
+    while (!failed && stream->Read(&message)) {
         sequence++;
         
+        PendingAck item;
+        item.ack.set_message_id(message.source_id() + ":" + std::to_string(message.source_sequence()));
+        item.ack.set_sequence(sequence);
+        
         try {
             // Set ingest timestamp if not set
             if (message.ts_ingest() == 0) {
@@ -66,32 +136,183 @@ grpc::Status GrpcIngestAdapter::Ingest(
                     std::chrono::system_clock::now().time_since_epoch()).count();
                 message.set_ts_ingest(now);
             }
+            if (message.transport_case() == SignalMessage::TRANSPORT_NOT_SET) {
+                message.mutable_grpc()->set_stream_id(stream_id);
+            }
             
-            // Append to spool
-            auto [partition, offset] = append_to_spool(message);
-            
-            // Send ack
-            IngestAck ack;
-            ack.set_message_id(message.source_id() + ":" + std::to_string(message.source_sequence()));
-            ack.set_sequence(sequence);
-            ack.mutable_spool_offset()->set_partition(partition);
-            ack.mutable_spool_offset()->set_offset(offset);
-            ack.set_success(true);
-            
-            if (!stream->Write(ack)) {
-                return grpc::Status(grpc::StatusCode::INTERNAL, "Failed to send ack");
+            // Append to spool; ack is sent once the record is on disk
+            item.durable = append_to_spool_durable(message);
+        } catch (...) {
+            std::promise<std::pair<int32_t, int64_t>> failed_append;
+            failed_append.set_exception(std::current_exception());
+            item.durable = failed_append.get_future();
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex);
+            pending.push_back(std::move(item));
+        }
+        pending_cv.notify_one();
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        reading_done = true;
+    }
+    pending_cv.notify_one();
+    ack_writer.join();
+    
+    if (failed) {
+        return grpc::Status(grpc::StatusCode::INTERNAL, error_message);
+    }
+    return grpc::Status::OK;
+}
+
+// One IngestBatch stream. Callbacks may run concurrently on gRPC threads,
+// so state is guarded by mutex_; one read and one write are outstanding
+// at most, as the reactor API requires. The stream finishes only once the
+// client is done writing and every batch it sent has been appended and
+// acked, so a batch still being appended when the final read completes
+// keeps the reactor alive and its ack is not dropped.
+class GrpcIngestAdapter::BatchReactor
+    : public grpc::ServerBidiReactor<SignalMessageBatch, IngestBatchAck> {
+public:
+    BatchReactor(GrpcIngestAdapter* adapter, int32_t partition, uint64_t stream_id)
+        : adapter_(adapter), partition_(partition), stream_id_(stream_id) {
+        StartRead(&batch_);
+    }
+    
+    void OnReadDone(bool ok) override {
+        if (!ok) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            reads_done_ = true;
+            maybe_finish_locked();
+            return;
+        }
+        
+        // Take the batch and read ahead while it is written. append_mutex_
+        // is held before the next read starts, so batches reach the spool
+        // and the ack queue in stream order.
+        std::unique_lock<std::mutex> append_lock(append_mutex_);
+        std::vector<SignalMessage> messages;
+        messages.reserve(batch_.messages_size());
+        auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        for (auto& message : *batch_.mutable_messages()) {
+            if (message.ts_ingest() == 0) {
+                message.set_ts_ingest(now);
+            }
+            if (message.transport_case() == SignalMessage::TRANSPORT_NOT_SET) {
+                message.mutable_grpc()->set_stream_id(stream_id_);
+            }
+            messages.push_back(std::move(message));
+        }
+        IngestBatchAck ack;
+        ack.set_batch_id(batch_.batch_id());
+        ack.set_first_sequence(next_sequence_ + 1);
+        next_sequence_ += static_cast<int64_t>(messages.size());
+        ack.set_last_sequence(next_sequence_);
+        batch_.Clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (finished_) return;
+            ++appends_in_flight_;
+            StartRead(&batch_);
+        }
+        
+        try {
+            if (!messages.empty()) {
+                auto [partition, offset] = adapter_->append_batch_to_spool_partitioned(messages, partition_);
+                ack.mutable_last_offset()->set_partition(partition);
+                ack.mutable_last_offset()->set_offset(offset);
             }
+            ack.set_success(true);
         } catch (const std::exception& e) {
-            IngestAck ack;
-            ack.set_sequence(sequence);
             ack.set_success(false);
             ack.set_error_message(e.what());
-            stream->Write(ack);
-            return grpc::Status(grpc::StatusCode::INTERNAL, e.what());
         }
+        
+        std::lock_guard<std::mutex> lock(mutex_);
+        --appends_in_flight_;
+        enqueue_ack_locked(std::move(ack));
+        send_next_locked();
+        maybe_finish_locked();
     }
     
-    return grpc::Status::OK;
+    void OnWriteDone(bool ok) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writing_ = false;
+        if (!ok) {
+            finish_locked(grpc::Status(grpc::StatusCode::UNAVAILABLE, "Failed to send ack"));
+            return;
+        }
+        if (!in_flight_.success()) {
+            finish_locked(grpc::Status(grpc::StatusCode::INTERNAL, in_flight_.error_message()));
+            return;
+        }
+        send_next_locked();
+        maybe_finish_locked();
+    }
+    
+    void OnDone() override {
+        delete this;
+    }
+
+private:
+    // Acks waiting behind an outstanding write are merged: a successful ack
+    // covers every earlier sequence, so only the newest needs sending
+    void enqueue_ack_locked(IngestBatchAck ack) {
+        if (!queued_.empty() && queued_.back().success() && ack.success()) {
+            int64_t first = queued_.back().first_sequence();
+            queued_.back() = std::move(ack);
+            queued_.back().set_first_sequence(first);
+            return;
+        }
+        queued_.push_back(std::move(ack));
+    }
+    
+    void send_next_locked() {
+        if (writing_ || finished_ || queued_.empty()) return;
+        in_flight_ = std::move(queued_.front());
+        queued_.pop_front();
+        writing_ = true;
+        StartWrite(&in_flight_);
+    }
+    
+    void maybe_finish_locked() {
+        if (reads_done_ && appends_in_flight_ == 0 && !writing_ && queued_.empty()) {
+            finish_locked(grpc::Status::OK);
+        }
+    }
+    
+    void finish_locked(const grpc::Status& status) {
+        if (finished_) return;
+        finished_ = true;
+        Finish(status);
+    }
+    
+    GrpcIngestAdapter* adapter_;
+    int32_t partition_;
+    uint64_t stream_id_;
+    SignalMessageBatch batch_;
+    
+    std::mutex append_mutex_;
+    int64_t next_sequence_ = 0;  // Guarded by append_mutex_
+    
+    std::mutex mutex_;
+    std::deque<IngestBatchAck> queued_;
+    IngestBatchAck in_flight_;
+    int appends_in_flight_ = 0;  // Batches read but not yet queued for acking
+    bool writing_ = false;
+    bool reads_done_ = false;
+    bool finished_ = false;
+};
+
+grpc::ServerBidiReactor<SignalMessageBatch, IngestBatchAck>* GrpcIngestAdapter::IngestBatch(
+    grpc::CallbackServerContext*) {
+    int32_t partitions = spool_ ? std::max(spool_->num_partitions(), 1) : 1;
+    int32_t partition = static_cast<int32_t>(next_stream_partition_.fetch_add(1) % partitions);
+    return new BatchReactor(this, partition, next_stream_id_.fetch_add(1));
 }
 
 } // namespace ingest
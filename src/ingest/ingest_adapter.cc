@@ -11,13 +11,109 @@
  */
 
 #include "s1see/ingest/ingest_adapter.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
 
 namespace s1see {
 namespace ingest {
 
-// Base class implementation (mostly virtual)
+size_t IngestAdapter::spool_batch_and_ack(std::vector<IngestRecord>& records, const BatchAck& ack) {
+    if (!spool_) {
+        throw std::runtime_error("Spool not set");
+    }
+    int32_t num_partitions = std::max(spool_->num_partitions(), 1);
+    std::hash<std::string> hasher;
+    for (auto& record : records) {
+        int32_t preferred = record.spool_partition >= 0
+            ? record.spool_partition
+            : static_cast<int32_t>(hasher(record.message.source_id()) % num_partitions);
+        record.spool_partition = spool_->partition_for(record.message, preferred);
+    }
+    
+    // Group by spool partition, keeping arrival order within each group
+    std::stable_sort(records.begin(), records.end(), [](const IngestRecord& a, const IngestRecord& b) {
+        return a.spool_partition < b.spool_partition;
+    });
+    
+    size_t durable = 0;
+    std::vector<SignalMessage> messages;
+    for (size_t begin = 0; begin < records.size();) {
+        size_t end = begin;
+        while (end < records.size() && records[end].spool_partition == records[begin].spool_partition) {
+            ++end;
+        }
+        messages.clear();
+        for (size_t i = begin; i < end; ++i) {
+            messages.push_back(std::move(records[i].message));
+        }
+        
+        bool ok = true;
+        try {
+            spool_->append_batch_durable(records[begin].spool_partition, messages);
+            durable += end - begin;
+        } catch (const std::exception& e) {
+            std::cerr << "Spool write failed: " << e.what() << std::endl;
+            ok = false;
+        }
+        ack(std::span<const IngestRecord>(records.data() + begin, end - begin), ok);
+        begin = end;
+    }
+    return durable;
+}
 
-} // namespace ingest
-} // namespace s1see
+std::pair<int32_t, int64_t> IngestAdapter::append_batch_to_spool_partitioned(
+    std::span<const SignalMessage> messages, int32_t preferred) {
+    if (!spool_) {
+        throw std::runtime_error("Spool not set");
+    }
+    if (messages.empty()) {
+        return {preferred, -1};
+    }
+    std::vector<int32_t> partitions(messages.size());
+    bool single = true;
+    for (size_t i = 0; i < messages.size(); ++i) {
+        partitions[i] = spool_->partition_for(messages[i], preferred);
+        single = single && partitions[i] == partitions[0];
+    }
+    if (single) {
+        int64_t first = spool_->append_batch_durable(partitions[0], messages);
+        return {partitions[0], first + static_cast<int64_t>(messages.size()) - 1};
+    }
+    
+    // Split by partition, keeping arrival order within each
+    std::map<int32_t, std::vector<SignalMessage>> groups;
+    for (size_t i = 0; i < messages.size(); ++i) {
+        groups[partitions[i]].push_back(messages[i]);
+    }
+    int64_t last_offset = -1;
+    for (const auto& [partition, group] : groups) {
+        int64_t first = spool_->append_batch_durable(partition, group);
+        if (partition == partitions.back()) {
+            last_offset = first + static_cast<int64_t>(group.size()) - 1;
+        }
+    }
+    return {partitions.back(), last_offset};
+}
 
+SignalMessage IngestAdapter::payload_to_message(const void* payload, size_t length,
+                                                const std::string& source_id, int64_t sequence,
+                                                int64_t ts_capture_ns) {
+    SignalMessage message;
+    if (!message.ParseFromArray(payload, static_cast<int>(length)) || message.raw_bytes().empty()) {
+        message.Clear();
+        message.set_raw_bytes(payload, length);
+        message.set_source_id(source_id);
+        message.set_source_sequence(sequence);
+        message.set_ts_capture(ts_capture_ns);
+    }
+    if (message.ts_ingest() == 0) {
+        message.set_ts_ingest(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+    return message;
+}
 
+} // namespace ingest
+} // namespace s1see
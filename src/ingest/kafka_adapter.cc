@@ -1,31 +1,235 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: kafka_adapter.cc
+ * Description: Implementation of KafkaIngestAdapter on librdkafka's high-level
+ *              consumer. A consumer thread polls batches from the consumer
+ *              queue, writes them to the spool durably and then commits the
+ *              Kafka offsets synchronously.
+ */
+
 #include "s1see/ingest/kafka_adapter.h"
+#include <algorithm>
 #include <iostream>
+#include <unordered_map>
+#ifdef HAVE_RDKAFKA
+#include <librdkafka/rdkafka.h>
+#endif
 
 namespace s1see {
 namespace ingest {
 
-KafkaIngestAdapter::KafkaIngestAdapter(const std::string& brokers, const std::string& topic)
-    : brokers_(brokers), topic_(topic) {
+KafkaIngestAdapter::KafkaIngestAdapter(const std::string& brokers, const std::string& topic) {
+    config_.brokers = brokers;
+    config_.topic = topic;
+}
+
+KafkaIngestAdapter::KafkaIngestAdapter(const Config& config)
+    : config_(config) {
 }
 
 KafkaIngestAdapter::~KafkaIngestAdapter() {
     stop();
 }
 
+SignalMessage KafkaIngestAdapter::to_signal_message(const std::string& topic, int32_t partition, int64_t offset,
+                                                    int64_t timestamp_ms, const void* payload, size_t length) {
+    SignalMessage message = payload_to_message(payload, length,
+                                               "kafka:" + topic + ":" + std::to_string(partition), offset,
+                                               timestamp_ms > 0 ? timestamp_ms * 1000000LL : 0);
+    if (message.transport_case() == SignalMessage::TRANSPORT_NOT_SET) {
+        auto* kafka = message.mutable_kafka();
+        kafka->set_topic(topic);
+        kafka->set_partition(partition);
+        kafka->set_offset(offset);
+    }
+    return message;
+}
+
+#ifdef HAVE_RDKAFKA
+
 bool KafkaIngestAdapter::start() {
-    // TODO: Initialize Kafka consumer
-    // For prototype: stub implementation
-    std::cerr << "KafkaIngestAdapter: Stub implementation - integrate librdkafka for production" << std::endl;
-    return false; // Not implemented yet
+    if (!spool_) {
+        std::cerr << "KafkaIngestAdapter: spool not set" << std::endl;
+        return false;
+    }
+    if (running_.exchange(true)) {
+        return false; // Already running
+    }
+    
+    char errstr[512];
+    rd_kafka_conf_t* conf = rd_kafka_conf_new();
+    std::map<std::string, std::string> settings = {
+        {"bootstrap.servers", config_.brokers},
+        {"group.id", config_.group_id},
+        // Offsets are committed by hand once the spool write is durable
+        {"enable.auto.commit", "false"},
+        {"enable.auto.offset.store", "false"},
+        {"auto.offset.reset", "earliest"},
+    };
+    for (const auto& [key, value] : config_.properties) {
+        settings[key] = value;
+    }
+    for (const auto& [key, value] : settings) {
+        if (rd_kafka_conf_set(conf, key.c_str(), value.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
+            std::cerr << "KafkaIngestAdapter: " << key << ": " << errstr << std::endl;
+            rd_kafka_conf_destroy(conf);
+            running_ = false;
+            return false;
+        }
+    }
+    
+    rd_kafka_t* rk = rd_kafka_new(RD_KAFKA_CONSUMER, conf, errstr, sizeof(errstr));
+    if (!rk) {
+        std::cerr << "KafkaIngestAdapter: failed to create consumer: " << errstr << std::endl;
+        rd_kafka_conf_destroy(conf);
+        running_ = false;
+        return false;
+    }
+    rd_kafka_poll_set_consumer(rk);
+    
+    rd_kafka_topic_partition_list_t* topics = rd_kafka_topic_partition_list_new(1);
+    rd_kafka_topic_partition_list_add(topics, config_.topic.c_str(), RD_KAFKA_PARTITION_UA);
+    rd_kafka_resp_err_t err = rd_kafka_subscribe(rk, topics);
+    rd_kafka_topic_partition_list_destroy(topics);
+    if (err) {
+        std::cerr << "KafkaIngestAdapter: failed to subscribe to " << config_.topic << ": "
+                  << rd_kafka_err2str(err) << std::endl;
+        rd_kafka_destroy(rk);
+        running_ = false;
+        return false;
+    }
+    
+    consumer_ = rk;
+    queue_ = rd_kafka_queue_get_consumer(rk);
+    consumer_thread_ = std::thread(&KafkaIngestAdapter::consume_loop, this);
+    return true;
+}
+
+void KafkaIngestAdapter::consume_loop() {
+    auto* rk = static_cast<rd_kafka_t*>(consumer_);
+    auto* queue = static_cast<rd_kafka_queue_t*>(queue_);
+    size_t batch_size = std::max<size_t>(config_.batch_size, 1);
+    std::vector<rd_kafka_message_t*> polled(batch_size);
+    std::vector<IngestRecord> records;
+    records.reserve(batch_size);
+    
+    while (running_) {
+        ssize_t n = rd_kafka_consume_batch_queue(queue, static_cast<int>(config_.poll_timeout.count()),
+                                                 polled.data(), batch_size);
+        if (n <= 0) {
+            continue;
+        }
+        
+        records.clear();
+        for (ssize_t i = 0; i < n; ++i) {
+            rd_kafka_message_t* msg = polled[i];
+            if (msg->err) {
+                if (msg->err != RD_KAFKA_RESP_ERR__PARTITION_EOF) {
+                    std::cerr << "KafkaIngestAdapter: " << rd_kafka_message_errstr(msg) << std::endl;
+                }
+            } else {
+                IngestRecord record;
+                record.message = to_signal_message(config_.topic, msg->partition, msg->offset,
+                                                   rd_kafka_message_timestamp(msg, nullptr), msg->payload, msg->len);
+                // Kafka partitions map onto spool partitions so per-partition
+                // order holds, unless the spool has its own partitioner
+                record.spool_partition = msg->partition;
+                record.source_partition = msg->partition;
+                record.ack_token = msg->offset;
+                records.push_back(std::move(record));
+            }
+            rd_kafka_message_destroy(msg);
+        }
+        if (records.empty()) {
+            continue;
+        }
+        
+        // Commit the next offset of every Kafka partition whose records are
+        // on disk; rewind any whose spool write failed so it is refetched
+        std::unordered_map<int32_t, int64_t> commit;
+        std::unordered_map<int32_t, int64_t> rewind;
+        for (const auto& record : records) {
+            commit.emplace(record.source_partition, -1);
+        }
+        messages_ingested_ += spool_batch_and_ack(records, [&](std::span<const IngestRecord> group, bool durable) {
+            for (const auto& record : group) {
+                if (durable) {
+                    commit[record.source_partition] = std::max(commit[record.source_partition], record.ack_token + 1);
+                } else {
+                    auto [it, inserted] = rewind.emplace(record.source_partition, record.ack_token);
+                    if (!inserted) it->second = std::min(it->second, record.ack_token);
+                }
+            }
+        });
+        
+        rd_kafka_topic_partition_list_t* offsets = rd_kafka_topic_partition_list_new(static_cast<int>(commit.size()));
+        for (const auto& [partition, offset] : commit) {
+            if (offset >= 0 && !rewind.count(partition)) {
+                rd_kafka_topic_partition_list_add(offsets, config_.topic.c_str(), partition)->offset = offset;
+            }
+        }
+        if (offsets->cnt > 0) {
+            rd_kafka_resp_err_t err = rd_kafka_commit(rk, offsets, 0);
+            if (err) {
+                // Uncommitted records are redelivered after a rebalance or restart
+                std::cerr << "KafkaIngestAdapter: offset commit failed: " << rd_kafka_err2str(err) << std::endl;
+            }
+        }
+        rd_kafka_topic_partition_list_destroy(offsets);
+        
+        if (!rewind.empty()) {
+            rd_kafka_topic_partition_list_t* seek = rd_kafka_topic_partition_list_new(static_cast<int>(rewind.size()));
+            for (const auto& [partition, offset] : rewind) {
+                rd_kafka_topic_partition_list_add(seek, config_.topic.c_str(), partition)->offset = offset;
+            }
+            rd_kafka_error_t* error = rd_kafka_seek_partitions(rk, seek, -1);
+            if (error) {
+                std::cerr << "KafkaIngestAdapter: seek failed: " << rd_kafka_error_string(error) << std::endl;
+                rd_kafka_error_destroy(error);
+            }
+            rd_kafka_topic_partition_list_destroy(seek);
+            std::this_thread::sleep_for(config_.poll_timeout);
+        }
+    }
 }
 
 void KafkaIngestAdapter::stop() {
-    // TODO: Cleanup Kafka consumer
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (consumer_thread_.joinable()) {
+        consumer_thread_.join();
+    }
+    auto* rk = static_cast<rd_kafka_t*>(consumer_);
+    if (queue_) {
+        rd_kafka_queue_destroy(static_cast<rd_kafka_queue_t*>(queue_));
+        queue_ = nullptr;
+    }
+    if (rk) {
+        rd_kafka_consumer_close(rk);
+        rd_kafka_destroy(rk);
+        consumer_ = nullptr;
+    }
 }
 
-} // namespace ingest
-} // namespace s1see
+#else // !HAVE_RDKAFKA
 
+bool KafkaIngestAdapter::start() {
+    std::cerr << "KafkaIngestAdapter: built without librdkafka (install librdkafka-dev and reconfigure)" << std::endl;
+    return false;
+}
 
+void KafkaIngestAdapter::consume_loop() {
+}
 
+void KafkaIngestAdapter::stop() {
+    running_ = false;
+}
+
+#endif // HAVE_RDKAFKA
 
+} // namespace ingest
+} // namespace s1see
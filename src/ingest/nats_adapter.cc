@@ -1,30 +1,183 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: nats_adapter.cc
+ * Description: Implementation of NATSIngestAdapter on nats.c JetStream. A fetch
+ *              thread pulls batches from a durable pull consumer, spools them
+ *              and acknowledges each batch with one AckAll ack.
+ */
+
 #include "s1see/ingest/nats_adapter.h"
+#include <algorithm>
 #include <iostream>
+#include <vector>
+#ifdef HAVE_NATS
+#include <nats/nats.h>
+#endif
 
 namespace s1see {
 namespace ingest {
 
-NATSIngestAdapter::NATSIngestAdapter(const std::string& servers, const std::string& subject)
-    : servers_(servers), subject_(subject) {
+NATSIngestAdapter::NATSIngestAdapter(const std::string& servers, const std::string& subject) {
+    config_.servers = servers;
+    config_.subject = subject;
+}
+
+NATSIngestAdapter::NATSIngestAdapter(const Config& config)
+    : config_(config) {
 }
 
 NATSIngestAdapter::~NATSIngestAdapter() {
     stop();
 }
 
+#ifdef HAVE_NATS
+
 bool NATSIngestAdapter::start() {
-    // TODO: Initialize NATS connection
-    std::cerr << "NATSIngestAdapter: Stub implementation - integrate nats.c for production" << std::endl;
-    return false;
+    if (!spool_) {
+        std::cerr << "NATSIngestAdapter: spool not set" << std::endl;
+        return false;
+    }
+    if (running_.exchange(true)) {
+        return false; // Already running
+    }
+    
+    natsOptions* opts = nullptr;
+    natsConnection* nc = nullptr;
+    jsCtx* js = nullptr;
+    natsSubscription* sub = nullptr;
+    jsErrCode jerr = static_cast<jsErrCode>(0);
+    
+    natsStatus s = natsOptions_Create(&opts);
+    if (s == NATS_OK) s = natsOptions_SetURL(opts, config_.servers.c_str());
+    if (s == NATS_OK) s = natsConnection_Connect(&nc, opts);
+    natsOptions_Destroy(opts);
+    if (s == NATS_OK) s = natsConnection_JetStream(&js, nc, nullptr);
+    if (s == NATS_OK) {
+        // AckAll: acknowledging the last message of a batch covers the rest
+        jsSubOptions sub_opts;
+        jsSubOptions_Init(&sub_opts);
+        if (!config_.stream.empty()) {
+            sub_opts.Stream = config_.stream.c_str();
+        }
+        sub_opts.Config.AckPolicy = js_AckAll;
+        s = js_PullSubscribe(&sub, js, config_.subject.c_str(), config_.durable.c_str(),
+                             nullptr, &sub_opts, &jerr);
+    }
+    if (s != NATS_OK) {
+        std::cerr << "NATSIngestAdapter: failed to subscribe to " << config_.subject << ": "
+                  << natsStatus_GetText(s) << " (JetStream error " << jerr << ")" << std::endl;
+        jsCtx_Destroy(js);
+        natsConnection_Destroy(nc);
+        running_ = false;
+        return false;
+    }
+    
+    connection_ = nc;
+    jetstream_ = js;
+    subscription_ = sub;
+    fetch_thread_ = std::thread(&NATSIngestAdapter::fetch_loop, this);
+    return true;
+}
+
+void NATSIngestAdapter::fetch_loop() {
+    auto* sub = static_cast<natsSubscription*>(subscription_);
+    std::vector<IngestRecord> records;
+    
+    while (running_) {
+        natsMsgList list;
+        jsErrCode jerr = static_cast<jsErrCode>(0);
+        natsStatus s = natsSubscription_Fetch(&list, sub, std::max(config_.batch_size, 1),
+                                              config_.fetch_timeout.count(), &jerr);
+        if (s == NATS_TIMEOUT) {
+            continue;
+        }
+        if (s != NATS_OK) {
+            std::cerr << "NATSIngestAdapter: fetch failed: " << natsStatus_GetText(s) << std::endl;
+            std::this_thread::sleep_for(config_.fetch_timeout);
+            continue;
+        }
+        
+        records.clear();
+        for (int i = 0; i < list.Count; ++i) {
+            natsMsg* msg = list.Msgs[i];
+            jsMsgMetaData* meta = nullptr;
+            int64_t sequence = 0;
+            int64_t timestamp_ns = 0;
+            if (natsMsg_GetMetaData(&meta, msg) == NATS_OK) {
+                sequence = static_cast<int64_t>(meta->Sequence.Stream);
+                timestamp_ns = meta->Timestamp;
+                jsMsgMetaData_Destroy(meta);
+            }
+            std::string subject = natsMsg_GetSubject(msg);
+            IngestRecord record;
+            record.message = payload_to_message(
+                natsMsg_GetData(msg), static_cast<size_t>(natsMsg_GetDataLength(msg)),
+                "nats:" + subject, sequence, timestamp_ns);
+            if (record.message.transport_case() == SignalMessage::TRANSPORT_NOT_SET) {
+                record.message.mutable_nats()->set_subject(subject);
+                record.message.mutable_nats()->set_stream_sequence(static_cast<uint64_t>(sequence));
+            }
+            record.ack_token = i;
+            records.push_back(std::move(record));
+        }
+        
+        bool all_durable = true;
+        size_t durable = spool_batch_and_ack(records, [&](std::span<const IngestRecord>, bool ok) {
+            all_durable = all_durable && ok;
+        });
+        messages_ingested_ += durable;
+        if (list.Count > 0) {
+            if (all_durable) {
+                // Synchronous, so the batch is acked on the server before
+                // stop() can drop the connection
+                natsMsg_AckSync(list.Msgs[list.Count - 1], nullptr, &jerr);
+            } else {
+                // An ack would cover the failed messages too
+                for (int i = 0; i < list.Count; ++i) {
+                    natsMsg_Nak(list.Msgs[i], nullptr);
+                }
+            }
+        }
+        natsMsgList_Destroy(&list);
+    }
 }
 
 void NATSIngestAdapter::stop() {
-    // TODO: Cleanup NATS connection
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (fetch_thread_.joinable()) {
+        fetch_thread_.join();
+    }
+    // Close first: destroying a still-open subscription unsubscribes,
+    // which deletes a consumer the library created, durable or not
+    natsConnection_Close(static_cast<natsConnection*>(connection_));
+    natsSubscription_Destroy(static_cast<natsSubscription*>(subscription_));
+    jsCtx_Destroy(static_cast<jsCtx*>(jetstream_));
+    natsConnection_Destroy(static_cast<natsConnection*>(connection_));
+    subscription_ = nullptr;
+    jetstream_ = nullptr;
+    connection_ = nullptr;
 }
 
-} // namespace ingest
-} // namespace s1see
+#else // !HAVE_NATS
 
+bool NATSIngestAdapter::start() {
+    std::cerr << "NATSIngestAdapter: built without nats.c (install libnats and reconfigure)" << std::endl;
+    return false;
+}
 
+void NATSIngestAdapter::fetch_loop() {
+}
 
+void NATSIngestAdapter::stop() {
+    running_ = false;
+}
+
+#endif // HAVE_NATS
 
+} // namespace ingest
+} // namespace s1see
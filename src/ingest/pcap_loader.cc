@@ -0,0 +1,127 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: pcap_loader.cc
+ * Description: Implementation of PcapLoader. Reads a mapped capture in rounds
+ *              of one chunk per worker, extracts S1AP PDUs from the chunks in
+ *              parallel, then appends them to the spool in frame order.
+ */
+
+#include "s1see/ingest/pcap_loader.h"
+#include "s1see/ingest/sctp_reassembler.h"
+#include "s1see/utils/pcap_reader.h"
+#include "s1see/utils/thread_pool.h"
+#include "s1ap_parser.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace s1see {
+namespace ingest {
+
+PcapLoader::PcapLoader(std::shared_ptr<spool::Spool> spool, const Config& config)
+    : spool_(std::move(spool)), config_(config) {
+}
+
+PcapLoader::Stats PcapLoader::load(const std::string& pcap_path, int64_t first_sequence) {
+    auto start = std::chrono::steady_clock::now();
+    utils::MappedPcapFile file(pcap_path);
+
+    const std::string source_id = config_.source_id.empty()
+        ? "pcap:" + std::filesystem::path(pcap_path).filename().string()
+        : config_.source_id;
+    size_t num_workers = config_.num_workers > 0
+        ? config_.num_workers
+        : std::max<size_t>(1, std::thread::hardware_concurrency());
+    size_t chunk_frames = std::max<size_t>(1, config_.chunk_frames);
+    size_t batch_size = std::max<size_t>(1, config_.batch_size);
+
+    utils::ThreadPool pool(num_workers);
+    std::vector<std::vector<utils::PcapFrame>> chunks(num_workers);
+    std::vector<std::vector<SignalMessage>> extracted(num_workers);
+    std::vector<SignalMessage> pending;
+    pending.reserve(batch_size);
+
+    Stats stats;
+    stats.bytes = file.size();
+    int64_t sequence = first_sequence;
+    const int64_t ts_ingest = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    auto write_pending = [&]() {
+        if (pending.empty()) return;
+        if (config_.partition >= 0) {
+            spool_->append_batch_durable(config_.partition, pending);
+        } else {
+            spool_->append_batch(pending);
+        }
+        pending.clear();
+    };
+
+    auto extract_chunk = [&](size_t i) {
+        auto& messages = extracted[i];
+        messages.clear();
+        for (const auto& frame : chunks[i]) {
+            uint64_t association = sctp_association(std::span<const uint8_t>(frame.data, frame.captured_len));
+            for (auto& s1ap_bytes : s1ap_parser::extractAllS1apFromSctp(frame.data, frame.captured_len)) {
+                SignalMessage& msg = messages.emplace_back();
+                msg.set_ts_capture(frame.timestamp_ns);
+                msg.set_ts_ingest(ts_ingest);
+                msg.set_source_id(source_id);
+                msg.set_direction(SignalMessage::UNKNOWN);
+                msg.set_frame_number(frame.frame_number);
+                msg.mutable_pcap()->set_file_id(config_.file_id);
+                msg.set_payload_type(SignalMessage::RAW_BYTES);
+                msg.set_raw_bytes(s1ap_bytes.data(), s1ap_bytes.size());
+                msg.set_sctp_association(association);
+            }
+        }
+    };
+
+    bool more = true;
+    while (more) {
+        // Fill one chunk per worker; frame data stays in the mapping
+        size_t filled = 0;
+        while (filled < num_workers) {
+            auto& frames = chunks[filled];
+            frames.clear();
+            utils::PcapFrame frame;
+            while (frames.size() < chunk_frames && (more = file.next(frame))) {
+                frames.push_back(frame);
+            }
+            if (frames.empty()) break;
+            stats.frames += frames.size();
+            ++filled;
+            if (!more) break;
+        }
+        if (filled == 0) break;
+
+        pool.parallel_for(filled, extract_chunk);
+
+        // Chunks are consecutive frame ranges, so taking them in index
+        // order keeps frame order
+        for (size_t i = 0; i < filled; ++i) {
+            for (auto& msg : extracted[i]) {
+                msg.set_source_sequence(sequence++);
+                pending.push_back(std::move(msg));
+                if (pending.size() >= batch_size) {
+                    write_pending();
+                }
+            }
+            stats.s1ap_pdus += extracted[i].size();
+        }
+    }
+    write_pending();
+    spool_->flush();
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+} // namespace ingest
+} // namespace s1see
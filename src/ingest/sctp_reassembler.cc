@@ -0,0 +1,193 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: sctp_reassembler.cc
+ * Description: Implementation of SctpReassembler. Locates the SCTP packet in
+ *              an Ethernet frame and reassembles fragmented S1AP DATA chunks.
+ */
+
+#include "s1see/ingest/sctp_reassembler.h"
+#include <algorithm>
+
+namespace s1see {
+namespace ingest {
+
+namespace {
+
+constexpr uint8_t IP_PROTO_SCTP = 132;
+constexpr uint8_t SCTP_CHUNK_DATA = 0;
+constexpr uint32_t S1AP_PPID = 18;
+
+// DATA chunk flags
+constexpr uint8_t SCTP_DATA_END = 0x01;
+constexpr uint8_t SCTP_DATA_BEGIN = 0x02;
+
+uint16_t be16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t be32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+// FNV-1a over one endpoint's address and port
+uint64_t hash_endpoint(const uint8_t* address, size_t size, uint16_t port) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ address[i]) * 0x100000001b3ULL;
+    }
+    hash = (hash ^ (port >> 8)) * 0x100000001b3ULL;
+    return (hash ^ (port & 0xFF)) * 0x100000001b3ULL;
+}
+
+// SCTP packet within an Ethernet frame, trimmed to the IP payload length
+// so Ethernet padding is not read as chunks. Empty if the frame carries
+// no (unfragmented) SCTP. With association set, also stores the key of
+// the association: both endpoints, ordered so either direction matches.
+std::span<const uint8_t> find_sctp_packet(std::span<const uint8_t> frame, uint64_t* association = nullptr) {
+    const uint8_t* p = frame.data();
+    size_t len = frame.size();
+    if (len < 14) return {};
+
+    size_t offset = 12;
+    uint16_t eth_type = be16(p + offset);
+    offset += 2;
+    for (int tags = 0; (eth_type == 0x8100 || eth_type == 0x88A8) && tags < 2; ++tags) {
+        if (len < offset + 4) return {};
+        eth_type = be16(p + offset + 2);
+        offset += 4;
+    }
+
+    uint8_t protocol = 0;
+    size_t end = len;
+    const uint8_t* addresses = nullptr;  // Source then destination
+    size_t address_size = 0;
+    if (eth_type == 0x0800) {
+        if (len < offset + 20 || (p[offset] >> 4) != 4) return {};
+        size_t header_len = (p[offset] & 0x0F) * 4;
+        size_t total_len = be16(p + offset + 2);
+        // IP fragments are not reassembled here
+        if ((be16(p + offset + 6) & 0x3FFF) != 0) return {};
+        if (header_len < 20 || total_len < header_len || len < offset + total_len) return {};
+        protocol = p[offset + 9];
+        addresses = p + offset + 12;
+        address_size = 4;
+        end = offset + total_len;
+        offset += header_len;
+    } else if (eth_type == 0x86DD) {
+        if (len < offset + 40 || (p[offset] >> 4) != 6) return {};
+        size_t payload_len = be16(p + offset + 4);
+        protocol = p[offset + 6];
+        addresses = p + offset + 8;
+        address_size = 16;
+        offset += 40;
+        if (payload_len > 0 && len >= offset + payload_len) end = offset + payload_len;
+        for (int ext = 0; ext < 8 && protocol != IP_PROTO_SCTP; ++ext) {
+            if (protocol != 0 && protocol != 43 && protocol != 60) break;
+            if (end < offset + 8) return {};
+            size_t ext_len = (static_cast<size_t>(p[offset + 1]) + 1) * 8;
+            if (end < offset + ext_len) return {};
+            protocol = p[offset];
+            offset += ext_len;
+        }
+    } else {
+        return {};
+    }
+
+    if (protocol != IP_PROTO_SCTP || end < offset + 12) return {};
+    if (association) {
+        uint64_t source = hash_endpoint(addresses, address_size, be16(p + offset));
+        uint64_t destination = hash_endpoint(addresses + address_size, address_size, be16(p + offset + 2));
+        uint64_t key = (std::min(source, destination) * 0x9E3779B97F4A7C15ULL) ^ std::max(source, destination);
+        *association = key != 0 ? key : 1;
+    }
+    return frame.subspan(offset, end - offset);
+}
+
+} // namespace
+
+uint64_t sctp_association(std::span<const uint8_t> frame) {
+    uint64_t association = 0;
+    find_sctp_packet(frame, &association);
+    return association;
+}
+
+SctpReassembler::SctpReassembler(const Config& config)
+    : config_(config) {
+}
+
+size_t SctpReassembler::process_frame(std::span<const uint8_t> frame, const PduCallback& on_pdu) {
+    association_ = 0;
+    std::span<const uint8_t> sctp = find_sctp_packet(frame, &association_);
+    if (sctp.empty()) return 0;
+
+    const uint8_t* p = sctp.data();
+    size_t len = sctp.size();
+    uint64_t source_port = be16(p);
+    uint64_t verification_tag = be32(p + 4);
+    size_t delivered = 0;
+
+    size_t offset = 12;
+    while (offset + 4 <= len) {
+        uint8_t chunk_type = p[offset];
+        uint8_t flags = p[offset + 1];
+        size_t chunk_len = be16(p + offset + 2);
+        if (chunk_len < 4 || offset + chunk_len > len) break;
+
+        // DATA: Type(1) Flags(1) Length(2) TSN(4) StreamID(2) StreamSeq(2) PPID(4) UserData
+        if (chunk_type == SCTP_CHUNK_DATA && chunk_len > 16 && be32(p + offset + 12) == S1AP_PPID) {
+            ++stats_.data_chunks;
+            uint32_t tsn = be32(p + offset + 4);
+            uint64_t stream = be16(p + offset + 8);
+            std::span<const uint8_t> user_data = sctp.subspan(offset + 16, chunk_len - 16);
+            bool begin = flags & SCTP_DATA_BEGIN;
+            bool end = flags & SCTP_DATA_END;
+
+            if (begin && end) {
+                on_pdu(user_data);
+                ++delivered;
+            } else {
+                ++stats_.fragments;
+                uint64_t key = (verification_tag << 32) | (source_port << 16) | stream;
+                if (begin) {
+                    if (partials_.size() >= config_.max_pending && partials_.find(key) == partials_.end()) {
+                        stats_.dropped += partials_.size();
+                        partials_.clear();
+                    }
+                    Partial& partial = partials_[key];
+                    if (!partial.data.empty()) ++stats_.dropped;  // Previous message never ended
+                    partial.data.assign(user_data.begin(), user_data.end());
+                    partial.next_tsn = tsn + 1;
+                } else {
+                    auto it = partials_.find(key);
+                    if (it == partials_.end()) {
+                        ++stats_.dropped;  // Missed the first fragment
+                    } else if (it->second.next_tsn != tsn ||
+                               it->second.data.size() + user_data.size() > config_.max_message_size) {
+                        ++stats_.dropped;
+                        partials_.erase(it);
+                    } else {
+                        Partial& partial = it->second;
+                        partial.data.insert(partial.data.end(), user_data.begin(), user_data.end());
+                        partial.next_tsn = tsn + 1;
+                        if (end) {
+                            on_pdu(partial.data);
+                            ++delivered;
+                            ++stats_.reassembled;
+                            partials_.erase(it);
+                        }
+                    }
+                }
+            }
+        }
+
+        offset += (chunk_len + 3) & ~size_t(3);
+    }
+    return delivered;
+}
+
+} // namespace ingest
+} // namespace s1see
@@ -0,0 +1,197 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: metrics.cc
+ * Description: Implementation of the metrics registry and its Prometheus
+ *              text rendering.
+ */
+
+#include "s1see/metrics/metrics.h"
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace s1see {
+namespace metrics {
+
+namespace {
+
+std::string escape_label_value(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '\\': escaped += "\\\\"; break;
+            case '"': escaped += "\\\""; break;
+            case '\n': escaped += "\\n"; break;
+            default: escaped += c;
+        }
+    }
+    return escaped;
+}
+
+// {a="1",b="2"}, with an optional extra label appended (le for buckets)
+std::string render_labels(const Labels& labels, const std::string& extra_name = "",
+                          const std::string& extra_value = "") {
+    if (labels.empty() && extra_name.empty()) {
+        return "";
+    }
+    std::string out = "{";
+    bool first = true;
+    for (const auto& [name, value] : labels) {
+        if (!first) out += ",";
+        out += name + "=\"" + escape_label_value(value) + "\"";
+        first = false;
+    }
+    if (!extra_name.empty()) {
+        if (!first) out += ",";
+        out += extra_name + "=\"" + extra_value + "\"";
+    }
+    return out + "}";
+}
+
+std::string render_value(double value, int precision = 17) {
+    if (std::isnan(value)) return "NaN";
+    if (std::isinf(value)) return value > 0 ? "+Inf" : "-Inf";
+    std::ostringstream os;
+    os.precision(precision);
+    os << value;
+    return os.str();
+}
+
+} // namespace
+
+size_t thread_stripe() {
+    static std::atomic<size_t> next_stripe{0};
+    thread_local size_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed);
+    return stripe;
+}
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const auto& stripe : stripes_) {
+        total += stripe.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void Histogram::merge(const utils::LatencyHistogram& local) {
+    Stripe& stripe = stripes_[thread_stripe() % STRIPES];
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    stripe.histogram.merge(local);
+}
+
+utils::LatencyHistogram Histogram::snapshot() const {
+    utils::LatencyHistogram merged;
+    for (const auto& stripe : stripes_) {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        merged.merge(stripe.histogram);
+    }
+    return merged;
+}
+
+const std::vector<double>& MetricsRegistry::histogram_bounds() {
+    // 1-2.5-5 steps from 1 us to 10 s
+    static const std::vector<double> bounds = [] {
+        std::vector<double> b;
+        for (double decade = 1e-6; decade < 10.0; decade *= 10.0) {
+            b.push_back(decade);
+            b.push_back(decade * 2.5);
+            b.push_back(decade * 5.0);
+        }
+        b.push_back(10.0);
+        return b;
+    }();
+    return bounds;
+}
+
+MetricsRegistry::Series& MetricsRegistry::series(const std::string& name, const std::string& help,
+                                                 Type type, const Labels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto [it, inserted] = families_.try_emplace(name);
+    Family& family = it->second;
+    if (inserted) {
+        family.help = help;
+        family.type = type;
+    } else if (family.type != type) {
+        throw std::runtime_error("Metric " + name + " already registered with another type");
+    }
+    for (auto& s : family.series) {
+        if (s->labels == labels) {
+            return *s;
+        }
+    }
+
+    auto s = std::make_unique<Series>();
+    s->labels = labels;
+    switch (type) {
+        case Type::COUNTER: s->counter = std::make_unique<Counter>(); break;
+        case Type::GAUGE: s->gauge = std::make_unique<Gauge>(); break;
+        case Type::HISTOGRAM: s->histogram = std::make_unique<Histogram>(); break;
+    }
+    family.series.push_back(std::move(s));
+    return *family.series.back();
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const Labels& labels) {
+    return *series(name, help, Type::COUNTER, labels).counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const Labels& labels) {
+    return *series(name, help, Type::GAUGE, labels).gauge;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help, const Labels& labels) {
+    return *series(name, help, Type::HISTOGRAM, labels).histogram;
+}
+
+std::string MetricsRegistry::render() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream os;
+
+    for (const auto& [name, family] : families_) {
+        os << "# HELP " << name << " " << family.help << "\n";
+        switch (family.type) {
+            case Type::COUNTER: os << "# TYPE " << name << " counter\n"; break;
+            case Type::GAUGE: os << "# TYPE " << name << " gauge\n"; break;
+            case Type::HISTOGRAM: os << "# TYPE " << name << " histogram\n"; break;
+        }
+
+        for (const auto& series : family.series) {
+            const Series& s = *series;
+            if (s.counter) {
+                os << name << render_labels(s.labels) << " " << s.counter->value() << "\n";
+            } else if (s.gauge) {
+                os << name << render_labels(s.labels) << " " << render_value(s.gauge->value()) << "\n";
+            } else {
+                utils::LatencyHistogram snapshot = s.histogram->snapshot();
+
+                // Cumulative counts of the recording buckets that end at or
+                // below each bound
+                std::vector<uint64_t> cumulative(histogram_bounds().size(), 0);
+                snapshot.for_each_bucket([&](uint64_t, uint64_t upper, uint64_t count) {
+                    double upper_seconds = static_cast<double>(upper) * 1e-9;
+                    for (size_t b = 0; b < cumulative.size(); ++b) {
+                        if (upper_seconds <= histogram_bounds()[b]) {
+                            cumulative[b] += count;
+                        }
+                    }
+                });
+                for (size_t b = 0; b < cumulative.size(); ++b) {
+                    os << name << "_bucket" << render_labels(s.labels, "le", render_value(histogram_bounds()[b], 6))
+                       << " " << cumulative[b] << "\n";
+                }
+                os << name << "_bucket" << render_labels(s.labels, "le", "+Inf") << " " << snapshot.count() << "\n";
+                os << name << "_sum" << render_labels(s.labels) << " "
+                   << render_value(snapshot.mean() * static_cast<double>(snapshot.count()) * 1e-9) << "\n";
+                os << name << "_count" << render_labels(s.labels) << " " << snapshot.count() << "\n";
+            }
+        }
+    }
+    return os.str();
+}
+
+} // namespace metrics
+} // namespace s1see
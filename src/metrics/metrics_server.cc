@@ -0,0 +1,167 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: metrics_server.cc
+ * Description: Implementation of MetricsServer on POSIX sockets.
+ */
+
+#include "s1see/metrics/metrics_server.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace s1see {
+namespace metrics {
+
+namespace {
+
+void send_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return;
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
+
+std::string response(const char* status, const char* content_type, const std::string& body) {
+    return std::string("HTTP/1.1 ") + status + "\r\n"
+           "Content-Type: " + content_type + "\r\n"
+           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+           "Connection: close\r\n\r\n" + body;
+}
+
+} // namespace
+
+MetricsServer::MetricsServer(std::shared_ptr<MetricsRegistry> registry, const Config& config)
+    : registry_(std::move(registry)), config_(config) {}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start() {
+    if (running_) {
+        return true;
+    }
+    
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "Metrics server: socket failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    int reuse = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config_.port);
+    if (::inet_pton(AF_INET, config_.bind_address.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "Metrics server: invalid address " << config_.bind_address << std::endl;
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd_, 16) != 0) {
+        std::cerr << "Metrics server: cannot listen on " << config_.bind_address << ":" << config_.port
+                  << ": " << std::strerror(errno) << std::endl;
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    
+    socklen_t len = sizeof(addr);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    bound_port_ = ntohs(addr.sin_port);
+    
+    running_ = true;
+    thread_ = std::thread(&MetricsServer::serve_loop, this);
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+}
+
+void MetricsServer::serve_loop() {
+    while (running_) {
+        // Poll with a timeout so stop() is noticed without closing the
+        // socket under a blocked accept()
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, 200);
+        if (ready <= 0) {
+            continue;
+        }
+        int fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+        handle_connection(fd);
+        ::close(fd);
+    }
+}
+
+void MetricsServer::handle_connection(int fd) {
+    // A slow or idle client must not stall the next scrape for long
+    timeval timeout{1, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        request.append(buffer, static_cast<size_t>(n));
+    }
+    
+    // Request line: METHOD SP target SP version; query strings are ignored
+    size_t method_end = request.find(' ');
+    size_t target_end = method_end == std::string::npos ? std::string::npos : request.find(' ', method_end + 1);
+    if (target_end == std::string::npos) {
+        send_all(fd, response("400 Bad Request", "text/plain", "Bad request\n"));
+        return;
+    }
+    std::string method = request.substr(0, method_end);
+    std::string target = request.substr(method_end + 1, target_end - method_end - 1);
+    target = target.substr(0, target.find('?'));
+    
+    if (method != "GET") {
+        send_all(fd, response("405 Method Not Allowed", "text/plain", "Method not allowed\n"));
+    } else if (target != config_.path) {
+        send_all(fd, response("404 Not Found", "text/plain", "Not found\n"));
+    } else {
+        if (collect_hook_) {
+            collect_hook_();
+        }
+        send_all(fd, response("200 OK", "text/plain; version=0.0.4; charset=utf-8", registry_->render()));
+    }
+}
+
+} // namespace metrics
+} // namespace s1see
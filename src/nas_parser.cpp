@@ -11,7 +11,9 @@
  */
 
 #include "nas_parser.h"
+#include "s1see/utils/codec.h"
 #include <algorithm>
+#include <array>
 #include <sstream>
 #include <iomanip>
 #include <cctype>
@@ -478,26 +480,10 @@ std::string decodeTbcdImsi(const uint8_t* bytes, size_t len, bool start_from_upp
     }
 
     // Extract remaining digits from bytes 1 onwards
-    // TBCD: low nibble first, then high nibble
-    for (size_t i = 1; i < len; ++i) {
-        uint8_t byte = bytes[i];
-        uint8_t digit1 = byte & 0x0F;  // Low nibble
-        uint8_t digit2 = (byte >> 4) & 0x0F;  // High nibble
-
-        if (digit1 <= 9) {
-            digits.push_back('0' + digit1);
-        } else {
-            // 0xF indicates padding/end
-            break;
-        }
-
-        if (digit2 <= 9) {
-            digits.push_back('0' + digit2);
-        } else {
-            // 0xF indicates padding/end
-            break;
-        }
-    }
+    // TBCD: low nibble first, then high nibble, up to the 0xF filler
+    size_t first_digits = digits.size();
+    digits.resize(first_digits + 2 * (len - 1));
+    digits.resize(first_digits + s1see::utils::tbcd_decode(bytes + 1, len - 1, digits.data() + first_digits));
     
     // Handle odd/even length indicator
     // If is_odd_length is true, the last digit is in the upper nibble of the last byte
@@ -576,29 +562,30 @@ std::string decodeTmsi(const uint8_t* bytes, size_t len, bool start_from_upper_n
               << " (high=0x" << std::hex << static_cast<unsigned>(first_byte_high) << std::dec
               << ", low=0x" << std::hex << static_cast<unsigned>(first_byte_low) << std::dec << ")" << std::endl;
 
-    std::ostringstream oss;
-    oss << std::hex << std::setfill('0');
+    // Two bytes from the first byte's nibbles, then up to three more
+    uint8_t tmsi_bytes[5];
+    size_t n = 0;
 
     if (start_from_upper_nibble) {
         // Start decoding from upper nibble of first byte (identity type byte)
         // Upper nibble contains the first byte of TMSI
-        oss << std::setw(2) << static_cast<unsigned>(first_byte_high);
+        tmsi_bytes[n++] = first_byte_high;
         DEBUG_LOG << "[NAS] decodeTmsi: First byte from upper nibble: 0x" << std::hex 
                   << static_cast<unsigned>(first_byte_high) << std::dec << std::endl;
         
         // Lower nibble contains the second byte of TMSI
-        oss << std::setw(2) << static_cast<unsigned>(first_byte_low);
+        tmsi_bytes[n++] = first_byte_low;
         DEBUG_LOG << "[NAS] decodeTmsi: Second byte from lower nibble: 0x" << std::hex 
                   << static_cast<unsigned>(first_byte_low) << std::dec << std::endl;
     } else {
         // Start decoding from lower nibble of first byte
-        oss << std::setw(2) << static_cast<unsigned>(first_byte_low);
+        tmsi_bytes[n++] = first_byte_low;
         DEBUG_LOG << "[NAS] decodeTmsi: First byte from lower nibble: 0x" << std::hex 
                   << static_cast<unsigned>(first_byte_low) << std::dec << std::endl;
         
         // Upper nibble may contain second byte
         if (first_byte_high <= 0x0F) {
-            oss << std::setw(2) << static_cast<unsigned>(first_byte_high);
+            tmsi_bytes[n++] = first_byte_high;
             DEBUG_LOG << "[NAS] decodeTmsi: Second byte from upper nibble: 0x" << std::hex 
                       << static_cast<unsigned>(first_byte_high) << std::dec << std::endl;
         }
@@ -608,7 +595,7 @@ std::string decodeTmsi(const uint8_t* bytes, size_t len, bool start_from_upper_n
     // TMSI is typically 4 bytes total, so we need 2-3 more bytes after the first byte
     for (size_t i = 1; i < len && i < 4; ++i) {
         uint8_t byte = bytes[i];
-        oss << std::setw(2) << static_cast<unsigned>(byte);
+        tmsi_bytes[n++] = byte;
         DEBUG_LOG << "[NAS] decodeTmsi: Byte " << i << ": 0x" << std::hex 
                   << static_cast<unsigned>(byte) << std::dec << std::endl;
     }
@@ -620,8 +607,7 @@ std::string decodeTmsi(const uint8_t* bytes, size_t len, bool start_from_upper_n
         DEBUG_LOG << "[NAS] decodeTmsi: Even length indicator - TMSI has even number of bytes" << std::endl;
     }
 
-    std::string tmsi = oss.str();
-    std::transform(tmsi.begin(), tmsi.end(), tmsi.begin(), ::tolower);
+    std::string tmsi = s1see::utils::to_hex(std::span<const uint8_t>(tmsi_bytes, n));
     
     DEBUG_LOG << "[NAS] decodeTmsi: Decoded TMSI: " << tmsi << std::endl;
 
@@ -684,13 +670,7 @@ std::pair<MobileIdentityType, std::string> decodeEpsMobileIdentity(const uint8_t
         // GUTI contains M-TMSI (last 4 bytes)
         if (len >= 5) {
             // Extract M-TMSI (last 4 bytes of GUTI)
-            std::ostringstream oss;
-            oss << std::hex << std::setfill('0');
-            for (size_t i = len - 4; i < len; ++i) {
-                oss << std::setw(2) << static_cast<unsigned>(bytes[i]);
-            }
-            std::string m_tmsi = oss.str();
-            std::transform(m_tmsi.begin(), m_tmsi.end(), m_tmsi.begin(), ::tolower);
+            std::string m_tmsi = s1see::utils::to_hex(std::span<const uint8_t>(bytes + len - 4, 4));
             return {MobileIdentityType::TMSI, m_tmsi};
         }
     } else if (lower_3_bits == 4) { // TMSI
@@ -800,13 +780,8 @@ std::vector<MobileIdentity> decodeStructuredNas(const uint8_t* nas_bytes, size_t
                 size_t tmsi_start = i + (pattern_len - 1) + tmsi_offset;
                 if (tmsi_start + tmsi_len <= ciphered_len) {
                     // Convert 4 bytes to hex string
-                    std::ostringstream oss;
-                    oss << std::hex << std::setfill('0');
-                    for (size_t k = 0; k < tmsi_len; ++k) {
-                        oss << std::setw(2) << static_cast<unsigned>(ciphered_data[tmsi_start + k]);
-                    }
-                    std::string tmsi = oss.str();
-                    std::transform(tmsi.begin(), tmsi.end(), tmsi.begin(), ::tolower);
+                    std::string tmsi = s1see::utils::to_hex(
+                        std::span<const uint8_t>(ciphered_data + tmsi_start, tmsi_len));
                     
                     DEBUG_LOG << "[NAS] decodeStructuredNas: Extracted TMSI from pattern: " << tmsi 
                               << " (from offset " << (ciphered_start + tmsi_start) << ")" << std::endl;
@@ -1408,68 +1383,57 @@ std::string getProtocolDiscriminatorName(ProtocolDiscriminator pd) {
     }
 }
 
-std::string getMessageTypeName(uint8_t message_type, ProtocolDiscriminator pd) {
-    if (pd == ProtocolDiscriminator::EPS_MOBILITY_MANAGEMENT) {
-        switch (message_type) {
-            case static_cast<uint8_t>(EMMessageType::IDENTITY_REQUEST):
-                return "Identity Request";
-            case static_cast<uint8_t>(EMMessageType::IDENTITY_RESPONSE):
-                return "Identity Response";
-            case static_cast<uint8_t>(EMMessageType::AUTHENTICATION_REQUEST):
-                return "Authentication Request";
-            case static_cast<uint8_t>(EMMessageType::AUTHENTICATION_RESPONSE):
-                return "Authentication Response";
-            case static_cast<uint8_t>(EMMessageType::AUTHENTICATION_REJECT):
-                return "Authentication Reject";
-            case static_cast<uint8_t>(EMMessageType::AUTHENTICATION_FAILURE):
-                return "Authentication Failure";
-            case static_cast<uint8_t>(EMMessageType::SECURITY_MODE_COMMAND):
-                return "Security Mode Command";
-            case static_cast<uint8_t>(EMMessageType::SECURITY_MODE_COMPLETE):
-                return "Security Mode Complete";
-            case static_cast<uint8_t>(EMMessageType::SECURITY_MODE_REJECT):
-                return "Security Mode Reject";
-            case static_cast<uint8_t>(EMMessageType::ATTACH_REQUEST):
-                return "Attach Request";
-            case static_cast<uint8_t>(EMMessageType::ATTACH_ACCEPT):
-                return "Attach Accept";
-            case static_cast<uint8_t>(EMMessageType::ATTACH_REJECT):
-                return "Attach Reject";
-            case static_cast<uint8_t>(EMMessageType::ATTACH_COMPLETE):
-                return "Attach Complete";
-            case static_cast<uint8_t>(EMMessageType::DETACH_REQUEST):
-                return "Detach Request";
-            case static_cast<uint8_t>(EMMessageType::DETACH_ACCEPT):
-                return "Detach Accept";
-            case static_cast<uint8_t>(EMMessageType::TRACKING_AREA_UPDATE_REQUEST):
-                return "Tracking Area Update Request";
-            case static_cast<uint8_t>(EMMessageType::TRACKING_AREA_UPDATE_ACCEPT):
-                return "Tracking Area Update Accept";
-            case static_cast<uint8_t>(EMMessageType::TRACKING_AREA_UPDATE_REJECT):
-                return "Tracking Area Update Reject";
-            case static_cast<uint8_t>(EMMessageType::TRACKING_AREA_UPDATE_COMPLETE):
-                return "Tracking Area Update Complete";
-            case static_cast<uint8_t>(EMMessageType::SERVICE_REQUEST):
-                return "Service Request";
-            case static_cast<uint8_t>(EMMessageType::EXTENDED_SERVICE_REQUEST):
-                return "Extended Service Request";
-            case static_cast<uint8_t>(EMMessageType::GUTI_REALLOCATION_COMMAND):
-                return "GUTI Reallocation Command";
-            case static_cast<uint8_t>(EMMessageType::GUTI_REALLOCATION_COMPLETE):
-                return "GUTI Reallocation Complete";
-            case static_cast<uint8_t>(EMMessageType::EMM_STATUS):
-                return "EMM Status";
-            case static_cast<uint8_t>(EMMessageType::EMM_INFORMATION):
-                return "EMM Information";
-            default:
-                return "Unknown EMM Message";
+namespace {
+    struct EmmMessageName {
+        EMMessageType type;
+        std::string_view name;
+    };
+
+    // Indexed by EMM message type; types not listed are empty
+    constexpr std::array<std::string_view, 256> EMM_MESSAGE_NAMES = [] {
+        constexpr EmmMessageName names[] = {
+            {EMMessageType::IDENTITY_REQUEST, "Identity Request"},
+            {EMMessageType::IDENTITY_RESPONSE, "Identity Response"},
+            {EMMessageType::AUTHENTICATION_REQUEST, "Authentication Request"},
+            {EMMessageType::AUTHENTICATION_RESPONSE, "Authentication Response"},
+            {EMMessageType::AUTHENTICATION_REJECT, "Authentication Reject"},
+            {EMMessageType::AUTHENTICATION_FAILURE, "Authentication Failure"},
+            {EMMessageType::SECURITY_MODE_COMMAND, "Security Mode Command"},
+            {EMMessageType::SECURITY_MODE_COMPLETE, "Security Mode Complete"},
+            {EMMessageType::SECURITY_MODE_REJECT, "Security Mode Reject"},
+            {EMMessageType::ATTACH_REQUEST, "Attach Request"},
+            {EMMessageType::ATTACH_ACCEPT, "Attach Accept"},
+            {EMMessageType::ATTACH_REJECT, "Attach Reject"},
+            {EMMessageType::ATTACH_COMPLETE, "Attach Complete"},
+            {EMMessageType::DETACH_REQUEST, "Detach Request"},
+            {EMMessageType::DETACH_ACCEPT, "Detach Accept"},
+            {EMMessageType::TRACKING_AREA_UPDATE_REQUEST, "Tracking Area Update Request"},
+            {EMMessageType::TRACKING_AREA_UPDATE_ACCEPT, "Tracking Area Update Accept"},
+            {EMMessageType::TRACKING_AREA_UPDATE_REJECT, "Tracking Area Update Reject"},
+            {EMMessageType::TRACKING_AREA_UPDATE_COMPLETE, "Tracking Area Update Complete"},
+            {EMMessageType::SERVICE_REQUEST, "Service Request"},
+            {EMMessageType::EXTENDED_SERVICE_REQUEST, "Extended Service Request"},
+            {EMMessageType::GUTI_REALLOCATION_COMMAND, "GUTI Reallocation Command"},
+            {EMMessageType::GUTI_REALLOCATION_COMPLETE, "GUTI Reallocation Complete"},
+            {EMMessageType::EMM_STATUS, "EMM Status"},
+            {EMMessageType::EMM_INFORMATION, "EMM Information"},
+        };
+        std::array<std::string_view, 256> table{};
+        for (const auto& entry : names) {
+            table[static_cast<uint8_t>(entry.type)] = entry.name;
         }
+        return table;
+    }();
+} // anonymous namespace
+
+std::string_view getMessageTypeName(uint8_t message_type, ProtocolDiscriminator pd) {
+    if (pd == ProtocolDiscriminator::EPS_MOBILITY_MANAGEMENT) {
+        std::string_view name = EMM_MESSAGE_NAMES[message_type];
+        return name.empty() ? "Unknown EMM Message" : name;
     } else if (pd == ProtocolDiscriminator::EPS_SESSION_MANAGEMENT) {
-        return "ESM Message (type 0x" + 
-               std::to_string(static_cast<unsigned>(message_type)) + ")";
+        return "ESM Message";
     } else {
-        return "Unknown Protocol Message (type 0x" + 
-               std::to_string(static_cast<unsigned>(message_type)) + ")";
+        return "Unknown Protocol Message";
     }
 }
 
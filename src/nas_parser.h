@@ -40,6 +40,7 @@
 #endif
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstdint>
 #include <cstddef>
@@ -203,7 +204,7 @@ std::vector<MobileIdentity> decodeStructuredNas(const uint8_t* nas_bytes, size_t
 // Helper functions to get human-readable names
 std::string getSecurityHeaderTypeName(SecurityHeaderType type);
 std::string getProtocolDiscriminatorName(ProtocolDiscriminator pd);
-std::string getMessageTypeName(uint8_t message_type, ProtocolDiscriminator pd);
+std::string_view getMessageTypeName(uint8_t message_type, ProtocolDiscriminator pd);
 std::string getMobileIdentityTypeName(MobileIdentityType type);
 
 // Dump decoded NAS message to output stream (or std::cout)
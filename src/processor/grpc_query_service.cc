@@ -0,0 +1,123 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: grpc_query_service.cc
+ * Description: Implementation of GrpcUeQueryService.
+ */
+
+#include "s1see/processor/grpc_query_service.h"
+#include <grpcpp/server_builder.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace s1see {
+namespace processor {
+
+GrpcUeQueryService::GrpcUeQueryService(const Pipeline& pipeline, const Config& config)
+    : pipeline_(pipeline), config_(config) {
+    config_.max_page_size = std::max<uint32_t>(config_.max_page_size, 1);
+    config_.default_page_size = std::clamp<uint32_t>(config_.default_page_size, 1, config_.max_page_size);
+}
+
+GrpcUeQueryService::~GrpcUeQueryService() {
+    stop();
+}
+
+bool GrpcUeQueryService::start() {
+    if (running_.exchange(true)) {
+        return false; // Already running
+    }
+
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort(config_.listen_address, grpc::InsecureServerCredentials(), &port_);
+    builder.RegisterService(this);
+
+    server_ = builder.BuildAndStart();
+    if (!server_ || port_ == 0) {
+        std::cerr << "GrpcUeQueryService: failed to listen on " << config_.listen_address << std::endl;
+        server_.reset();
+        running_ = false;
+        return false;
+    }
+    return true;
+}
+
+void GrpcUeQueryService::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    server_->Shutdown(std::chrono::system_clock::now() + std::chrono::seconds(1));
+    server_.reset();
+}
+
+grpc::Status GrpcUeQueryService::Lookup(grpc::ServerContext* /*context*/, const UeLookupRequest* request,
+                                        UeRecord* response) {
+    correlate::UeLookup lookup;
+    switch (request->identifier_case()) {
+        case UeLookupRequest::kImsi:
+            lookup.kind = correlate::UeLookup::Kind::IMSI;
+            lookup.identifier = request->imsi();
+            break;
+        case UeLookupRequest::kTmsi:
+            lookup.kind = correlate::UeLookup::Kind::TMSI;
+            lookup.identifier = request->tmsi();
+            break;
+        case UeLookupRequest::kTeid:
+            lookup.kind = correlate::UeLookup::Kind::TEID;
+            lookup.value = request->teid();
+            break;
+        case UeLookupRequest::kMmeUeS1ApId:
+            lookup.kind = correlate::UeLookup::Kind::MME_UE_S1AP_ID;
+            lookup.value = request->mme_ue_s1ap_id();
+            break;
+        default:
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "no identifier given");
+    }
+
+    auto context = pipeline_.find_ue(lookup);
+    if (!context) {
+        return grpc::Status(grpc::StatusCode::NOT_FOUND, "no live UE holds that identifier");
+    }
+    to_record(*context, *response);
+    return grpc::Status::OK;
+}
+
+grpc::Status GrpcUeQueryService::ListCell(grpc::ServerContext* /*context*/, const CellQuery* request,
+                                          UePage* response) {
+    if (request->ecgi().empty()) {
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "ecgi is required");
+    }
+    uint32_t page_size = request->page_size() == 0 ? config_.default_page_size
+                                                   : std::min(request->page_size(), config_.max_page_size);
+
+    auto page = pipeline_.list_cell(request->ecgi(), request->page_token(), page_size);
+    response->mutable_ues()->Reserve(static_cast<int>(page.ues.size()));
+    for (const auto& context : page.ues) {
+        to_record(*context, *response->add_ues());
+    }
+    response->set_next_page_token(page.next_page_token);
+    return grpc::Status::OK;
+}
+
+void GrpcUeQueryService::to_record(const correlate::UEContext& context, UeRecord& record) {
+    record.set_subscriber_key(context.subscriber_key);
+    if (context.imsi) record.set_imsi(*context.imsi);
+    if (context.tmsi) record.set_tmsi(*context.tmsi);
+    if (context.guti) record.set_guti(*context.guti);
+    if (context.imei) record.set_imei(*context.imei);
+    if (context.mme_ue_s1ap_id) record.set_mme_ue_s1ap_id(*context.mme_ue_s1ap_id);
+    if (context.enb_ue_s1ap_id) record.set_enb_ue_s1ap_id(*context.enb_ue_s1ap_id);
+    if (context.enb_id) record.set_enb_id(*context.enb_id);
+    if (context.mme_id) record.set_mme_id(*context.mme_id);
+    record.set_ecgi(context.ecgi);
+    record.set_target_ecgi(context.target_ecgi);
+    record.set_last_procedure(context.last_procedure);
+    record.set_last_seen(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        context.last_seen.time_since_epoch()).count());
+}
+
+} // namespace processor
+} // namespace s1see
@@ -16,12 +16,17 @@
 #include <chrono>
 #include <iostream>
 #include <cctype>
+#include <algorithm>
+#include <limits>
+#include <span>
+#include <filesystem>
 #include "spool_record.pb.h"
 
 namespace s1see {
 namespace processor {
 
-Pipeline::Pipeline(const Config& config) : config_(config) {
+Pipeline::Pipeline(const Config& config)
+    : config_(config), decode_level_(config.decode_level) {
     spool::WALLog::Config wal_config;
     wal_config.base_dir = config_.spool_base_dir;
     wal_config.num_partitions = config_.spool_partitions;
@@ -29,12 +34,75 @@ Pipeline::Pipeline(const Config& config) : config_(config) {
     
     correlate::Correlator::Config corr_config;
     corr_config.context_expiry = config_.context_expiry;
-    correlator_ = std::make_shared<correlate::Correlator>(corr_config);
+    corr_config.event_time = config_.event_time;
     
-    rule_engine_ = std::make_unique<rules::RuleEngine>(correlator_);
+    rules::RuleEngine::Config rule_config;
+    rule_config.event_time = config_.event_time;
+    rule_config.emit_aggregates = false;  // Merged over shards (emit_aggregate_windows)
+    partition_time_ns_.assign(std::max<int32_t>(config_.spool_partitions, 0), 0);
+    
+    size_t num_shards = config_.parallel ? std::max<size_t>(config_.num_shards, 1) : 1;
+    shards_.resize(num_shards);
+    for (size_t s = 0; s < num_shards; ++s) {
+        shards_[s].correlator = std::make_shared<correlate::Correlator>(corr_config);
+        rule_config.shard = static_cast<uint32_t>(s);
+        shards_[s].rule_engine = std::make_unique<rules::RuleEngine>(shards_[s].correlator, rule_config);
+    }
+    
+    if (config_.parallel) {
+        worker_pool_ = std::make_unique<utils::ThreadPool>(
+            std::max(config_.worker_threads, num_shards));
+    }
     
     // Use real S1AP decoder (s1ap_parser)
     decoder_ = std::make_unique<decode::RealS1APDecoder>();
+    
+    if (config_.batch_arena) {
+        google::protobuf::ArenaOptions options;
+        arena_block_.resize(std::max<size_t>(config_.arena_block_bytes, 256));
+        options.initial_block = arena_block_.data();
+        options.initial_block_size = arena_block_.size();
+        arena_ = std::make_unique<google::protobuf::Arena>(options);
+    }
+    
+    last_snapshot_ = std::chrono::steady_clock::now();
+    if (config_.group_membership && !config_.snapshot_path.empty()) {
+        // A snapshot holds every partition's offsets and state, and members
+        // own changing subsets of them
+        std::cerr << "Ignoring snapshot_path: snapshots are not taken with consumer group membership" << std::endl;
+        config_.snapshot_path.clear();
+    }
+    bool replay = config_.replay_from_ns > 0 || config_.replay_to_ns > 0;
+    if (replay && !config_.snapshot_path.empty()) {
+        // A snapshot's offsets are the live group's, not the range's
+        std::cerr << "Ignoring snapshot_path: snapshots are not taken in replay mode" << std::endl;
+        config_.snapshot_path.clear();
+    }
+    if (!config_.snapshot_path.empty()) {
+        load_snapshot();
+    }
+    spool::SpoolCursor::Config cursor_config;
+    cursor_config.chunk_records = config_.spool_read_chunk;
+    for (int32_t p = 0; p < config_.spool_partitions; ++p) {
+        read_offsets_.push_back(spool_->load_offset(config_.consumer_group, p));
+        if (replay) {
+            read_offsets_.back() = std::max(read_offsets_.back(), spool_->seek_by_time(p, config_.replay_from_ns));
+            replay_end_.push_back(config_.replay_to_ns > 0 ? spool_->seek_by_time(p, config_.replay_to_ns)
+                                                           : spool_->get_high_water_mark(p) + 1);
+        }
+        cursors_.push_back(spool_->cursor(p, read_offsets_.back(), cursor_config));
+    }
+    
+    if (config_.group_membership) {
+        spool::ConsumerGroup::Config group_config;
+        group_config.base_dir = config_.spool_base_dir;
+        group_config.group = config_.consumer_group;
+        group_config.member_id = config_.member_id;
+        group_config.num_partitions = config_.spool_partitions;
+        group_config.lease_duration = config_.lease_duration;
+        group_ = std::make_unique<spool::ConsumerGroup>(group_config);
+        maybe_heartbeat(true);
+    }
 }
 
 void Pipeline::set_decoder(std::unique_ptr<decode::S1APDecoderWrapper> decoder) {
@@ -42,24 +110,167 @@ void Pipeline::set_decoder(std::unique_ptr<decode::S1APDecoderWrapper> decoder)
 }
 
 void Pipeline::load_ruleset(const rules::Ruleset& ruleset) {
-    rule_engine_->load_ruleset(ruleset);
+    // Compiled once; the shards share the result
+    std::vector<rules::Ruleset> rulesets = shards_.front().rule_engine->rules()->rulesets;
+    rulesets.push_back(ruleset);
+    auto compiled = rules::RuleEngine::compile(std::move(rulesets));
+    for (auto& shard : shards_) {
+        shard.rule_engine->install_rules(compiled);
+    }
+    update_decode_level();
+}
+
+void Pipeline::reload_rulesets(std::vector<rules::Ruleset> rulesets) {
+    auto compiled = rules::RuleEngine::compile(std::move(rulesets));
+    {
+        std::lock_guard<std::mutex> lock(reload_mutex_);
+        pending_rules_ = std::move(compiled);
+    }
+    rules_pending_.store(true, std::memory_order_release);
+}
+
+void Pipeline::install_pending_rules() {
+    if (!rules_pending_.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::shared_ptr<const rules::RuleEngine::CompiledRules> compiled;
+    {
+        std::lock_guard<std::mutex> lock(reload_mutex_);
+        compiled = std::move(pending_rules_);
+        rules_pending_.store(false, std::memory_order_relaxed);
+    }
+    if (!compiled) {
+        return;
+    }
+    // No shard is evaluating between batches
+    for (auto& shard : shards_) {
+        shard.rule_engine->install_rules(compiled);
+    }
+    update_decode_level();
+    ruleset_reloads_.fetch_add(1, std::memory_order_relaxed);
 }
 
 void Pipeline::add_sink(std::shared_ptr<sinks::Sink> sink) {
     sinks_.push_back(sink);
+    update_decode_level();
 }
 
-CanonicalMessage Pipeline::decode_and_normalize(const SpoolRecord& record) {
-    CanonicalMessage canonical;
+void Pipeline::update_decode_level() {
+    sink_decode_level_ = decode::DecodeLevel::IDENTIFIERS;
+    for (const auto& sink : sinks_) {
+        sink_decode_level_ = std::max(sink_decode_level_, sink->decode_level());
+    }
+    decode_level_ = std::max({config_.decode_level, sink_decode_level_,
+                              shards_.front().rule_engine->decode_level()});
+}
+
+void Pipeline::set_metrics(std::shared_ptr<metrics::MetricsRegistry> registry) {
+    metrics_ = std::move(registry);
+    if (!metrics_) {
+        return;
+    }
+    
+    const std::string latency_help =
+        "Pipeline stage latency (per message for decode, correlate and rules; per call for spool_read and sink_emit)";
+    const std::string items_help = "Records through each pipeline stage (events for sink_emit)";
+    auto stage = [&](const char* name) {
+        StageMetrics stage_metrics;
+        stage_metrics.latency = &metrics_->histogram("s1see_stage_latency_seconds", latency_help, {{"stage", name}});
+        stage_metrics.items = &metrics_->counter("s1see_stage_items_total", items_help, {{"stage", name}});
+        return stage_metrics;
+    };
+    spool_read_metrics_ = stage("spool_read");
+    decode_metrics_ = stage("decode");
+    correlate_metrics_ = stage("correlate");
+    rules_metrics_ = stage("rules");
+    sink_metrics_ = stage("sink_emit");
+    
+    decode_failures_ = &metrics_->counter("s1see_decode_failures_total", "Records the decoder could not decode");
+    processing_errors_ = &metrics_->counter("s1see_processing_errors_total",
+                                            "Records dropped after an exception in decode, correlation or rules");
+    ue_contexts_gauge_ = &metrics_->gauge("s1see_ue_contexts", "Live UE contexts, over all shards");
+    sequence_states_gauge_ = &metrics_->gauge("s1see_sequence_states", "Pending sequence rule states, over all shards");
+    watermark_gauge_ = &metrics_->gauge("s1see_event_time_watermark_seconds", "Event-time watermark (Unix time)");
+    pending_commits_gauge_ = &metrics_->gauge("s1see_pending_commits",
+                                              "Partition batches whose commit waits for sink delivery");
     
+    consumer_lag_gauges_.clear();
+    wal_segment_gauges_.clear();
+    for (int32_t p = 0; p < config_.spool_partitions; ++p) {
+        metrics::Labels labels = {{"partition", std::to_string(p)}};
+        consumer_lag_gauges_.push_back(&metrics_->gauge(
+            "s1see_consumer_lag_records", "Records appended but not yet committed by the consumer group",
+            {{"group", config_.consumer_group}, {"partition", std::to_string(p)}}));
+        wal_segment_gauges_.push_back(&metrics_->gauge(
+            "s1see_wal_segments", "WAL segments on disk, per partition", labels));
+    }
+    update_gauges();
+}
+
+void Pipeline::update_gauges() {
+    if (!metrics_) {
+        return;
+    }
+    size_t contexts = 0;
+    size_t sequences = 0;
+    for (const auto& shard : shards_) {
+        contexts += shard.correlator->context_count();
+        sequences += shard.rule_engine->sequence_state_count();
+    }
+    ue_contexts_gauge_->set(static_cast<double>(contexts));
+    sequence_states_gauge_->set(static_cast<double>(sequences));
+    watermark_gauge_->set(static_cast<double>(watermark_ns_) * 1e-9);
+    pending_commits_gauge_->set(static_cast<double>(pending_commits_.size()));
+    
+    for (int32_t p = 0; p < config_.spool_partitions; ++p) {
+        // The high-water mark is the last offset written; the committed
+        // offset is the next one to process. Other members report the
+        // partitions they own, so the group's lag is the sum.
+        int64_t lag = spool_->get_high_water_mark(p) + 1 - spool_->load_offset(config_.consumer_group, p);
+        consumer_lag_gauges_[p]->set(reads_partition(p) ? static_cast<double>(std::max<int64_t>(lag, 0)) : 0.0);
+        wal_segment_gauges_[p]->set(static_cast<double>(spool_->segment_count(p)));
+    }
+}
+
+spool::SpoolCursor& Pipeline::cursor_for(int32_t partition) {
+    // A restored snapshot moves the read offsets
+    spool::SpoolCursor& cursor = cursors_[partition];
+    if (cursor.position() != read_offsets_[partition]) {
+        cursor.seek(read_offsets_[partition]);
+    }
+    return cursor;
+}
+
+std::span<const SpoolRecord> Pipeline::read_chunk(spool::SpoolCursor& cursor, size_t max_messages) {
+    // Timed only when the cursor goes to the spool for another chunk
+    metrics::ScopedTimer timer(cursor.buffered() == 0 ? spool_read_metrics_.latency : nullptr);
+    auto records = cursor.next_chunk(max_messages);
+    if (spool_read_metrics_.items) {
+        spool_read_metrics_.items->add(records.size());
+    }
+    return records;
+}
+
+CanonicalMessage* Pipeline::new_message(CanonicalMessage& local) {
+    if (arena_) {
+        return google::protobuf::Arena::CreateMessage<CanonicalMessage>(arena_.get());
+    }
+    return &local;
+}
+
+void Pipeline::decode_and_normalize(const SpoolRecord& record, CanonicalMessage& canonical,
+                                    decode::DecodedTree& decoded_tree) {
     // Set spool reference
     canonical.set_spool_partition(record.partition());
     canonical.set_spool_offset(record.offset());
     
     const auto& message = record.message();
+    canonical.set_ts_capture(message.ts_capture());
     
-    // Extract frame number from transport_meta if present (for PCAP sources)
-    if (!message.transport_meta().empty()) {
+    // Frame number for PCAP sources; older spools carry it only in transport_meta
+    if (message.frame_number() != 0) {
+        canonical.set_frame_number(message.frame_number());
+    } else if (!message.transport_meta().empty()) {
         // Parse JSON: {"pcap": true, "packet_num": <number>}
         std::string meta = message.transport_meta();
         size_t pos = meta.find("\"packet_num\"");
@@ -82,94 +293,629 @@ CanonicalMessage Pipeline::decode_and_normalize(const SpoolRecord& record) {
         }
     }
     
-    // Decode
-    decode::DecodedTree decoded_tree;
-    std::vector<uint8_t> raw_bytes(message.raw_bytes().begin(), message.raw_bytes().end());
+    // Decode straight from the spool record's bytes. decoded_tree.parse_result
+    // may view those bytes, so the record must outlive its processing.
+    decode::S1APDecoderWrapper::Options options;
+    options.embed_raw_bytes = config_.embed_raw_bytes;
+    options.level = decode_level_;
+    std::span<const uint8_t> raw_bytes(reinterpret_cast<const uint8_t*>(message.raw_bytes().data()),
+                                       message.raw_bytes().size());
+    
+    bool decode_ok;
+    {
+        metrics::ScopedTimer timer(decode_metrics_.latency);
+        decode_ok = decoder_->decode(raw_bytes, canonical, decoded_tree, options);
+    }
+    if (decode_metrics_.items) {
+        decode_metrics_.items->add();
+        if (!decode_ok) {
+            decode_failures_->add();
+        }
+    }
     
-    bool decode_ok = decoder_->decode(raw_bytes, canonical, decoded_tree);
+    // Preserve raw bytes, unless the decoder already embedded them
+    if (config_.embed_raw_bytes && canonical.raw_bytes().empty()) {
+        canonical.set_raw_bytes(message.raw_bytes());
+    }
     
     if (!decode_ok) {
         canonical.set_decode_failed(true);
-        canonical.set_raw_bytes(message.raw_bytes());
-        return canonical;
+        return;
     }
     
-    // Preserve raw bytes
-    canonical.set_raw_bytes(message.raw_bytes());
-    canonical.set_decoded_tree(decoded_tree.json_representation);
+    if (decode_level_ >= decode::DecodeLevel::FULL_TREE && canonical.decoded_tree().empty()) {
+        canonical.set_decoded_tree(decoded_tree.json_representation);
+    }
+}
+
+std::vector<Event> Pipeline::process_message(Shard& shard, const CanonicalMessage& canonical,
+                                             const s1ap_parser::S1apParseResult* parse_result) {
+    // Resolve the subscriber once, then run the rules against it; the two
+    // stages are timed separately
+    correlate::SubscriberId subscriber_id;
+    {
+        metrics::ScopedTimer timer(correlate_metrics_.latency);
+        subscriber_id = shard.correlator->get_or_create_subscriber(canonical, parse_result);
+    }
+    metrics::ScopedTimer timer(rules_metrics_.latency);
+    std::vector<Event> events = shard.rule_engine->evaluate(canonical, subscriber_id);
+    if (rules_metrics_.items) {
+        correlate_metrics_.items->add();
+        rules_metrics_.items->add();
+    }
+    add_message_detail(canonical, events);
+    return events;
+}
+
+void Pipeline::add_message_detail(const CanonicalMessage& canonical, std::vector<Event>& events) const {
+    if (sink_decode_level_ == decode::DecodeLevel::IDENTIFIERS || events.empty()) {
+        return;
+    }
+    for (auto& event : events) {
+        auto& attributes = *event.mutable_attributes();
+        for (const auto& ie : canonical.information_elements()) {
+            const std::string& value = ie.value();
+            attributes["ie." + s1ap_parser::ieDisplayName(static_cast<uint16_t>(ie.id()))] =
+                s1ap_parser::ieValueHex(std::span<const uint8_t>(
+                    reinterpret_cast<const uint8_t*>(value.data()), value.size()));
+        }
+        if (sink_decode_level_ >= decode::DecodeLevel::FULL_TREE && !canonical.decoded_tree().empty()) {
+            attributes["decoded_tree"] = canonical.decoded_tree();
+        }
+    }
+}
+
+size_t Pipeline::shard_for(const SpoolRecord& record, const CanonicalMessage& canonical) {
+    if (shards_.size() == 1) {
+        return 0;
+    }
+    
+    // Fibonacci hashing spreads sequential IDs evenly across shards
+    auto spread = [this](uint64_t key) {
+        key *= 0x9E3779B97F4A7C15ULL;
+        return static_cast<uint32_t>((key >> 32) % shards_.size());
+    };
     
-    return canonical;
+    // MME-UE-S1AP-ID first: the MME keeps it for the UE's whole S1
+    // connection, across handovers. An eNB-UE-S1AP-ID is only unique within
+    // its eNB and changes on handover, so it is paired with the eNB's SCTP
+    // association (or source), and a pair seen beside an MME ID follows it.
+    // That keeps InitialUEMessage, sent before the MME has assigned its ID,
+    // with the rest of the connection.
+    const SignalMessage& signal = record.message();
+    std::optional<uint32_t> mme_ue_id;
+    std::optional<uint64_t> enb_ue_key;
+    if (canonical.mme_ue_s1ap_id() != 0) {
+        mme_ue_id = static_cast<uint32_t>(canonical.mme_ue_s1ap_id());
+    }
+    if (canonical.enb_ue_s1ap_id() != 0) {
+        uint64_t enb = signal.sctp_association() != 0 ? signal.sctp_association()
+                                                      : std::hash<std::string>{}(signal.source_id());
+        enb_ue_key = (enb * 0x9E3779B97F4A7C15ULL) ^ static_cast<uint32_t>(canonical.enb_ue_s1ap_id());
+    }
+    
+    uint32_t shard = 0;
+    auto mme_it = mme_ue_id ? mme_affinity_.find(*mme_ue_id) : mme_affinity_.end();
+    auto enb_it = enb_ue_key ? enb_affinity_.find(*enb_ue_key) : enb_affinity_.end();
+    if (mme_it != mme_affinity_.end()) {
+        shard = mme_it->second;
+    } else if (enb_it != enb_affinity_.end()) {
+        shard = enb_it->second;
+    } else if (mme_ue_id) {
+        shard = spread((2ULL << 32) | *mme_ue_id);
+    } else if (enb_ue_key) {
+        shard = spread(*enb_ue_key);
+    } else if (!canonical.tmsi().empty()) {
+        return spread(std::hash<std::string>{}(canonical.tmsi()));
+    } else if (!canonical.imsi().empty()) {
+        return spread(std::hash<std::string>{}(canonical.imsi()));
+    } else {
+        return 0; // Non-UE-associated signalling
+    }
+    
+    // The connection's IDs are free for reuse once it is released
+    if (canonical.msg_type() == "UEContextReleaseComplete") {
+        if (mme_it != mme_affinity_.end()) mme_affinity_.erase(mme_it);
+        if (enb_it != enb_affinity_.end()) enb_affinity_.erase(enb_it);
+        return shard;
+    }
+    if (mme_ue_id) {
+        mme_affinity_[*mme_ue_id] = shard;
+    }
+    if (enb_ue_key) {
+        enb_affinity_[*enb_ue_key] = shard;
+    }
+    return shard;
+}
+
+void Pipeline::update_watermark(const std::vector<int64_t>& batch_time_ns) {
+    if (!config_.event_time) {
+        return;
+    }
+    
+    // Slowest partition that delivered records; caught-up partitions do
+    // not hold the watermark back
+    int64_t slowest = std::numeric_limits<int64_t>::max();
+    for (size_t p = 0; p < batch_time_ns.size(); ++p) {
+        if (batch_time_ns[p] <= 0) {
+            continue;
+        }
+        partition_time_ns_[p] = std::max(partition_time_ns_[p], batch_time_ns[p]);
+        slowest = std::min(slowest, partition_time_ns_[p]);
+    }
+    if (slowest == std::numeric_limits<int64_t>::max()) {
+        return;
+    }
+    
+    int64_t watermark = slowest - std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      config_.allowed_lateness).count();
+    if (watermark <= watermark_ns_) {
+        return;
+    }
+    watermark_ns_ = watermark;
+    for (auto& shard : shards_) {
+        shard.correlator->advance_watermark(watermark_ns_);
+        shard.rule_engine->advance_watermark(watermark_ns_);
+    }
+}
+
+void Pipeline::emit_events(const std::vector<Event>& events) {
+    if (events.empty()) {
+        return;
+    }
+    metrics::ScopedTimer timer(sink_metrics_.latency);
+    for (auto& sink : sinks_) {
+        sink->emit_batch(events);
+    }
+    if (sink_metrics_.items) {
+        sink_metrics_.items->add(events.size());
+    }
 }
 
-std::vector<Event> Pipeline::process_message(const CanonicalMessage& canonical) {
-    // Run rules - this will call get_or_create_context internally
-    // No need to call update_context separately as it would duplicate the work
-    return rule_engine_->process(canonical);
+void Pipeline::commit_when_delivered(int32_t partition, int64_t next_offset) {
+    PendingCommit commit{partition, next_offset, {}};
+    commit.accepted.reserve(sinks_.size());
+    for (const auto& sink : sinks_) {
+        commit.accepted.push_back(sink->accepted_sequence());
+    }
+    pending_commits_.push_back(std::move(commit));
+    commit_delivered();
+}
+
+size_t Pipeline::commit_delivered() {
+    // Batches complete in order, so only the oldest can be next
+    while (!pending_commits_.empty()) {
+        const PendingCommit& commit = pending_commits_.front();
+        for (size_t s = 0; s < sinks_.size(); ++s) {
+            if (sinks_[s]->delivered_sequence() < commit.accepted[s]) {
+                return pending_commits_.size();
+            }
+        }
+        spool_->commit_offset(config_.consumer_group, commit.partition, commit.next_offset);
+        pending_commits_.pop_front();
+    }
+    return 0;
+}
+
+void Pipeline::maybe_heartbeat(bool force) {
+    auto now = std::chrono::steady_clock::now();
+    if (!group_ || (!force && now - last_heartbeat_ < config_.lease_duration / 3)) {
+        return;
+    }
+    last_heartbeat_ = now;
+    
+    // A partition is handed over only once its read records are committed,
+    // so the next owner starts where this one stopped
+    auto can_release = [this](int32_t partition) {
+        commit_delivered();
+        return std::none_of(pending_commits_.begin(), pending_commits_.end(),
+                            [partition](const PendingCommit& commit) { return commit.partition == partition; });
+    };
+    spool::ConsumerGroup::Assignment assignment;
+    try {
+        assignment = group_->heartbeat(can_release);
+    } catch (const std::exception& e) {
+        std::cerr << "Consumer group heartbeat failed: " << e.what() << std::endl;
+        return;
+    }
+    
+    for (int32_t p : assignment.lost) {
+        // Taken over after our lease ran out: the new owner commits now
+        pending_commits_.erase(std::remove_if(pending_commits_.begin(), pending_commits_.end(),
+                                              [p](const PendingCommit& commit) { return commit.partition == p; }),
+                               pending_commits_.end());
+    }
+    for (int32_t p : assignment.gained) {
+        if (p < config_.spool_partitions) {
+            read_offsets_[p] = spool_->reload_offset(config_.consumer_group, p);
+            if (!replay_end_.empty()) {
+                read_offsets_[p] = std::max(read_offsets_[p], spool_->seek_by_time(p, config_.replay_from_ns));
+            }
+        }
+    }
+    if (assignment.changed()) {
+        std::cout << "Consumer group " << config_.consumer_group << ": member " << group_->member_id()
+                  << " of " << group_->members().size() << " owns partitions";
+        for (int32_t p : group_->owned_partitions()) {
+            std::cout << " " << p;
+        }
+        std::cout << std::endl;
+    }
 }
 
 int Pipeline::process_batch(int64_t max_messages) {
+    maybe_heartbeat();
+    install_pending_rules();
+    
+    // Back-pressure: stop reading while sinks are this far behind
+    if (commit_delivered() >= std::max<size_t>(config_.max_pending_commits, 1)) {
+        update_gauges();
+        return 0;
+    }
+    int events = config_.parallel ? process_batch_parallel(max_messages)
+                                  : process_batch_serial(max_messages);
+    events += emit_aggregate_windows();
+    // The sinks have copied or written out the events by now, and nothing
+    // else refers to the batch's messages
+    if (arena_) {
+        arena_->Reset();
+    }
+    maybe_write_snapshot();
+    update_gauges();
+    return events;
+}
+
+int Pipeline::emit_aggregate_windows() {
+    // Each shard counts its own UEs' messages; one engine merges the
+    // shards' panes, closed at the same time, so a window is summarized once
+    int64_t now = shards_.front().rule_engine->now_ns();
+    std::vector<rules::AggregatePane> panes;
+    for (auto& shard : shards_) {
+        shard.rule_engine->close_windows(now);
+        shard.rule_engine->take_closed_panes(panes);
+    }
+    auto events = shards_.front().rule_engine->merge_panes(std::move(panes), now);
+    emit_events(events);
+    return static_cast<int>(events.size());
+}
+
+void Pipeline::maybe_write_snapshot() {
+    // State is snapshotted with the committed offsets, so it must not be
+    // ahead of them
+    if (config_.snapshot_path.empty() || !pending_commits_.empty() ||
+        std::chrono::steady_clock::now() - last_snapshot_ < config_.snapshot_interval) {
+        return;
+    }
+    try {
+        write_snapshot();
+    } catch (const std::exception& e) {
+        std::cerr << "Snapshot failed: " << e.what() << std::endl;
+    }
+    last_snapshot_ = std::chrono::steady_clock::now();
+}
+
+void Pipeline::write_snapshot() {
+    snapshot::SnapshotWriter writer(static_cast<uint32_t>(shards_.size()));
+    writer.set_watermark(watermark_ns_);
+    for (int32_t p = 0; p < config_.spool_partitions; ++p) {
+        snapshot::OffsetEntry entry{};
+        entry.partition = p;
+        entry.next_offset = spool_->load_offset(config_.consumer_group, p);
+        entry.partition_time_ns = partition_time_ns_[p];
+        writer.add_record(snapshot::SectionKind::OFFSETS, 0, entry);
+    }
+    for (size_t s = 0; s < shards_.size(); ++s) {
+        shards_[s].correlator->save_snapshot(writer, static_cast<uint32_t>(s));
+        shards_[s].rule_engine->save_snapshot(writer, static_cast<uint32_t>(s));
+    }
+    writer.write(config_.snapshot_path);
+}
+
+bool Pipeline::load_snapshot() {
+    if (!std::filesystem::exists(config_.snapshot_path)) {
+        return false;
+    }
+    try {
+        snapshot::SnapshotReader reader(config_.snapshot_path);
+        // UE keys are routed by hash modulo the shard count, so state is
+        // only valid with the shard layout it was written with
+        if (reader.shard_count() != shards_.size()) {
+            std::cerr << "Ignoring snapshot " << config_.snapshot_path << ": written with "
+                      << reader.shard_count() << " shards, running with " << shards_.size() << std::endl;
+            return false;
+        }
+        for (size_t s = 0; s < shards_.size(); ++s) {
+            shards_[s].correlator->load_snapshot(reader, static_cast<uint32_t>(s));
+            shards_[s].rule_engine->load_snapshot(reader, static_cast<uint32_t>(s));
+        }
+        
+        // Records after the snapshot's offsets are replayed; events emitted
+        // for them before the restart are emitted again
+        for (const auto& entry : reader.records<snapshot::OffsetEntry>(snapshot::SectionKind::OFFSETS, 0)) {
+            if (entry.partition < 0 || entry.partition >= config_.spool_partitions) {
+                continue;
+            }
+            spool_->commit_offset(config_.consumer_group, entry.partition, entry.next_offset);
+            partition_time_ns_[entry.partition] = entry.partition_time_ns;
+            if (static_cast<size_t>(entry.partition) < read_offsets_.size()) {
+                read_offsets_[entry.partition] = entry.next_offset;
+            }
+        }
+        watermark_ns_ = reader.watermark();
+        std::cout << "Restored snapshot " << config_.snapshot_path << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Ignoring snapshot: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+int Pipeline::process_batch_serial(int64_t max_messages) {
     int events_emitted = 0;
+    Shard& shard = shards_.front();
+    std::vector<int64_t> batch_time_ns(config_.spool_partitions, 0);
     
     // Process each partition
     for (int32_t p = 0; p < config_.spool_partitions; ++p) {
-        // Load consumer offset
-        int64_t offset = spool_->load_offset(config_.consumer_group, p);
-        int64_t high_water = spool_->get_high_water_mark(p);
+        if (!reads_partition(p)) {
+            continue;
+        }
+        int64_t offset = read_offsets_[p];
+        int64_t limit = read_limit(p);
         
-        if (offset >= high_water) {
+        if (offset > limit) {
             continue; // Nothing new
         }
         
-        // Read batch
-        auto records = spool_->read(p, offset, max_messages);
-        
-        int64_t last_offset = offset;
-        for (const auto& record : records) {
-            try {
-                // Decode and normalize
-                auto canonical = decode_and_normalize(record);
-                
-                // Process through rules
-                auto events = process_message(canonical);
-                
-                // Emit events
-                for (const auto& event : events) {
-                    for (auto& sink : sinks_) {
-                        sink->emit(event);
+        // Stream the batch a chunk at a time
+        spool::SpoolCursor& cursor = cursor_for(p);
+        size_t remaining = static_cast<size_t>(std::clamp<int64_t>(max_messages, 0, limit - offset + 1));
+        int64_t last_offset = -1;
+        while (remaining > 0) {
+            auto records = read_chunk(cursor, remaining);
+            if (records.empty()) {
+                break;
+            }
+            remaining -= records.size();
+            last_offset = records.back().offset();
+            
+            for (const auto& record : records) {
+                batch_time_ns[p] = std::max(batch_time_ns[p], record.message().ts_capture());
+                try {
+                    // Decode and normalize
+                    decode::DecodedTree decoded_tree;
+                    CanonicalMessage local;
+                    CanonicalMessage& canonical = *new_message(local);
+                    decode_and_normalize(record, canonical, decoded_tree);
+                    
+                    // Process through rules
+                    auto events = process_message(shard, canonical,
+                                                  decoded_tree.parse_result ? &*decoded_tree.parse_result : nullptr);
+                    
+                    // Emit events
+                    emit_events(events);
+                    events_emitted += static_cast<int>(events.size());
+                } catch (const std::exception& e) {
+                    std::cerr << "Error processing record p=" << p 
+                             << " offset=" << record.offset() << ": " << e.what() << std::endl;
+                    if (processing_errors_) {
+                        processing_errors_->add();
                     }
-                    events_emitted++;
                 }
-                
-                last_offset = record.offset();
-            } catch (const std::exception& e) {
-                std::cerr << "Error processing record p=" << p 
-                         << " offset=" << record.offset() << ": " << e.what() << std::endl;
             }
         }
-        
-        // Commit offset
-        if (last_offset > offset) {
-            spool_->commit_offset(config_.consumer_group, p, last_offset);
+        if (last_offset < 0) {
+            continue;
         }
+        
+        // Commit once the sinks have the batch's events
+        read_offsets_[p] = last_offset + 1;
+        commit_when_delivered(p, read_offsets_[p]);
     }
     
     // Cleanup
-    correlator_->cleanup_expired();
-    rule_engine_->cleanup_expired_sequences();
+    update_watermark(batch_time_ns);
+    shard.correlator->cleanup_expired();
+    shard.rule_engine->cleanup_expired_sequences();
     
     return events_emitted;
 }
 
+int Pipeline::process_batch_parallel(int64_t max_messages) {
+    // Read one batch per partition; items keep (partition, offset) order
+    struct Item {
+        const SpoolRecord* record = nullptr;
+        CanonicalMessage* canonical = nullptr;  // In the batch arena, or `local`
+        CanonicalMessage local;
+        decode::DecodedTree decoded_tree;
+        bool decoded = false;
+        std::vector<Event> events;
+    };
+    std::vector<std::span<const SpoolRecord>> batches(config_.spool_partitions);
+    std::vector<Item> items;
+    std::vector<int64_t> batch_time_ns(config_.spool_partitions, 0);
+    
+    for (int32_t p = 0; p < config_.spool_partitions; ++p) {
+        if (!reads_partition(p)) {
+            continue; // Another member's
+        }
+        int64_t offset = read_offsets_[p];
+        int64_t limit = read_limit(p);
+        if (offset > limit) {
+            continue; // Nothing new
+        }
+        batches[p] = read_chunk(cursor_for(p),
+                                static_cast<size_t>(std::clamp<int64_t>(max_messages, 0, limit - offset + 1)));
+        for (const auto& record : batches[p]) {
+            items.emplace_back();
+            items.back().record = &record;
+            batch_time_ns[p] = std::max(batch_time_ns[p], record.message().ts_capture());
+        }
+    }
+    if (items.empty()) {
+        return 0;
+    }
+    
+    // Stage 1: decode is stateless, so any worker takes any record
+    worker_pool_->parallel_for(items.size(), [&](size_t i) {
+        try {
+            // Arena allocation is thread-safe
+            items[i].canonical = new_message(items[i].local);
+            decode_and_normalize(*items[i].record, *items[i].canonical, items[i].decoded_tree);
+            items[i].decoded = true;
+        } catch (const std::exception& e) {
+            std::cerr << "Error decoding record p=" << items[i].record->partition()
+                     << " offset=" << items[i].record->offset() << ": " << e.what() << std::endl;
+            if (processing_errors_) {
+                processing_errors_->add();
+            }
+        }
+    });
+    
+    // Stage 2: route by UE key; each shard handles its records in spool order
+    std::vector<std::vector<size_t>> shard_items(shards_.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (items[i].decoded) {
+            shard_items[shard_for(*items[i].record, *items[i].canonical)].push_back(i);
+        }
+    }
+    
+    // Shards clean up against this batch's watermark
+    update_watermark(batch_time_ns);
+    
+    worker_pool_->parallel_for(shards_.size(), [&](size_t s) {
+        Shard& shard = shards_[s];
+        for (size_t i : shard_items[s]) {
+            try {
+                const auto& parse_result = items[i].decoded_tree.parse_result;
+                items[i].events = process_message(shard, *items[i].canonical,
+                                                  parse_result ? &*parse_result : nullptr);
+            } catch (const std::exception& e) {
+                std::cerr << "Error processing record p=" << items[i].record->partition()
+                         << " offset=" << items[i].record->offset() << ": " << e.what() << std::endl;
+                if (processing_errors_) {
+                    processing_errors_->add();
+                }
+            }
+        }
+        shard.correlator->cleanup_expired();
+        shard.rule_engine->cleanup_expired_sequences();
+    });
+    
+    // Stage 3: reorder. Emit in spool order, then commit each partition past
+    // its last record once the sinks have its events; every record of the
+    // batch has completed by now, so commits only ever move forward.
+    int events_emitted = 0;
+    for (const auto& item : items) {
+        emit_events(item.events);
+        events_emitted += static_cast<int>(item.events.size());
+    }
+    for (int32_t p = 0; p < config_.spool_partitions; ++p) {
+        if (!batches[p].empty()) {
+            read_offsets_[p] = batches[p].back().offset() + 1;
+            commit_when_delivered(p, read_offsets_[p]);
+        }
+    }
+    
+    return events_emitted;
+}
+
+bool Pipeline::has_pending_records() {
+    // Nothing is read while the commit queue is full
+    if (pending_commits_.size() >= std::max<size_t>(config_.max_pending_commits, 1)) {
+        return false;
+    }
+    for (int32_t p = 0; p < config_.spool_partitions; ++p) {
+        if (reads_partition(p) && read_offsets_[p] <= read_limit(p)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int64_t Pipeline::read_limit(int32_t partition) {
+    int64_t high_water = spool_->get_high_water_mark(partition);
+    return replay_end_.empty() ? high_water : std::min(high_water, replay_end_[partition] - 1);
+}
+
+bool Pipeline::replay_done() const {
+    if (replay_end_.empty()) {
+        return false;
+    }
+    for (int32_t p = 0; p < config_.spool_partitions; ++p) {
+        if (reads_partition(p) && read_offsets_[p] < replay_end_[p]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Pipeline::wait_for_data(std::chrono::milliseconds timeout) {
+    // Take the sequence first: an append that lands after the pending
+    // check changes it, so the wait cannot miss it
+    uint32_t seen = spool_->append_sequence();
+    if (has_pending_records()) {
+        return true;
+    }
+    return spool_->wait_for_appends(seen, timeout);
+}
+
 void Pipeline::run_continuous() {
     while (true) {
         process_batch();
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        wait_for_data(std::chrono::milliseconds(1000));
     }
 }
 
 void Pipeline::dump_ue_records(std::ostream& os) const {
-    if (correlator_) {
-        correlator_->dump_ue_records(os);
+    for (const auto& shard : shards_) {
+        if (shard.correlator) {
+            shard.correlator->dump_ue_records(os);
+        }
+    }
+}
+
+std::shared_ptr<const correlate::UEContext> Pipeline::find_ue(const correlate::UeLookup& lookup) const {
+    // Each S1 connection is sharded on its own, so a UE seen over several
+    // can have a context in more than one shard; the latest answers
+    std::shared_ptr<const correlate::UEContext> found;
+    for (const auto& shard : shards_) {
+        auto context = shard.correlator->find_context(lookup);
+        if (context && (!found || context->last_seen > found->last_seen)) {
+            found = std::move(context);
+        }
+    }
+    return found;
+}
+
+Pipeline::UePage Pipeline::list_cell(const std::string& ecgi, uint64_t page_token, size_t page_size) const {
+    // Token: shard in the top 16 bits, last context ID returned below
+    constexpr int kShardShift = 48;
+    constexpr uint64_t kIdMask = (uint64_t{1} << kShardShift) - 1;
+    
+    UePage page;
+    size_t shard = static_cast<size_t>(page_token >> kShardShift);
+    correlate::SubscriberId after = page_token & kIdMask;
+    for (; shard < shards_.size() && page.ues.size() < page_size; ++shard, after = 0) {
+        auto cell = shards_[shard].correlator->list_cell(ecgi, after, page_size - page.ues.size());
+        page.ues.insert(page.ues.end(), std::make_move_iterator(cell.contexts.begin()),
+                        std::make_move_iterator(cell.contexts.end()));
+        if (cell.next_after != 0) {
+            page.next_page_token = (static_cast<uint64_t>(shard) << kShardShift) | cell.next_after;
+            return page;
+        }
+    }
+    if (shard < shards_.size()) {
+        page.next_page_token = static_cast<uint64_t>(shard) << kShardShift;
+    }
+    return page;
+}
+
+void Pipeline::dump_memory_usage(std::ostream& os) const {
+    for (const auto& shard : shards_) {
+        if (shard.correlator) {
+            shard.correlator->dump_memory_usage(os);
+        }
     }
 }
 
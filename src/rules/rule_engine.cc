@@ -11,171 +11,777 @@
  */
 
 #include "s1see/rules/rule_engine.h"
+#include "s1see/utils/codec.h"
 #include <algorithm>
+#include <cmath>
 #include <iostream>
-#include <sstream>
-#include <iomanip>
+#include <cstring>
+#include <string_view>
 #include "spool_record.pb.h"
 
 namespace s1see {
 namespace rules {
 
-// Helper function to convert bytes (std::string) to hex string
-static std::string bytes_to_hex_string(const std::string& bytes) {
-    if (bytes.empty()) {
-        return "";
+// Sequence states older than this are dropped
+constexpr auto max_sequence_age = std::chrono::seconds(60); // 1 minute max
+
+// FNV-1a over a length-prefixed string, chained. Stable across builds,
+// so fingerprints can be kept in snapshots.
+static uint64_t fingerprint_append(uint64_t hash, std::string_view bytes) {
+    uint64_t length = bytes.size();
+    for (size_t i = 0; i < sizeof(length); ++i) {
+        hash = (hash ^ ((length >> (8 * i)) & 0xFF)) * 0x100000001b3ULL;
+    }
+    for (unsigned char c : bytes) {
+        hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Identity of a sequence rule within its ruleset: two rules with the same
+// fingerprint are treated as the same rule by reloads and snapshots
+static uint64_t sequence_fingerprint(const std::string& ruleset_id, const SequenceRule& rule,
+                                     const std::vector<std::string>& steps) {
+    uint64_t hash = fingerprint_append(0xcbf29ce484222325ULL, ruleset_id);
+    hash = fingerprint_append(hash, rule.event_name);
+    for (const auto& step : steps) {
+        hash = fingerprint_append(hash, step);
+    }
+    hash = fingerprint_append(hash, std::to_string(rule.time_window.count()));
+    for (const auto& [key, value] : rule.attributes) {
+        hash = fingerprint_append(fingerprint_append(hash, key), value);
     }
-    std::ostringstream hex;
-    hex << std::hex << std::setfill('0');
-    for (unsigned char byte : bytes) {
-        hex << std::setw(2) << static_cast<int>(byte);
+    for (const auto& extraction : rule.event_data) {
+        hash = fingerprint_append(hash, extraction.target_attribute);
+        hash = fingerprint_append(hash, extraction.source_expression);
     }
-    return hex.str();
+    return hash;
 }
 
-RuleEngine::RuleEngine(std::shared_ptr<correlate::Correlator> correlator)
-    : correlator_(correlator) {
+// Identity of an aggregate rule within its ruleset, as for sequence rules
+static uint64_t aggregate_fingerprint(const std::string& ruleset_id, const AggregateRule& rule) {
+    uint64_t hash = fingerprint_append(0xcbf29ce484222325ULL, ruleset_id);
+    hash = fingerprint_append(hash, rule.event_name);
+    hash = fingerprint_append(hash, std::to_string(static_cast<int>(rule.function)) + "/" +
+                                        std::to_string(static_cast<int>(rule.key)));
+    for (const auto& msg_type : rule.msg_types) {
+        hash = fingerprint_append(hash, msg_type);
+    }
+    hash = fingerprint_append(hash, "/");
+    for (const auto& msg_type : rule.total_msg_types) {
+        hash = fingerprint_append(hash, msg_type);
+    }
+    hash = fingerprint_append(hash, std::to_string(rule.window.count()) + "/" + std::to_string(rule.slide.count()));
+    hash = fingerprint_append(hash, rule.threshold ? std::to_string(*rule.threshold) : "");
+    hash = fingerprint_append(hash, std::to_string(rule.min_total));
+    for (const auto& [key, value] : rule.attributes) {
+        hash = fingerprint_append(fingerprint_append(hash, key), value);
+    }
+    return hash;
+}
+
+// splitmix64 finalizer, for HyperLogLog hashes of subscriber IDs
+static uint64_t mix(uint64_t key) {
+    key ^= key >> 30;
+    key *= 0xBF58476D1CE4E5B9ULL;
+    key ^= key >> 27;
+    key *= 0x94D049BB133111EBULL;
+    return key ^ (key >> 31);
+}
+
+// Value a captured step holds for field, if one was kept
+static std::string_view captured_value(const std::string& captured, uint8_t step, ExtractionField field) {
+    constexpr size_t header = 2 * sizeof(uint8_t) + sizeof(uint32_t);
+    std::string_view values = captured;
+    while (values.size() >= header) {
+        uint32_t length;
+        std::memcpy(&length, values.data() + 2, sizeof(length));
+        if (static_cast<uint8_t>(values[0]) == step && static_cast<uint8_t>(values[1]) == static_cast<uint8_t>(field)) {
+            return values.substr(header, length);
+        }
+        values.remove_prefix(header + length);
+    }
+    return {};
+}
+
+// Render a message field as event data
+static std::string message_field_value(ExtractionField field, const CanonicalMessage& message) {
+    switch (field) {
+        case ExtractionField::ECGI:
+            return utils::to_hex(message.ecgi());
+        case ExtractionField::TARGET_ECGI:
+            return utils::to_hex(message.target_ecgi());
+        case ExtractionField::MME_UE_S1AP_ID:
+            return message.mme_ue_s1ap_id() != 0 ? std::to_string(message.mme_ue_s1ap_id()) : "";
+        case ExtractionField::ENB_UE_S1AP_ID:
+            return message.enb_ue_s1ap_id() != 0 ? std::to_string(message.enb_ue_s1ap_id()) : "";
+        case ExtractionField::IMSI:
+            return message.imsi();
+        case ExtractionField::TMSI:
+            return message.tmsi();
+        case ExtractionField::MSG_TYPE:
+            return message.msg_type();
+        case ExtractionField::DECODED_TREE:
+            return message.decoded_tree();
+        default:
+            return "";
+    }
+}
+
+CompiledExtraction compile_extraction(const EventDataExtraction& extraction) {
+    static const std::unordered_map<std::string, ExtractionSource> sources = {
+        {"message", ExtractionSource::MESSAGE},
+        {"first_message", ExtractionSource::FIRST_MESSAGE},
+        {"context", ExtractionSource::CONTEXT},
+    };
+    constexpr std::string_view step_prefix = "step";
+    static const std::unordered_map<std::string, ExtractionField> fields = {
+        {"ecgi", ExtractionField::ECGI},
+        {"target_ecgi", ExtractionField::TARGET_ECGI},
+        {"source_ecgi", ExtractionField::SOURCE_ECGI},
+        {"mme_ue_s1ap_id", ExtractionField::MME_UE_S1AP_ID},
+        {"enb_ue_s1ap_id", ExtractionField::ENB_UE_S1AP_ID},
+        {"imsi", ExtractionField::IMSI},
+        {"tmsi", ExtractionField::TMSI},
+        {"msg_type", ExtractionField::MSG_TYPE},
+        {"decoded_tree", ExtractionField::DECODED_TREE},
+    };
+    
+    CompiledExtraction compiled;
+    compiled.target_attribute = extraction.target_attribute;
+    
+    // Parse expression: "message.field" or "first_message.field" or "context.field"
+    const std::string& expression = extraction.source_expression;
+    size_t dot_pos = expression.find('.');
+    if (dot_pos == std::string::npos) {
+        return compiled; // Invalid expression
+    }
+    std::string source = expression.substr(0, dot_pos);
+    auto source_it = sources.find(source);
+    if (source_it != sources.end()) {
+        compiled.source = source_it->second;
+    } else if (source.size() > step_prefix.size() && source.compare(0, step_prefix.size(), step_prefix) == 0 &&
+               source.size() <= step_prefix.size() + 2 &&
+               std::all_of(source.begin() + step_prefix.size(), source.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        // "stepN", N from 1
+        size_t step = std::stoul(source.substr(step_prefix.size()));
+        if (step >= 1 && step <= kMaxSequenceSteps) {
+            compiled.source = ExtractionSource::STEP;
+            compiled.step = static_cast<uint8_t>(step - 1);
+        }
+    }
+    auto field_it = fields.find(expression.substr(dot_pos + 1));
+    if (field_it != fields.end()) {
+        compiled.field = field_it->second;
+    }
+    return compiled;
+}
+
+std::vector<std::string> sequence_steps(const SequenceRule& rule) {
+    if (!rule.steps.empty()) {
+        return rule.steps;
+    }
+    return {rule.first_msg_type, rule.second_msg_type};
+}
+
+RuleEngine::RuleEngine(std::shared_ptr<correlate::Correlator> correlator,
+                       const Config& config)
+    : config_(config), correlator_(correlator), rules_(compile({})) {
 }
 
 void RuleEngine::load_ruleset(const Ruleset& ruleset) {
-    rulesets_.push_back(ruleset);
+    std::vector<Ruleset> rulesets = rules_->rulesets;
+    rulesets.push_back(ruleset);
+    install_rules(compile(std::move(rulesets)));
 }
 
-std::vector<Event> RuleEngine::process(const CanonicalMessage& message) {
-    std::vector<Event> events;
+std::shared_ptr<const RuleEngine::CompiledRules> RuleEngine::compile(std::vector<Ruleset> rulesets) {
+    auto rules = std::make_shared<CompiledRules>();
+    rules->rulesets = std::move(rulesets);
+    
+    auto compile_all = [&](const std::vector<EventDataExtraction>& event_data) {
+        std::vector<CompiledExtraction> out;
+        out.reserve(event_data.size());
+        for (const auto& extraction : event_data) {
+            out.push_back(compile_extraction(extraction));
+            if (out.back().field == ExtractionField::DECODED_TREE) {
+                rules->decode_level = decode::DecodeLevel::FULL_TREE;
+            }
+        }
+        return out;
+    };
+    
+    // Rulesets are visited in order, so appending keeps each list in
+    // evaluation order
+    for (uint32_t index = 0; index < rules->rulesets.size(); ++index) {
+        const Ruleset& ruleset = rules->rulesets[index];
+        CompiledRuleset compiled;
+        for (uint32_t r = 0; r < ruleset.single_message_rules.size(); ++r) {
+            const auto& rule = ruleset.single_message_rules[r];
+            compiled.single_event_data.push_back(compile_all(rule.event_data));
+            rules->dispatch[rule.msg_type_pattern].push_back({RuleRef::Kind::SINGLE, index, r});
+        }
+        for (uint32_t r = 0; r < ruleset.sequence_rules.size(); ++r) {
+            const auto& rule = ruleset.sequence_rules[r];
+            std::vector<std::string> steps = sequence_steps(rule);
+            compiled.sequence_event_data.push_back(compile_all(rule.event_data));
+            
+            SequenceAutomaton automaton;
+            automaton.num_steps = static_cast<uint32_t>(steps.size());
+            automaton.window_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(rule.time_window).count();
+            automaton.fingerprint = sequence_fingerprint(ruleset.id, rule, steps);
+            if (steps.size() >= 2 && steps.size() <= kMaxSequenceSteps) {
+                // The last step's values are read from the message that completes it
+                automaton.captured_fields.resize(steps.size() - 1);
+                for (const auto& extraction : compiled.sequence_event_data.back()) {
+                    if ((extraction.source == ExtractionSource::FIRST_MESSAGE ||
+                         extraction.source == ExtractionSource::STEP) &&
+                        extraction.field != ExtractionField::UNKNOWN &&
+                        extraction.step < automaton.captured_fields.size()) {
+                        auto& fields = automaton.captured_fields[extraction.step];
+                        if (std::find(fields.begin(), fields.end(), extraction.field) == fields.end()) {
+                            fields.push_back(extraction.field);
+                        }
+                    }
+                }
+                
+                // One entry per distinct type, with the steps it is
+                std::vector<std::pair<std::string, uint32_t>> transitions;
+                for (uint32_t step = 0; step < steps.size(); ++step) {
+                    auto it = std::find_if(transitions.begin(), transitions.end(),
+                                           [&](const auto& t) { return t.first == steps[step]; });
+                    if (it == transitions.end()) {
+                        transitions.emplace_back(steps[step], 1u << step);
+                    } else {
+                        it->second |= 1u << step;
+                    }
+                }
+                for (const auto& [msg_type, mask] : transitions) {
+                    rules->dispatch[msg_type].push_back({RuleRef::Kind::SEQUENCE, index, r, mask});
+                }
+            }
+            compiled.sequences.push_back(std::move(automaton));
+        }
+        for (uint32_t r = 0; r < ruleset.aggregate_rules.size(); ++r) {
+            const auto& rule = ruleset.aggregate_rules[r];
+            CompiledAggregate aggregate;
+            aggregate.window_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(rule.window).count();
+            aggregate.fingerprint = aggregate_fingerprint(ruleset.id, rule);
+            int64_t pane_ns = rule.slide.count() == 0
+                                  ? aggregate.window_ns
+                                  : std::chrono::duration_cast<std::chrono::nanoseconds>(rule.slide).count();
+            // Windows must be a whole number of panes
+            if (aggregate.window_ns > 0 && pane_ns > 0 && aggregate.window_ns % pane_ns == 0 &&
+                static_cast<uint64_t>(aggregate.window_ns / pane_ns) <= kMaxWindowPanes) {
+                aggregate.pane_ns = pane_ns;
+                std::vector<std::pair<std::string, uint32_t>> roles;
+                auto add_role = [&](const std::string& msg_type, uint32_t role) {
+                    auto it = std::find_if(roles.begin(), roles.end(),
+                                           [&](const auto& entry) { return entry.first == msg_type; });
+                    if (it == roles.end()) {
+                        roles.emplace_back(msg_type, role);
+                    } else {
+                        it->second |= role;
+                    }
+                };
+                for (const auto& msg_type : rule.msg_types) {
+                    add_role(msg_type, 1u);
+                }
+                if (rule.function == AggregateRule::Function::RATIO) {
+                    for (const auto& msg_type : rule.total_msg_types) {
+                        add_role(msg_type, 2u);
+                    }
+                }
+                for (const auto& [msg_type, mask] : roles) {
+                    rules->dispatch[msg_type].push_back({RuleRef::Kind::AGGREGATE, index, r, mask});
+                }
+                rules->aggregate_index.emplace(aggregate.fingerprint, RuleRef{RuleRef::Kind::AGGREGATE, index, r, 0});
+            }
+            compiled.aggregates.push_back(aggregate);
+        }
+        rules->compiled.push_back(std::move(compiled));
+    }
+    return rules;
+}
+
+void RuleEngine::install_rules(std::shared_ptr<const CompiledRules> rules) {
+    if (!rules || rules == rules_) {
+        return;
+    }
+    rules_ = std::move(rules);
+    bind_sequences();
+}
+
+void RuleEngine::bind_sequences() {
+    std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> by_fingerprint;
+    for (uint32_t index = 0; index < rules_->compiled.size(); ++index) {
+        const auto& sequences = rules_->compiled[index].sequences;
+        for (uint32_t r = 0; r < sequences.size(); ++r) {
+            by_fingerprint.emplace(sequences[r].fingerprint, std::make_pair(index, r));
+        }
+    }
     
+    for (auto it = sequence_states_.begin(); it != sequence_states_.end();) {
+        auto& sequences = it->second;
+        auto dropped = std::remove_if(sequences.begin(), sequences.end(), [&](SequenceState& state) {
+            auto rule_it = by_fingerprint.find(state.rule_fingerprint);
+            if (rule_it == by_fingerprint.end()) {
+                // A rule that was installed has gone; an unbound state
+                // waits for its rule
+                return state.ruleset != SequenceState::UNBOUND;
+            }
+            state.ruleset = rule_it->second.first;
+            state.rule = rule_it->second.second;
+            return false;
+        });
+        sequence_state_count_ -= static_cast<size_t>(sequences.end() - dropped);
+        sequences.erase(dropped, sequences.end());
+        if (sequences.empty()) {
+            // Its expiry entry is skipped when it surfaces
+            sequence_expiry_.cancel(it->first);
+            it = sequence_states_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+decode::DecodeLevel RuleEngine::decode_level() const {
+    return rules_->decode_level;
+}
+
+std::vector<Event> RuleEngine::process(const CanonicalMessage& message,
+                                       const s1ap_parser::S1apParseResult* parse_result) {
     // Get subscriber key ONCE and cache it to avoid calling get_or_create_context multiple times
     // This prevents processS1apFrame from being called multiple times for the same message
-    std::string subscriber_key = correlator_->get_or_create_context(message);
+    return evaluate(message, correlator_->get_or_create_subscriber(message, parse_result));
+}
+
+std::vector<Event> RuleEngine::evaluate(const CanonicalMessage& message, correlate::SubscriberId subscriber_id) {
+    std::vector<Event> events;
     
-    // Check all rulesets
-    for (const auto& ruleset : rulesets_) {
-        // Check single message rules - pass subscriber_key to avoid re-calling get_or_create_context
-        auto single_events = check_single_message_rules(message, ruleset, subscriber_key);
-        events.insert(events.end(), single_events.begin(), single_events.end());
-        
-        // Check sequence rules - pass subscriber_key to avoid re-calling get_or_create_context
-        auto seq_events = check_sequence_rules(message, ruleset, subscriber_key);
-        events.insert(events.end(), seq_events.begin(), seq_events.end());
+    if (config_.event_time && message.ts_capture() > 0) {
+        clock_ns_ = std::max(clock_ns_, message.ts_capture());
+    }
+    
+    if (!rules_->rulesets.empty()) {
+        // Cleanup expired sequences first
+        cleanup_expired_sequences();
+    }
+    
+    // One lookup yields every rule this message type can fire or advance
+    auto it = rules_->dispatch.find(message.msg_type());
+    if (it == rules_->dispatch.end()) {
+        return events;
+    }
+    
+    for (const auto& ref : it->second) {
+        switch (ref.kind) {
+            case RuleRef::Kind::SINGLE:
+                events.push_back(apply_single_rule(ref, message, subscriber_id));
+                break;
+            case RuleRef::Kind::SEQUENCE:
+                advance_sequence(ref, message, subscriber_id, events);
+                break;
+            case RuleRef::Kind::AGGREGATE:
+                accumulate(ref, message, subscriber_id);
+                break;
+        }
     }
     
     return events;
 }
 
-std::vector<Event> RuleEngine::check_single_message_rules(const CanonicalMessage& message,
-                                                          const Ruleset& ruleset,
-                                                          const std::string& subscriber_key) {
-    std::vector<Event> events;
+Event RuleEngine::apply_single_rule(const RuleRef& ref,
+                                    const CanonicalMessage& message,
+                                    correlate::SubscriberId subscriber_id) {
+    const Ruleset& ruleset = rules_->rulesets[ref.ruleset];
+    const auto& rule = ruleset.single_message_rules[ref.rule];
     
-    for (const auto& rule : ruleset.single_message_rules) {
-        if (message.msg_type() == rule.msg_type_pattern) {
-            Event event = create_event(rule.event_name, message, rule.attributes,
-                                      ruleset.id, ruleset.version, subscriber_key);
-            
-            // Extract event data based on rule specifications
-            for (const auto& extraction : rule.event_data) {
-                std::string value = extract_event_data_value(extraction.source_expression, message, nullptr, subscriber_key);
-                if (!value.empty()) {
-                    (*event.mutable_attributes())[extraction.target_attribute] = value;
+    Event event = create_event(rule.event_name, message, rule.attributes,
+                              ruleset.id, ruleset.version, subscriber_id);
+    
+    // Extract event data based on rule specifications
+    for (const auto& extraction : rules_->compiled[ref.ruleset].single_event_data[ref.rule]) {
+        std::string value = extract_event_data_value(extraction, message, nullptr, subscriber_id);
+        if (!value.empty()) {
+            (*event.mutable_attributes())[extraction.target_attribute] = value;
+        }
+    }
+    
+    return event;
+}
+
+void RuleEngine::advance_sequence(const RuleRef& ref,
+                                  const CanonicalMessage& message,
+                                  correlate::SubscriberId subscriber_id,
+                                  std::vector<Event>& events) {
+    const auto& automaton = rules_->compiled[ref.ruleset].sequences[ref.rule];
+    const int64_t ts = message_time_ns(message);
+    
+    // At most one automaton per rule and subscriber
+    auto states_it = sequence_states_.find(subscriber_id);
+    if (states_it != sequence_states_.end()) {
+        auto& sequences = states_it->second;
+        for (auto it = sequences.begin(); it != sequences.end(); ++it) {
+            if (it->ruleset != ref.ruleset || it->rule != ref.rule) {
+                continue;
+            }
+            if ((ref.steps & (1u << it->steps_matched)) && ts - it->first_seen_ns <= automaton.window_ns) {
+                if (it->steps_matched + 1 == automaton.num_steps) {
+                    events.push_back(complete_sequence(ref, *it, message, subscriber_id));
+                    sequences.erase(it);
+                    sequence_state_count_--;
+                } else {
+                    capture_step(*it, automaton, message);
                 }
+            } else if (ref.steps & 1u) {
+                // Out of its window or off the pattern: a first step starts over
+                it->steps_matched = 0;
+                it->first_seen_ns = ts;
+                it->evidence.clear();
+                it->captured.clear();
+                capture_step(*it, automaton, message);
             }
-            
-            events.push_back(event);
+            return;
         }
     }
+    if (!(ref.steps & 1u)) {
+        return;
+    }
     
-    return events;
+    // Start new sequence
+    SequenceState state;
+    state.rule_fingerprint = automaton.fingerprint;
+    state.ruleset = ref.ruleset;
+    state.rule = ref.rule;
+    state.first_seen_ns = ts;
+    capture_step(state, automaton, message);
+    
+    // The oldest state sets the subscriber's deadline; later ones are
+    // picked up when it fires
+    auto& sequences = sequence_states_[subscriber_id];
+    if (sequences.empty()) {
+        sequence_expiry_.schedule(subscriber_id, ts + std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                           max_sequence_age).count());
+    }
+    sequences.push_back(std::move(state));
+    sequence_state_count_++;
+}
+
+void RuleEngine::capture_step(SequenceState& state,
+                              const SequenceAutomaton& automaton,
+                              const CanonicalMessage& message) {
+    const uint8_t step = static_cast<uint8_t>(state.steps_matched);
+    state.evidence.push_back({message.spool_partition(), message.spool_offset(), message.frame_number()});
+    for (ExtractionField field : automaton.captured_fields[step]) {
+        std::string value = message_field_value(field, message);
+        if (value.empty()) {
+            continue;
+        }
+        uint8_t code = static_cast<uint8_t>(field);
+        uint32_t length = static_cast<uint32_t>(value.size());
+        state.captured.append(reinterpret_cast<const char*>(&step), sizeof(step));
+        state.captured.append(reinterpret_cast<const char*>(&code), sizeof(code));
+        state.captured.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        state.captured.append(value);
+    }
+    state.steps_matched++;
+}
+
+Event RuleEngine::complete_sequence(const RuleRef& ref,
+                                    const SequenceState& state,
+                                    const CanonicalMessage& message,
+                                    correlate::SubscriberId subscriber_id) {
+    const Ruleset& ruleset = rules_->rulesets[ref.ruleset];
+    const auto& rule = ruleset.sequence_rules[ref.rule];
+    Event event = create_event(rule.event_name, message, rule.attributes,
+                              ruleset.id, ruleset.version, subscriber_id);
+    
+    // Extract event data based on rule specifications
+    for (const auto& extraction : rules_->compiled[ref.ruleset].sequence_event_data[ref.rule]) {
+        std::string value = extract_event_data_value(extraction, message, &state, subscriber_id);
+        if (!value.empty()) {
+            (*event.mutable_attributes())[extraction.target_attribute] = value;
+        }
+    }
+    
+    // Evidence from every step in order, the current message last
+    for (const auto& step : state.evidence) {
+        SpoolOffset offset;
+        offset.set_partition(step.partition);
+        offset.set_offset(step.offset);
+        if (step.frame_number != 0) {
+            offset.set_frame_number(step.frame_number);
+        }
+        *event.mutable_evidence()->add_offsets() = offset;
+    }
+    SpoolOffset current_offset;
+    current_offset.set_partition(message.spool_partition());
+    current_offset.set_offset(message.spool_offset());
+    if (message.frame_number() != 0) {
+        current_offset.set_frame_number(message.frame_number());
+    }
+    *event.mutable_evidence()->add_offsets() = current_offset;
+    
+    return event;
 }
 
-std::vector<Event> RuleEngine::check_sequence_rules(const CanonicalMessage& message,
-                                                     const Ruleset& ruleset,
-                                                     const std::string& subscriber_key) {
+void RuleEngine::accumulate(const RuleRef& ref,
+                            const CanonicalMessage& message,
+                            correlate::SubscriberId subscriber_id) {
+    const auto& rule = rules_->rulesets[ref.ruleset].aggregate_rules[ref.rule];
+    const auto& compiled = rules_->compiled[ref.ruleset].aggregates[ref.rule];
+    
+    PaneKey pane_key{compiled.fingerprint, {}, 0};
+    std::shared_ptr<const correlate::UEContext> context;
+    switch (rule.key) {
+        case AggregateRule::Key::ECGI:
+            if (!message.ecgi().empty()) {
+                pane_key.key = message.ecgi();
+            } else if ((context = correlator_->get_context(subscriber_id))) {
+                pane_key.key = context->ecgi;
+            }
+            break;
+        case AggregateRule::Key::ENB:
+            if (!message.enb_id().empty()) {
+                pane_key.key = message.enb_id();
+            } else if ((context = correlator_->get_context(subscriber_id)) && context->enb_id) {
+                pane_key.key = *context->enb_id;
+            }
+            break;
+        case AggregateRule::Key::MME:
+            if (!message.mme_id().empty()) {
+                pane_key.key = message.mme_id();
+            } else if ((context = correlator_->get_context(subscriber_id)) && context->mme_id) {
+                pane_key.key = *context->mme_id;
+            }
+            break;
+    }
+    if (pane_key.key.empty()) {
+        return;  // Nothing to key it by
+    }
+    
+    const int64_t ts = message_time_ns(message);
+    int64_t start = ts - ts % compiled.pane_ns;
+    if (ts < 0 && ts % compiled.pane_ns != 0) {
+        start -= compiled.pane_ns;
+    }
+    if (start + compiled.pane_ns <= windows_closed_ns_) {
+        late_aggregate_messages_++;
+        return;
+    }
+    pane_key.start_ns = start;
+    
+    auto [it, inserted] = open_panes_.try_emplace(pane_key);
+    AggregatePane& pane = it->second;
+    if (inserted) {
+        pane.rule_fingerprint = compiled.fingerprint;
+        pane.key = pane_key.key;
+        pane.start_ns = start;
+        next_pane_end_ns_ = std::min(next_pane_end_ns_, start + compiled.pane_ns);
+    }
+    if (ref.steps & 1u) {
+        pane.count++;
+        if (rule.function == AggregateRule::Function::DISTINCT_UES) {
+            pane.ues.add(mix(subscriber_id ^ (static_cast<uint64_t>(config_.shard) << 48)));
+        }
+    }
+    if (ref.steps & 2u) {
+        pane.total++;
+    }
+}
+
+std::vector<Event> RuleEngine::close_windows(int64_t now_ns) {
+    windows_closed_ns_ = std::max(windows_closed_ns_, now_ns);
+    if (now_ns >= next_pane_end_ns_) {
+        next_pane_end_ns_ = INT64_MAX;
+        for (auto it = open_panes_.begin(); it != open_panes_.end();) {
+            auto rule_it = rules_->aggregate_index.find(it->first.rule_fingerprint);
+            if (rule_it == rules_->aggregate_index.end()) {
+                it = open_panes_.erase(it);  // Its rule was reloaded away
+                continue;
+            }
+            const auto& compiled = rules_->compiled[rule_it->second.ruleset].aggregates[rule_it->second.rule];
+            int64_t end = it->first.start_ns + compiled.pane_ns;
+            if (end <= now_ns) {
+                closed_panes_.push_back(std::move(it->second));
+                it = open_panes_.erase(it);
+            } else {
+                next_pane_end_ns_ = std::min(next_pane_end_ns_, end);
+                ++it;
+            }
+        }
+    }
+    if (!config_.emit_aggregates) {
+        return {};
+    }
+    return merge_panes(std::move(closed_panes_), now_ns);
+}
+
+void RuleEngine::take_closed_panes(std::vector<AggregatePane>& panes) {
+    for (auto& pane : closed_panes_) {
+        panes.push_back(std::move(pane));
+    }
+    closed_panes_.clear();
+}
+
+std::vector<Event> RuleEngine::merge_panes(std::vector<AggregatePane> panes, int64_t now_ns) {
     std::vector<Event> events;
     
-    // Cleanup expired sequences first
-    cleanup_expired_sequences();
-    
-    auto& sequences = sequence_states_[subscriber_key];
-    
-    for (const auto& rule : ruleset.sequence_rules) {
-        if (message.msg_type() == rule.first_msg_type) {
-            // Start new sequence
-            SequenceState state;
-            state.subscriber_key = subscriber_key;
-            state.first_msg_type = rule.first_msg_type;
-            state.first_message = message;
-            state.first_seen = std::chrono::system_clock::now();
-            state.ruleset_id = ruleset.id;
-            state.ruleset_version = ruleset.version;
-            sequences.push_back(state);
-        } else if (message.msg_type() == rule.second_msg_type) {
-            // Check for matching first message
-            auto it = sequences.begin();
-            while (it != sequences.end()) {
-                if (it->first_msg_type == rule.first_msg_type) {
-                    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                        std::chrono::system_clock::now() - it->first_seen);
-                    
-                    if (elapsed <= rule.time_window) {
-                        // Sequence matched!
-                        Event event = create_event(rule.event_name, message, rule.attributes,
-                                                  ruleset.id, ruleset.version, subscriber_key);
-                        
-                        // Extract event data based on rule specifications
-                        for (const auto& extraction : rule.event_data) {
-                            std::string value = extract_event_data_value(extraction.source_expression, message, &it->first_message, subscriber_key);
-                            if (!value.empty()) {
-                                (*event.mutable_attributes())[extraction.target_attribute] = value;
-                            }
-                        }
-                        
-                        // Add evidence from first message
-                        SpoolOffset first_offset;
-                        first_offset.set_partition(it->first_message.spool_partition());
-                        first_offset.set_offset(it->first_message.spool_offset());
-                        if (it->first_message.frame_number() != 0) {
-                            first_offset.set_frame_number(it->first_message.frame_number());
-                        }
-                        *event.mutable_evidence()->add_offsets() = first_offset;
-                        
-                        // Add evidence from current message
-                        SpoolOffset current_offset;
-                        current_offset.set_partition(message.spool_partition());
-                        current_offset.set_offset(message.spool_offset());
-                        if (message.frame_number() != 0) {
-                            current_offset.set_frame_number(message.frame_number());
-                        }
-                        *event.mutable_evidence()->add_offsets() = current_offset;
-                        
-                        events.push_back(event);
-                        it = sequences.erase(it);
-                    } else {
-                        // Expired
-                        ++it;
-                    }
-                } else {
-                    ++it;
+    // One pane per rule, key and start
+    std::sort(panes.begin(), panes.end(), [](const AggregatePane& a, const AggregatePane& b) {
+        if (a.rule_fingerprint != b.rule_fingerprint) return a.rule_fingerprint < b.rule_fingerprint;
+        if (a.key != b.key) return a.key < b.key;
+        return a.start_ns < b.start_ns;
+    });
+    for (size_t i = 0; i < panes.size();) {
+        AggregatePane pane = std::move(panes[i]);
+        for (++i; i < panes.size() && panes[i].rule_fingerprint == pane.rule_fingerprint &&
+                  panes[i].key == pane.key && panes[i].start_ns == pane.start_ns; ++i) {
+            pane.merge(panes[i]);
+        }
+        auto rule_it = rules_->aggregate_index.find(pane.rule_fingerprint);
+        if (rule_it == rules_->aggregate_index.end()) {
+            continue;
+        }
+        const RuleRef& ref = rule_it->second;
+        const auto& compiled = rules_->compiled[ref.ruleset].aggregates[ref.rule];
+        if (compiled.pane_ns == compiled.window_ns) {
+            // Tumbling: the pane is the window
+            emit_window(ref, pane, pane.start_ns + compiled.window_ns, events);
+            continue;
+        }
+        auto& history = window_history_[PaneKey{pane.rule_fingerprint, pane.key, 0}];
+        if (history.panes.empty()) {
+            // The first window to cover it ends a slide later
+            history.last_end_ns = std::max(history.last_end_ns, pane.start_ns);
+            next_window_end_ns_ = std::min(next_window_end_ns_, history.last_end_ns + compiled.pane_ns);
+        }
+        history.panes.push_back(std::move(pane));
+    }
+    
+    // Sliding windows that end by now, with or without new panes
+    if (now_ns < next_window_end_ns_) {
+        return events;
+    }
+    next_window_end_ns_ = INT64_MAX;
+    for (auto it = window_history_.begin(); it != window_history_.end();) {
+        auto rule_it = rules_->aggregate_index.find(it->first.rule_fingerprint);
+        if (rule_it == rules_->aggregate_index.end()) {
+            it = window_history_.erase(it);
+            continue;
+        }
+        const RuleRef& ref = rule_it->second;
+        const auto& compiled = rules_->compiled[ref.ruleset].aggregates[ref.rule];
+        auto& history = it->second;
+        while (!history.panes.empty() && history.last_end_ns + compiled.pane_ns <= now_ns) {
+            const int64_t end = history.last_end_ns + compiled.pane_ns;
+            const int64_t start = end - compiled.window_ns;
+            AggregatePane window;
+            window.key = it->first.key;
+            window.start_ns = start;
+            bool covered = false;
+            for (const auto& pane : history.panes) {
+                if (pane.start_ns >= start && pane.start_ns < end) {
+                    window.merge(pane);
+                    covered = true;
                 }
             }
+            if (covered) {
+                emit_window(ref, window, end, events);
+            }
+            history.last_end_ns = end;
+            
+            // Drop panes no later window covers, and skip the windows
+            // before the next pane
+            while (!history.panes.empty() && history.panes.front().start_ns < start + compiled.pane_ns) {
+                history.panes.pop_front();
+            }
+            if (!history.panes.empty() && history.panes.front().start_ns > end) {
+                history.last_end_ns = history.panes.front().start_ns;
+            }
+        }
+        if (history.panes.empty()) {
+            it = window_history_.erase(it);
+            continue;
         }
+        next_window_end_ns_ = std::min(next_window_end_ns_, history.last_end_ns + compiled.pane_ns);
+        ++it;
     }
-    
     return events;
 }
 
+void RuleEngine::emit_window(const RuleRef& ref, const AggregatePane& window, int64_t end_ns,
+                             std::vector<Event>& events) const {
+    const Ruleset& ruleset = rules_->rulesets[ref.ruleset];
+    const auto& rule = ruleset.aggregate_rules[ref.rule];
+    
+    Event event;
+    event.set_name(rule.event_name);
+    event.set_ts(utils::wall_clock_ns());
+    for (const auto& [key, value] : rule.attributes) {
+        (*event.mutable_attributes())[key] = value;
+    }
+    auto& attributes = *event.mutable_attributes();
+    switch (rule.key) {
+        case AggregateRule::Key::ECGI:
+            attributes["ecgi"] = utils::to_hex(window.key);
+            break;
+        case AggregateRule::Key::ENB:
+            attributes["enb_id"] = window.key;
+            break;
+        case AggregateRule::Key::MME:
+            attributes["mme_id"] = window.key;
+            break;
+    }
+    attributes["window_start"] = std::to_string(window.start_ns);
+    attributes["window_end"] = std::to_string(end_ns);
+    
+    double value = 0.0;
+    switch (rule.function) {
+        case AggregateRule::Function::COUNT:
+            value = static_cast<double>(window.count);
+            attributes["count"] = std::to_string(window.count);
+            break;
+        case AggregateRule::Function::DISTINCT_UES:
+            value = std::round(window.ues.estimate());
+            attributes["count"] = std::to_string(window.count);
+            attributes["distinct_ues"] = std::to_string(static_cast<uint64_t>(value));
+            break;
+        case AggregateRule::Function::RATIO:
+            if (window.total == 0 || window.total < rule.min_total) {
+                return;
+            }
+            value = static_cast<double>(window.count) / static_cast<double>(window.total);
+            attributes["count"] = std::to_string(window.count);
+            attributes["total"] = std::to_string(window.total);
+            attributes["ratio"] = std::to_string(value);
+            break;
+    }
+    if (rule.threshold && value < *rule.threshold) {
+        return;
+    }
+    
+    event.set_confidence(1.0);
+    event.set_ruleset_id(ruleset.id);
+    event.set_ruleset_version(ruleset.version);
+    events.push_back(std::move(event));
+}
+
 Event RuleEngine::create_event(const std::string& name,
                                const CanonicalMessage& message,
                                const std::map<std::string, std::string>& attributes,
                                const std::string& ruleset_id,
                                const std::string& ruleset_version,
-                               const std::string& subscriber_key) {
+                               correlate::SubscriberId subscriber_id) {
     Event event;
     event.set_name(name);
     event.set_ts(std::chrono::duration_cast<std::chrono::nanoseconds>(
         std::chrono::system_clock::now().time_since_epoch()).count());
     
-    // Use the provided subscriber_key instead of calling get_or_create_context again
-    event.set_subscriber_key(subscriber_key);
+    // Render the string key only here, at the event boundary
+    event.set_subscriber_key(correlator_->subscriber_key(subscriber_id));
     
     // Add attributes
     for (const auto& [key, value] : attributes) {
@@ -185,7 +791,7 @@ Event RuleEngine::create_event(const std::string& name,
     // Add message-derived attributes
     (*event.mutable_attributes())["msg_type"] = message.msg_type();
     if (!message.ecgi().empty()) {
-        (*event.mutable_attributes())["ecgi"] = bytes_to_hex_string(message.ecgi());
+        (*event.mutable_attributes())["ecgi"] = utils::to_hex(message.ecgi());
     }
     
     event.set_confidence(1.0); // Explicit events have full confidence
@@ -205,115 +811,199 @@ Event RuleEngine::create_event(const std::string& name,
     return event;
 }
 
-std::string RuleEngine::extract_event_data_value(const std::string& expression,
+std::string RuleEngine::extract_event_data_value(const CompiledExtraction& extraction,
                                                  const CanonicalMessage& message,
-                                                 const CanonicalMessage* first_message,
-                                                 const std::string& subscriber_key) {
-    // Parse expression: "message.field" or "first_message.field" or "context.field"
-    size_t dot_pos = expression.find('.');
-    if (dot_pos == std::string::npos) {
-        return ""; // Invalid expression
-    }
-    
-    std::string source = expression.substr(0, dot_pos);
-    std::string field = expression.substr(dot_pos + 1);
-    
+                                                 const SequenceState* sequence,
+                                                 correlate::SubscriberId subscriber_id) {
     std::string value;
     
-    if (source == "message") {
-        // Extract from current message
-        if (field == "ecgi" && !message.ecgi().empty()) {
-            value = bytes_to_hex_string(message.ecgi());
-        } else if (field == "target_ecgi" && !message.target_ecgi().empty()) {
-            value = bytes_to_hex_string(message.target_ecgi());
-        } else if (field == "mme_ue_s1ap_id" && message.mme_ue_s1ap_id() != 0) {
-            value = std::to_string(message.mme_ue_s1ap_id());
-        } else if (field == "enb_ue_s1ap_id" && message.enb_ue_s1ap_id() != 0) {
-            value = std::to_string(message.enb_ue_s1ap_id());
-        } else if (field == "imsi" && !message.imsi().empty()) {
-            value = message.imsi();
-        } else if (field == "tmsi" && !message.tmsi().empty()) {
-            value = message.tmsi();
-        } else if (field == "msg_type" && !message.msg_type().empty()) {
-            value = message.msg_type();
-        }
-    } else if (source == "first_message" && first_message) {
-        // Extract from first message (sequence rules only)
-        if (field == "ecgi" && !first_message->ecgi().empty()) {
-            value = bytes_to_hex_string(first_message->ecgi());
-        } else if (field == "target_ecgi" && !first_message->target_ecgi().empty()) {
-            value = bytes_to_hex_string(first_message->target_ecgi());
-        } else if (field == "mme_ue_s1ap_id" && first_message->mme_ue_s1ap_id() != 0) {
-            value = std::to_string(first_message->mme_ue_s1ap_id());
-        } else if (field == "enb_ue_s1ap_id" && first_message->enb_ue_s1ap_id() != 0) {
-            value = std::to_string(first_message->enb_ue_s1ap_id());
-        } else if (field == "imsi" && !first_message->imsi().empty()) {
-            value = first_message->imsi();
-        } else if (field == "tmsi" && !first_message->tmsi().empty()) {
-            value = first_message->tmsi();
-        } else if (field == "msg_type" && !first_message->msg_type().empty()) {
-            value = first_message->msg_type();
-        }
-    } else if (source == "context") {
-        // Extract from UE context
-        auto context = correlator_->get_context(subscriber_key);
-        if (context) {
-            if (field == "source_ecgi" && !context->source_ecgi.empty()) {
-                value = bytes_to_hex_string(context->source_ecgi);
-            } else if (field == "ecgi" && !context->ecgi.empty()) {
-                value = bytes_to_hex_string(context->ecgi);
-            } else if (field == "target_ecgi" && !context->target_ecgi.empty()) {
-                value = bytes_to_hex_string(context->target_ecgi);
-            } else if (field == "imsi" && context->imsi.has_value()) {
-                value = context->imsi.value();
-            } else if (field == "tmsi" && context->tmsi.has_value()) {
-                value = context->tmsi.value();
+    switch (extraction.source) {
+        case ExtractionSource::MESSAGE:
+            value = message_field_value(extraction.field, message);
+            break;
+        case ExtractionSource::FIRST_MESSAGE:
+        case ExtractionSource::STEP:
+            // Kept with the sequence state (sequence rules only); the last
+            // step is the current message
+            if (!sequence) {
+                break;
+            }
+            if (extraction.step == sequence->steps_matched) {
+                value = message_field_value(extraction.field, message);
+            } else {
+                value = std::string(captured_value(sequence->captured, extraction.step, extraction.field));
+            }
+            break;
+        case ExtractionSource::CONTEXT: {
+            // Extract from UE context
+            auto context = correlator_->get_context(subscriber_id);
+            if (!context) {
+                break;
             }
+            switch (extraction.field) {
+                case ExtractionField::SOURCE_ECGI:
+                    if (!context->source_ecgi.empty()) value = utils::to_hex(context->source_ecgi);
+                    break;
+                case ExtractionField::ECGI:
+                    if (!context->ecgi.empty()) value = utils::to_hex(context->ecgi);
+                    break;
+                case ExtractionField::TARGET_ECGI:
+                    if (!context->target_ecgi.empty()) value = utils::to_hex(context->target_ecgi);
+                    break;
+                case ExtractionField::IMSI:
+                    if (context->imsi.has_value()) value = context->imsi.value();
+                    break;
+                case ExtractionField::TMSI:
+                    if (context->tmsi.has_value()) value = context->tmsi.value();
+                    break;
+                default:
+                    break;
+            }
+            break;
         }
+        case ExtractionSource::INVALID:
+            break;
     }
     
     return value;
 }
 
-void RuleEngine::extract_event_data(Event& event,
-                                   const std::string& expression,
-                                   const CanonicalMessage& message,
-                                   const CanonicalMessage* first_message) {
-    std::string subscriber_key = event.subscriber_key();
-    std::string value = extract_event_data_value(expression, message, first_message, subscriber_key);
-    
-    // Add to event attributes if value was extracted
-    // Note: The target attribute name is set by the caller
-    if (!value.empty()) {
-        std::string field_name = expression.substr(expression.find('.') + 1);
-        (*event.mutable_attributes())[field_name] = value;
+std::string RuleEngine::extract_event_data_value(const std::string& expression,
+                                                 const CanonicalMessage& message,
+                                                 const SequenceState* sequence,
+                                                 correlate::SubscriberId subscriber_id) {
+    EventDataExtraction extraction;
+    extraction.source_expression = expression;
+    return extract_event_data_value(compile_extraction(extraction), message,
+                                    sequence, subscriber_id);
+}
+
+int64_t RuleEngine::current_time_ns() const {
+    if (!config_.event_time) {
+        return utils::wall_clock_ns();
+    }
+    if (watermark_ns_ != 0) {
+        return watermark_ns_;
     }
+    return clock_ns_ != 0 ? clock_ns_ : utils::wall_clock_ns();
+}
+
+int64_t RuleEngine::message_time_ns(const CanonicalMessage& message) const {
+    if (config_.event_time && message.ts_capture() > 0) {
+        return message.ts_capture();
+    }
+    return current_time_ns();
+}
+
+void RuleEngine::advance_watermark(int64_t watermark_ns) {
+    watermark_ns_ = std::max(watermark_ns_, watermark_ns);
 }
 
 void RuleEngine::cleanup_expired_sequences() {
-    auto now = std::chrono::system_clock::now();
-    constexpr auto max_sequence_age = std::chrono::seconds(60); // 1 minute max
+    const int64_t now = current_time_ns();
+    const int64_t max_age_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(max_sequence_age).count();
     
-    auto it = sequence_states_.begin();
-    while (it != sequence_states_.end()) {
+    sequence_expiry_.expire(now, [&](correlate::SubscriberId subscriber_id) {
+        auto it = sequence_states_.find(subscriber_id);
+        if (it == sequence_states_.end()) {
+            return;
+        }
         auto& sequences = it->second;
-        sequences.erase(
-            std::remove_if(sequences.begin(), sequences.end(),
-                [&](const SequenceState& state) {
-                    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                        now - state.first_seen);
-                    return elapsed > max_sequence_age;
-                }),
-            sequences.end());
+        auto expired = std::remove_if(sequences.begin(), sequences.end(),
+            [&](const SequenceState& state) {
+                return state.first_seen_ns + max_age_ns <= now;
+            });
+        sequence_state_count_ -= static_cast<size_t>(sequences.end() - expired);
+        sequences.erase(expired, sequences.end());
         
         if (sequences.empty()) {
-            it = sequence_states_.erase(it);
-        } else {
-            ++it;
+            sequence_states_.erase(it);
+            return;
+        }
+        
+        // Re-arm for the oldest remaining state
+        int64_t oldest = sequences.front().first_seen_ns;
+        for (const auto& state : sequences) {
+            oldest = std::min(oldest, state.first_seen_ns);
+        }
+        sequence_expiry_.schedule(subscriber_id, oldest + max_age_ns);
+    });
+}
+
+void RuleEngine::save_snapshot(snapshot::SnapshotWriter& writer, uint32_t shard) const {
+    snapshot::RuleEngineStateEntry state{};
+    state.clock_ns = clock_ns_;
+    state.watermark_ns = watermark_ns_;
+    writer.add_record(snapshot::SectionKind::RULE_ENGINE_STATE, shard, state);
+    
+    std::string evidence;
+    for (const auto& [subscriber_id, sequences] : sequence_states_) {
+        for (const auto& sequence : sequences) {
+            snapshot::SequenceEntry entry{};
+            entry.subscriber_id = subscriber_id;
+            entry.first_seen_ns = sequence.first_seen_ns;
+            entry.rule_fingerprint = sequence.rule_fingerprint;
+            entry.steps_matched = sequence.steps_matched;
+            evidence.clear();
+            for (const auto& step : sequence.evidence) {
+                evidence.append(reinterpret_cast<const char*>(&step.partition), sizeof(step.partition));
+                evidence.append(reinterpret_cast<const char*>(&step.offset), sizeof(step.offset));
+                evidence.append(reinterpret_cast<const char*>(&step.frame_number), sizeof(step.frame_number));
+            }
+            entry.evidence = writer.add_blob(evidence);
+            entry.captured = writer.add_blob(sequence.captured);
+            writer.add_record(snapshot::SectionKind::SEQUENCES, shard, entry);
+        }
+    }
+}
+
+void RuleEngine::load_snapshot(const snapshot::SnapshotReader& reader, uint32_t shard) {
+    for (const auto& state : reader.records<snapshot::RuleEngineStateEntry>(
+             snapshot::SectionKind::RULE_ENGINE_STATE, shard)) {
+        clock_ns_ = std::max(clock_ns_, state.clock_ns);
+        watermark_ns_ = std::max(watermark_ns_, state.watermark_ns);
+    }
+    
+    const int64_t max_age_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(max_sequence_age).count();
+    constexpr size_t evidence_size = sizeof(int32_t) + 2 * sizeof(int64_t);
+    for (const auto& entry : reader.records<snapshot::SequenceEntry>(snapshot::SectionKind::SEQUENCES, shard)) {
+        std::string_view evidence = reader.blob(entry.evidence);
+        if (entry.steps_matched == 0 || entry.steps_matched >= kMaxSequenceSteps ||
+            evidence.size() != entry.steps_matched * evidence_size) {
+            std::cerr << "Skipping unreadable sequence state in snapshot for subscriber "
+                      << entry.subscriber_id << std::endl;
+            continue;
+        }
+        SequenceState state;
+        state.rule_fingerprint = entry.rule_fingerprint;
+        state.steps_matched = entry.steps_matched;
+        state.first_seen_ns = entry.first_seen_ns;
+        for (size_t i = 0; i < entry.steps_matched; ++i) {
+            const char* data = evidence.data() + i * evidence_size;
+            StepEvidence step{};
+            std::memcpy(&step.partition, data, sizeof(step.partition));
+            std::memcpy(&step.offset, data + sizeof(step.partition), sizeof(step.offset));
+            std::memcpy(&step.frame_number, data + sizeof(step.partition) + sizeof(step.offset),
+                        sizeof(step.frame_number));
+            state.evidence.push_back(step);
         }
+        state.captured = std::string(reader.blob(entry.captured));
+        sequence_states_[entry.subscriber_id].push_back(std::move(state));
+        sequence_state_count_++;
     }
+    
+    // Arm each subscriber for its oldest restored state
+    for (const auto& [subscriber_id, sequences] : sequence_states_) {
+        int64_t oldest = sequences.front().first_seen_ns;
+        for (const auto& state : sequences) {
+            oldest = std::min(oldest, state.first_seen_ns);
+        }
+        sequence_expiry_.schedule(subscriber_id, oldest + max_age_ns);
+    }
+    
+    // Rules loaded before the snapshot take their states now
+    bind_sequences();
 }
 
 } // namespace rules
 } // namespace s1see
-
@@ -0,0 +1,90 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: ruleset_watcher.cc
+ * Description: Implementation of RulesetWatcher: polls a ruleset file's
+ *              metadata and reloads it through the YAML loader on change.
+ */
+
+#include "s1see/rules/ruleset_watcher.h"
+#include "s1see/rules/yaml_loader.h"
+#include <iostream>
+#include <sys/stat.h>
+
+namespace s1see {
+namespace rules {
+
+RulesetWatcher::RulesetWatcher(const Config& config, ReloadCallback on_reload)
+    : config_(config), on_reload_(std::move(on_reload)), seen_(version()) {
+}
+
+RulesetWatcher::~RulesetWatcher() {
+    stop();
+}
+
+RulesetWatcher::FileVersion RulesetWatcher::version() const {
+    FileVersion version;
+    struct stat st;
+    if (::stat(config_.path.c_str(), &st) != 0) {
+        return version;  // Missing: size -1
+    }
+    version.inode = static_cast<uint64_t>(st.st_ino);
+    version.size = static_cast<int64_t>(st.st_size);
+    version.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    return version;
+}
+
+bool RulesetWatcher::check() {
+    FileVersion current = version();
+    if (current == seen_ || current.size < 0) {
+        return false;  // Unchanged, or gone while being replaced
+    }
+    seen_ = current;
+    
+    Ruleset ruleset;
+    try {
+        ruleset = load_ruleset_from_yaml(config_.path);
+    } catch (const std::exception& e) {
+        failures_.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "Ruleset reload from " << config_.path << " failed, keeping the rules in use: "
+                  << e.what() << std::endl;
+        return false;
+    }
+    on_reload_(ruleset);
+    reloads_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void RulesetWatcher::start() {
+    if (thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = false;
+    }
+    thread_ = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_cv_.wait_for(lock, config_.poll_interval, [this] { return stopping_; })) {
+            lock.unlock();
+            check();
+            lock.lock();
+        }
+    });
+}
+
+void RulesetWatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    stop_cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+} // namespace rules
+} // namespace s1see
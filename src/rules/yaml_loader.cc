@@ -5,7 +5,7 @@
  * Disclaimer: Provided "as is" without warranty; use at your own risk.
  * Title: yaml_loader.cc
  * Description: Implementation of YAML ruleset loader for loading rule configurations
- *              from YAML files. Parses single-message rules and sequence rules,
+ *              from YAML files. Parses single-message, sequence and aggregate rules,
  *              extracts event names, message type patterns, attributes, and
  *              event data extraction specifications.
  */
@@ -64,8 +64,21 @@ Ruleset load_ruleset_from_yaml(const std::string& file_path) {
         for (const auto& rule_node : rs_node["sequence_rules"]) {
             SequenceRule rule;
             rule.event_name = rule_node["event_name"].as<std::string>();
-            rule.first_msg_type = rule_node["first_msg_type"].as<std::string>();
-            rule.second_msg_type = rule_node["second_msg_type"].as<std::string>();
+            if (rule_node["steps"]) {
+                // Any number of steps, in order
+                for (const auto& step_node : rule_node["steps"]) {
+                    rule.steps.push_back(step_node.as<std::string>());
+                }
+                if (rule.steps.size() < 2 || rule.steps.size() > kMaxSequenceSteps) {
+                    throw std::runtime_error("Sequence rule '" + rule.event_name + "' needs 2 to " +
+                                             std::to_string(kMaxSequenceSteps) + " steps");
+                }
+                rule.first_msg_type = rule.steps.front();
+                rule.second_msg_type = rule.steps.back();
+            } else {
+                rule.first_msg_type = rule_node["first_msg_type"].as<std::string>();
+                rule.second_msg_type = rule_node["second_msg_type"].as<std::string>();
+            }
             
             int window_ms = rule_node["time_window_ms"].as<int>(15000);
             rule.time_window = std::chrono::milliseconds(window_ms);
@@ -91,6 +104,74 @@ Ruleset load_ruleset_from_yaml(const std::string& file_path) {
         }
     }
     
+    // Load aggregate rules
+    if (rs_node["aggregate_rules"]) {
+        for (const auto& rule_node : rs_node["aggregate_rules"]) {
+            AggregateRule rule;
+            rule.event_name = rule_node["event_name"].as<std::string>();
+            
+            std::string function = rule_node["function"].as<std::string>("count");
+            if (function == "count") {
+                rule.function = AggregateRule::Function::COUNT;
+            } else if (function == "distinct_ues") {
+                rule.function = AggregateRule::Function::DISTINCT_UES;
+            } else if (function == "ratio") {
+                rule.function = AggregateRule::Function::RATIO;
+            } else {
+                throw std::runtime_error("Aggregate rule '" + rule.event_name + "': unknown function '" +
+                                         function + "'");
+            }
+            std::string key = rule_node["key"].as<std::string>("ecgi");
+            if (key == "ecgi") {
+                rule.key = AggregateRule::Key::ECGI;
+            } else if (key == "enb") {
+                rule.key = AggregateRule::Key::ENB;
+            } else if (key == "mme") {
+                rule.key = AggregateRule::Key::MME;
+            } else {
+                throw std::runtime_error("Aggregate rule '" + rule.event_name + "': unknown key '" + key + "'");
+            }
+            
+            for (const auto& type_node : rule_node["msg_types"]) {
+                rule.msg_types.push_back(type_node.as<std::string>());
+            }
+            if (rule_node["total_msg_types"]) {
+                for (const auto& type_node : rule_node["total_msg_types"]) {
+                    rule.total_msg_types.push_back(type_node.as<std::string>());
+                }
+            }
+            if (rule.msg_types.empty() ||
+                (rule.function == AggregateRule::Function::RATIO && rule.total_msg_types.empty())) {
+                throw std::runtime_error("Aggregate rule '" + rule.event_name + "' needs msg_types" +
+                                         (rule.function == AggregateRule::Function::RATIO ? " and total_msg_types" : ""));
+            }
+            
+            rule.window = std::chrono::milliseconds(rule_node["window_ms"].as<int64_t>(60000));
+            rule.slide = std::chrono::milliseconds(rule_node["slide_ms"].as<int64_t>(0));
+            if (rule.window.count() <= 0 || rule.slide.count() < 0 ||
+                (rule.slide.count() > 0 && (rule.window.count() % rule.slide.count() != 0 ||
+                                            static_cast<uint64_t>(rule.window.count() / rule.slide.count()) >
+                                                kMaxWindowPanes))) {
+                throw std::runtime_error("Aggregate rule '" + rule.event_name +
+                                         "': slide_ms must divide window_ms into at most " +
+                                         std::to_string(kMaxWindowPanes) + " slides");
+            }
+            if (rule_node["threshold"]) {
+                rule.threshold = rule_node["threshold"].as<double>();
+            }
+            rule.min_total = rule_node["min_total"].as<uint64_t>(0);
+            
+            if (rule_node["attributes"]) {
+                for (const auto& attr : rule_node["attributes"]) {
+                    rule.attributes[attr.first.as<std::string>()] = 
+                        attr.second.as<std::string>();
+                }
+            }
+            
+            ruleset.aggregate_rules.push_back(rule);
+        }
+    }
+    
     return ruleset;
 }
 
@@ -12,12 +12,16 @@
 
 #include "s1ap_parser.h"
 #include "nas_parser.h"
+#include "s1see/utils/codec.h"
 #include <algorithm>
 #include <cstring>
 #include <sstream>
 #include <iomanip>
 #include <iostream>
 #include <cctype>
+#include <array>
+#include <charconv>
+#include <tuple>
 
 namespace s1ap_parser {
 
@@ -30,15 +34,26 @@ constexpr uint8_t SCTP_CHUNK_DATA = 0;
 std::optional<std::vector<uint8_t>> extractS1apFromSctp(
     const uint8_t* packet, size_t len) {
     
-    if (!packet || len < 14) {
+    auto payload = findS1apInSctp(std::span<const uint8_t>(packet, packet ? len : 0));
+    if (payload.empty()) {
         return std::nullopt;
     }
+    return std::vector<uint8_t>(payload.begin(), payload.end());
+}
+
+std::span<const uint8_t> findS1apInSctp(std::span<const uint8_t> packet_bytes) {
+    const uint8_t* packet = packet_bytes.data();
+    size_t len = packet_bytes.size();
+    
+    if (!packet || len < 14) {
+        return {};
+    }
     
     size_t offset = 0;
     
     // Parse Ethernet header
     if (len < 14) {
-        return std::nullopt;
+        return {};
     }
     
     uint16_t eth_type = (packet[12] << 8) | packet[13];
@@ -56,15 +71,15 @@ std::optional<std::vector<uint8_t>> extractS1apFromSctp(
     // Parse IPv4
     if (eth_type == 0x0800) {
         if (len < offset + 20) {
-            return std::nullopt;
+            return {};
         }
         uint8_t ver_ihl = packet[offset];
         if ((ver_ihl >> 4) != 4) {
-            return std::nullopt;
+            return {};
         }
         ip_header_len = (ver_ihl & 0x0F) * 4;
         if (len < offset + ip_header_len) {
-            return std::nullopt;
+            return {};
         }
         protocol = packet[offset + 9];
         offset += ip_header_len;
@@ -72,10 +87,10 @@ std::optional<std::vector<uint8_t>> extractS1apFromSctp(
     // Parse IPv6
     else if (eth_type == 0x86DD) {
         if (len < offset + 40) {
-            return std::nullopt;
+            return {};
         }
         if ((packet[offset] >> 4) != 6) {
-            return std::nullopt;
+            return {};
         }
         protocol = packet[offset + 6];  // Next Header
         offset += 40;
@@ -85,12 +100,12 @@ std::optional<std::vector<uint8_t>> extractS1apFromSctp(
         while (protocol != IP_PROTO_SCTP && ext_header_limit < 8 && offset < len) {
             if (protocol == 0 || protocol == 43 || protocol == 44 || protocol == 60) {
                 if (len < offset + 8) {
-                    return std::nullopt;
+                    return {};
                 }
                 uint8_t ext_len = packet[offset + 1];
                 size_t ext_header_len = (ext_len + 1) * 8;
                 if (len < offset + ext_header_len) {
-                    return std::nullopt;
+                    return {};
                 }
                 protocol = packet[offset];
                 offset += ext_header_len;
@@ -100,17 +115,17 @@ std::optional<std::vector<uint8_t>> extractS1apFromSctp(
             }
         }
     } else {
-        return std::nullopt;
+        return {};
     }
     
     // Check if SCTP
     if (protocol != IP_PROTO_SCTP) {
-        return std::nullopt;
+        return {};
     }
     
     // Parse SCTP header (12 bytes)
     if (len < offset + 12) {
-        return std::nullopt;
+        return {};
     }
     offset += 12;  // Skip SCTP common header
     
@@ -131,17 +146,13 @@ std::optional<std::vector<uint8_t>> extractS1apFromSctp(
 
             uint32_t payload_protocol_id = (packet[offset + 12] << 24) | (packet[offset + 13] << 16) | (packet[offset + 14] << 8) | packet[offset + 15];
 
-            if (payload_protocol_id != 18) {return std::nullopt;} // 18 is the S1AP protocol ID
+            if (payload_protocol_id != 18) {return {};} // 18 is the S1AP protocol ID
 
             size_t payload_offset = offset + 16;
             size_t payload_len = chunk_len - 16;
             
             if (payload_len > 0 && payload_offset + payload_len <= len) {
-                std::vector<uint8_t> s1ap_payload(
-                    packet + payload_offset, 
-                    packet + payload_offset + payload_len
-                );
-                return s1ap_payload;
+                return packet_bytes.subspan(payload_offset, payload_len);
             }
         }
         
@@ -150,7 +161,7 @@ std::optional<std::vector<uint8_t>> extractS1apFromSctp(
         offset += chunk_len + pad;
     }
     
-    return std::nullopt;
+    return {};
 }
 
 std::vector<std::vector<uint8_t>> extractAllS1apFromSctp(
@@ -348,232 +359,257 @@ std::pair<std::vector<uint8_t>, size_t> readPerOctetString(
     return {result, length};
 }
 
-std::string getProcedureCodeName(uint8_t procedure_code) {
-    // Map ProcedureCode to procedure name based on S1AP specification
-    switch (procedure_code) {
-        case 0: return "HandoverPreparation";
-        case 1: return "HandoverResourceAllocation";
-        case 2: return "HandoverNotification";
-        case 3: return "PathSwitchRequest";
-        case 4: return "HandoverCancel";
-        case 5: return "E-RABSetup";
-        case 6: return "E-RABModify";
-        case 7: return "E-RABRelease";
-        case 8: return "E-RABReleaseIndication";
-        case 9: return "InitialContextSetup";
-        case 10: return "Paging";
-        case 11: return "downlinkNASTransport";
-        case 12: return "initialUEMessage";
-        case 13: return "uplinkNASTransport";
-        case 14: return "Reset";
-        case 15: return "ErrorIndication";
-        case 16: return "NASNonDeliveryIndication";
-        case 17: return "S1Setup";
-        case 18: return "UEContextReleaseRequest";
-        case 19: return "DownlinkS1cdma2000tunneling";
-        case 20: return "UplinkS1cdma2000tunneling";
-        case 21: return "UEContextModification";
-        case 22: return "UECapabilityInfoIndication";
-        case 23: return "UEContextRelease";
-        case 24: return "eNBStatusTransfer";
-        case 25: return "MMEStatusTransfer";
-        case 26: return "DeactivateTrace";
-        case 27: return "TraceStart";
-        case 28: return "TraceFailureIndication";
-        case 29: return "ENBConfigurationUpdate";
-        case 30: return "MMEConfigurationUpdate";
-        case 31: return "LocationReportingControl";
-        case 32: return "LocationReportingFailureIndication";
-        case 33: return "LocationReport";
-        case 34: return "OverloadStart";
-        case 35: return "OverloadStop";
-        case 36: return "WriteReplaceWarning";
-        case 37: return "eNBDirectInformationTransfer";
-        case 38: return "MMEDirectInformationTransfer";
-        case 39: return "PrivateMessage";
-        case 40: return "eNBConfigurationTransfer";
-        case 41: return "MMEConfigurationTransfer";
-        case 42: return "CellTrafficTrace";
-        case 43: return "Kill";
-        case 44: return "downlinkUEAssociatedLPPaTransport";
-        case 45: return "uplinkUEAssociatedLPPaTransport";
-        case 46: return "downlinkNonUEAssociatedLPPaTransport";
-        case 47: return "uplinkNonUEAssociatedLPPaTransport";
-        default: return "Unknown";
-    }
+namespace {
+    // Indexed by ProcedureCode (3GPP TS 36.413)
+    constexpr std::array<std::string_view, 48> PROCEDURE_NAMES = {
+        "HandoverPreparation",                                 // 0
+        "HandoverResourceAllocation",                          // 1
+        "HandoverNotification",                                // 2
+        "PathSwitchRequest",                                   // 3
+        "HandoverCancel",                                      // 4
+        "E-RABSetup",                                          // 5
+        "E-RABModify",                                         // 6
+        "E-RABRelease",                                        // 7
+        "E-RABReleaseIndication",                              // 8
+        "InitialContextSetup",                                 // 9
+        "Paging",                                              // 10
+        "downlinkNASTransport",                                // 11
+        "initialUEMessage",                                    // 12
+        "uplinkNASTransport",                                  // 13
+        "Reset",                                               // 14
+        "ErrorIndication",                                     // 15
+        "NASNonDeliveryIndication",                            // 16
+        "S1Setup",                                             // 17
+        "UEContextReleaseRequest",                             // 18
+        "DownlinkS1cdma2000tunneling",                         // 19
+        "UplinkS1cdma2000tunneling",                           // 20
+        "UEContextModification",                               // 21
+        "UECapabilityInfoIndication",                          // 22
+        "UEContextRelease",                                    // 23
+        "eNBStatusTransfer",                                   // 24
+        "MMEStatusTransfer",                                   // 25
+        "DeactivateTrace",                                     // 26
+        "TraceStart",                                          // 27
+        "TraceFailureIndication",                              // 28
+        "ENBConfigurationUpdate",                              // 29
+        "MMEConfigurationUpdate",                              // 30
+        "LocationReportingControl",                            // 31
+        "LocationReportingFailureIndication",                  // 32
+        "LocationReport",                                      // 33
+        "OverloadStart",                                       // 34
+        "OverloadStop",                                        // 35
+        "WriteReplaceWarning",                                 // 36
+        "eNBDirectInformationTransfer",                        // 37
+        "MMEDirectInformationTransfer",                        // 38
+        "PrivateMessage",                                      // 39
+        "eNBConfigurationTransfer",                            // 40
+        "MMEConfigurationTransfer",                            // 41
+        "CellTrafficTrace",                                    // 42
+        "Kill",                                                // 43
+        "downlinkUEAssociatedLPPaTransport",                   // 44
+        "uplinkUEAssociatedLPPaTransport",                     // 45
+        "downlinkNonUEAssociatedLPPaTransport",                // 46
+        "uplinkNonUEAssociatedLPPaTransport",                  // 47
+    };
+
+    // Indexed by ProtocolIE-ID (3GPP TS 36.413); IDs with no IE in this
+    // release are "Unknown-<id>"
+    constexpr std::array<std::string_view, 166> IE_NAMES = {
+        "MME-UE-S1AP-ID",                                      // 0
+        "HandoverType",                                        // 1
+        "Cause",                                               // 2
+        "SourceID",                                            // 3
+        "TargetID",                                            // 4
+        "Unknown-5",                                           // 5
+        "Unknown-6",                                           // 6
+        "Unknown-7",                                           // 7
+        "eNB-UE-S1AP-ID",                                      // 8
+        "Unknown-9",                                           // 9
+        "Unknown-10",                                          // 10
+        "Unknown-11",                                          // 11
+        "E-RABSubjecttoDataForwardingList",                    // 12
+        "E-RABtoReleaseListHOCmd",                             // 13
+        "E-RABDataForwardingItem",                             // 14
+        "E-RABReleaseItemBearerRelComp",                       // 15
+        "E-RABToBeSetupListBearerSUReq",                       // 16
+        "E-RABToBeSetupItemBearerSUReq",                       // 17
+        "E-RABAdmittedList",                                   // 18
+        "E-RABFailedToSetupListHOReqAck",                      // 19
+        "E-RABAdmittedItem",                                   // 20
+        "E-RABFailedtoSetupItemHOReqAck",                      // 21
+        "E-RABToBeSwitchedDLList",                             // 22
+        "E-RABToBeSwitchedDLItem",                             // 23
+        "E-RABToBeSetupListCtxtSUReq",                         // 24
+        "TraceActivation",                                     // 25
+        "NAS-PDU",                                             // 26
+        "E-RABToBeSetupItemHOReq",                             // 27
+        "E-RABSetupListBearerSURes",                           // 28
+        "E-RABFailedToSetupListBearerSURes",                   // 29
+        "E-RABToBeModifiedListBearerModReq",                   // 30
+        "E-RABModifyListBearerModRes",                         // 31
+        "E-RABFailedToModifyList",                             // 32
+        "E-RABToBeReleasedList",                               // 33
+        "E-RABFailedToReleaseList",                            // 34
+        "E-RABItem",                                           // 35
+        "E-RABToBeModifiedItemBearerModReq",                   // 36
+        "E-RABModifyItemBearerModRes",                         // 37
+        "E-RABReleaseItem",                                    // 38
+        "E-RABSetupItemBearerSURes",                           // 39
+        "SecurityContext",                                     // 40
+        "HandoverRestrictionList",                             // 41
+        "Unknown-42",                                          // 42
+        "UEPagingID",                                          // 43
+        "pagingDRX",                                           // 44
+        "Unknown-45",                                          // 45
+        "TAIList",                                             // 46
+        "TAIItem",                                             // 47
+        "E-RABFailedToSetupListCtxtSURes",                     // 48
+        "E-RABReleaseItemHOCmd",                               // 49
+        "E-RABSetupItemCtxtSURes",                             // 50
+        "E-RABSetupListCtxtSURes",                             // 51
+        "E-RABToBeSetupItemCtxtSUReq",                         // 52
+        "E-RABToBeSetupListHOReq",                             // 53
+        "Unknown-54",                                          // 54
+        "GERANtoLTEHOInformationRes",                          // 55
+        "Unknown-56",                                          // 56
+        "UTRANtoLTEHOInformationRes",                          // 57
+        "CriticalityDiagnostics",                              // 58
+        "Global-ENB-ID",                                       // 59
+        "eNBname",                                             // 60
+        "MMEname",                                             // 61
+        "Unknown-62",                                          // 62
+        "ServedPLMNs",                                         // 63
+        "SupportedTAs",                                        // 64
+        "TimeToWait",                                          // 65
+        "uEaggregateMaximumBitrate",                           // 66
+        "TAI",                                                 // 67
+        "Unknown-68",                                          // 68
+        "E-RABReleaseListBearerRelComp",                       // 69
+        "cdma2000PDU",                                         // 70
+        "cdma2000RATType",                                     // 71
+        "cdma2000SectorID",                                    // 72
+        "SecurityKey",                                         // 73
+        "UERadioCapability",                                   // 74
+        "GUMMEI-ID",                                           // 75
+        "Unknown-76",                                          // 76
+        "Unknown-77",                                          // 77
+        "E-RABInformationListItem",                            // 78
+        "Direct-Forwarding-Path-Availability",                 // 79
+        "UEIdentityIndexValue",                                // 80
+        "Unknown-81",                                          // 81
+        "Unknown-82",                                          // 82
+        "cdma2000HOStatus",                                    // 83
+        "cdma2000HORequiredIndication",                        // 84
+        "Unknown-85",                                          // 85
+        "E-UTRAN-Trace-ID",                                    // 86
+        "RelativeMMECapacity",                                 // 87
+        "SourceMME-UE-S1AP-ID",                                // 88
+        "Bearers-SubjectToStatusTransfer-Item",                // 89
+        "eNB-StatusTransfer-TransparentContainer",             // 90
+        "UE-associatedLogicalS1-ConnectionItem",               // 91
+        "ResetType",                                           // 92
+        "UE-associatedLogicalS1-ConnectionListResAck",         // 93
+        "E-RABToBeSwitchedULItem",                             // 94
+        "E-RABToBeSwitchedULList",                             // 95
+        "S-TMSI",                                              // 96
+        "cdma2000OneXRAND",                                    // 97
+        "RequestType",                                         // 98
+        "UE-S1AP-IDs",                                         // 99
+        "EUTRAN-CGI",                                          // 100
+        "OverloadResponse",                                    // 101
+        "cdma2000OneXSRVCCInfo",                               // 102
+        "E-RABFailedToBeReleasedList",                         // 103
+        "Source-ToTarget-TransparentContainer",                // 104
+        "ServedGUMMEIs",                                       // 105
+        "SubscriberProfileIDforRFP",                           // 106
+        "UESecurityCapabilities",                              // 107
+        "CSFallbackIndicator",                                 // 108
+        "CNDomain",                                            // 109
+        "E-RABReleasedList",                                   // 110
+        "MessageIdentifier",                                   // 111
+        "SerialNumber",                                        // 112
+        "WarningAreaList",                                     // 113
+        "RepetitionPeriod",                                    // 114
+        "NumberofBroadcastRequest",                            // 115
+        "WarningType",                                         // 116
+        "WarningSecurityInfo",                                 // 117
+        "DataCodingScheme",                                    // 118
+        "WarningMessageContents",                              // 119
+        "BroadcastCompletedAreaList",                          // 120
+        "Inter-SystemInformationTransferTypeEDT",              // 121
+        "Inter-SystemInformationTransferTypeMDT",              // 122
+        "Target-ToSource-TransparentContainer",                // 123
+        "SRVCCOperationPossible",                              // 124
+        "SRVCCHOIndication",                                   // 125
+        "NAS-DownlinkCount",                                   // 126
+        "CSG-Id",                                              // 127
+        "CSG-IdList",                                          // 128
+        "SONConfigurationTransferECT",                         // 129
+        "SONConfigurationTransferMCT",                         // 130
+        "TraceCollectionEntityIPAddress",                      // 131
+        "MSClassmark2",                                        // 132
+        "MSClassmark3",                                        // 133
+        "RRC-Establishment-Cause",                             // 134
+        "NASSecurityParametersfromE-UTRAN",                    // 135
+        "NASSecurityParameterstoE-UTRAN",                      // 136
+        "DefaultPagingDRX",                                    // 137
+        "Source-ToTarget-TransparentContainer-Secondary",      // 138
+        "Target-ToSource-TransparentContainer-Secondary",      // 139
+        "EUTRANRoundTripDelayEstimationInfo",                  // 140
+        "BroadcastCancelledAreaList",                          // 141
+        "ConcurrentWarningMessageIndicator",                   // 142
+        "Data-Forwarding-Not-Possible",                        // 143
+        "ExtendedRepetitionPeriod",                            // 144
+        "CellAccessMode",                                      // 145
+        "CSGMembershipStatus",                                 // 146
+        "LPPa-PDU",                                            // 147
+        "Routing-ID",                                          // 148
+        "Time-Synchronization-Info",                           // 149
+        "PS-ServiceNotAvailable",                              // 150
+        "PagingPriority",                                      // 151
+        "x2TNLConfigurationInfo",                              // 152
+        "eNBX2ExtendedTransportLayerAddresses",                // 153
+        "GUMMEIList",                                          // 154
+        "GW-TransportLayerAddress",                            // 155
+        "Correlation-ID",                                      // 156
+        "SourceMME-GUMMEI",                                    // 157
+        "MME-UE-S1AP-ID-2",                                    // 158
+        "RegisteredLAI",                                       // 159
+        "RelayNode-Indicator",                                 // 160
+        "TrafficLoadReductionIndication",                      // 161
+        "MDTConfiguration",                                    // 162
+        "MMERelaySupportIndicator",                            // 163
+        "GWContextReleaseIndication",                          // 164
+        "ManagementBasedMDTAllowed",                           // 165
+    };
+
+    constexpr std::string_view IE_ID_PREFIX = "IE_";
+} // anonymous namespace
+
+std::string_view getProcedureCodeName(uint8_t procedure_code) {
+    return procedure_code < PROCEDURE_NAMES.size() ? PROCEDURE_NAMES[procedure_code] : "Unknown";
+}
+
+std::string_view getIeNameFromId(uint16_t ie_id) {
+    return ie_id < IE_NAMES.size() ? IE_NAMES[ie_id] : std::string_view();
+}
+
+std::string ieDisplayName(uint16_t ie_id) {
+    std::string_view name = getIeNameFromId(ie_id);
+    return name.empty() ? std::string(IE_ID_PREFIX) + std::to_string(ie_id) : std::string(name);
 }
 
-std::string getIeNameFromId(uint16_t ie_id) {
-    // Map ProtocolIE-ID to IE name based on S1AP specification
-    switch (ie_id) {
-        case 0: return "MME-UE-S1AP-ID";
-        case 1: return "HandoverType";
-        case 2: return "Cause";
-        case 3: return "SourceID";
-        case 4: return "TargetID";
-        case 5: return "Unknown-5";
-        case 6: return "Unknown-6";
-        case 7: return "Unknown-7";
-        case 8: return "eNB-UE-S1AP-ID";
-        case 9: return "Unknown-9";
-        case 10: return "Unknown-10";
-        case 11: return "Unknown-11";
-        case 12: return "E-RABSubjecttoDataForwardingList";
-        case 13: return "E-RABtoReleaseListHOCmd";
-        case 14: return "E-RABDataForwardingItem";
-        case 15: return "E-RABReleaseItemBearerRelComp";
-        case 16: return "E-RABToBeSetupListBearerSUReq";
-        case 17: return "E-RABToBeSetupItemBearerSUReq";
-        case 18: return "E-RABAdmittedList";
-        case 19: return "E-RABFailedToSetupListHOReqAck";
-        case 20: return "E-RABAdmittedItem";
-        case 21: return "E-RABFailedtoSetupItemHOReqAck";
-        case 22: return "E-RABToBeSwitchedDLList";
-        case 23: return "E-RABToBeSwitchedDLItem";
-        case 24: return "E-RABToBeSetupListCtxtSUReq";
-        case 25: return "TraceActivation";
-        case 26: return "NAS-PDU";
-        case 27: return "E-RABToBeSetupItemHOReq";
-        case 28: return "E-RABSetupListBearerSURes";
-        case 29: return "E-RABFailedToSetupListBearerSURes";
-        case 30: return "E-RABToBeModifiedListBearerModReq";
-        case 31: return "E-RABModifyListBearerModRes";
-        case 32: return "E-RABFailedToModifyList";
-        case 33: return "E-RABToBeReleasedList";
-        case 34: return "E-RABFailedToReleaseList";
-        case 35: return "E-RABItem";
-        case 36: return "E-RABToBeModifiedItemBearerModReq";
-        case 37: return "E-RABModifyItemBearerModRes";
-        case 38: return "E-RABReleaseItem";
-        case 39: return "E-RABSetupItemBearerSURes";
-        case 40: return "SecurityContext";
-        case 41: return "HandoverRestrictionList";
-        case 42: return "Unknown-42";
-        case 43: return "UEPagingID";
-        case 44: return "pagingDRX";
-        case 45: return "Unknown-45";
-        case 46: return "TAIList";
-        case 47: return "TAIItem";
-        case 48: return "E-RABFailedToSetupListCtxtSURes";
-        case 49: return "E-RABReleaseItemHOCmd";
-        case 50: return "E-RABSetupItemCtxtSURes";
-        case 51: return "E-RABSetupListCtxtSURes";
-        case 52: return "E-RABToBeSetupItemCtxtSUReq";
-        case 53: return "E-RABToBeSetupListHOReq";
-        case 54: return "Unknown-54";
-        case 55: return "GERANtoLTEHOInformationRes";
-        case 56: return "Unknown-56";
-        case 57: return "UTRANtoLTEHOInformationRes";
-        case 58: return "CriticalityDiagnostics";
-        case 59: return "Global-ENB-ID";
-        case 60: return "eNBname";
-        case 61: return "MMEname";
-        case 62: return "Unknown-62";
-        case 63: return "ServedPLMNs";
-        case 64: return "SupportedTAs";
-        case 65: return "TimeToWait";
-        case 66: return "uEaggregateMaximumBitrate";
-        case 67: return "TAI";
-        case 68: return "Unknown-68";
-        case 69: return "E-RABReleaseListBearerRelComp";
-        case 70: return "cdma2000PDU";
-        case 71: return "cdma2000RATType";
-        case 72: return "cdma2000SectorID";
-        case 73: return "SecurityKey";
-        case 74: return "UERadioCapability";
-        case 75: return "GUMMEI-ID";
-        case 76: return "Unknown-76";
-        case 77: return "Unknown-77";
-        case 78: return "E-RABInformationListItem";
-        case 79: return "Direct-Forwarding-Path-Availability";
-        case 80: return "UEIdentityIndexValue";
-        case 81: return "Unknown-81";
-        case 82: return "Unknown-82";
-        case 83: return "cdma2000HOStatus";
-        case 84: return "cdma2000HORequiredIndication";
-        case 85: return "Unknown-85";
-        case 86: return "E-UTRAN-Trace-ID";
-        case 87: return "RelativeMMECapacity";
-        case 88: return "SourceMME-UE-S1AP-ID";
-        case 89: return "Bearers-SubjectToStatusTransfer-Item";
-        case 90: return "eNB-StatusTransfer-TransparentContainer";
-        case 91: return "UE-associatedLogicalS1-ConnectionItem";
-        case 92: return "ResetType";
-        case 93: return "UE-associatedLogicalS1-ConnectionListResAck";
-        case 94: return "E-RABToBeSwitchedULItem";
-        case 95: return "E-RABToBeSwitchedULList";
-        case 96: return "S-TMSI";
-        case 97: return "cdma2000OneXRAND";
-        case 98: return "RequestType";
-        case 99: return "UE-S1AP-IDs";
-        case 100: return "EUTRAN-CGI";
-        case 101: return "OverloadResponse";
-        case 102: return "cdma2000OneXSRVCCInfo";
-        case 103: return "E-RABFailedToBeReleasedList";
-        case 104: return "Source-ToTarget-TransparentContainer";
-        case 105: return "ServedGUMMEIs";
-        case 106: return "SubscriberProfileIDforRFP";
-        case 107: return "UESecurityCapabilities";
-        case 108: return "CSFallbackIndicator";
-        case 109: return "CNDomain";
-        case 110: return "E-RABReleasedList";
-        case 111: return "MessageIdentifier";
-        case 112: return "SerialNumber";
-        case 113: return "WarningAreaList";
-        case 114: return "RepetitionPeriod";
-        case 115: return "NumberofBroadcastRequest";
-        case 116: return "WarningType";
-        case 117: return "WarningSecurityInfo";
-        case 118: return "DataCodingScheme";
-        case 119: return "WarningMessageContents";
-        case 120: return "BroadcastCompletedAreaList";
-        case 121: return "Inter-SystemInformationTransferTypeEDT";
-        case 122: return "Inter-SystemInformationTransferTypeMDT";
-        case 123: return "Target-ToSource-TransparentContainer";
-        case 124: return "SRVCCOperationPossible";
-        case 125: return "SRVCCHOIndication";
-        case 126: return "NAS-DownlinkCount";
-        case 127: return "CSG-Id";
-        case 128: return "CSG-IdList";
-        case 129: return "SONConfigurationTransferECT";
-        case 130: return "SONConfigurationTransferMCT";
-        case 131: return "TraceCollectionEntityIPAddress";
-        case 132: return "MSClassmark2";
-        case 133: return "MSClassmark3";
-        case 134: return "RRC-Establishment-Cause";
-        case 135: return "NASSecurityParametersfromE-UTRAN";
-        case 136: return "NASSecurityParameterstoE-UTRAN";
-        case 137: return "DefaultPagingDRX";
-        case 138: return "Source-ToTarget-TransparentContainer-Secondary";
-        case 139: return "Target-ToSource-TransparentContainer-Secondary";
-        case 140: return "EUTRANRoundTripDelayEstimationInfo";
-        case 141: return "BroadcastCancelledAreaList";
-        case 142: return "ConcurrentWarningMessageIndicator";
-        case 143: return "Data-Forwarding-Not-Possible";
-        case 144: return "ExtendedRepetitionPeriod";
-        case 145: return "CellAccessMode";
-        case 146: return "CSGMembershipStatus";
-        case 147: return "LPPa-PDU";
-        case 148: return "Routing-ID";
-        case 149: return "Time-Synchronization-Info";
-        case 150: return "PS-ServiceNotAvailable";
-        case 151: return "PagingPriority";
-        case 152: return "x2TNLConfigurationInfo";
-        case 153: return "eNBX2ExtendedTransportLayerAddresses";
-        case 154: return "GUMMEIList";
-        case 155: return "GW-TransportLayerAddress";
-        case 156: return "Correlation-ID";
-        case 157: return "SourceMME-GUMMEI";
-        case 158: return "MME-UE-S1AP-ID-2";
-        case 159: return "RegisteredLAI";
-        case 160: return "RelayNode-Indicator";
-        case 161: return "TrafficLoadReductionIndication";
-        case 162: return "MDTConfiguration";
-        case 163: return "MMERelaySupportIndicator";
-        case 164: return "GWContextReleaseIndication";
-        case 165: return "ManagementBasedMDTAllowed";
-        default: return "IE_" + std::to_string(ie_id);
+std::optional<uint16_t> getIeIdFromName(std::string_view name) {
+    if (name.substr(0, IE_ID_PREFIX.size()) == IE_ID_PREFIX) {
+        uint16_t ie_id = 0;
+        auto digits = name.substr(IE_ID_PREFIX.size());
+        auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), ie_id);
+        if (ec == std::errc() && end == digits.data() + digits.size() && !digits.empty()) return ie_id;
+        return std::nullopt;
     }
+    auto it = std::find(IE_NAMES.begin(), IE_NAMES.end(), name);
+    if (it == IE_NAMES.end()) return std::nullopt;
+    return static_cast<uint16_t>(it - IE_NAMES.begin());
 }
 
 std::vector<uint32_t> findTeidPatterns(const uint8_t* data, size_t len) {
@@ -629,10 +665,66 @@ std::vector<uint32_t> findTeidPatterns(const uint8_t* data, size_t len) {
 }
 
 S1apParseResult parseS1apPdu(const uint8_t* s1ap_bytes, size_t len) {
+    S1apParseResult result = parseS1apPdu(std::span<const uint8_t>(s1ap_bytes, s1ap_bytes ? len : 0), true);
+    
+    // Owning copies, so the result stays valid after the caller's buffer goes
+    result.pdu = {};
+    if (s1ap_bytes) {
+        result.raw_bytes.assign(s1ap_bytes, s1ap_bytes + len);
+        result.s1ap_payload.assign(s1ap_bytes, s1ap_bytes + len);
+    }
+    return result;
+}
+
+std::string ieValueHex(std::span<const uint8_t> value) {
+    return s1see::utils::to_hex(value);
+}
+
+const S1apIe* S1apParseResult::findIe(S1apIeId id) const {
+    for (const auto& ie : ies) {
+        if (ie.id == static_cast<uint16_t>(id)) {
+            return &ie;
+        }
+    }
+    return nullptr;
+}
+
+std::span<const uint8_t> S1apParseResult::ieValue(S1apIeId id) const {
+    const S1apIe* ie = findIe(id);
+    return ie ? ieValue(*ie) : std::span<const uint8_t>();
+}
+
+namespace {
+    // Big-endian value of an INTEGER IE. Mirrors the historical
+    // stoul(hex, 16) conversion: up to 8 bytes, truncated to 32 bits.
+    std::optional<uint32_t> ieValueAsUint32(std::span<const uint8_t> value) {
+        if (value.empty() || value.size() > 8) {
+            return std::nullopt;
+        }
+        uint64_t v = 0;
+        for (uint8_t b : value) {
+            v = (v << 8) | b;
+        }
+        return static_cast<uint32_t>(v);
+    }
+} // anonymous namespace
+
+std::optional<uint32_t> S1apParseResult::mmeUeS1apId() const {
+    const S1apIe* ie = findIe(S1apIeId::MME_UE_S1AP_ID);
+    return ie ? ieValueAsUint32(ieValue(*ie)) : std::nullopt;
+}
+
+std::optional<uint32_t> S1apParseResult::enbUeS1apId() const {
+    const S1apIe* ie = findIe(S1apIeId::ENB_UE_S1AP_ID);
+    return ie ? ieValueAsUint32(ieValue(*ie)) : std::nullopt;
+}
+
+S1apParseResult parseS1apPdu(std::span<const uint8_t> pdu, bool format_hex_ies) {
     S1apParseResult result;
     result.decoded = false;
-    result.raw_bytes.assign(s1ap_bytes, s1ap_bytes + len);
-    result.s1ap_payload.assign(s1ap_bytes, s1ap_bytes + len);
+    result.pdu = pdu;
+    const uint8_t* s1ap_bytes = pdu.data();
+    size_t len = pdu.size();
     
     if (!s1ap_bytes || len < 1) {
         return result;
@@ -778,6 +870,7 @@ S1apParseResult parseS1apPdu(const uint8_t* s1ap_bytes, size_t len) {
     
     DEBUG_LOG << "[S1AP] Decoding " << num_ies << " protocolIE(s) starting at offset " 
               << offset << std::endl;
+    result.ies.reserve(std::min<uint32_t>(num_ies, 32));
     
     // Decode each ProtocolIE-Field
     for (uint32_t ie_idx = 0; ie_idx < num_ies && offset < len; ++ie_idx) {
@@ -867,41 +960,28 @@ S1apParseResult parseS1apPdu(const uint8_t* s1ap_bytes, size_t len) {
             break;
         }
         
-        // Store IE information
-        // Get IE name from ID using helper function
-        std::string ie_name = getIeNameFromId(ie_id);
-        
-        DEBUG_LOG << "[S1AP]   IE Name: " << ie_name << std::endl;
-        
-        // Store value as hex string for now
-        // In a full implementation, we would decode the value based on IE type
-        std::ostringstream value_hex;
-        value_hex << std::hex << std::setfill('0');
-        size_t bytes_to_show = (value_length > 32) ? 32 : value_length;  // Show first 32 bytes max
-        for (size_t i = 0; i < bytes_to_show && (offset + i) < len; ++i) {
-            value_hex << std::setw(2) << static_cast<unsigned>(s1ap_bytes[offset + i]);
-        }
+#ifdef ENABLE_DEBUG_LOGGING
+        DEBUG_LOG << "[S1AP]   IE Name: " << ieDisplayName(ie_id) << std::endl;
+        std::string value_hex = ieValueHex(pdu.subspan(offset, std::min<uint32_t>(value_length, 32)));
         if (value_length > 32) {
-            value_hex << "...";
+            value_hex += "...";  // Show first 32 bytes max
         }
-        
         DEBUG_LOG << "[S1AP]   Value (" << value_length << " bytes): " 
-                  << value_hex.str() << std::endl;
+                  << value_hex << std::endl;
+#endif
         
-        // Store full value in result
-        std::ostringstream full_value_hex;
-        full_value_hex << std::hex << std::setfill('0');
-        for (size_t i = 0; i < value_length && (offset + i) < len; ++i) {
-            full_value_hex << std::setw(2) << static_cast<unsigned>(s1ap_bytes[offset + i]);
+        // Store IE information: a reference into the PDU, no copy
+        result.ies.push_back({ie_id, static_cast<uint32_t>(offset), value_length});
+        if (format_hex_ies) {
+            result.information_elements[ie_id] = ieValueHex(pdu.subspan(offset, value_length));
         }
-        result.information_elements[ie_name] = full_value_hex.str();
         
         offset += value_length;
         DEBUG_LOG << "[S1AP]   IE #" << (ie_idx + 1) << " decoded, new offset: " << offset << std::endl;
     }
     
     DEBUG_LOG << "[S1AP] Finished decoding protocolIEs. Total decoded: " 
-              << result.information_elements.size() << " IEs" << std::endl;
+              << result.ies.size() << " IEs" << std::endl;
     
     result.decoded = true;
     
@@ -1262,28 +1342,206 @@ ERabSetupListCtxtSURes decodeERabSetupListCtxtSURes(
 
 // Helper function to convert hex string to bytes
 namespace {
+    // A trailing odd digit is ignored; invalid hex gives no bytes
     std::vector<uint8_t> hexToBytes(const std::string& hex) {
-        std::vector<uint8_t> bytes;
-        for (size_t i = 0; i < hex.length(); i += 2) {
-            if (i + 1 < hex.length()) {
-                std::string byte_str = hex.substr(i, 2);
-                bytes.push_back(static_cast<uint8_t>(std::stoul(byte_str, nullptr, 16)));
+        return s1see::utils::from_hex(std::string_view(hex).substr(0, hex.size() & ~size_t(1)));
+    }
+
+    // Value bytes of a top-level IE. Results from parseS1apPdu carry the
+    // typed IE table and are read in place; results rebuilt from a decoded
+    // tree only have the hex map, which is decoded into scratch.
+    std::optional<std::span<const uint8_t>> findIeValue(const S1apParseResult& s1ap_result,
+                                                        S1apIeId id,
+                                                        std::vector<uint8_t>& scratch) {
+        if (!s1ap_result.ies.empty()) {
+            const S1apIe* ie = s1ap_result.findIe(id);
+            if (!ie) return std::nullopt;
+            return s1ap_result.ieValue(*ie);
+        }
+        auto it = s1ap_result.information_elements.find(static_cast<uint16_t>(id));
+        if (it == s1ap_result.information_elements.end()) return std::nullopt;
+        scratch = hexToBytes(it->second);
+        return std::span<const uint8_t>(scratch);
+    }
+
+    // Walk E-RABToBeSetupListCtxtSUReq, passing each item's gTP-TEID and
+    // its NAS-PDU when it carries one
+    template <typename OnTeid, typename OnNasPdu>
+    void forEachERabToBeSetupItemCtxtSUReq(std::span<const uint8_t> erab_list_bytes,
+                                           OnTeid&& on_teid, OnNasPdu&& on_nas_pdu) {
+        size_t offset = 0;
+        size_t len = erab_list_bytes.size();
+        
+        uint64_t num_items = 0;
+        offset += 2; // Skip IE ID and criticality
+        
+        if (offset < len) {
+            uint8_t length_byte = erab_list_bytes[offset];
+            offset++;
+            
+            if ((length_byte & 0x80) == 0) {
+                num_items = length_byte & 0x7F;
+            } else {
+                uint8_t num_length_bytes = (length_byte & 0x7F) + 1;
+                if (num_length_bytes <= 4 && offset + num_length_bytes <= len) {
+                    num_items = 0;
+                    for (size_t i = 0; i < num_length_bytes; ++i) {
+                        num_items = (num_items << 8) | erab_list_bytes[offset + i];
+                    }
+                    offset += num_length_bytes;
+                }
+            }
+        }
+        
+        // Process each ProtocolIE-SingleContainer
+        if (num_items > 0) {
+            for (uint64_t item_idx = 0; item_idx < num_items && offset < len; ++item_idx) {
+                offset = 2; // Reset for each item
+                
+                // Read IE ID
+                if (offset >= len) break;
+                uint16_t ie_id = 0;
+                uint8_t first_byte = erab_list_bytes[offset];
+                if (first_byte & 0x80) {
+                    if (offset + 1 >= len) break;
+                    ie_id = ((first_byte & 0x7F) << 8) | erab_list_bytes[offset + 1];
+                    offset += 2;
+                } else {
+                    ie_id = first_byte;
+                    offset += 1;
+                }
+                
+                if (offset >= len) break;
+                offset += 1; // Skip criticality
+                
+                // Read value length
+                if (offset >= len) break;
+                uint32_t value_length = 0;
+                uint8_t value_length_byte = erab_list_bytes[offset];
+                offset++;
+                
+                if ((value_length_byte & 0x80) == 0) {
+                    value_length = value_length_byte & 0x7F;
+                } else {
+                    uint8_t num_length_bytes = (value_length_byte & 0x7F) + 1;
+                    if (offset + num_length_bytes > len) break;
+                    for (size_t i = 0; i < num_length_bytes; ++i) {
+                        value_length = (value_length << 8) | erab_list_bytes[offset + i];
+                    }
+                    offset += num_length_bytes;
+                }
+                
+                if (offset + value_length > len) break;
+                
+                // If this is IE ID 52 (E-RABToBeSetupItemCtxtSUReq), parse it
+                if (ie_id == 52) {
+                    size_t item_offset = offset;
+                    size_t item_len = value_length;
+                    
+                    // Skip e-RAB-ID (tag 0, 1 byte)
+                    if (item_offset >= offset + item_len) break;
+                    item_offset += 1;
+                    
+                    // Skip e-RABlevelQoSParameters (tag 1, SEQUENCE)
+                    if (item_offset >= offset + item_len) break;
+                    uint8_t qos_length_byte = erab_list_bytes[item_offset];
+                    item_offset++;
+                    uint32_t qos_len = 0;
+                    if ((qos_length_byte & 0x80) == 0) {
+                        qos_len = qos_length_byte & 0x7F;
+                    } else {
+                        uint8_t num_qos_bytes = (qos_length_byte & 0x7F) + 1;
+                        if (item_offset + num_qos_bytes > offset + item_len) break;
+                        for (size_t i = 0; i < num_qos_bytes; ++i) {
+                            qos_len = (qos_len << 8) | erab_list_bytes[item_offset + i];
+                        }
+                        item_offset += num_qos_bytes;
+                    }
+                    if (item_offset + qos_len > offset + item_len) break;
+                    item_offset += qos_len;
+                    
+                    // Skip transportLayerAddress (tag 2, BIT STRING)
+                    if (item_offset >= offset + item_len) break;
+                    uint8_t transport_length_byte = erab_list_bytes[item_offset];
+                    item_offset++;
+                    uint32_t transport_bits = 0;
+                    if ((transport_length_byte & 0x80) == 0) {
+                        transport_bits = transport_length_byte & 0x7F;
+                    } else {
+                        uint8_t num_transport_bytes = (transport_length_byte & 0x7F) + 1;
+                        if (item_offset + num_transport_bytes > offset + item_len) break;
+                        for (size_t i = 0; i < num_transport_bytes; ++i) {
+                            transport_bits = (transport_bits << 8) | erab_list_bytes[item_offset + i];
+                        }
+                        item_offset += num_transport_bytes;
+                    }
+                    size_t transport_bytes_len = (transport_bits + 7) / 8;
+                    if (item_offset + transport_bytes_len > offset + item_len) break;
+                    item_offset += transport_bytes_len;
+                    
+                    // Skip gTP-TEID (tag 3, OCTET STRING, 4 bytes)
+                    item_offset += 5; // Tag + length + 4 bytes
+                    if (item_offset + 4 > offset + item_len) break;
+                    uint32_t gtp_teid = (static_cast<uint32_t>(erab_list_bytes[item_offset]) << 24) |
+                                        (static_cast<uint32_t>(erab_list_bytes[item_offset + 1]) << 16) |
+                                        (static_cast<uint32_t>(erab_list_bytes[item_offset + 2]) << 8) |
+                                        static_cast<uint32_t>(erab_list_bytes[item_offset + 3]);
+                    on_teid(gtp_teid);
+                    item_offset += 4;
+                    
+                    // Check for nAS-PDU (tag 4, OPTIONAL)
+                    if (item_offset < offset + item_len) {
+                        bool has_nas_pdu = true; // Assume present
+                        
+                        if (has_nas_pdu) {
+                            // Read NAS-PDU length determinant
+                            if (item_offset >= offset + item_len) break;
+                            uint8_t nas_length_byte = erab_list_bytes[item_offset];
+                            item_offset++;
+                            uint32_t nas_pdu_len = 0;
+                            if ((nas_length_byte & 0x80) == 0) {
+                                nas_pdu_len = nas_length_byte & 0x7F;
+                            } else {
+                                uint8_t num_nas_bytes = (nas_length_byte & 0x7F) + 1;
+                                if (item_offset + num_nas_bytes > offset + item_len) break;
+                                for (size_t i = 0; i < num_nas_bytes; ++i) {
+                                    nas_pdu_len = (nas_pdu_len << 8) | erab_list_bytes[item_offset + i];
+                                }
+                                item_offset += num_nas_bytes;
+                            }
+                            
+                            if (item_offset + nas_pdu_len <= offset + item_len) {
+                                on_nas_pdu(erab_list_bytes.subspan(item_offset, nas_pdu_len));
+                            }
+                        }
+                    }
+                }
+                
+                offset += value_length;
             }
         }
-        return bytes;
+    }
+
+    // m-TMSI (last 4 bytes of S-TMSI: mMEC + m-TMSI) as uppercase hex
+    std::vector<std::string> extractTmsiFromSTmsi(std::span<const uint8_t> s_tmsi) {
+        if (s_tmsi.size() < 5) {
+            return {};
+        }
+        std::string tmsi = s1see::utils::to_hex(s_tmsi.last(4));
+        std::transform(tmsi.begin(), tmsi.end(), tmsi.begin(), ::toupper);
+        return {tmsi};
     }
 } // anonymous namespace
 
 // Extract TMSI from S-TMSI IE in information_elements
 std::vector<std::string> extractTmsiFromIEList(
-    const std::unordered_map<std::string, std::string>& information_elements) {
+    const std::unordered_map<uint16_t, std::string>& information_elements) {
     
     std::vector<std::string> tmsis;
     
     DEBUG_LOG << "[S1AP] extractTmsiFromIEList: Looking for S-TMSI IE in information_elements" << std::endl;
     
-    // Look for "S-TMSI" IE name
-    auto s_tmsi_it = information_elements.find("S-TMSI");
+    auto s_tmsi_it = information_elements.find(static_cast<uint16_t>(S1apIeId::S_TMSI));
     if (s_tmsi_it == information_elements.end()) {
         DEBUG_LOG << "[S1AP] extractTmsiFromIEList: S-TMSI IE not found in information_elements" << std::endl;
         return tmsis;
@@ -1337,21 +1595,19 @@ std::vector<std::string> extractImsisFromS1ap(const S1apParseResult& s1ap_result
     DEBUG_LOG << "[S1AP] extractImsisFromS1ap: Starting IMSI extraction from S1AP" << std::endl;
     
     // IMSI in S1AP is typically in NAS messages, not directly in S1AP IEs
-    // First, try to extract NAS PDU from information_elements (decoded IEs)
+    // First, try to extract NAS PDU from the decoded IEs
     
-    // Check if NAS-PDU IE is present in information_elements
-    auto nas_pdu_it = s1ap_result.information_elements.find("NAS-PDU");
-    if (nas_pdu_it != s1ap_result.information_elements.end()) {
-        DEBUG_LOG << "[S1AP] extractImsisFromS1ap: Found NAS-PDU IE in information_elements" << std::endl;
+    // Check if NAS-PDU IE is present
+    std::vector<uint8_t> nas_pdu_scratch;
+    auto nas_pdu = findIeValue(s1ap_result, S1apIeId::NAS_PDU, nas_pdu_scratch);
+    if (nas_pdu) {
+        DEBUG_LOG << "[S1AP] extractImsisFromS1ap: Found NAS-PDU IE" << std::endl;
         
-        const std::string& nas_pdu_hex = nas_pdu_it->second;
-        DEBUG_LOG << "[S1AP] extractImsisFromS1ap: NAS-PDU hex value length: " << nas_pdu_hex.length() 
-                  << " chars (" << (nas_pdu_hex.length() / 2) << " bytes)" << std::endl;
+        std::span<const uint8_t> nas_pdu_bytes = *nas_pdu;
+        DEBUG_LOG << "[S1AP] extractImsisFromS1ap: NAS-PDU value length: " << nas_pdu_bytes.size() 
+                  << " bytes" << std::endl;
         
-        if (!nas_pdu_hex.empty()) {
-            // Convert hex string to bytes
-            std::vector<uint8_t> nas_pdu_bytes = hexToBytes(nas_pdu_hex);
-            DEBUG_LOG << "[S1AP] extractImsisFromS1ap: Converted NAS-PDU to " << nas_pdu_bytes.size() << " bytes" << std::endl;
+        if (!nas_pdu_bytes.empty()) {
             
             // Skip first byte (length byte) before passing to NAS decoder
             if (nas_pdu_bytes.size() >= 2) {
@@ -1383,13 +1639,13 @@ std::vector<std::string> extractImsisFromS1ap(const S1apParseResult& s1ap_result
         
         // Fallback: Try to extract NAS PDUs from raw_bytes using parser
 
-        if (!s1ap_result.raw_bytes.empty()) {
+        if (!s1ap_result.bytes().empty()) {
             DEBUG_LOG << "[S1AP] extractImsisFromS1ap: Falling back to raw_bytes extraction (size: " 
-                      << s1ap_result.raw_bytes.size() << " bytes)" << std::endl;
+                      << s1ap_result.bytes().size() << " bytes)" << std::endl;
             
             auto nas_pdus = extractNasPdusFromS1ap(
-                s1ap_result.raw_bytes.data(),
-                s1ap_result.raw_bytes.size()
+                s1ap_result.bytes().data(),
+                s1ap_result.bytes().size()
             );
             
             DEBUG_LOG << "[S1AP] extractImsisFromS1ap: Extracted " << nas_pdus.size() << " NAS PDU(s) from raw_bytes" << std::endl;
@@ -1435,8 +1691,13 @@ TmsiExtractionResult extractTmsisFromS1ap(const S1apParseResult& s1ap_result) {
     
     DEBUG_LOG << "[S1AP] extractTmsisFromS1ap: Starting TMSI extraction from S1AP" << std::endl;
     
-    // First, try to extract TMSI from S-TMSI IE in information_elements
-    auto ie_tmsis = extractTmsiFromIEList(s1ap_result.information_elements);
+    // First, try to extract TMSI from S-TMSI IE
+    std::vector<std::string> ie_tmsis;
+    if (!s1ap_result.ies.empty()) {
+        ie_tmsis = extractTmsiFromSTmsi(s1ap_result.ieValue(S1apIeId::S_TMSI));
+    } else {
+        ie_tmsis = extractTmsiFromIEList(s1ap_result.information_elements);
+    }
     if (!ie_tmsis.empty()) {
         DEBUG_LOG << "[S1AP] extractTmsisFromS1ap: Found " << ie_tmsis.size() 
                   << " TMSI(s) from S-TMSI IE" << std::endl;
@@ -1444,11 +1705,11 @@ TmsiExtractionResult extractTmsisFromS1ap(const S1apParseResult& s1ap_result) {
     }
     
     // Also extract from NAS PDUs (similar to IMSI extraction)
-    auto nas_pdu_it = s1ap_result.information_elements.find("NAS-PDU");
-    if (nas_pdu_it != s1ap_result.information_elements.end()) {
-        const std::string& nas_pdu_hex = nas_pdu_it->second;
-        if (!nas_pdu_hex.empty()) {
-            std::vector<uint8_t> nas_pdu_bytes = hexToBytes(nas_pdu_hex);
+    std::vector<uint8_t> nas_pdu_scratch;
+    auto nas_pdu = findIeValue(s1ap_result, S1apIeId::NAS_PDU, nas_pdu_scratch);
+    if (nas_pdu) {
+        std::span<const uint8_t> nas_pdu_bytes = *nas_pdu;
+        if (!nas_pdu_bytes.empty()) {
             if (nas_pdu_bytes.size() >= 2) {
                 auto nas_tmsis = nas_parser::extractTmsiFromNas(
                     nas_pdu_bytes.data() + 1,
@@ -1465,190 +1726,35 @@ TmsiExtractionResult extractTmsisFromS1ap(const S1apParseResult& s1ap_result) {
         DEBUG_LOG << "[S1AP] extractTmsisFromS1ap: Detected InitialContextSetupRequest procedure" << std::endl;
         
         // Look for E-RABToBeSetupListCtxtSUReq IE (ID 24)
-        auto erab_list_it = s1ap_result.information_elements.find("E-RABToBeSetupListCtxtSUReq");
-        if (erab_list_it != s1ap_result.information_elements.end()) {
+        std::vector<uint8_t> erab_list_scratch;
+        auto erab_list = findIeValue(s1ap_result, S1apIeId::E_RAB_TO_BE_SETUP_LIST_CTXT_SU_REQ, erab_list_scratch);
+        if (erab_list) {
             DEBUG_LOG << "[S1AP] extractTmsisFromS1ap: Found E-RABToBeSetupListCtxtSUReq IE" << std::endl;
             
-            const std::string& erab_list_hex = erab_list_it->second;
-            DEBUG_LOG << "[S1AP] extractTmsisFromS1ap: E-RABToBeSetupListCtxtSUReq hex value length: " 
-                      << erab_list_hex.length() << " chars (" << (erab_list_hex.length() / 2) << " bytes)" << std::endl;
+            std::span<const uint8_t> erab_list_bytes = *erab_list;
+            DEBUG_LOG << "[S1AP] extractTmsisFromS1ap: E-RABToBeSetupListCtxtSUReq value length: " 
+                      << erab_list_bytes.size() << " bytes" << std::endl;
             
-            if (!erab_list_hex.empty()) {
-                // Convert hex string to bytes
-                std::vector<uint8_t> erab_list_bytes = hexToBytes(erab_list_hex);
-                DEBUG_LOG << "[S1AP] extractTmsisFromS1ap: Converted E-RABToBeSetupListCtxtSUReq to " 
-                          << erab_list_bytes.size() << " bytes" << std::endl;
-                
-                // Parse E-RABToBeSetupListCtxtSUReq structure - full implementation
-                size_t offset = 0;
-                size_t len = erab_list_bytes.size();
-                
-                uint64_t num_items = 0;
-                offset += 2; // Skip IE ID and criticality
-                
-                if (offset < len) {
-                    uint8_t length_byte = erab_list_bytes[offset];
-                    offset++;
-                    
-                    if ((length_byte & 0x80) == 0) {
-                        num_items = length_byte & 0x7F;
-                    } else {
-                        uint8_t num_length_bytes = (length_byte & 0x7F) + 1;
-                        if (num_length_bytes <= 4 && offset + num_length_bytes <= len) {
-                            num_items = 0;
-                            for (size_t i = 0; i < num_length_bytes; ++i) {
-                                num_items = (num_items << 8) | erab_list_bytes[offset + i];
-                            }
-                            offset += num_length_bytes;
-                        }
-                    }
-                }
+            if (!erab_list_bytes.empty()) {
                 
-                // Process each ProtocolIE-SingleContainer
-                if (num_items > 0) {
-                    for (uint64_t item_idx = 0; item_idx < num_items && offset < len; ++item_idx) {
-                        offset = 2; // Reset for each item
-                        
-                        // Read IE ID
-                        if (offset >= len) break;
-                        uint16_t ie_id = 0;
-                        uint8_t first_byte = erab_list_bytes[offset];
-                        if (first_byte & 0x80) {
-                            if (offset + 1 >= len) break;
-                            ie_id = ((first_byte & 0x7F) << 8) | erab_list_bytes[offset + 1];
-                            offset += 2;
-                        } else {
-                            ie_id = first_byte;
-                            offset += 1;
-                        }
-                        
-                        if (offset >= len) break;
-                        offset += 1; // Skip criticality
-                        
-                        // Read value length
-                        if (offset >= len) break;
-                        uint32_t value_length = 0;
-                        uint8_t value_length_byte = erab_list_bytes[offset];
-                        offset++;
-                        
-                        if ((value_length_byte & 0x80) == 0) {
-                            value_length = value_length_byte & 0x7F;
-                        } else {
-                            uint8_t num_length_bytes = (value_length_byte & 0x7F) + 1;
-                            if (offset + num_length_bytes > len) break;
-                            for (size_t i = 0; i < num_length_bytes; ++i) {
-                                value_length = (value_length << 8) | erab_list_bytes[offset + i];
-                            }
-                            offset += num_length_bytes;
-                        }
-                        
-                        if (offset + value_length > len) break;
-                        
-                        // If this is IE ID 52 (E-RABToBeSetupItemCtxtSUReq), parse it
-                        if (ie_id == 52) {
-                            size_t item_offset = offset;
-                            size_t item_len = value_length;
-                            
-                            // Skip e-RAB-ID (tag 0, 1 byte)
-                            if (item_offset >= offset + item_len) break;
-                            item_offset += 1;
-                            
-                            // Skip e-RABlevelQoSParameters (tag 1, SEQUENCE)
-                            if (item_offset >= offset + item_len) break;
-                            uint8_t qos_length_byte = erab_list_bytes[item_offset];
-                            item_offset++;
-                            uint32_t qos_len = 0;
-                            if ((qos_length_byte & 0x80) == 0) {
-                                qos_len = qos_length_byte & 0x7F;
-                            } else {
-                                uint8_t num_qos_bytes = (qos_length_byte & 0x7F) + 1;
-                                if (item_offset + num_qos_bytes > offset + item_len) break;
-                                for (size_t i = 0; i < num_qos_bytes; ++i) {
-                                    qos_len = (qos_len << 8) | erab_list_bytes[item_offset + i];
-                                }
-                                item_offset += num_qos_bytes;
-                            }
-                            if (item_offset + qos_len > offset + item_len) break;
-                            item_offset += qos_len;
-                            
-                            // Skip transportLayerAddress (tag 2, BIT STRING)
-                            if (item_offset >= offset + item_len) break;
-                            uint8_t transport_length_byte = erab_list_bytes[item_offset];
-                            item_offset++;
-                            uint32_t transport_bits = 0;
-                            if ((transport_length_byte & 0x80) == 0) {
-                                transport_bits = transport_length_byte & 0x7F;
-                            } else {
-                                uint8_t num_transport_bytes = (transport_length_byte & 0x7F) + 1;
-                                if (item_offset + num_transport_bytes > offset + item_len) break;
-                                for (size_t i = 0; i < num_transport_bytes; ++i) {
-                                    transport_bits = (transport_bits << 8) | erab_list_bytes[item_offset + i];
-                                }
-                                item_offset += num_transport_bytes;
-                            }
-                            size_t transport_bytes_len = (transport_bits + 7) / 8;
-                            if (item_offset + transport_bytes_len > offset + item_len) break;
-                            item_offset += transport_bytes_len;
-                            
-                            // Skip gTP-TEID (tag 3, OCTET STRING, 4 bytes)
-                            item_offset += 5; // Tag + length + 4 bytes
-                            if (item_offset + 4 > offset + item_len) break;
-                            uint32_t gtp_teid = (static_cast<uint32_t>(erab_list_bytes[item_offset]) << 24) |
-                                                (static_cast<uint32_t>(erab_list_bytes[item_offset + 1]) << 16) |
-                                                (static_cast<uint32_t>(erab_list_bytes[item_offset + 2]) << 8) |
-                                                static_cast<uint32_t>(erab_list_bytes[item_offset + 3]);
-                            result.teids.push_back(gtp_teid);
-                            item_offset += 4;
-                            
-                            // Check for nAS-PDU (tag 4, OPTIONAL)
-                            if (item_offset < offset + item_len) {
-                                bool has_nas_pdu = true; // Assume present
-                                
-                                if (has_nas_pdu) {
-                                    // Read NAS-PDU length determinant
-                                    if (item_offset >= offset + item_len) break;
-                                    uint8_t nas_length_byte = erab_list_bytes[item_offset];
-                                    item_offset++;
-                                    uint32_t nas_pdu_len = 0;
-                                    if ((nas_length_byte & 0x80) == 0) {
-                                        nas_pdu_len = nas_length_byte & 0x7F;
-                                    } else {
-                                        uint8_t num_nas_bytes = (nas_length_byte & 0x7F) + 1;
-                                        if (item_offset + num_nas_bytes > offset + item_len) break;
-                                        for (size_t i = 0; i < num_nas_bytes; ++i) {
-                                            nas_pdu_len = (nas_pdu_len << 8) | erab_list_bytes[item_offset + i];
-                                        }
-                                        item_offset += num_nas_bytes;
-                                    }
-                                    
-                                    if (item_offset + nas_pdu_len <= offset + item_len) {
-                                        // Extract TMSI from NAS PDU
-                                        auto nas_tmsis = nas_parser::extractTmsiFromNas(
-                                            erab_list_bytes.data() + item_offset,
-                                            nas_pdu_len
-                                        );
-                                        
-                                        if (!nas_tmsis.empty()) {
-                                            tmsis.insert(tmsis.end(), nas_tmsis.begin(), nas_tmsis.end());
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                        
-                        offset += value_length;
-                    }
-                }
+                forEachERabToBeSetupItemCtxtSUReq(
+                    erab_list_bytes,
+                    [&](uint32_t gtp_teid) { result.teids.push_back(gtp_teid); },
+                    [&](std::span<const uint8_t> nas_pdu_bytes) {
+                        // Extract TMSI from NAS PDU
+                        auto nas_tmsis = nas_parser::extractTmsiFromNas(nas_pdu_bytes.data(), nas_pdu_bytes.size());
+                        tmsis.insert(tmsis.end(), nas_tmsis.begin(), nas_tmsis.end());
+                    });
             }
         }
     }
     
     // Check for E-RABSetupListCtxtSURes (InitialContextSetupResponse)
-    auto erab_setup_list_it = s1ap_result.information_elements.find("E-RABSetupListCtxtSURes");
-    if (erab_setup_list_it != s1ap_result.information_elements.end()) {
-        const std::string& erab_setup_list_hex = erab_setup_list_it->second;
-        if (!erab_setup_list_hex.empty()) {
-            std::vector<uint8_t> erab_setup_list_bytes = hexToBytes(erab_setup_list_hex);
+    std::vector<uint8_t> erab_setup_list_scratch;
+    auto erab_setup_list = findIeValue(s1ap_result, S1apIeId::E_RAB_SETUP_LIST_CTXT_SU_RES, erab_setup_list_scratch);
+    if (erab_setup_list) {
+        std::span<const uint8_t> erab_setup_list_bytes = *erab_setup_list;
+        if (!erab_setup_list_bytes.empty()) {
             ERabSetupListCtxtSURes decoded_list = 
                 decodeERabSetupListCtxtSURes(
                     erab_setup_list_bytes.data(), 
@@ -1691,12 +1797,12 @@ std::vector<std::string> extractImeisvsFromS1ap(const S1apParseResult& s1ap_resu
     DEBUG_LOG << "[S1AP] extractImeisvsFromS1ap: Starting IMEISV extraction from S1AP" << std::endl;
     
     // IMEISV in S1AP is typically in NAS messages, not directly in S1AP IEs
-    // Check if NAS-PDU IE is present in information_elements
-    auto nas_pdu_it = s1ap_result.information_elements.find("NAS-PDU");
-    if (nas_pdu_it != s1ap_result.information_elements.end()) {
-        const std::string& nas_pdu_hex = nas_pdu_it->second;
-        if (!nas_pdu_hex.empty()) {
-            std::vector<uint8_t> nas_pdu_bytes = hexToBytes(nas_pdu_hex);
+    // Check if NAS-PDU IE is present
+    std::vector<uint8_t> nas_pdu_scratch;
+    auto nas_pdu = findIeValue(s1ap_result, S1apIeId::NAS_PDU, nas_pdu_scratch);
+    if (nas_pdu) {
+        std::span<const uint8_t> nas_pdu_bytes = *nas_pdu;
+        if (!nas_pdu_bytes.empty()) {
             if (nas_pdu_bytes.size() >= 2) {
                 auto nas_imeisvs = nas_parser::extractImeisvFromNas(
                     nas_pdu_bytes.data() + 1,
@@ -1708,10 +1814,10 @@ std::vector<std::string> extractImeisvsFromS1ap(const S1apParseResult& s1ap_resu
     }
     
     // Fallback: Try to extract NAS PDUs from raw_bytes
-    if (imeisvs.empty() && !s1ap_result.raw_bytes.empty()) {
+    if (imeisvs.empty() && !s1ap_result.bytes().empty()) {
         auto nas_pdus = extractNasPdusFromS1ap(
-            s1ap_result.raw_bytes.data(),
-            s1ap_result.raw_bytes.size()
+            s1ap_result.bytes().data(),
+            s1ap_result.bytes().size()
         );
         
         for (const auto& nas_pdu : nas_pdus) {
@@ -1737,53 +1843,62 @@ std::pair<std::optional<uint32_t>, std::optional<uint32_t>> extractS1apIds(const
     std::optional<uint32_t> mme_ue_s1ap_id = std::nullopt;
     std::optional<uint32_t> enb_ue_s1ap_id = std::nullopt;
     
-    DEBUG_LOG << "[S1AP] extractS1apIds: Starting S1AP ID extraction from information_elements" << std::endl;
+    DEBUG_LOG << "[S1AP] extractS1apIds: Starting S1AP ID extraction from IEs" << std::endl;
     
     // First, try to extract from UE-S1AP-IDs IE (contains both IDs in one field)
     // MME-UE-S1AP-ID is in the first half (4 bytes), eNB-UE-S1AP-ID is in the second half (4 bytes)
-    auto ue_s1ap_ids_it = s1ap_result.information_elements.find("UE-S1AP-IDs");
-    if (ue_s1ap_ids_it != s1ap_result.information_elements.end()) {
-        const std::string& ue_s1ap_ids_hex = ue_s1ap_ids_it->second;
-        DEBUG_LOG << "[S1AP] extractS1apIds: Found UE-S1AP-IDs in information_elements: " << ue_s1ap_ids_hex << std::endl;
+    std::vector<uint8_t> ue_s1ap_ids_scratch;
+    std::optional<std::span<const uint8_t>> ue_s1ap_ids;
+    try {
+        ue_s1ap_ids = findIeValue(s1ap_result, S1apIeId::UE_S1AP_IDS, ue_s1ap_ids_scratch);
+    } catch (const std::exception& e) {
+        DEBUG_LOG << "[S1AP] extractS1apIds: Failed to parse UE-S1AP-IDs: " << e.what() << std::endl;
+    }
+    if (ue_s1ap_ids) {
+        std::span<const uint8_t> bytes = *ue_s1ap_ids;
+        DEBUG_LOG << "[S1AP] extractS1apIds: Found UE-S1AP-IDs (" << bytes.size() << " bytes)" << std::endl;
         
-        if (!ue_s1ap_ids_hex.empty()) {
-            try {
-                // Convert hex string to bytes
-                std::vector<uint8_t> bytes = hexToBytes(ue_s1ap_ids_hex);
+        if (!bytes.empty()) {
+            // UE-S1AP-IDs should be 8 bytes (4 bytes for MME-UE-S1AP-ID + 4 bytes for eNB-UE-S1AP-ID)
+            if (bytes.size() >= 8) {
+                // Extract MME-UE-S1AP-ID from first 4 bytes (big-endian)
+                uint32_t mme_id = (static_cast<uint32_t>(bytes[0]) << 24) |
+                                 (static_cast<uint32_t>(bytes[1]) << 16) |
+                                 (static_cast<uint32_t>(bytes[2]) << 8) |
+                                 static_cast<uint32_t>(bytes[3]);
+                mme_ue_s1ap_id = mme_id;
+                DEBUG_LOG << "[S1AP] extractS1apIds: Extracted MME-UE-S1AP-ID from UE-S1AP-IDs: " << mme_ue_s1ap_id.value() << std::endl;
                 
-                // UE-S1AP-IDs should be 8 bytes (4 bytes for MME-UE-S1AP-ID + 4 bytes for eNB-UE-S1AP-ID)
-                if (bytes.size() >= 8) {
-                    // Extract MME-UE-S1AP-ID from first 4 bytes (big-endian)
-                    uint32_t mme_id = (static_cast<uint32_t>(bytes[0]) << 24) |
-                                     (static_cast<uint32_t>(bytes[1]) << 16) |
-                                     (static_cast<uint32_t>(bytes[2]) << 8) |
-                                     static_cast<uint32_t>(bytes[3]);
-                    mme_ue_s1ap_id = mme_id;
-                    DEBUG_LOG << "[S1AP] extractS1apIds: Extracted MME-UE-S1AP-ID from UE-S1AP-IDs: " << mme_ue_s1ap_id.value() << std::endl;
-                    
-                    // Extract eNB-UE-S1AP-ID from next 4 bytes (big-endian)
-                    // Note: eNB-UE-S1AP-ID is 24 bits, but stored in 4 bytes, so we take all 4 bytes
-                    uint32_t enb_id = (static_cast<uint32_t>(bytes[4]) << 24) |
-                                     (static_cast<uint32_t>(bytes[5]) << 16) |
-                                     (static_cast<uint32_t>(bytes[6]) << 8) |
-                                     static_cast<uint32_t>(bytes[7]);
-                    enb_ue_s1ap_id = enb_id;
-                    DEBUG_LOG << "[S1AP] extractS1apIds: Extracted eNB-UE-S1AP-ID from UE-S1AP-IDs: " << enb_ue_s1ap_id.value() << std::endl;
-                } else {
-                    DEBUG_LOG << "[S1AP] extractS1apIds: UE-S1AP-IDs has insufficient bytes (" << bytes.size() << "), expected 8" << std::endl;
-                }
-            } catch (const std::exception& e) {
-                DEBUG_LOG << "[S1AP] extractS1apIds: Failed to parse UE-S1AP-IDs: " << e.what() << std::endl;
+                // Extract eNB-UE-S1AP-ID from next 4 bytes (big-endian)
+                // Note: eNB-UE-S1AP-ID is 24 bits, but stored in 4 bytes, so we take all 4 bytes
+                uint32_t enb_id = (static_cast<uint32_t>(bytes[4]) << 24) |
+                                 (static_cast<uint32_t>(bytes[5]) << 16) |
+                                 (static_cast<uint32_t>(bytes[6]) << 8) |
+                                 static_cast<uint32_t>(bytes[7]);
+                enb_ue_s1ap_id = enb_id;
+                DEBUG_LOG << "[S1AP] extractS1apIds: Extracted eNB-UE-S1AP-ID from UE-S1AP-IDs: " << enb_ue_s1ap_id.value() << std::endl;
+            } else {
+                DEBUG_LOG << "[S1AP] extractS1apIds: UE-S1AP-IDs has insufficient bytes (" << bytes.size() << "), expected 8" << std::endl;
             }
         }
     } else {
-        DEBUG_LOG << "[S1AP] extractS1apIds: UE-S1AP-IDs not found in information_elements, trying individual IEs" << std::endl;
+        DEBUG_LOG << "[S1AP] extractS1apIds: UE-S1AP-IDs not found, trying individual IEs" << std::endl;
     }
     
     // If UE-S1AP-IDs was not found or failed, try individual IEs
+    // Typed IE table: read the INTEGER in place
+    if (!s1ap_result.ies.empty()) {
+        if (!mme_ue_s1ap_id.has_value()) {
+            mme_ue_s1ap_id = s1ap_result.mmeUeS1apId();
+        }
+        if (!enb_ue_s1ap_id.has_value()) {
+            enb_ue_s1ap_id = s1ap_result.enbUeS1apId();
+        }
+    }
+    
     // Try to extract MME-UE-S1AP-ID from information_elements
-    if (!mme_ue_s1ap_id.has_value()) {
-        auto mme_id_it = s1ap_result.information_elements.find("MME-UE-S1AP-ID");
+    if (!mme_ue_s1ap_id.has_value() && s1ap_result.ies.empty()) {
+        auto mme_id_it = s1ap_result.information_elements.find(static_cast<uint16_t>(S1apIeId::MME_UE_S1AP_ID));
         if (mme_id_it != s1ap_result.information_elements.end()) {
             const std::string& mme_id_hex = mme_id_it->second;
             DEBUG_LOG << "[S1AP] extractS1apIds: Found MME-UE-S1AP-ID in information_elements: " << mme_id_hex << std::endl;
@@ -1808,8 +1923,8 @@ std::pair<std::optional<uint32_t>, std::optional<uint32_t>> extractS1apIds(const
     }
     
     // Try to extract eNB-UE-S1AP-ID from information_elements
-    if (!enb_ue_s1ap_id.has_value()) {
-        auto enb_id_it = s1ap_result.information_elements.find("eNB-UE-S1AP-ID");
+    if (!enb_ue_s1ap_id.has_value() && s1ap_result.ies.empty()) {
+        auto enb_id_it = s1ap_result.information_elements.find(static_cast<uint16_t>(S1apIeId::ENB_UE_S1AP_ID));
         if (enb_id_it != s1ap_result.information_elements.end()) {
             const std::string& enb_id_hex = enb_id_it->second;
             DEBUG_LOG << "[S1AP] extractS1apIds: Found eNB-UE-S1AP-ID in information_elements: " << enb_id_hex << std::endl;
@@ -1841,5 +1956,110 @@ std::pair<std::optional<uint32_t>, std::optional<uint32_t>> extractS1apIds(const
     return {mme_ue_s1ap_id, enb_ue_s1ap_id};
 }
 
+namespace {
+    // Identities of one NAS message, from a single structured decode
+    void addNasIdentities(std::span<const uint8_t> nas, bool with_imsi_imeisv, S1apIdentifiers& ids,
+                          IdentifierDigits<8>& tmsi) {
+        for (const auto& identity : nas_parser::decodeStructuredNas(nas.data(), nas.size())) {
+            const std::string& value = identity.identity_string;
+            if (value.empty()) continue;
+            switch (identity.identity_type) {
+                case nas_parser::MobileIdentityType::IMSI:
+                    if (with_imsi_imeisv && ids.imsi.empty() && nas_parser::isValidImsi(value)) ids.imsi.assign(value);
+                    break;
+                case nas_parser::MobileIdentityType::TMSI:
+                case nas_parser::MobileIdentityType::GUTI:
+                    if (tmsi.empty() && nas_parser::isValidTmsi(value)) tmsi.assign(value);
+                    break;
+                case nas_parser::MobileIdentityType::IMEISV:
+                    if (with_imsi_imeisv && ids.imeisv.empty()) ids.imeisv.assign(value);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+} // anonymous namespace
+
+S1apIdentifiers extractIdentifiers(const S1apParseResult& s1ap_result) {
+    S1apIdentifiers ids;
+    if (s1ap_result.ies.empty()) {
+        auto imsis = extractImsisFromS1ap(s1ap_result);
+        auto tmsi_result = extractTmsisFromS1ap(s1ap_result);
+        auto imeisvs = extractImeisvsFromS1ap(s1ap_result);
+        if (!imsis.empty()) ids.imsi.assign(imsis.front());
+        if (!tmsi_result.tmsis.empty()) ids.tmsi.assign(tmsi_result.tmsis.front());
+        if (!imeisvs.empty()) ids.imeisv.assign(imeisvs.front());
+        for (uint32_t teid : tmsi_result.teids) ids.add_teid(teid);
+        std::tie(ids.mme_ue_s1ap_id, ids.enb_ue_s1ap_id) = extractS1apIds(s1ap_result);
+        return ids;
+    }
+
+    // First IE of each ID counts, as with findIe. A TMSI is taken from
+    // S-TMSI first, then the NAS-PDU, then NAS-PDUs inside E-RAB items.
+    bool seen_mme_id = false, seen_enb_id = false, seen_ue_ids = false, seen_nas = false,
+         seen_s_tmsi = false, seen_erab_req = false, seen_erab_res = false;
+    std::optional<uint32_t> mme_id, enb_id;
+    IdentifierDigits<8> s_tmsi, nas_tmsi, erab_tmsi;
+    for (const auto& ie : s1ap_result.ies) {
+        auto value = s1ap_result.ieValue(ie);
+        switch (static_cast<S1apIeId>(ie.id)) {
+            case S1apIeId::MME_UE_S1AP_ID:
+                if (!seen_mme_id) mme_id = ieValueAsUint32(value);
+                seen_mme_id = true;
+                break;
+            case S1apIeId::ENB_UE_S1AP_ID:
+                if (!seen_enb_id) enb_id = ieValueAsUint32(value);
+                seen_enb_id = true;
+                break;
+            case S1apIeId::UE_S1AP_IDS:
+                // Both IDs, 4 bytes each, big-endian
+                if (!seen_ue_ids && value.size() >= 8) {
+                    ids.mme_ue_s1ap_id = ieValueAsUint32(value.first(4));
+                    ids.enb_ue_s1ap_id = ieValueAsUint32(value.subspan(4, 4));
+                }
+                seen_ue_ids = true;
+                break;
+            case S1apIeId::NAS_PDU:
+                // First byte is the length determinant
+                if (!seen_nas && value.size() >= 2) addNasIdentities(value.subspan(1), true, ids, nas_tmsi);
+                seen_nas = true;
+                break;
+            case S1apIeId::S_TMSI:
+                // mMEC + m-TMSI; the m-TMSI is the last 4 bytes
+                if (!seen_s_tmsi && value.size() >= 5) {
+                    s1see::utils::hex_encode(value.last(4).data(), 4, s_tmsi.chars.data());
+                    s_tmsi.size = 8;
+                }
+                seen_s_tmsi = true;
+                break;
+            case S1apIeId::E_RAB_TO_BE_SETUP_LIST_CTXT_SU_REQ:
+                if (!seen_erab_req && s1ap_result.procedure_code == 9 /*id-InitialContextSetup*/) {
+                    forEachERabToBeSetupItemCtxtSUReq(
+                        value,
+                        [&](uint32_t gtp_teid) { ids.add_teid(gtp_teid); },
+                        [&](std::span<const uint8_t> nas) { addNasIdentities(nas, false, ids, erab_tmsi); });
+                }
+                seen_erab_req = true;
+                break;
+            case S1apIeId::E_RAB_SETUP_LIST_CTXT_SU_RES:
+                if (!seen_erab_res && !value.empty()) {
+                    ERabSetupListCtxtSURes decoded_list = decodeERabSetupListCtxtSURes(value.data(), value.size());
+                    if (decoded_list.decoded) {
+                        for (const auto& item : decoded_list.items) ids.add_teid(item.gtp_teid);
+                    }
+                }
+                seen_erab_res = true;
+                break;
+            default:
+                break;
+        }
+    }
+    if (!ids.mme_ue_s1ap_id) ids.mme_ue_s1ap_id = mme_id;
+    if (!ids.enb_ue_s1ap_id) ids.enb_ue_s1ap_id = enb_id;
+    ids.tmsi = !s_tmsi.empty() ? s_tmsi : !nas_tmsi.empty() ? nas_tmsi : erab_tmsi;
+    return ids;
+}
+
 } // namespace s1ap_parser
 
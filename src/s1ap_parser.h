@@ -39,12 +39,16 @@
     #endif
 #endif
 
+#include <algorithm>
+#include <array>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <cstdint>
 #include <cstddef>
 #include <optional>
+#include <span>
 
 namespace s1ap_parser {
 
@@ -277,15 +281,51 @@ enum class S1apIeId : uint16_t {
     MANAGEMENT_BASED_MDT_ALLOWED = 165
 };
 
+// One top-level ProtocolIE-Field: the value occupies
+// [offset, offset + length) of the parsed PDU bytes
+struct S1apIe {
+    uint16_t id;
+    uint32_t offset;
+    uint32_t length;
+};
+
 // S1AP Result Structure (for parsing)
 struct S1apParseResult {
-    bool decoded;
-    S1apPduType pdu_type;
-    uint8_t procedure_code;
+    bool decoded = false;
+    S1apPduType pdu_type = S1apPduType::INITIATING_MESSAGE;
+    uint8_t procedure_code = 0;
     std::string procedure_name;
-    std::unordered_map<std::string, std::string> information_elements;
+    std::unordered_map<uint16_t, std::string> information_elements;  // ProtocolIE-ID -> value hex
     std::vector<uint8_t> raw_bytes;
     std::vector<uint8_t> s1ap_payload;  // Extracted S1AP PDU bytes
+    // Non-owning view of the PDU, set by the span overload of parseS1apPdu
+    // instead of copying into raw_bytes; valid while the caller's buffer is
+    std::span<const uint8_t> pdu;
+
+    // Typed IE table filled by parseS1apPdu, in PDU order. Values are read
+    // straight from bytes(); nothing is formatted or copied.
+    std::vector<S1apIe> ies;
+
+    // PDU bytes, from whichever of raw_bytes / pdu is populated
+    std::span<const uint8_t> bytes() const {
+        return raw_bytes.empty() ? pdu : std::span<const uint8_t>(raw_bytes);
+    }
+
+    // First IE with the given ID, or nullptr
+    const S1apIe* findIe(S1apIeId id) const;
+    std::span<const uint8_t> ieValue(const S1apIe& ie) const {
+        return bytes().subspan(ie.offset, ie.length);
+    }
+    // Value bytes of the given IE; empty if absent
+    std::span<const uint8_t> ieValue(S1apIeId id) const;
+
+    // Common IEs, read from the typed table
+    std::optional<uint32_t> mmeUeS1apId() const;
+    std::optional<uint32_t> enbUeS1apId() const;
+    std::span<const uint8_t> eutranCgi() const { return ieValue(S1apIeId::EUTRAN_CGI); }
+    std::span<const uint8_t> nasPdu() const { return ieValue(S1apIeId::NAS_PDU); }
+    std::span<const uint8_t> tai() const { return ieValue(S1apIeId::TAI); }
+    std::span<const uint8_t> cause() const { return ieValue(S1apIeId::CAUSE); }
 };
 
 // S1AP Result Structure (for correlation - simplified version)
@@ -311,6 +351,10 @@ struct S1apParseResult {
 std::optional<std::vector<uint8_t>> extractS1apFromSctp(
     const uint8_t* packet, size_t len);
 
+// As extractS1apFromSctp, but returns a view into packet instead of a copy.
+// Empty if the packet carries no S1AP DATA chunk.
+std::span<const uint8_t> findS1apInSctp(std::span<const uint8_t> packet);
+
 // Extract all S1AP payloads from SCTP packet
 // Parses Ethernet/IP/SCTP headers and extracts all SCTP DATA chunks with PayloadProtocolID == 18
 // Returns a vector of S1AP payloads (one per DATA chunk)
@@ -321,6 +365,15 @@ std::vector<std::vector<uint8_t>> extractAllS1apFromSctp(
 // This is a simplified parser that extracts key IEs without full PER decoding
 S1apParseResult parseS1apPdu(const uint8_t* s1ap_bytes, size_t len);
 
+// Zero-copy variant: the result references s1ap_bytes through pdu and
+// leaves raw_bytes / s1ap_payload empty, so it must not outlive the buffer.
+// Only the typed IE table is filled; information_elements (hex strings) is
+// left empty unless format_hex_ies is set.
+S1apParseResult parseS1apPdu(std::span<const uint8_t> s1ap_bytes, bool format_hex_ies = false);
+
+// Lowercase hex of an IE value, as stored in information_elements
+std::string ieValueHex(std::span<const uint8_t> value);
+
 // Extract TEIDs from S1AP PDU bytes
 // Searches for 4-byte TEID values in the S1AP structure
 std::vector<uint32_t> extractTeidsFromS1apBytes(const uint8_t* s1ap_bytes, size_t len);
@@ -346,12 +399,56 @@ struct TmsiExtractionResult {
 
 // Extract identifiers from S1apParseResult (uses parsed information_elements)
 std::vector<std::string> extractTmsiFromIEList(
-    const std::unordered_map<std::string, std::string>& information_elements);
+    const std::unordered_map<uint16_t, std::string>& information_elements);
 TmsiExtractionResult extractTmsisFromS1ap(const S1apParseResult& s1ap_result);
 std::vector<std::string> extractImsisFromS1ap(const S1apParseResult& s1ap_result);
 std::vector<std::string> extractImeisvsFromS1ap(const S1apParseResult& s1ap_result);
 std::pair<std::optional<uint32_t>, std::optional<uint32_t>> extractS1apIds(const S1apParseResult& s1ap_result);
 
+// Identifier characters held in place, up to N of them
+template <size_t N>
+struct IdentifierDigits {
+    std::array<char, N> chars{};
+    uint8_t size = 0;
+
+    bool empty() const { return size == 0; }
+    std::string_view view() const { return {chars.data(), size}; }
+    // False (and left as it was) if value is empty or longer than N
+    bool assign(std::string_view value) {
+        if (value.empty() || value.size() > N) return false;
+        std::copy(value.begin(), value.end(), chars.begin());
+        size = static_cast<uint8_t>(value.size());
+        return true;
+    }
+};
+
+// What the correlator takes from one PDU, in a fixed-size struct: the S1AP
+// IDs, the first IMSI, TMSI and IMEISV, and the bearer TEIDs
+struct S1apIdentifiers {
+    static constexpr size_t MAX_TEIDS = 16;
+
+    std::optional<uint32_t> mme_ue_s1ap_id;
+    std::optional<uint32_t> enb_ue_s1ap_id;
+    IdentifierDigits<15> imsi;
+    IdentifierDigits<8> tmsi;     // m-TMSI as hex
+    IdentifierDigits<16> imeisv;
+    std::array<uint32_t, MAX_TEIDS> teids{};
+    uint8_t num_teids = 0;
+
+    std::span<const uint32_t> teid_list() const { return {teids.data(), num_teids}; }
+    // Duplicates, and TEIDs past MAX_TEIDS, are dropped
+    void add_teid(uint32_t teid) {
+        auto end = teids.begin() + num_teids;
+        if (num_teids == MAX_TEIDS || std::find(teids.begin(), end, teid) != end) return;
+        teids[num_teids++] = teid;
+    }
+};
+
+// Everything extract*FromS1ap above finds, in one walk of the IE table:
+// each NAS-PDU is decoded once, for all identity types. Results without a
+// typed IE table (rebuilt from hex) go through the functions above.
+S1apIdentifiers extractIdentifiers(const S1apParseResult& s1ap_result);
+
 // Extract NAS PDU from S1AP
 std::vector<std::vector<uint8_t>> extractNasPdusFromS1ap(
     const uint8_t* s1ap_bytes, size_t len);
@@ -368,11 +465,21 @@ std::pair<std::vector<uint8_t>, size_t> readPerOctetString(
 // Helper: Find pattern in bytes (for TEID extraction)
 std::vector<uint32_t> findTeidPatterns(const uint8_t* data, size_t len);
 
-// Helper: Get IE name from ProtocolIE-ID
-std::string getIeNameFromId(uint16_t ie_id);
+// Names come from constexpr tables indexed by ID, so a lookup costs no
+// allocation; IEs are keyed by ID everywhere and named only for output.
+
+// Helper: Get IE name from ProtocolIE-ID; empty past the end of the table
+std::string_view getIeNameFromId(uint16_t ie_id);
+
+// IE name for output: getIeNameFromId, or "IE_<id>" for an ID it has no
+// name for
+std::string ieDisplayName(uint16_t ie_id);
+
+// Reverse of ieDisplayName
+std::optional<uint16_t> getIeIdFromName(std::string_view name);
 
-// Helper: Get procedure code name from ProcedureCode
-std::string getProcedureCodeName(uint8_t procedure_code);
+// Helper: Get procedure code name from ProcedureCode; "Unknown" if out of range
+std::string_view getProcedureCodeName(uint8_t procedure_code);
 
 // E-RAB Setup Item structure for Context Setup Response
 struct ERabSetupItemCtxtSURes {
@@ -18,9 +18,13 @@
 #include <algorithm>
 #include <cctype>
 #include <cstring>
+#include <climits>
 
 namespace s1ap_correlator {
 
+static_assert(sizeof(void*) != 8 || sizeof(SubscriberRecord) < 100,
+              "SubscriberRecord is kept under 100 bytes per idle UE");
+
 // Helper function to convert hex string to bytes
 // namespace {
 //     std::vector<uint8_t> hexToBytes(const std::string& hex) {
@@ -36,7 +40,7 @@ namespace s1ap_correlator {
 // } // anonymous namespace
 
 // Constructor
-S1apUeCorrelator::S1apUeCorrelator() : next_subscriber_id_(1) {
+S1apUeCorrelator::S1apUeCorrelator() {
 }
 
 // Destructor
@@ -48,7 +52,8 @@ SubscriberRecord* S1apUeCorrelator::processS1apFrame(uint32_t /* frame_no */, co
     if (s1ap_result.procedure_code == 12 /*id-initialUEMessage*/) {
         // first sight of MME-UE-S1AP-ID
         DEBUG_LOG << "[S1AP] processS1apFrame: Initial UE Message" << std::endl;
-        auto enb_id_it = s1ap_result.information_elements.find("eNB-UE-S1AP-ID");
+        auto enb_id_it = s1ap_result.information_elements.find(
+            static_cast<uint16_t>(s1ap_parser::S1apIeId::ENB_UE_S1AP_ID));
         if (enb_id_it != s1ap_result.information_elements.end()) {
             DEBUG_LOG << "[S1AP] processS1apFrame: eNB-UE-S1AP-ID: 0x" << enb_id_it->second << std::endl;
         }
@@ -58,58 +63,54 @@ SubscriberRecord* S1apUeCorrelator::processS1apFrame(uint32_t /* frame_no */, co
         DEBUG_LOG << "[S1AP] processS1apFrame: Downlink NAS Transport" << std::endl;
     }
 
-    // Extract identifiers and TEIDs (using s1ap_parser functions)
-    auto teids = extractTeidsFromS1ap(s1ap_result);
-    auto imsis = s1ap_parser::extractImsisFromS1ap(s1ap_result);
-    auto tmsi_result = s1ap_parser::extractTmsisFromS1ap(s1ap_result);
-    const auto& tmsis = tmsi_result.tmsis;
-    // Add all TEIDs from decoded_list.items to the teids vector
-    if (!tmsi_result.teids.empty()) {
-        DEBUG_LOG << "[S1AP] processS1apFrame: Found " << tmsi_result.teids.size() 
-                  << " TEID(s) from decoded_list.items: ";
+    // Extract identifiers and TEIDs in one pass over the IEs
+    const s1ap_parser::S1apIdentifiers ids = s1ap_parser::extractIdentifiers(s1ap_result);
+    auto teids = ids.teid_list();
+    std::pair<std::optional<uint32_t>, std::optional<uint32_t>> s1ap_ids(ids.mme_ue_s1ap_id, ids.enb_ue_s1ap_id);
+    if (!teids.empty()) {
+        DEBUG_LOG << "[S1AP] processS1apFrame: Found " << teids.size() << " TEID(s): ";
         bool first = true;
-        for (uint32_t teid : tmsi_result.teids) {
+        for (uint32_t teid : teids) {
             if (!first) DEBUG_LOG << ", ";
             DEBUG_LOG << "0x" << std::hex << teid << std::dec << " (" << teid << ")";
-            teids.push_back(teid);
             first = false;
         }
         DEBUG_LOG << std::endl;
     }
-    auto imeisvs = s1ap_parser::extractImeisvsFromS1ap(s1ap_result);
-    auto s1ap_ids = s1ap_parser::extractS1apIds(s1ap_result);
+
+    // Normalize all identifiers
+    std::optional<std::string> imsi_norm = ids.imsi.empty() ? std::nullopt : std::make_optional(normalizeImsi(std::string(ids.imsi.view())));
+    std::optional<std::string> tmsi_norm = ids.tmsi.empty() ? std::nullopt : std::make_optional(normalizeTmsi(std::string(ids.tmsi.view())));
+    std::optional<std::string> imeisv_norm = ids.imeisv.empty() ? std::nullopt : std::make_optional(normalizeImeisv(std::string(ids.imeisv.view())));
 
     // Build mappings
-    for (const auto& imsi : imsis) {
-        std::string imsi_norm = normalizeImsi(imsi);
+    if (imsi_norm.has_value()) {
         for (uint32_t teid : teids) {
-            imsi_to_teids_[imsi_norm].insert(teid);
-            teid_to_imsi_[teid] = imsi_norm;
+            imsi_to_teids_[*imsi_norm].insert(teid);
+            teid_to_imsi_[teid] = *imsi_norm;
         }
 
         // Map S1AP IDs
         if (s1ap_ids.first.has_value()) {
-            imsi_to_mme_ue_s1ap_id_[imsi_norm] = s1ap_ids.first.value();
+            imsi_to_mme_ue_s1ap_id_[*imsi_norm] = s1ap_ids.first.value();
         }
         if (s1ap_ids.second.has_value()) {
-            imsi_to_enb_ue_s1ap_id_[imsi_norm] = s1ap_ids.second.value();
+            imsi_to_enb_ue_s1ap_id_[*imsi_norm] = s1ap_ids.second.value();
         }
     }
 
     // Similar for TMSI and IMEISV
-    for (const auto& tmsi : tmsis) {
-        std::string tmsi_norm = normalizeTmsi(tmsi);
+    if (tmsi_norm.has_value()) {
         for (uint32_t teid : teids) {
-            tmsi_to_teids_[tmsi_norm].insert(teid);
-            teid_to_tmsi_[teid] = tmsi_norm;
+            tmsi_to_teids_[*tmsi_norm].insert(teid);
+            teid_to_tmsi_[teid] = *tmsi_norm;
         }
     }
 
-    for (const auto& imeisv : imeisvs) {
-        std::string imeisv_norm = normalizeImeisv(imeisv);
+    if (imeisv_norm.has_value()) {
         for (uint32_t teid : teids) {
-            imeisv_to_teids_[imeisv_norm].insert(teid);
-            teid_to_imeisv_[teid] = imeisv_norm;
+            imeisv_to_teids_[*imeisv_norm].insert(teid);
+            teid_to_imeisv_[teid] = *imeisv_norm;
         }
     }
 
@@ -121,11 +122,6 @@ SubscriberRecord* S1apUeCorrelator::processS1apFrame(uint32_t /* frame_no */, co
         }
     }
     
-    // Normalize all identifiers
-    std::optional<std::string> imsi_norm = imsis.empty() ? std::nullopt : std::make_optional(normalizeImsi(imsis[0]));
-    std::optional<std::string> tmsi_norm = tmsis.empty() ? std::nullopt : std::make_optional(normalizeTmsi(tmsis[0]));
-    std::optional<std::string> imeisv_norm = imeisvs.empty() ? std::nullopt : std::make_optional(normalizeImeisv(imeisvs[0]));
-    
     // Process all identifiers together to ensure they're merged into a single record
     // This is critical - if IMSI and TMSI appear in the same message, they must be in the same record
     if (imsi_norm.has_value() || tmsi_norm.has_value() || imeisv_norm.has_value() || 
@@ -193,7 +189,7 @@ SubscriberRecord* S1apUeCorrelator::processS1apFrame(uint32_t /* frame_no */, co
             
             // Update timestamps
             if (timestamp > 0.0) {
-                if (!subscriber->first_seen_timestamp.has_value()) {
+                if (subscriber->first_seen_timestamp == 0.0) {
                     subscriber->first_seen_timestamp = timestamp;
                 }
                 subscriber->last_seen_timestamp = timestamp;
@@ -233,14 +229,12 @@ SubscriberRecord* S1apUeCorrelator::processS1apFrame(uint32_t /* frame_no */, co
 // Identifier extraction functions
 std::vector<uint32_t> S1apUeCorrelator::extractTeidsFromS1ap(const s1ap_parser::S1apParseResult& s1ap_result) {
     // Extract TEIDs from S1AP bytes using pattern matching
-    if (s1ap_result.raw_bytes.empty()) {
+    auto bytes = s1ap_result.bytes();
+    if (bytes.empty()) {
         return {};
     }
     
-    return s1ap_parser::extractTeidsFromS1apBytes(
-        s1ap_result.raw_bytes.data(),
-        s1ap_result.raw_bytes.size()
-    );
+    return s1ap_parser::extractTeidsFromS1apBytes(bytes.data(), bytes.size());
 }
 
 std::vector<std::string> S1apUeCorrelator::extractImsisFromS1ap(const s1ap_parser::S1apParseResult& s1ap_result) {
@@ -459,8 +453,7 @@ SubscriberRecord* S1apUeCorrelator::getOrCreateSubscriber(
     // Create new subscriber if not found
     //bool is_new_subscriber = (subscriber_id == 0);
     if (subscriber_id == 0) {
-        subscriber_id = next_subscriber_id_++;
-        subscriber_records_[subscriber_id] = SubscriberRecord();
+        subscriber_id = subscriber_records_.emplace();
         DEBUG_LOG << "[S1AP] getOrCreateSubscriber: Created NEW subscriber ID=" << subscriber_id;
         if (imsi.has_value()) DEBUG_LOG << " IMSI=" << imsi.value();
         if (tmsi.has_value()) DEBUG_LOG << " TMSI=" << tmsi.value();
@@ -479,7 +472,7 @@ SubscriberRecord* S1apUeCorrelator::getOrCreateSubscriber(
         DEBUG_LOG << std::endl;
     }
     
-    subscriber = &subscriber_records_[subscriber_id];
+    subscriber = subscriber_records_.get(subscriber_id);
     
     // Update associations with provided identifiers (pass subscriber_id to avoid O(n) lookup)
     if (imsi.has_value()) {
@@ -504,13 +497,60 @@ SubscriberRecord* S1apUeCorrelator::getOrCreateSubscriber(
     return subscriber;
 }
 
+SubscriberRecord* S1apUeCorrelator::restoreSubscriber(const SubscriberRecord& saved) {
+    uint64_t subscriber_id = subscriber_records_.emplace();
+    SubscriberRecord* subscriber = subscriber_records_.get(subscriber_id);
+    subscriber->first_seen_timestamp = saved.first_seen_timestamp;
+    subscriber->last_seen_timestamp = saved.last_seen_timestamp;
+    
+    if (saved.imsi.has_value()) {
+        associateImsi(subscriber, subscriber_id, saved.imsi.value());
+    }
+    if (saved.tmsi.has_value()) {
+        associateTmsi(subscriber, subscriber_id, saved.tmsi.value());
+    }
+    if (saved.enb_ue_s1ap_id.has_value()) {
+        associateEnbUeS1apId(subscriber, subscriber_id, saved.enb_ue_s1ap_id.value());
+    }
+    if (saved.mme_ue_s1ap_id.has_value()) {
+        associateMmeUeS1apId(subscriber, subscriber_id, saved.mme_ue_s1ap_id.value());
+    }
+    for (uint32_t teid : saved.teids) {
+        associateTeid(subscriber, subscriber_id, teid);
+    }
+    if (saved.imeisv.has_value()) {
+        associateImeisv(subscriber, subscriber_id, saved.imeisv.value());
+    }
+    return subscriber;
+}
+
+SubscriberRecord* S1apUeCorrelator::getSubscriberById(uint64_t subscriber_id) {
+    if (subscriber_id > UINT32_MAX) {
+        return nullptr;
+    }
+    return subscriber_records_.get(static_cast<SubscriberSlab::Handle>(subscriber_id));
+}
+
+const SubscriberRecord* S1apUeCorrelator::getSubscriberById(uint64_t subscriber_id) const {
+    if (subscriber_id > UINT32_MAX) {
+        return nullptr;
+    }
+    return subscriber_records_.get(static_cast<SubscriberSlab::Handle>(subscriber_id));
+}
+
+const SubscriberLocation* S1apUeCorrelator::getLocation(uint64_t subscriber_id) const {
+    auto it = locations_.find(subscriber_id);
+    return it != locations_.end() ? &it->second : nullptr;
+}
+
+SubscriberLocation& S1apUeCorrelator::getOrCreateLocation(uint64_t subscriber_id) {
+    return locations_[subscriber_id];
+}
+
 SubscriberRecord* S1apUeCorrelator::getSubscriberByImsi(const std::string& imsi) {
     auto it = imsi_to_subscriber_id_.find(imsi);
     if (it != imsi_to_subscriber_id_.end() && it->second != 0) {
-        auto record_it = subscriber_records_.find(it->second);
-        if (record_it != subscriber_records_.end()) {
-            return &record_it->second;
-        }
+        return getSubscriberById(it->second);
     }
     return nullptr;
 }
@@ -518,10 +558,7 @@ SubscriberRecord* S1apUeCorrelator::getSubscriberByImsi(const std::string& imsi)
 SubscriberRecord* S1apUeCorrelator::getSubscriberByTmsi(const std::string& tmsi) {
     auto it = tmsi_to_subscriber_id_.find(tmsi);
     if (it != tmsi_to_subscriber_id_.end() && it->second != 0) {
-        auto record_it = subscriber_records_.find(it->second);
-        if (record_it != subscriber_records_.end()) {
-            return &record_it->second;
-        }
+        return getSubscriberById(it->second);
     }
     return nullptr;
 }
@@ -529,10 +566,7 @@ SubscriberRecord* S1apUeCorrelator::getSubscriberByTmsi(const std::string& tmsi)
 SubscriberRecord* S1apUeCorrelator::getSubscriberByEnbUeS1apId(uint32_t enb_ue_s1ap_id) {
     auto it = enb_ue_s1ap_id_to_subscriber_id_.find(enb_ue_s1ap_id);
     if (it != enb_ue_s1ap_id_to_subscriber_id_.end() && it->second != 0) {
-        auto record_it = subscriber_records_.find(it->second);
-        if (record_it != subscriber_records_.end()) {
-            return &record_it->second;
-        }
+        return getSubscriberById(it->second);
     }
     return nullptr;
 }
@@ -540,10 +574,7 @@ SubscriberRecord* S1apUeCorrelator::getSubscriberByEnbUeS1apId(uint32_t enb_ue_s
 SubscriberRecord* S1apUeCorrelator::getSubscriberByMmeUeS1apId(uint32_t mme_ue_s1ap_id) {
     auto it = mme_ue_s1ap_id_to_subscriber_id_.find(mme_ue_s1ap_id);
     if (it != mme_ue_s1ap_id_to_subscriber_id_.end() && it->second != 0) {
-        auto record_it = subscriber_records_.find(it->second);
-        if (record_it != subscriber_records_.end()) {
-            return &record_it->second;
-        }
+        return getSubscriberById(it->second);
     }
     return nullptr;
 }
@@ -551,10 +582,7 @@ SubscriberRecord* S1apUeCorrelator::getSubscriberByMmeUeS1apId(uint32_t mme_ue_s
 SubscriberRecord* S1apUeCorrelator::getSubscriberByTeid(uint32_t teid) {
     auto it = teid_to_subscriber_id_.find(teid);
     if (it != teid_to_subscriber_id_.end() && it->second != 0) {
-        auto record_it = subscriber_records_.find(it->second);
-        if (record_it != subscriber_records_.end()) {
-            return &record_it->second;
-        }
+        return getSubscriberById(it->second);
     }
     return nullptr;
 }
@@ -562,10 +590,7 @@ SubscriberRecord* S1apUeCorrelator::getSubscriberByTeid(uint32_t teid) {
 SubscriberRecord* S1apUeCorrelator::getSubscriberByImeisv(const std::string& imeisv) {
     auto it = imeisv_to_subscriber_id_.find(imeisv);
     if (it != imeisv_to_subscriber_id_.end() && it->second != 0) {
-        auto record_it = subscriber_records_.find(it->second);
-        if (record_it != subscriber_records_.end()) {
-            return &record_it->second;
-        }
+        return getSubscriberById(it->second);
     }
     return nullptr;
 }
@@ -636,9 +661,9 @@ void S1apUeCorrelator::associateEnbUeS1apId(SubscriberRecord* subscriber, uint64
     if (existing_it != enb_ue_s1ap_id_to_subscriber_id_.end() && existing_it->second != subscriber_id) {
         // Another subscriber already has this eNB-UE-S1AP-ID
         uint64_t other_subscriber_id = existing_it->second;
-        auto other_record_it = subscriber_records_.find(other_subscriber_id);
-        if (other_record_it != subscriber_records_.end()) {
-            SubscriberRecord* other_subscriber = &other_record_it->second;
+        SubscriberRecord* other_record = getSubscriberById(other_subscriber_id);
+        if (other_record) {
+            SubscriberRecord* other_subscriber = other_record;
             // Update the mapping - the other subscriber will lose this ID
             other_subscriber->enb_ue_s1ap_id = std::nullopt;
             DEBUG_LOG << "[S1AP] associateEnbUeS1apId: CONFLICT - eNB-UE-S1AP-ID=" << enb_ue_s1ap_id 
@@ -680,9 +705,9 @@ void S1apUeCorrelator::associateMmeUeS1apId(SubscriberRecord* subscriber, uint64
     if (existing_it != mme_ue_s1ap_id_to_subscriber_id_.end() && existing_it->second != subscriber_id) {
         // Another subscriber already has this MME-UE-S1AP-ID
         uint64_t other_subscriber_id = existing_it->second;
-        auto other_record_it = subscriber_records_.find(other_subscriber_id);
-        if (other_record_it != subscriber_records_.end()) {
-            SubscriberRecord* other_subscriber = &other_record_it->second;
+        SubscriberRecord* other_record = getSubscriberById(other_subscriber_id);
+        if (other_record) {
+            SubscriberRecord* other_subscriber = other_record;
             other_subscriber->mme_ue_s1ap_id = std::nullopt;
             DEBUG_LOG << "[S1AP] associateMmeUeS1apId: CONFLICT - MME-UE-S1AP-ID=" << mme_ue_s1ap_id 
                       << " was associated with subscriber ID=" << other_subscriber_id 
@@ -719,16 +744,16 @@ void S1apUeCorrelator::associateTeid(SubscriberRecord* subscriber, uint64_t subs
         return;
     }
     
-    bool was_new = (subscriber->teids.find(teid) == subscriber->teids.end());
+    bool was_new = !subscriber->teids.contains(teid);
     
     // Remove old association if exists
     auto old_it = teid_to_subscriber_id_.find(teid);
     if (old_it != teid_to_subscriber_id_.end() && old_it->second != 0 && old_it->second != subscriber_id) {
         // Remove from old subscriber's TEID set
         uint64_t old_subscriber_id = old_it->second;
-        auto record_it = subscriber_records_.find(old_it->second);
-        if (record_it != subscriber_records_.end()) {
-            record_it->second.teids.erase(teid);
+        SubscriberRecord* record = getSubscriberById(old_it->second);
+        if (record) {
+            record->teids.erase_value(teid);
             DEBUG_LOG << "[S1AP] associateTeid: CONFLICT - TEID=0x" << std::hex << teid << std::dec
                       << " was associated with subscriber ID=" << old_subscriber_id
                       << ", now reassigning to subscriber ID=" << subscriber_id << std::endl;
@@ -737,7 +762,9 @@ void S1apUeCorrelator::associateTeid(SubscriberRecord* subscriber, uint64_t subs
         }
     }
     
-    subscriber->teids.insert(teid);
+    if (was_new) {
+        subscriber->teids.push_back(teid);
+    }
     teid_to_subscriber_id_[teid] = subscriber_id;
     
     DEBUG_LOG << "[S1AP] associateTeid: Subscriber ID=" << subscriber_id;
@@ -775,9 +802,9 @@ void S1apUeCorrelator::removeImsiAssociation(const std::string& imsi) {
     auto it = imsi_to_subscriber_id_.find(imsi);
     if (it != imsi_to_subscriber_id_.end() && it->second != 0) {
         uint64_t subscriber_id = it->second;
-        auto record_it = subscriber_records_.find(it->second);
-        if (record_it != subscriber_records_.end()) {
-            record_it->second.imsi = std::nullopt;
+        SubscriberRecord* record = getSubscriberById(it->second);
+        if (record) {
+            record->imsi = std::nullopt;
         }
         imsi_to_subscriber_id_.erase(it);
         DEBUG_LOG << "[S1AP] removeImsiAssociation: Removed IMSI=" << imsi 
@@ -789,9 +816,9 @@ void S1apUeCorrelator::removeTmsiAssociation(const std::string& tmsi) {
     auto it = tmsi_to_subscriber_id_.find(tmsi);
     if (it != tmsi_to_subscriber_id_.end() && it->second != 0) {
         uint64_t subscriber_id = it->second;
-        auto record_it = subscriber_records_.find(it->second);
-        if (record_it != subscriber_records_.end()) {
-            record_it->second.tmsi = std::nullopt;
+        SubscriberRecord* record = getSubscriberById(it->second);
+        if (record) {
+            record->tmsi = std::nullopt;
         }
         tmsi_to_subscriber_id_.erase(it);
         DEBUG_LOG << "[S1AP] removeTmsiAssociation: Removed TMSI=" << tmsi 
@@ -803,10 +830,10 @@ void S1apUeCorrelator::removeEnbUeS1apIdAssociation(uint32_t enb_ue_s1ap_id) {
     auto it = enb_ue_s1ap_id_to_subscriber_id_.find(enb_ue_s1ap_id);
     if (it != enb_ue_s1ap_id_to_subscriber_id_.end() && it->second != 0) {
         uint64_t subscriber_id = it->second;
-        auto record_it = subscriber_records_.find(it->second);
-        if (record_it != subscriber_records_.end()) {
+        SubscriberRecord* record = getSubscriberById(it->second);
+        if (record) {
             // Completely remove from record (UEContextReleaseComplete means context is released)
-            record_it->second.enb_ue_s1ap_id = std::nullopt;
+            record->enb_ue_s1ap_id = std::nullopt;
         }
         // Remove from mapping
         enb_ue_s1ap_id_to_subscriber_id_.erase(it);
@@ -819,10 +846,10 @@ void S1apUeCorrelator::removeMmeUeS1apIdAssociation(uint32_t mme_ue_s1ap_id) {
     auto it = mme_ue_s1ap_id_to_subscriber_id_.find(mme_ue_s1ap_id);
     if (it != mme_ue_s1ap_id_to_subscriber_id_.end() && it->second != 0) {
         uint64_t subscriber_id = it->second;
-        auto record_it = subscriber_records_.find(it->second);
-        if (record_it != subscriber_records_.end()) {
+        SubscriberRecord* record = getSubscriberById(it->second);
+        if (record) {
             // Completely remove from record (UEContextReleaseComplete means context is released)
-            record_it->second.mme_ue_s1ap_id = std::nullopt;
+            record->mme_ue_s1ap_id = std::nullopt;
         }
         // Remove from mapping
         mme_ue_s1ap_id_to_subscriber_id_.erase(it);
@@ -835,9 +862,9 @@ void S1apUeCorrelator::removeTeidAssociation(uint32_t teid) {
     auto it = teid_to_subscriber_id_.find(teid);
     if (it != teid_to_subscriber_id_.end() && it->second != 0) {
         uint64_t subscriber_id = it->second;
-        auto record_it = subscriber_records_.find(it->second);
-        if (record_it != subscriber_records_.end()) {
-            record_it->second.teids.erase(teid);
+        SubscriberRecord* record = getSubscriberById(it->second);
+        if (record) {
+            record->teids.erase_value(teid);
         }
         teid_to_subscriber_id_.erase(it);
         DEBUG_LOG << "[S1AP] removeTeidAssociation: Removed TEID=0x" << std::hex << teid << std::dec
@@ -849,9 +876,9 @@ void S1apUeCorrelator::removeImeisvAssociation(const std::string& imeisv) {
     auto it = imeisv_to_subscriber_id_.find(imeisv);
     if (it != imeisv_to_subscriber_id_.end() && it->second != 0) {
         uint64_t subscriber_id = it->second;
-        auto record_it = subscriber_records_.find(it->second);
-        if (record_it != subscriber_records_.end()) {
-            record_it->second.imeisv = std::nullopt;
+        SubscriberRecord* record = getSubscriberById(it->second);
+        if (record) {
+            record->imeisv = std::nullopt;
         }
         imeisv_to_subscriber_id_.erase(it);
         DEBUG_LOG << "[S1AP] removeImeisvAssociation: Removed IMEISV=" << imeisv 
@@ -866,12 +893,12 @@ std::optional<S1apUeCorrelator::SubscriberIdentifiers> S1apUeCorrelator::getIden
     }
     
     SubscriberIdentifiers identifiers;
-    identifiers.imsi = subscriber->imsi;
-    identifiers.tmsi = subscriber->tmsi;
+    identifiers.imsi = subscriber->imsi.get();
+    identifiers.tmsi = subscriber->tmsi.get();
     identifiers.enb_ue_s1ap_id = subscriber->enb_ue_s1ap_id;
     identifiers.mme_ue_s1ap_id = subscriber->mme_ue_s1ap_id;
     identifiers.teids.assign(subscriber->teids.begin(), subscriber->teids.end());
-    identifiers.imeisv = subscriber->imeisv;
+    identifiers.imeisv = subscriber->imeisv.get();
     
     return identifiers;
 }
@@ -900,5 +927,80 @@ std::vector<uint32_t> S1apUeCorrelator::getTeidsByImeisv(const std::string& imei
     return std::vector<uint32_t>(subscriber->teids.begin(), subscriber->teids.end());
 }
 
-} // namespace s1ap_correlator
+namespace {
+
+size_t stringHeapBytes(const std::string& s) {
+    // libstdc++/libc++ keep up to 15 chars inline
+    return s.capacity() > 15 ? s.capacity() + 1 : 0;
+}
 
+size_t stringHeapBytes(const std::optional<std::string>& s) {
+    return s.has_value() ? stringHeapBytes(s.value()) : 0;
+}
+
+template <typename Map>
+size_t nodeMapBytes(const Map& map) {
+    return map.size() * (sizeof(typename Map::value_type) + 2 * sizeof(void*)) +
+           map.bucket_count() * sizeof(void*);
+}
+
+template <typename Map>
+size_t stringKeyedMapBytes(const Map& map) {
+    size_t bytes = nodeMapBytes(map);
+    for (const auto& [key, value] : map) {
+        bytes += stringHeapBytes(key);
+    }
+    return bytes;
+}
+
+template <typename Map>
+size_t teidSetMapBytes(const Map& map) {
+    size_t bytes = stringKeyedMapBytes(map);
+    for (const auto& [key, teids] : map) {
+        bytes += nodeMapBytes(teids);
+    }
+    return bytes;
+}
+
+} // anonymous namespace
+
+S1apUeCorrelator::MemoryUsage S1apUeCorrelator::memoryUsage() const {
+    MemoryUsage usage;
+    usage.subscribers = subscriber_records_.size();
+    
+    usage.record_bytes = subscriber_records_.memory_bytes() + nodeMapBytes(locations_);
+    for (const auto& [id, record] : subscriber_records_) {
+        usage.record_bytes += record.imsi.heap_bytes() + record.tmsi.heap_bytes() +
+                              record.imeisv.heap_bytes() + record.teids.heap_bytes();
+    }
+    for (const auto& [id, location] : locations_) {
+        usage.record_bytes += stringHeapBytes(location.drone_protocol_type);
+    }
+    
+    usage.integer_index_bytes = enb_ue_s1ap_id_to_subscriber_id_.memory_bytes() +
+                                mme_ue_s1ap_id_to_subscriber_id_.memory_bytes() +
+                                teid_to_subscriber_id_.memory_bytes();
+    for (const auto* index : {&teid_to_imsi_, &teid_to_tmsi_, &teid_to_imeisv_}) {
+        usage.integer_index_bytes += index->memory_bytes();
+        index->for_each([&usage](uint32_t, const std::string& value) {
+            usage.integer_index_bytes += stringHeapBytes(value);
+        });
+    }
+    
+    usage.string_index_bytes = stringKeyedMapBytes(imsi_to_subscriber_id_) +
+                               stringKeyedMapBytes(tmsi_to_subscriber_id_) +
+                               stringKeyedMapBytes(imeisv_to_subscriber_id_) +
+                               stringKeyedMapBytes(imsi_to_mme_ue_s1ap_id_) +
+                               stringKeyedMapBytes(imsi_to_enb_ue_s1ap_id_);
+    
+    usage.teid_set_bytes = teidSetMapBytes(imsi_to_teids_) +
+                           teidSetMapBytes(tmsi_to_teids_) +
+                           teidSetMapBytes(imeisv_to_teids_) +
+                           nodeMapBytes(s1ap_ids_to_teids_);
+    for (const auto& [ids, teids] : s1ap_ids_to_teids_) {
+        usage.teid_set_bytes += nodeMapBytes(teids);
+    }
+    return usage;
+}
+
+} // namespace s1ap_correlator
@@ -18,6 +18,11 @@
 #include <unordered_set>
 #include <optional>
 #include <cstdint>
+#include <cstddef>
+#include "s1see/utils/flat_hash_map.h"
+#include "s1see/utils/packed_identifier.h"
+#include "s1see/utils/slab.h"
+#include "s1see/utils/small_vector.h"
 
 // Forward declaration - S1apParseResult is defined in s1ap_parser namespace
 namespace s1ap_parser {
@@ -52,19 +57,28 @@ namespace s1ap_parser {
 namespace s1ap_correlator {
 
 // Subscriber Record
+//
+// Hot identifiers only, kept compact (under 100 bytes on LP64) because one
+// exists per UE ever seen. Records live in slab storage and are addressed by
+// subscriber ID. Rarely used drone/GPS data sits in SubscriberLocation.
 struct SubscriberRecord {
-    std::optional<std::string> imsi;
-    std::optional<std::string> tmsi;
+    s1see::utils::PackedIdentifier imsi;
+    s1see::utils::PackedIdentifier tmsi;
+    s1see::utils::PackedIdentifier imeisv;
     std::optional<uint32_t> enb_ue_s1ap_id;
     std::optional<uint32_t> mme_ue_s1ap_id;
-    std::unordered_set<uint32_t> teids;
-    std::optional<std::string> imeisv;
+    s1see::utils::SmallVector<uint32_t, 2> teids;  // Usually only a few bearers per UE
     
-    // Drone protocol and GPS tracking
+    // Capture timestamps (seconds; 0 until a timestamped frame is seen)
+    double first_seen_timestamp = 0.0;
+    double last_seen_timestamp = 0.0;
+};
+
+// Drone protocol and GPS tracking for a subscriber. Allocated on demand in a
+// side table keyed by subscriber ID; absent for ordinary LTE subscribers.
+struct SubscriberLocation {
     std::optional<std::string> drone_protocol_type;  // "MAVLink", "DJI DUML", "other", or nullopt
-    bool gps_data_available;
-    std::optional<double> first_seen_timestamp;
-    std::optional<double> last_seen_timestamp;
+    bool gps_data_available = false;
     
     // GPS location data (when available)
     std::optional<double> gps_latitude;
@@ -81,8 +95,6 @@ struct SubscriberRecord {
     std::optional<double> home_latitude;
     std::optional<double> home_longitude;
     std::optional<double> home_altitude;
-    
-    SubscriberRecord() : gps_data_available(false) {}
 };
 
 // Result structure for TMSI extraction
@@ -151,11 +163,39 @@ public:
     std::vector<uint32_t> getTeidsByTmsi(const std::string& tmsi);
     std::vector<uint32_t> getTeidsByImeisv(const std::string& imeisv);
     
-    // Get all subscriber records (for iteration)
-    const std::unordered_map<uint64_t, SubscriberRecord>& getAllSubscribers() const {
+    // Re-create a subscriber from saved identifiers (snapshot restore) and
+    // rebuild its identifier indexes. Per-frame TEID side maps are not restored.
+    SubscriberRecord* restoreSubscriber(const SubscriberRecord& saved);
+    
+    // Get subscriber by ID (nullptr if unknown)
+    SubscriberRecord* getSubscriberById(uint64_t subscriber_id);
+    const SubscriberRecord* getSubscriberById(uint64_t subscriber_id) const;
+    
+    // Get all subscriber records (range-for yields {subscriber ID, record})
+    using SubscriberSlab = s1see::utils::Slab<SubscriberRecord>;
+    const SubscriberSlab& getAllSubscribers() const {
         return subscriber_records_;
     }
     
+    // Drone/GPS side table: getLocation returns nullptr when none was recorded
+    const SubscriberLocation* getLocation(uint64_t subscriber_id) const;
+    SubscriberLocation& getOrCreateLocation(uint64_t subscriber_id);
+    
+    // Approximate heap footprint of the correlator's records and indexes.
+    // Node-based maps are estimated as one node (value + two pointers) per
+    // element plus the bucket array; strings count only beyond the SSO buffer.
+    struct MemoryUsage {
+        size_t subscribers = 0;
+        size_t record_bytes = 0;          // Record slab, record-owned heap and location side table
+        size_t integer_index_bytes = 0;   // S1AP-ID and TEID indexes (flat maps)
+        size_t string_index_bytes = 0;    // IMSI/TMSI/IMEISV keyed indexes
+        size_t teid_set_bytes = 0;        // Identifier -> TEID set mappings
+        size_t total() const {
+            return record_bytes + integer_index_bytes + string_index_bytes + teid_set_bytes;
+        }
+    };
+    MemoryUsage memoryUsage() const;
+    
     // Identifier extraction from S1AP
     std::vector<uint32_t> extractTeidsFromS1ap(const s1ap_parser::S1apParseResult& s1ap_result);
     std::vector<std::string> extractImsisFromS1ap(const s1ap_parser::S1apParseResult& s1ap_result);
@@ -164,16 +204,17 @@ public:
     std::pair<std::optional<uint32_t>, std::optional<uint32_t>> extractS1apIds(const s1ap_parser::S1apParseResult& s1ap_result);
 
 private:
-    // Subscriber records storage (keyed by unique ID)
-    std::unordered_map<uint64_t, SubscriberRecord> subscriber_records_;
-    uint64_t next_subscriber_id_;
+    // Subscriber records storage (slab handle is the subscriber ID)
+    SubscriberSlab subscriber_records_;
+    std::unordered_map<uint64_t, SubscriberLocation> locations_;
     
-    // Identifier to subscriber record ID mappings
+    // Identifier to subscriber record ID mappings (integer keys use flat
+    // open-addressing maps)
     std::unordered_map<std::string, uint64_t> imsi_to_subscriber_id_;
     std::unordered_map<std::string, uint64_t> tmsi_to_subscriber_id_;
-    std::unordered_map<uint32_t, uint64_t> enb_ue_s1ap_id_to_subscriber_id_;
-    std::unordered_map<uint32_t, uint64_t> mme_ue_s1ap_id_to_subscriber_id_;
-    std::unordered_map<uint32_t, uint64_t> teid_to_subscriber_id_;
+    s1see::utils::FlatHashMap<uint32_t, uint64_t> enb_ue_s1ap_id_to_subscriber_id_;
+    s1see::utils::FlatHashMap<uint32_t, uint64_t> mme_ue_s1ap_id_to_subscriber_id_;
+    s1see::utils::FlatHashMap<uint32_t, uint64_t> teid_to_subscriber_id_;
     std::unordered_map<std::string, uint64_t> imeisv_to_subscriber_id_;
     
     // Mappings: Identifier -> Set of TEIDs
@@ -182,9 +223,9 @@ private:
     std::unordered_map<std::string, std::unordered_set<uint32_t>> imeisv_to_teids_;
     
     // Reverse mappings: TEID -> Identifier
-    std::unordered_map<uint32_t, std::string> teid_to_imsi_;
-    std::unordered_map<uint32_t, std::string> teid_to_tmsi_;
-    std::unordered_map<uint32_t, std::string> teid_to_imeisv_;
+    s1see::utils::FlatHashMap<uint32_t, std::string> teid_to_imsi_;
+    s1see::utils::FlatHashMap<uint32_t, std::string> teid_to_tmsi_;
+    s1see::utils::FlatHashMap<uint32_t, std::string> teid_to_imeisv_;
     
     // S1AP ID mappings
     std::unordered_map<std::string, uint32_t> imsi_to_mme_ue_s1ap_id_;
@@ -0,0 +1,832 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: arrow_sink.cc
+ * Description: Implementation of ArrowSink. Events are appended to column
+ *              buffers, cut into record batches, and written out as an Arrow
+ *              IPC file: magic, schema, one dictionary batch per dictionary
+ *              column, the record batches, and a footer indexing them. The
+ *              FlatBuffers metadata is built by a small builder here, so the
+ *              sink needs no Arrow library.
+ */
+
+#include "s1see/sinks/arrow_sink.h"
+#include "event.pb.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace s1see {
+namespace sinks {
+
+namespace {
+
+// Back-to-front FlatBuffers builder, enough for the Arrow IPC metadata
+// (tables, strings, vectors of offsets and of structs). As in the
+// reference builder, an object is identified by its distance from the end
+// of the buffer, so references always point forward. Assumes a
+// little-endian host.
+class FlatBufferBuilder {
+public:
+    using Offset = uint32_t;
+
+    FlatBufferBuilder() : buf_(1024), head_(buf_.size()) {}
+
+    size_t size() const { return buf_.size() - head_; }
+
+    // Pad so that size() + additional is a multiple of alignment
+    void align(size_t alignment, size_t additional = 0) {
+        max_align_ = std::max(max_align_, alignment);
+        size_t padding = (alignment - (size() + additional) % alignment) % alignment;
+        reserve(padding);
+        head_ -= padding;
+        std::memset(&buf_[head_], 0, padding);
+    }
+
+    void push_bytes(const void* data, size_t length) {
+        reserve(length);
+        head_ -= length;
+        std::memcpy(&buf_[head_], data, length);
+    }
+
+    template <typename T>
+    void push(T value) {
+        align(sizeof(T));
+        push_bytes(&value, sizeof(T));
+    }
+
+    void push_offset(Offset target) {
+        align(4);
+        push<uint32_t>(static_cast<uint32_t>(size() + 4 - target));
+    }
+
+    Offset create_string(const std::string& value) {
+        align(4, value.size() + 1);
+        push<uint8_t>(0);
+        push_bytes(value.data(), value.size());
+        push<uint32_t>(static_cast<uint32_t>(value.size()));
+        return static_cast<Offset>(size());
+    }
+
+    Offset create_offset_vector(const std::vector<Offset>& items) {
+        align(4, items.size() * 4);
+        for (auto it = items.rbegin(); it != items.rend(); ++it) {
+            push_offset(*it);
+        }
+        push<uint32_t>(static_cast<uint32_t>(items.size()));
+        return static_cast<Offset>(size());
+    }
+
+    template <typename T>
+    Offset create_struct_vector(const std::vector<T>& items) {
+        align(std::max<size_t>(alignof(T), 4), items.size() * sizeof(T));
+        push_bytes(items.data(), items.size() * sizeof(T));
+        push<uint32_t>(static_cast<uint32_t>(items.size()));
+        return static_cast<Offset>(size());
+    }
+
+    // Tables: children (strings, vectors, other tables) must be created
+    // before start_table(), then the fields added in any order
+    void start_table() {
+        fields_.clear();
+        table_start_ = static_cast<Offset>(size());
+    }
+
+    template <typename T>
+    void add_field(uint16_t id, T value) {
+        push(value);
+        fields_.push_back({id, static_cast<Offset>(size())});
+    }
+
+    void add_offset(uint16_t id, Offset target) {
+        push_offset(target);
+        fields_.push_back({id, static_cast<Offset>(size())});
+    }
+
+    Offset end_table() {
+        push<int32_t>(0);  // Offset to the vtable, patched below
+        Offset table = static_cast<Offset>(size());
+
+        uint16_t slots = 0;
+        for (const auto& field : fields_) {
+            slots = std::max<uint16_t>(slots, field.id + 1);
+        }
+        std::vector<uint16_t> vtable(slots, 0);
+        for (const auto& field : fields_) {
+            vtable[field.id] = static_cast<uint16_t>(table - field.position);
+        }
+        for (auto it = vtable.rbegin(); it != vtable.rend(); ++it) {
+            push<uint16_t>(*it);
+        }
+        push<uint16_t>(static_cast<uint16_t>(table - table_start_));
+        push<uint16_t>(static_cast<uint16_t>((slots + 2) * 2));
+
+        // The vtable precedes the table; the table stores the distance back
+        int32_t to_vtable = static_cast<int32_t>(size() - table);
+        std::memcpy(&buf_[buf_.size() - table], &to_vtable, sizeof(to_vtable));
+        return table;
+    }
+
+    std::string finish(Offset root) {
+        align(std::max<size_t>(max_align_, 8), 4);
+        push_offset(root);
+        return std::string(reinterpret_cast<const char*>(&buf_[head_]), size());
+    }
+
+private:
+    struct FieldLocation {
+        uint16_t id;
+        Offset position;
+    };
+
+    std::vector<uint8_t> buf_;  // Filled from the back; valid bytes are [head_, end)
+    size_t head_;
+    size_t max_align_ = 1;
+    Offset table_start_ = 0;
+    std::vector<FieldLocation> fields_;
+
+    void reserve(size_t length) {
+        if (head_ >= length) {
+            return;
+        }
+        size_t used = size();
+        std::vector<uint8_t> grown(std::max(buf_.size() * 2, used + length));
+        std::memcpy(grown.data() + grown.size() - used, buf_.data() + head_, used);
+        buf_.swap(grown);
+        head_ = buf_.size() - used;
+    }
+};
+
+using Offset = FlatBufferBuilder::Offset;
+
+// Arrow format enums (Schema.fbs, Message.fbs)
+constexpr uint8_t TYPE_INT = 2;
+constexpr uint8_t TYPE_FLOATING_POINT = 3;
+constexpr uint8_t TYPE_UTF8 = 5;
+constexpr uint8_t TYPE_TIMESTAMP = 10;
+constexpr uint8_t TYPE_LIST = 12;
+constexpr uint8_t TYPE_STRUCT = 13;
+constexpr uint8_t TYPE_MAP = 17;
+constexpr uint8_t HEADER_SCHEMA = 1;
+constexpr uint8_t HEADER_DICTIONARY_BATCH = 2;
+constexpr uint8_t HEADER_RECORD_BATCH = 3;
+constexpr int16_t METADATA_V5 = 4;
+constexpr int16_t PRECISION_DOUBLE = 2;
+constexpr int16_t TIME_UNIT_NANOSECOND = 3;
+
+constexpr char FILE_MAGIC[8] = {'A', 'R', 'R', 'O', 'W', '1', 0, 0};
+constexpr uint32_t CONTINUATION = 0xFFFFFFFF;
+
+// Structs from Message.fbs and File.fbs
+struct FieldNode {
+    int64_t length;
+    int64_t null_count;
+};
+struct BufferSpec {
+    int64_t offset;
+    int64_t length;
+};
+struct Block {
+    int64_t offset;
+    int32_t metadata_length;
+    int32_t padding;
+    int64_t body_length;
+};
+static_assert(sizeof(Block) == 24, "Block must match the Arrow File.fbs layout");
+
+enum class ColumnType { DICTIONARY, TIMESTAMP, DOUBLE, INT32, INT64, UTF8, MAP, LIST, STRUCT };
+
+struct FieldSpec {
+    std::string name;
+    ColumnType type;
+    bool nullable;
+    int64_t dictionary_id;
+    int32_t index_bit_width;  // Dictionary columns only
+    std::vector<FieldSpec> children;
+};
+
+Offset build_int_type(FlatBufferBuilder& fbb, int32_t bit_width) {
+    fbb.start_table();
+    fbb.add_field<int32_t>(0, bit_width);  // bitWidth
+    fbb.add_field<uint8_t>(1, 1);          // is_signed
+    return fbb.end_table();
+}
+
+Offset build_field(FlatBufferBuilder& fbb, const FieldSpec& spec) {
+    std::vector<Offset> children;
+    for (const auto& child : spec.children) {
+        children.push_back(build_field(fbb, child));
+    }
+    Offset children_vector = fbb.create_offset_vector(children);
+    Offset name = fbb.create_string(spec.name);
+
+    // Type table; a dictionary column is typed by its values
+    uint8_t type_type = TYPE_UTF8;
+    Offset type = 0;
+    switch (spec.type) {
+        case ColumnType::DICTIONARY:
+        case ColumnType::UTF8:
+            fbb.start_table();
+            type = fbb.end_table();
+            break;
+        case ColumnType::TIMESTAMP: {
+            Offset timezone = fbb.create_string("UTC");
+            fbb.start_table();
+            fbb.add_field<int16_t>(0, TIME_UNIT_NANOSECOND);
+            fbb.add_offset(1, timezone);
+            type = fbb.end_table();
+            type_type = TYPE_TIMESTAMP;
+            break;
+        }
+        case ColumnType::DOUBLE:
+            fbb.start_table();
+            fbb.add_field<int16_t>(0, PRECISION_DOUBLE);
+            type = fbb.end_table();
+            type_type = TYPE_FLOATING_POINT;
+            break;
+        case ColumnType::INT32:
+        case ColumnType::INT64:
+            type = build_int_type(fbb, spec.type == ColumnType::INT32 ? 32 : 64);
+            type_type = TYPE_INT;
+            break;
+        case ColumnType::MAP:
+            fbb.start_table();
+            fbb.add_field<uint8_t>(0, 0);  // keysSorted
+            type = fbb.end_table();
+            type_type = TYPE_MAP;
+            break;
+        case ColumnType::LIST:
+            fbb.start_table();
+            type = fbb.end_table();
+            type_type = TYPE_LIST;
+            break;
+        case ColumnType::STRUCT:
+            fbb.start_table();
+            type = fbb.end_table();
+            type_type = TYPE_STRUCT;
+            break;
+    }
+
+    Offset dictionary = 0;
+    if (spec.type == ColumnType::DICTIONARY) {
+        Offset index_type = build_int_type(fbb, spec.index_bit_width);
+        fbb.start_table();
+        fbb.add_field<int64_t>(0, spec.dictionary_id);
+        fbb.add_offset(1, index_type);
+        fbb.add_field<uint8_t>(2, 0);  // isOrdered
+        dictionary = fbb.end_table();
+    }
+
+    fbb.start_table();
+    fbb.add_offset(0, name);
+    fbb.add_field<uint8_t>(1, spec.nullable ? 1 : 0);
+    fbb.add_field<uint8_t>(2, type_type);
+    fbb.add_offset(3, type);
+    if (dictionary != 0) {
+        fbb.add_offset(4, dictionary);
+    }
+    fbb.add_offset(5, children_vector);
+    return fbb.end_table();
+}
+
+Offset build_schema(FlatBufferBuilder& fbb, const std::vector<FieldSpec>& fields) {
+    std::vector<Offset> offsets;
+    for (const auto& field : fields) {
+        offsets.push_back(build_field(fbb, field));
+    }
+    Offset fields_vector = fbb.create_offset_vector(offsets);
+    fbb.start_table();
+    fbb.add_field<int16_t>(0, 0);  // Little-endian
+    fbb.add_offset(1, fields_vector);
+    return fbb.end_table();
+}
+
+std::string build_message(FlatBufferBuilder& fbb, uint8_t header_type, Offset header, int64_t body_length) {
+    fbb.start_table();
+    fbb.add_field<int16_t>(0, METADATA_V5);
+    fbb.add_field<uint8_t>(1, header_type);
+    fbb.add_offset(2, header);
+    fbb.add_field<int64_t>(3, body_length);
+    return fbb.finish(fbb.end_table());
+}
+
+// Encapsulated message prefix: continuation marker, metadata length, then
+// the metadata padded so the body starts 8-byte aligned
+std::string frame_metadata(const std::string& flatbuffer) {
+    size_t padded = (flatbuffer.size() + 8 + 7) / 8 * 8 - 8;
+    std::string framed(8 + padded, '\0');
+    uint32_t length = static_cast<uint32_t>(padded);
+    std::memcpy(&framed[0], &CONTINUATION, 4);
+    std::memcpy(&framed[4], &length, 4);
+    std::memcpy(&framed[8], flatbuffer.data(), flatbuffer.size());
+    return framed;
+}
+
+// Record batch body: field nodes and buffers in depth-first schema order,
+// each buffer padded to 8 bytes
+struct Body {
+    std::vector<FieldNode> nodes;
+    std::vector<BufferSpec> buffers;
+    std::string data;
+
+    void add_node(size_t length, size_t null_count) {
+        nodes.push_back({static_cast<int64_t>(length), static_cast<int64_t>(null_count)});
+    }
+
+    void add_buffer(const void* bytes, size_t length) {
+        buffers.push_back({static_cast<int64_t>(data.size()), static_cast<int64_t>(length)});
+        data.append(static_cast<const char*>(bytes), length);
+        data.append((8 - data.size() % 8) % 8, '\0');
+    }
+
+    template <typename T>
+    void add_buffer(const std::vector<T>& values) {
+        add_buffer(values.data(), values.size() * sizeof(T));
+    }
+
+    // Validity bitmap is left empty when nothing is null
+    void add_no_nulls() { add_buffer(nullptr, 0); }
+};
+
+std::string record_batch_metadata(const Body& body, size_t rows, int64_t dictionary_id) {
+    FlatBufferBuilder fbb;
+    Offset nodes = fbb.create_struct_vector(body.nodes);
+    Offset buffers = fbb.create_struct_vector(body.buffers);
+    fbb.start_table();
+    fbb.add_field<int64_t>(0, static_cast<int64_t>(rows));
+    fbb.add_offset(1, nodes);
+    fbb.add_offset(2, buffers);
+    Offset batch = fbb.end_table();
+    if (dictionary_id < 0) {
+        return frame_metadata(build_message(fbb, HEADER_RECORD_BATCH, batch,
+                                            static_cast<int64_t>(body.data.size())));
+    }
+    fbb.start_table();
+    fbb.add_field<int64_t>(0, dictionary_id);
+    fbb.add_offset(1, batch);
+    fbb.add_field<uint8_t>(2, 0);  // isDelta
+    Offset dictionary = fbb.end_table();
+    return frame_metadata(build_message(fbb, HEADER_DICTIONARY_BATCH, dictionary,
+                                        static_cast<int64_t>(body.data.size())));
+}
+
+struct StringColumn {
+    std::vector<int32_t> offsets{0};
+    std::string data;
+
+    void append(const std::string& value) {
+        data += value;
+        offsets.push_back(static_cast<int32_t>(data.size()));
+    }
+    size_t count() const { return offsets.size() - 1; }
+    void add_to(Body& body) const {
+        body.add_node(count(), 0);
+        body.add_no_nulls();
+        body.add_buffer(offsets);
+        body.add_buffer(data.data(), data.size());
+    }
+};
+
+bool write_all(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = ::write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+const char* const FIXED_COLUMNS[] = {"name", "ts", "subscriber_key", "confidence", "ruleset_id",
+                                     "ruleset_version", "attributes", "evidence"};
+
+// Dictionary column slots ahead of the attribute columns
+constexpr size_t DICT_NAME = 0;
+constexpr size_t DICT_SUBSCRIBER_KEY = 1;
+constexpr size_t DICT_RULESET_ID = 2;
+constexpr size_t DICT_RULESET_VERSION = 3;
+constexpr size_t DICT_FIRST_ATTRIBUTE = 4;
+
+} // namespace
+
+// Column buffers for the open file: its dictionaries and the rows of each
+// record batch. Encoding waits until the file is written, when the
+// dictionary sizes are known and each column gets the narrowest index type
+// that fits.
+class ArrowSink::Columns {
+public:
+    explicit Columns(const std::vector<std::string>& attributes)
+        : attribute_names_(attributes), dictionaries_(DICT_FIRST_ATTRIBUTE + attributes.size()) {
+        for (size_t i = 0; i < attributes.size(); ++i) {
+            attribute_columns_[attributes[i]] = DICT_FIRST_ATTRIBUTE + i;
+        }
+        batches_.emplace_back(dictionaries_.size());
+    }
+
+    bool empty() const { return events_ == 0; }
+    uint64_t events() const { return events_; }
+
+    // Encoded size of the file if it were written now, give or take the
+    // schema, footer and narrower indices
+    size_t estimated_bytes() const { return estimated_bytes_; }
+
+    void append(const Event& event, size_t batch_rows) {
+        if (batches_.back().rows >= batch_rows) {
+            batches_.emplace_back(dictionaries_.size());
+        }
+        RowBatch& batch = batches_.back();
+        size_t bytes = estimated_bytes_;
+
+        batch.indices[DICT_NAME].push_back(id(DICT_NAME, event.name()));
+        batch.ts.push_back(event.ts());
+        batch.indices[DICT_SUBSCRIBER_KEY].push_back(id(DICT_SUBSCRIBER_KEY, event.subscriber_key()));
+        batch.confidence.push_back(event.confidence());
+        batch.indices[DICT_RULESET_ID].push_back(id(DICT_RULESET_ID, event.ruleset_id()));
+        batch.indices[DICT_RULESET_VERSION].push_back(id(DICT_RULESET_VERSION, event.ruleset_version()));
+
+        // One pass over the attributes: dictionary keys fill their column,
+        // the rest go to the map
+        for (size_t slot = DICT_FIRST_ATTRIBUTE; slot < batch.indices.size(); ++slot) {
+            batch.indices[slot].push_back(-1);
+        }
+        for (const auto& [key, value] : event.attributes()) {
+            auto it = attribute_columns_.find(key);
+            if (it != attribute_columns_.end()) {
+                batch.indices[it->second].back() = id(it->second, value);
+            } else {
+                batch.map_keys.append(key);
+                batch.map_values.append(value);
+                bytes += key.size() + value.size() + 8;
+            }
+        }
+        batch.map_offsets.push_back(static_cast<int32_t>(batch.map_keys.count()));
+
+        for (const auto& offset : event.evidence().offsets()) {
+            batch.partition.push_back(offset.partition());
+            batch.offset.push_back(offset.offset());
+            batch.frame_number.push_back(offset.frame_number());
+        }
+        batch.evidence_offsets.push_back(static_cast<int32_t>(batch.partition.size()));
+        bytes += event.evidence().offsets_size() * 20;
+
+        bytes += batch.indices.size() * 4 + sizeof(int64_t) + sizeof(double) + 8;
+        estimated_bytes_ = bytes;
+        ++batch.rows;
+        ++events_;
+    }
+
+    // Write the whole file to fd; returns the bytes written, or 0 on error
+    size_t write(int fd) {
+        std::vector<int32_t> index_widths;
+        for (const auto& dictionary : dictionaries_) {
+            size_t values = dictionary.values.size();
+            index_widths.push_back(values <= 0x80 ? 8 : values <= 0x8000 ? 16 : 32);
+        }
+        std::vector<FieldSpec> schema = field_specs(index_widths);
+
+        size_t position = 0;
+        auto put = [&](const char* bytes, size_t length) {
+            if (!write_all(fd, bytes, length)) {
+                return false;
+            }
+            position += length;
+            return true;
+        };
+        std::vector<Block> dictionary_blocks;
+        std::vector<Block> record_blocks;
+        auto put_message = [&](const std::string& metadata, const std::string& body, std::vector<Block>* blocks) {
+            if (blocks) {
+                blocks->push_back({static_cast<int64_t>(position), static_cast<int32_t>(metadata.size()), 0,
+                                   static_cast<int64_t>(body.size())});
+            }
+            return put(metadata.data(), metadata.size()) && put(body.data(), body.size());
+        };
+
+        FlatBufferBuilder schema_fbb;
+        Offset schema_table = build_schema(schema_fbb, schema);
+        if (!put(FILE_MAGIC, sizeof(FILE_MAGIC)) ||
+            !put_message(frame_metadata(build_message(schema_fbb, HEADER_SCHEMA, schema_table, 0)), "", nullptr)) {
+            return 0;
+        }
+
+        for (size_t slot = 0; slot < dictionaries_.size(); ++slot) {
+            StringColumn values;
+            for (const std::string* value : dictionaries_[slot].values) {
+                values.append(*value);
+            }
+            Body body;
+            values.add_to(body);
+            if (!put_message(record_batch_metadata(body, values.count(), static_cast<int64_t>(slot)), body.data,
+                             &dictionary_blocks)) {
+                return 0;
+            }
+        }
+        for (auto& batch : batches_) {
+            if (batch.rows == 0) {
+                continue;
+            }
+            Body body = encode(batch, index_widths);
+            if (!put_message(record_batch_metadata(body, batch.rows, -1), body.data, &record_blocks)) {
+                return 0;
+            }
+        }
+
+        // End-of-stream marker, then the footer, its length and the magic
+        const uint32_t eos[2] = {CONTINUATION, 0};
+        FlatBufferBuilder fbb;
+        Offset footer_schema = build_schema(fbb, schema);
+        Offset dictionaries = fbb.create_struct_vector(dictionary_blocks);
+        Offset records = fbb.create_struct_vector(record_blocks);
+        fbb.start_table();
+        fbb.add_field<int16_t>(0, METADATA_V5);
+        fbb.add_offset(1, footer_schema);
+        fbb.add_offset(2, dictionaries);
+        fbb.add_offset(3, records);
+        std::string footer = fbb.finish(fbb.end_table());
+        int32_t footer_length = static_cast<int32_t>(footer.size());
+        if (!put(reinterpret_cast<const char*>(eos), sizeof(eos)) || !put(footer.data(), footer.size()) ||
+            !put(reinterpret_cast<const char*>(&footer_length), sizeof(footer_length)) || !put(FILE_MAGIC, 6)) {
+            return 0;
+        }
+        return position;
+    }
+
+private:
+    struct Dictionary {
+        std::unordered_map<std::string, int32_t> ids;
+        std::vector<const std::string*> values;  // By id; keys of ids are stable
+    };
+
+    struct RowBatch {
+        explicit RowBatch(size_t dictionary_columns) : indices(dictionary_columns) {}
+
+        size_t rows = 0;
+        std::vector<std::vector<int32_t>> indices;  // Per dictionary column; -1 for null
+        std::vector<int64_t> ts;
+        std::vector<double> confidence;
+        std::vector<int32_t> map_offsets{0};
+        StringColumn map_keys;
+        StringColumn map_values;
+        std::vector<int32_t> evidence_offsets{0};
+        std::vector<int32_t> partition;
+        std::vector<int64_t> offset;
+        std::vector<int64_t> frame_number;
+    };
+
+    std::vector<std::string> attribute_names_;
+    std::unordered_map<std::string, size_t> attribute_columns_;  // Key -> dictionary column
+    std::vector<Dictionary> dictionaries_;
+    std::vector<RowBatch> batches_;
+    size_t estimated_bytes_ = 0;
+    uint64_t events_ = 0;
+
+    int32_t id(size_t slot, const std::string& value) {
+        Dictionary& dictionary = dictionaries_[slot];
+        auto [it, inserted] = dictionary.ids.try_emplace(value, static_cast<int32_t>(dictionary.values.size()));
+        if (inserted) {
+            dictionary.values.push_back(&it->first);
+            estimated_bytes_ += value.size() + 4;
+        }
+        return it->second;
+    }
+
+    static Body encode(const RowBatch& batch, const std::vector<int32_t>& index_widths) {
+        Body body;
+        size_t slot = 0;
+        auto add_fixed_column = [&](const auto& values) {
+            body.add_node(values.size(), 0);
+            body.add_no_nulls();
+            body.add_buffer(values);
+        };
+        auto add_indices = [&](const std::vector<int32_t>& indices, auto narrow) {
+            std::vector<decltype(narrow)> values(indices.size());
+            for (size_t row = 0; row < indices.size(); ++row) {
+                values[row] = static_cast<decltype(narrow)>(std::max<int32_t>(indices[row], 0));
+            }
+            body.add_buffer(values);
+        };
+        auto add_dictionary_column = [&] {
+            const std::vector<int32_t>& indices = batch.indices[slot];
+            size_t nulls = std::count(indices.begin(), indices.end(), -1);
+            body.add_node(indices.size(), nulls);
+            if (nulls == 0) {
+                body.add_no_nulls();
+            } else {
+                std::vector<uint8_t> validity((indices.size() + 7) / 8, 0);
+                for (size_t row = 0; row < indices.size(); ++row) {
+                    if (indices[row] >= 0) {
+                        validity[row / 8] |= static_cast<uint8_t>(1u << (row % 8));
+                    }
+                }
+                body.add_buffer(validity);
+            }
+            switch (index_widths[slot]) {
+                case 8: add_indices(indices, int8_t()); break;
+                case 16: add_indices(indices, int16_t()); break;
+                default: add_indices(indices, int32_t()); break;
+            }
+            ++slot;
+        };
+
+        add_dictionary_column();  // name
+        add_fixed_column(batch.ts);
+        add_dictionary_column();  // subscriber_key
+        add_fixed_column(batch.confidence);
+        add_dictionary_column();  // ruleset_id
+        add_dictionary_column();  // ruleset_version
+        while (slot < batch.indices.size()) {
+            add_dictionary_column();
+        }
+
+        // attributes: map -> entries struct -> key, value
+        body.add_node(batch.rows, 0);
+        body.add_no_nulls();
+        body.add_buffer(batch.map_offsets);
+        body.add_node(batch.map_keys.count(), 0);
+        body.add_no_nulls();
+        batch.map_keys.add_to(body);
+        batch.map_values.add_to(body);
+
+        // evidence: list -> struct -> partition, offset, frame_number
+        body.add_node(batch.rows, 0);
+        body.add_no_nulls();
+        body.add_buffer(batch.evidence_offsets);
+        body.add_node(batch.partition.size(), 0);
+        body.add_no_nulls();
+        add_fixed_column(batch.partition);
+        add_fixed_column(batch.offset);
+        add_fixed_column(batch.frame_number);
+        return body;
+    }
+
+    std::vector<FieldSpec> field_specs(const std::vector<int32_t>& index_widths) const {
+        auto dictionary = [&](const std::string& name, size_t slot, bool nullable) {
+            return FieldSpec{name, ColumnType::DICTIONARY, nullable, static_cast<int64_t>(slot),
+                             index_widths[slot], {}};
+        };
+        auto plain = [](const std::string& name, ColumnType type, bool nullable) {
+            return FieldSpec{name, type, nullable, -1, 0, {}};
+        };
+
+        std::vector<FieldSpec> fields;
+        fields.push_back(dictionary("name", DICT_NAME, false));
+        fields.push_back(plain("ts", ColumnType::TIMESTAMP, false));
+        fields.push_back(dictionary("subscriber_key", DICT_SUBSCRIBER_KEY, false));
+        fields.push_back(plain("confidence", ColumnType::DOUBLE, false));
+        fields.push_back(dictionary("ruleset_id", DICT_RULESET_ID, false));
+        fields.push_back(dictionary("ruleset_version", DICT_RULESET_VERSION, false));
+        for (size_t i = 0; i < attribute_names_.size(); ++i) {
+            fields.push_back(dictionary(attribute_names_[i], DICT_FIRST_ATTRIBUTE + i, true));
+        }
+
+        FieldSpec entries = plain("entries", ColumnType::STRUCT, false);
+        entries.children = {plain("key", ColumnType::UTF8, false), plain("value", ColumnType::UTF8, true)};
+        FieldSpec attributes = plain("attributes", ColumnType::MAP, false);
+        attributes.children = {entries};
+        fields.push_back(attributes);
+
+        FieldSpec item = plain("item", ColumnType::STRUCT, false);
+        item.children = {plain("partition", ColumnType::INT32, false), plain("offset", ColumnType::INT64, false),
+                         plain("frame_number", ColumnType::INT64, false)};
+        FieldSpec evidence = plain("evidence", ColumnType::LIST, false);
+        evidence.children = {item};
+        fields.push_back(evidence);
+        return fields;
+    }
+};
+
+ArrowSink::ArrowSink(const Config& config) : config_(config) {
+    config_.batch_rows = std::max<size_t>(config_.batch_rows, 1);
+    for (size_t i = 0; i < config_.dictionary_attributes.size(); ++i) {
+        const std::string& key = config_.dictionary_attributes[i];
+        bool clash = std::find(std::begin(FIXED_COLUMNS), std::end(FIXED_COLUMNS), key) != std::end(FIXED_COLUMNS) ||
+                     std::find(config_.dictionary_attributes.begin(),
+                               config_.dictionary_attributes.begin() + i, key) !=
+                         config_.dictionary_attributes.begin() + i;
+        if (clash) {
+            throw std::runtime_error("Arrow sink attribute column clashes with another column: " + key);
+        }
+    }
+    fs::create_directories(config_.directory);
+    columns_ = std::make_unique<Columns>(config_.dictionary_attributes);
+}
+
+ArrowSink::~ArrowSink() {
+    close();
+}
+
+std::vector<std::string> ArrowSink::column_names() const {
+    std::vector<std::string> names(std::begin(FIXED_COLUMNS), std::end(FIXED_COLUMNS) - 2);
+    names.insert(names.end(), config_.dictionary_attributes.begin(), config_.dictionary_attributes.end());
+    names.push_back("attributes");
+    names.push_back("evidence");
+    return names;
+}
+
+bool ArrowSink::append(const Event& event) {
+    bool ok = true;
+    if (!columns_->empty() && std::chrono::steady_clock::now() - file_started_ >= config_.roll_interval) {
+        ok = write_file();
+    }
+    if (columns_->empty()) {
+        file_started_ = std::chrono::steady_clock::now();
+    }
+
+    columns_->append(event, config_.batch_rows);
+    if (columns_->estimated_bytes() >= config_.roll_bytes) {
+        ok = write_file() && ok;
+    }
+    return ok;
+}
+
+bool ArrowSink::emit(const Event& event) {
+    if (closed_) {
+        return false;
+    }
+    return append(event);
+}
+
+bool ArrowSink::emit_batch(const std::vector<Event>& events) {
+    if (closed_) {
+        return false;
+    }
+    bool ok = true;
+    for (const auto& event : events) {
+        ok = append(event) && ok;
+    }
+    return ok;
+}
+
+bool ArrowSink::write_file() {
+    if (columns_->empty()) {
+        return true;
+    }
+
+    char stamp[32];
+    std::time_t now = std::time(nullptr);
+    std::tm utc;
+    gmtime_r(&now, &utc);
+    std::strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%SZ", &utc);
+    char sequence[16];
+    std::snprintf(sequence, sizeof(sequence), "%06llu", static_cast<unsigned long long>(file_sequence_++));
+    fs::path path = fs::path(config_.directory) / (config_.file_prefix + "-" + stamp + "-" + sequence + ".arrow");
+    std::string tmp_path = path.string() + ".tmp";
+
+    uint64_t events = columns_->events();
+    size_t written = 0;
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        written = columns_->write(fd);
+        if (::close(fd) != 0) {
+            written = 0;
+        }
+    }
+
+    // The file's events go either way; a failed file is not retried
+    columns_ = std::make_unique<Columns>(config_.dictionary_attributes);
+    if (written == 0 || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::cerr << "Failed to write Arrow file: " << path.string() << std::endl;
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+
+    stats_.files_written++;
+    stats_.events_written += events;
+    stats_.bytes_written += written;
+    return true;
+}
+
+bool ArrowSink::roll() {
+    return write_file();
+}
+
+void ArrowSink::flush() {
+    if (!columns_->empty() && std::chrono::steady_clock::now() - file_started_ >= config_.roll_interval) {
+        write_file();
+    }
+}
+
+void ArrowSink::close() {
+    if (!closed_) {
+        write_file();
+        closed_ = true;
+    }
+}
+
+} // namespace sinks
+} // namespace s1see
@@ -0,0 +1,281 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: async_sink.cc
+ * Description: Implementation of AsyncSink. Producers queue events under a
+ *              short lock; a writer thread takes batches off the ring (then
+ *              the spill file) and hands them to the wrapped sink.
+ */
+
+#include "s1see/sinks/async_sink.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+namespace s1see {
+namespace sinks {
+
+AsyncSink::AsyncSink(std::shared_ptr<Sink> sink, const Config& config)
+    : sink_(std::move(sink)), config_(config) {
+    config_.capacity = std::max<size_t>(config_.capacity, 1);
+    config_.max_batch = std::max<size_t>(config_.max_batch, 1);
+    ring_.resize(config_.capacity);
+    
+    if (config_.overflow == OverflowPolicy::SPILL_TO_DISK) {
+        if (config_.spill_path.empty()) {
+            throw std::runtime_error("AsyncSink spill policy requires spill_path");
+        }
+        spill_.open(config_.spill_path, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!spill_.is_open()) {
+            throw std::runtime_error("Failed to open sink spill file: " + config_.spill_path);
+        }
+    }
+    
+    writer_ = std::thread(&AsyncSink::writer_loop, this);
+}
+
+AsyncSink::~AsyncSink() {
+    close();
+}
+
+bool AsyncSink::emit(const Event& event) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    bool ok = enqueue_locked(event, lock);
+    lock.unlock();
+    not_empty_.notify_one();
+    return ok;
+}
+
+bool AsyncSink::emit_batch(const std::vector<Event>& events) {
+    if (events.empty()) {
+        return true;
+    }
+    bool all_ok = true;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (const auto& event : events) {
+        if (!enqueue_locked(event, lock)) {
+            all_ok = false;
+        }
+    }
+    lock.unlock();
+    not_empty_.notify_one();
+    return all_ok;
+}
+
+bool AsyncSink::enqueue_locked(const Event& event, std::unique_lock<std::mutex>& lock) {
+    if (stopping_) {
+        return false;
+    }
+    if (spill_pending_ > 0) {
+        spill_locked(event);
+        return true;
+    }
+    
+    bool ok = true;
+    if (count_ == config_.capacity) {
+        switch (config_.overflow) {
+            case OverflowPolicy::BLOCK:
+                // Let the writer take what is queued before waiting
+                not_empty_.notify_one();
+                not_full_.wait(lock, [this]() { return stopping_ || count_ < config_.capacity; });
+                if (stopping_) {
+                    return false;
+                }
+                break;
+            case OverflowPolicy::DROP_OLDEST:
+                head_ = (head_ + 1) % config_.capacity;
+                --count_;
+                ++stats_.dropped;
+                ok = false;
+                break;
+            case OverflowPolicy::SPILL_TO_DISK:
+                spill_locked(event);
+                return true;
+        }
+    }
+    
+    ring_[(head_ + count_) % config_.capacity] = event;
+    ++count_;
+    ++stats_.enqueued;
+    return ok;
+}
+
+void AsyncSink::spill_locked(const Event& event) {
+    std::string bytes;
+    if (!event.SerializeToString(&bytes)) {
+        ++stats_.dropped;
+        mark_lost_locked();
+        return;
+    }
+    uint32_t length = static_cast<uint32_t>(bytes.size());
+    spill_.clear();
+    spill_.seekp(static_cast<std::streamoff>(spill_write_pos_));
+    spill_.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    spill_.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    if (!spill_) {
+        std::cerr << "Failed to write sink spill file: " << config_.spill_path << std::endl;
+        ++stats_.dropped;
+        mark_lost_locked();
+        return;
+    }
+    spill_write_pos_ += sizeof(length) + bytes.size();
+    ++spill_pending_;
+    ++stats_.spilled;
+    ++stats_.enqueued;
+}
+
+bool AsyncSink::read_spill_locked(std::vector<Event>& batch) {
+    spill_.clear();
+    spill_.flush();
+    spill_.seekg(static_cast<std::streamoff>(spill_read_pos_));
+    std::string bytes;
+    while (spill_pending_ > 0 && batch.size() < config_.max_batch) {
+        uint32_t length = 0;
+        spill_.read(reinterpret_cast<char*>(&length), sizeof(length));
+        bytes.resize(length);
+        spill_.read(bytes.data(), length);
+        if (!spill_) {
+            // Unreadable tail: count what is left as dropped and start over
+            std::cerr << "Failed to read sink spill file: " << config_.spill_path << std::endl;
+            stats_.dropped += spill_pending_;
+            spill_pending_ = 0;
+            mark_lost_locked();
+            break;
+        }
+        spill_read_pos_ += sizeof(length) + length;
+        --spill_pending_;
+        batch.emplace_back();
+        if (!batch.back().ParseFromString(bytes)) {
+            batch.pop_back();
+            ++stats_.dropped;
+            mark_lost_locked();
+        }
+    }
+    
+    if (spill_pending_ == 0) {
+        // Caught up: truncate so the file does not grow without bound
+        spill_write_pos_ = 0;
+        spill_read_pos_ = 0;
+        spill_.clear();
+        std::error_code ec;
+        std::filesystem::resize_file(config_.spill_path, 0, ec);
+    }
+    return !batch.empty();
+}
+
+void AsyncSink::writer_loop() {
+    std::vector<Event> batch;
+    batch.reserve(config_.max_batch);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        not_empty_.wait(lock, [this]() { return stopping_ || count_ > 0 || spill_pending_ > 0; });
+        if (count_ == 0 && spill_pending_ == 0) {
+            break;  // Stopping and fully drained
+        }
+        
+        // The ring holds everything queued before spilling began, so it is
+        // always written ahead of the spill file
+        batch.clear();
+        if (count_ > 0) {
+            size_t n = std::min(count_, config_.max_batch);
+            for (size_t i = 0; i < n; ++i) {
+                batch.push_back(std::move(ring_[head_]));
+                ring_[head_].Clear();
+                head_ = (head_ + 1) % config_.capacity;
+            }
+            count_ -= n;
+            not_full_.notify_all();
+        } else {
+            read_spill_locked(batch);
+        }
+        
+        writing_ = true;
+        lock.unlock();
+        bool ok = batch.empty() || sink_->emit_batch(batch);
+        lock.lock();
+        writing_ = false;
+        if (ok) {
+            stats_.emitted += batch.size();
+        } else {
+            mark_lost_locked();
+            stats_.failed += batch.size();
+        }
+        if (idle_locked()) {
+            drained_.notify_all();
+        }
+    }
+    drained_.notify_all();
+}
+
+void AsyncSink::flush() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        drained_.wait(lock, [this]() { return idle_locked() || !writer_.joinable(); });
+    }
+    sink_->flush();
+}
+
+void AsyncSink::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    sink_->flush();
+    sink_->close();
+    if (spill_.is_open()) {
+        spill_.close();
+        std::error_code ec;
+        std::filesystem::remove(config_.spill_path, ec);
+    }
+}
+
+void AsyncSink::mark_lost_locked() {
+    if (!lost_) {
+        lost_ = true;
+        emitted_at_loss_ = stats_.emitted;
+    }
+}
+
+uint64_t AsyncSink::accepted_sequence() const {
+    if (config_.overflow == OverflowPolicy::DROP_OLDEST) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_.enqueued;
+}
+
+uint64_t AsyncSink::delivered_sequence() const {
+    if (config_.overflow == OverflowPolicy::DROP_OLDEST) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t written = lost_ ? emitted_at_loss_ : stats_.emitted;
+    // A tracking sink numbers what it accepts the same way, one for one
+    // until the first loss, which freezes `written`
+    if (sink_->accepted_sequence() == 0) {
+        return written;
+    }
+    return std::min(written, sink_->delivered_sequence());
+}
+
+AsyncSink::Stats AsyncSink::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.queue_depth = count_;
+    stats.spill_depth = spill_pending_;
+    return stats;
+}
+
+} // namespace sinks
+} // namespace s1see
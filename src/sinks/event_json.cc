@@ -0,0 +1,244 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: event_json.cc
+ * Description: Implementation of the direct Event JSON serializer. String
+ *              escaping and double formatting follow protobuf's JSON printer
+ *              so output is byte-for-byte compatible with earlier releases.
+ */
+
+#include "s1see/sinks/event_json.h"
+#include <cfloat>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace s1see {
+namespace sinks {
+
+namespace {
+    const char kHex[] = "0123456789abcdef";
+
+    void append_unicode_escape(std::string& out, uint32_t unit) {
+        char buf[6] = {'\\', 'u', kHex[(unit >> 12) & 0xF], kHex[(unit >> 8) & 0xF],
+                       kHex[(unit >> 4) & 0xF], kHex[unit & 0xF]};
+        out.append(buf, sizeof(buf));
+    }
+
+    // Code points protobuf escapes even though they are valid UTF-8:
+    // C1 controls and invisible formatting characters
+    bool needs_escape(uint32_t cp) {
+        return (cp >= 0x7F && cp <= 0x9F) || cp == 0xAD ||
+               (cp >= 0x600 && cp <= 0x603) || cp == 0x6DD || cp == 0x70F ||
+               cp == 0x17B4 || cp == 0x17B5 ||
+               (cp >= 0x200B && cp <= 0x200F) || (cp >= 0x2028 && cp <= 0x202E) ||
+               (cp >= 0x2060 && cp <= 0x2064) || (cp >= 0x206A && cp <= 0x206F) ||
+               cp == 0xFEFF || (cp >= 0xFFF9 && cp <= 0xFFFB) ||
+               (cp >= 0x1D173 && cp <= 0x1D17A) ||
+               cp == 0xE0001 || (cp >= 0xE0020 && cp <= 0xE007F);
+    }
+
+    // Decode one UTF-8 sequence at s[i]; returns its length, or 0 if the
+    // byte at i does not start a valid sequence
+    size_t decode_utf8(const std::string& s, size_t i, uint32_t& cp) {
+        auto byte = [&](size_t k) { return static_cast<uint8_t>(s[k]); };
+        auto cont = [&](size_t k) { return k < s.size() && (byte(k) & 0xC0) == 0x80; };
+        uint8_t b = byte(i);
+        if (b < 0x80) {
+            cp = b;
+            return 1;
+        }
+        if (b >= 0xC2 && b <= 0xDF && cont(i + 1)) {
+            cp = ((b & 0x1Fu) << 6) | (byte(i + 1) & 0x3Fu);
+            return 2;
+        }
+        if (b >= 0xE0 && b <= 0xEF && cont(i + 1) && cont(i + 2)) {
+            cp = ((b & 0x0Fu) << 12) | ((byte(i + 1) & 0x3Fu) << 6) | (byte(i + 2) & 0x3Fu);
+            return (cp >= 0x800 && (cp < 0xD800 || cp > 0xDFFF)) ? 3 : 0;
+        }
+        if (b >= 0xF0 && b <= 0xF4 && cont(i + 1) && cont(i + 2) && cont(i + 3)) {
+            cp = ((b & 0x07u) << 18) | ((byte(i + 1) & 0x3Fu) << 12) |
+                 ((byte(i + 2) & 0x3Fu) << 6) | (byte(i + 3) & 0x3Fu);
+            return (cp >= 0x10000 && cp <= 0x10FFFF) ? 4 : 0;
+        }
+        return 0;
+    }
+
+    void append_string(std::string& out, const std::string& s) {
+        out.push_back('"');
+        size_t i = 0;
+        while (i < s.size()) {
+            // Plain ASCII runs are copied in one go
+            size_t run = i;
+            while (run < s.size()) {
+                uint8_t c = static_cast<uint8_t>(s[run]);
+                if (c < 0x20 || c >= 0x7F || c == '"' || c == '\\' || c == '<' || c == '>') break;
+                ++run;
+            }
+            out.append(s, i, run - i);
+            i = run;
+            if (i == s.size()) break;
+
+            uint32_t cp = 0;
+            size_t len = decode_utf8(s, i, cp);
+            if (len == 0) {
+                ++i;  // Invalid UTF-8 (not valid in a proto3 string) is dropped
+                continue;
+            }
+            switch (cp) {
+                case '"': out.append("\\\""); break;
+                case '\\': out.append("\\\\"); break;
+                case '\b': out.append("\\b"); break;
+                case '\f': out.append("\\f"); break;
+                case '\n': out.append("\\n"); break;
+                case '\r': out.append("\\r"); break;
+                case '\t': out.append("\\t"); break;
+                default:
+                    if (cp < 0x20 || cp == '<' || cp == '>' || needs_escape(cp)) {
+                        if (cp >= 0x10000) {
+                            cp -= 0x10000;
+                            append_unicode_escape(out, 0xD800 + (cp >> 10));
+                            append_unicode_escape(out, 0xDC00 + (cp & 0x3FF));
+                        } else {
+                            append_unicode_escape(out, cp);
+                        }
+                    } else {
+                        out.append(s, i, len);
+                    }
+            }
+            i += len;
+        }
+        out.push_back('"');
+    }
+
+    template <typename Int>
+    void append_int(std::string& out, Int value) {
+        char buf[24];
+        auto result = std::to_chars(buf, buf + sizeof(buf), value);
+        out.append(buf, result.ptr);
+    }
+
+    // int64 fields are JSON strings in proto3
+    void append_int64(std::string& out, int64_t value) {
+        out.push_back('"');
+        append_int(out, value);
+        out.push_back('"');
+    }
+
+    // protobuf's SimpleDtoa: %.15g if it round-trips, else %.17g
+    void append_double(std::string& out, double value) {
+        if (std::isnan(value)) {
+            out.append("\"NaN\"");
+            return;
+        }
+        if (std::isinf(value)) {
+            out.append(value > 0 ? "\"Infinity\"" : "\"-Infinity\"");
+            return;
+        }
+        char buf[32];
+        int n = std::snprintf(buf, sizeof(buf), "%.*g", DBL_DIG, value);
+        if (std::strtod(buf, nullptr) != value) {
+            n = std::snprintf(buf, sizeof(buf), "%.*g", DBL_DIG + 2, value);
+        }
+        out.append(buf, static_cast<size_t>(n));
+    }
+
+    void append_key(std::string& out, bool& first, const char* key) {
+        if (!first) out.push_back(',');
+        first = false;
+        out.push_back('"');
+        out.append(key);
+        out.append("\":");
+    }
+
+    void append_evidence(std::string& out, const EvidenceChain& evidence) {
+        out.push_back('{');
+        if (evidence.offsets_size() > 0) {
+            out.append("\"offsets\":[");
+            bool first_offset = true;
+            for (const auto& offset : evidence.offsets()) {
+                if (!first_offset) out.push_back(',');
+                first_offset = false;
+                out.push_back('{');
+                bool first = true;
+                if (offset.partition() != 0) {
+                    append_key(out, first, "partition");
+                    append_int(out, offset.partition());
+                }
+                if (offset.offset() != 0) {
+                    append_key(out, first, "offset");
+                    append_int64(out, offset.offset());
+                }
+                if (offset.frame_number() != 0) {
+                    append_key(out, first, "frame_number");
+                    append_int64(out, offset.frame_number());
+                }
+                out.push_back('}');
+            }
+            out.push_back(']');
+        }
+        out.push_back('}');
+    }
+} // anonymous namespace
+
+void append_event_json(const Event& event, std::string& out) {
+    // Fields in declaration order; proto3 defaults are omitted
+    out.push_back('{');
+    bool first = true;
+    if (!event.name().empty()) {
+        append_key(out, first, "name");
+        append_string(out, event.name());
+    }
+    if (event.ts() != 0) {
+        append_key(out, first, "ts");
+        append_int64(out, event.ts());
+    }
+    if (!event.subscriber_key().empty()) {
+        append_key(out, first, "subscriber_key");
+        append_string(out, event.subscriber_key());
+    }
+    if (!event.attributes().empty()) {
+        // Map iteration order matches what the reflection printer emits
+        append_key(out, first, "attributes");
+        out.push_back('{');
+        bool first_attr = true;
+        for (const auto& [key, value] : event.attributes()) {
+            if (!first_attr) out.push_back(',');
+            first_attr = false;
+            append_string(out, key);
+            out.push_back(':');
+            append_string(out, value);
+        }
+        out.push_back('}');
+    }
+    if (event.confidence() != 0 || std::signbit(event.confidence())) {
+        append_key(out, first, "confidence");
+        append_double(out, event.confidence());
+    }
+    if (event.has_evidence()) {
+        append_key(out, first, "evidence");
+        append_evidence(out, event.evidence());
+    }
+    if (!event.ruleset_id().empty()) {
+        append_key(out, first, "ruleset_id");
+        append_string(out, event.ruleset_id());
+    }
+    if (!event.ruleset_version().empty()) {
+        append_key(out, first, "ruleset_version");
+        append_string(out, event.ruleset_version());
+    }
+    out.push_back('}');
+}
+
+std::string event_to_json(const Event& event) {
+    std::string out;
+    out.reserve(256);
+    append_event_json(event, out);
+    return out;
+}
+
+} // namespace sinks
+} // namespace s1see
@@ -0,0 +1,213 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: grpc_sink.cc
+ * Description: Implementation of GrpcEventSink. Each Subscribe stream writes
+ *              batches from the shared event buffer on the handler thread
+ *              while a second thread reads the subscriber's acks.
+ */
+
+#include "s1see/sinks/grpc_sink.h"
+#include <grpcpp/server_builder.h>
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+namespace s1see {
+namespace sinks {
+
+GrpcEventSink::GrpcEventSink(const Config& config)
+    : config_(config) {
+    config_.buffer_events = std::max<size_t>(config_.buffer_events, 1);
+    config_.max_batch = std::max<size_t>(config_.max_batch, 1);
+}
+
+GrpcEventSink::~GrpcEventSink() {
+    stop();
+}
+
+bool GrpcEventSink::start() {
+    if (running_.exchange(true)) {
+        return false; // Already running
+    }
+
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort(config_.listen_address, grpc::InsecureServerCredentials(), &port_);
+    if (config_.compress) {
+        builder.SetDefaultCompressionAlgorithm(GRPC_COMPRESS_GZIP);
+    }
+    builder.RegisterService(this);
+
+    server_ = builder.BuildAndStart();
+    if (!server_ || port_ == 0) {
+        std::cerr << "GrpcEventSink: failed to listen on " << config_.listen_address << std::endl;
+        server_.reset();
+        running_ = false;
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+    return true;
+}
+
+void GrpcEventSink::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    events_ready_.notify_all();
+    space_ready_.notify_all();
+
+    // Streams see stopping_ and finish; the deadline cancels any that do not
+    server_->Shutdown(std::chrono::system_clock::now() + std::chrono::seconds(1));
+    server_.reset();
+}
+
+void GrpcEventSink::close() {
+    stop();
+}
+
+bool GrpcEventSink::emit(const Event& event) {
+    return emit_batch(std::vector<Event>{event});
+}
+
+bool GrpcEventSink::emit_batch(const std::vector<Event>& events) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (const auto& event : events) {
+        if (buffer_.size() >= config_.buffer_events) {
+            // Let subscribers take what is buffered before waiting for acks
+            events_ready_.notify_all();
+            space_ready_.wait(lock, [this]() {
+                return stopping_ || !running_ || buffer_.size() < config_.buffer_events;
+            });
+        }
+        if (stopping_ || !running_) {
+            return false;
+        }
+        buffer_.push_back(event);
+        ++accepted_;
+    }
+    lock.unlock();
+    events_ready_.notify_all();
+    return true;
+}
+
+void GrpcEventSink::acknowledge_locked(int64_t sequence) {
+    sequence = std::min(sequence, accepted_);
+    if (sequence <= delivered_) {
+        return;
+    }
+    delivered_ = sequence;
+    while (first_buffered_ <= delivered_ && !buffer_.empty()) {
+        buffer_.pop_front();
+        ++first_buffered_;
+    }
+    stats_.delivered = static_cast<uint64_t>(delivered_);
+    space_ready_.notify_all();
+}
+
+uint64_t GrpcEventSink::accepted_sequence() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<uint64_t>(accepted_);
+}
+
+uint64_t GrpcEventSink::delivered_sequence() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<uint64_t>(delivered_);
+}
+
+GrpcEventSink::Stats GrpcEventSink::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.buffered = buffer_.size();
+    return stats;
+}
+
+grpc::Status GrpcEventSink::Subscribe(
+    grpc::ServerContext* context,
+    grpc::ServerReaderWriter<EventBatch, EventStreamRequest>* stream) {
+
+    EventStreamRequest request;
+    if (!stream->Read(&request) || !request.has_subscribe()) {
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "First message must be a subscribe request");
+    }
+
+    // Resuming after n says events up to n are durable at the subscriber
+    int64_t next;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.subscribers;
+        acknowledge_locked(request.subscribe().resume_after());
+        next = std::max(request.subscribe().resume_after() + 1, first_buffered_);
+    }
+
+    // Acks are read on a second thread while this one writes
+    bool reading = true;
+    std::thread ack_reader([&]() {
+        EventStreamRequest ack;
+        while (stream->Read(&ack)) {
+            if (ack.has_ack()) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                acknowledge_locked(ack.ack().sequence());
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        reading = false;
+        events_ready_.notify_all();
+    });
+
+    while (true) {
+        EventBatch batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto done = [&]() { return stopping_ || !reading || context->IsCancelled(); };
+            // Events acked through another stream are released; skip them
+            auto available = [&]() { return accepted_ - std::max(next, first_buffered_) + 1; };
+            while (!done() && available() <= 0) {
+                events_ready_.wait_for(lock, std::chrono::milliseconds(100));
+            }
+            if (done()) {
+                break;
+            }
+            if (available() < static_cast<int64_t>(config_.max_batch)) {
+                events_ready_.wait_for(lock, config_.linger, [&]() {
+                    return done() || available() >= static_cast<int64_t>(config_.max_batch);
+                });
+            }
+
+            next = std::max(next, first_buffered_);
+            int64_t count = std::min<int64_t>(available(), static_cast<int64_t>(config_.max_batch));
+            batch.set_first_sequence(next);
+            for (int64_t i = 0; i < count; ++i) {
+                *batch.add_events() = buffer_[static_cast<size_t>(next - first_buffered_ + i)];
+            }
+        }
+        if (batch.events_size() == 0) {
+            continue;
+        }
+        if (!stream->Write(batch)) {
+            break;
+        }
+        next += batch.events_size();
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.sent += static_cast<uint64_t>(batch.events_size());
+    }
+
+    context->TryCancel(); // Unblock the pending Read()
+    ack_reader.join();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    --stats_.subscribers;
+    if (stopping_) {
+        return grpc::Status(grpc::StatusCode::UNAVAILABLE, "Event sink stopped");
+    }
+    return grpc::Status::OK;
+}
+
+} // namespace sinks
+} // namespace s1see
@@ -10,21 +10,24 @@
  */
 
 #include "s1see/sinks/jsonl_sink.h"
+#include "s1see/sinks/event_json.h"
 #include "event.pb.h"
-#include <google/protobuf/util/json_util.h>
+#include <cerrno>
 #include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace s1see {
 namespace sinks {
 
-JSONLSink::JSONLSink(const std::string& file_path)
-    : file_path_(file_path), opened_(false) {
-    file_.open(file_path_, std::ios::app);
-    if (!file_.is_open()) {
+JSONLSink::JSONLSink(const std::string& file_path, size_t buffer_bytes,
+                     decode::DecodeLevel decode_level)
+    : file_path_(file_path), fd_(-1), buffer_bytes_(buffer_bytes), decode_level_(decode_level) {
+    fd_ = ::open(file_path_.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd_ < 0) {
         std::cerr << "Failed to open JSONL file: " << file_path_ << std::endl;
-    } else {
-        opened_ = true;
     }
+    buffer_.reserve(buffer_bytes_ + 4096);
 }
 
 JSONLSink::~JSONLSink() {
@@ -32,38 +35,62 @@ JSONLSink::~JSONLSink() {
 }
 
 bool JSONLSink::emit(const Event& event) {
-    if (!opened_ || !file_.is_open()) {
+    if (fd_ < 0) {
         return false;
     }
     
-    std::string json;
-    google::protobuf::util::JsonPrintOptions options;
-    options.preserve_proto_field_names = true;
-    
-    auto status = google::protobuf::util::MessageToJsonString(event, &json, options);
-    if (!status.ok()) {
-        std::cerr << "Failed to serialize event to JSON: " << status.message() << std::endl;
+    append_event_json(event, buffer_);
+    buffer_.push_back('\n');
+    return buffer_.size() < buffer_bytes_ || write_buffer();
+}
+
+bool JSONLSink::emit_batch(const std::vector<Event>& events) {
+    if (fd_ < 0) {
         return false;
     }
     
-    file_ << json << "\n";
+    bool ok = true;
+    for (const auto& event : events) {
+        append_event_json(event, buffer_);
+        buffer_.push_back('\n');
+        if (buffer_.size() >= buffer_bytes_ && !write_buffer()) {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool JSONLSink::write_buffer() {
+    const char* data = buffer_.data();
+    size_t remaining = buffer_.size();
+    while (remaining > 0) {
+        ssize_t n = ::write(fd_, data, remaining);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Failed to write JSONL file: " << file_path_ << std::endl;
+            buffer_.clear();
+            return false;
+        }
+        data += n;
+        remaining -= static_cast<size_t>(n);
+    }
+    buffer_.clear();
     return true;
 }
 
 void JSONLSink::flush() {
-    if (file_.is_open()) {
-        file_.flush();
+    if (fd_ >= 0 && !buffer_.empty()) {
+        write_buffer();
     }
 }
 
 void JSONLSink::close() {
-    if (file_.is_open()) {
-        file_.close();
-        opened_ = false;
+    if (fd_ >= 0) {
+        flush();
+        ::close(fd_);
+        fd_ = -1;
     }
 }
 
 } // namespace sinks
 } // namespace s1see
-
-
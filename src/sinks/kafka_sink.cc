@@ -0,0 +1,237 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: kafka_sink.cc
+ * Description: Implementation of KafkaSink on librdkafka's producer. Each
+ *              event is produced with its sequence number as the message
+ *              opaque; a poll thread serves delivery reports and advances
+ *              the delivered prefix.
+ */
+
+#include "s1see/sinks/kafka_sink.h"
+#include "s1see/sinks/event_json.h"
+#include "event.pb.h"
+#include <algorithm>
+#include <iostream>
+#ifdef HAVE_RDKAFKA
+#include <librdkafka/rdkafka.h>
+#endif
+
+namespace s1see {
+namespace sinks {
+
+KafkaSink::KafkaSink(const Config& config)
+    : config_(config) {
+}
+
+KafkaSink::~KafkaSink() {
+    close();
+}
+
+std::string KafkaSink::encode(const Event& event, Format format) {
+    if (format == Format::PROTOBUF) {
+        return event.SerializeAsString();
+    }
+    return event_to_json(event);
+}
+
+bool KafkaSink::emit(const Event& event) {
+    return emit_batch(std::vector<Event>{event});
+}
+
+uint64_t KafkaSink::delivered_sequence() const {
+    std::lock_guard<std::mutex> lock(delivery_mutex_);
+    return window_.delivered();
+}
+
+KafkaSink::Stats KafkaSink::stats() const {
+    std::lock_guard<std::mutex> lock(delivery_mutex_);
+    return stats_;
+}
+
+void KafkaSink::on_delivery(uint64_t sequence, bool success, const char* error) {
+    std::lock_guard<std::mutex> lock(delivery_mutex_);
+    if (success) {
+        window_.complete(sequence);
+        ++stats_.delivered;
+        return;
+    }
+    if (stats_.failed++ == 0) {
+        // Later failures follow from the first; one line is enough
+        std::cerr << "KafkaSink: delivery to " << config_.topic << " failed: " << error
+                  << " (commits held back from event " << sequence << ")" << std::endl;
+    }
+}
+
+#ifdef HAVE_RDKAFKA
+
+namespace {
+
+void delivery_report(rd_kafka_t*, const rd_kafka_message_t* message, void* opaque) {
+    auto* sink = static_cast<KafkaSink*>(opaque);
+    auto sequence = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(message->_private));
+    sink->on_delivery(sequence, message->err == RD_KAFKA_RESP_ERR_NO_ERROR,
+                      rd_kafka_err2str(message->err));
+}
+
+} // namespace
+
+bool KafkaSink::start() {
+    if (running_.exchange(true)) {
+        return false; // Already running
+    }
+
+    char errstr[512];
+    rd_kafka_conf_t* conf = rd_kafka_conf_new();
+    std::map<std::string, std::string> settings = {
+        {"bootstrap.servers", config_.brokers},
+        {"linger.ms", std::to_string(config_.linger.count())},
+        {"batch.num.messages", std::to_string(std::max<size_t>(config_.batch_size, 1))},
+        {"compression.codec", config_.compression},
+        {"acks", config_.acks},
+        // Keeps each partition in order across retries
+        {"enable.idempotence", "true"},
+        // Same key hashing as the Java client, so other producers agree
+        {"partitioner", "murmur2_random"},
+    };
+    for (const auto& [key, value] : config_.properties) {
+        settings[key] = value;
+    }
+    for (const auto& [key, value] : settings) {
+        if (rd_kafka_conf_set(conf, key.c_str(), value.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) {
+            std::cerr << "KafkaSink: " << key << ": " << errstr << std::endl;
+            rd_kafka_conf_destroy(conf);
+            running_ = false;
+            return false;
+        }
+    }
+    rd_kafka_conf_set_dr_msg_cb(conf, delivery_report);
+    rd_kafka_conf_set_opaque(conf, this);
+
+    rd_kafka_t* rk = rd_kafka_new(RD_KAFKA_PRODUCER, conf, errstr, sizeof(errstr));
+    if (!rk) {
+        std::cerr << "KafkaSink: failed to create producer: " << errstr << std::endl;
+        rd_kafka_conf_destroy(conf);
+        running_ = false;
+        return false;
+    }
+    rd_kafka_topic_t* topic = rd_kafka_topic_new(rk, config_.topic.c_str(), nullptr);
+    if (!topic) {
+        std::cerr << "KafkaSink: failed to open topic " << config_.topic << ": "
+                  << rd_kafka_err2str(rd_kafka_last_error()) << std::endl;
+        rd_kafka_destroy(rk);
+        running_ = false;
+        return false;
+    }
+
+    producer_ = rk;
+    topic_ = topic;
+    poll_thread_ = std::thread(&KafkaSink::poll_loop, this);
+    return true;
+}
+
+void KafkaSink::poll_loop() {
+    auto* rk = static_cast<rd_kafka_t*>(producer_);
+    while (running_) {
+        rd_kafka_poll(rk, 100);
+    }
+}
+
+bool KafkaSink::emit_batch(const std::vector<Event>& events) {
+    if (!running_) {
+        return false;
+    }
+    auto* rk = static_cast<rd_kafka_t*>(producer_);
+    auto* topic = static_cast<rd_kafka_topic_t*>(topic_);
+
+    bool all_ok = true;
+    std::string value;
+    for (const auto& event : events) {
+        value = encode(event, config_.format);
+        const std::string& key = event.subscriber_key();
+
+        // Numbered only once the producer takes it, so sequence numbers
+        // stay contiguous
+        uint64_t sequence = accepted_.load() + 1;
+        while (true) {
+            int result = rd_kafka_produce(topic, RD_KAFKA_PARTITION_UA, RD_KAFKA_MSG_F_COPY,
+                                          value.data(), value.size(),
+                                          key.empty() ? nullptr : key.data(), key.size(),
+                                          reinterpret_cast<void*>(static_cast<uintptr_t>(sequence)));
+            if (result == 0) {
+                accepted_.store(sequence);
+                std::lock_guard<std::mutex> lock(delivery_mutex_);
+                ++stats_.produced;
+                break;
+            }
+            rd_kafka_resp_err_t err = rd_kafka_last_error();
+            if (err == RD_KAFKA_RESP_ERR__QUEUE_FULL && running_) {
+                // Queue full: wait for deliveries to make room
+                rd_kafka_poll(rk, 100);
+                continue;
+            }
+            std::cerr << "KafkaSink: produce to " << config_.topic << " failed: "
+                      << rd_kafka_err2str(err) << std::endl;
+            std::lock_guard<std::mutex> lock(delivery_mutex_);
+            ++stats_.failed;
+            all_ok = false;
+            break;
+        }
+    }
+    return all_ok;
+}
+
+void KafkaSink::flush() {
+    if (!running_) {
+        return;
+    }
+    rd_kafka_resp_err_t err = rd_kafka_flush(static_cast<rd_kafka_t*>(producer_),
+                                             static_cast<int>(config_.flush_timeout.count()));
+    if (err) {
+        std::cerr << "KafkaSink: " << rd_kafka_outq_len(static_cast<rd_kafka_t*>(producer_))
+                  << " events still in flight after flush" << std::endl;
+    }
+}
+
+void KafkaSink::close() {
+    if (!running_) {
+        return;
+    }
+    flush();
+    running_ = false;
+    if (poll_thread_.joinable()) {
+        poll_thread_.join();
+    }
+    rd_kafka_topic_destroy(static_cast<rd_kafka_topic_t*>(topic_));
+    rd_kafka_destroy(static_cast<rd_kafka_t*>(producer_));
+    topic_ = nullptr;
+    producer_ = nullptr;
+}
+
+#else // !HAVE_RDKAFKA
+
+bool KafkaSink::start() {
+    std::cerr << "KafkaSink: built without librdkafka (install librdkafka-dev and reconfigure)" << std::endl;
+    return false;
+}
+
+void KafkaSink::poll_loop() {
+}
+
+bool KafkaSink::emit_batch(const std::vector<Event>&) {
+    return false;
+}
+
+void KafkaSink::flush() {
+}
+
+void KafkaSink::close() {
+    running_ = false;
+}
+
+#endif // HAVE_RDKAFKA
+
+} // namespace sinks
+} // namespace s1see
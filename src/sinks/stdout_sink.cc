@@ -10,25 +10,15 @@
  */
 
 #include "s1see/sinks/stdout_sink.h"
+#include "s1see/sinks/event_json.h"
 #include "event.pb.h"
-#include <google/protobuf/util/json_util.h>
 #include <iostream>
 
 namespace s1see {
 namespace sinks {
 
 bool StdoutSink::emit(const Event& event) {
-    std::string json;
-    google::protobuf::util::JsonPrintOptions options;
-    options.preserve_proto_field_names = true;
-    
-    auto status = google::protobuf::util::MessageToJsonString(event, &json, options);
-    if (!status.ok()) {
-        std::cerr << "Failed to serialize event to JSON: " << status.message() << std::endl;
-        return false;
-    }
-    
-    std::cout << json << std::endl;
+    std::cout << event_to_json(event) << std::endl;
     return true;
 }
 
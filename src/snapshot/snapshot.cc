@@ -0,0 +1,200 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: snapshot.cc
+ * Description: Implementation of the snapshot file writer and mapped reader.
+ *              Files are written to a temporary name, synced and renamed so a
+ *              crash never leaves a partial snapshot in place.
+ */
+
+#include "s1see/snapshot/snapshot.h"
+#include "s1see/utils/expiry_queue.h"
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace s1see {
+namespace snapshot {
+
+namespace {
+    constexpr size_t ALIGNMENT = 8;
+
+    size_t align_up(size_t n) {
+        return (n + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    uint64_t fnv1a(const char* data, size_t size, uint64_t hash = 0xcbf29ce484222325ULL) {
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<uint8_t>(data[i]);
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    void write_all(int fd, const char* data, size_t size, const std::string& path) {
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error("Failed to write snapshot: " + path);
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+    }
+} // anonymous namespace
+
+BlobRef SnapshotWriter::add_blob(std::string_view bytes) {
+    return add_blob(bytes.data(), bytes.size());
+}
+
+BlobRef SnapshotWriter::add_blob(const void* data, size_t size) {
+    if (blob_.size() + size > UINT32_MAX) {
+        throw std::runtime_error("Snapshot blob exceeds 4 GiB");
+    }
+    BlobRef ref{static_cast<uint32_t>(blob_.size()), static_cast<uint32_t>(size)};
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    blob_.insert(blob_.end(), bytes, bytes + size);
+    return ref;
+}
+
+void SnapshotWriter::write(const std::string& path) const {
+    // Lay out the file in memory: header, section table, sections, blob
+    std::vector<SectionHeader> table;
+    size_t offset = align_up(sizeof(FileHeader) + sections_.size() * sizeof(SectionHeader));
+    for (const auto& [key, section] : sections_) {
+        SectionHeader header{};
+        header.kind = key.first;
+        header.shard = key.second;
+        header.record_size = section.record_size;
+        header.offset = offset;
+        header.count = section.count;
+        table.push_back(header);
+        offset = align_up(offset + section.data.size());
+    }
+
+    std::vector<char> file(offset + blob_.size(), 0);
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.section_count = static_cast<uint32_t>(table.size());
+    header.shard_count = shard_count_;
+    header.created_ns = utils::wall_clock_ns();
+    header.watermark_ns = watermark_ns_;
+    header.blob_offset = offset;
+    header.blob_bytes = blob_.size();
+
+    std::memcpy(file.data() + sizeof(FileHeader), table.data(), table.size() * sizeof(SectionHeader));
+    size_t i = 0;
+    for (const auto& [key, section] : sections_) {
+        std::memcpy(file.data() + table[i++].offset, section.data.data(), section.data.size());
+    }
+    std::memcpy(file.data() + offset, blob_.data(), blob_.size());
+    header.checksum = fnv1a(file.data() + sizeof(FileHeader), file.size() - sizeof(FileHeader));
+    std::memcpy(file.data(), &header, sizeof(header));
+
+    fs::path target(path);
+    if (target.has_parent_path()) {
+        fs::create_directories(target.parent_path());
+    }
+    std::string tmp_path = path + ".tmp";
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create snapshot: " + tmp_path);
+    }
+    try {
+        write_all(fd, file.data(), file.size(), tmp_path);
+        if (::fsync(fd) != 0) {
+            throw std::runtime_error("Failed to sync snapshot: " + tmp_path);
+        }
+    } catch (...) {
+        ::close(fd);
+        ::unlink(tmp_path.c_str());
+        throw;
+    }
+    ::close(fd);
+
+    if (::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        ::unlink(tmp_path.c_str());
+        throw std::runtime_error("Failed to rename snapshot into place: " + path);
+    }
+}
+
+SnapshotReader::SnapshotReader(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open snapshot: " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Snapshot truncated: " + path);
+    }
+    void* addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // Mapping stays valid after the descriptor is closed
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("Failed to map snapshot: " + path);
+    }
+    data_ = static_cast<const char*>(addr);
+    size_ = static_cast<size_t>(st.st_size);
+    header_ = reinterpret_cast<const FileHeader*>(data_);
+    sections_ = reinterpret_cast<const SectionHeader*>(data_ + sizeof(FileHeader));
+
+    auto fail = [&](const std::string& reason) {
+        ::munmap(const_cast<char*>(data_), size_);
+        throw std::runtime_error("Invalid snapshot " + path + ": " + reason);
+    };
+    if (std::memcmp(header_->magic, kMagic, sizeof(kMagic)) != 0) {
+        fail("bad magic");
+    }
+    if (header_->version != kVersion) {
+        fail("unsupported version " + std::to_string(header_->version));
+    }
+    size_t table_end = sizeof(FileHeader) + static_cast<size_t>(header_->section_count) * sizeof(SectionHeader);
+    if (table_end > size_ || header_->blob_offset + header_->blob_bytes != size_) {
+        fail("truncated");
+    }
+    for (uint32_t i = 0; i < header_->section_count; ++i) {
+        const SectionHeader& section = sections_[i];
+        if (section.offset % ALIGNMENT != 0 ||
+            section.offset + section.count * section.record_size > header_->blob_offset) {
+            fail("section out of bounds");
+        }
+    }
+    if (fnv1a(data_ + sizeof(FileHeader), size_ - sizeof(FileHeader)) != header_->checksum) {
+        fail("checksum mismatch");
+    }
+}
+
+SnapshotReader::~SnapshotReader() {
+    if (data_) ::munmap(const_cast<char*>(data_), size_);
+}
+
+const SectionHeader* SnapshotReader::find(SectionKind kind, uint32_t shard) const {
+    for (uint32_t i = 0; i < header_->section_count; ++i) {
+        if (sections_[i].kind == kind && sections_[i].shard == shard) {
+            return &sections_[i];
+        }
+    }
+    return nullptr;
+}
+
+std::string_view SnapshotReader::blob(BlobRef ref) const {
+    if (static_cast<uint64_t>(ref.offset) + ref.length > header_->blob_bytes) {
+        throw std::runtime_error("Snapshot blob reference out of bounds");
+    }
+    return std::string_view(data_ + header_->blob_offset + ref.offset, ref.length);
+}
+
+} // namespace snapshot
+} // namespace s1see
@@ -0,0 +1,440 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: compressed_segment.cc
+ * Description: Implementation of CompressedSegment: splits a sealed segment
+ *              into record-aligned blocks, builds a dictionary from sampled
+ *              records, and compresses each block with zlib or zstd.
+ */
+
+#include "s1see/spool/compressed_segment.h"
+#include "s1see/spool/record_frame.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#include <zdict.h>
+#endif
+
+namespace s1see {
+namespace spool {
+
+namespace {
+    constexpr char MAGIC[4] = {'S', '1', 'S', 'Z'};
+    constexpr uint16_t VERSION = 1;
+    constexpr size_t HEADER_SIZE = 32;
+    constexpr size_t BLOCK_ENTRY_SIZE = 24;
+    constexpr size_t ZLIB_MAX_DICTIONARY = 32 * 1024;  // Deflate's window
+    constexpr size_t ZSTD_SAMPLES_PER_DICTIONARY_BYTE = 100;
+
+    template <typename T>
+    void put(std::string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename T>
+    T get(const char* at) {
+        T value;
+        std::memcpy(&value, at, sizeof(value));
+        return value;
+    }
+
+    // Read-only mapping of a whole file, unmapped on destruction
+    struct MappedFile {
+        const char* data = nullptr;
+        size_t size = 0;
+        bool ok = false;  // Mapped, or empty
+
+        explicit MappedFile(const std::string& path) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return;
+            struct stat st;
+            if (::fstat(fd, &st) == 0) {
+                ok = st.st_size == 0;
+                if (st.st_size > 0) {
+                    void* addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (addr != MAP_FAILED) {
+                        data = static_cast<const char*>(addr);
+                        size = static_cast<size_t>(st.st_size);
+                        ok = true;
+                    }
+                }
+            }
+            ::close(fd);
+        }
+        ~MappedFile() {
+            if (data) ::munmap(const_cast<char*>(data), size);
+        }
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+    };
+
+    // Offsets of each complete record frame, plus the end of the last. The
+    // CRCs go into the blocks as they are and are checked when read.
+    std::vector<size_t> record_boundaries(const char* data, size_t size) {
+        std::vector<size_t> boundaries{0};
+        size_t pos = 0;
+        RecordFrame frame;
+        while (parse_record_frame(data + pos, size - pos, frame, false) == FrameStatus::OK) {
+            pos += frame.size;
+            boundaries.push_back(pos);
+        }
+        return boundaries;
+    }
+
+    // Records spread evenly over the segment, about budget bytes in all
+    std::vector<std::pair<size_t, size_t>> sample_records(const std::vector<size_t>& boundaries, size_t budget) {
+        std::vector<std::pair<size_t, size_t>> samples;
+        size_t records = boundaries.size() - 1;
+        if (records == 0 || budget == 0) return samples;
+        size_t average = std::max<size_t>(boundaries.back() / records, 1);
+        size_t wanted = std::max<size_t>(budget / average, 1);
+        size_t stride = std::max<size_t>(records / wanted, 1);
+        size_t taken = 0;
+        for (size_t i = 0; i < records && taken < budget; i += stride) {
+            size_t length = boundaries[i + 1] - boundaries[i];
+            samples.emplace_back(boundaries[i], length);
+            taken += length;
+        }
+        return samples;
+    }
+
+    std::string build_dictionary(const char* data, const std::vector<size_t>& boundaries,
+                                 const CompressedSegment::Options& options) {
+        if (options.dictionary_size == 0) return {};
+        bool zstd = options.codec == SegmentCompression::ZSTD;
+        size_t dictionary_size = zstd ? options.dictionary_size
+                                      : std::min(options.dictionary_size, ZLIB_MAX_DICTIONARY);
+        size_t budget = zstd ? dictionary_size * ZSTD_SAMPLES_PER_DICTIONARY_BYTE : dictionary_size;
+
+        std::string samples;
+        std::vector<size_t> sample_sizes;
+        for (const auto& [start, length] : sample_records(boundaries, budget)) {
+            samples.append(data + start, length);
+            sample_sizes.push_back(length);
+        }
+
+#ifdef HAVE_ZSTD
+        if (zstd) {
+            std::string dictionary(dictionary_size, '\0');
+            size_t trained = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(), samples.data(),
+                                                   sample_sizes.data(), static_cast<unsigned>(sample_sizes.size()));
+            if (!ZDICT_isError(trained)) {
+                dictionary.resize(trained);
+                return dictionary;
+            }
+            // Too few samples to train on: fall through to a raw-content dictionary
+        }
+#endif
+
+        // Deflate matches best against the end of its dictionary
+        if (samples.size() > dictionary_size) {
+            samples.erase(0, samples.size() - dictionary_size);
+        }
+        return samples;
+    }
+
+    bool write_fully(int fd, const char* data, size_t len) {
+        while (len > 0) {
+            ssize_t n = ::write(fd, data, len);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            len -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // Compresses blocks one after another against a fixed dictionary
+    class BlockCompressor {
+    public:
+        BlockCompressor(const CompressedSegment::Options& options, const std::string& dictionary)
+            : codec_(options.codec), dictionary_(dictionary) {
+            if (codec_ == SegmentCompression::ZLIB) {
+                int level = options.level != 0 ? options.level : Z_DEFAULT_COMPRESSION;
+                if (deflateInit(&zlib_, level) != Z_OK) {
+                    throw std::runtime_error("Failed to initialise deflate");
+                }
+                zlib_ready_ = true;
+            }
+#ifdef HAVE_ZSTD
+            if (codec_ == SegmentCompression::ZSTD) {
+                int level = options.level != 0 ? options.level : ZSTD_CLEVEL_DEFAULT;
+                zstd_context_ = ZSTD_createCCtx();
+                zstd_dictionary_ = ZSTD_createCDict(dictionary_.data(), dictionary_.size(), level);
+                if (!zstd_context_ || !zstd_dictionary_) {
+                    throw std::runtime_error("Failed to initialise zstd");
+                }
+            }
+#endif
+        }
+
+        ~BlockCompressor() {
+            if (zlib_ready_) deflateEnd(&zlib_);
+#ifdef HAVE_ZSTD
+            ZSTD_freeCDict(zstd_dictionary_);
+            ZSTD_freeCCtx(zstd_context_);
+#endif
+        }
+
+        // Append the compressed form of data to out; returns its size
+        size_t compress(const char* data, size_t size, std::string& out) {
+            size_t start = out.size();
+#ifdef HAVE_ZSTD
+            if (codec_ == SegmentCompression::ZSTD) {
+                out.resize(start + ZSTD_compressBound(size));
+                size_t n = ZSTD_compress_usingCDict(zstd_context_, &out[start], out.size() - start,
+                                                    data, size, zstd_dictionary_);
+                if (ZSTD_isError(n)) {
+                    throw std::runtime_error(std::string("zstd compression failed: ") + ZSTD_getErrorName(n));
+                }
+                out.resize(start + n);
+                return n;
+            }
+#endif
+            // Each block is a complete zlib stream of its own
+            deflateReset(&zlib_);
+            if (!dictionary_.empty()) {
+                deflateSetDictionary(&zlib_, reinterpret_cast<const Bytef*>(dictionary_.data()),
+                                     static_cast<uInt>(dictionary_.size()));
+            }
+            out.resize(start + deflateBound(&zlib_, static_cast<uLong>(size)));
+            zlib_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+            zlib_.avail_in = static_cast<uInt>(size);
+            zlib_.next_out = reinterpret_cast<Bytef*>(&out[start]);
+            zlib_.avail_out = static_cast<uInt>(out.size() - start);
+            if (deflate(&zlib_, Z_FINISH) != Z_STREAM_END) {
+                throw std::runtime_error("Deflate failed");
+            }
+            size_t n = out.size() - start - zlib_.avail_out;
+            out.resize(start + n);
+            return n;
+        }
+
+    private:
+        SegmentCompression codec_;
+        const std::string& dictionary_;
+        z_stream zlib_{};
+        bool zlib_ready_ = false;
+#ifdef HAVE_ZSTD
+        ZSTD_CCtx* zstd_context_ = nullptr;
+        ZSTD_CDict* zstd_dictionary_ = nullptr;
+#endif
+    };
+}
+
+bool CompressedSegment::available(SegmentCompression codec) {
+    switch (codec) {
+        case SegmentCompression::NONE:
+        case SegmentCompression::ZLIB:
+            return true;
+        case SegmentCompression::ZSTD:
+#ifdef HAVE_ZSTD
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+int64_t CompressedSegment::write(const std::string& log_path, const std::string& out_path,
+                                 const Options& options) {
+    if (options.codec == SegmentCompression::NONE || !available(options.codec)) {
+        throw std::runtime_error("Segment compression codec not available in this build");
+    }
+
+    MappedFile raw(log_path);
+    if (!raw.ok) {
+        throw std::runtime_error("Failed to map segment: " + log_path);
+    }
+    // A torn record at the tail of a sealed segment is never readable, so
+    // it is not carried over
+    std::vector<size_t> boundaries = record_boundaries(raw.data, raw.size);
+    std::string dictionary = build_dictionary(raw.data, boundaries, options);
+
+    // Header is filled in once the block index position is known
+    std::string out(HEADER_SIZE, '\0');
+    out += dictionary;
+
+    std::vector<Block> blocks;
+    BlockCompressor compressor(options, dictionary);
+    size_t block_size = std::max<size_t>(options.block_size, 1);
+    for (size_t first = 0; first + 1 < boundaries.size();) {
+        // Whole records up to block_size, and at least one
+        size_t last = first + 1;
+        while (last + 1 < boundaries.size() && boundaries[last + 1] - boundaries[first] <= block_size) {
+            ++last;
+        }
+        size_t raw_position = boundaries[first];
+        size_t raw_size = boundaries[last] - raw_position;
+        Block block;
+        block.raw_position = static_cast<int64_t>(raw_position);
+        block.file_position = static_cast<int64_t>(out.size());
+        block.raw_size = static_cast<uint32_t>(raw_size);
+        block.compressed_size = static_cast<uint32_t>(compressor.compress(raw.data + raw_position, raw_size, out));
+        blocks.push_back(block);
+        first = last;
+    }
+
+    int64_t index_position = static_cast<int64_t>(out.size());
+    for (const auto& block : blocks) {
+        put<int64_t>(out, block.raw_position);
+        put<int64_t>(out, block.file_position);
+        put<uint32_t>(out, block.raw_size);
+        put<uint32_t>(out, block.compressed_size);
+    }
+
+    std::string header(MAGIC, sizeof(MAGIC));
+    put<uint16_t>(header, VERSION);
+    put<uint16_t>(header, static_cast<uint16_t>(options.codec));
+    put<uint32_t>(header, static_cast<uint32_t>(dictionary.size()));
+    put<uint32_t>(header, static_cast<uint32_t>(blocks.size()));
+    put<int64_t>(header, static_cast<int64_t>(boundaries.back()));
+    put<int64_t>(header, index_position);
+    out.replace(0, HEADER_SIZE, header);
+
+    // Synced before the caller renames it into place
+    int fd = ::open(out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create compressed segment: " + out_path);
+    }
+    bool ok = write_fully(fd, out.data(), out.size()) && ::fsync(fd) == 0;
+    ::close(fd);
+    if (!ok) {
+        throw std::runtime_error("Failed to write compressed segment " + out_path + ": " + std::strerror(errno));
+    }
+    return static_cast<int64_t>(out.size());
+}
+
+CompressedSegment::~CompressedSegment() {
+#ifdef HAVE_ZSTD
+    ZSTD_freeDDict(static_cast<ZSTD_DDict*>(zstd_dictionary_));
+#endif
+    if (data_) ::munmap(const_cast<char*>(data_), size_);
+}
+
+bool CompressedSegment::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(HEADER_SIZE)) {
+        ::close(fd);
+        return false;
+    }
+    void* addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) return false;
+    data_ = static_cast<const char*>(addr);
+    size_ = static_cast<size_t>(st.st_size);
+
+    if (std::memcmp(data_, MAGIC, sizeof(MAGIC)) != 0 || get<uint16_t>(data_ + 4) != VERSION) {
+        return false;
+    }
+    codec_ = static_cast<SegmentCompression>(get<uint16_t>(data_ + 6));
+    if (codec_ == SegmentCompression::NONE || !available(codec_)) {
+        return false;
+    }
+    dictionary_size_ = get<uint32_t>(data_ + 8);
+    uint32_t block_count = get<uint32_t>(data_ + 12);
+    raw_size_ = get<int64_t>(data_ + 16);
+    int64_t index_position = get<int64_t>(data_ + 24);
+    if (HEADER_SIZE + dictionary_size_ > size_ || index_position < 0 ||
+        static_cast<size_t>(index_position) + static_cast<size_t>(block_count) * BLOCK_ENTRY_SIZE > size_) {
+        return false;
+    }
+    dictionary_ = data_ + HEADER_SIZE;
+
+    blocks_.resize(block_count);
+    const char* entry = data_ + index_position;
+    for (auto& block : blocks_) {
+        block.raw_position = get<int64_t>(entry);
+        block.file_position = get<int64_t>(entry + 8);
+        block.raw_size = get<uint32_t>(entry + 16);
+        block.compressed_size = get<uint32_t>(entry + 20);
+        entry += BLOCK_ENTRY_SIZE;
+        if (block.file_position < 0 ||
+            static_cast<size_t>(block.file_position) + block.compressed_size > static_cast<size_t>(index_position)) {
+            return false;
+        }
+    }
+
+#ifdef HAVE_ZSTD
+    if (codec_ == SegmentCompression::ZSTD && dictionary_size_ > 0) {
+        zstd_dictionary_ = ZSTD_createDDict(dictionary_, dictionary_size_);
+        if (!zstd_dictionary_) return false;
+    }
+#endif
+    return true;
+}
+
+int64_t CompressedSegment::find_block(int64_t raw_position) const {
+    if (raw_position < 0 || raw_position >= raw_size_) return -1;
+    auto it = std::upper_bound(blocks_.begin(), blocks_.end(), raw_position,
+                               [](int64_t position, const Block& block) { return position < block.raw_position; });
+    if (it == blocks_.begin()) return -1;
+    return static_cast<int64_t>(it - blocks_.begin()) - 1;
+}
+
+void CompressedSegment::read_ahead(int64_t raw_position, int64_t raw_bytes) const {
+    int64_t first = find_block(raw_position);
+    if (first < 0 || raw_bytes <= 0) return;
+    int64_t last = find_block(std::min(raw_position + raw_bytes, raw_size_) - 1);
+    const Block& end = blocks_[static_cast<size_t>(last)];
+    size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t begin = static_cast<size_t>(blocks_[static_cast<size_t>(first)].file_position) / page * page;
+    size_t finish = static_cast<size_t>(end.file_position) + end.compressed_size;
+    ::madvise(const_cast<char*>(data_) + begin, finish - begin, MADV_WILLNEED);
+}
+
+bool CompressedSegment::decompress(size_t index, std::string& out) const {
+    if (index >= blocks_.size()) return false;
+    const Block& block = blocks_[index];
+    const char* input = data_ + block.file_position;
+    out.resize(block.raw_size);
+
+#ifdef HAVE_ZSTD
+    if (codec_ == SegmentCompression::ZSTD) {
+        ZSTD_DCtx* context = ZSTD_createDCtx();
+        if (!context) return false;
+        size_t n = zstd_dictionary_
+            ? ZSTD_decompress_usingDDict(context, out.data(), out.size(), input, block.compressed_size,
+                                         static_cast<const ZSTD_DDict*>(zstd_dictionary_))
+            : ZSTD_decompressDCtx(context, out.data(), out.size(), input, block.compressed_size);
+        ZSTD_freeDCtx(context);
+        return !ZSTD_isError(n) && n == block.raw_size;
+    }
+#endif
+
+    z_stream zs{};
+    if (inflateInit(&zs) != Z_OK) return false;
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input));
+    zs.avail_in = block.compressed_size;
+    zs.next_out = reinterpret_cast<Bytef*>(out.data());
+    zs.avail_out = block.raw_size;
+    int rc = inflate(&zs, Z_FINISH);
+    if (rc == Z_NEED_DICT) {
+        rc = inflateSetDictionary(&zs, reinterpret_cast<const Bytef*>(dictionary_),
+                                  static_cast<uInt>(dictionary_size_));
+        if (rc == Z_OK) {
+            rc = inflate(&zs, Z_FINISH);
+        }
+    }
+    bool ok = rc == Z_STREAM_END && zs.avail_out == 0;
+    inflateEnd(&zs);
+    return ok;
+}
+
+} // namespace spool
+} // namespace s1see
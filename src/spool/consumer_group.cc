@@ -0,0 +1,213 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: consumer_group.cc
+ * Description: Implementation of ConsumerGroup: member and partition lease
+ *              files in the spool directory, and the heartbeat that renews
+ *              them and hands partitions over between members.
+ */
+
+#include "s1see/spool/consumer_group.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace s1see {
+namespace spool {
+
+namespace {
+    int64_t wall_clock_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    // Every reader and writer holds the group lock, so files are simply
+    // overwritten; one cut short by a crash reads as expired. Overwriting
+    // rather than truncating first keeps ext4 from flushing the file on
+    // close (auto_da_alloc), which costs a heartbeat hundreds of ms.
+    void write_file(const std::string& path, const std::string& contents) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open " + path + ": " + std::strerror(errno));
+        }
+        bool ok = ::pwrite(fd, contents.data(), contents.size(), 0) == static_cast<ssize_t>(contents.size()) &&
+                  ::ftruncate(fd, static_cast<off_t>(contents.size())) == 0;
+        int error = errno;
+        ::close(fd);
+        if (!ok) {
+            throw std::runtime_error("Failed to write " + path + ": " + std::strerror(error));
+        }
+    }
+
+    // Exclusive flock held for the scope of a heartbeat
+    class GroupLock {
+    public:
+        explicit GroupLock(int fd) : fd_(fd) {
+            while (::flock(fd_, LOCK_EX) != 0) {
+                if (errno != EINTR) {
+                    throw std::runtime_error(std::string("Failed to lock consumer group: ") + std::strerror(errno));
+                }
+            }
+        }
+        ~GroupLock() { ::flock(fd_, LOCK_UN); }
+    private:
+        int fd_;
+    };
+}
+
+ConsumerGroup::ConsumerGroup(const Config& config) : config_(config) {
+    if (config_.member_id.empty()) {
+        char host[256] = {};
+        if (::gethostname(host, sizeof(host) - 1) != 0) {
+            std::strcpy(host, "localhost");
+        }
+        config_.member_id = std::string(host) + "-" + std::to_string(::getpid());
+    }
+    // Ids name files and are written space-separated in leases
+    for (char& c : config_.member_id) {
+        if (c == '/' || c == ' ' || c == '\n' || c == '\t') {
+            c = '_';
+        }
+    }
+    config_.num_partitions = std::max<int32_t>(config_.num_partitions, 0);
+    group_dir_ = (fs::path(config_.base_dir) / "groups" / config_.group).string();
+}
+
+ConsumerGroup::~ConsumerGroup() {
+    try {
+        leave();
+    } catch (const std::exception&) {
+        // The leases expire on their own
+    }
+    if (lock_fd_ >= 0) {
+        ::close(lock_fd_);
+    }
+}
+
+std::string ConsumerGroup::member_path(const std::string& member) const {
+    return (fs::path(group_dir_) / "members" / (member + ".member")).string();
+}
+
+std::string ConsumerGroup::lease_path(int32_t partition) const {
+    return (fs::path(group_dir_) / ("partition_" + std::to_string(partition) + ".lease")).string();
+}
+
+int64_t ConsumerGroup::expiry_ns() const {
+    return wall_clock_ns() + std::chrono::duration_cast<std::chrono::nanoseconds>(config_.lease_duration).count();
+}
+
+bool ConsumerGroup::owns(int32_t partition) const {
+    return std::binary_search(owned_.begin(), owned_.end(), partition);
+}
+
+std::vector<std::string> ConsumerGroup::live_members(int64_t now_ns) {
+    // Members that stopped heartbeating are removed by whoever notices
+    std::vector<std::string> members;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(fs::path(group_dir_) / "members", ec)) {
+        if (entry.path().extension() != ".member") {
+            continue;
+        }
+        int64_t expiry = 0;
+        std::ifstream file(entry.path());
+        if (!(file >> expiry) || expiry < now_ns) {
+            fs::remove(entry.path(), ec);
+            continue;
+        }
+        members.push_back(entry.path().stem().string());
+    }
+    std::sort(members.begin(), members.end());
+    return members;
+}
+
+std::string ConsumerGroup::lease_owner(int32_t partition, int64_t now_ns) const {
+    std::ifstream file(lease_path(partition));
+    std::string owner;
+    int64_t expiry = 0;
+    if (!(file >> owner >> expiry) || expiry < now_ns) {
+        return "";
+    }
+    return owner;
+}
+
+ConsumerGroup::Assignment ConsumerGroup::heartbeat(const std::function<bool(int32_t)>& can_release) {
+    if (lock_fd_ < 0) {
+        fs::create_directories(fs::path(group_dir_) / "members");
+        std::string lock_path = (fs::path(group_dir_) / "lock").string();
+        lock_fd_ = ::open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (lock_fd_ < 0) {
+            throw std::runtime_error("Failed to open " + lock_path + ": " + std::strerror(errno));
+        }
+    }
+    GroupLock lock(lock_fd_);
+
+    int64_t now = wall_clock_ns();
+    std::string expiry = std::to_string(expiry_ns());
+    write_file(member_path(config_.member_id), expiry + "\n");
+    joined_ = true;
+    members_ = live_members(now);
+
+    Assignment result;
+    std::vector<int32_t> owned;
+    std::string lease = config_.member_id + " " + expiry + "\n";
+    for (int32_t p = 0; p < config_.num_partitions; ++p) {
+        bool target = members_[static_cast<size_t>(p) % members_.size()] == config_.member_id;
+        std::string owner = lease_owner(p, now);
+        bool mine = owner == config_.member_id;
+
+        if (owns(p)) {
+            if (!owner.empty() && !mine) {
+                // Our lease ran out and another member has the partition
+                result.lost.push_back(p);
+            } else if (!target && can_release(p)) {
+                std::error_code ec;
+                fs::remove(lease_path(p), ec);
+                result.lost.push_back(p);
+            } else {
+                write_file(lease_path(p), lease);
+                owned.push_back(p);
+            }
+        } else if (target && (owner.empty() || mine)) {
+            write_file(lease_path(p), lease);
+            result.gained.push_back(p);
+            owned.push_back(p);
+        } else if (mine) {
+            // Left behind by an earlier run under the same id
+            std::error_code ec;
+            fs::remove(lease_path(p), ec);
+        }
+    }
+    owned_ = std::move(owned);
+    return result;
+}
+
+void ConsumerGroup::leave() {
+    if (!joined_) {
+        return;
+    }
+    GroupLock lock(lock_fd_);
+    int64_t now = wall_clock_ns();
+    std::error_code ec;
+    for (int32_t p : owned_) {
+        if (lease_owner(p, now) == config_.member_id) {
+            fs::remove(lease_path(p), ec);
+        }
+    }
+    fs::remove(member_path(config_.member_id), ec);
+    owned_.clear();
+    members_.clear();
+    joined_ = false;
+}
+
+} // namespace spool
+} // namespace s1see
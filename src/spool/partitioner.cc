@@ -0,0 +1,166 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: partitioner.cc
+ * Description: Implementation of the spool partitioners and the S1AP
+ *              pre-parse that finds a PDU's eNB-UE-S1AP-ID.
+ */
+
+#include "s1see/spool/partitioner.h"
+#include <functional>
+#include <string_view>
+
+namespace s1see {
+namespace spool {
+
+namespace {
+    constexpr uint16_t ENB_UE_S1AP_ID = 8;
+    constexpr uint16_t UE_S1AP_IDS = 99;
+
+    // eNB-UE-S1AP-ID (or the UE-S1AP-IDs pair) comes first or second in
+    // every message that has it
+    constexpr uint32_t MAX_PEEKED_IES = 4;
+
+    // splitmix64 finalizer: spreads sequential keys over all bits
+    uint64_t mix(uint64_t key) {
+        key ^= key >> 30;
+        key *= 0xBF58476D1CE4E5B9ULL;
+        key ^= key >> 27;
+        key *= 0x94D049BB133111EBULL;
+        return key ^ (key >> 31);
+    }
+
+    uint64_t hash_source(const SignalMessage& message) {
+        return std::hash<std::string_view>{}(message.source_id());
+    }
+
+    // The eNB end of the record: its SCTP association, or its source
+    uint64_t enb_key(const SignalMessage& message) {
+        return message.sctp_association() != 0 ? mix(message.sctp_association()) : hash_source(message);
+    }
+
+    int32_t bucket(uint64_t key, int32_t num_partitions) {
+        return static_cast<int32_t>(mix(key) % static_cast<uint64_t>(num_partitions));
+    }
+
+    // APER length determinant of up to 16383 octets; false if fragmented
+    // or past the end
+    bool read_length(std::span<const uint8_t> pdu, size_t& offset, size_t& length) {
+        if (offset >= pdu.size()) return false;
+        uint8_t first = pdu[offset++];
+        if ((first & 0x80) == 0) {
+            length = first;
+            return true;
+        }
+        if ((first & 0xC0) != 0x80 || offset >= pdu.size()) return false;
+        length = (static_cast<size_t>(first & 0x3F) << 8) | pdu[offset++];
+        return true;
+    }
+
+    // Constrained INTEGER of at most four octets (MME-UE-S1AP-ID,
+    // eNB-UE-S1AP-ID): a 2-bit octet count less one at bit_offset of the
+    // octet at position, then the octets, aligned. Advances position past
+    // them.
+    std::optional<uint32_t> read_constrained_integer(std::span<const uint8_t> value, size_t& position,
+                                                     int bit_offset) {
+        if (position >= value.size()) return std::nullopt;
+        size_t octets = ((value[position] >> (6 - bit_offset)) & 0x03) + 1;
+        ++position;
+        if (position + octets > value.size()) return std::nullopt;
+        uint32_t result = 0;
+        for (size_t b = 0; b < octets; ++b) {
+            result = (result << 8) | value[position++];
+        }
+        return result;
+    }
+}
+
+int32_t SourceSequencePartitioner::partition(const SignalMessage& message, int32_t num_partitions) const {
+    uint64_t key = hash_source(message) ^ static_cast<uint64_t>(message.source_sequence());
+    return bucket(key, num_partitions);
+}
+
+int32_t UeAffinityPartitioner::partition(const SignalMessage& message, int32_t num_partitions) const {
+    const std::string& raw = message.raw_bytes();
+    auto enb_ue_id = peek_enb_ue_s1ap_id(std::span<const uint8_t>(
+        reinterpret_cast<const uint8_t*>(raw.data()), raw.size()));
+    uint64_t key = enb_key(message);
+    if (enb_ue_id) {
+        key ^= mix(0x100000000ULL | *enb_ue_id);
+    }
+    return bucket(key, num_partitions);
+}
+
+int32_t SctpAssociationPartitioner::partition(const SignalMessage& message, int32_t num_partitions) const {
+    return bucket(enb_key(message), num_partitions);
+}
+
+std::shared_ptr<const Partitioner> make_partitioner(Partitioning partitioning) {
+    switch (partitioning) {
+        case Partitioning::UE:
+            return std::make_shared<UeAffinityPartitioner>();
+        case Partitioning::SCTP_ASSOCIATION:
+            return std::make_shared<SctpAssociationPartitioner>();
+        case Partitioning::SOURCE_SEQUENCE:
+            break;
+    }
+    return std::make_shared<SourceSequencePartitioner>();
+}
+
+std::optional<Partitioning> parse_partitioning(const std::string& name) {
+    if (name == "source") return Partitioning::SOURCE_SEQUENCE;
+    if (name == "ue") return Partitioning::UE;
+    if (name == "sctp") return Partitioning::SCTP_ASSOCIATION;
+    return std::nullopt;
+}
+
+std::optional<uint32_t> peek_enb_ue_s1ap_id(std::span<const uint8_t> pdu) {
+    // CHOICE, procedureCode, criticality, then the open type holding the
+    // message: length, SEQUENCE preamble and a 16-bit IE count
+    size_t offset = 3;
+    size_t message_length = 0;
+    if (!read_length(pdu, offset, message_length) || offset + 3 > pdu.size()) {
+        return std::nullopt;
+    }
+    ++offset;
+    uint32_t num_ies = (static_cast<uint32_t>(pdu[offset]) << 8) | pdu[offset + 1];
+    offset += 2;
+
+    // Each IE: 16-bit id, criticality, length and value
+    for (uint32_t i = 0; i < num_ies && i < MAX_PEEKED_IES; ++i) {
+        if (offset + 3 > pdu.size()) {
+            return std::nullopt;
+        }
+        uint16_t id = static_cast<uint16_t>((pdu[offset] << 8) | pdu[offset + 1]);
+        offset += 3;
+        size_t length = 0;
+        if (!read_length(pdu, offset, length) || offset + length > pdu.size()) {
+            return std::nullopt;
+        }
+        std::span<const uint8_t> value = pdu.subspan(offset, length);
+        if (id == ENB_UE_S1AP_ID) {
+            size_t position = 0;
+            return read_constrained_integer(value, position, 0);
+        }
+        if (id == UE_S1AP_IDS) {
+            // CHOICE extension and index, then the pair's extension and
+            // iE-Extensions bits ahead of the MME-UE-S1AP-ID's length;
+            // the mME-UE-S1AP-ID alternative carries no eNB id
+            if (value.empty() || (value[0] & 0xC0) != 0) {
+                return std::nullopt;
+            }
+            size_t position = 0;
+            if (!read_constrained_integer(value, position, 4)) {
+                return std::nullopt;
+            }
+            return read_constrained_integer(value, position, 0);
+        }
+        offset += length;
+    }
+    return std::nullopt;
+}
+
+} // namespace spool
+} // namespace s1see
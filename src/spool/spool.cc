@@ -18,14 +18,76 @@ Spool::Spool(const WALLog::Config& config) {
     wal_ = std::make_unique<WALLog>(config);
 }
 
+void Spool::set_metrics(std::shared_ptr<metrics::MetricsRegistry> registry) {
+    metrics_ = std::move(registry);
+    if (!metrics_) {
+        return;
+    }
+    appended_records_ = &metrics_->counter("s1see_spool_appended_records_total",
+                                           "Records appended to the spool");
+    const std::string help = "Spool append call latency, including the sync for durable batches";
+    append_latency_ = &metrics_->histogram("s1see_spool_append_seconds", help, {{"call", "append"}});
+    append_batch_latency_ = &metrics_->histogram("s1see_spool_append_seconds", help, {{"call", "append_batch"}});
+    append_batch_durable_latency_ = &metrics_->histogram("s1see_spool_append_seconds", help,
+                                                         {{"call", "append_batch_durable"}});
+}
+
 std::pair<int32_t, int64_t> Spool::append(const SignalMessage& message) {
-    return wal_->append(message);
+    metrics::ScopedTimer timer(append_latency_);
+    auto result = wal_->append(message);
+    if (appended_records_) {
+        appended_records_->add();
+    }
+    return result;
+}
+
+std::vector<std::pair<int32_t, int64_t>> Spool::append_batch(std::span<const SignalMessage> messages) {
+    metrics::ScopedTimer timer(append_batch_latency_);
+    auto result = wal_->append_batch(messages);
+    if (appended_records_) {
+        appended_records_->add(messages.size());
+    }
+    return result;
+}
+
+int64_t Spool::append_batch_durable(int32_t partition, std::span<const SignalMessage> messages) {
+    metrics::ScopedTimer timer(append_batch_durable_latency_);
+    int64_t first = wal_->append_batch_durable(partition, messages);
+    if (appended_records_) {
+        appended_records_->add(messages.size());
+    }
+    return first;
+}
+
+int32_t Spool::num_partitions() const {
+    return wal_->num_partitions();
+}
+
+int32_t Spool::partition_for(const SignalMessage& message, int32_t preferred) const {
+    return wal_->partition_for_message(message, preferred);
+}
+
+std::future<std::pair<int32_t, int64_t>> Spool::append_durable(const SignalMessage& message) {
+    // Counted when queued; the sync is shared with other callers, so its
+    // latency is not attributed per call
+    if (appended_records_) {
+        appended_records_->add();
+    }
+    return wal_->append_durable(message);
 }
 
 std::vector<SpoolRecord> Spool::read(int32_t partition, int64_t offset, int64_t max_records) {
     return wal_->read(partition, offset, max_records);
 }
 
+SpoolCursor Spool::cursor(int32_t partition, int64_t offset, const SpoolCursor::Config& config) {
+    return SpoolCursor(*wal_, partition, offset, config);
+}
+
+int64_t Spool::seek_by_time(int32_t partition, int64_t ts_ns, TimeField field) {
+    return wal_->seek_by_time(partition, ts_ns, field);
+}
+
 void Spool::commit_offset(const std::string& group, int32_t partition, int64_t offset) {
     wal_->commit_offset(group, partition, offset);
 }
@@ -34,18 +96,34 @@ int64_t Spool::load_offset(const std::string& group, int32_t partition) {
     return wal_->load_offset(group, partition);
 }
 
-void Spool::prune_old_segments() {
-    wal_->prune_old_segments();
+int64_t Spool::reload_offset(const std::string& group, int32_t partition) {
+    return wal_->reload_offset(group, partition);
+}
+
+size_t Spool::prune_old_segments() {
+    return wal_->prune_old_segments();
 }
 
 int64_t Spool::get_high_water_mark(int32_t partition) {
     return wal_->get_high_water_mark(partition);
 }
 
+size_t Spool::segment_count(int32_t partition) {
+    return wal_->segment_count(partition);
+}
+
 void Spool::flush() {
     wal_->flush_all_segments();
 }
 
+uint32_t Spool::append_sequence() const {
+    return wal_->append_sequence();
+}
+
+bool Spool::wait_for_appends(uint32_t seen_sequence, std::chrono::milliseconds timeout) {
+    return wal_->wait_for_appends(seen_sequence, timeout);
+}
+
 } // namespace spool
 } // namespace s1see
 
@@ -0,0 +1,62 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: spool_cursor.cc
+ * Description: Implementation of SpoolCursor on WALLog::read_into, which
+ *              parses into the cursor's slots, and WALLog::read_ahead.
+ */
+
+#include "s1see/spool/spool_cursor.h"
+#include <algorithm>
+
+namespace s1see {
+namespace spool {
+
+SpoolCursor::SpoolCursor(WALLog& wal, int32_t partition, int64_t offset, const Config& config)
+    : wal_(&wal), partition_(partition), config_(config), position_(offset) {
+    config_.chunk_records = std::max<size_t>(config_.chunk_records, 1);
+}
+
+bool SpoolCursor::fill() {
+    count_ = wal_->read_into(partition_, position_, static_cast<int64_t>(config_.chunk_records), slots_);
+    next_ = 0;
+    if (count_ == 0) {
+        return false;
+    }
+    if (config_.read_ahead_bytes > 0) {
+        wal_->read_ahead(partition_, slots_[count_ - 1].offset() + 1,
+                         static_cast<int64_t>(config_.read_ahead_bytes));
+    }
+    return true;
+}
+
+const SpoolRecord* SpoolCursor::next() {
+    if (next_ == count_ && !fill()) {
+        return nullptr;
+    }
+    const SpoolRecord* record = &slots_[next_++];
+    position_ = record->offset() + 1;
+    return record;
+}
+
+std::span<const SpoolRecord> SpoolCursor::next_chunk(size_t max_records) {
+    if (max_records == 0 || (next_ == count_ && !fill())) {
+        return {};
+    }
+    size_t n = std::min(max_records, count_ - next_);
+    std::span<const SpoolRecord> records(slots_.data() + next_, n);
+    next_ += n;
+    position_ = records.back().offset() + 1;
+    return records;
+}
+
+void SpoolCursor::seek(int64_t offset) {
+    position_ = offset;
+    count_ = 0;
+    next_ = 0;
+}
+
+} // namespace spool
+} // namespace s1see
@@ -11,12 +11,28 @@
  */
 
 #include "s1see/spool/wal_log.h"
+#include "s1see/spool/record_frame.h"
+#include "s1see/utils/thread_pool.h"
 #include <fstream>
 #include <filesystem>
 #include <sstream>
 #include <chrono>
 #include <cstring>
 #include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <thread>
+#include <google/protobuf/io/coded_stream.h>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
 
 namespace fs = std::filesystem;
 
@@ -25,33 +41,369 @@ namespace spool {
 
 namespace {
     constexpr int64_t INDEX_ENTRY_SIZE = 16; // offset (8) + position (8)
+
+    // Map a whole file read-only; returns nullptr for empty or unreadable files
+    const char* map_file(const std::string& path, size_t& size) {
+        size = 0;
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return nullptr;
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return nullptr;
+        }
+
+        void* addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);  // Mapping stays valid after the descriptor is closed
+        if (addr == MAP_FAILED) return nullptr;
+
+        size = static_cast<size_t>(st.st_size);
+        return static_cast<const char*>(addr);
+    }
+
+    // Write all of data, retrying short writes and EINTR
+    bool write_fully(int fd, const char* data, size_t len) {
+        while (len > 0) {
+            ssize_t n = ::write(fd, data, len);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            len -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // writev all iovecs (in IOV_MAX chunks), retrying short writes and EINTR
+    bool writev_fully(int fd, std::vector<iovec>& iov) {
+        size_t idx = 0;
+        while (idx < iov.size()) {
+            int count = static_cast<int>(std::min<size_t>(iov.size() - idx, IOV_MAX));
+            ssize_t n = ::writev(fd, &iov[idx], count);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            // Advance past fully written iovecs, trim a partially written one
+            size_t written = static_cast<size_t>(n);
+            while (written > 0 && idx < iov.size()) {
+                if (written >= iov[idx].iov_len) {
+                    written -= iov[idx].iov_len;
+                    ++idx;
+                } else {
+                    iov[idx].iov_base = static_cast<char*>(iov[idx].iov_base) + written;
+                    iov[idx].iov_len -= written;
+                    written = 0;
+                }
+            }
+            while (idx < iov.size() && iov[idx].iov_len == 0) ++idx;
+        }
+        return true;
+    }
+
+    bool sync_fd(int fd) {
+        if (fd < 0) return true;
+#if defined(__APPLE__)
+        return ::fsync(fd) == 0;
+#else
+        return ::fdatasync(fd) == 0;
+#endif
+    }
+
+    // Tag of SpoolRecord.message (field 4, length-delimited)
+    constexpr uint32_t SPOOL_RECORD_MESSAGE_TAG = (4 << 3) | 2;
+
+    // Size of the frame header (length and CRC), the SpoolRecord scalar
+    // fields and the field-4 tag/length that precede a message of
+    // message_size bytes
+    size_t record_header_size(size_t header_fields_size, size_t message_size) {
+        return RECORD_FRAME_HEADER_SIZE + header_fields_size +
+               google::protobuf::io::CodedOutputStream::VarintSize32(SPOOL_RECORD_MESSAGE_TAG) +
+               google::protobuf::io::CodedOutputStream::VarintSize32(static_cast<uint32_t>(message_size));
+    }
+
+    // Write the SpoolRecord fields that precede a serialized SignalMessage,
+    // after room for the frame header. Protobuf parses header fields +
+    // message bytes as a single SpoolRecord, so the message never has to be
+    // copied into a SpoolRecord first. The frame header is filled in once
+    // the message is in place (its CRC covers the whole payload).
+    uint8_t* write_record_header(const SpoolRecord& header, size_t header_fields_size,
+                                 size_t message_size, uint8_t* out) {
+        out += RECORD_FRAME_HEADER_SIZE;
+        header.SerializeToArray(out, static_cast<int>(header_fields_size));
+        out += header_fields_size;
+        out = google::protobuf::io::CodedOutputStream::WriteVarint32ToArray(SPOOL_RECORD_MESSAGE_TAG, out);
+        return google::protobuf::io::CodedOutputStream::WriteVarint32ToArray(
+            static_cast<uint32_t>(message_size), out);
+    }
+
+    // Block while *word == expected, up to timeout. Uses a shared (not
+    // FUTEX_PRIVATE) futex so writers in other processes can wake us;
+    // elsewhere falls back to a short sleep.
+    void wait_on_word(std::atomic<uint32_t>* word, uint32_t expected, std::chrono::nanoseconds timeout) {
+#if defined(__linux__)
+        struct timespec ts;
+        ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+        ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+#else
+        (void)word;
+        (void)expected;
+        std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, std::chrono::milliseconds(1)));
+#endif
+    }
+
+    void wake_all_on_word(std::atomic<uint32_t>* word) {
+#if defined(__linux__)
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+        (void)word;
+#endif
+    }
+
+    // Sealed segments are segment_<base>.log, or .logz once compressed
+    bool is_segment_log(const fs::path& path) {
+        return (path.extension() == ".log" || path.extension() == ".logz") &&
+               path.stem().string().find("segment_") == 0;
+    }
+
+    std::string index_path_for(const std::string& log_path) {
+        return fs::path(log_path).replace_extension(".idx").string();
+    }
+
+    // Index bytes of a segment holding records [base_offset, end_offset)
+    int64_t index_bytes(int64_t base_offset, int64_t end_offset) {
+        return (end_offset - base_offset) * INDEX_ENTRY_SIZE;
+    }
+
+    // Offset files are <group>_p<partition>.offset; the group may itself
+    // contain "_p"
+    bool parse_offset_file(const fs::path& path, std::string& group, int32_t& partition, int64_t& offset) {
+        if (path.extension() != ".offset") return false;
+        std::string filename = path.stem().string();
+        size_t pos = filename.rfind("_p");
+        if (pos == std::string::npos) return false;
+        try {
+            partition = std::stoi(filename.substr(pos + 2));
+        } catch (const std::exception&) {
+            return false;
+        }
+        group = filename.substr(0, pos);
+        std::ifstream file(path, std::ios::binary);
+        file.read(reinterpret_cast<char*>(&offset), sizeof(offset));
+        return !file.fail();
+    }
+
+    // Index entries checked at the tail of a segment before recovery gives
+    // up on the index and rebuilds it from the log
+    constexpr int64_t RECOVERY_TAIL_ENTRIES = 64;
+
+    // Start the kernel reading data[position, position + length) of a mapping
+    void advise_will_need(const char* data, size_t size, int64_t position, int64_t length) {
+        if (position < 0 || static_cast<size_t>(position) >= size || length <= 0) return;
+        size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        size_t begin = static_cast<size_t>(position) / page * page;
+        size_t end = std::min(size, static_cast<size_t>(position + length));
+        ::madvise(const_cast<char*>(data) + begin, end - begin, MADV_WILLNEED);
+    }
+
+    // A complete record whose CRC does not match; reads skip it
+    void report_corrupt_record(const std::string& segment, int64_t position) {
+        std::cerr << "Skipping spool record with a bad CRC at byte " << position
+                  << " of " << segment << std::endl;
+    }
+
+    // Make a rename in dir durable
+    void sync_directory(const fs::path& dir) {
+        int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+        if (fd >= 0) {
+            ::fsync(fd);
+            ::close(fd);
+        }
+    }
+
+    int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+}
+
+MappedSegment::~MappedSegment() {
+    if (log_data) ::munmap(const_cast<char*>(log_data), log_size);
+    if (idx_data) ::munmap(const_cast<char*>(idx_data), idx_size);
+}
+
+bool MappedSegment::map(const std::string& log_path, const std::string& idx_path) {
+    log_data = map_file(log_path, log_size);
+    idx_data = map_file(idx_path, idx_size);
+    if (!log_data || !idx_data) return false;
+    
+    // Records are consumed front to back
+    ::madvise(const_cast<char*>(log_data), log_size, MADV_SEQUENTIAL);
+    return true;
 }
 
 WALLog::WALLog(const Config& config) : config_(config) {
     ensure_directory(config_.base_dir);
+    open_notify_block();
     for (int32_t p = 0; p < config_.num_partitions; ++p) {
         ensure_directory(fs::path(config_.base_dir) / ("partition_" + std::to_string(p)));
     }
+    partitions_.reserve(config_.num_partitions);
+    for (int32_t p = 0; p < config_.num_partitions; ++p) {
+        partitions_.push_back(std::make_unique<PartitionState>());
+    }
+    if (config_.recover_segments) {
+        recover_partitions();
+    }
     load_consumer_offsets();
-    cache_timestamp_ = std::chrono::system_clock::now();
+    load_catalog();
+
+    if (config_.group_commit) {
+        writer_thread_ = std::thread(&WALLog::writer_loop, this);
+    }
+
+    if (config_.compression != SegmentCompression::NONE) {
+        if (!CompressedSegment::available(config_.compression)) {
+            std::cerr << "Spool built without libzstd; compressing sealed segments with zlib" << std::endl;
+            config_.compression = SegmentCompression::ZLIB;
+        }
+        queue_sealed_segments();
+        compress_thread_ = std::thread(&WALLog::compress_loop, this);
+    }
+
+    if (config_.retention_thread) {
+        retention_thread_ = std::thread(&WALLog::retention_loop, this);
+    }
 }
 
 WALLog::~WALLog() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    {
+        std::lock_guard<std::mutex> retention_lock(retention_mutex_);
+        retention_stopping_ = true;
+    }
+    retention_cv_.notify_all();
+    if (retention_thread_.joinable()) {
+        retention_thread_.join();
+    }
+
+    // Drain queued durable appends before closing segments
+    {
+        std::lock_guard<std::mutex> commit_lock(commit_mutex_);
+        stopping_ = true;
+    }
+    commit_cv_.notify_all();
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+
+    // Segments still queued are compressed on the next start
+    {
+        std::lock_guard<std::mutex> compress_lock(compress_mutex_);
+        compress_stopping_ = true;
+    }
+    compress_cv_.notify_all();
+    if (compress_thread_.joinable()) {
+        compress_thread_.join();
+    }
+
     // Flush and close all open segments
-    for (auto& [partition, seg] : active_segments_) {
-        if (seg) {
-            flush_segment_buffers(seg.get(), true);
-            close_segment_files(seg.get());
+    for (auto& state : partitions_) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->active) {
+            flush_segment_buffers(state->active.get(), true);
+            close_segment_files(state->active.get());
         }
     }
+
+    if (notify_mapped_) {
+        ::munmap(notify_, sizeof(SpoolNotifyBlock));
+    }
+}
+
+void WALLog::open_notify_block() {
+    notify_ = &local_notify_;
+    
+    std::string path = (fs::path(config_.base_dir) / "notify").string();
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        std::cerr << "Failed to open spool notify file " << path << ": " << std::strerror(errno)
+                  << " (cross-process notification disabled)" << std::endl;
+        return;
+    }
+    
+    // Creators race harmlessly: both extend a zero-filled file to the same size
+    struct stat st;
+    if (::fstat(fd, &st) != 0 ||
+        (st.st_size < static_cast<off_t>(sizeof(SpoolNotifyBlock)) &&
+         ::ftruncate(fd, sizeof(SpoolNotifyBlock)) != 0)) {
+        std::cerr << "Failed to size spool notify file " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return;
+    }
+    
+    void* addr = ::mmap(nullptr, sizeof(SpoolNotifyBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        std::cerr << "Failed to map spool notify file " << path << ": " << std::strerror(errno) << std::endl;
+        return;
+    }
+    notify_ = static_cast<SpoolNotifyBlock*>(addr);
+    notify_mapped_ = true;
 }
 
-int32_t WALLog::partition_for_message(const SignalMessage& message) {
-    // Hash source_id + source_sequence for partitioning
-    std::hash<std::string> hasher;
-    std::string key = message.source_id() + ":" + std::to_string(message.source_sequence());
-    return static_cast<int32_t>(hasher(key) % config_.num_partitions);
+void WALLog::publish_appends() {
+    notify_->sequence.fetch_add(1, std::memory_order_release);
+    if (notify_->waiters.load(std::memory_order_acquire) > 0) {
+        wake_all_on_word(&notify_->sequence);
+    }
+}
+
+uint32_t WALLog::append_sequence() const {
+    return notify_->sequence.load(std::memory_order_acquire);
+}
+
+bool WALLog::wait_for_appends(uint32_t seen_sequence, std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (notify_->sequence.load(std::memory_order_acquire) == seen_sequence) {
+        auto remaining = deadline - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::nanoseconds::zero()) {
+            return false;
+        }
+        // Register before the futex re-checks the word, so a publisher that
+        // bumps the sequence after our load either sees us or changes the
+        // value the kernel compares against
+        notify_->waiters.fetch_add(1, std::memory_order_acq_rel);
+        wait_on_word(&notify_->sequence, seen_sequence,
+                     std::chrono::duration_cast<std::chrono::nanoseconds>(remaining));
+        notify_->waiters.fetch_sub(1, std::memory_order_acq_rel);
+    }
+    return true;
+}
+
+WALLog::PartitionState& WALLog::partition_state(int32_t partition) {
+    if (partition < 0 || partition >= static_cast<int32_t>(partitions_.size())) {
+        throw std::out_of_range("Invalid spool partition: " + std::to_string(partition));
+    }
+    return *partitions_[partition];
+}
+
+int32_t WALLog::partition_for_message(const SignalMessage& message, int32_t preferred) const {
+    if (partitions_.empty()) {
+        return 0;  // Rejected by partition_state
+    }
+    int32_t partition;
+    if (config_.partitioner) {
+        partition = config_.partitioner->partition(message, num_partitions());
+    } else if (preferred >= 0) {
+        partition = preferred % num_partitions();
+    } else {
+        static const SourceSequencePartitioner default_partitioner;
+        partition = default_partitioner.partition(message, num_partitions());
+    }
+    return std::clamp(partition, 0, num_partitions() - 1);
 }
 
 void WALLog::ensure_directory(const std::string& path) {
@@ -66,49 +418,37 @@ std::string WALLog::segment_path(int32_t partition, int64_t base_offset, const s
 }
 
 SegmentInfo* WALLog::get_or_create_segment(int32_t partition) {
-    auto it = active_segments_.find(partition);
-    if (it != active_segments_.end()) {
+    PartitionState& state = partition_state(partition);
+    if (state.active) {
         // Check if current segment needs rotation
-        if (it->second->file_size >= config_.max_segment_size) {
-            rotate_segment(partition);
-            it = active_segments_.find(partition);
+        if (state.active->file_size < config_.max_segment_size) {
+            return state.active.get();
         }
-        return it->second.get();
+        // Segment is full: seal it and fall through to open the next one
+        rotate_segment(partition);
     }
 
-    // Find the highest existing segment or start at 0
-    int64_t base_offset = 0;
-    fs::path part_dir = fs::path(config_.base_dir) / ("partition_" + std::to_string(partition));
-    
-    if (fs::exists(part_dir)) {
-        for (const auto& entry : fs::directory_iterator(part_dir)) {
-            if (entry.path().extension() == ".log") {
-                std::string stem = entry.path().stem().string();
-                if (stem.find("segment_") == 0) {
-                    int64_t seg_offset = std::stoll(stem.substr(8));
-                    if (seg_offset >= base_offset) {
-                        base_offset = seg_offset + 1;
-                    }
-                }
-            }
-        }
-    }
+    // Continue after the last offset already on disk so offsets stay
+    // monotonic across rotation and restart
+    int64_t base_offset = next_offset_for_partition(partition);
 
     auto seg = std::make_unique<SegmentInfo>();
     seg->partition = partition;
     seg->base_offset = base_offset;
     seg->log_path = segment_path(partition, base_offset, ".log");
     seg->idx_path = segment_path(partition, base_offset, ".idx");
+    seg->tix_path = segment_path(partition, base_offset, ".tix");
     seg->current_offset = base_offset;
     seg->file_size = 0;
     seg->last_fsync = std::chrono::system_clock::now();
 
-    // If segment file exists, read to find current offset
+    // If segment file exists, carry on after its records. The index
+    // counts them: recovery (recover_segments) brings it back in line with
+    // the log after a crash.
     if (fs::exists(seg->log_path)) {
         std::ifstream log_file(seg->log_path, std::ios::binary | std::ios::ate);
         if (log_file.is_open()) {
-            // Read existing records to find last offset
-            // Simplified: assume we can read the index
+            seg->file_size = static_cast<int64_t>(log_file.tellg());
             std::ifstream idx_file(seg->idx_path, std::ios::binary);
             if (idx_file.is_open()) {
                 idx_file.seekg(0, std::ios::end);
@@ -120,99 +460,444 @@ SegmentInfo* WALLog::get_or_create_segment(int32_t partition) {
         }
     }
 
-    // Open file handles for this segment
+    // Open file handles for this segment; readers list it from now on
     open_segment_files(seg.get());
+    invalidate_segment_index(partition);
 
     SegmentInfo* ptr = seg.get();
-    active_segments_[partition] = std::move(seg);
+    state.active = std::move(seg);
     return ptr;
 }
 
+int64_t WALLog::next_offset_for_partition(int32_t partition) {
+    int64_t last_base_offset = -1;
+    fs::path part_dir = fs::path(config_.base_dir) / ("partition_" + std::to_string(partition));
+    if (!fs::exists(part_dir)) return 0;
+
+    for (const auto& entry : fs::directory_iterator(part_dir)) {
+        if (is_segment_log(entry.path())) {
+            std::string stem = entry.path().stem().string();
+            last_base_offset = std::max(last_base_offset, static_cast<int64_t>(std::stoll(stem.substr(8))));
+        }
+    }
+    if (last_base_offset < 0) return 0;
+
+    // Each index entry covers one record of the segment
+    std::error_code ec;
+    auto idx_size = fs::file_size(segment_path(partition, last_base_offset, ".idx"), ec);
+    if (ec) idx_size = 0;
+    return last_base_offset + static_cast<int64_t>(idx_size / INDEX_ENTRY_SIZE);
+}
+
+void WALLog::recover_partitions() {
+    size_t threads = config_.recovery_threads > 0 ? config_.recovery_threads
+                                                   : std::max(std::thread::hardware_concurrency(), 1u);
+    threads = std::min(threads, partitions_.size());
+
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto recover = [&](size_t p) {
+        try {
+            recover_partition(static_cast<int32_t>(p));
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+        }
+    };
+    if (threads <= 1) {
+        for (size_t p = 0; p < partitions_.size(); ++p) recover(p);
+    } else {
+        utils::ThreadPool pool(threads);
+        pool.parallel_for(partitions_.size(), recover);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void WALLog::recover_partition(int32_t partition) {
+    // Only the newest segment can have been cut short: sealed segments are
+    // synced when they rotate, and compressed ones are renamed into place
+    // complete. Compression output a crash left behind goes.
+    fs::path part_dir = fs::path(config_.base_dir) / ("partition_" + std::to_string(partition));
+    int64_t newest = -1;
+    bool newest_raw = false;
+    std::error_code ec;
+    std::vector<fs::path> leftovers;
+    for (const auto& entry : fs::directory_iterator(part_dir, ec)) {
+        const fs::path& path = entry.path();
+        if (path.extension() == ".tmp") {
+            leftovers.push_back(path);
+        } else if (is_segment_log(path)) {
+            int64_t base = std::stoll(path.stem().string().substr(8));
+            if (base > newest) {
+                newest = base;
+                newest_raw = path.extension() == ".log";
+            } else if (base == newest && path.extension() == ".logz") {
+                newest_raw = false;
+            }
+        }
+    }
+    for (const auto& path : leftovers) {
+        fs::remove(path, ec);
+    }
+    if (newest < 0 || !newest_raw) return;
+
+    std::string log_path = segment_path(partition, newest, ".log");
+    std::string idx_path = segment_path(partition, newest, ".idx");
+    size_t log_size = 0;
+    const char* log = map_file(log_path, log_size);
+    struct Unmap {
+        const char* data;
+        size_t size;
+        ~Unmap() { if (data) ::munmap(const_cast<char*>(data), size); }
+    } unmap{log, log_size};
+
+    // Whether a frame at position is a whole, intact record. Records
+    // written before CRC framing are checked by parsing them.
+    auto valid_frame = [&](int64_t position, int64_t offset, RecordFrame& frame) {
+        if (position < 0 || static_cast<size_t>(position) >= log_size) return false;
+        if (parse_record_frame(log + position, log_size - position, frame) != FrameStatus::OK) return false;
+        if (frame.checksummed) return true;
+        SpoolRecord record;
+        return record.ParseFromArray(frame.payload, static_cast<int>(frame.payload_size)) &&
+               record.offset() == offset;
+    };
+
+    // Trust the index up to its last entry that still points at an intact
+    // record, looking back at most RECOVERY_TAIL_ENTRIES from the end, so a
+    // clean or torn segment costs a few reads. If none does, the index is
+    // rebuilt from the log.
+    int fd = ::open(idx_path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open index file: " + idx_path);
+    }
+    struct Close {
+        int fd;
+        ~Close() { ::close(fd); }
+    } close_idx{fd};
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        throw std::runtime_error("Failed to stat index file: " + idx_path);
+    }
+    int64_t entries = st.st_size / INDEX_ENTRY_SIZE;
+    int64_t tail = std::min(entries, RECOVERY_TAIL_ENTRIES);
+    std::vector<int64_t> tail_entries(tail * 2);
+    ssize_t tail_bytes = static_cast<ssize_t>(tail * INDEX_ENTRY_SIZE);
+    if (tail > 0 && ::pread(fd, tail_entries.data(), tail_bytes, (entries - tail) * INDEX_ENTRY_SIZE) != tail_bytes) {
+        throw std::runtime_error("Failed to read index file: " + idx_path);
+    }
+
+    int64_t kept = 0;       // Index entries kept
+    int64_t resume = 0;     // Log position after the last kept record
+    bool rebuild = log_size > 0;
+    for (int64_t i = tail - 1; i >= 0; --i) {
+        int64_t entry = entries - tail + i;
+        RecordFrame frame;
+        if (tail_entries[i * 2] == newest + entry &&
+            valid_frame(tail_entries[i * 2 + 1], newest + entry, frame)) {
+            kept = entry + 1;
+            resume = tail_entries[i * 2 + 1] + static_cast<int64_t>(frame.size);
+            rebuild = false;
+            break;
+        }
+    }
+    if (rebuild) {
+        std::cerr << "Spool recovery: rebuilding index of " << log_path << std::endl;
+    }
+
+    // Records past the index (the log is written first), up to the first
+    // torn or corrupt one
+    std::vector<int64_t> added;
+    int64_t position = resume;
+    RecordFrame frame;
+    while (valid_frame(position, newest + kept + static_cast<int64_t>(added.size() / 2), frame)) {
+        added.push_back(newest + kept + static_cast<int64_t>(added.size() / 2));
+        added.push_back(position);
+        position += static_cast<int64_t>(frame.size);
+    }
+
+    bool log_changed = static_cast<size_t>(position) < log_size;
+    bool idx_changed = kept != entries || st.st_size != entries * INDEX_ENTRY_SIZE || !added.empty();
+    if (log_changed) {
+        std::cerr << "Spool recovery: dropped " << (log_size - position) << " bytes of torn or corrupt records from "
+                  << log_path << " (now " << (kept + added.size() / 2) << " records)" << std::endl;
+        if (::truncate(log_path.c_str(), position) != 0) {
+            throw std::runtime_error("Failed to truncate log file: " + log_path + ": " + std::strerror(errno));
+        }
+    }
+    if (idx_changed) {
+        ssize_t added_bytes = static_cast<ssize_t>(added.size() * sizeof(int64_t));
+        if (::ftruncate(fd, kept * INDEX_ENTRY_SIZE) != 0 ||
+            (added_bytes > 0 && ::pwrite(fd, added.data(), added_bytes, kept * INDEX_ENTRY_SIZE) != added_bytes)) {
+            throw std::runtime_error("Failed to repair index file: " + idx_path + ": " + std::strerror(errno));
+        }
+    }
+    
+    // Time index entries past the recovered records go, as does a torn entry
+    int64_t recovered_end = newest + kept + static_cast<int64_t>(added.size() / 2);
+    std::string tix_path = segment_path(partition, newest, ".tix");
+    auto time_entries = load_time_index(partition, newest);
+    size_t time_kept = 0;
+    while (time_kept < time_entries.size() &&
+           time_entries[time_kept].offset + time_entries[time_kept].count <= recovered_end) {
+        ++time_kept;
+    }
+    std::error_code tix_ec;
+    auto tix_size = fs::file_size(tix_path, tix_ec);
+    if (!tix_ec && tix_size != time_kept * sizeof(TimeIndexEntry) &&
+        ::truncate(tix_path.c_str(), static_cast<off_t>(time_kept * sizeof(TimeIndexEntry))) != 0) {
+        throw std::runtime_error("Failed to truncate time index: " + tix_path + ": " + std::strerror(errno));
+    }
+    
+    if (log_changed || idx_changed) {
+        int log_fd = ::open(log_path.c_str(), O_WRONLY);
+        bool synced = log_fd >= 0 && sync_fd(log_fd) && sync_fd(fd);
+        if (log_fd >= 0) ::close(log_fd);
+        if (!synced) {
+            throw std::runtime_error("Failed to sync recovered segment: " + log_path);
+        }
+    }
+}
+
 void WALLog::rotate_segment(int32_t partition) {
-    auto it = active_segments_.find(partition);
-    if (it == active_segments_.end()) return;
+    PartitionState& state = partition_state(partition);
+    if (!state.active) return;
 
     // Flush and close current segment
-    if (it->second) {
-        flush_segment_buffers(it->second.get(), true);
-        close_segment_files(it->second.get());
+    flush_segment_buffers(state.active.get(), true);
+    close_segment_files(state.active.get());
+    int64_t sealed_base = state.active->base_offset;
+    {
+        std::lock_guard<std::mutex> catalog_lock(state.catalog_mutex);
+        const SegmentInfo& seg = *state.active;
+        PartitionState::CatalogEntry entry{seg.base_offset, seg.current_offset,
+                                           seg.file_size + index_bytes(seg.base_offset, seg.current_offset),
+                                           std::chrono::system_clock::now()};
+        // An empty segment found at startup is reopened, and already listed
+        if (!state.catalog.empty() && state.catalog.back().base_offset == seg.base_offset) {
+            state.catalog.back() = entry;
+        } else {
+            state.catalog.push_back(entry);
+        }
     }
-    it->second.reset();
-    active_segments_.erase(it);
+    state.active.reset();
     
-    // Invalidate cache for this partition
-    segment_cache_.erase(partition);
+    // The sealed segment gets a resident position array on the next read
+    invalidate_segment_index(partition);
+    
+    if (config_.compression != SegmentCompression::NONE) {
+        queue_compression(partition, sealed_base);
+    }
 }
 
-std::pair<int32_t, int64_t> WALLog::append(const SignalMessage& message) {
-    std::lock_guard<std::mutex> lock(mutex_);
+void WALLog::queue_compression(int32_t partition, int64_t base_offset) {
+    {
+        std::lock_guard<std::mutex> lock(compress_mutex_);
+        compress_queue_.emplace_back(partition, base_offset);
+    }
+    compress_cv_.notify_all();
+}
 
-    int32_t partition = partition_for_message(message);
+void WALLog::queue_sealed_segments() {
+    // Every raw segment but the newest is sealed: left from before a
+    // restart, or from before compression was enabled
+    for (int32_t p = 0; p < config_.num_partitions; ++p) {
+        fs::path part_dir = fs::path(config_.base_dir) / ("partition_" + std::to_string(p));
+        std::vector<int64_t> raw_bases;
+        int64_t newest = -1;
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(part_dir, ec)) {
+            if (is_segment_log(entry.path())) {
+                int64_t base = std::stoll(entry.path().stem().string().substr(8));
+                newest = std::max(newest, base);
+                if (entry.path().extension() == ".log") {
+                    raw_bases.push_back(base);
+                }
+            }
+        }
+        std::sort(raw_bases.begin(), raw_bases.end());
+        for (int64_t base : raw_bases) {
+            if (base != newest) {
+                compress_queue_.emplace_back(p, base);
+            }
+        }
+    }
+}
+
+void WALLog::wait_for_compression() {
+    std::unique_lock<std::mutex> lock(compress_mutex_);
+    compress_cv_.wait(lock, [this]() {
+        return (compress_queue_.empty() && !compressing_) || !compress_thread_.joinable();
+    });
+}
+
+void WALLog::compress_loop() {
+    while (true) {
+        std::pair<int32_t, int64_t> segment;
+        {
+            std::unique_lock<std::mutex> lock(compress_mutex_);
+            compressing_ = false;
+            compress_cv_.notify_all();
+            compress_cv_.wait(lock, [this]() { return compress_stopping_ || !compress_queue_.empty(); });
+            if (compress_stopping_) {
+                return;
+            }
+            segment = compress_queue_.front();
+            compress_queue_.pop_front();
+            compressing_ = true;
+        }
+        try {
+            compress_segment(segment.first, segment.second);
+        } catch (const std::exception& e) {
+            // The raw segment stays in place and readable
+            std::cerr << "Failed to compress spool segment " << segment.second << " of partition "
+                      << segment.first << ": " << e.what() << std::endl;
+        }
+    }
+}
+
+void WALLog::compress_segment(int32_t partition, int64_t base_offset) {
+    std::lock_guard<std::mutex> files_lock(segment_files_mutex_);
+    std::string log_path = segment_path(partition, base_offset, ".log");
+    std::string out_path = segment_path(partition, base_offset, ".logz");
+
+    // A .logz is only ever renamed into place complete, so one left beside
+    // its .log by a crash just needs the .log removed
+    if (!fs::exists(out_path)) {
+        if (!fs::exists(log_path)) {
+            return;
+        }
+        CompressedSegment::Options options;
+        options.codec = config_.compression;
+        options.block_size = config_.compression_block_size;
+        options.level = config_.compression_level;
+        options.dictionary_size = config_.compression_dictionary_size;
+        std::string tmp_path = out_path + ".tmp";
+        int64_t compressed_size = CompressedSegment::write(log_path, tmp_path, options);
+        fs::rename(tmp_path, out_path);
+        sync_directory(fs::path(out_path).parent_path());
+
+        PartitionState& state = partition_state(partition);
+        std::lock_guard<std::mutex> catalog_lock(state.catalog_mutex);
+        for (auto& entry : state.catalog) {
+            if (entry.base_offset == base_offset) {
+                entry.bytes = compressed_size + index_bytes(entry.base_offset, entry.end_offset);
+            }
+        }
+    }
+
+    // Readers switch to the .logz when their index is rebuilt; one that
+    // still has the .log path retries (see read)
+    invalidate_segment_index(partition);
+    fs::remove(log_path);
+}
+
+int64_t WALLog::append_record_locked(int32_t partition, const SignalMessage& message, int64_t ts_append) {
     SegmentInfo* seg = get_or_create_segment(partition);
+    if (seg->log_fd < 0 || seg->idx_fd < 0) {
+        open_segment_files(seg);
+    }
 
-    int64_t offset = seg->current_offset++;
+    int64_t offset = seg->current_offset;
 
-    // Create SpoolRecord
-    SpoolRecord record;
-    record.set_partition(partition);
-    record.set_offset(offset);
-    record.set_ts_append(std::chrono::duration_cast<std::chrono::nanoseconds>(
-        std::chrono::system_clock::now().time_since_epoch()).count());
-    *record.mutable_message() = message;
+    // SpoolRecord header fields only; the message is serialized after them
+    SpoolRecord header;
+    header.set_partition(partition);
+    header.set_offset(offset);
+    header.set_ts_append(ts_append);
+    size_t header_fields_size = header.ByteSizeLong();
+    size_t message_size = message.ByteSizeLong();
+    size_t total_size = record_header_size(header_fields_size, message_size) + message_size;
+    if (total_size - RECORD_FRAME_HEADER_SIZE > RECORD_LENGTH_MASK) {
+        throw std::runtime_error("SpoolRecord too large");
+    }
 
-    // Serialize record
-    std::string serialized;
-    if (!record.SerializeToString(&serialized)) {
-        throw std::runtime_error("Failed to serialize SpoolRecord");
+    // Serialize straight into the segment buffer (or a scratch buffer for direct writes)
+    std::vector<char> direct;
+    std::vector<char>& out = config_.use_buffering ? seg->log_buffer : direct;
+    size_t start = out.size();
+    out.resize(start + total_size);
+    uint8_t* pos = write_record_header(header, header_fields_size, message_size,
+                                       reinterpret_cast<uint8_t*>(out.data() + start));
+    if (!message.SerializeToArray(pos, static_cast<int>(message_size))) {
+        out.resize(start);
+        throw std::runtime_error("Failed to serialize SignalMessage");
     }
+    seal_record_frame(out.data() + start, total_size - RECORD_FRAME_HEADER_SIZE);
 
     // Get position before writing
     int64_t position = seg->file_size;
-    
-    // Write length prefix + data to buffer or directly to file
-    uint32_t length = static_cast<uint32_t>(serialized.size());
-    
-    if (config_.use_buffering && seg->log_file) {
-        // Buffered write
-        const char* length_bytes = reinterpret_cast<const char*>(&length);
-        seg->log_buffer.insert(seg->log_buffer.end(), length_bytes, length_bytes + sizeof(length));
-        seg->log_buffer.insert(seg->log_buffer.end(), serialized.begin(), serialized.end());
+    seg->file_size += total_size;
+    seg->current_offset++;
+
+    int64_t idx_entry[2] = {offset, position};
+    if (config_.use_buffering) {
+        const char* entry_bytes = reinterpret_cast<const char*>(idx_entry);
+        seg->idx_buffer.insert(seg->idx_buffer.end(), entry_bytes, entry_bytes + INDEX_ENTRY_SIZE);
         
-        // Flush buffer if it's getting large
-        if (seg->log_buffer.size() >= SegmentInfo::BUFFER_SIZE) {
-            seg->log_file->write(seg->log_buffer.data(), seg->log_buffer.size());
+        // Flush buffers if they're getting large; the log always goes first
+        // so index entries never point past the end of the log
+        bool flush_idx = seg->idx_buffer.size() >= SegmentInfo::BUFFER_SIZE;
+        if (flush_idx || seg->log_buffer.size() >= SegmentInfo::BUFFER_SIZE) {
+            if (!write_fully(seg->log_fd, seg->log_buffer.data(), seg->log_buffer.size())) {
+                throw std::runtime_error("Failed to write log file: " + seg->log_path);
+            }
             seg->log_buffer.clear();
         }
-    } else {
-        // Direct write (fallback)
-        if (!seg->log_file) {
-            open_segment_files(seg);
-        }
-        seg->log_file->write(reinterpret_cast<const char*>(&length), sizeof(length));
-        seg->log_file->write(serialized.data(), serialized.size());
-    }
-    
-    seg->file_size += sizeof(length) + serialized.size();
-
-    // Write to index (buffered or direct)
-    if (config_.use_buffering && seg->idx_file) {
-        const char* offset_bytes = reinterpret_cast<const char*>(&offset);
-        const char* position_bytes = reinterpret_cast<const char*>(&position);
-        seg->idx_buffer.insert(seg->idx_buffer.end(), offset_bytes, offset_bytes + sizeof(offset));
-        seg->idx_buffer.insert(seg->idx_buffer.end(), position_bytes, position_bytes + sizeof(position));
-        
-        if (seg->idx_buffer.size() >= SegmentInfo::BUFFER_SIZE) {
-            seg->idx_file->write(seg->idx_buffer.data(), seg->idx_buffer.size());
+        if (flush_idx) {
+            if (!write_fully(seg->idx_fd, seg->idx_buffer.data(), seg->idx_buffer.size())) {
+                throw std::runtime_error("Failed to write index file: " + seg->idx_path);
+            }
             seg->idx_buffer.clear();
         }
     } else {
-        if (!seg->idx_file) {
-            open_segment_files(seg);
+        // Direct write (fallback)
+        if (!write_fully(seg->log_fd, direct.data(), direct.size())) {
+            throw std::runtime_error("Failed to write log file: " + seg->log_path);
         }
-        seg->idx_file->write(reinterpret_cast<const char*>(&offset), sizeof(offset));
-        seg->idx_file->write(reinterpret_cast<const char*>(&position), sizeof(position));
+        if (!write_fully(seg->idx_fd, reinterpret_cast<const char*>(idx_entry), INDEX_ENTRY_SIZE)) {
+            throw std::runtime_error("Failed to write index file: " + seg->idx_path);
+        }
+    }
+
+    index_time(seg, offset, message.ts_capture(), ts_append);
+    return offset;
+}
+
+void WALLog::index_time(SegmentInfo* seg, int64_t offset, int64_t ts_capture, int64_t ts_append) {
+    if (config_.time_index_interval <= 0) {
+        return;
+    }
+    TimeIndexEntry& block = seg->time_block;
+    if (block.count == 0) {
+        block = TimeIndexEntry{offset, 0, ts_capture, ts_append};
+    }
+    block.max_ts_capture = std::max(block.max_ts_capture, ts_capture);
+    block.max_ts_append = std::max(block.max_ts_append, ts_append);
+    if (++block.count >= config_.time_index_interval) {
+        // The entry never covers records a reader cannot find yet
+        flush_segment_buffers(seg);
+        write_time_block(seg);
+    }
+}
+
+void WALLog::write_time_block(SegmentInfo* seg) {
+    if (seg->time_block.count == 0) {
+        return;
+    }
+    if (seg->tix_fd < 0) {
+        seg->tix_fd = ::open(seg->tix_path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    }
+    // A lost entry only means a seek scans those records
+    if (seg->tix_fd < 0 || !write_fully(seg->tix_fd, reinterpret_cast<const char*>(&seg->time_block),
+                                        sizeof(TimeIndexEntry))) {
+        std::cerr << "Failed to write time index " << seg->tix_path << ": " << std::strerror(errno) << std::endl;
     }
+    seg->time_block.count = 0;
+}
 
+void WALLog::sync_if_due(SegmentInfo* seg) {
     // Periodic fsync (instead of every append)
     auto now = std::chrono::system_clock::now();
     bool should_fsync = config_.fsync_on_append && 
@@ -221,24 +906,243 @@ std::pair<int32_t, int64_t> WALLog::append(const SignalMessage& message) {
     if (should_fsync) {
         flush_segment_buffers(seg, true);
         seg->last_fsync = now;
+    } else if (config_.visible_on_append) {
+        flush_segment_buffers(seg);
+    }
+}
+
+std::pair<int32_t, int64_t> WALLog::append(const SignalMessage& message) {
+    int32_t partition = partition_for_message(message);
+    PartitionState& state = partition_state(partition);
+
+    int64_t offset;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        offset = append_record_locked(partition, message, now_ns());
+        sync_if_due(state.active.get());
     }
+    publish_appends();
 
     return {partition, offset};
 }
 
+std::vector<std::pair<int32_t, int64_t>> WALLog::append_batch(std::span<const SignalMessage> messages) {
+    std::vector<std::pair<int32_t, int64_t>> results(messages.size());
+
+    // Bucket by partition (keeping input order) so each lock is taken once
+    std::vector<std::vector<size_t>> by_partition(partitions_.size());
+    for (size_t i = 0; i < messages.size(); ++i) {
+        by_partition[partition_for_message(messages[i])].push_back(i);
+    }
+
+    int64_t ts_append = now_ns();
+    for (size_t p = 0; p < by_partition.size(); ++p) {
+        if (by_partition[p].empty()) continue;
+
+        int32_t partition = static_cast<int32_t>(p);
+        PartitionState& state = partition_state(partition);
+        std::lock_guard<std::mutex> lock(state.mutex);
+        for (size_t i : by_partition[p]) {
+            results[i] = {partition, append_record_locked(partition, messages[i], ts_append)};
+        }
+        sync_if_due(state.active.get());
+    }
+    if (!messages.empty()) {
+        publish_appends();
+    }
+
+    return results;
+}
+
+int64_t WALLog::append_batch_durable(int32_t partition, std::span<const SignalMessage> messages) {
+    PartitionState& state = partition_state(partition);
+    int64_t first_offset = -1;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        int64_t ts_append = now_ns();
+        for (const auto& message : messages) {
+            int64_t offset = append_record_locked(partition, message, ts_append);
+            if (first_offset < 0) first_offset = offset;
+        }
+        if (state.active && !messages.empty()) {
+            flush_segment_buffers(state.active.get(), true);
+            state.active->last_fsync = std::chrono::system_clock::now();
+        }
+    }
+    if (!messages.empty()) {
+        publish_appends();
+    }
+    return first_offset;
+}
+
+std::future<std::pair<int32_t, int64_t>> WALLog::append_durable(const SignalMessage& message) {
+    if (!config_.group_commit) {
+        // No writer thread: append and sync this partition's segment inline
+        std::promise<std::pair<int32_t, int64_t>> done;
+        auto result = append(message);
+        {
+            PartitionState& state = partition_state(result.first);
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (state.active) {
+                flush_segment_buffers(state.active.get(), true);
+                state.active->last_fsync = std::chrono::system_clock::now();
+            }
+        }
+        done.set_value(result);
+        return done.get_future();
+    }
+
+    PendingAppend pending;
+    pending.partition = partition_for_message(message);
+    pending.ts_capture = message.ts_capture();
+    if (!message.SerializeToString(&pending.payload)) {
+        throw std::runtime_error("Failed to serialize SignalMessage");
+    }
+    auto future = pending.done.get_future();
+
+    {
+        std::lock_guard<std::mutex> commit_lock(commit_mutex_);
+        if (stopping_) {
+            throw std::runtime_error("WALLog is shutting down");
+        }
+        pending_appends_.push_back(std::move(pending));
+    }
+    commit_cv_.notify_one();
+    return future;
+}
+
+void WALLog::writer_loop() {
+    std::vector<PendingAppend> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> commit_lock(commit_mutex_);
+            commit_cv_.wait(commit_lock, [this] { return stopping_ || !pending_appends_.empty(); });
+            if (pending_appends_.empty()) {
+                return; // Stopping and fully drained
+            }
+
+            // Take everything queued so far (bounded) as one group
+            size_t count = std::min(pending_appends_.size(), config_.group_commit_max_batch);
+            batch.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                batch.push_back(std::move(pending_appends_.front()));
+                pending_appends_.pop_front();
+            }
+        }
+
+        commit_batch(batch);
+        publish_appends();
+        batch.clear();
+    }
+}
+
+void WALLog::commit_batch(std::vector<PendingAppend>& batch) {
+    // Group by partition, preserving enqueue order within each partition
+    std::map<int32_t, std::vector<PendingAppend*>> by_partition;
+    for (auto& pending : batch) {
+        by_partition[pending.partition].push_back(&pending);
+    }
+
+    for (auto& [partition, entries] : by_partition) {
+        try {
+            std::lock_guard<std::mutex> lock(partition_state(partition).mutex);
+            commit_partition(partition, entries);
+        } catch (...) {
+            for (auto* pending : entries) {
+                if (!pending->acked) {
+                    pending->done.set_exception(std::current_exception());
+                    pending->acked = true;
+                }
+            }
+        }
+    }
+}
+
+void WALLog::commit_partition(int32_t partition, std::vector<PendingAppend*>& entries) {
+    size_t next = 0;
+    while (next < entries.size()) {
+        SegmentInfo* seg = get_or_create_segment(partition);
+
+        // Anything appended through the buffered path must land first
+        flush_segment_buffers(seg);
+
+        // Fill the current segment up to its size limit; the rest of the
+        // group continues in the next segment
+        size_t chunk_start = next;
+        int64_t ts_append = now_ns();
+        std::vector<std::string> headers;
+        std::vector<int64_t> idx_entries;
+        while (next < entries.size() &&
+               (next == chunk_start || seg->file_size < config_.max_segment_size)) {
+            PendingAppend* pending = entries[next];
+            int64_t offset = seg->current_offset++;
+
+            // SpoolRecord header fields followed by the pre-serialized message
+            SpoolRecord header;
+            header.set_partition(partition);
+            header.set_offset(offset);
+            header.set_ts_append(ts_append);
+            size_t header_fields_size = header.ByteSizeLong();
+
+            std::string framed(record_header_size(header_fields_size, pending->payload.size()), '\0');
+            write_record_header(header, header_fields_size, pending->payload.size(),
+                                reinterpret_cast<uint8_t*>(&framed[0]));
+            uint32_t length = static_cast<uint32_t>(framed.size() - RECORD_FRAME_HEADER_SIZE +
+                                                    pending->payload.size()) | RECORD_CHECKSUMMED;
+            uint32_t crc = utils::crc32c(framed.data() + RECORD_FRAME_HEADER_SIZE,
+                                         framed.size() - RECORD_FRAME_HEADER_SIZE);
+            crc = utils::crc32c(pending->payload.data(), pending->payload.size(), crc);
+            std::memcpy(&framed[0], &length, sizeof(length));
+            std::memcpy(&framed[sizeof(length)], &crc, sizeof(crc));
+
+            idx_entries.push_back(offset);
+            idx_entries.push_back(seg->file_size);
+            seg->file_size += framed.size() + pending->payload.size();
+
+            pending->result = {partition, offset};
+            headers.push_back(std::move(framed));
+            ++next;
+        }
+
+        // One writev for the whole chunk, one index write, then make it durable
+        std::vector<iovec> iov;
+        iov.reserve(headers.size() * 2);
+        for (size_t i = 0; i < headers.size(); ++i) {
+            PendingAppend* pending = entries[chunk_start + i];
+            iov.push_back({headers[i].data(), headers[i].size()});
+            iov.push_back({pending->payload.data(), pending->payload.size()});
+        }
+
+        if (!writev_fully(seg->log_fd, iov) ||
+            !write_fully(seg->idx_fd, reinterpret_cast<const char*>(idx_entries.data()),
+                         idx_entries.size() * sizeof(int64_t)) ||
+            !sync_fd(seg->log_fd) || !sync_fd(seg->idx_fd)) {
+            throw std::runtime_error("Group commit failed for partition " + std::to_string(partition) +
+                                     ": " + std::strerror(errno));
+        }
+        seg->last_fsync = std::chrono::system_clock::now();
+
+        for (size_t i = chunk_start; i < next; ++i) {
+            index_time(seg, entries[i]->result.second, entries[i]->ts_capture, ts_append);
+        }
+        for (size_t i = chunk_start; i < next; ++i) {
+            entries[i]->done.set_value(entries[i]->result);
+            entries[i]->acked = true;
+        }
+    }
+}
+
 void WALLog::open_segment_files(SegmentInfo* seg) {
-    if (!seg->log_file) {
-        seg->log_file = std::make_unique<std::ofstream>(
-            seg->log_path, std::ios::binary | std::ios::app);
-        if (!seg->log_file->is_open()) {
+    if (seg->log_fd < 0) {
+        seg->log_fd = ::open(seg->log_path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (seg->log_fd < 0) {
             throw std::runtime_error("Failed to open log file: " + seg->log_path);
         }
     }
     
-    if (!seg->idx_file) {
-        seg->idx_file = std::make_unique<std::ofstream>(
-            seg->idx_path, std::ios::binary | std::ios::app);
-        if (!seg->idx_file->is_open()) {
+    if (seg->idx_fd < 0) {
+        seg->idx_fd = ::open(seg->idx_path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (seg->idx_fd < 0) {
             throw std::runtime_error("Failed to open index file: " + seg->idx_path);
         }
     }
@@ -248,30 +1152,33 @@ void WALLog::flush_segment_buffers(SegmentInfo* seg, bool force_fsync) {
     if (!seg) return;
     
     // Flush log buffer
-    if (seg->log_file && !seg->log_buffer.empty()) {
-        seg->log_file->write(seg->log_buffer.data(), seg->log_buffer.size());
+    if (seg->log_fd >= 0 && !seg->log_buffer.empty()) {
+        if (!write_fully(seg->log_fd, seg->log_buffer.data(), seg->log_buffer.size())) {
+            std::cerr << "Failed to flush log file " << seg->log_path << ": " << std::strerror(errno) << std::endl;
+        }
         seg->log_buffer.clear();
-        seg->log_file->flush();
     }
     
     // Flush index buffer
-    if (seg->idx_file && !seg->idx_buffer.empty()) {
-        seg->idx_file->write(seg->idx_buffer.data(), seg->idx_buffer.size());
+    if (seg->idx_fd >= 0 && !seg->idx_buffer.empty()) {
+        if (!write_fully(seg->idx_fd, seg->idx_buffer.data(), seg->idx_buffer.size())) {
+            std::cerr << "Failed to flush index file " << seg->idx_path << ": " << std::strerror(errno) << std::endl;
+        }
         seg->idx_buffer.clear();
-        seg->idx_file->flush();
     }
     
-    if (force_fsync && seg->log_file) {
-        // Note: Full fsync would require file descriptor access
-        // For now, flush is sufficient
+    if (force_fsync) {
+        if (!sync_fd(seg->log_fd) || !sync_fd(seg->idx_fd)) {
+            std::cerr << "Failed to sync segment " << seg->log_path << ": " << std::strerror(errno) << std::endl;
+        }
     }
 }
 
 void WALLog::flush_all_segments() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (auto& [partition, seg] : active_segments_) {
-        if (seg) {
-            flush_segment_buffers(seg.get(), true);
+    for (auto& state : partitions_) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->active) {
+            flush_segment_buffers(state->active.get(), true);
         }
     }
 }
@@ -282,144 +1189,585 @@ void WALLog::close_segment_files(SegmentInfo* seg) {
     // Flush any remaining buffers before closing
     flush_segment_buffers(seg, true);
     
-    if (seg->log_file) {
-        seg->log_file->close();
-        seg->log_file.reset();
+    if (seg->log_fd >= 0) {
+        ::close(seg->log_fd);
+        seg->log_fd = -1;
+    }
+    
+    if (seg->idx_fd >= 0) {
+        ::close(seg->idx_fd);
+        seg->idx_fd = -1;
     }
     
-    if (seg->idx_file) {
-        seg->idx_file->close();
-        seg->idx_file.reset();
+    // The partial last block too; a reopened segment starts a new one
+    write_time_block(seg);
+    if (seg->tix_fd >= 0) {
+        sync_fd(seg->tix_fd);
+        ::close(seg->tix_fd);
+        seg->tix_fd = -1;
     }
 }
 
-std::vector<std::pair<int64_t, std::string>> WALLog::get_segments_for_partition(int32_t partition) {
-    // Check cache first
-    auto now = std::chrono::system_clock::now();
-    bool cache_valid = (now - cache_timestamp_) < CACHE_TTL;
-    
-    auto cache_it = segment_cache_.find(partition);
-    if (cache_valid && cache_it != segment_cache_.end()) {
-        return cache_it->second;
+std::shared_ptr<const std::vector<int64_t>> WALLog::load_segment_positions(const std::string& idx_path,
+                                                                           int64_t base_offset) {
+    std::ifstream idx_file(idx_path, std::ios::binary | std::ios::ate);
+    if (!idx_file.is_open()) return nullptr;
+
+    std::streamsize file_size = idx_file.tellg();
+    int64_t num_entries = file_size / INDEX_ENTRY_SIZE;
+    std::vector<int64_t> entries(num_entries * 2);
+    idx_file.seekg(0, std::ios::beg);
+    if (!idx_file.read(reinterpret_cast<char*>(entries.data()), num_entries * INDEX_ENTRY_SIZE)) {
+        return nullptr;
     }
-    
-    // Cache miss or expired - scan directory
+
+    // Offsets within a segment are dense from its base, so the array is
+    // indexed by (offset - base_offset). Anything else keeps binary search.
+    auto positions = std::make_shared<std::vector<int64_t>>(num_entries);
+    for (int64_t i = 0; i < num_entries; ++i) {
+        if (entries[i * 2] != base_offset + i) return nullptr;
+        (*positions)[i] = entries[i * 2 + 1];
+    }
+    return positions;
+}
+
+std::shared_ptr<const WALLog::SegmentIndex> WALLog::get_segment_index(int32_t partition) {
+    PartitionState& state = partition_state(partition);
+    std::lock_guard<std::mutex> lock(state.index_mutex);
+
+    // Every process that changes the segments bumps the shared generation
+    // after the change, and it is read before listing, so a listing is never
+    // newer than its generation. Without the shared block, segments created
+    // or removed by another process show in the directory mtime.
+    uint32_t generation = notify_->segment_generation.load(std::memory_order_acquire);
     fs::path part_dir = fs::path(config_.base_dir) / ("partition_" + std::to_string(partition));
-    if (!fs::exists(part_dir)) {
-        return {};
+    std::error_code ec;
+    fs::file_time_type dir_mtime{};
+    if (!notify_mapped_) {
+        dir_mtime = fs::last_write_time(part_dir, ec);
+        if (ec) return nullptr;
+    }
+    if (state.index && state.index->generation == generation && state.index->dir_mtime == dir_mtime) {
+        return state.index;
+    }
+    if (notify_mapped_ && !fs::is_directory(part_dir, ec)) {
+        return nullptr;
     }
 
-    std::vector<std::pair<int64_t, std::string>> segments;
-    for (const auto& entry : fs::directory_iterator(part_dir)) {
-        if (entry.path().extension() == ".log") {
-            std::string stem = entry.path().stem().string();
-            if (stem.find("segment_") == 0) {
-                int64_t seg_base = std::stoll(stem.substr(8));
-                segments.emplace_back(seg_base, entry.path().string());
+    // base offset -> log path; a .logz wins over a .log left beside it
+    std::map<int64_t, std::string> segments;
+    for (const auto& entry : fs::directory_iterator(part_dir, ec)) {
+        if (is_segment_log(entry.path())) {
+            int64_t base_offset = std::stoll(entry.path().stem().string().substr(8));
+            std::string& log_path = segments[base_offset];
+            if (log_path.empty() || entry.path().extension() == ".logz") {
+                log_path = entry.path().string();
             }
         }
     }
-    std::sort(segments.begin(), segments.end());
+    std::vector<std::pair<int64_t, std::string>> listing(segments.begin(), segments.end());
+
+    auto index = std::make_shared<SegmentIndex>();
+    index->generation = generation;
+    index->dir_mtime = dir_mtime;
+    for (size_t i = 0; i < listing.size(); ++i) {
+        auto& [base_offset, log_path] = listing[i];
+        bool compressed = fs::path(log_path).extension() == ".logz";
+        std::shared_ptr<const std::vector<int64_t>> positions;
+
+        // Only sealed segments get a resident position array; the last one may still grow
+        if (i + 1 < listing.size()) {
+            if (state.index) {
+                auto old = std::lower_bound(state.index->base_offsets.begin(),
+                                            state.index->base_offsets.end(), base_offset);
+                if (old != state.index->base_offsets.end() && *old == base_offset) {
+                    positions = state.index->positions[old - state.index->base_offsets.begin()];
+                }
+            }
+            if (!positions) {
+                positions = load_segment_positions(index_path_for(log_path), base_offset);
+            }
+        }
+
+        index->base_offsets.push_back(base_offset);
+        index->compressed.push_back(compressed);
+        index->log_paths.push_back(std::move(log_path));
+        index->positions.push_back(std::move(positions));
+    }
+
+    state.index = index;
+    return index;
+}
+
+void WALLog::invalidate_segment_index(int32_t partition) {
+    PartitionState& state = partition_state(partition);
+    std::lock_guard<std::mutex> lock(state.index_mutex);
+    state.index.reset();
+    notify_->segment_generation.fetch_add(1, std::memory_order_release);
+}
+
+std::shared_ptr<const MappedSegment> WALLog::get_mapped_segment(int32_t partition, int64_t base_offset,
+                                                                const std::string& log_path) {
+    PartitionState& state = partition_state(partition);
+    std::lock_guard<std::mutex> lock(state.mapped_mutex);
+    auto it = state.mapped.find(base_offset);
+    if (it != state.mapped.end()) {
+        return it->second;
+    }
+
+    auto mapped = std::make_shared<MappedSegment>();
+    mapped->base_offset = base_offset;
+    if (!mapped->map(log_path, index_path_for(log_path))) {
+        return nullptr;
+    }
+
+    state.mapped[base_offset] = mapped;
+    return mapped;
+}
+
+void WALLog::drop_stale_mappings(int32_t partition, const SegmentIndex& index) {
+    PartitionState& state = partition_state(partition);
+    std::lock_guard<std::mutex> lock(state.mapped_mutex);
+
+    // Unmap segments that are no longer on disk (e.g. pruned), and raw
+    // mappings of segments since compressed, which would otherwise keep
+    // the deleted .log allocated
+    auto find = [&index](int64_t base_offset) -> int64_t {
+        auto it = std::lower_bound(index.base_offsets.begin(), index.base_offsets.end(), base_offset);
+        if (it == index.base_offsets.end() || *it != base_offset) return -1;
+        return it - index.base_offsets.begin();
+    };
+    for (auto mit = state.mapped.begin(); mit != state.mapped.end();) {
+        int64_t i = find(mit->first);
+        mit = (i >= 0 && !index.compressed[i]) ? std::next(mit) : state.mapped.erase(mit);
+    }
+    for (auto cit = state.compressed.begin(); cit != state.compressed.end();) {
+        cit = find(cit->first) >= 0 ? std::next(cit) : state.compressed.erase(cit);
+    }
+    if (state.last_block && find(state.last_block->base_offset) < 0) {
+        state.last_block.reset();
+    }
+}
+
+std::shared_ptr<const CompressedSegment> WALLog::get_compressed_segment(int32_t partition, int64_t base_offset,
+                                                                        const std::string& log_path) {
+    PartitionState& state = partition_state(partition);
+    std::lock_guard<std::mutex> lock(state.mapped_mutex);
+    auto it = state.compressed.find(base_offset);
+    if (it != state.compressed.end()) {
+        return it->second;
+    }
+
+    auto segment = std::make_shared<CompressedSegment>();
+    if (!segment->open(log_path)) {
+        return nullptr;
+    }
+    state.compressed[base_offset] = segment;
+    return segment;
+}
+
+int64_t WALLog::find_position_mapped(const MappedSegment& mapped, int64_t offset) {
+    // Binary search the mapped index for the first entry >= offset
+    int64_t num_entries = static_cast<int64_t>(mapped.idx_size) / INDEX_ENTRY_SIZE;
+    int64_t left = 0, right = num_entries - 1;
+    int64_t file_position = -1;
+
+    while (left <= right) {
+        int64_t mid = left + (right - left) / 2;
+        int64_t idx_offset;
+        int64_t idx_position;
+        std::memcpy(&idx_offset, mapped.idx_data + mid * INDEX_ENTRY_SIZE, sizeof(idx_offset));
+        std::memcpy(&idx_position, mapped.idx_data + mid * INDEX_ENTRY_SIZE + sizeof(idx_offset),
+                    sizeof(idx_position));
+
+        if (idx_offset < offset) {
+            left = mid + 1;
+        } else {
+            file_position = idx_position;
+            right = mid - 1;
+        }
+    }
+    return file_position;
+}
+
+int64_t WALLog::find_position_stream(const std::string& idx_path, int64_t offset) {
+    // Read index to find position (optimized with binary search on file)
+    std::ifstream idx_file(idx_path, std::ios::binary);
+    if (!idx_file.is_open()) return -1;
+
+    // Get file size for binary search
+    idx_file.seekg(0, std::ios::end);
+    std::streampos file_size = idx_file.tellg();
+    if (file_size < INDEX_ENTRY_SIZE) return -1;
     
-    // Update cache
-    segment_cache_[partition] = segments;
-    cache_timestamp_ = now;
+    // Binary search for the offset
+    int64_t file_position = -1;
+    int64_t num_entries = file_size / INDEX_ENTRY_SIZE;
+    int64_t left = 0, right = num_entries - 1;
     
-    return segments;
+    while (left <= right) {
+        int64_t mid = left + (right - left) / 2;
+        idx_file.seekg(mid * INDEX_ENTRY_SIZE, std::ios::beg);
+        
+        int64_t idx_offset;
+        int64_t idx_position;
+        idx_file.read(reinterpret_cast<char*>(&idx_offset), sizeof(idx_offset));
+        idx_file.read(reinterpret_cast<char*>(&idx_position), sizeof(idx_position));
+        
+        if (idx_file.fail()) break;
+        
+        if (idx_offset < offset) {
+            left = mid + 1;
+        } else {
+            file_position = idx_position;
+            right = mid - 1;
+        }
+    }
+    return file_position;
 }
 
-std::vector<SpoolRecord> WALLog::read(int32_t partition, int64_t offset, int64_t max_records) {
-    std::lock_guard<std::mutex> lock(mutex_);
+bool WALLog::read_mapped_records(const MappedSegment& mapped, int64_t file_position, int64_t offset,
+                                 int64_t max_records, RecordSlots& records) {
+    // Parse records straight from the mapped bytes
+    size_t pos = static_cast<size_t>(file_position);
+    while (records.count < static_cast<size_t>(max_records) && pos < mapped.log_size) {
+        RecordFrame frame;
+        FrameStatus status = parse_record_frame(mapped.log_data + pos, mapped.log_size - pos, frame);
+        if (status == FrameStatus::END) break;
+        if (status == FrameStatus::OK) {
+            records.parse(frame.payload, frame.payload_size, offset);
+        } else {
+            report_corrupt_record("segment_" + std::to_string(mapped.base_offset), static_cast<int64_t>(pos));
+        }
+        pos += frame.size;
+    }
+    return true;
+}
 
-    std::vector<SpoolRecord> records;
+bool WALLog::read_stream_records(const std::string& log_path, int64_t file_position, int64_t offset,
+                                 int64_t max_records, RecordSlots& records) {
+    std::ifstream log_file(log_path, std::ios::binary);
+    if (!log_file.is_open()) return false;
+
+    log_file.seekg(file_position, std::ios::beg);
     
-    // Use cached segment list
-    auto segments = get_segments_for_partition(partition);
-    if (segments.empty()) {
-        return records;
+    // Frame header and payload are read into one buffer and parsed together
+    std::string buffer;
+    int64_t pos = file_position;
+    while (records.count < static_cast<size_t>(max_records) && !log_file.eof()) {
+        uint32_t length;
+        if (!log_file.read(reinterpret_cast<char*>(&length), sizeof(length))) break;
+        size_t header = (length & RECORD_CHECKSUMMED) ? RECORD_FRAME_HEADER_SIZE : sizeof(length);
+        buffer.resize(header + (length & RECORD_LENGTH_MASK));
+        std::memcpy(&buffer[0], &length, sizeof(length));
+        if (!log_file.read(&buffer[sizeof(length)], static_cast<std::streamsize>(buffer.size() - sizeof(length)))) break;
+
+        RecordFrame frame;
+        FrameStatus status = parse_record_frame(buffer.data(), buffer.size(), frame);
+        if (status == FrameStatus::END) break;
+        if (status == FrameStatus::OK) {
+            records.parse(frame.payload, frame.payload_size, offset);
+        } else {
+            report_corrupt_record(log_path, pos);
+        }
+        pos += static_cast<int64_t>(frame.size);
     }
+    return true;
+}
 
-    // Read from appropriate segment(s)
-    for (const auto& [seg_base, log_path] : segments) {
-        if (offset < seg_base) continue;
-        
-        std::string idx_path = log_path;
-        idx_path.replace(idx_path.size() - 4, 4, ".idx");
+bool WALLog::read_compressed_records(int32_t partition, int64_t base_offset, const CompressedSegment& segment,
+                                     int64_t file_position, int64_t offset, int64_t max_records,
+                                     RecordSlots& records) {
+    PartitionState& state = partition_state(partition);
+    const auto& blocks = segment.blocks();
+    int64_t first = segment.find_block(file_position);
+    if (first < 0) return true; // Past the end
 
-        // Read index to find position (optimized with binary search on file)
-        std::ifstream idx_file(idx_path, std::ios::binary);
-        if (!idx_file.is_open()) continue;
+    // Decompress only the blocks the read reaches
+    int64_t pos = file_position;
+    for (size_t b = static_cast<size_t>(first);
+         b < blocks.size() && records.count < static_cast<size_t>(max_records); ++b) {
+        std::shared_ptr<const PartitionState::DecompressedBlock> block;
+        {
+            std::lock_guard<std::mutex> lock(state.mapped_mutex);
+            if (state.last_block && state.last_block->base_offset == base_offset && state.last_block->block == b) {
+                block = state.last_block;
+            }
+        }
+        if (!block) {
+            auto fresh = std::make_shared<PartitionState::DecompressedBlock>();
+            fresh->base_offset = base_offset;
+            fresh->block = b;
+            if (!segment.decompress(b, fresh->data)) {
+                std::cerr << "Corrupt block " << b << " in spool segment " << base_offset
+                          << " of partition " << partition << std::endl;
+                return false;
+            }
+            block = fresh;
+            std::lock_guard<std::mutex> lock(state.mapped_mutex);
+            state.last_block = block;
+        }
 
-        // Get file size for binary search
-        idx_file.seekg(0, std::ios::end);
-        std::streampos file_size = idx_file.tellg();
-        if (file_size < INDEX_ENTRY_SIZE) continue;
-        
-        // Binary search for the offset
-        int64_t file_position = 0;
-        bool found = false;
-        int64_t num_entries = file_size / INDEX_ENTRY_SIZE;
-        int64_t left = 0, right = num_entries - 1;
-        
-        while (left <= right) {
-            int64_t mid = left + (right - left) / 2;
-            idx_file.seekg(mid * INDEX_ENTRY_SIZE, std::ios::beg);
-            
-            int64_t idx_offset;
-            int64_t idx_position;
-            idx_file.read(reinterpret_cast<char*>(&idx_offset), sizeof(idx_offset));
-            idx_file.read(reinterpret_cast<char*>(&idx_position), sizeof(idx_position));
-            
-            if (idx_file.fail()) break;
-            
-            if (idx_offset < offset) {
-                left = mid + 1;
+        const std::string& data = block->data;
+        size_t at = static_cast<size_t>(std::max(pos - blocks[b].raw_position, int64_t{0}));
+        while (records.count < static_cast<size_t>(max_records) && at < data.size()) {
+            RecordFrame frame;
+            FrameStatus status = parse_record_frame(data.data() + at, data.size() - at, frame);
+            if (status == FrameStatus::END) break;
+            if (status == FrameStatus::OK) {
+                records.parse(frame.payload, frame.payload_size, offset);
             } else {
-                file_position = idx_position;
-                found = true;
-                right = mid - 1;
+                report_corrupt_record(segment_path(partition, base_offset, ".logz"),
+                                      blocks[b].raw_position + static_cast<int64_t>(at));
             }
+            at += frame.size;
         }
-        
-        if (!found) continue;
+        pos = blocks[b].raw_position + blocks[b].raw_size;
+    }
+    return true;
+}
 
-        // Read from log file
-        std::ifstream log_file(log_path, std::ios::binary);
-        if (!log_file.is_open()) continue;
+void WALLog::RecordSlots::parse(const char* data, size_t size, int64_t min_offset) {
+    if (count == slots.size()) {
+        slots.emplace_back();
+    }
+    SpoolRecord& record = slots[count];
+    if (record.ParseFromArray(data, static_cast<int>(size)) && record.offset() >= min_offset) {
+        ++count;
+    }
+}
 
-        log_file.seekg(file_position, std::ios::beg);
-        
-        while (records.size() < static_cast<size_t>(max_records) && !log_file.eof()) {
-            uint32_t length;
-            log_file.read(reinterpret_cast<char*>(&length), sizeof(length));
-            if (log_file.fail() || length == 0) break;
-
-            std::string buffer(length, '\0');
-            log_file.read(&buffer[0], length);
-            if (log_file.fail()) break;
-
-            SpoolRecord record;
-            if (record.ParseFromString(buffer)) {
-                if (record.offset() >= offset) {
-                    records.push_back(record);
+std::vector<SpoolRecord> WALLog::read(int32_t partition, int64_t offset, int64_t max_records) {
+    std::vector<SpoolRecord> records;
+    records.resize(read_into(partition, offset, max_records, records));
+    return records;
+}
+
+size_t WALLog::read_into(int32_t partition, int64_t offset, int64_t max_records, std::vector<SpoolRecord>& slots) {
+    RecordSlots records{slots};
+    PartitionState& state = partition_state(partition);
+
+    // Make buffered appends to the active segment visible to this read. The
+    // partition lock is only held for the flush; the file reads below run
+    // concurrently with appends (index entries are written after their records).
+    int64_t active_base = -1;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.active) {
+            flush_segment_buffers(state.active.get());
+            active_base = state.active->base_offset;
+        }
+    }
+    
+    // A segment can be compressed, and its .log removed, between listing
+    // and opening it; the read then resumes once on a fresh index
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        auto index = get_segment_index(partition);
+        if (!index || index->base_offsets.empty()) {
+            return records.count;
+        }
+        drop_stale_mappings(partition, *index);
+
+        int64_t next = records.count == 0 ? offset : records.back().offset() + 1;
+        bool complete = true;
+
+        // Start at the segment containing next
+        const auto& bases = index->base_offsets;
+        size_t first = std::upper_bound(bases.begin(), bases.end(), next) - bases.begin();
+        if (first > 0) --first;
+
+        for (size_t i = first; i < bases.size(); ++i) {
+            const std::string& log_path = index->log_paths[i];
+            const auto& positions = index->positions[i];
+            bool compressed = index->compressed[i];
+
+            // Only the last segment can still be growing; everything before it is sealed
+            bool sealed = compressed || (i + 1 < bases.size() && bases[i] != active_base);
+            std::shared_ptr<const MappedSegment> mapped;
+            std::shared_ptr<const CompressedSegment> segment;
+            if (compressed) {
+                segment = get_compressed_segment(partition, bases[i], log_path);
+                if (!segment) {
+                    complete = false;
+                    break;
                 }
+            } else if (sealed && config_.use_mmap_reads) {
+                mapped = get_mapped_segment(partition, bases[i], log_path);
             }
+
+            // Resolve the starting file position: direct arithmetic on the
+            // resident positions of sealed segments, index search otherwise.
+            // Compressed segments keep their raw positions.
+            int64_t start_offset = std::max(next, bases[i]);
+            int64_t file_position = -1;
+            if (sealed && positions) {
+                int64_t rel = start_offset - bases[i];
+                if (rel >= static_cast<int64_t>(positions->size())) continue;
+                file_position = (*positions)[rel];
+            } else if (mapped) {
+                file_position = find_position_mapped(*mapped, start_offset);
+            } else {
+                file_position = find_position_stream(index_path_for(log_path), start_offset);
+            }
+            if (file_position < 0) continue;
+
+            bool read_ok;
+            if (segment) {
+                read_ok = read_compressed_records(partition, bases[i], *segment, file_position, next,
+                                                  max_records, records);
+            } else if (mapped) {
+                read_ok = read_mapped_records(*mapped, file_position, next, max_records, records);
+            } else {
+                read_ok = read_stream_records(log_path, file_position, next, max_records, records);
+            }
+            if (!read_ok) {
+                // Stop rather than skip ahead, so records stay contiguous
+                complete = false;
+                break;
+            }
+
+            if (records.count >= static_cast<size_t>(max_records)) break;
         }
 
-        if (records.size() >= static_cast<size_t>(max_records)) break;
+        if (complete || records.count >= static_cast<size_t>(max_records)) break;
+        // The listing went stale under this read (e.g. a .log compressed
+        // away); relist without bumping everyone's generation
+        std::lock_guard<std::mutex> index_lock(state.index_mutex);
+        state.index.reset();
     }
 
-    return records;
+    return records.count;
+}
+
+std::vector<TimeIndexEntry> WALLog::load_time_index(int32_t partition, int64_t base_offset) {
+    std::vector<TimeIndexEntry> entries;
+    std::ifstream file(segment_path(partition, base_offset, ".tix"), std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return entries;
+    }
+    // Whole entries only; a torn last one is ignored
+    entries.resize(static_cast<size_t>(file.tellg()) / sizeof(TimeIndexEntry));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(entries.data()),
+              static_cast<std::streamsize>(entries.size() * sizeof(TimeIndexEntry)));
+    if (!file) {
+        entries.clear();
+    }
+    return entries;
+}
+
+int64_t WALLog::seek_by_time(int32_t partition, int64_t ts_ns, TimeField field) {
+    int64_t end = get_high_water_mark(partition) + 1;
+    auto index = get_segment_index(partition);
+    if (!index) {
+        return std::max<int64_t>(end, 0);
+    }
+    auto reaches = [&](int64_t ts_capture, int64_t ts_append) {
+        return (field == TimeField::CAPTURE ? ts_capture : ts_append) >= ts_ns;
+    };
+
+    // First record in [from, to) at or after ts_ns, or -1
+    std::vector<SpoolRecord> records;
+    auto scan = [&](int64_t from, int64_t to) -> int64_t {
+        while (from < to) {
+            size_t n = read_into(partition, from, std::min<int64_t>(to - from, 1024), records);
+            if (n == 0) {
+                return -1;
+            }
+            for (size_t i = 0; i < n && records[i].offset() < to; ++i) {
+                if (reaches(records[i].message().ts_capture(), records[i].ts_append())) {
+                    return records[i].offset();
+                }
+            }
+            from = records[n - 1].offset() + 1;
+        }
+        return -1;
+    };
+
+    for (size_t i = 0; i < index->base_offsets.size(); ++i) {
+        int64_t base = index->base_offsets[i];
+        int64_t segment_end = i + 1 < index->base_offsets.size() ? index->base_offsets[i + 1] : end;
+        int64_t covered = base;  // Records before this have been ruled out
+        for (const auto& entry : load_time_index(partition, base)) {
+            if (entry.offset < covered || entry.count <= 0 || entry.offset + entry.count > segment_end) {
+                continue;  // Not a block of this segment's records
+            }
+            int64_t found = entry.offset > covered ? scan(covered, entry.offset) : -1;
+            if (found < 0 && reaches(entry.max_ts_capture, entry.max_ts_append)) {
+                found = scan(entry.offset, entry.offset + entry.count);
+            }
+            if (found >= 0) {
+                return found;
+            }
+            covered = entry.offset + entry.count;
+        }
+        if (int64_t found = covered < segment_end ? scan(covered, segment_end) : -1; found >= 0) {
+            return found;
+        }
+    }
+    return std::max<int64_t>(end, 0);
+}
+
+void WALLog::read_ahead(int32_t partition, int64_t offset, int64_t bytes) {
+    if (bytes <= 0) return;
+    auto index = get_segment_index(partition);
+    if (!index || index->base_offsets.empty()) return;
+
+    const auto& bases = index->base_offsets;
+    size_t i = std::upper_bound(bases.begin(), bases.end(), offset) - bases.begin();
+    if (i == 0) return;
+    --i;
+
+    // Where offset's record starts; a read that has just finished a sealed
+    // segment carries on at the start of the next
+    const auto& positions = index->positions[i];
+    int64_t position;
+    if (positions) {
+        int64_t rel = offset - bases[i];
+        if (rel < static_cast<int64_t>(positions->size())) {
+            position = (*positions)[rel];
+        } else if (i + 1 < bases.size()) {
+            ++i;
+            position = 0;
+        } else {
+            return;
+        }
+    } else {
+        position = find_position_stream(index_path_for(index->log_paths[i]), offset);
+    }
+    if (position < 0) return;
+
+    const std::string& log_path = index->log_paths[i];
+    if (index->compressed[i]) {
+        if (auto segment = get_compressed_segment(partition, bases[i], log_path)) {
+            segment->read_ahead(position, bytes);
+        }
+        return;
+    }
+    // Sealed segments (those with resident positions) are mapped for reads
+    if (index->positions[i] && config_.use_mmap_reads) {
+        if (auto mapped = get_mapped_segment(partition, bases[i], log_path)) {
+            advise_will_need(mapped->log_data, mapped->log_size, position, bytes);
+            return;
+        }
+    }
+#if defined(POSIX_FADV_WILLNEED)
+    int fd = ::open(log_path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::posix_fadvise(fd, position, bytes, POSIX_FADV_WILLNEED);
+        ::close(fd);
+    }
+#endif
 }
 
 void WALLog::commit_offset(const std::string& group, int32_t partition, int64_t offset) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> lock(offsets_mutex_);
     consumer_offsets_[group][partition] = offset;
     save_consumer_offset(group, partition, offset);
 }
 
 int64_t WALLog::load_offset(const std::string& group, int32_t partition) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> lock(offsets_mutex_);
     auto it = consumer_offsets_.find(group);
     if (it != consumer_offsets_.end()) {
         auto pit = it->second.find(partition);
@@ -430,6 +1778,18 @@ int64_t WALLog::load_offset(const std::string& group, int32_t partition) {
     return 0;
 }
 
+int64_t WALLog::reload_offset(const std::string& group, int32_t partition) {
+    std::string file_group;
+    int32_t file_partition;
+    int64_t offset;
+    if (!parse_offset_file(offset_file_path(group, partition), file_group, file_partition, offset)) {
+        return load_offset(group, partition);
+    }
+    std::lock_guard<std::mutex> lock(offsets_mutex_);
+    consumer_offsets_[group][partition] = offset;
+    return offset;
+}
+
 std::string WALLog::offset_file_path(const std::string& group, int32_t partition) {
     fs::path p(config_.base_dir);
     p /= "offsets";
@@ -442,22 +1802,11 @@ void WALLog::load_consumer_offsets() {
     if (!fs::exists(offsets_dir)) return;
 
     for (const auto& entry : fs::directory_iterator(offsets_dir)) {
-        if (entry.path().extension() == ".offset") {
-            std::string filename = entry.path().stem().string();
-            size_t pos = filename.find("_p");
-            if (pos != std::string::npos) {
-                std::string group = filename.substr(0, pos);
-                int32_t partition = std::stoi(filename.substr(pos + 2));
-                
-                std::ifstream file(entry.path(), std::ios::binary);
-                if (file.is_open()) {
-                    int64_t offset;
-                    file.read(reinterpret_cast<char*>(&offset), sizeof(offset));
-                    if (!file.fail()) {
-                        consumer_offsets_[group][partition] = offset;
-                    }
-                }
-            }
+        std::string group;
+        int32_t partition;
+        int64_t offset;
+        if (parse_offset_file(entry.path(), group, partition, offset)) {
+            consumer_offsets_[group][partition] = offset;
         }
     }
 }
@@ -466,35 +1815,198 @@ void WALLog::save_consumer_offset(const std::string& group, int32_t partition, i
     fs::path offsets_dir = fs::path(config_.base_dir) / "offsets";
     ensure_directory(offsets_dir.string());
     
+    // The 8 bytes are overwritten in place rather than truncated and
+    // rewritten, so a consumer in another process taking over the
+    // partition (reload_offset) never reads an empty file
     std::string path = offset_file_path(group, partition);
-    std::ofstream file(path, std::ios::binary);
-    if (file.is_open()) {
-        file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return;
+    }
+    if (::pwrite(fd, &offset, sizeof(offset), 0) != static_cast<ssize_t>(sizeof(offset))) {
+        std::cerr << "Failed to write consumer offset " << path << ": " << std::strerror(errno) << std::endl;
+    }
+    ::close(fd);
+}
+
+void WALLog::load_catalog() {
+    for (int32_t p = 0; p < config_.num_partitions; ++p) {
+        fs::path part_dir = fs::path(config_.base_dir) / ("partition_" + std::to_string(p));
+        std::map<int64_t, fs::path> segments; // A .logz wins over a .log left beside it
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(part_dir, ec)) {
+            if (is_segment_log(entry.path())) {
+                fs::path& path = segments[std::stoll(entry.path().stem().string().substr(8))];
+                if (path.empty() || entry.path().extension() == ".logz") {
+                    path = entry.path();
+                }
+            }
+        }
+
+        // Segments from before the restart are sealed; age runs from
+        // their last write
+        PartitionState& state = *partitions_[p];
+        for (const auto& [base_offset, path] : segments) {
+            auto idx_size = fs::file_size(index_path_for(path.string()), ec);
+            if (ec) idx_size = 0;
+            auto log_size = fs::file_size(path, ec);
+            if (ec) log_size = 0;
+            auto mtime = fs::last_write_time(path, ec);
+            auto sealed_at = ec ? std::chrono::system_clock::now()
+                                : std::chrono::file_clock::to_sys(mtime);
+            int64_t end_offset = base_offset + static_cast<int64_t>(idx_size / INDEX_ENTRY_SIZE);
+            state.catalog.push_back({base_offset, end_offset,
+                                     static_cast<int64_t>(log_size + idx_size),
+                                     std::chrono::time_point_cast<std::chrono::system_clock::duration>(sealed_at)});
+        }
+    }
+}
+
+std::unordered_map<int32_t, int64_t> WALLog::min_committed_offsets() {
+    // Consumers in other processes commit through the offset files, so
+    // read those rather than trust this process's view
+    std::unordered_map<std::string, std::unordered_map<int32_t, int64_t>> offsets;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(fs::path(config_.base_dir) / "offsets", ec)) {
+        std::string group;
+        int32_t partition;
+        int64_t offset;
+        if (parse_offset_file(entry.path(), group, partition, offset)) {
+            offsets[group][partition] = offset;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(offsets_mutex_);
+        for (const auto& [group, partitions] : consumer_offsets_) {
+            for (const auto& [partition, offset] : partitions) {
+                int64_t& known = offsets[group][partition];
+                known = std::max(known, offset);
+            }
+        }
+    }
+
+    std::unordered_map<int32_t, int64_t> min_offsets;
+    for (const auto& [group, partitions] : offsets) {
+        for (const auto& [partition, offset] : partitions) {
+            auto [it, inserted] = min_offsets.emplace(partition, offset);
+            if (!inserted) it->second = std::min(it->second, offset);
+        }
     }
+    return min_offsets;
 }
 
-void WALLog::prune_old_segments() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    // Implementation: remove segments older than retention policy
-    // Simplified for prototype
+void WALLog::retention_loop() {
+    std::unique_lock<std::mutex> lock(retention_mutex_);
+    while (!retention_stopping_) {
+        retention_cv_.wait_for(lock, config_.retention_interval, [this]() { return retention_stopping_; });
+        if (retention_stopping_) break;
+        lock.unlock();
+        try {
+            prune_old_segments();
+        } catch (const std::exception& e) {
+            std::cerr << "Spool retention failed: " << e.what() << std::endl;
+        }
+        lock.lock();
+    }
+}
+
+size_t WALLog::prune_old_segments() {
+    std::lock_guard<std::mutex> files_lock(segment_files_mutex_);
+    auto now = std::chrono::system_clock::now();
+    std::unordered_map<int32_t, int64_t> committed;
+    if (config_.retain_unconsumed) {
+        committed = min_committed_offsets();
+    }
+
+    // Every sealed segment but the newest of each partition, oldest first
+    struct Candidate {
+        int32_t partition;
+        PartitionState::CatalogEntry entry;
+    };
+    std::vector<Candidate> candidates;
+    int64_t total_bytes = 0;
+    for (int32_t p = 0; p < static_cast<int32_t>(partitions_.size()); ++p) {
+        PartitionState& state = *partitions_[p];
+        std::lock_guard<std::mutex> catalog_lock(state.catalog_mutex);
+        for (size_t i = 0; i < state.catalog.size(); ++i) {
+            total_bytes += state.catalog[i].bytes;
+            if (i + 1 < state.catalog.size()) {
+                candidates.push_back({p, state.catalog[i]});
+            }
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.entry.sealed_at < b.entry.sealed_at;
+    });
+
+    std::vector<Candidate> doomed;
+    for (const auto& candidate : candidates) {
+        bool over_size = config_.max_retention_bytes > 0 && total_bytes > config_.max_retention_bytes;
+        bool over_age = config_.max_retention_seconds > 0 &&
+                        now - candidate.entry.sealed_at > std::chrono::seconds(config_.max_retention_seconds);
+        if (!over_size && !over_age) {
+            break; // Later candidates are younger and the total is within bounds
+        }
+        if (config_.retain_unconsumed) {
+            auto it = committed.find(candidate.partition);
+            if (it == committed.end() || it->second < candidate.entry.end_offset) {
+                continue; // Unconsumed; so is everything after it in this partition
+            }
+        }
+        doomed.push_back(candidate);
+        total_bytes -= candidate.entry.bytes;
+    }
+    if (doomed.empty()) {
+        return 0;
+    }
+
+    // Out of the catalog and the read index before the files go; a read
+    // that still has a deleted path retries on a fresh index
+    for (const auto& candidate : doomed) {
+        PartitionState& state = *partitions_[candidate.partition];
+        std::lock_guard<std::mutex> catalog_lock(state.catalog_mutex);
+        auto it = std::find_if(state.catalog.begin(), state.catalog.end(), [&](const auto& entry) {
+            return entry.base_offset == candidate.entry.base_offset;
+        });
+        if (it != state.catalog.end()) {
+            state.catalog.erase(it);
+        }
+    }
+    for (const auto& candidate : doomed) {
+        invalidate_segment_index(candidate.partition);
+    }
+    for (const auto& candidate : doomed) {
+        for (const char* suffix : {".log", ".logz", ".idx", ".tix"}) {
+            std::error_code ec;
+            fs::remove(segment_path(candidate.partition, candidate.entry.base_offset, suffix), ec);
+        }
+        invalidate_segment_index(candidate.partition);
+    }
+    return doomed.size();
+}
+
+size_t WALLog::segment_count(int32_t partition) {
+    auto index = get_segment_index(partition);
+    return index ? index->base_offsets.size() : 0;
 }
 
 int64_t WALLog::get_high_water_mark(int32_t partition) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    // First check in-memory active segments
-    auto it = active_segments_.find(partition);
-    if (it != active_segments_.end()) {
-        return it->second->current_offset - 1;
+    // First check in-memory active segment
+    {
+        PartitionState& state = partition_state(partition);
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.active) {
+            return state.active->current_offset - 1;
+        }
     }
     
     // If not in memory, scan filesystem to find the highest offset
     fs::path part_dir = fs::path(config_.base_dir) / ("partition_" + std::to_string(partition));
     if (!fs::exists(part_dir)) {
-        return 0;
+        return -1;
     }
     
-    int64_t max_offset = 0;
+    int64_t max_offset = -1;
     
     // Find all segments and check their indexes
     for (const auto& entry : fs::directory_iterator(part_dir)) {
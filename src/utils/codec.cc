@@ -0,0 +1,428 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: codec.cc
+ * Description: Implementation of the hex and TBCD codecs. Vector kernels
+ *              work on 16-byte blocks (32 for AVX2 hex); a hex input or tail
+ *              short of a block is padded into one, while TBCD under a
+ *              block takes the scalar loop. The kernel is picked once at
+ *              startup.
+ */
+
+#include "s1see/utils/codec.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define S1SEE_CODEC_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define S1SEE_CODEC_NEON 1
+#endif
+
+namespace s1see {
+namespace utils {
+
+namespace {
+    constexpr char HEX_DIGITS[] = "0123456789abcdef";
+    constexpr uint8_t INVALID = 0xff;
+
+    constexpr std::array<uint8_t, 256> make_hex_values() {
+        std::array<uint8_t, 256> values{};
+        for (auto& value : values) value = INVALID;
+        for (int c = '0'; c <= '9'; ++c) values[c] = static_cast<uint8_t>(c - '0');
+        for (int c = 'a'; c <= 'f'; ++c) values[c] = static_cast<uint8_t>(c - 'a' + 10);
+        for (int c = 'A'; c <= 'F'; ++c) values[c] = static_cast<uint8_t>(c - 'A' + 10);
+        return values;
+    }
+    constexpr auto HEX_VALUES = make_hex_values();
+
+    void hex_encode_scalar(const uint8_t* p, size_t size, char* out) {
+        for (size_t i = 0; i < size; ++i) {
+            out[2 * i] = HEX_DIGITS[p[i] >> 4];
+            out[2 * i + 1] = HEX_DIGITS[p[i] & 0x0f];
+        }
+    }
+
+    bool hex_decode_scalar(const char* hex, size_t bytes, uint8_t* out) {
+        for (size_t i = 0; i < bytes; ++i) {
+            uint8_t high = HEX_VALUES[static_cast<uint8_t>(hex[2 * i])];
+            uint8_t low = HEX_VALUES[static_cast<uint8_t>(hex[2 * i + 1])];
+            if (high == INVALID || low == INVALID) return false;
+            out[i] = static_cast<uint8_t>(high << 4 | low);
+        }
+        return true;
+    }
+
+    size_t tbcd_decode_scalar(const uint8_t* p, size_t size, char* out) {
+        size_t n = 0;
+        for (size_t i = 0; i < size; ++i) {
+            uint8_t low = p[i] & 0x0f;
+            uint8_t high = p[i] >> 4;
+            if (low > 9) break;
+            out[n++] = static_cast<char>('0' + low);
+            if (high > 9) break;
+            out[n++] = static_cast<char>('0' + high);
+        }
+        return n;
+    }
+
+    enum class Kernel { SCALAR = 0, SSSE3, AVX2, NEON };
+
+#if defined(S1SEE_CODEC_X86)
+    // 16 bytes -> 32 hex characters
+    __attribute__((target("ssse3")))
+    inline void hex_encode_block_ssse3(const uint8_t* p, char* out) {
+        const __m128i table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(HEX_DIGITS));
+        const __m128i nibble = _mm_set1_epi8(0x0f);
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i high = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+        __m128i low = _mm_shuffle_epi8(table, _mm_and_si128(v, nibble));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi8(high, low));
+    }
+
+    __attribute__((target("ssse3")))
+    void hex_encode_ssse3(const uint8_t* p, size_t size, char* out) {
+        size_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            hex_encode_block_ssse3(p + i, out + 2 * i);
+        }
+        if (i < size) {
+            uint8_t block[16] = {};
+            char chars[32];
+            std::memcpy(block, p + i, size - i);
+            hex_encode_block_ssse3(block, chars);
+            std::memcpy(out + 2 * i, chars, 2 * (size - i));
+        }
+    }
+
+    __attribute__((target("avx2")))
+    void hex_encode_avx2(const uint8_t* p, size_t size, char* out) {
+        const __m256i table = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(HEX_DIGITS)));
+        const __m256i nibble = _mm256_set1_epi8(0x0f);
+        size_t i = 0;
+        for (; i + 32 <= size; i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+            __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+            __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(v, nibble));
+            // Unpacking works within 128-bit lanes; put the lanes back in order
+            __m256i first = _mm256_unpacklo_epi8(high, low);   // Bytes 0-7 | 16-23
+            __m256i second = _mm256_unpackhi_epi8(high, low);  // Bytes 8-15 | 24-31
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i),
+                                _mm256_permute2x128_si256(first, second, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i + 32),
+                                _mm256_permute2x128_si256(first, second, 0x31));
+        }
+        hex_encode_ssse3(p + i, size - i, out + 2 * i);
+    }
+
+    // 16 hex characters -> their nibble values; false if any is not hex
+    __attribute__((target("ssse3")))
+    inline bool hex_values_ssse3(__m128i c, __m128i& values) {
+        __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+        __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+        __m128i alpha = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+        __m128i is_alpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+        values = _mm_or_si128(_mm_and_si128(is_digit, digit),
+                              _mm_and_si128(is_alpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+        return _mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) == 0xffff;
+    }
+
+    // 32 hex characters -> 16 bytes
+    __attribute__((target("ssse3")))
+    inline bool hex_decode_block_ssse3(const char* hex, uint8_t* out) {
+        __m128i first, second;
+        bool ok = hex_values_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex)), first);
+        ok &= hex_values_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + 16)), second);
+        // Each pair of nibbles: high * 16 + low
+        const __m128i weights = _mm_set1_epi16(0x0110);
+        __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(first, weights),
+                                         _mm_maddubs_epi16(second, weights));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bytes);
+        return ok;
+    }
+
+    __attribute__((target("ssse3")))
+    bool hex_decode_ssse3(const char* hex, size_t bytes, uint8_t* out) {
+        size_t i = 0;
+        for (; i + 16 <= bytes; i += 16) {
+            if (!hex_decode_block_ssse3(hex + 2 * i, out + i)) return false;
+        }
+        if (i < bytes) {
+            char chars[32];
+            uint8_t block[16];
+            std::memset(chars, '0', sizeof(chars));
+            std::memcpy(chars, hex + 2 * i, 2 * (bytes - i));
+            if (!hex_decode_block_ssse3(chars, block)) return false;
+            std::memcpy(out + i, block, bytes - i);
+        }
+        return true;
+    }
+
+    // 32 hex characters -> their nibble values; clears ok if any is not hex
+    __attribute__((target("avx2")))
+    inline __m256i hex_values_avx2(__m256i c, bool& ok) {
+        __m256i digit = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+        __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+        __m256i alpha = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+        __m256i is_alpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+        ok &= _mm256_movemask_epi8(_mm256_or_si256(is_digit, is_alpha)) == -1;
+        return _mm256_or_si256(_mm256_and_si256(is_digit, digit),
+                               _mm256_and_si256(is_alpha, _mm256_add_epi8(alpha, _mm256_set1_epi8(10))));
+    }
+
+    __attribute__((target("avx2")))
+    bool hex_decode_avx2(const char* hex, size_t bytes, uint8_t* out) {
+        const __m256i weights = _mm256_set1_epi16(0x0110);
+        size_t i = 0;
+        for (; i + 32 <= bytes; i += 32) {
+            bool ok = true;
+            __m256i first = hex_values_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex + 2 * i)), ok);
+            __m256i second = hex_values_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex + 2 * i + 32)), ok);
+            if (!ok) return false;
+            // Packing works within 128-bit lanes; restore the quadword order
+            __m256i packed = _mm256_packus_epi16(_mm256_maddubs_epi16(first, weights),
+                                                 _mm256_maddubs_epi16(second, weights));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permute4x64_epi64(packed, 0xd8));
+        }
+        return hex_decode_ssse3(hex + 2 * i, bytes - i, out + i);
+    }
+
+    // 16 bytes -> 32 digits; returns a bit per digit that is not 0-9
+    __attribute__((target("ssse3")))
+    inline uint32_t tbcd_block_ssse3(const uint8_t* p, char* out) {
+        const __m128i nibble = _mm_set1_epi8(0x0f);
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i low = _mm_and_si128(v, nibble);
+        __m128i high = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+        __m128i first = _mm_unpacklo_epi8(low, high);  // Low nibble first
+        __m128i second = _mm_unpackhi_epi8(low, high);
+        const __m128i nine = _mm_set1_epi8(9);
+        uint32_t bad = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(first, nine))) |
+                       static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(second, nine))) << 16;
+        const __m128i zero_char = _mm_set1_epi8('0');
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_add_epi8(first, zero_char));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_add_epi8(second, zero_char));
+        return bad;
+    }
+
+    __attribute__((target("ssse3")))
+    size_t tbcd_decode_ssse3(const uint8_t* p, size_t size, char* out) {
+        size_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            uint32_t bad = tbcd_block_ssse3(p + i, out + 2 * i);
+            if (bad) return 2 * i + static_cast<size_t>(__builtin_ctz(bad));
+        }
+        if (i == size) return 2 * i;
+        uint8_t block[16];
+        char digits[32];
+        std::memset(block, 0xff, sizeof(block));  // Padding reads as filler
+        std::memcpy(block, p + i, size - i);
+        uint32_t bad = tbcd_block_ssse3(block, digits);
+        size_t n = static_cast<size_t>(__builtin_ctz(bad));  // Padding guarantees a bit
+        std::memcpy(out + 2 * i, digits, n);
+        return 2 * i + n;
+    }
+
+    Kernel detect() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return Kernel::AVX2;
+        if (__builtin_cpu_supports("ssse3")) return Kernel::SSSE3;
+        return Kernel::SCALAR;
+    }
+#elif defined(S1SEE_CODEC_NEON)
+    inline void hex_encode_block_neon(const uint8_t* p, char* out) {
+        const uint8x16_t table = vld1q_u8(reinterpret_cast<const uint8_t*>(HEX_DIGITS));
+        uint8x16_t v = vld1q_u8(p);
+        uint8x16x2_t chars;
+        chars.val[0] = vqtbl1q_u8(table, vshrq_n_u8(v, 4));
+        chars.val[1] = vqtbl1q_u8(table, vandq_u8(v, vdupq_n_u8(0x0f)));
+        vst2q_u8(reinterpret_cast<uint8_t*>(out), chars);  // Interleaves high, low
+    }
+
+    void hex_encode_neon(const uint8_t* p, size_t size, char* out) {
+        size_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            hex_encode_block_neon(p + i, out + 2 * i);
+        }
+        if (i < size) {
+            uint8_t block[16] = {};
+            char chars[32];
+            std::memcpy(block, p + i, size - i);
+            hex_encode_block_neon(block, chars);
+            std::memcpy(out + 2 * i, chars, 2 * (size - i));
+        }
+    }
+
+    inline uint8x16_t hex_values_neon(uint8x16_t c, uint8x16_t& valid) {
+        uint8x16_t digit = vsubq_u8(c, vdupq_n_u8('0'));
+        uint8x16_t is_digit = vcleq_u8(digit, vdupq_n_u8(9));
+        uint8x16_t alpha = vsubq_u8(vorrq_u8(c, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+        uint8x16_t is_alpha = vcleq_u8(alpha, vdupq_n_u8(5));
+        valid = vandq_u8(valid, vorrq_u8(is_digit, is_alpha));
+        return vbslq_u8(is_digit, digit, vaddq_u8(alpha, vdupq_n_u8(10)));
+    }
+
+    // 32 hex characters -> 16 bytes
+    inline bool hex_decode_block_neon(const char* hex, uint8_t* out) {
+        uint8x16x2_t chars = vld2q_u8(reinterpret_cast<const uint8_t*>(hex));  // Even, odd
+        uint8x16_t valid = vdupq_n_u8(0xff);
+        uint8x16_t high = hex_values_neon(chars.val[0], valid);
+        uint8x16_t low = hex_values_neon(chars.val[1], valid);
+        vst1q_u8(out, vorrq_u8(vshlq_n_u8(high, 4), low));
+        return vminvq_u8(valid) != 0;
+    }
+
+    bool hex_decode_neon(const char* hex, size_t bytes, uint8_t* out) {
+        size_t i = 0;
+        for (; i + 16 <= bytes; i += 16) {
+            if (!hex_decode_block_neon(hex + 2 * i, out + i)) return false;
+        }
+        if (i < bytes) {
+            char chars[32];
+            uint8_t block[16];
+            std::memset(chars, '0', sizeof(chars));
+            std::memcpy(chars, hex + 2 * i, 2 * (bytes - i));
+            if (!hex_decode_block_neon(chars, block)) return false;
+            std::memcpy(out + i, block, bytes - i);
+        }
+        return true;
+    }
+
+    // 16 bytes -> 32 digits; false if any nibble is above 9
+    inline bool tbcd_block_neon(const uint8_t* p, char* out) {
+        uint8x16_t v = vld1q_u8(p);
+        uint8x16x2_t digits;
+        digits.val[0] = vandq_u8(v, vdupq_n_u8(0x0f));  // Low nibble first
+        digits.val[1] = vshrq_n_u8(v, 4);
+        bool ok = vmaxvq_u8(vmaxq_u8(digits.val[0], digits.val[1])) <= 9;
+        digits.val[0] = vaddq_u8(digits.val[0], vdupq_n_u8('0'));
+        digits.val[1] = vaddq_u8(digits.val[1], vdupq_n_u8('0'));
+        vst2q_u8(reinterpret_cast<uint8_t*>(out), digits);
+        return ok;
+    }
+
+    size_t tbcd_decode_neon(const uint8_t* p, size_t size, char* out) {
+        size_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            if (!tbcd_block_neon(p + i, out + 2 * i)) break;
+        }
+        if (i == size) return 2 * i;
+        // The block with the filler, or the tail: written out, then cut at
+        // the first non-digit
+        uint8_t block[16];
+        char digits[32];
+        std::memset(block, 0xff, sizeof(block));
+        size_t rest = std::min<size_t>(size - i, 16);
+        std::memcpy(block, p + i, rest);
+        tbcd_block_neon(block, digits);
+        size_t n = 0;
+        while (n < 2 * rest && digits[n] <= '9') ++n;
+        std::memcpy(out + 2 * i, digits, n);
+        return 2 * i + n;
+    }
+
+    Kernel detect() {
+        return Kernel::NEON;  // Every AArch64 CPU has Advanced SIMD
+    }
+#else
+    Kernel detect() {
+        return Kernel::SCALAR;
+    }
+#endif
+
+    // Zero (scalar) until set, should another translation unit's static
+    // initialisation get here first
+    const Kernel KERNEL = detect();
+}
+
+void hex_encode(const uint8_t* data, size_t size, char* out) {
+    switch (KERNEL) {
+#if defined(S1SEE_CODEC_X86)
+        case Kernel::AVX2: return hex_encode_avx2(data, size, out);
+        case Kernel::SSSE3: return hex_encode_ssse3(data, size, out);
+#elif defined(S1SEE_CODEC_NEON)
+        case Kernel::NEON: return hex_encode_neon(data, size, out);
+#endif
+        default: return hex_encode_scalar(data, size, out);
+    }
+}
+
+std::string to_hex(std::span<const uint8_t> bytes) {
+    std::string hex(2 * bytes.size(), '\0');
+    hex_encode(bytes.data(), bytes.size(), hex.data());
+    return hex;
+}
+
+std::string to_hex(std::string_view bytes) {
+    return to_hex(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size()));
+}
+
+bool hex_decode(std::string_view hex, uint8_t* out) {
+    if (hex.size() % 2 != 0) {
+        return false;
+    }
+    size_t bytes = hex.size() / 2;
+    switch (KERNEL) {
+#if defined(S1SEE_CODEC_X86)
+        case Kernel::AVX2: return hex_decode_avx2(hex.data(), bytes, out);
+        case Kernel::SSSE3: return hex_decode_ssse3(hex.data(), bytes, out);
+#elif defined(S1SEE_CODEC_NEON)
+        case Kernel::NEON: return hex_decode_neon(hex.data(), bytes, out);
+#endif
+        default: return hex_decode_scalar(hex.data(), bytes, out);
+    }
+}
+
+std::vector<uint8_t> from_hex(std::string_view hex) {
+    std::vector<uint8_t> bytes(hex.size() / 2);
+    if (!hex_decode(hex, bytes.data())) {
+        bytes.clear();
+    }
+    return bytes;
+}
+
+size_t tbcd_decode(const uint8_t* data, size_t size, char* out) {
+    // Below a block, padding costs more than the loop (IMSIs are 8 bytes)
+    if (size < 16) {
+        return tbcd_decode_scalar(data, size, out);
+    }
+    switch (KERNEL) {
+#if defined(S1SEE_CODEC_X86)
+        case Kernel::AVX2:
+        case Kernel::SSSE3: return tbcd_decode_ssse3(data, size, out);
+#elif defined(S1SEE_CODEC_NEON)
+        case Kernel::NEON: return tbcd_decode_neon(data, size, out);
+#endif
+        default: return tbcd_decode_scalar(data, size, out);
+    }
+}
+
+std::string tbcd_to_string(std::span<const uint8_t> bytes) {
+    // Identifiers end in filler, so decoding on the stack and copying lets
+    // a 15-digit IMSI stay within the string's inline buffer
+    char stack[64];
+    if (bytes.size() <= sizeof(stack) / 2) {
+        return std::string(stack, tbcd_decode(bytes.data(), bytes.size(), stack));
+    }
+    std::string digits(2 * bytes.size(), '\0');
+    digits.resize(tbcd_decode(bytes.data(), bytes.size(), digits.data()));
+    return digits;
+}
+
+const char* codec_instruction_set() {
+    switch (KERNEL) {
+        case Kernel::AVX2: return "avx2";
+        case Kernel::SSSE3: return "ssse3";
+        case Kernel::NEON: return "neon";
+        default: return "scalar";
+    }
+}
+
+} // namespace utils
+} // namespace s1see
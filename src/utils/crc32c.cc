@@ -0,0 +1,133 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: crc32c.cc
+ * Description: Implementation of CRC-32C. The instruction path is picked
+ *              once at startup; the table path handles everything else and
+ *              produces the same values.
+ */
+
+#include "s1see/utils/crc32c.h"
+#include <array>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#define S1SEE_CRC32C_X86 1
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define S1SEE_CRC32C_ARM 1
+#endif
+
+namespace s1see {
+namespace utils {
+
+namespace {
+    constexpr uint32_t POLYNOMIAL = 0x82f63b78; // Castagnoli, reflected
+
+    // tables[k][b] is the CRC of byte b followed by k zero bytes
+    constexpr std::array<std::array<uint32_t, 256>, 8> make_tables() {
+        std::array<std::array<uint32_t, 256>, 8> tables{};
+        for (uint32_t b = 0; b < 256; ++b) {
+            uint32_t crc = b;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ ((crc & 1) ? POLYNOMIAL : 0);
+            }
+            tables[0][b] = crc;
+        }
+        for (uint32_t b = 0; b < 256; ++b) {
+            for (size_t k = 1; k < 8; ++k) {
+                tables[k][b] = (tables[k - 1][b] >> 8) ^ tables[0][tables[k - 1][b] & 0xff];
+            }
+        }
+        return tables;
+    }
+    constexpr auto TABLES = make_tables();
+
+    uint32_t crc32c_table(const uint8_t* p, size_t size, uint32_t crc) {
+        // Eight bytes per step (little-endian load)
+        while (size >= 8) {
+            uint64_t word;
+            std::memcpy(&word, p, sizeof(word));
+            word ^= crc;
+            crc = TABLES[7][word & 0xff] ^ TABLES[6][(word >> 8) & 0xff] ^
+                  TABLES[5][(word >> 16) & 0xff] ^ TABLES[4][(word >> 24) & 0xff] ^
+                  TABLES[3][(word >> 32) & 0xff] ^ TABLES[2][(word >> 40) & 0xff] ^
+                  TABLES[1][(word >> 48) & 0xff] ^ TABLES[0][word >> 56];
+            p += 8;
+            size -= 8;
+        }
+        while (size-- > 0) {
+            crc = (crc >> 8) ^ TABLES[0][(crc ^ *p++) & 0xff];
+        }
+        return crc;
+    }
+
+#if defined(S1SEE_CRC32C_X86)
+    __attribute__((target("sse4.2")))
+    uint32_t crc32c_instructions(const uint8_t* p, size_t size, uint32_t crc) {
+#if defined(__x86_64__)
+        uint64_t crc64 = crc;
+        while (size >= 8) {
+            uint64_t word;
+            std::memcpy(&word, p, sizeof(word));
+            crc64 = _mm_crc32_u64(crc64, word);
+            p += 8;
+            size -= 8;
+        }
+        crc = static_cast<uint32_t>(crc64);
+#endif
+        while (size-- > 0) {
+            crc = _mm_crc32_u8(crc, *p++);
+        }
+        return crc;
+    }
+
+    bool detect_instructions() {
+        return __builtin_cpu_supports("sse4.2");
+    }
+#elif defined(S1SEE_CRC32C_ARM)
+    uint32_t crc32c_instructions(const uint8_t* p, size_t size, uint32_t crc) {
+        while (size >= 8) {
+            uint64_t word;
+            std::memcpy(&word, p, sizeof(word));
+            crc = __crc32cd(crc, word);
+            p += 8;
+            size -= 8;
+        }
+        while (size-- > 0) {
+            crc = __crc32cb(crc, *p++);
+        }
+        return crc;
+    }
+
+    bool detect_instructions() {
+        return true; // Compiled for a CPU with the CRC extension
+    }
+#else
+    uint32_t crc32c_instructions(const uint8_t* p, size_t size, uint32_t crc) {
+        return crc32c_table(p, size, crc);
+    }
+
+    bool detect_instructions() {
+        return false;
+    }
+#endif
+
+    const bool HARDWARE = detect_instructions();
+}
+
+uint32_t crc32c(const void* data, size_t size, uint32_t crc) {
+    const auto* p = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    crc = HARDWARE ? crc32c_instructions(p, size, crc) : crc32c_table(p, size, crc);
+    return ~crc;
+}
+
+bool crc32c_hardware() {
+    return HARDWARE;
+}
+
+} // namespace utils
+} // namespace s1see
@@ -7,12 +7,20 @@
  * Description: Implementation of PCAP file reader utility for reading network packet
  *              captures. Provides functions to parse PCAP files and extract packet
  *              data with timestamps. Supports both libpcap and basic file reading
- *              depending on build configuration.
+ *              depending on build configuration. MappedPcapFile parses pcap
+ *              and pcapng records directly from a read-only mapping.
  */
 
 #include "s1see/utils/pcap_reader.h"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #ifdef HAVE_PCAP
 #include <pcap/pcap.h>
@@ -57,6 +65,258 @@ int read_pcap_file(const std::string& pcap_path,
 #endif
 }
 
+namespace {
+
+constexpr uint32_t PCAP_MAGIC_USEC = 0xa1b2c3d4;
+constexpr uint32_t PCAP_MAGIC_NSEC = 0xa1b23c4d;
+constexpr uint32_t PCAPNG_SHB = 0x0A0D0D0A;
+constexpr uint32_t PCAPNG_BYTE_ORDER_MAGIC = 0x1A2B3C4D;
+
+// pcapng block types
+constexpr uint32_t PCAPNG_IDB = 1;
+constexpr uint32_t PCAPNG_PB = 2;   // Obsolete Packet Block
+constexpr uint32_t PCAPNG_SPB = 3;
+constexpr uint32_t PCAPNG_EPB = 6;
+
+constexpr uint16_t PCAPNG_OPT_END = 0;
+constexpr uint16_t PCAPNG_OPT_IF_TSRESOL = 9;
+
+constexpr uint64_t NS_PER_SECOND = 1000000000ULL;
+
+int64_t ticks_to_ns(uint64_t ticks, uint64_t ticks_per_second) {
+    if (ticks_per_second == NS_PER_SECOND) {
+        return static_cast<int64_t>(ticks);
+    }
+    unsigned __int128 ns = static_cast<unsigned __int128>(ticks) * NS_PER_SECOND / ticks_per_second;
+    return static_cast<int64_t>(ns);
+}
+
+void warn_truncated(size_t pos, size_t size) {
+    std::cerr << "PCAP file truncated: " << (size - pos) << " trailing bytes ignored" << std::endl;
+}
+
+} // namespace
+
+MappedPcapFile::MappedPcapFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open PCAP file: " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 4) {
+        ::close(fd);
+        throw std::runtime_error("Not a PCAP file: " + path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to mmap PCAP file: " + path);
+    }
+    data_ = static_cast<const uint8_t*>(mapping);
+    madvise(mapping, size_, MADV_SEQUENTIAL);
+
+    uint32_t magic;
+    std::memcpy(&magic, data_, sizeof(magic));
+    try {
+        if (magic == PCAPNG_SHB) {
+            pcapng_ = true;
+            read_section_header(0);
+            return;
+        }
+        if (magic == PCAP_MAGIC_USEC || magic == PCAP_MAGIC_NSEC) {
+            swapped_ = false;
+        } else if (magic == __builtin_bswap32(PCAP_MAGIC_USEC) || magic == __builtin_bswap32(PCAP_MAGIC_NSEC)) {
+            swapped_ = true;
+        } else {
+            throw std::runtime_error("Not a PCAP file: " + path);
+        }
+        if (size_ < 24) {
+            throw std::runtime_error("PCAP file header truncated: " + path);
+        }
+        nanosecond_ = read32(0) == PCAP_MAGIC_NSEC;
+        link_type_ = read32(20) & 0xFFFF;  // Upper bits carry FCS information
+        pos_ = 24;
+    } catch (...) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+        throw;
+    }
+}
+
+MappedPcapFile::~MappedPcapFile() {
+    if (data_) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+}
+
+uint16_t MappedPcapFile::read16(size_t pos) const {
+    uint16_t value;
+    std::memcpy(&value, data_ + pos, sizeof(value));
+    return swapped_ ? __builtin_bswap16(value) : value;
+}
+
+uint32_t MappedPcapFile::read32(size_t pos) const {
+    uint32_t value;
+    std::memcpy(&value, data_ + pos, sizeof(value));
+    return swapped_ ? __builtin_bswap32(value) : value;
+}
+
+bool MappedPcapFile::next(PcapFrame& frame) {
+    return pcapng_ ? next_pcapng(frame) : next_pcap(frame);
+}
+
+bool MappedPcapFile::next_pcap(PcapFrame& frame) {
+    if (pos_ + 16 > size_) {
+        if (pos_ < size_) warn_truncated(pos_, size_);
+        pos_ = size_;
+        return false;
+    }
+    uint32_t captured_len = read32(pos_ + 8);
+    if (captured_len > size_ - pos_ - 16) {
+        warn_truncated(pos_, size_);
+        pos_ = size_;
+        return false;
+    }
+    uint64_t ts_sec = read32(pos_);
+    uint64_t ts_frac = read32(pos_ + 4);
+    frame.timestamp_ns = static_cast<int64_t>(ts_sec * NS_PER_SECOND + (nanosecond_ ? ts_frac : ts_frac * 1000));
+    frame.captured_len = captured_len;
+    frame.original_len = read32(pos_ + 12);
+    frame.frame_number = ++frame_number_;
+    frame.link_type = link_type_;
+    frame.data = data_ + pos_ + 16;
+    pos_ += 16 + captured_len;
+    return true;
+}
+
+void MappedPcapFile::read_section_header(size_t pos) {
+    if (pos + 28 > size_) {
+        throw std::runtime_error("pcapng section header truncated");
+    }
+    uint32_t byte_order;
+    std::memcpy(&byte_order, data_ + pos + 8, sizeof(byte_order));
+    if (byte_order == PCAPNG_BYTE_ORDER_MAGIC) {
+        swapped_ = false;
+    } else if (byte_order == __builtin_bswap32(PCAPNG_BYTE_ORDER_MAGIC)) {
+        swapped_ = true;
+    } else {
+        throw std::runtime_error("pcapng section header has an invalid byte-order magic");
+    }
+    uint32_t block_len = read32(pos + 4);
+    if (block_len < 28 || block_len % 4 != 0 || block_len > size_ - pos) {
+        throw std::runtime_error("pcapng section header has an invalid length");
+    }
+    interfaces_.clear();
+    pos_ = pos + block_len;
+}
+
+void MappedPcapFile::read_interface(size_t body, size_t body_len) {
+    if (body_len < 8) {
+        throw std::runtime_error("pcapng interface block truncated");
+    }
+    Interface iface{read16(body), 1000000};  // Microseconds unless if_tsresol says otherwise
+
+    size_t opt = body + 8;
+    size_t end = body + body_len;
+    while (opt + 4 <= end) {
+        uint16_t code = read16(opt);
+        uint16_t len = read16(opt + 2);
+        if (code == PCAPNG_OPT_END || opt + 4 + len > end) break;
+        if (code == PCAPNG_OPT_IF_TSRESOL && len >= 1) {
+            uint8_t resolution = data_[opt + 4];
+            uint8_t exponent = resolution & 0x7F;
+            if (resolution & 0x80) {
+                iface.ticks_per_second = 1ULL << std::min<uint8_t>(exponent, 63);
+            } else {
+                iface.ticks_per_second = 1;
+                for (uint8_t i = 0; i < std::min<uint8_t>(exponent, 19); ++i) {
+                    iface.ticks_per_second *= 10;
+                }
+            }
+        }
+        opt += 4 + ((len + 3u) & ~3u);
+    }
+    interfaces_.push_back(iface);
+}
+
+bool MappedPcapFile::next_pcapng(PcapFrame& frame) {
+    while (pos_ + 12 <= size_) {
+        uint32_t block_type;
+        std::memcpy(&block_type, data_ + pos_, sizeof(block_type));
+        if (block_type == PCAPNG_SHB) {
+            read_section_header(pos_);
+            continue;
+        }
+        block_type = read32(pos_);
+        uint32_t block_len = read32(pos_ + 4);
+        if (block_len < 12 || block_len % 4 != 0) {
+            throw std::runtime_error("pcapng block has an invalid length");
+        }
+        if (block_len > size_ - pos_) {
+            break;
+        }
+
+        size_t body = pos_ + 8;
+        size_t body_len = block_len - 12;
+        bool is_packet = false;
+        size_t data_offset = 0;
+        uint32_t interface_id = 0;
+        uint64_t ticks = 0;
+        uint32_t captured_len = 0;
+        uint32_t original_len = 0;
+
+        switch (block_type) {
+            case PCAPNG_IDB:
+                read_interface(body, body_len);
+                break;
+            case PCAPNG_EPB:
+            case PCAPNG_PB:
+                if (body_len < 20) {
+                    throw std::runtime_error("pcapng packet block truncated");
+                }
+                interface_id = block_type == PCAPNG_EPB ? read32(body) : read16(body);
+                ticks = (static_cast<uint64_t>(read32(body + 4)) << 32) | read32(body + 8);
+                captured_len = read32(body + 12);
+                original_len = read32(body + 16);
+                data_offset = body + 20;
+                if (captured_len > body_len - 20) {
+                    throw std::runtime_error("pcapng packet block overruns its length");
+                }
+                is_packet = true;
+                break;
+            case PCAPNG_SPB:
+                if (body_len < 4) {
+                    throw std::runtime_error("pcapng simple packet block truncated");
+                }
+                original_len = read32(body);
+                captured_len = std::min<uint32_t>(original_len, static_cast<uint32_t>(body_len - 4));
+                data_offset = body + 4;
+                is_packet = true;
+                break;
+            default:
+                break;  // Name resolution, statistics, custom blocks, ...
+        }
+        pos_ += block_len;
+
+        if (is_packet) {
+            if (interface_id >= interfaces_.size()) {
+                throw std::runtime_error("pcapng packet references an undefined interface");
+            }
+            const Interface& iface = interfaces_[interface_id];
+            frame.timestamp_ns = ticks_to_ns(ticks, iface.ticks_per_second);
+            frame.captured_len = captured_len;
+            frame.original_len = original_len;
+            frame.frame_number = ++frame_number_;
+            frame.link_type = iface.link_type;
+            frame.data = data_ + data_offset;
+            return true;
+        }
+    }
+    if (pos_ < size_) warn_truncated(pos_, size_);
+    pos_ = size_;
+    return false;
+}
+
 } // namespace utils
 } // namespace s1see
 
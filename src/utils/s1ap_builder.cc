@@ -0,0 +1,657 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: s1ap_builder.cc
+ * Description: Implementation of S1apBuilder. A small aligned-PER bit writer
+ *              encodes the S1AP IE values; PDUs are assembled from
+ *              ProtocolIE-Field lists with open-type length determinants.
+ */
+
+#include "s1see/utils/s1ap_builder.h"
+#include <stdexcept>
+
+namespace s1see {
+namespace utils {
+
+namespace {
+
+using Bytes = S1apBuilder::Bytes;
+
+// S1AP-PDU choice, procedure codes and protocol IE IDs (TS 36.413)
+enum class PduType : uint8_t { INITIATING = 0, SUCCESSFUL = 1, UNSUCCESSFUL = 2 };
+
+enum Procedure : uint8_t {
+    HANDOVER_PREPARATION = 0,
+    HANDOVER_RESOURCE_ALLOCATION = 1,
+    HANDOVER_NOTIFICATION = 2,
+    PATH_SWITCH_REQUEST = 3,
+    INITIAL_CONTEXT_SETUP = 9,
+    DOWNLINK_NAS_TRANSPORT = 11,
+    INITIAL_UE_MESSAGE = 12,
+    UPLINK_NAS_TRANSPORT = 13,
+    UE_CONTEXT_RELEASE_REQUEST = 18,
+    UE_CONTEXT_RELEASE = 23,
+};
+
+enum IeId : uint16_t {
+    MME_UE_S1AP_ID = 0,
+    HANDOVER_TYPE = 1,
+    CAUSE = 2,
+    TARGET_ID = 4,
+    ENB_UE_S1AP_ID = 8,
+    E_RAB_ADMITTED_LIST = 18,
+    E_RAB_ADMITTED_ITEM = 20,
+    E_RAB_TO_BE_SWITCHED_DL_LIST = 22,
+    E_RAB_TO_BE_SWITCHED_DL_ITEM = 23,
+    E_RAB_TO_BE_SETUP_LIST_CTXT_SU_REQ = 24,
+    NAS_PDU = 26,
+    E_RAB_TO_BE_SETUP_ITEM_HO_REQ = 27,
+    SECURITY_CONTEXT = 40,
+    E_RAB_SETUP_ITEM_CTXT_SU_RES = 50,
+    E_RAB_SETUP_LIST_CTXT_SU_RES = 51,
+    E_RAB_TO_BE_SETUP_ITEM_CTXT_SU_REQ = 52,
+    E_RAB_TO_BE_SETUP_LIST_HO_REQ = 53,
+    UE_AGGREGATE_MAXIMUM_BITRATE = 66,
+    TAI = 67,
+    SECURITY_KEY = 73,
+    SOURCE_MME_UE_S1AP_ID = 88,
+    S_TMSI = 96,
+    UE_S1AP_IDS = 99,
+    EUTRAN_CGI = 100,
+    SOURCE_TO_TARGET_CONTAINER = 104,
+    UE_SECURITY_CAPABILITIES = 107,
+    TARGET_TO_SOURCE_CONTAINER = 123,
+    RRC_ESTABLISHMENT_CAUSE = 134,
+};
+
+constexpr uint8_t REJECT = 0x00;
+constexpr uint8_t IGNORE = 0x40;
+
+// Radio network and NAS cause values
+constexpr uint8_t CAUSE_HANDOVER_DESIRABLE = 2;
+constexpr uint8_t CAUSE_USER_INACTIVITY = 20;
+constexpr uint8_t CAUSE_NAS_NORMAL_RELEASE = 0;
+
+constexpr uint8_t RRC_CAUSE_MO_SIGNALLING = 3;
+
+// Aligned PER bit writer: fields are packed MSB first, octet-aligned
+// fields pad to the next byte boundary first
+class BitWriter {
+public:
+    void put(uint64_t value, int bits) {
+        for (int i = bits - 1; i >= 0; --i) {
+            if (used_ == 0) out_.push_back(0);
+            out_.back() |= static_cast<uint8_t>(((value >> i) & 1) << (7 - used_));
+            used_ = (used_ + 1) % 8;
+        }
+    }
+
+    void align() { used_ = 0; }
+
+    void octets(const uint8_t* data, size_t len) {
+        align();
+        out_.insert(out_.end(), data, data + len);
+    }
+    void octets(const Bytes& data) { octets(data.data(), data.size()); }
+
+    void put_u32(uint32_t value) {
+        uint8_t be[4] = {static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16),
+                         static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)};
+        octets(be, sizeof(be));
+    }
+
+    // Constrained INTEGER with a range above 64K: octet count in
+    // length_bits, then the minimal big-endian octets, aligned
+    void put_wide_integer(uint64_t value, int length_bits) {
+        int n = 1;
+        while (n < 8 && (value >> (8 * n)) != 0) ++n;
+        put(static_cast<uint64_t>(n - 1), length_bits);
+        align();
+        for (int i = n - 1; i >= 0; --i) {
+            out_.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    Bytes take() { used_ = 0; return std::move(out_); }
+
+private:
+    Bytes out_;
+    int used_ = 0;  // Bits used in the last byte; 0 when aligned
+};
+
+// Unconstrained length determinant
+void put_length(Bytes& out, size_t len) {
+    if (len < 128) {
+        out.push_back(static_cast<uint8_t>(len));
+    } else if (len < 16384) {
+        out.push_back(static_cast<uint8_t>(0x80 | (len >> 8)));
+        out.push_back(static_cast<uint8_t>(len));
+    } else {
+        throw std::runtime_error("S1apBuilder: open type too long: " + std::to_string(len));
+    }
+}
+
+Bytes octet_string(const Bytes& value) {
+    Bytes out;
+    put_length(out, value.size());
+    out.insert(out.end(), value.begin(), value.end());
+    return out;
+}
+
+// PLMN identity from MCC+MNC digits, TBCD with a filler for 2-digit MNCs
+Bytes plmn_identity(const std::string& plmn) {
+    if (plmn.size() != 5 && plmn.size() != 6) {
+        throw std::runtime_error("S1apBuilder: PLMN must be 5 or 6 digits: " + plmn);
+    }
+    auto d = [&](size_t i) { return static_cast<uint8_t>(plmn[i] - '0'); };
+    uint8_t mnc3 = plmn.size() == 6 ? d(5) : 0x0F;
+    return {static_cast<uint8_t>(d(1) << 4 | d(0)),
+            static_cast<uint8_t>(mnc3 << 4 | d(2)),
+            static_cast<uint8_t>(d(4) << 4 | d(3))};
+}
+
+// ProtocolIE-Container under construction
+class IeList {
+public:
+    IeList& add(uint16_t id, uint8_t criticality, const Bytes& value) {
+        body_.push_back(static_cast<uint8_t>(id >> 8));
+        body_.push_back(static_cast<uint8_t>(id));
+        body_.push_back(criticality);
+        put_length(body_, value.size());
+        body_.insert(body_.end(), value.begin(), value.end());
+        ++count_;
+        return *this;
+    }
+
+    // Value of a SEQUENCE { protocolIEs, ... }: extension bit, padding,
+    // then the 16-bit IE count
+    Bytes sequence() const {
+        Bytes out = {0x00, static_cast<uint8_t>(count_ >> 8), static_cast<uint8_t>(count_)};
+        out.insert(out.end(), body_.begin(), body_.end());
+        return out;
+    }
+
+    // Value of a single-item E-RAB list (SEQUENCE (SIZE(1..256)) OF
+    // ProtocolIE-SingleContainer): count - 1, then the fields
+    Bytes single_container_list() const {
+        Bytes out = {static_cast<uint8_t>(count_ - 1)};
+        out.insert(out.end(), body_.begin(), body_.end());
+        return out;
+    }
+
+private:
+    Bytes body_;
+    uint16_t count_ = 0;
+};
+
+Bytes pdu(PduType type, uint8_t procedure, uint8_t criticality, const IeList& ies) {
+    Bytes value = ies.sequence();
+    Bytes out = {static_cast<uint8_t>(static_cast<uint8_t>(type) << 5), procedure, criticality};
+    put_length(out, value.size());
+    out.insert(out.end(), value.begin(), value.end());
+    return out;
+}
+
+Bytes mme_ue_s1ap_id(uint32_t id) {
+    BitWriter w;
+    w.put_wide_integer(id, 2);
+    return w.take();
+}
+
+Bytes enb_ue_s1ap_id(uint32_t id) {
+    BitWriter w;
+    w.put_wide_integer(id & 0xFFFFFF, 2);
+    return w.take();
+}
+
+Bytes tai(const S1apCell& cell) {
+    BitWriter w;
+    w.put(0, 2);  // Extension, iE-Extensions absent
+    w.octets(plmn_identity(cell.plmn));
+    w.put(cell.tac, 16);
+    return w.take();
+}
+
+Bytes eutran_cgi(const S1apCell& cell) {
+    BitWriter w;
+    w.put(0, 2);
+    w.octets(plmn_identity(cell.plmn));
+    w.align();
+    w.put(cell.eci & 0xFFFFFFF, 28);
+    return w.take();
+}
+
+Bytes s_tmsi(const Guti& guti) {
+    BitWriter w;
+    w.put(0, 2);
+    w.put(guti.mme_code, 8);
+    w.put_u32(guti.m_tmsi);
+    return w.take();
+}
+
+Bytes rrc_establishment_cause(uint8_t cause) {
+    BitWriter w;
+    w.put(0, 1);
+    w.put(cause, 3);
+    return w.take();
+}
+
+Bytes radio_network_cause(uint8_t cause) {
+    BitWriter w;
+    w.put(0, 1);
+    w.put(0, 3);  // radioNetwork
+    w.put(0, 1);
+    w.put(cause, 6);
+    return w.take();
+}
+
+Bytes nas_cause(uint8_t cause) {
+    BitWriter w;
+    w.put(0, 1);
+    w.put(2, 3);  // nas
+    w.put(0, 1);
+    w.put(cause, 2);
+    return w.take();
+}
+
+Bytes handover_type_intralte() {
+    BitWriter w;
+    w.put(0, 1);
+    w.put(0, 3);
+    return w.take();
+}
+
+Bytes ue_aggregate_maximum_bitrate(uint64_t downlink, uint64_t uplink) {
+    BitWriter w;
+    w.put(0, 2);
+    w.put_wide_integer(downlink, 3);
+    w.put_wide_integer(uplink, 3);
+    return w.take();
+}
+
+Bytes ue_security_capabilities() {
+    BitWriter w;
+    w.put(0, 2);
+    w.put(0, 1);
+    w.put(0xC000, 16);  // EEA1, EEA2
+    w.put(0, 1);
+    w.put(0xC000, 16);  // EIA1, EIA2
+    return w.take();
+}
+
+Bytes key_material(uint8_t seed) {
+    Bytes key(32);
+    for (size_t i = 0; i < key.size(); ++i) {
+        key[i] = static_cast<uint8_t>(seed + i * 37);
+    }
+    return key;
+}
+
+Bytes security_context(uint8_t next_hop_chaining_count) {
+    BitWriter w;
+    w.put(0, 2);
+    w.put(next_hop_chaining_count & 0x07, 3);
+    w.octets(key_material(next_hop_chaining_count));
+    return w.take();
+}
+
+// RRC containers are carried opaquely; a fixed filler keeps sizes realistic
+Bytes transparent_container(uint8_t tag) {
+    Bytes container(40, 0);
+    container[0] = tag;
+    for (size_t i = 1; i < container.size(); ++i) {
+        container[i] = static_cast<uint8_t>(i * 11);
+    }
+    return octet_string(container);
+}
+
+void put_erab_id(BitWriter& w, uint8_t id) {
+    w.put(0, 1);
+    w.put(id & 0x0F, 4);
+}
+
+void put_transport_layer_address(BitWriter& w, uint32_t address) {
+    w.put(0, 1);
+    w.put(32 - 1, 8);  // SIZE(1..160): 32-bit IPv4 address
+    w.put_u32(address);
+}
+
+void put_erab_qos(BitWriter& w, uint8_t qci) {
+    w.put(0, 3);  // Extension, gbrQosInformation and iE-Extensions absent
+    w.align();
+    w.put(qci, 8);
+    // allocationRetentionPriority: priority 15, no pre-emption
+    w.put(0, 2);
+    w.put(15, 4);
+    w.put(0, 2);
+}
+
+Bytes single_item_list(uint16_t item_id, const Bytes& item) {
+    IeList list;
+    list.add(item_id, REJECT, item);
+    return list.single_container_list();
+}
+
+Bytes target_enb_id(const S1apCell& cell) {
+    BitWriter w;
+    w.put(0, 1);  // CHOICE extension
+    w.put(0, 2);  // targeteNB-ID
+    w.put(0, 2);  // TargeteNB-ID extension, iE-Extensions absent
+    w.put(0, 2);  // Global-ENB-ID extension, iE-Extensions absent
+    w.octets(plmn_identity(cell.plmn));
+    w.put(0, 1);  // ENB-ID CHOICE extension
+    w.put(0, 1);  // macroENB-ID
+    w.align();
+    w.put(cell.enb_id() & 0xFFFFF, 20);
+    w.put(0, 2);  // selected-TAI extension, iE-Extensions absent
+    w.octets(plmn_identity(cell.plmn));
+    w.put(cell.tac, 16);
+    return w.take();
+}
+
+// EPS mobile identity with a GUTI (TS 24.301 9.9.3.12)
+Bytes guti_identity(const Guti& guti) {
+    Bytes out = {0xF6};
+    Bytes plmn = plmn_identity(guti.plmn);
+    out.insert(out.end(), plmn.begin(), plmn.end());
+    out.push_back(static_cast<uint8_t>(guti.mme_group_id >> 8));
+    out.push_back(static_cast<uint8_t>(guti.mme_group_id));
+    out.push_back(guti.mme_code);
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<uint8_t>(guti.m_tmsi >> shift));
+    }
+    return out;
+}
+
+Bytes tai_list(const S1apCell& cell) {
+    Bytes out = {0x00};  // One PLMN, list of TACs, one element
+    Bytes plmn = plmn_identity(cell.plmn);
+    out.insert(out.end(), plmn.begin(), plmn.end());
+    out.push_back(static_cast<uint8_t>(cell.tac >> 8));
+    out.push_back(static_cast<uint8_t>(cell.tac));
+    return out;
+}
+
+void append_lv(Bytes& out, const Bytes& value) {
+    out.push_back(static_cast<uint8_t>(value.size()));
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+void append_lv_e(Bytes& out, const Bytes& value) {
+    out.push_back(static_cast<uint8_t>(value.size() >> 8));
+    out.push_back(static_cast<uint8_t>(value.size()));
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+// Security protected NAS message with a zero MAC around a plain message
+Bytes protect(uint8_t security_header_type, uint8_t nas_count, const Bytes& plain) {
+    Bytes out = {static_cast<uint8_t>(security_header_type << 4 | 0x07), 0, 0, 0, 0, nas_count};
+    out.insert(out.end(), plain.begin(), plain.end());
+    return out;
+}
+
+constexpr uint8_t INTEGRITY_PROTECTED = 1;
+constexpr uint8_t INTEGRITY_PROTECTED_CIPHERED = 2;
+
+} // namespace
+
+Bytes S1apBuilder::attach_request(const std::string& imsi) {
+    if (imsi.size() < 6 || imsi.size() > 15) {
+        throw std::runtime_error("S1apBuilder: invalid IMSI length: " + imsi);
+    }
+    auto d = [&](size_t i) { return static_cast<uint8_t>(imsi[i] - '0'); };
+    bool odd = imsi.size() % 2 == 1;
+    Bytes identity = {static_cast<uint8_t>(d(0) << 4 | (odd ? 0x08 : 0x00) | 0x01)};
+    for (size_t i = 1; i < imsi.size(); i += 2) {
+        uint8_t high = i + 1 < imsi.size() ? d(i + 1) : 0x0F;
+        identity.push_back(static_cast<uint8_t>(high << 4 | d(i)));
+    }
+
+    // No NAS key set yet (KSI 7), EPS attach
+    Bytes out = {0x07, 0x41, 0x71};
+    append_lv(out, identity);
+    append_lv(out, {0xE0, 0xE0});  // UE network capability: EEA0/1/2, EIA0/1/2
+    append_lv_e(out, {0x02, 0x01, 0xD0, 0x11});  // PDN connectivity request, IPv4
+    return out;
+}
+
+Bytes S1apBuilder::attach_accept(const Guti& guti, const S1apCell& cell, uint32_t ue_address, uint8_t nas_count) {
+    // Activate default EPS bearer context request for APN "internet"
+    Bytes esm = {0x52, 0x01, 0xC1};
+    append_lv(esm, {0x09});
+    append_lv(esm, {0x08, 'i', 'n', 't', 'e', 'r', 'n', 'e', 't'});
+    append_lv(esm, {0x01, static_cast<uint8_t>(ue_address >> 24), static_cast<uint8_t>(ue_address >> 16),
+                    static_cast<uint8_t>(ue_address >> 8), static_cast<uint8_t>(ue_address)});
+
+    Bytes plain = {0x07, 0x42, 0x01, 0x29};  // EPS only, T3412 54 min
+    append_lv(plain, tai_list(cell));
+    append_lv_e(plain, esm);
+    plain.push_back(0x50);  // GUTI
+    append_lv(plain, guti_identity(guti));
+    plain.insert(plain.end(), {0x64, 0x01, 0x01});  // EPS network feature support: IMS voice
+    return protect(INTEGRITY_PROTECTED_CIPHERED, nas_count, plain);
+}
+
+Bytes S1apBuilder::attach_complete(uint8_t nas_count) {
+    Bytes plain = {0x07, 0x43};
+    append_lv_e(plain, {0x52, 0x00, 0xC2});  // Activate default EPS bearer context accept
+    return protect(INTEGRITY_PROTECTED_CIPHERED, nas_count, plain);
+}
+
+Bytes S1apBuilder::tau_request(const Guti& guti, uint8_t nas_count) {
+    Bytes plain = {0x07, 0x48, 0x00};  // KSI 0, TA updating
+    append_lv(plain, guti_identity(guti));
+    return protect(INTEGRITY_PROTECTED, nas_count, plain);
+}
+
+Bytes S1apBuilder::tau_accept(const Guti& guti, const S1apCell& cell, uint8_t nas_count) {
+    Bytes plain = {0x07, 0x49, 0x00, 0x5A, 0x29};  // TA updated, T3412 54 min
+    plain.push_back(0x50);
+    append_lv(plain, guti_identity(guti));
+    plain.push_back(0x54);
+    append_lv(plain, tai_list(cell));
+    return protect(INTEGRITY_PROTECTED_CIPHERED, nas_count, plain);
+}
+
+Bytes S1apBuilder::service_request(uint8_t ksi, uint8_t nas_count) {
+    // Security header type 12 with KSI, sequence number and short MAC
+    return {0xC7, static_cast<uint8_t>((ksi & 0x07) << 5 | (nas_count & 0x1F)), 0x00, 0x00};
+}
+
+Bytes S1apBuilder::initial_ue_message(uint32_t enb_ue_id, const Bytes& nas, const S1apCell& cell,
+                                      const std::optional<Guti>& guti) {
+    IeList ies;
+    ies.add(ENB_UE_S1AP_ID, REJECT, enb_ue_s1ap_id(enb_ue_id))
+       .add(NAS_PDU, REJECT, octet_string(nas))
+       .add(TAI, REJECT, tai(cell))
+       .add(EUTRAN_CGI, IGNORE, eutran_cgi(cell))
+       .add(RRC_ESTABLISHMENT_CAUSE, IGNORE, rrc_establishment_cause(RRC_CAUSE_MO_SIGNALLING));
+    if (guti) {
+        ies.add(S_TMSI, REJECT, s_tmsi(*guti));
+    }
+    return pdu(PduType::INITIATING, INITIAL_UE_MESSAGE, IGNORE, ies);
+}
+
+Bytes S1apBuilder::downlink_nas_transport(uint32_t mme_ue_id, uint32_t enb_ue_id, const Bytes& nas) {
+    IeList ies;
+    ies.add(MME_UE_S1AP_ID, REJECT, mme_ue_s1ap_id(mme_ue_id))
+       .add(ENB_UE_S1AP_ID, REJECT, enb_ue_s1ap_id(enb_ue_id))
+       .add(NAS_PDU, REJECT, octet_string(nas));
+    return pdu(PduType::INITIATING, DOWNLINK_NAS_TRANSPORT, IGNORE, ies);
+}
+
+Bytes S1apBuilder::uplink_nas_transport(uint32_t mme_ue_id, uint32_t enb_ue_id, const Bytes& nas,
+                                        const S1apCell& cell) {
+    IeList ies;
+    ies.add(MME_UE_S1AP_ID, REJECT, mme_ue_s1ap_id(mme_ue_id))
+       .add(ENB_UE_S1AP_ID, REJECT, enb_ue_s1ap_id(enb_ue_id))
+       .add(NAS_PDU, REJECT, octet_string(nas))
+       .add(EUTRAN_CGI, IGNORE, eutran_cgi(cell))
+       .add(TAI, IGNORE, tai(cell));
+    return pdu(PduType::INITIATING, UPLINK_NAS_TRANSPORT, IGNORE, ies);
+}
+
+Bytes S1apBuilder::initial_context_setup_request(uint32_t mme_ue_id, uint32_t enb_ue_id, const ERab& erab,
+                                                 const Bytes& nas) {
+    BitWriter item;
+    item.put(0, 1);
+    item.put(nas.empty() ? 0 : 1, 1);  // nAS-PDU
+    item.put(0, 1);
+    put_erab_id(item, erab.id);
+    put_erab_qos(item, erab.qci);
+    put_transport_layer_address(item, erab.transport_address);
+    item.put_u32(erab.teid);
+    if (!nas.empty()) {
+        item.octets(octet_string(nas));
+    }
+
+    IeList ies;
+    ies.add(MME_UE_S1AP_ID, REJECT, mme_ue_s1ap_id(mme_ue_id))
+       .add(ENB_UE_S1AP_ID, REJECT, enb_ue_s1ap_id(enb_ue_id))
+       .add(UE_AGGREGATE_MAXIMUM_BITRATE, REJECT, ue_aggregate_maximum_bitrate(1000000000, 500000000))
+       .add(E_RAB_TO_BE_SETUP_LIST_CTXT_SU_REQ, REJECT,
+            single_item_list(E_RAB_TO_BE_SETUP_ITEM_CTXT_SU_REQ, item.take()))
+       .add(UE_SECURITY_CAPABILITIES, REJECT, ue_security_capabilities())
+       .add(SECURITY_KEY, REJECT, key_material(static_cast<uint8_t>(mme_ue_id)));
+    return pdu(PduType::INITIATING, INITIAL_CONTEXT_SETUP, REJECT, ies);
+}
+
+Bytes S1apBuilder::initial_context_setup_response(uint32_t mme_ue_id, uint32_t enb_ue_id, const ERab& erab) {
+    BitWriter item;
+    item.put(0, 2);
+    put_erab_id(item, erab.id);
+    put_transport_layer_address(item, erab.transport_address);
+    item.put_u32(erab.teid);
+
+    IeList ies;
+    ies.add(MME_UE_S1AP_ID, IGNORE, mme_ue_s1ap_id(mme_ue_id))
+       .add(ENB_UE_S1AP_ID, IGNORE, enb_ue_s1ap_id(enb_ue_id))
+       .add(E_RAB_SETUP_LIST_CTXT_SU_RES, IGNORE, single_item_list(E_RAB_SETUP_ITEM_CTXT_SU_RES, item.take()));
+    return pdu(PduType::SUCCESSFUL, INITIAL_CONTEXT_SETUP, REJECT, ies);
+}
+
+Bytes S1apBuilder::ue_context_release_request(uint32_t mme_ue_id, uint32_t enb_ue_id) {
+    IeList ies;
+    ies.add(MME_UE_S1AP_ID, REJECT, mme_ue_s1ap_id(mme_ue_id))
+       .add(ENB_UE_S1AP_ID, REJECT, enb_ue_s1ap_id(enb_ue_id))
+       .add(CAUSE, IGNORE, radio_network_cause(CAUSE_USER_INACTIVITY));
+    return pdu(PduType::INITIATING, UE_CONTEXT_RELEASE_REQUEST, IGNORE, ies);
+}
+
+Bytes S1apBuilder::ue_context_release_command(uint32_t mme_ue_id, uint32_t enb_ue_id) {
+    BitWriter pair;
+    pair.put(0, 1);  // CHOICE extension
+    pair.put(0, 1);  // uE-S1AP-ID-pair
+    pair.put(0, 2);  // Extension, iE-Extensions absent
+    pair.put_wide_integer(mme_ue_id, 2);
+    pair.put_wide_integer(enb_ue_id & 0xFFFFFF, 2);
+
+    IeList ies;
+    ies.add(UE_S1AP_IDS, REJECT, pair.take())
+       .add(CAUSE, IGNORE, nas_cause(CAUSE_NAS_NORMAL_RELEASE));
+    return pdu(PduType::INITIATING, UE_CONTEXT_RELEASE, REJECT, ies);
+}
+
+Bytes S1apBuilder::ue_context_release_complete(uint32_t mme_ue_id, uint32_t enb_ue_id) {
+    IeList ies;
+    ies.add(MME_UE_S1AP_ID, IGNORE, mme_ue_s1ap_id(mme_ue_id))
+       .add(ENB_UE_S1AP_ID, IGNORE, enb_ue_s1ap_id(enb_ue_id));
+    return pdu(PduType::SUCCESSFUL, UE_CONTEXT_RELEASE, REJECT, ies);
+}
+
+Bytes S1apBuilder::handover_required(uint32_t mme_ue_id, uint32_t enb_ue_id, const S1apCell& target) {
+    IeList ies;
+    ies.add(MME_UE_S1AP_ID, REJECT, mme_ue_s1ap_id(mme_ue_id))
+       .add(ENB_UE_S1AP_ID, REJECT, enb_ue_s1ap_id(enb_ue_id))
+       .add(HANDOVER_TYPE, REJECT, handover_type_intralte())
+       .add(CAUSE, IGNORE, radio_network_cause(CAUSE_HANDOVER_DESIRABLE))
+       .add(TARGET_ID, REJECT, target_enb_id(target))
+       .add(SOURCE_TO_TARGET_CONTAINER, REJECT, transparent_container(0x40));
+    return pdu(PduType::INITIATING, HANDOVER_PREPARATION, REJECT, ies);
+}
+
+Bytes S1apBuilder::handover_request(uint32_t mme_ue_id, const ERab& erab) {
+    BitWriter item;
+    item.put(0, 2);
+    put_erab_id(item, erab.id);
+    put_transport_layer_address(item, erab.transport_address);
+    item.put_u32(erab.teid);
+    put_erab_qos(item, erab.qci);
+
+    IeList ies;
+    ies.add(MME_UE_S1AP_ID, REJECT, mme_ue_s1ap_id(mme_ue_id))
+       .add(HANDOVER_TYPE, REJECT, handover_type_intralte())
+       .add(CAUSE, IGNORE, radio_network_cause(CAUSE_HANDOVER_DESIRABLE))
+       .add(UE_AGGREGATE_MAXIMUM_BITRATE, REJECT, ue_aggregate_maximum_bitrate(1000000000, 500000000))
+       .add(E_RAB_TO_BE_SETUP_LIST_HO_REQ, REJECT, single_item_list(E_RAB_TO_BE_SETUP_ITEM_HO_REQ, item.take()))
+       .add(SOURCE_TO_TARGET_CONTAINER, REJECT, transparent_container(0x40))
+       .add(UE_SECURITY_CAPABILITIES, REJECT, ue_security_capabilities())
+       .add(SECURITY_CONTEXT, REJECT, security_context(1));
+    return pdu(PduType::INITIATING, HANDOVER_RESOURCE_ALLOCATION, REJECT, ies);
+}
+
+Bytes S1apBuilder::handover_request_ack(uint32_t mme_ue_id, uint32_t enb_ue_id, const ERab& erab) {
+    BitWriter item;
+    item.put(0, 1);
+    item.put(0, 5);  // DL/UL forwarding tunnels and iE-Extensions absent
+    put_erab_id(item, erab.id);
+    put_transport_layer_address(item, erab.transport_address);
+    item.put_u32(erab.teid);
+
+    IeList ies;
+    ies.add(MME_UE_S1AP_ID, IGNORE, mme_ue_s1ap_id(mme_ue_id))
+       .add(ENB_UE_S1AP_ID, IGNORE, enb_ue_s1ap_id(enb_ue_id))
+       .add(E_RAB_ADMITTED_LIST, IGNORE, single_item_list(E_RAB_ADMITTED_ITEM, item.take()))
+       .add(TARGET_TO_SOURCE_CONTAINER, REJECT, transparent_container(0x20));
+    return pdu(PduType::SUCCESSFUL, HANDOVER_RESOURCE_ALLOCATION, REJECT, ies);
+}
+
+Bytes S1apBuilder::handover_command(uint32_t mme_ue_id, uint32_t enb_ue_id) {
+    IeList ies;
+    ies.add(MME_UE_S1AP_ID, REJECT, mme_ue_s1ap_id(mme_ue_id))
+       .add(ENB_UE_S1AP_ID, REJECT, enb_ue_s1ap_id(enb_ue_id))
+       .add(HANDOVER_TYPE, REJECT, handover_type_intralte())
+       .add(TARGET_TO_SOURCE_CONTAINER, REJECT, transparent_container(0x20));
+    return pdu(PduType::SUCCESSFUL, HANDOVER_PREPARATION, REJECT, ies);
+}
+
+Bytes S1apBuilder::handover_notify(uint32_t mme_ue_id, uint32_t enb_ue_id, const S1apCell& cell) {
+    IeList ies;
+    ies.add(MME_UE_S1AP_ID, REJECT, mme_ue_s1ap_id(mme_ue_id))
+       .add(ENB_UE_S1AP_ID, REJECT, enb_ue_s1ap_id(enb_ue_id))
+       .add(EUTRAN_CGI, IGNORE, eutran_cgi(cell))
+       .add(TAI, IGNORE, tai(cell));
+    return pdu(PduType::INITIATING, HANDOVER_NOTIFICATION, IGNORE, ies);
+}
+
+Bytes S1apBuilder::path_switch_request(uint32_t source_mme_ue_id, uint32_t enb_ue_id, const ERab& erab,
+                                       const S1apCell& cell) {
+    BitWriter item;
+    item.put(0, 2);
+    put_erab_id(item, erab.id);
+    put_transport_layer_address(item, erab.transport_address);
+    item.put_u32(erab.teid);
+
+    IeList ies;
+    ies.add(ENB_UE_S1AP_ID, REJECT, enb_ue_s1ap_id(enb_ue_id))
+       .add(E_RAB_TO_BE_SWITCHED_DL_LIST, REJECT,
+            single_item_list(E_RAB_TO_BE_SWITCHED_DL_ITEM, item.take()))
+       .add(SOURCE_MME_UE_S1AP_ID, REJECT, mme_ue_s1ap_id(source_mme_ue_id))
+       .add(EUTRAN_CGI, IGNORE, eutran_cgi(cell))
+       .add(TAI, IGNORE, tai(cell))
+       .add(UE_SECURITY_CAPABILITIES, IGNORE, ue_security_capabilities());
+    return pdu(PduType::INITIATING, PATH_SWITCH_REQUEST, REJECT, ies);
+}
+
+Bytes S1apBuilder::path_switch_request_ack(uint32_t mme_ue_id, uint32_t enb_ue_id) {
+    IeList ies;
+    ies.add(MME_UE_S1AP_ID, IGNORE, mme_ue_s1ap_id(mme_ue_id))
+       .add(ENB_UE_S1AP_ID, IGNORE, enb_ue_s1ap_id(enb_ue_id))
+       .add(SECURITY_CONTEXT, REJECT, security_context(2));
+    return pdu(PduType::SUCCESSFUL, PATH_SWITCH_REQUEST, REJECT, ies);
+}
+
+} // namespace utils
+} // namespace s1see
@@ -0,0 +1,80 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: thread_pool.cc
+ * Description: Implementation of the fixed-size worker thread pool. Workers
+ *              claim indices of the current parallel_for job one at a time
+ *              and the caller blocks until every index has completed.
+ */
+
+#include "s1see/utils/thread_pool.h"
+#include <iostream>
+
+namespace s1see {
+namespace utils {
+
+ThreadPool::ThreadPool(size_t num_threads) {
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    workers_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+        workers_.emplace_back(&ThreadPool::worker_loop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) return;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    job_ = &fn;
+    job_count_ = count;
+    next_index_ = 0;
+    completed_ = 0;
+    work_cv_.notify_all();
+
+    done_cv_.wait(lock, [this] { return completed_ == job_count_; });
+    job_ = nullptr;
+}
+
+void ThreadPool::worker_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        work_cv_.wait(lock, [this] { return stopping_ || (job_ && next_index_ < job_count_); });
+        if (stopping_) return;
+
+        // Claim indices until the job is exhausted
+        while (job_ && next_index_ < job_count_) {
+            size_t index = next_index_++;
+            const auto* fn = job_;
+            lock.unlock();
+            try {
+                (*fn)(index);
+            } catch (const std::exception& e) {
+                std::cerr << "ThreadPool task " << index << " failed: " << e.what() << std::endl;
+            }
+            lock.lock();
+            if (++completed_ == job_count_) {
+                done_cv_.notify_all();
+            }
+        }
+    }
+}
+
+} // namespace utils
+} // namespace s1see
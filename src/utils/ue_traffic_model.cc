@@ -0,0 +1,199 @@
+/*
+ * Melrose Networks (Melrose Labs Ltd) - https://melrosenetworks.com
+ * Date: 2026-01-04
+ * Support: support@melrosenetworks.com
+ * Disclaimer: Provided "as is" without warranty; use at your own risk.
+ * Title: ue_traffic_model.cc
+ * Description: Implementation of UeTrafficModel. Each script step is built
+ *              on demand from the UE index and cycle, so the model holds no
+ *              per-UE state.
+ */
+
+#include "s1see/utils/ue_traffic_model.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace s1see {
+namespace utils {
+
+namespace {
+
+enum Step : size_t {
+    // Attach
+    ATTACH_INITIAL_UE_MESSAGE,
+    ATTACH_CONTEXT_SETUP_REQUEST,
+    ATTACH_CONTEXT_SETUP_RESPONSE,
+    ATTACH_COMPLETE,
+    ATTACH_RELEASE_REQUEST,
+    ATTACH_RELEASE_COMMAND,
+    ATTACH_RELEASE_COMPLETE,
+    // Service request, then S1 handover to the neighbour eNB
+    SERVICE_INITIAL_UE_MESSAGE,
+    SERVICE_CONTEXT_SETUP_REQUEST,
+    SERVICE_CONTEXT_SETUP_RESPONSE,
+    S1HO_REQUIRED,
+    S1HO_REQUEST,
+    S1HO_REQUEST_ACK,
+    S1HO_COMMAND,
+    S1HO_NOTIFY,
+    S1HO_RELEASE_COMMAND,
+    S1HO_RELEASE_COMPLETE,
+    // X2 handover back to the home eNB, then inactivity release
+    X2HO_PATH_SWITCH_REQUEST,
+    X2HO_PATH_SWITCH_ACK,
+    X2HO_RELEASE_REQUEST,
+    X2HO_RELEASE_COMMAND,
+    X2HO_RELEASE_COMPLETE,
+    // Tracking area update
+    TAU_INITIAL_UE_MESSAGE,
+    TAU_ACCEPT,
+    TAU_RELEASE_COMMAND,
+    TAU_RELEASE_COMPLETE,
+    NUM_STEPS
+};
+
+// S1AP IDs are per connection: MME side attach / service / TAU, eNB side
+// attach, service, handover target, path switch and TAU
+constexpr uint32_t MME_CONNECTIONS = 3;
+constexpr uint32_t ENB_CONNECTIONS = 5;
+
+} // namespace
+
+UeTrafficModel::UeTrafficModel(const Config& config)
+    : config_(config) {
+    if (config_.num_ues == 0) {
+        throw std::runtime_error("UeTrafficModel: num_ues must be positive");
+    }
+    if (config_.first_ue + config_.num_ues > MAX_UES) {
+        throw std::runtime_error("UeTrafficModel: more than " + std::to_string(MAX_UES) + " UEs");
+    }
+    if (config_.num_enbs < 2) {
+        config_.num_enbs = 2;
+    }
+}
+
+size_t UeTrafficModel::script_length() {
+    return NUM_STEPS;
+}
+
+std::string UeTrafficModel::imsi(const std::string& plmn, size_t ue) {
+    std::string digits = std::to_string(ue);
+    size_t msin_length = 15 - plmn.size();
+    return plmn + std::string(msin_length - std::min(msin_length, digits.size()), '0') + digits;
+}
+
+uint32_t UeTrafficModel::m_tmsi(size_t ue) {
+    return static_cast<uint32_t>(0xC0000000u | ue);
+}
+
+S1apCell UeTrafficModel::cell(size_t enb) const {
+    return S1apCell{config_.plmn, static_cast<uint32_t>((enb + 1) << 8 | 1), static_cast<uint16_t>(1 + enb % 16)};
+}
+
+UeTrafficModel::Pdu UeTrafficModel::next() {
+    Pdu pdu = build(step_, config_.first_ue + ue_);
+    if (++ue_ == config_.num_ues) {
+        ue_ = 0;
+        if (++step_ == NUM_STEPS) {
+            step_ = 0;
+            ++cycle_;
+        }
+    }
+    return pdu;
+}
+
+UeTrafficModel::Pdu UeTrafficModel::build(size_t step, size_t ue) const {
+    uint64_t key = cycle_ * MAX_UES + ue;
+    auto mme_id = [&](uint32_t connection) {
+        return static_cast<uint32_t>(1 + key * MME_CONNECTIONS + connection);
+    };
+    auto enb_id = [&](uint32_t connection) {
+        return static_cast<uint32_t>((1 + key * ENB_CONNECTIONS + connection) & 0xFFFFFF);
+    };
+    
+    uint32_t home = static_cast<uint32_t>(ue % config_.num_enbs);
+    uint32_t neighbour = static_cast<uint32_t>((home + 1) % config_.num_enbs);
+    S1apCell home_cell = cell(home);
+    S1apCell neighbour_cell = cell(neighbour);
+    Guti guti{config_.plmn, 0x8001, 0x01, m_tmsi(ue)};
+    // Uplink (S-GW) and downlink (eNB) GTP-U tunnels of the default bearer
+    ERab uplink{5, static_cast<uint32_t>(0x10000000u | (key & 0x0FFFFFFF)), 0x0A000001, 9};
+    ERab downlink{5, static_cast<uint32_t>(0x20000000u | (key & 0x0FFFFFFF)), 0x0A010000u | home, 9};
+    uint32_t address = static_cast<uint32_t>(0x0A800000u + ue);
+    
+    switch (static_cast<Step>(step)) {
+        case ATTACH_INITIAL_UE_MESSAGE:
+            return {"initial_ue_message", home,
+                    S1apBuilder::initial_ue_message(enb_id(0), S1apBuilder::attach_request(imsi(config_.plmn, ue)),
+                                                    home_cell)};
+        case ATTACH_CONTEXT_SETUP_REQUEST:
+            return {"initial_context_setup_request", home,
+                    S1apBuilder::initial_context_setup_request(mme_id(0), enb_id(0), uplink,
+                        S1apBuilder::attach_accept(guti, home_cell, address, 1))};
+        case ATTACH_CONTEXT_SETUP_RESPONSE:
+            return {"initial_context_setup_response", home,
+                    S1apBuilder::initial_context_setup_response(mme_id(0), enb_id(0), downlink)};
+        case ATTACH_COMPLETE:
+            return {"uplink_nas_transport", home,
+                    S1apBuilder::uplink_nas_transport(mme_id(0), enb_id(0), S1apBuilder::attach_complete(2), home_cell)};
+        case ATTACH_RELEASE_REQUEST:
+            return {"ue_context_release_request", home, S1apBuilder::ue_context_release_request(mme_id(0), enb_id(0))};
+        case ATTACH_RELEASE_COMMAND:
+            return {"ue_context_release_command", home, S1apBuilder::ue_context_release_command(mme_id(0), enb_id(0))};
+        case ATTACH_RELEASE_COMPLETE:
+            return {"ue_context_release_complete", home, S1apBuilder::ue_context_release_complete(mme_id(0), enb_id(0))};
+            
+        case SERVICE_INITIAL_UE_MESSAGE:
+            return {"initial_ue_message", home,
+                    S1apBuilder::initial_ue_message(enb_id(1), S1apBuilder::service_request(0, 3), home_cell, guti)};
+        case SERVICE_CONTEXT_SETUP_REQUEST:
+            return {"initial_context_setup_request", home,
+                    S1apBuilder::initial_context_setup_request(mme_id(1), enb_id(1), uplink)};
+        case SERVICE_CONTEXT_SETUP_RESPONSE:
+            return {"initial_context_setup_response", home,
+                    S1apBuilder::initial_context_setup_response(mme_id(1), enb_id(1), downlink)};
+        case S1HO_REQUIRED:
+            return {"handover_required", home, S1apBuilder::handover_required(mme_id(1), enb_id(1), neighbour_cell)};
+        case S1HO_REQUEST:
+            return {"handover_request", neighbour, S1apBuilder::handover_request(mme_id(1), uplink)};
+        case S1HO_REQUEST_ACK:
+            return {"handover_request_ack", neighbour, S1apBuilder::handover_request_ack(mme_id(1), enb_id(2), downlink)};
+        case S1HO_COMMAND:
+            return {"handover_command", home, S1apBuilder::handover_command(mme_id(1), enb_id(1))};
+        case S1HO_NOTIFY:
+            return {"handover_notify", neighbour, S1apBuilder::handover_notify(mme_id(1), enb_id(2), neighbour_cell)};
+        case S1HO_RELEASE_COMMAND:
+            return {"ue_context_release_command", home, S1apBuilder::ue_context_release_command(mme_id(1), enb_id(1))};
+        case S1HO_RELEASE_COMPLETE:
+            return {"ue_context_release_complete", home, S1apBuilder::ue_context_release_complete(mme_id(1), enb_id(1))};
+            
+        case X2HO_PATH_SWITCH_REQUEST:
+            return {"path_switch_request", home,
+                    S1apBuilder::path_switch_request(mme_id(1), enb_id(3), downlink, home_cell)};
+        case X2HO_PATH_SWITCH_ACK:
+            return {"path_switch_request_ack", home, S1apBuilder::path_switch_request_ack(mme_id(1), enb_id(3))};
+        case X2HO_RELEASE_REQUEST:
+            return {"ue_context_release_request", home, S1apBuilder::ue_context_release_request(mme_id(1), enb_id(3))};
+        case X2HO_RELEASE_COMMAND:
+            return {"ue_context_release_command", home, S1apBuilder::ue_context_release_command(mme_id(1), enb_id(3))};
+        case X2HO_RELEASE_COMPLETE:
+            return {"ue_context_release_complete", home, S1apBuilder::ue_context_release_complete(mme_id(1), enb_id(3))};
+            
+        case TAU_INITIAL_UE_MESSAGE:
+            return {"initial_ue_message", home,
+                    S1apBuilder::initial_ue_message(enb_id(4), S1apBuilder::tau_request(guti, 4), home_cell, guti)};
+        case TAU_ACCEPT:
+            return {"downlink_nas_transport", home,
+                    S1apBuilder::downlink_nas_transport(mme_id(2), enb_id(4), S1apBuilder::tau_accept(guti, home_cell, 5))};
+        case TAU_RELEASE_COMMAND:
+            return {"ue_context_release_command", home, S1apBuilder::ue_context_release_command(mme_id(2), enb_id(4))};
+        case TAU_RELEASE_COMPLETE:
+            return {"ue_context_release_complete", home, S1apBuilder::ue_context_release_complete(mme_id(2), enb_id(4))};
+        case NUM_STEPS:
+            break;
+    }
+    throw std::runtime_error("UeTrafficModel: invalid step " + std::to_string(step));
+}
+
+} // namespace utils
+} // namespace s1see
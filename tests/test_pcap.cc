@@ -109,8 +109,7 @@ void test_pcap_processing(const std::string& pcap_path) {
                 msg.set_source_id("pcap:" + fs::path(pcap_path).filename().string());
                 msg.set_direction(SignalMessage::UNKNOWN); // Could be determined from packet analysis
                 msg.set_source_sequence(sequence++);
-                msg.set_transport_meta("{\"pcap\": true, \"packet_num\": " + 
-                                      std::to_string(pkt.frame_number) + "}");
+                msg.set_frame_number(pkt.frame_number);
                 msg.set_payload_type(SignalMessage::RAW_BYTES);
                 msg.set_raw_bytes(s1ap_bytes.data(), s1ap_bytes.size());
                 
@@ -143,8 +142,7 @@ void test_pcap_processing(const std::string& pcap_path) {
             msg.set_source_id("pcap:" + fs::path(pcap_path).filename().string());
             msg.set_direction(SignalMessage::UNKNOWN);
             msg.set_source_sequence(sequence++);
-            msg.set_transport_meta("{\"pcap\": true, \"packet_num\": " + 
-                                  std::to_string(pkt.frame_number) + "}");
+            msg.set_frame_number(pkt.frame_number);
             msg.set_payload_type(SignalMessage::RAW_BYTES);
             msg.set_raw_bytes(s1ap_bytes.data(), s1ap_bytes.size());
             